@@ -0,0 +1,460 @@
+#include "bench.hpp"
+#include "crc32c.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace SAK {
+namespace bench {
+
+namespace {
+
+struct RunOptions {
+    std::string filter;
+    std::string out;
+    std::vector<size_t> threads;  // Replaces ThreadSweep() when set
+    size_t samples = 20;
+    size_t warmup = 3;
+    double min_sample_ns = 10e6;
+    bool list = false;
+};
+
+struct Result {
+    std::string name;
+    size_t threads = 1;
+    size_t ops = 0;                  // Per thread and sample, or shared by the threads
+    std::vector<double> ns_per_op;   // One entry per sample, sorted
+    double ops_per_sec = 0;
+    double bytes_per_sec = 0;
+    std::string error;
+};
+
+std::vector<Case>& Cases() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+std::vector<size_t>& SweepOverride() {
+    static std::vector<size_t> threads;
+    return threads;
+}
+
+/**
+ * Threads 1..n-1 of a sample; thread 0 is the caller of Sample(), so a
+ * single-threaded case never pays for a wake-up.
+ */
+class Team {
+public:
+    Team(size_t threads, const Fixture& fixture) : fixture_(fixture) {
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, i] { Work(i); });
+        }
+    }
+
+    ~Team() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Wall time of one sample in nanoseconds; rethrows what a thread threw
+    double Sample(size_t ops) {
+        if (fixture_.reset) {
+            fixture_.reset();
+        }
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ops_ = ops;
+            done_ = 0;
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        try {
+            fixture_.run(0, ops);
+        } catch (...) {
+            Fail(std::current_exception());
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [this] { return done_ == workers_.size(); });
+        }
+        if (!error_ && fixture_.finish_sample) {
+            try {
+                fixture_.finish_sample();
+            } catch (...) {
+                Fail(std::current_exception());
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    void Work(size_t index) {
+        uint64_t seen = 0;
+        for (;;) {
+            size_t ops;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                ops = ops_;
+            }
+            try {
+                fixture_.run(index, ops);
+            } catch (...) {
+                Fail(std::current_exception());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++done_;
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    void Fail(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = error;
+        }
+    }
+
+    const Fixture& fixture_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t ops_ = 0;
+    size_t done_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+// Grows the batch until one sample takes at least the minimum time
+size_t Calibrate(Team& team, double min_sample_ns) {
+    constexpr size_t kMaxOps = size_t(1) << 30;
+    // The first call pays for lazy initialization and cold caches
+    team.Sample(1);
+    size_t ops = 1;
+    for (;;) {
+        double elapsed = team.Sample(ops);
+        if (elapsed >= min_sample_ns || ops >= kMaxOps) {
+            return ops;
+        }
+        double scale = elapsed > 0 ? min_sample_ns * 1.2 / elapsed : 10.0;
+        ops = std::min(kMaxOps, static_cast<size_t>(static_cast<double>(ops) * std::min(10.0, std::max(2.0, scale))));
+    }
+}
+
+Result Measure(const Case& bench_case, size_t threads, const RunOptions& options) {
+    Result result;
+    result.name = bench_case.name;
+    result.threads = threads;
+    Fixture fixture;
+    try {
+        fixture = bench_case.setup(threads);
+        {
+            Team team(threads, fixture);
+            result.ops = Calibrate(team, options.min_sample_ns);
+            for (size_t i = 0; i < options.warmup; ++i) {
+                team.Sample(result.ops);
+            }
+            double total_ns = 0;
+            for (size_t i = 0; i < options.samples; ++i) {
+                double elapsed = team.Sample(result.ops);
+                total_ns += elapsed;
+                result.ns_per_op.push_back(elapsed / static_cast<double>(result.ops));
+            }
+            double total_ops = static_cast<double>(result.ops) * static_cast<double>(options.samples) *
+                               (bench_case.shared_ops ? 1.0 : static_cast<double>(threads));
+            result.ops_per_sec = total_ns > 0 ? total_ops * 1e9 / total_ns : 0;
+            result.bytes_per_sec = result.ops_per_sec * static_cast<double>(bench_case.bytes_per_op);
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    } catch (...) {
+        result.error = "unknown exception";
+    }
+    if (fixture.teardown) {
+        fixture.teardown();
+    }
+    std::sort(result.ns_per_op.begin(), result.ns_per_op.end());
+    return result;
+}
+
+// Nearest-rank percentile of sorted samples
+double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+double Mean(const std::vector<double>& values) {
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+    return values.empty() ? 0 : sum / static_cast<double>(values.size());
+}
+
+std::string Quote(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+std::string Number(double value) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.3f", value);
+    return text;
+}
+
+std::string Compiler() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+std::string Timestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return text;
+}
+
+/**
+ * One object per run: what was measured on which build, then one entry
+ * per (benchmark, thread count). Latencies are per operation and thread,
+ * with percentiles taken over the samples.
+ */
+std::string ToJson(const std::vector<Result>& results, const RunOptions& options) {
+    std::string out = "{\n";
+    out += "  \"schema\": 1,\n";
+    out += "  \"timestamp\": " + Quote(Timestamp()) + ",\n";
+    out += "  \"compiler\": " + Quote(Compiler()) + ",\n";
+#ifdef NDEBUG
+    out += "  \"build\": \"release\",\n";
+#else
+    out += "  \"build\": \"debug\",\n";
+#endif
+    out += "  \"hardware_concurrency\": " + std::to_string(std::thread::hardware_concurrency()) + ",\n";
+    out += std::string("  \"crc32c_hardware\": ") + (Crc32c::IsHardwareAccelerated() ? "true" : "false") + ",\n";
+    out += "  \"samples\": " + std::to_string(options.samples) + ",\n";
+    out += "  \"warmup\": " + std::to_string(options.warmup) + ",\n";
+    out += "  \"min_sample_ms\": " + Number(options.min_sample_ns / 1e6) + ",\n";
+    out += "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out += i ? ",\n    {" : "\n    {";
+        out += "\"name\": " + Quote(r.name);
+        out += ", \"threads\": " + std::to_string(r.threads);
+        if (!r.error.empty()) {
+            out += ", \"error\": " + Quote(r.error) + "}";
+            continue;
+        }
+        out += ", \"ops_per_sample\": " + std::to_string(r.ops);
+        out += ", \"ops_per_sec\": " + Number(r.ops_per_sec);
+        if (r.bytes_per_sec > 0) {
+            out += ", \"bytes_per_sec\": " + Number(r.bytes_per_sec);
+        }
+        out += ", \"ns_per_op\": {\"mean\": " + Number(Mean(r.ns_per_op));
+        out += ", \"min\": " + Number(r.ns_per_op.front());
+        out += ", \"p50\": " + Number(Percentile(r.ns_per_op, 50));
+        out += ", \"p90\": " + Number(Percentile(r.ns_per_op, 90));
+        out += ", \"p99\": " + Number(Percentile(r.ns_per_op, 99));
+        out += ", \"max\": " + Number(r.ns_per_op.back()) + "}}";
+    }
+    out += results.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+std::vector<size_t> ParseList(const char* text) {
+    std::vector<size_t> values;
+    while (*text) {
+        char* end = nullptr;
+        unsigned long value = std::strtoul(text, &end, 10);
+        if (end == text) {
+            break;
+        }
+        if (value) {
+            values.push_back(value);
+        }
+        text = *end == ',' ? end + 1 : end;
+    }
+    return values;
+}
+
+bool StartsWith(const char* arg, const char* prefix, const char** value) {
+    size_t length = std::strlen(prefix);
+    if (std::strncmp(arg, prefix, length) != 0) {
+        return false;
+    }
+    *value = arg + length;
+    return true;
+}
+
+void Usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--filter=TEXT] [--threads=N,N...] [--samples=N] [--warmup=N]\n"
+                 "          [--min-time-ms=N] [--out=FILE] [--list]\n"
+                 "Runs the benchmarks whose name contains TEXT and writes JSON to FILE or stdout.\n",
+                 program);
+}
+
+bool ParseOptions(int argc, char** argv, RunOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (StartsWith(argv[i], "--filter=", &value)) {
+            options.filter = value;
+        } else if (StartsWith(argv[i], "--out=", &value)) {
+            options.out = value;
+        } else if (StartsWith(argv[i], "--threads=", &value)) {
+            options.threads = ParseList(value);
+        } else if (StartsWith(argv[i], "--samples=", &value)) {
+            options.samples = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (StartsWith(argv[i], "--warmup=", &value)) {
+            options.warmup = std::strtoul(value, nullptr, 10);
+        } else if (StartsWith(argv[i], "--min-time-ms=", &value)) {
+            options.min_sample_ns = std::max(0.01, std::strtod(value, nullptr)) * 1e6;
+        } else if (std::strcmp(argv[i], "--list") == 0) {
+            options.list = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void Register(Case bench_case) {
+    Cases().push_back(std::move(bench_case));
+}
+
+std::vector<size_t> ThreadSweep() {
+    if (!SweepOverride().empty()) {
+        return SweepOverride();
+    }
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threads;
+    for (size_t n = 1; n < hardware; n *= 2) {
+        threads.push_back(n);
+    }
+    threads.push_back(hardware);
+    return threads;
+}
+
+} // namespace bench
+} // namespace SAK
+
+int main(int argc, char** argv) {
+    using namespace SAK::bench;
+    RunOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        Usage(argv[0]);
+        return 2;
+    }
+    SweepOverride() = options.threads;
+    RegisterUtilBenchmarks();
+    RegisterIoBenchmarks();
+    RegisterSignalBenchmarks();
+
+    std::vector<Result> results;
+    for (const Case& bench_case : Cases()) {
+        if (bench_case.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        for (size_t threads : bench_case.threads) {
+            if (options.list) {
+                std::printf("%s threads=%zu\n", bench_case.name.c_str(), threads);
+                continue;
+            }
+            results.push_back(Measure(bench_case, threads, options));
+            const Result& r = results.back();
+            if (!r.error.empty()) {
+                std::fprintf(stderr, "%-40s %3zu  error: %s\n", r.name.c_str(), threads, r.error.c_str());
+            } else {
+                std::fprintf(stderr, "%-40s %3zu  p50 %10.1f ns/op  p99 %10.1f ns/op  %14.0f ops/s\n",
+                             r.name.c_str(), threads, Percentile(r.ns_per_op, 50), Percentile(r.ns_per_op, 99),
+                             r.ops_per_sec);
+            }
+        }
+    }
+    if (options.list) {
+        return 0;
+    }
+
+    std::string json = ToJson(results, options);
+    if (options.out.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        FILE* file = std::fopen(options.out.c_str(), "w");
+        bool written = file && std::fputs(json.c_str(), file) >= 0;
+        if (file && std::fclose(file) != 0) {
+            written = false;
+        }
+        if (!written) {
+            std::fprintf(stderr, "cannot write %s\n", options.out.c_str());
+            return 1;
+        }
+    }
+    for (const Result& r : results) {
+        if (!r.error.empty()) {
+            return 1;
+        }
+    }
+    return 0;
+}
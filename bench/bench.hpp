@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SAK {
+namespace bench {
+
+/**
+ * @brief Keep `value` alive as far as the optimizer can tell
+ *
+ * Stops a benchmark body whose results are otherwise unused, such as a
+ * malloc/free pair, from being folded away.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief What one benchmark runs at a given thread count
+ *
+ * `run(thread, ops)` performs `ops` operations on behalf of thread
+ * `thread`; every thread of a sample is released at the same time and the
+ * sample lasts until the slowest one returns and `finish_sample`, when set,
+ * has run, e.g. to drain work handed off to other threads. `reset`, when
+ * set, runs untimed before every sample, and `teardown` once, untimed,
+ * after the last one.
+ */
+struct Fixture {
+    std::function<void(size_t thread, size_t ops)> run;
+    std::function<void()> finish_sample;
+    std::function<void()> reset;
+    std::function<void()> teardown;
+};
+
+/**
+ * @brief A named benchmark and the thread counts it is swept over
+ *
+ * `setup(threads)` is called once per thread count, untimed, and builds
+ * the state the fixture works on. With `shared_ops` the threads cooperate
+ * on one batch of `ops` operations (e.g. an owner and its thieves), so
+ * throughput is not multiplied by the thread count. A non-zero
+ * `bytes_per_op` adds a bytes per second figure.
+ */
+struct Case {
+    std::string name;
+    std::function<Fixture(size_t threads)> setup;
+    std::vector<size_t> threads{1};
+    bool shared_ops = false;
+    size_t bytes_per_op = 0;
+};
+
+// Adds a benchmark to the suite; names are "area/operation[/variant]"
+void Register(Case bench_case);
+
+// 1, 2, 4, ... up to and including the hardware concurrency, or --threads
+std::vector<size_t> ThreadSweep();
+
+// Stable per-thread pseudo-random sequence for key and size choices
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed * 0x9e3779b97f4a7c15ull + 1) {}
+
+    uint64_t Next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+        return state_;
+    }
+
+private:
+    uint64_t state_;
+};
+
+// Registration entry points of the benchmark files
+void RegisterUtilBenchmarks();
+void RegisterIoBenchmarks();
+void RegisterSignalBenchmarks();
+
+} // namespace bench
+} // namespace SAK
@@ -0,0 +1,182 @@
+#include "bench.hpp"
+#include "file_object.hpp"
+#include "ipc_implement.hpp"
+#include "logger.hpp"
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace SAK {
+namespace bench {
+
+namespace {
+
+std::string UniqueName(const std::string& what) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return "codeknife_bench_" + what + "_" + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+/**
+ * LOG_INFO lines of about 80 bytes; each sample ends when the logging
+ * thread has written them, so the figure is end-to-end throughput rather
+ * than the cost of handing a line off.
+ */
+Fixture LoggerFixture(bool async_mode, bool thread_buffers) {
+    auto dir = std::make_shared<fs::path>(fs::temp_directory_path() / UniqueName("log"));
+    log::LogConfig config;
+    config.log_dir = dir->string();
+    config.async_mode = async_mode;
+    config.thread_buffers = thread_buffers;
+    config.min_level = log::Level::LOG_INFO;
+    log::Logger::instance().configure(config);
+
+    Fixture fixture;
+    fixture.run = [](size_t thread, size_t ops) {
+        for (size_t i = 0; i < ops; ++i) {
+            LOG_INFO("bench thread %zu line %zu value %d status %s", thread, i, 42, "ok");
+        }
+    };
+    fixture.finish_sample = [] { log::Logger::instance().flush(); };
+    fixture.teardown = [dir] {
+        log::Logger::instance().configure(log::LogConfig());
+        std::error_code ignored;
+        fs::remove_all(*dir, ignored);
+    };
+    return fixture;
+}
+
+void RegisterLogger() {
+    Register({"logger/sync", [](size_t) { return LoggerFixture(false, false); }, ThreadSweep()});
+    Register({"logger/async_queue", [](size_t) { return LoggerFixture(true, false); }, ThreadSweep()});
+    Register({"logger/async_thread_buffers", [](size_t) { return LoggerFixture(true, true); }, ThreadSweep()});
+}
+
+/**
+ * One operation is a request from the client and the server's echo of
+ * it, the server answering from its message handler; the client polls
+ * for the reply without sleeping.
+ */
+Fixture IpcFixture(ipc::IPCTransport transport, size_t payload) {
+    struct Channel {
+        explicit Channel(const std::string& name) : server(name, true), client(name, false) {}
+
+        ipc::IPCImplement server;
+        ipc::IPCImplement client;
+        std::string request;
+        std::string reply;
+    };
+    auto channel = std::make_shared<Channel>(UniqueName("ipc"));
+    channel->request.assign(payload, 'r');
+    channel->server.setTransport(transport);
+    channel->client.setTransport(transport);
+    ipc::IPCImplement* server = &channel->server;
+    channel->server.setMessageHandler([server](std::string_view message) { server->sendMessage(std::string(message)); });
+    channel->server.start();
+    channel->client.start();
+
+    Fixture fixture;
+    fixture.run = [channel](size_t, size_t ops) {
+        for (size_t i = 0; i < ops; ++i) {
+            if (!channel->client.sendMessage(channel->request)) {
+                throw std::runtime_error("sendMessage failed");
+            }
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            for (size_t spins = 1; !channel->client.receiveMessage(channel->reply); ++spins) {
+                if (spins % 4096 == 0 && std::chrono::steady_clock::now() > deadline) {
+                    throw std::runtime_error("no reply within 5 s");
+                }
+            }
+        }
+    };
+    fixture.teardown = [channel] {
+        channel->client.stop();
+        channel->server.stop();
+    };
+    return fixture;
+}
+
+void RegisterIpc() {
+    Register({"ipc/round_trip/semaphore/64",
+              [](size_t) { return IpcFixture(ipc::IPCTransport::semaphore, 64); }});
+    Register({"ipc/round_trip/spsc_ring/64",
+              [](size_t) { return IpcFixture(ipc::IPCTransport::spsc_ring, 64); }});
+    Register({"ipc/round_trip/spsc_ring/4096",
+              [](size_t) { return IpcFixture(ipc::IPCTransport::spsc_ring, 4096); }});
+}
+
+constexpr size_t kFileChunk = 64 * 1024;
+
+/**
+ * One operation appends a 64 KiB chunk; each sample writes a new file of
+ * `ops` chunks and includes trimming and reopening it. The Create()
+ * baseline builds the whole file in memory first, as its callers do.
+ */
+Fixture FileWriteFixture(bool streaming, bool direct_io, bool pooled) {
+    struct State {
+        std::string path = (fs::temp_directory_path() / UniqueName("file")).string();
+        std::vector<uint8_t> chunk = std::vector<uint8_t>(kFileChunk, 0x5a);
+        std::unique_ptr<thread::ThreadPool> pool;
+        FileWriterOptions options;
+    };
+    auto state = std::make_shared<State>();
+    if (pooled) {
+        state->pool = std::make_unique<thread::ThreadPool>(2);
+        state->options.pool = state->pool.get();
+        state->options.buffers = 4;
+    }
+    state->options.direct_io = direct_io;
+
+    Fixture fixture;
+    fixture.run = [state, streaming](size_t, size_t ops) {
+        FileObject file;
+        if (streaming) {
+            FileWriter writer(state->path, state->options);
+            for (size_t i = 0; i < ops; ++i) {
+                writer.Append(state->chunk);
+            }
+            file = writer.Finish();
+        } else {
+            std::vector<uint8_t> data;
+            data.reserve(ops * kFileChunk);
+            for (size_t i = 0; i < ops; ++i) {
+                data.insert(data.end(), state->chunk.begin(), state->chunk.end());
+            }
+            file = FileObject::Create(state->path, data);
+        }
+        if (file.Size() != ops * kFileChunk) {
+            throw std::runtime_error("short file");
+        }
+    };
+    fixture.teardown = [state] {
+        std::error_code ignored;
+        fs::remove(state->path, ignored);
+    };
+    return fixture;
+}
+
+void RegisterFileWrite() {
+    Case create{"file/create_from_vector", [](size_t) { return FileWriteFixture(false, false, false); }};
+    Case buffered{"file/writer/buffered", [](size_t) { return FileWriteFixture(true, false, false); }};
+    Case direct{"file/writer/direct", [](size_t) { return FileWriteFixture(true, true, false); }};
+    Case pooled{"file/writer/direct_pool", [](size_t) { return FileWriteFixture(true, true, true); }};
+    for (Case* bench_case : {&create, &buffered, &direct, &pooled}) {
+        bench_case->bytes_per_op = kFileChunk;
+        Register(std::move(*bench_case));
+    }
+}
+
+} // namespace
+
+void RegisterIoBenchmarks() {
+    RegisterLogger();
+    RegisterIpc();
+    RegisterFileWrite();
+}
+
+} // namespace bench
+} // namespace SAK
@@ -0,0 +1,144 @@
+#include "bench.hpp"
+#include "cobject.hpp"
+#include "connection_manager.hpp"
+#include "meta_registry.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace SAK {
+namespace bench {
+
+class BenchEmitter : public CObject {
+    DECLARE_OBJECT(BenchEmitter)
+public:
+    SIGNAL(BenchEmitter, ticked, "void()")
+    SIGNAL(BenchEmitter, valued, "void(int)")
+    TYPED_SIGNAL(BenchEmitter, typed, int)
+};
+
+class BenchCounter : public CObject {
+    DECLARE_OBJECT(BenchCounter)
+public:
+    SLOT(BenchCounter, void, onTick, "void()")
+    SLOT(BenchCounter, void, onValue, "void(int)", int value)
+
+    // Not registered: reached through a typed connection
+    void add(int value) { total_.fetch_add(value, std::memory_order_relaxed); }
+
+private:
+    std::atomic<long> total_{0};
+};
+
+void BenchCounter::onTick() {
+    total_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BenchCounter::onValue(int value) {
+    total_.fetch_add(value, std::memory_order_relaxed);
+}
+
+class BenchWidget : public CObject {
+    DECLARE_OBJECT(BenchWidget)
+};
+
+class BenchPooledWidget : public CObject {
+    DECLARE_POOLED_OBJECT(BenchPooledWidget)
+};
+
+AUTO_REGISTER_META_OBJECT(BenchEmitter, CObject)
+AUTO_REGISTER_META_OBJECT(BenchCounter, CObject)
+AUTO_REGISTER_META_OBJECT(BenchWidget, CObject)
+AUTO_REGISTER_META_OBJECT(BenchPooledWidget, CObject)
+
+namespace {
+
+enum class Emission { ByName, ByNameWithArgument, Typed };
+
+/**
+ * Every thread emits from the same sender into `receivers` direct
+ * connections, so the figure includes the cost of the slot calls; with no
+ * receivers it is the lookup alone.
+ */
+Fixture SignalFixture(Emission emission, size_t receivers) {
+    struct Objects {
+        BenchEmitter emitter;
+        std::vector<std::unique_ptr<BenchCounter>> counters;
+    };
+    auto objects = std::make_shared<Objects>();
+    for (size_t i = 0; i < receivers; ++i) {
+        objects->counters.push_back(std::make_unique<BenchCounter>());
+        BenchCounter* counter = objects->counters.back().get();
+        switch (emission) {
+        case Emission::ByName:
+            CObject::connect(&objects->emitter, "ticked", counter, "onTick");
+            break;
+        case Emission::ByNameWithArgument:
+            CObject::connect(&objects->emitter, "valued", counter, "onValue");
+            break;
+        case Emission::Typed:
+            CObject::connect(&objects->emitter, &BenchEmitter::typed, counter, &BenchCounter::add);
+            break;
+        }
+    }
+
+    Fixture fixture;
+    fixture.run = [objects, emission](size_t, size_t ops) {
+        BenchEmitter& emitter = objects->emitter;
+        for (size_t i = 0; i < ops; ++i) {
+            switch (emission) {
+            case Emission::ByName:
+                ConnectionManager::instance().emitSignal(&emitter, "ticked");
+                break;
+            case Emission::ByNameWithArgument:
+                ConnectionManager::instance().emitSignal(&emitter, "valued", {static_cast<int>(i)});
+                break;
+            case Emission::Typed:
+                emitter.typed(static_cast<int>(i));
+                break;
+            }
+        }
+    };
+    return fixture;
+}
+
+/**
+ * One operation creates an object by class name and deletes it; the
+ * factory variants resolve the name once, up front.
+ */
+Fixture CreateFixture(const char* className, bool resolved) {
+    MetaRegistry::instance().registerMeta(&BenchWidget::staticMetaObject);
+    MetaRegistry::instance().registerMeta(&BenchPooledWidget::staticMetaObject);
+    MetaFactory factory = MetaRegistry::instance().factory(className);
+
+    Fixture fixture;
+    fixture.run = [className, resolved, factory](size_t, size_t ops) {
+        for (size_t i = 0; i < ops; ++i) {
+            delete (resolved ? factory.create() : MetaRegistry::instance().createInstance(className));
+        }
+    };
+    return fixture;
+}
+
+} // namespace
+
+void RegisterSignalBenchmarks() {
+    Register({"meta/create/by_name", [](size_t) { return CreateFixture("BenchWidget", false); }, ThreadSweep()});
+    Register({"meta/create/factory", [](size_t) { return CreateFixture("BenchWidget", true); }, ThreadSweep()});
+    Register({"meta/create/pooled_factory", [](size_t) { return CreateFixture("BenchPooledWidget", true); },
+              ThreadSweep()});
+    Register({"signal/by_name/no_receivers", [](size_t) { return SignalFixture(Emission::ByName, 0); },
+              ThreadSweep()});
+    Register({"signal/by_name/1_receiver", [](size_t) { return SignalFixture(Emission::ByName, 1); },
+              ThreadSweep()});
+    Register({"signal/by_name/8_receivers", [](size_t) { return SignalFixture(Emission::ByName, 8); },
+              ThreadSweep()});
+    Register({"signal/by_name_int/1_receiver",
+              [](size_t) { return SignalFixture(Emission::ByNameWithArgument, 1); }, ThreadSweep()});
+    Register({"signal/typed_int/1_receiver", [](size_t) { return SignalFixture(Emission::Typed, 1); },
+              ThreadSweep()});
+}
+
+} // namespace bench
+} // namespace SAK
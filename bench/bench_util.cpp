@@ -0,0 +1,282 @@
+#include "bench.hpp"
+#include "crc32c.hpp"
+#include "memory_pool_v2.hpp"
+#include "object_pool.hpp"
+#include "skiplist.hpp"
+#include "spin_mutex.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace SAK {
+namespace bench {
+
+namespace {
+
+// Live allocations per thread; each operation frees the oldest and replaces it
+constexpr size_t kChurnSlots = 64;
+
+struct alignas(64) ChurnSlots {
+    void* slots[kChurnSlots] = {};
+    size_t next = 0;
+};
+
+template <typename Allocate, typename Free>
+Fixture ChurnFixture(size_t threads, size_t size, Allocate allocate, Free free) {
+    auto state = std::make_shared<std::vector<ChurnSlots>>(threads);
+    Fixture fixture;
+    fixture.run = [state, size, allocate, free](size_t thread, size_t ops) {
+        ChurnSlots& mine = (*state)[thread];
+        for (size_t i = 0; i < ops; ++i) {
+            void*& slot = mine.slots[mine.next++ % kChurnSlots];
+            if (slot) {
+                free(slot, size);
+            }
+            slot = allocate(size);
+            *static_cast<char*>(slot) = 1;
+            DoNotOptimize(slot);
+        }
+    };
+    fixture.teardown = [state, size, free] {
+        for (ChurnSlots& mine : *state) {
+            for (void* slot : mine.slots) {
+                if (slot) {
+                    free(slot, size);
+                }
+            }
+        }
+    };
+    return fixture;
+}
+
+void RegisterAllocators() {
+    for (size_t size : {16, 256, 4096}) {
+        std::string suffix = "/" + std::to_string(size);
+        Register({"memory/pool_v2" + suffix, [size](size_t threads) {
+                      return ChurnFixture(
+                          threads, size, [](size_t n) { return MemoryPoolV2::GetInstance().Allocate(n); },
+                          [](void* p, size_t n) { MemoryPoolV2::GetInstance().Deallocate(p, n); });
+                  },
+                  ThreadSweep()});
+        Register({"memory/malloc" + suffix, [size](size_t threads) {
+                      return ChurnFixture(
+                          threads, size, [](size_t n) { return std::malloc(n); },
+                          [](void* p, size_t) { std::free(p); });
+                  },
+                  ThreadSweep()});
+    }
+}
+
+struct Pooled {
+    char payload[64];
+};
+
+// One acquire/release pair per operation
+template <typename Pool>
+Fixture PoolFixture(size_t) {
+    auto pool = std::make_shared<Pool>(256);
+    Fixture fixture;
+    fixture.run = [pool](size_t, size_t ops) {
+        for (size_t i = 0; i < ops; ++i) {
+            Pooled* object = pool->acquire();
+            DoNotOptimize(object);
+            pool->release(object);
+        }
+    };
+    return fixture;
+}
+
+void RegisterObjectPools() {
+    using Reset = std::function<void(Pooled&)>;
+    Register({"object_pool/mutex", PoolFixture<pool::ObjectPool<Pooled>>, ThreadSweep()});
+    Register({"object_pool/spin_mutex", PoolFixture<pool::ObjectPool<Pooled, Reset, spin_mutex>>, ThreadSweep()});
+    Register({"object_pool/sharded", PoolFixture<pool::ShardedObjectPool<Pooled>>, ThreadSweep()});
+}
+
+// Producers submit to a pool of hardware_concurrency workers
+void RegisterThreadPool() {
+    Register({"thread_pool/enqueue", [](size_t threads) {
+                  auto pool = std::make_shared<thread::ThreadPool>();
+                  auto futures = std::make_shared<std::vector<std::vector<std::future<int>>>>(threads);
+                  Fixture fixture;
+                  fixture.run = [pool, futures](size_t thread, size_t ops) {
+                      std::vector<std::future<int>>& mine = (*futures)[thread];
+                      mine.clear();
+                      mine.reserve(ops);
+                      for (size_t i = 0; i < ops; ++i) {
+                          mine.push_back(pool->enqueue([] { return 1; }));
+                      }
+                      for (auto& future : mine) {
+                          future.get();
+                      }
+                  };
+                  return fixture;
+              },
+              ThreadSweep()});
+
+    Register({"thread_pool/post", [](size_t) {
+                  auto pool = std::make_shared<thread::ThreadPool>();
+                  auto posted = std::make_shared<std::atomic<size_t>>(0);
+                  auto ran = std::make_shared<std::atomic<size_t>>(0);
+                  Fixture fixture;
+                  fixture.run = [pool, posted, ran](size_t, size_t ops) {
+                      for (size_t i = 0; i < ops; ++i) {
+                          pool->post([ran] { ran->fetch_add(1, std::memory_order_relaxed); });
+                      }
+                      posted->fetch_add(ops, std::memory_order_relaxed);
+                  };
+                  fixture.finish_sample = [posted, ran] {
+                      while (ran->load(std::memory_order_acquire) < posted->load(std::memory_order_relaxed)) {
+                          std::this_thread::yield();
+                      }
+                  };
+                  return fixture;
+              },
+              ThreadSweep()});
+}
+
+void RegisterDeque() {
+    using Deque = thread::work_stealing_deque<long>;
+    // The owner alone: bursts of pushes popped back LIFO
+    Register({"work_stealing_deque/push_pop", [](size_t) {
+                  auto deque = std::make_shared<Deque>();
+                  Fixture fixture;
+                  fixture.run = [deque](size_t, size_t ops) {
+                      constexpr size_t kBurst = 64;
+                      for (size_t done = 0; done < ops; done += kBurst) {
+                          size_t burst = std::min(kBurst, ops - done);
+                          for (size_t i = 0; i < burst; ++i) {
+                              deque->push_bottom(static_cast<long>(i));
+                          }
+                          for (size_t i = 0; i < burst; ++i) {
+                              DoNotOptimize(deque->pop_bottom());
+                          }
+                      }
+                  };
+                  return fixture;
+              }});
+
+    // Thread 0 owns the deque, pushing `ops` items and popping half of
+    // each burst; the other threads steal until it has drained the rest
+    Register({"work_stealing_deque/steal", [](size_t threads) {
+                  auto deque = std::make_shared<Deque>();
+                  // Samples the owner has drained, and the ones each thief has joined
+                  auto drained = std::make_shared<std::atomic<uint64_t>>(0);
+                  auto joined = std::make_shared<std::vector<uint64_t>>(threads, 0);
+                  Fixture fixture;
+                  fixture.run = [deque, drained, joined](size_t thread, size_t ops) {
+                      constexpr size_t kBurst = 64;
+                      if (thread != 0) {
+                          uint64_t sample = ++(*joined)[thread];
+                          for (;;) {
+                              if (auto item = deque->steal_top()) {
+                                  DoNotOptimize(*item);
+                              } else if (drained->load(std::memory_order_acquire) >= sample) {
+                                  return;
+                              }
+                          }
+                      }
+                      for (size_t done = 0; done < ops; done += kBurst) {
+                          size_t burst = std::min(kBurst, ops - done);
+                          for (size_t i = 0; i < burst; ++i) {
+                              deque->push_bottom(static_cast<long>(i));
+                          }
+                          for (size_t i = 0; i < burst / 2; ++i) {
+                              DoNotOptimize(deque->pop_bottom());
+                          }
+                      }
+                      while (deque->pop_bottom()) {
+                      }
+                      drained->fetch_add(1, std::memory_order_release);
+                  };
+                  return fixture;
+              },
+              ThreadSweep(), true});
+}
+
+void RegisterSkipList() {
+    using List = ConcurrentSkipList<uint64_t, uint64_t>;
+    // Every sample inserts into an empty list
+    Register({"skiplist/insert", [](size_t) {
+                  auto list = std::make_shared<std::unique_ptr<List>>();
+                  auto round = std::make_shared<uint64_t>(0);
+                  Fixture fixture;
+                  fixture.reset = [list, round] {
+                      list->reset(new List());
+                      ++*round;
+                  };
+                  fixture.run = [list, round](size_t thread, size_t ops) {
+                      Random random(*round * 1024 + thread);
+                      List& target = **list;
+                      for (size_t i = 0; i < ops; ++i) {
+                          uint64_t key = random.Next();
+                          target.emplace(key, key);
+                      }
+                  };
+                  return fixture;
+              },
+              ThreadSweep()});
+
+    Register({"skiplist/find", [](size_t) {
+                  constexpr size_t kKeys = 1 << 20;
+                  auto list = std::make_shared<List>();
+                  auto keys = std::make_shared<std::vector<uint64_t>>();
+                  keys->reserve(kKeys);
+                  Random random(7);
+                  for (size_t i = 0; i < kKeys; ++i) {
+                      keys->push_back(random.Next());
+                      list->emplace(keys->back(), i);
+                  }
+                  Fixture fixture;
+                  fixture.run = [list, keys](size_t thread, size_t ops) {
+                      Random pick(thread + 1);
+                      for (size_t i = 0; i < ops; ++i) {
+                          DoNotOptimize(list->find((*keys)[pick.Next() % kKeys]));
+                      }
+                  };
+                  return fixture;
+              },
+              ThreadSweep()});
+}
+
+void RegisterCrc32c() {
+    for (size_t size : {64, 4096, 1 << 20}) {
+        Case bench_case{"crc32c/compute/" + std::to_string(size), [size](size_t) {
+                            auto data = std::make_shared<std::vector<uint8_t>>(size);
+                            Random random(size);
+                            for (uint8_t& byte : *data) {
+                                byte = static_cast<uint8_t>(random.Next());
+                            }
+                            Fixture fixture;
+                            fixture.run = [data](size_t, size_t ops) {
+                                for (size_t i = 0; i < ops; ++i) {
+                                    DoNotOptimize(Crc32c::Compute(data->data(), data->size()));
+                                }
+                            };
+                            return fixture;
+                        }};
+        bench_case.bytes_per_op = size;
+        Register(std::move(bench_case));
+    }
+}
+
+} // namespace
+
+void RegisterUtilBenchmarks() {
+    RegisterAllocators();
+    RegisterObjectPools();
+    RegisterThreadPool();
+    RegisterDeque();
+    RegisterSkipList();
+    RegisterCrc32c();
+}
+
+} // namespace bench
+} // namespace SAK
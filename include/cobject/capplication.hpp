@@ -1,18 +1,21 @@
 #pragma once
 
 #include "cobject.hpp"
-#include <mutex>
+#include "event_dispatcher.hpp"
+#include "unique_task.hpp"
+#include <functional>
 #include <vector>
 
 namespace SAK {
 
-class EventDispatcher;
+class EventLoop;
 
 class CApplication : public CObject {
 public:
     DECLARE_OBJECT(CApplication)
     
-    explicit CApplication(CObject* parent = nullptr);
+    explicit CApplication(CObject* parent = nullptr,
+                          EventDispatcherBackend backend = EventDispatcherBackend::Default);
     ~CApplication();
 
     static CApplication* instance();
@@ -24,25 +27,66 @@ public:
     EventDispatcher* eventDispatcher() const {
         return dispatcher_;
     }
+    /// The loop exec() runs, for its budget, coalescing and statistics
+    EventLoop* eventLoop() const {
+        return loop_;
+    }
     void setEventDispatcher(EventDispatcher* dispatcher);
     static bool sendEvent(CObject* receiver, Event* event);
+    /**
+     * @brief Queue `event` on the thread `receiver` lives in
+     *
+     * It is delivered by the event loop of that thread: exec() for the
+     * thread running it, an EventLoop for a worker thread.
+     */
     static void postEvent(CObject* receiver, Event* event);
     static void removePostedEvents(CObject* receiver, Event::Type eventType = Event::Type::None);
 
-private:
-    void processPostedEvents();
-    
-    struct PostedEvent {
-        CObject* receiver;
-        Event* event;
-        int priority;
+    /**
+     * @brief Run a function on the thread executing exec()
+     *
+     * Before exec() starts, the function is queued for the thread the
+     * application lives in. Callbacks and posted events run in the
+     * order they were posted. Without an application instance the
+     * callback is dropped.
+     */
+    static void postCallback(std::function<void()> callback);
+
+    /**
+     * @brief A SAK::timer::TimerExecutor that runs expired timer callbacks
+     *        on the main loop
+     *
+     * Each batch becomes one postCallback(), so callbacks that expired
+     * together run back to back in deadline order. Assign it to
+     * TimerOptions::executor.
+     */
+    static std::function<void(std::vector<thread::unique_task>&)> timerExecutor();
+
+    /**
+     * @brief Awaitable that resumes the awaiting coroutine on the main loop
+     *
+     * `co_await app.resumeOnMain()` suspends the coroutine and resumes it
+     * from exec() via postCallback().
+     */
+    struct MainAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<class Handle>
+        void await_suspend(Handle handle) {
+            CApplication::postCallback([handle]() mutable { handle.resume(); });
+        }
+
+        void await_resume() const noexcept {}
     };
+
+    MainAwaiter resumeOnMain() {
+        return MainAwaiter{};
+    }
+
+private:
     static CApplication* instance_;
     EventDispatcher* dispatcher_;
-    std::mutex eventQueueMutex_;
-    std::vector<PostedEvent> eventQueue_;
-    bool quitFlag_;
-    int returnCode_;
+    EventLoop* loop_;
 };
 
 }
\ No newline at end of file
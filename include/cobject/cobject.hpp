@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <any>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <unordered_map>
 #include <string>
 #include <thread>
@@ -9,12 +12,16 @@
 #include "meta_object.hpp"
 #include "meta_registrar.hpp"
 #include "invoker_helper.hpp"
+#include "signal.hpp"
 #include "connection_types.hpp"
 #include "event.hpp"
+#include "event_loop.hpp"
 
 namespace SAK {
 
 class ConnectionManager;
+struct ConnectionList;
+class EventDispatcher;
 
 class CObject {
 public:
@@ -38,6 +45,37 @@ public:
     std::vector<std::string> dynamicPropertyNames() const;
     static bool connect(const CObject* sender, const char* signal, const CObject* receiver, const char* slot, ConnectionType type = ConnectionType::kDirectConnection);
     static bool disconnect(const CObject* sender, const char* signal, const CObject* receiver, const char* slot);
+
+    /**
+     * @brief Connect a TYPED_SIGNAL to a member function, checked at compile time
+     *
+     * The slot need not be registered with SLOT; it is called through a
+     * typed thunk with the signal's arguments, never through std::any.
+     * Connection types behave as for the string-based connect().
+     */
+    template<typename Sender, typename SignalOwner, typename... Args, typename Receiver, typename Method>
+    static bool connect(const Sender* sender, Signal<Args...> SignalOwner::* signal,
+                        const Receiver* receiver, Method slot,
+                        ConnectionType type = ConnectionType::kDirectConnection) {
+        static_assert(std::is_base_of_v<SignalOwner, Sender>, "the signal is not a member of the sender");
+        static_assert(std::is_base_of_v<CObject, Receiver>, "the receiver must be a CObject");
+        if (!sender || !receiver || !signal || !slot) {
+            return false;
+        }
+        return connectThunk(sender, (sender->*signal).id(), receiver,
+                            std::make_shared<MemberSlotThunk<Receiver, Method, Args...>>(slot), type);
+    }
+
+    template<typename Sender, typename SignalOwner, typename... Args, typename Receiver, typename Method>
+    static bool disconnect(const Sender* sender, Signal<Args...> SignalOwner::* signal,
+                           const Receiver* receiver, Method slot) {
+        static_assert(std::is_base_of_v<SignalOwner, Sender>, "the signal is not a member of the sender");
+        if (!sender || !receiver || !signal || !slot) {
+            return false;
+        }
+        return disconnectThunk(sender, (sender->*signal).id(), receiver,
+                               MemberSlotThunk<Receiver, Method, Args...>(slot));
+    }
     static bool sendEvent(CObject* receiver, Event* event) {
         if (!receiver || !event)
             return false;
@@ -47,7 +85,22 @@ public:
     int startTimer(int64_t interval);
     void killTimer(int timerId);
     bool unregisterTimers();
-    std::thread::id thread() const { return thread_id_; }
+    std::thread::id thread() const { return thread_id_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Change the thread whose event loop receives this object's events
+     *
+     * Posted events, queued and blocking calls and deleteLater() then run
+     * on `thread`; events already queued for the object follow it. Only
+     * the object's current thread may move it, and only a top-level
+     * object can be moved; its children move with it. Timers stay with
+     * the dispatcher they were started on.
+     */
+    bool moveToThread(std::thread::id thread);
+
+    // Storage of DECLARE_POOLED_OBJECT classes
+    static void* allocatePooled(std::size_t size);
+    static void freePooled(void* object, std::size_t size) noexcept;
 
 protected:
     void emitSignal(const char* signal, const std::vector<std::any>& args = {});
@@ -55,17 +108,45 @@ protected:
     // Qt-style metacall for slot invocation
     void metacall(const char* slot, const std::vector<std::any>& args, 
                   ConnectionType type, const CObject* sender);
+    void metacall(const MetaMethod* method, const std::vector<std::any>& args,
+                  ConnectionType type, const CObject* sender);
+    // Typed connections: `args` is the emitting Signal's argument tuple
+    void metacall(const SlotThunk& thunk, const void* args,
+                  ConnectionType type, const CObject* sender);
+    void metacall(const std::shared_ptr<const SlotThunk>& thunk, const std::vector<std::any>& args,
+                  ConnectionType type, const CObject* sender);
     
 private:
+    enum class CallMode { Direct, Queued, Blocking };
+    CallMode callMode(ConnectionType type) const;
+    // Posts a MetaCallEvent to this object; Blocking waits until it ran
+    void postCall(MetaCallEvent* event, CallMode mode);
+
+    static bool connectThunk(const CObject* sender, int signal, const CObject* receiver,
+                             std::shared_ptr<const SlotThunk> thunk, ConnectionType type);
+    static bool disconnectThunk(const CObject* sender, int signal, const CObject* receiver,
+                                const SlotThunk& thunk);
+
     void removeChild(CObject* child);
     void addChild(CObject* child);
+    void setThreadData(ThreadData* data);
+    // The dispatcher of this object's thread, else the application's
+    EventDispatcher* eventDispatcher() const;
     friend class ConnectionManager;
+    friend class ThreadData;
 
     std::string object_name_;
     CObject* parent_ = nullptr;
     std::vector<CObject*> children_;
     std::unordered_map<std::string, std::any> dynamic_properties_;
-    std::thread::id thread_id_{std::this_thread::get_id()};
+    // Holds a reference; replaced only by moveToThread()
+    std::atomic<ThreadData*> thread_data_;
+    std::atomic<std::thread::id> thread_id_{std::this_thread::get_id()};
+    // Events queued for this object; see ThreadData
+    PostedEventList posted_events_;
+    std::atomic<int> posted_count_{0};
+    // Outgoing connections, owned and replaced by ConnectionManager
+    mutable std::atomic<const ConnectionList*> connections_{nullptr};
 };
 
 #define DECLARE_OBJECT(className) \
@@ -79,6 +160,22 @@ private: \
     static std::vector<MetaSignal> __signals(); \
 public:
 
+// DECLARE_OBJECT with instances, and those of subclasses, stored in
+// MemoryPoolV2's per-thread size-class caches instead of the global heap.
+// They are still created with new and freed with delete, by a parent or
+// deleteLater() as usual; the sized delete hands the pool the object's size.
+// This is not a speed-up: single-threaded, meta/create/pooled_factory runs
+// at about 80-90 ns against 60-65 ns for the plain factory. What it buys is
+// bulk object churn kept off the shared heap and covered by the pool's
+// statistics and Trim().
+#define DECLARE_POOLED_OBJECT(className) \
+    DECLARE_OBJECT(className) \
+    static void* operator new(std::size_t size) { return ::SAK::CObject::allocatePooled(size); } \
+    static void* operator new(std::size_t, void* place) noexcept { return place; } \
+    static void operator delete(void* object, std::size_t size) noexcept { ::SAK::CObject::freePooled(object, size); } \
+    static void operator delete(void*, void*) noexcept {} \
+public:
+
 #define REGISTER_OBJECT(className, parentClassName) \
     const MetaObject className::staticMetaObject( \
         #className, \
@@ -124,6 +221,18 @@ private: \
 public: \
     static constexpr const char* signal_##signature = #signature;
 
+// A Signal member named `name` taking the given argument types; it is
+// registered like SIGNAL and emitted with name(args...)
+#define TYPED_SIGNAL(className, name, ...) \
+private: \
+    inline static const bool signal_##name##_registered_ = []() { \
+        MetaRegistrar<className>::registerSignal(#name, "void(" #__VA_ARGS__ ")"); \
+        return true; \
+    }(); \
+public: \
+    static constexpr const char* signal_##name = #name; \
+    ::SAK::Signal<__VA_ARGS__> name{this, #name};
+
 #define SLOT(className, returnType, name, signature, ...) \
 public: \
     returnType name(__VA_ARGS__); \
@@ -145,7 +254,7 @@ std::vector<MetaProperty> className::__properties() { \
     std::vector<MetaProperty> props; \
     const auto& regProps = MetaRegistrar<className>::getProperties(); \
     for (const auto& p : regProps) { \
-        props.emplace_back(p.name, p.typeName, p.getter, p.setter); \
+        props.emplace_back(p.name, p.typeName, p.getter, p.setter, nullptr, p.id); \
     } \
     return props; \
 } \
@@ -153,7 +262,7 @@ std::vector<MetaMethod> className::__methods() { \
     std::vector<MetaMethod> meths; \
     const auto& regMeths = MetaRegistrar<className>::getMethods(); \
     for (const auto& m : regMeths) { \
-        meths.emplace_back(m.name, m.signature, m.invoker); \
+        meths.emplace_back(m.name, m.signature, m.invoker, m.id); \
     } \
     return meths; \
 } \
@@ -161,7 +270,7 @@ std::vector<MetaSignal> className::__signals() { \
     std::vector<MetaSignal> sigs; \
     const auto& regSigs = MetaRegistrar<className>::getSignals(); \
     for (const auto& s : regSigs) { \
-        sigs.emplace_back(s.name, s.signature, [](CObject*, const std::vector<std::any>&) {}); \
+        sigs.emplace_back(s.name, s.signature, [](CObject*, const std::vector<std::any>&) {}, s.id); \
     } \
     return sigs; \
 } \
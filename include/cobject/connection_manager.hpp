@@ -5,47 +5,66 @@
 #include <functional>
 #include <string>
 #include <memory>
-#include <mutex>
 #include <any>
+#include <mutex>
 #include "meta_object.hpp"
 #include "connection_types.hpp"
+#include "signal.hpp"
+#include "epoch.hpp"
 
 namespace SAK {
 
 class CObject;
 struct Connection {
     const CObject* sender;
-    std::string signal;
+    int signal;                 // MetaNames id of the signal
     const CObject* receiver;
-    std::string slot;
+    const MetaMethod* slot;     // Resolved once, at connect(); null when typed
     ConnectionType type;
     bool enabled;
+    std::shared_ptr<const SlotThunk> thunk;  // Typed connections only
 
     bool operator==(const Connection& other) const {
         return sender == other.sender &&
                signal == other.signal &&
                receiver == other.receiver &&
-               slot == other.slot;
+               slot == other.slot &&
+               (thunk == other.thunk || (thunk && other.thunk && thunk->equals(*other.thunk)));
     }
 };
 
 struct ConnectionHash {
     std::size_t operator()(const Connection& conn) const {
         std::size_t h1 = std::hash<const void*>{}(conn.sender);
-        std::size_t h2 = std::hash<std::string>{}(conn.signal);
+        std::size_t h2 = std::hash<int>{}(conn.signal);
         std::size_t h3 = std::hash<const void*>{}(conn.receiver);
-        std::size_t h4 = std::hash<std::string>{}(conn.slot);
+        std::size_t h4 = std::hash<const void*>{}(conn.slot);
         return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3);
     }
 };
 
+// Immutable snapshot of one sender's connections, sorted by signal id. A
+// sender publishes a new list on every change and emitters read whichever
+// one is current under an epoch guard.
+struct ConnectionList {
+    std::vector<Connection> connections;
+};
+
 class ConnectionManager {
 public:
     static ConnectionManager& instance();
     bool connect(const CObject* sender, const char* signal, const CObject* receiver, const char* slot, ConnectionType type);
     bool disconnect(const CObject* sender, const char* signal, const CObject* receiver, const char* slot);
+    // Typed connections, made through CObject::connect(&Sender::signal, ...)
+    bool connect(const CObject* sender, int signal, const CObject* receiver,
+                 std::shared_ptr<const SlotThunk> thunk, ConnectionType type);
+    bool disconnect(const CObject* sender, int signal, const CObject* receiver, const SlotThunk& thunk);
     void disconnectAll(const CObject* obj);
+    // Takes no lock and allocates nothing
     void emitSignal(const CObject* sender, const char* signal, const std::vector<std::any>& args={});
+    // Emission from a Signal member; see detail::activate()
+    void emitSignal(const CObject* sender, int signal, const void* args,
+                    const std::type_info& signature, detail::BoxArgs box);
 
 private:
     ConnectionManager() = default;
@@ -53,13 +72,20 @@ private:
     ConnectionManager(const ConnectionManager&) = delete;
     ConnectionManager& operator=(const ConnectionManager&) = delete;
 
-    std::vector<Connection> findConnections(const CObject* sender, const char* signal) const;
+    // Call with mutex_ held
+    bool addConnection(Connection conn);
+    std::vector<Connection> connectionsOf(const CObject* sender) const;
+    void publish(const CObject* sender, std::vector<Connection> connections);
+    void forgetReceiver(const CObject* sender, const CObject* receiver);
     void invokeSlot(const Connection& conn, const std::vector<std::any>& args);
 
-    std::unordered_map<const CObject*, std::vector<Connection>> connections_;
-    mutable std::mutex mutex_;
+    // Serializes connect/disconnect; emission never takes it
+    std::mutex mutex_;
+    // receiver -> senders connected to it, with connection counts, so
+    // disconnectAll() only visits the senders concerned
+    std::unordered_map<const CObject*, std::unordered_map<const CObject*, size_t>> senders_;
+    epoch_domain epoch_;
 
 };
 
 }
-
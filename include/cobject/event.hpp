@@ -1,10 +1,15 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <atomic>
 #include <vector>
 #include <future>
 #include <any>
 #include <string>
+#include <functional>
+#include <new>
+#include <typeinfo>
+#include "memory_pool_v2.hpp"
 
 namespace SAK {
 
@@ -21,6 +26,7 @@ public:
         DeferredDelete = 5,
         ChildAdded = 6,
         ChildRemoved = 7,
+        IoCompletion = 8,
         User = 1000,
         MaxUser = 65535
     };
@@ -28,6 +34,30 @@ public:
     explicit Event(Type type) : type_(type), accepted_(false) {}
     virtual ~Event() = default;
 
+    // Events are created by one thread and freed by another at a high
+    // rate; the pool keeps both sides off the global heap
+    static void* operator new(std::size_t size) {
+        void* ptr = MemoryPoolV2::GetInstance().Allocate(size);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        MemoryPoolV2::GetInstance().Deallocate(ptr, size);
+    }
+
+    /**
+     * @brief Absorb `later`, posted to the same receiver right after this one
+     *
+     * Only asked when the event loop coalesces, while this event is still
+     * queued and `later` has the same type. Return true to drop `later`.
+     */
+    virtual bool merge(const Event& later) {
+        (void)later;
+        return false;
+    }
+
     Type type() const { return type_; }
     bool isAccepted() const { return accepted_; }
     void accept() { accepted_ = true; }
@@ -45,6 +75,22 @@ private:
     int timerId_;
 };
 
+// Completion of an asynchronous read or write, see EventDispatcherUring
+class IoCompletionEvent : public Event {
+public:
+    IoCompletionEvent(uint64_t requestId, int64_t result, const uint8_t* data)
+        : Event(Type::IoCompletion), requestId_(requestId), result_(result), data_(data) {}
+    uint64_t requestId() const { return requestId_; }
+    // Bytes transferred, or -errno
+    int64_t result() const { return result_; }
+    // The bytes read, valid only while the event is delivered; nullptr for writes
+    const uint8_t* data() const { return data_; }
+private:
+    uint64_t requestId_;
+    int64_t result_;
+    const uint8_t* data_;
+};
+
 class ChildEvent : public Event {
 public:
     ChildEvent(Type type, CObject* child) : Event(type), child_(child) {}
@@ -53,18 +99,62 @@ private:
     CObject* child_;
 };
 
+namespace detail {
+
+// Values of common property and argument types compare by value; anything
+// else never compares equal
+template<typename... T>
+bool sameAny(const std::any& a, const std::any& b) {
+    if (a.type() != b.type()) {
+        return false;
+    }
+    if (!a.has_value()) {
+        return true;
+    }
+    bool equal = false;
+    ((a.type() == typeid(T) && (equal = *std::any_cast<T>(&a) == *std::any_cast<T>(&b), true)) || ...);
+    return equal;
+}
+
+inline bool sameArgument(const std::any& a, const std::any& b) {
+    return sameAny<bool, char, int, unsigned, long, unsigned long, long long, unsigned long long,
+                   float, double, std::string>(a, b);
+}
+
+} // namespace detail
+
 class MetaCallEvent : public Event {
 public:
     MetaCallEvent(const char* slot, std::vector<std::any> args)
         : Event(Type::MetaCall), slot_(slot), args_(std::move(args)), promise_(nullptr) {}
+    // A typed connection's call, already bound to its receiver and arguments
+    explicit MetaCallEvent(std::function<void()> call)
+        : Event(Type::MetaCall), call_(std::move(call)), promise_(nullptr) {}
     const char* slot() const { return slot_.c_str(); }
     const std::vector<std::any>& args() const { return args_; }
+    const std::function<void()>& call() const { return call_; }
     void setPromise(std::shared_ptr<std::promise<void>> promise) { promise_ = promise; }
     std::shared_ptr<std::promise<void>> promise() const { return promise_; }
 
+    // Identical by-name calls collapse; typed and blocking calls never do
+    bool merge(const Event& later) override {
+        const auto& other = static_cast<const MetaCallEvent&>(later);
+        if (call_ || other.call_ || promise_ || other.promise_ ||
+            slot_ != other.slot_ || args_.size() != other.args_.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < args_.size(); ++i) {
+            if (!detail::sameArgument(args_[i], other.args_[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
 private:
     std::string slot_;  // Store as string to avoid dangling pointer
     std::vector<std::any> args_;
+    std::function<void()> call_;
     std::shared_ptr<std::promise<void>> promise_;
 };
 
@@ -9,6 +9,20 @@ enum class SocketNotifierType {
     Exception
 };
 
+/**
+ * @brief Which dispatcher CApplication creates on Linux
+ *
+ * Default is the GLib one, or epoll in builds without GLib, where GLib
+ * also falls back to epoll. IoUring is epoll plus asynchronous file and
+ * socket I/O, see EventDispatcherUring. Other platforms ignore the choice.
+ */
+enum class EventDispatcherBackend {
+    Default,
+    GLib,
+    Epoll,
+    IoUring
+};
+
 struct SocketNotifier {
     int socket;
     SocketNotifierType type;
@@ -0,0 +1,95 @@
+#pragma once
+#include "event_dispatcher.hpp"
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SAK {
+
+/**
+ * @brief Linux dispatcher built on epoll, without GLib
+ *
+ * One epoll instance watches the socket notifiers, an eventfd for
+ * wakeUp() and a single timerfd armed for the earliest timer, so an
+ * iteration costs one epoll_wait() plus the work for what is ready,
+ * however many notifiers and timers are registered.
+ *
+ * Notifiers on the same socket share one epoll registration. In
+ * edge-triggered mode a socket is reported once per readiness change:
+ * receivers must then read or write until EAGAIN, or they will not be
+ * told again.
+ */
+class EventDispatcherEpoll : public EventDispatcher {
+public:
+    DECLARE_OBJECT(EventDispatcherEpoll)
+public:
+    enum class Trigger { Level, Edge };
+
+    explicit EventDispatcherEpoll(CObject* parent = nullptr);
+    explicit EventDispatcherEpoll(Trigger trigger, CObject* parent = nullptr);
+    ~EventDispatcherEpoll() override;
+
+    EventDispatcherEpoll(const EventDispatcherEpoll&) = delete;
+    EventDispatcherEpoll& operator=(const EventDispatcherEpoll&) = delete;
+
+    /// Blocks until a socket, a timer or wakeUp() needs attention
+    bool processEvents() override;
+    void wakeUp() override;
+    void interrupt() override;
+
+    void registerTimer(int timerId, int64_t interval, CObject* receiver) override;
+    bool unregisterTimer(int timerId) override;
+    bool unregisterTimers(CObject* object) override;
+    int remainingTime(int timerId) override;
+
+    void registerSocketNotifier(SocketNotifier* notifier) override;
+    void unregisterSocketNotifier(SocketNotifier* notifier) override;
+
+    /// Creates the epoll instance, the eventfd and the timerfd
+    void startingUp() override;
+    void shuttingDown() override;
+
+    Trigger trigger() const { return trigger_; }
+
+protected:
+    /// Called by processEvents() right before it waits
+    virtual void aboutToWait() {}
+    /// Adds `fd` to the epoll set, level-triggered; its readiness is
+    /// reported to internalEvent() rather than to a notifier
+    bool watchInternal(int fd);
+    void unwatchInternal(int fd);
+    virtual void internalEvent(int fd) { (void)fd; }
+
+private:
+    struct Timer {
+        int64_t interval;
+        int64_t deadline;
+        CObject* receiver;
+    };
+
+    // The notifiers registered on one socket, by SocketNotifierType
+    struct Socket {
+        SocketNotifier* notifiers[3] = {nullptr, nullptr, nullptr};
+    };
+
+    uint32_t interestFor(const Socket& socket) const;
+    void dispatchSocket(int fd, uint32_t events);
+    void activateTimers();
+    // Arms the timerfd for the earliest deadline, or disarms it
+    void armTimer();
+
+    const Trigger trigger_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    int timerFd_ = -1;
+    std::unordered_map<int, Timer> timers_;
+    // (deadline, timer id), earliest first
+    std::set<std::pair<int64_t, int>> deadlines_;
+    int64_t armedDeadline_ = -1;
+    std::unordered_map<int, Socket> sockets_;
+    std::vector<int> internalFds_;
+};
+
+}
@@ -17,6 +17,10 @@ public:
     explicit EventDispatcherLinux(GMainContext *context, CObject* parent = nullptr);
     ~EventDispatcherLinux();
 
+    /// A dispatcher on a new GMainContext of its own, for loops on
+    /// threads other than the main one
+    static EventDispatcherLinux* createForThread(CObject* parent = nullptr);
+
     bool processEvents() override;
     void wakeUp() override;
     void interrupt() override;
@@ -39,6 +43,7 @@ private:
     GTimerSource *timerSource_;
     GIdleTimerSource *idleTimerSource_;
     bool wakeUpCalled_ = true;
+    bool ownsContext_ = false;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include "event_dispatcher_epoll.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SAK {
+
+/**
+ * @brief Epoll dispatcher that also runs asynchronous reads and writes on
+ *        an io_uring
+ *
+ * read() and write() queue a request and return its id; the result comes
+ * back as an IoCompletionEvent sent to the receiver from processEvents(),
+ * on the loop's thread. Requests queued during one iteration are submitted
+ * together with a single io_uring_enter() before the next wait, and the
+ * ring signals completions through an eventfd in the epoll set, so file
+ * I/O, sockets and timers share one wait.
+ *
+ * Transfers go through buffers taken from MemoryPoolV2 and registered with
+ * the ring, so the kernel does not map user pages per request; larger
+ * transfers, or more than the registered buffers at once, use plain pool
+ * buffers. Data read is only valid while its event is delivered.
+ *
+ * Where io_uring is unavailable (old kernels, seccomp) requests run
+ * synchronously on submission and still complete through events.
+ *
+ * Not thread-safe: use it from the thread running the loop.
+ */
+class EventDispatcherUring : public EventDispatcherEpoll {
+public:
+    DECLARE_OBJECT(EventDispatcherUring)
+public:
+    /// Offset for sockets, pipes and other unseekable descriptors
+    static constexpr uint64_t kCurrentPosition = ~uint64_t(0);
+
+    explicit EventDispatcherUring(CObject* parent = nullptr);
+    EventDispatcherUring(unsigned entries, std::size_t bufferSize, unsigned bufferCount,
+                         CObject* parent = nullptr);
+    ~EventDispatcherUring() override;
+
+    /// Reads up to `len` bytes of `fd` at `offset`; 0 if nothing was queued
+    uint64_t read(int fd, uint64_t offset, std::size_t len, CObject* receiver);
+    /// Writes a copy of `data`, so it need not outlive the call
+    uint64_t write(int fd, uint64_t offset, const void* data, std::size_t len, CObject* receiver);
+    /**
+     * @brief Drop the completions of `receiver`'s requests
+     *
+     * The requests still run; call this before deleting a receiver that
+     * has some outstanding.
+     */
+    void cancelRequests(CObject* receiver);
+    std::size_t pendingRequests() const { return requests_.size(); }
+    /// Whether requests go to an io_uring rather than running synchronously
+    bool ringAvailable() const { return ring_ != nullptr; }
+
+    void startingUp() override;
+    /// Waits for outstanding requests, cancelling what the kernel can
+    void shuttingDown() override;
+
+protected:
+    void aboutToWait() override;
+    void internalEvent(int fd) override;
+
+private:
+    struct Ring;
+
+    struct Request {
+        CObject* receiver;
+        uint8_t* buffer;
+        std::size_t size;
+        // Registered buffer index, or -1 for a plain pool buffer
+        int bufferIndex;
+        bool isRead;
+    };
+
+    uint64_t submit(int fd, uint64_t offset, std::size_t len, const void* data,
+                    CObject* receiver, bool isRead);
+    void runSynchronously(uint64_t id, int fd, uint64_t offset, const Request& request);
+    void complete(uint64_t id, int64_t result);
+    void releaseBuffer(const Request& request);
+
+    const unsigned entries_;
+    const std::size_t bufferSize_;
+    const unsigned bufferCount_;
+    Ring* ring_ = nullptr;
+    int completionFd_ = -1;
+    uint8_t* buffers_ = nullptr;
+    bool buffersRegistered_ = false;
+    std::vector<int> freeBuffers_;
+    uint64_t nextId_ = 1;
+    std::unordered_map<uint64_t, Request> requests_;
+    // Results of requests run synchronously, delivered like completions
+    std::vector<std::pair<uint64_t, int64_t>> finished_;
+};
+
+}
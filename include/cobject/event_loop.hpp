@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "event.hpp"
+#include "epoch.hpp"
+#include "instrusive_list.hpp"
+#include "memory_pool_v2.hpp"
+#include "mpsc_queue.hpp"
+#include "spin_mutex.hpp"
+
+namespace SAK {
+
+class CObject;
+class EventDispatcher;
+
+/**
+ * @brief One queued event
+ *
+ * Pushed onto the MPSC queue of the receiver's thread, then linked into
+ * that thread's pending queue and into the receiver's own list, so
+ * removing a receiver's events touches only those events.
+ */
+struct PostedEvent : mpsc_node {
+    PostedEvent(CObject* receiver, Event* event) : receiver(receiver), event(event) {}
+
+    static void* operator new(std::size_t size) {
+        void* ptr = MemoryPoolV2::GetInstance().Allocate(size);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        MemoryPoolV2::GetInstance().Deallocate(ptr, size);
+    }
+
+    CObject* receiver;  // nullptr for ThreadData::postCall()
+    Event* event;
+    InstrusiveListNode queue_node;
+    InstrusiveListNode receiver_node;
+};
+
+using PostedEventQueue = MemptrInstrusiveList<PostedEvent, PostedEvent, &PostedEvent::queue_node>;
+using PostedEventList = MemptrInstrusiveList<PostedEvent, PostedEvent, &PostedEvent::receiver_node>;
+
+/**
+ * @brief The event state of one thread
+ *
+ * Every CObject references the ThreadData of the thread it lives in.
+ * Events posted to it are pushed onto that thread's lock-free MPSC queue
+ * and delivered by the loop running there; posters never share a lock
+ * with each other or with another thread's loop.
+ *
+ * Instances are reference counted and freed through an epoch domain, so a
+ * poster that read an object's ThreadData under ThreadData::pin() can use
+ * it even if the object moves to another thread meanwhile.
+ *
+ * An object's posted_events_ list is guarded by the lock of the ThreadData
+ * it lives in, and its ThreadData only changes with both the old and the
+ * new lock held.
+ */
+class ThreadData {
+public:
+    /// The calling thread's data, created on first use
+    static ThreadData* current();
+    /// The data of `thread`, created if that thread has none yet. The
+    /// caller owns the returned reference.
+    static ThreadData* get(std::thread::id thread);
+    /// Guards ThreadData pointers read from shared state
+    static epoch_guard pin();
+
+    std::thread::id id() const { return id_; }
+    void ref() noexcept;
+    void deref() noexcept;
+
+    /// Queues `event` for `receiver`'s thread; takes ownership of `event`
+    static void postEvent(CObject* receiver, Event* event);
+    /// Queues an event with no receiver on this thread; `event` must be a
+    /// MetaCallEvent carrying a call
+    void postCall(Event* event);
+    /**
+     * @brief Drop queued events
+     *
+     * For one receiver the cost is proportional to that receiver's queued
+     * events, and nothing is locked if it has none. With a null receiver
+     * the matching events of every thread are removed.
+     */
+    static void removePostedEvents(CObject* receiver, Event::Type type = Event::Type::None);
+
+    /**
+     * @brief Delivers the events queued before this call
+     *
+     * Must run on this thread. Events posted while it runs wait for the
+     * next call, so a handler that keeps posting cannot starve the loop;
+     * a non-zero `maxEvents` bounds the batch further. Returns the number
+     * of events delivered.
+     */
+    std::size_t processPostedEvents(std::size_t maxEvents = 0);
+
+    /// Events queued or in flight for this thread
+    bool hasPendingEvents() const { return queued_.load(std::memory_order_acquire) != 0; }
+
+    /**
+     * @brief Collapse events as they are queued
+     *
+     * An event whose type matches the receiver's last queued event is
+     * offered to that event's Event::merge() and dropped if absorbed.
+     */
+    void setCoalescing(bool enabled) { coalesce_.store(enabled, std::memory_order_relaxed); }
+    bool coalescing() const { return coalesce_.load(std::memory_order_relaxed); }
+    /// Events dropped by coalescing since the last call
+    std::size_t takeCoalesced() { return coalesced_.exchange(0, std::memory_order_relaxed); }
+
+    /// The dispatcher of the loop running on this thread, if any
+    EventDispatcher* dispatcher() const;
+    /// Returns the previous dispatcher
+    EventDispatcher* setDispatcher(EventDispatcher* dispatcher);
+    void wakeUp() const;
+
+private:
+    friend class CObject;
+
+    explicit ThreadData(std::thread::id id) : id_(id) {}
+    ~ThreadData();
+
+    void enqueue(CObject* receiver, Event* event);
+    // Locks the ThreadData `object` lives in and returns it
+    static ThreadData* lockOwner(const CObject* object, std::unique_lock<std::mutex>& lock);
+    void removeAll(Event::Type type);
+    // Moves `object` and its queued events to `target`, in order
+    static void moveObject(CObject* object, ThreadData* target);
+    // Caller holds pending_mutex_
+    void drainIncoming();
+    void unlink(PostedEvent* pe);
+    bool coalesceInto(CObject* receiver, PostedEvent* pe);
+
+    const std::thread::id id_;
+    std::atomic<int> refs_{1};
+    mpsc_queue<PostedEvent> incoming_;
+    // Popped from incoming_ but not delivered yet; also serializes the
+    // consumers of incoming_
+    std::mutex pending_mutex_;
+    PostedEventQueue pending_;
+    mutable spin_rw_mutex dispatcher_mutex_;
+    EventDispatcher* dispatcher_ = nullptr;
+    // Every PostedEvent in incoming_ or pending_
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<bool> coalesce_{false};
+    std::atomic<std::size_t> coalesced_{0};
+};
+
+/**
+ * @brief Runs a dispatcher and the posted events of the calling thread
+ *
+ * CApplication::exec() runs one on the thread that calls it; worker
+ * threads that own CObjects run their own, so queued calls to those
+ * objects execute there:
+ *
+ *     std::thread worker([&]() {
+ *         EventLoop loop;
+ *         obj->moveToThread(std::this_thread::get_id());
+ *         loop.exec();
+ *     });
+ */
+class EventLoop {
+public:
+    /**
+     * @brief Counters for tuning the budget and coalescing
+     *
+     * ioTime is spent in the dispatcher, waiting for I/O and timers
+     * included; eventTime is spent delivering posted events.
+     */
+    struct Stats {
+        uint64_t iterations = 0;
+        uint64_t events = 0;
+        uint64_t coalesced = 0;
+        uint64_t maxEventsPerIteration = 0;
+        // Iterations that left queued events for the next one
+        uint64_t budgetExhausted = 0;
+        std::chrono::nanoseconds ioTime{0};
+        std::chrono::nanoseconds eventTime{0};
+
+        double eventsPerIteration() const {
+            return iterations ? static_cast<double>(events) / static_cast<double>(iterations) : 0.0;
+        }
+    };
+
+    /// Without a dispatcher the loop creates the platform one and owns it
+    explicit EventLoop(EventDispatcher* dispatcher = nullptr);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    int exec();
+    /// Thread-safe
+    void quit() { exit(0); }
+    void exit(int returnCode = 0);
+
+    bool isRunning() const { return thread_.load(std::memory_order_acquire) != nullptr; }
+    /// The ThreadData of the thread running exec(), or nullptr. Only valid
+    /// under ThreadData::pin().
+    ThreadData* threadData() const { return thread_.load(std::memory_order_acquire); }
+
+    EventDispatcher* dispatcher() const { return dispatcher_; }
+    /// Not while the loop runs; a borrowed dispatcher is never deleted
+    void setDispatcher(EventDispatcher* dispatcher);
+
+    static EventDispatcher* createPlatformDispatcher(CObject* parent = nullptr);
+
+    /**
+     * @brief Posted events delivered per iteration at most, 0 for no limit
+     *
+     * Whatever is left waits until the dispatcher has polled once more,
+     * without blocking, so a flood of posted events cannot starve I/O.
+     */
+    void setEventBudget(std::size_t maxEvents) { budget_.store(maxEvents, std::memory_order_relaxed); }
+    std::size_t eventBudget() const { return budget_.load(std::memory_order_relaxed); }
+
+    /// See ThreadData::setCoalescing(); applies to the thread running the loop
+    void setCoalescing(bool enabled);
+    bool coalescing() const { return coalesce_.load(std::memory_order_relaxed); }
+
+    /// Thread-safe; each counter is read on its own
+    Stats stats() const;
+    void resetStats();
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> iterations{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> coalesced{0};
+        std::atomic<uint64_t> maxEventsPerIteration{0};
+        std::atomic<uint64_t> budgetExhausted{0};
+        std::atomic<int64_t> ioNanos{0};
+        std::atomic<int64_t> eventNanos{0};
+    };
+
+    EventDispatcher* dispatcher_;
+    bool ownsDispatcher_;
+    std::atomic<std::size_t> budget_{0};
+    std::atomic<bool> coalesce_{false};
+    Counters counters_;
+    std::atomic<bool> quit_{false};
+    std::atomic<int> returnCode_{0};
+    std::atomic<ThreadData*> thread_{nullptr};
+};
+
+} // namespace SAK
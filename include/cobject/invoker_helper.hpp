@@ -1,6 +1,7 @@
 #pragma once
 
 #include <any>
+#include <cstddef>
 #include <vector>
 #include <functional>
 #include <utility>
@@ -10,135 +11,45 @@ namespace SAK {
 
 class CObject;
 
-// 0-arity
-template <typename R, typename Class>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)()) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (!args.empty()) return std::any{};
-        Class* instance = static_cast<Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)();
-            return std::any{};
-        } else {
-            R ret = (instance->*method)();
-            return std::any(std::move(ret));
-        }
-    };
-}
+namespace detail {
 
-template <typename R, typename Class>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)() const) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (!args.empty()) return std::any{};
-        const Class* instance = static_cast<const Class*>(obj);
+template <typename... Args>
+struct unpack_args {
+    // Reference parameters bind straight to the value held by the std::any;
+    // by-value parameters are copied from it once
+    template <typename R, typename Instance, typename Method, std::size_t... I>
+    static std::any call(Instance* instance, Method method, const std::vector<std::any>& args,
+                         std::index_sequence<I...>) {
         if constexpr (std::is_void_v<R>) {
-            (instance->*method)();
+            (instance->*method)(std::any_cast<const std::decay_t<Args>&>(args[I])...);
             return std::any{};
         } else {
-            R ret = (instance->*method)();
-            return std::any(std::move(ret));
+            return std::any((instance->*method)(std::any_cast<const std::decay_t<Args>&>(args[I])...));
         }
-    };
-}
+    }
+};
 
-// 1-arity
-template <typename R, typename Class, typename A1>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1)) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 1) return std::any{};
-        Class* instance = static_cast<Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]));
-            return std::any(std::move(ret));
-        }
-    };
-}
+} // namespace detail
 
-template <typename R, typename Class, typename A1>
+// Any arity. A call with the wrong number of arguments does nothing and
+// returns an empty std::any; a wrong argument type throws std::bad_any_cast.
+template <typename R, typename Class, typename... Args>
 std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1) const) {
+make_invoker(R (Class::*method)(Args...)) {
     return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 1) return std::any{};
-        const Class* instance = static_cast<const Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]));
-            return std::any(std::move(ret));
-        }
+        if (args.size() != sizeof...(Args)) return std::any{};
+        return detail::unpack_args<Args...>::template call<R>(
+            static_cast<Class*>(obj), method, args, std::index_sequence_for<Args...>());
     };
 }
 
-// 2-arity
-template <typename R, typename Class, typename A1, typename A2>
+template <typename R, typename Class, typename... Args>
 std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1, A2)) {
+make_invoker(R (Class::*method)(Args...) const) {
     return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 2) return std::any{};
-        Class* instance = static_cast<Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]));
-            return std::any(std::move(ret));
-        }
-    };
-}
-
-template <typename R, typename Class, typename A1, typename A2>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1, A2) const) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 2) return std::any{};
-        const Class* instance = static_cast<const Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]));
-            return std::any(std::move(ret));
-        }
-    };
-}
-
-// 3-arity (extendable)
-template <typename R, typename Class, typename A1, typename A2, typename A3>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1, A2, A3)) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 3) return std::any{};
-        Class* instance = static_cast<Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]), std::any_cast<A3>(args[2]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]), std::any_cast<A3>(args[2]));
-            return std::any(std::move(ret));
-        }
-    };
-}
-
-template <typename R, typename Class, typename A1, typename A2, typename A3>
-std::function<std::any(CObject*, const std::vector<std::any>&)>
-make_invoker(R (Class::*method)(A1, A2, A3) const) {
-    return [method](CObject* obj, const std::vector<std::any>& args) -> std::any {
-        if (args.size() != 3) return std::any{};
-        const Class* instance = static_cast<const Class*>(obj);
-        if constexpr (std::is_void_v<R>) {
-            (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]), std::any_cast<A3>(args[2]));
-            return std::any{};
-        } else {
-            R ret = (instance->*method)(std::any_cast<A1>(args[0]), std::any_cast<A2>(args[1]), std::any_cast<A3>(args[2]));
-            return std::any(std::move(ret));
-        }
+        if (args.size() != sizeof...(Args)) return std::any{};
+        return detail::unpack_args<Args...>::template call<R>(
+            static_cast<const Class*>(obj), method, args, std::index_sequence_for<Args...>());
     };
 }
 
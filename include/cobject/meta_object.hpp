@@ -6,6 +6,9 @@
 #include <any>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 
 namespace SAK {
 
@@ -14,15 +17,35 @@ class MetaProperty;
 class MetaMethod;
 class MetaSignal;
 
+/**
+ * @brief Process-wide table that interns signal, slot and property names
+ *
+ * Every distinct name gets a small dense id the first time it is
+ * registered, so connections compare integers instead of strings. Ids are
+ * never recycled and name() stays valid for the life of the process.
+ */
+class MetaNames {
+public:
+    static constexpr int kInvalid = -1;
+
+    static int intern(std::string_view name);
+    // kInvalid for a name that was never interned
+    static int find(std::string_view name);
+    static const char* name(int id);
+};
+
 class MetaProperty {
 public:
     using Getter = std::function<std::any(const CObject*)>;
     using Setter = std::function<void(CObject*, const std::any&)>;
     using NotifySignal = std::function<void(CObject*)>;
     
-    MetaProperty(const char* name, const char* typeName, Getter getter, Setter setter, NotifySignal notifySignal = nullptr)
-        : name_(name), type_name_(typeName), getter_(getter), setter_(setter), notify_signal_(notifySignal) {}
+    MetaProperty(const char* name, const char* typeName, Getter getter, Setter setter, NotifySignal notifySignal = nullptr,
+                 int id = MetaNames::kInvalid)
+        : name_(name), type_name_(typeName), getter_(getter), setter_(setter), notify_signal_(notifySignal),
+          id_(id != MetaNames::kInvalid ? id : MetaNames::intern(name)) {}
     const char* name() const { return name_; }
+    int id() const { return id_; }
     const char* typeName() const { return type_name_; }
     
     std::any get(const CObject* object) const { return getter_(object); }
@@ -45,14 +68,17 @@ private:
     Getter getter_;
     Setter setter_;
     NotifySignal notify_signal_;
+    int id_;
 };
 
 class MetaMethod {
 public:
     using Invoker = std::function<std::any(CObject*, const std::vector<std::any>&)>;
-    MetaMethod(const char* name, const char* signature, Invoker invoker)
-        : name_(name), signature_(signature), invoker_(invoker) {}
+    MetaMethod(const char* name, const char* signature, Invoker invoker, int id = MetaNames::kInvalid)
+        : name_(name), signature_(signature), invoker_(invoker),
+          id_(id != MetaNames::kInvalid ? id : MetaNames::intern(name)) {}
     const char* name() const { return name_; }
+    int id() const { return id_; }
     const char* signature() const { return signature_; }
     std::any invoke(CObject* object, const std::vector<std::any>& args) const { 
         if (invoker_ && object) {
@@ -64,15 +90,18 @@ private:
     const char* name_;
     const char* signature_;
     Invoker invoker_;
+    int id_;
 };
 
 class MetaSignal {
 public:
     using Invoker = std::function<void(CObject*, const std::vector<std::any>&)>;
 
-    MetaSignal(const char* name, const char* signature, Invoker invoker)
-        : name_(name), signature_(signature), invoker_(invoker) {}
+    MetaSignal(const char* name, const char* signature, Invoker invoker, int id = MetaNames::kInvalid)
+        : name_(name), signature_(signature), invoker_(invoker),
+          id_(id != MetaNames::kInvalid ? id : MetaNames::intern(name)) {}
     const char* name() const { return name_; }
+    int id() const { return id_; }
     const char* signature() const { return signature_; }
     void invoke(CObject* object, const std::vector<std::any>& args) const { 
         if (invoker_ && object) {
@@ -83,6 +112,7 @@ private:
     const char* name_;
     const char* signature_;
     Invoker invoker_;
+    int id_;
 };
 
 class MetaObject {
@@ -93,33 +123,55 @@ public:
     const char* className() const { return className_; }
     const MetaObject* parent() const { return parent_; }
     CObject* createInstance() const;
+    const FactoryFunc& factory() const { return factory_; }
 
     int propertyCount() const { return static_cast<int>(properties_.size()); }
     const MetaProperty* property(int index) const {
         return (index >= 0 && index < propertyCount()) ? &properties_[index] : nullptr;
     }
-    const MetaProperty* findProperty(const std::string& name) const;
+    // Lookups search this class and its ancestors, nearest class first
+    const MetaProperty* findProperty(std::string_view name) const;
+    const MetaProperty* findProperty(int id) const;
 
     int methodCount() const { return static_cast<int>(methods_.size()); }
     const MetaMethod* method(int index) const {
         return (index >= 0 && index < methodCount()) ? &methods_[index] : nullptr;
     }
-    const MetaMethod* findMethod(const std::string& name) const;
+    const MetaMethod* findMethod(std::string_view name) const;
+    const MetaMethod* findMethod(int id) const;
 
     int signalCount() const { return static_cast<int>(signals_.size()); }
     const MetaSignal* signal(int index) const {
         return (index >= 0 && index < signalCount()) ? &signals_[index] : nullptr;
     }
-    const MetaSignal* findSignal(const std::string& name) const;
+    const MetaSignal* findSignal(std::string_view name) const;
+    const MetaSignal* findSignal(int id) const;
     bool inherits(const MetaObject* metaObject) const;
 
 private:
+    // Inherited members flattened into one table per kind, keyed by name
+    // id, plus the ids of every member name so lookups by name never touch
+    // the shared MetaNames table
+    struct Index {
+        std::unordered_map<std::string_view, int> ids;
+        std::unordered_map<int, const MetaProperty*> properties;
+        std::unordered_map<int, const MetaMethod*> methods;
+        std::unordered_map<int, const MetaSignal*> signals;
+    };
+
+    // Built on first use: a parent defined in another translation unit may
+    // not be constructed yet when this one is
+    const Index& index() const;
+    int memberId(std::string_view name) const;
+
     const char* className_;
     const MetaObject* parent_;
     FactoryFunc factory_;
     std::vector<MetaProperty> properties_;
     std::vector<MetaMethod> methods_;
     std::vector<MetaSignal> signals_;
+    mutable std::once_flag index_once_;
+    mutable std::unique_ptr<Index> index_;
 };
 
 } // namespace SAK
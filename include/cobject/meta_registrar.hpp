@@ -4,14 +4,13 @@
 #include <functional>
 #include <any>
 #include <string>
+#include "meta_object.hpp"
 
 namespace SAK {
 
 class CObject;
-class MetaProperty;
-class MetaMethod;
-class MetaSignal;
 
+// Names are interned here, at registration, rather than on first lookup
 template<typename T>
 class MetaRegistrar {
 public:
@@ -20,17 +19,20 @@ public:
         const char* typeName;
         std::function<std::any(const CObject*)> getter;
         std::function<void(CObject*, const std::any&)> setter;
+        int id;
     };
     
     struct MethodInfo {
         const char* name;
         const char* signature;
         std::function<std::any(CObject*, const std::vector<std::any>&)> invoker;
+        int id;
     };
     
     struct SignalInfo {
         const char* name;
         const char* signature;
+        int id;
     };
     
     inline static std::vector<PropertyInfo> properties_;
@@ -40,16 +42,16 @@ public:
     static void registerProperty(const char* name, const char* typeName,
                                  std::function<std::any(const CObject*)> getter,
                                  std::function<void(CObject*, const std::any&)> setter) {
-        properties_.push_back({name, typeName, getter, setter});
+        properties_.push_back({name, typeName, getter, setter, MetaNames::intern(name)});
     }
     
     static void registerMethod(const char* name, const char* signature,
                                std::function<std::any(CObject*, const std::vector<std::any>&)> invoker) {
-        methods_.push_back({name, signature, invoker});
+        methods_.push_back({name, signature, invoker, MetaNames::intern(name)});
     }
     
     static void registerSignal(const char* name, const char* signature) {
-        signals_.push_back({name, signature});
+        signals_.push_back({name, signature, MetaNames::intern(name)});
     }
     
     static const std::vector<PropertyInfo>& getProperties() { return properties_; }
@@ -1,32 +1,103 @@
 #pragma once
 
-#include <unordered_map>
-#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <vector>
+#include "meta_object.hpp"
 
 namespace SAK {
 
-class MetaObject;
 class CObject;
 
+/**
+ * @brief A class resolved by name once, for creating many instances
+ *
+ * Holds the class's factory, so create() is one indirect call with no
+ * lookup. Default constructed, or resolved from an unknown name, it is
+ * invalid and create() returns nullptr.
+ */
+class MetaFactory {
+public:
+    using RawFactory = CObject* (*)();
+
+    MetaFactory() = default;
+    explicit MetaFactory(const MetaObject* metaObject);
+
+    bool valid() const { return raw_ || factory_; }
+    explicit operator bool() const { return valid(); }
+    const MetaObject* metaObject() const { return meta_object_; }
+
+    CObject* create() const {
+        if (raw_) {
+            return raw_();
+        }
+        return factory_ ? (*factory_)() : nullptr;
+    }
+
+private:
+    const MetaObject* meta_object_ = nullptr;
+    // The plain function DECLARE_OBJECT factories are, else the std::function
+    RawFactory raw_ = nullptr;
+    const MetaObject::FactoryFunc* factory_ = nullptr;
+};
+
+/**
+ * @brief Classes by name, for creating objects from configuration or plugins
+ *
+ * Lookups take no lock: the names live in an open-addressing table keyed
+ * by their hash whose slots are filled once and published with a release
+ * store. registerMeta() runs under a mutex and, when the table is half
+ * full, publishes a copy twice the size; earlier tables are kept for
+ * readers still probing them, so at most twice the final table is ever
+ * held. Registering a name again replaces its class.
+ */
 class MetaRegistry {
 public:
     static MetaRegistry& instance();
 
     void registerMeta(const MetaObject* metaObject);
-    const MetaObject* findMeta(const std::string& className) const;
-    CObject* createInstance(const std::string& className) const;
+    const MetaObject* findMeta(std::string_view className) const;
+    CObject* createInstance(std::string_view className) const;
+    // Resolve once, then create() repeatedly
+    MetaFactory factory(std::string_view className) const;
     std::vector<std::string> registeredClasses() const;
-    bool isClassRegistered(const std::string& className) const;
+    bool isClassRegistered(std::string_view className) const;
     
 private:
-    MetaRegistry() = default;
+    struct Slot {
+        // Set once, released after hash; replaced for a re-registered name
+        std::atomic<const MetaObject*> meta{nullptr};
+        std::atomic<uint64_t> hash{0};
+    };
+
+    struct Table {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        size_t used = 0;
+    };
+
+    static constexpr size_t kInitialCapacity = 64;
+
+    MetaRegistry();
     ~MetaRegistry() = default;
     MetaRegistry(const MetaRegistry&) = delete;
     MetaRegistry& operator=(const MetaRegistry&) = delete;
 
-    std::unordered_map<std::string, const MetaObject*> metaMap_;
+    static uint64_t hashOf(std::string_view className);
+    // Writers only: the slot holding className, or the empty one it goes into
+    static Slot& probe(Table& table, std::string_view className, uint64_t hash);
+    static void fill(Table& table, Slot& slot, const MetaObject* metaObject, uint64_t hash);
+
+    std::atomic<Table*> table_;
+    // Every table published, the current one last
+    std::vector<std::unique_ptr<Table>> tables_;
     mutable std::mutex mutex_;
 };
 
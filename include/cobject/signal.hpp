@@ -0,0 +1,133 @@
+#pragma once
+
+#include <any>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "meta_object.hpp"
+
+namespace SAK {
+
+class CObject;
+
+/**
+ * @brief A slot bound at compile time to the argument types of a Signal
+ *
+ * Typed connections store one of these instead of going through
+ * MetaMethod: emission hands it a pointer to the signal's argument tuple
+ * and it calls the slot directly, with no std::any boxing.
+ */
+class SlotThunk {
+public:
+    virtual ~SlotThunk() = default;
+
+    // void(Args...) of the signal it was connected to, decayed
+    virtual const std::type_info& signature() const = 0;
+    // `args` points at the emitting Signal's ArgsTuple
+    virtual void invoke(CObject* receiver, const void* args) const = 0;
+    // Copies the arguments so the call can run later in another thread
+    virtual std::function<void()> bind(CObject* receiver, const void* args) const = 0;
+    // Dynamic emission (emitSignal by name) of the same signal
+    virtual void invokeAny(CObject* receiver, const std::vector<std::any>& args) const = 0;
+    virtual bool equals(const SlotThunk& other) const = 0;
+};
+
+namespace detail {
+
+using BoxArgs = std::vector<std::any> (*)(const void* args);
+
+// Defined by ConnectionManager. `box` converts the argument tuple for
+// slots connected by name and is only called if one is connected.
+void activate(const CObject* sender, int signal, const void* args,
+              const std::type_info& signature, BoxArgs box);
+
+} // namespace detail
+
+/**
+ * @brief A signal declared as a data member, emitted by calling it
+ *
+ * Declare it with TYPED_SIGNAL so the name is registered as well; it can
+ * then be connected by name like any SIGNAL, or type-checked through
+ * CObject::connect(sender, &Sender::signal, receiver, &Receiver::slot).
+ */
+template<typename... Args>
+class Signal {
+public:
+    using Signature = void(std::decay_t<Args>...);
+    using ArgsTuple = std::tuple<const std::decay_t<Args>&...>;
+
+    Signal(const CObject* owner, const char* name)
+        : owner_(owner), id_(MetaNames::intern(name)) {}
+
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+
+    int id() const { return id_; }
+
+    void operator()(const std::decay_t<Args>&... args) const {
+        ArgsTuple tuple(args...);
+        detail::activate(owner_, id_, &tuple, typeid(Signature), &box);
+    }
+
+private:
+    static std::vector<std::any> box(const void* args) {
+        return std::apply([](const auto&... values) { return std::vector<std::any>{std::any(values)...}; },
+                          *static_cast<const ArgsTuple*>(args));
+    }
+
+    const CObject* owner_;
+    int id_;
+};
+
+template<typename Receiver, typename Method, typename... Args>
+class MemberSlotThunk final : public SlotThunk {
+public:
+    static_assert(std::is_invocable_v<Method, Receiver*, const std::decay_t<Args>&...>,
+                  "slot cannot be called with the signal's arguments");
+
+    explicit MemberSlotThunk(Method slot) : slot_(slot) {}
+
+    const std::type_info& signature() const override {
+        return typeid(typename Signal<Args...>::Signature);
+    }
+
+    void invoke(CObject* receiver, const void* args) const override {
+        std::apply([this, receiver](const auto&... values) {
+            std::invoke(slot_, static_cast<Receiver*>(receiver), values...);
+        }, *static_cast<const typename Signal<Args...>::ArgsTuple*>(args));
+    }
+
+    std::function<void()> bind(CObject* receiver, const void* args) const override {
+        std::tuple<std::decay_t<Args>...> copy = *static_cast<const typename Signal<Args...>::ArgsTuple*>(args);
+        return [slot = slot_, receiver, copy = std::move(copy)]() {
+            std::apply([slot, receiver](const auto&... values) {
+                std::invoke(slot, static_cast<Receiver*>(receiver), values...);
+            }, copy);
+        };
+    }
+
+    void invokeAny(CObject* receiver, const std::vector<std::any>& args) const override {
+        if (args.size() == sizeof...(Args)) {
+            invokeAny(receiver, args, std::index_sequence_for<Args...>());
+        }
+    }
+
+    bool equals(const SlotThunk& other) const override {
+        auto* same = dynamic_cast<const MemberSlotThunk*>(&other);
+        return same && same->slot_ == slot_;
+    }
+
+private:
+    template<size_t... I>
+    void invokeAny(CObject* receiver, const std::vector<std::any>& args, std::index_sequence<I...>) const {
+        std::invoke(slot_, static_cast<Receiver*>(receiver),
+                    std::any_cast<const std::decay_t<Args>&>(args[I])...);
+    }
+
+    Method slot_;
+};
+
+} // namespace SAK
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "spin_mutex.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Monotonic bump allocator for request-scoped data
+ *
+ * Memory is carved sequentially out of blocks obtained from MemoryPoolV2
+ * (its medium path by default, the large path for oversized blocks).
+ * Individual allocations are never freed; Reset() releases everything at
+ * once and keeps the first block for the next request.
+ *
+ * Not thread-safe: an arena belongs to one request or one thread at a time.
+ * Destructors of objects placed in the arena are not run.
+ */
+class Arena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    /**
+     * @param block_size Size of each block requested from MemoryPoolV2,
+     *        including the block header
+     */
+    explicit Arena(size_t block_size = kDefaultBlockSize);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+
+    /**
+     * @brief Allocate `bytes` with the given power-of-two alignment
+     *
+     * @return Pointer to the memory, or nullptr if a new block could not be obtained
+     */
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(ptr_) + alignment - 1) & ~(alignment - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+        if (ptr_ && aligned <= end && bytes <= end - aligned) {
+            ptr_ = reinterpret_cast<char*>(aligned + bytes);
+            bytes_used_ += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+        return AllocateSlow(bytes, alignment);
+    }
+
+    /**
+     * @brief Copy `size` bytes into the arena
+     */
+    void* Copy(const void* data, size_t size, size_t alignment = 1);
+
+    /**
+     * @brief Construct a trivially destructible object in the arena
+     */
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena never runs destructors; use ArenaAllocator with a container instead");
+        void* mem = Allocate(sizeof(T), alignof(T));
+        return mem ? new (mem) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * @brief Release all allocations; one standard-sized block is kept for reuse
+     */
+    void Reset();
+
+    /// Bytes handed out by Allocate() since the last Reset()
+    size_t BytesUsed() const { return bytes_used_; }
+    /// Bytes held in blocks, including block headers
+    size_t BytesReserved() const { return bytes_reserved_; }
+    /// Reserved bytes not handed out: alignment padding, block tails and headers
+    size_t BytesWasted() const { return bytes_reserved_ - bytes_used_; }
+    size_t BlockCount() const { return block_count_; }
+    size_t BlockSize() const { return block_size_; }
+
+private:
+    friend class ConcurrentArena;
+
+    struct Block {
+        Block* next;
+        size_t size;  // Including this header
+    };
+    static constexpr size_t kHeaderSize =
+        (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    void* AllocateSlow(size_t bytes, size_t alignment);
+    Block* NewBlock(size_t size);
+    void FreeBlocks(Block* block);
+
+    size_t block_size_;
+    Block* head_ = nullptr;       // Current block for bump allocation, chained to older ones
+    char* ptr_ = nullptr;
+    char* end_ = nullptr;
+    size_t bytes_used_ = 0;
+    size_t bytes_reserved_ = 0;
+    size_t block_count_ = 0;
+};
+
+/**
+ * @brief Arena shared by concurrent writers
+ *
+ * The underlying Arena hands out whole chunks of about a block each; threads
+ * bump-allocate inside the current chunk with a single fetch_add and only
+ * take the spin lock to install the next chunk or to place an allocation
+ * too large for one. Threads filling one structure, such as a MemTable's
+ * skip list, can share an arena this way. The byte counters can be read at
+ * any time.
+ */
+class ConcurrentArena {
+public:
+    explicit ConcurrentArena(size_t block_size = Arena::kDefaultBlockSize);
+
+    ConcurrentArena(const ConcurrentArena&) = delete;
+    ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (void* ptr = TryBump(chunk_.load(std::memory_order_acquire), bytes, alignment)) {
+            bytes_used_.fetch_add(bytes, std::memory_order_relaxed);
+            return ptr;
+        }
+        return AllocateSlow(bytes, alignment);
+    }
+
+    size_t BytesUsed() const { return bytes_used_.load(std::memory_order_relaxed); }
+    size_t BytesReserved() const { return bytes_reserved_.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        std::atomic<size_t> offset;
+        size_t size;  // Usable bytes following this header
+    };
+
+    static void* TryBump(Chunk* chunk, size_t bytes, size_t alignment) {
+        // The worst-case padding is claimed with the bytes so one fetch_add suffices
+        size_t claim = bytes + alignment - 1;
+        if (!chunk || claim > chunk->size) {
+            return nullptr;
+        }
+        size_t offset = chunk->offset.fetch_add(claim, std::memory_order_relaxed);
+        if (offset > chunk->size - claim) {
+            return nullptr;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(chunk + 1) + offset;
+        return reinterpret_cast<void*>((start + alignment - 1) & ~(alignment - 1));
+    }
+
+    void* AllocateSlow(size_t bytes, size_t alignment);
+
+    spin_mutex mutex_;
+    Arena arena_;
+    size_t chunk_size_;
+    std::atomic<Chunk*> chunk_{nullptr};
+    std::atomic<size_t> bytes_used_{0};
+    std::atomic<size_t> bytes_reserved_{0};
+};
+
+/**
+ * @brief STL allocator drawing from an Arena or a ConcurrentArena
+ *
+ * deallocate() is a no-op; memory comes back when the arena is reset.
+ * Allocators compare equal when they share an arena. Containers that know
+ * about `releases_in_bulk`, such as ConcurrentSkipList, skip the per-element
+ * deallocation entirely.
+ */
+template <typename T, typename ArenaType = Arena>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using releases_in_bulk = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = ArenaAllocator<U, ArenaType>;
+    };
+
+    explicit ArenaAllocator(ArenaType& arena) noexcept : arena_(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U, ArenaType>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_type n) {
+        if (n > static_cast<size_type>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = arena_->Allocate(n * sizeof(T), alignof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T*, size_type) noexcept {
+    }
+
+    ArenaType* arena() const noexcept { return arena_; }
+
+private:
+    ArenaType* arena_;
+};
+
+template <typename T, typename U, typename ArenaType>
+bool operator==(const ArenaAllocator<T, ArenaType>& a, const ArenaAllocator<U, ArenaType>& b) noexcept {
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U, typename ArenaType>
+bool operator!=(const ArenaAllocator<T, ArenaType>& a, const ArenaAllocator<U, ArenaType>& b) noexcept {
+    return !(a == b);
+}
+
+} // namespace SAK
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "byte_buffer.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Orders (key, ts) pairs like KeyTs: key ascending, then newest first
+ *
+ * @return Negative, zero or positive like memcmp
+ */
+int CompareKeyTs(const char* a, size_t a_size, uint64_t a_ts, const char* b, size_t b_size, uint64_t b_ts);
+
+/**
+ * @brief Builds one SST data block of versioned entries
+ *
+ * Entries are encoded as
+ *
+ *     varint shared | varint unshared | varint value size |
+ *     key[shared, shared + unshared) | fixed64 ts | value
+ *
+ * where `shared` is the number of leading key bytes in common with the
+ * previous entry. Every `restart_interval` entries the key is stored whole
+ * (shared = 0) and its offset recorded; the offsets and their count follow
+ * the entries as fixed32s, so readers binary-search the restart points
+ * and only decode forward from the nearest one.
+ */
+class BlockBuilder {
+public:
+    static constexpr size_t kDefaultRestartInterval = 16;
+
+    explicit BlockBuilder(size_t restart_interval = kDefaultRestartInterval);
+
+    /// Entries must arrive in KeyTs order, each (key, ts) once
+    void Add(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value);
+
+    /// Size of the block Finish() would return now
+    size_t EstimatedSize() const noexcept;
+    bool Empty() const noexcept { return entries_ == 0; }
+    size_t NumEntries() const noexcept { return entries_; }
+
+    /// Appends the restart array and returns the block; valid until Reset()
+    const std::vector<uint8_t>& Finish();
+    void Reset();
+
+private:
+    const size_t restart_interval_;
+    std::vector<uint8_t> buffer_;
+    std::vector<uint32_t> restarts_;
+    std::string last_key_;
+    size_t counter_ = 0;  // Entries since the last restart point
+    size_t entries_ = 0;
+    bool finished_ = false;
+};
+
+/**
+ * @brief A decoded, immutable data block
+ *
+ * Holds the block bytes in a ByteBuffer; iterators hand out values, and
+ * keys stored whole, as slices of it rather than copies.
+ */
+class Block {
+public:
+    /// nullptr if `contents` is not a well-formed block
+    static std::shared_ptr<const Block> Decode(ByteBuffer contents);
+
+    size_t Size() const noexcept { return data_.Size(); }
+    uint32_t NumRestarts() const noexcept { return num_restarts_; }
+
+private:
+    friend class BlockIterator;
+
+    explicit Block(ByteBuffer data, size_t restarts_offset, uint32_t num_restarts);
+
+    const uint8_t* Bytes() const noexcept { return reinterpret_cast<const uint8_t*>(data_.Data()); }
+    uint32_t RestartOffset(uint32_t index) const noexcept;
+
+    ByteBuffer data_;
+    size_t restarts_offset_;  // End of the entries
+    uint32_t num_restarts_;
+};
+
+/**
+ * @brief Walks the entries of a Block in KeyTs order
+ *
+ * Keeps the block alive. Seek() binary-searches the restart points, whose
+ * keys are read in place, and then decodes at most one restart interval.
+ */
+class BlockIterator {
+public:
+    explicit BlockIterator(std::shared_ptr<const Block> block);
+
+    bool Valid() const noexcept { return valid_; }
+    /// Set when decoding ran into malformed bytes; Valid() is then false
+    bool Corrupted() const noexcept { return corrupted_; }
+
+    void SeekToFirst();
+    /// To the first entry at or after (key, ts) in KeyTs order
+    void Seek(const ByteBuffer& key, uint64_t ts);
+    void Next();
+
+    /// A slice of the block when the key is stored whole, else a copy
+    ByteBuffer Key() const;
+    const char* KeyData() const noexcept { return key_.data(); }
+    size_t KeySize() const noexcept { return key_.size(); }
+    uint64_t Timestamp() const noexcept { return ts_; }
+    /// A slice of the block
+    ByteBuffer Value() const { return block_->data_.Slice(value_offset_, value_size_); }
+
+private:
+    void SeekToRestart(uint32_t index);
+    // Decodes the entry at next_offset_, building on key_
+    bool ParseNext();
+
+    std::shared_ptr<const Block> block_;
+    std::string key_;
+    size_t key_offset_ = 0;  // Of the key in the block when stored whole
+    bool key_whole_ = false;
+    uint64_t ts_ = 0;
+    size_t value_offset_ = 0;
+    size_t value_size_ = 0;
+    size_t next_offset_ = 0;
+    bool valid_ = false;
+    bool corrupted_ = false;
+};
+
+} // namespace SAK
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "_utils.hpp"
+#include "block.hpp"
+#include "instrusive_list.hpp"
+#include "options.hpp"
+#include "spin_mutex.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Where an inserted block starts out in the cache
+ */
+enum class CachePriority {
+    High,  // Point lookups: most recently used end of the probation segment
+    Low,   // Scans and compaction reads: first in line for eviction
+};
+
+/**
+ * @brief Sharded, byte-bounded cache of decoded SST blocks
+ *
+ * Blocks are keyed by (file id, offset) so one cache can be shared by every
+ * SsTable. The key is hashed to one of 2^shard_bits shards, each with its own
+ * spin lock and a segmented LRU: blocks enter a probation segment and move
+ * to a protected segment, of at most 80% of the shard's capacity, when hit
+ * again. Eviction takes the least recently used probation block first, so
+ * a scan of blocks read once cannot push out the hot set.
+ *
+ * Lookup() hands out a shared_ptr, which pins the block: an evicted block
+ * stays valid, and its bytes referenced, until the last holder lets go.
+ * Usage only counts blocks still in the cache.
+ */
+class BlockCache {
+public:
+    /// Bytes charged per entry on top of the block itself
+    static constexpr size_t kEntryOverhead = 96;
+
+    explicit BlockCache(size_t capacity, size_t shard_bits = 4);
+    ~BlockCache();
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /// A cache sized by Options::block_cache_size; nullptr if that is 0
+    static std::shared_ptr<BlockCache> Create(const Options& options);
+
+    /// The cached block, or nullptr on a miss
+    std::shared_ptr<const Block> Lookup(uint64_t file_id, uint64_t offset);
+
+    /**
+     * @brief Cache `block`, replacing any block under the same key
+     *
+     * Evicts least recently used blocks until the shard is back within its
+     * capacity. A block larger than a whole shard is not cached.
+     */
+    void Insert(uint64_t file_id, uint64_t offset, std::shared_ptr<const Block> block,
+                CachePriority priority = CachePriority::High);
+
+    void Erase(uint64_t file_id, uint64_t offset);
+    /// Drops every block of a file, e.g. once compaction deleted it
+    void EraseFile(uint64_t file_id);
+
+    size_t Capacity() const noexcept { return capacity_; }
+    /// Bytes charged for the blocks in the cache
+    size_t Usage() const noexcept;
+    size_t Count() const noexcept;
+    uint64_t Hits() const noexcept;
+    uint64_t Misses() const noexcept;
+
+private:
+    struct Key {
+        uint64_t file_id;
+        uint64_t offset;
+
+        bool operator==(const Key& other) const noexcept {
+            return file_id == other.file_id && offset == other.offset;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Entry : InstrusiveListNode {
+        Key key{};
+        std::shared_ptr<const Block> block;
+        size_t charge = 0;
+        bool is_protected = false;
+    };
+
+    using Map = std::unordered_map<Key, Entry, KeyHash>;
+    using List = InstrusiveList<Entry>;
+
+    struct alignas(max_nfs_size) Shard {
+        spin_mutex mutex;
+        Map map;
+        List probation;  // Front is most recently used
+        List protected_;
+        size_t usage = 0;
+        size_t protected_usage = 0;
+        std::atomic<size_t> published_usage{0};
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+
+    Shard& ShardFor(const Key& key) noexcept;
+
+    // The rest run with the shard's mutex held
+    void Unlink(Shard& shard, Entry& entry) noexcept;
+    void Remove(Shard& shard, Map::iterator it) noexcept;
+    void Promote(Shard& shard, Entry& entry) noexcept;
+    void EvictToCapacity(Shard& shard) noexcept;
+    void Publish(Shard& shard) noexcept;
+
+    const size_t capacity_;
+    const size_t shard_bits_;
+    const size_t shard_capacity_;
+    const size_t protected_capacity_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace SAK
@@ -7,14 +7,23 @@
 #include <string>
 #include <vector>
 
+#include "hash.hpp"
+
 namespace SAK {
 
+class Arena;
+
 /**
  * @brief A reference-counted byte buffer with zero-copy operations
  * 
  * ByteBuffer provides a thread-safe, memory-efficient container for binary data
  * with copy-on-write semantics. It allows efficient slicing and cloning operations
  * that share the same underlying data via reference counting.
+ *
+ * Buffers of up to kInlineCapacity bytes, typical of keys, store their bytes
+ * in the object itself: creating or copying one allocates nothing and
+ * touches no reference count. Larger copies made by the buffer get a single
+ * allocation holding both the bytes and the reference count.
  */
 class ByteBuffer {
 public:
@@ -64,6 +73,38 @@ public:
      */
     explicit ByteBuffer(const std::vector<uint8_t>& vec);
 
+    /**
+     * @brief Creates a buffer that takes over the storage of a vector
+     *
+     * No bytes are copied, e.g. for the result of FileObject::Read().
+     *
+     * @param vec Vector to adopt; left empty
+     */
+    explicit ByteBuffer(std::vector<uint8_t>&& vec);
+
+    /**
+     * @brief Creates a view of bytes owned elsewhere
+     *
+     * No bytes are copied, e.g. for a memory-mapped file; `data` keeps the
+     * storage alive for as long as the buffer or any slice of it exists.
+     *
+     * @param data Shared pointer to the first byte
+     * @param size Size of the data in bytes
+     */
+    ByteBuffer(std::shared_ptr<const char> data, size_t size);
+
+    /**
+     * @brief Creates a buffer whose bytes and reference count live in an arena
+     *
+     * No heap allocation takes place. The buffer, and every copy or slice of
+     * it, must not be used after the arena is reset or destroyed.
+     *
+     * @param arena Arena to copy the data into
+     * @param data Pointer to the data
+     * @param size Size of the data in bytes
+     */
+    ByteBuffer(Arena& arena, const char* data, size_t size);
+
     /**
      * @brief Copy constructor
      * 
@@ -104,22 +145,36 @@ public:
     /**
      * @brief Returns a pointer to the underlying data
      * 
-     * @return Const pointer to the data
+     * @return Const pointer to the data; nullptr for an empty buffer
      */
-    const char* Data() const;
+    const char* Data() const noexcept {
+        if (size_ & kSharedFlag) {
+            return shared_.data.get() + shared_.offset;
+        }
+        return size_ ? inline_ : nullptr;
+    }
 
     /**
      * @brief Returns the size of the buffer in bytes
      * 
      * @return Size in bytes
      */
-    size_t Size() const;
+    size_t Size() const noexcept { return size_ & ~kSharedFlag; }
+
+    /**
+     * @brief Whether the bytes are stored in the buffer itself
+     *
+     * True for every buffer of up to kInlineCapacity bytes, except those
+     * explicitly placed in an arena.
+     */
+    bool IsInline() const noexcept { return !(size_ & kSharedFlag); }
 
     /**
      * @brief Creates a slice of the buffer
      * 
      * Creates a new ByteBuffer that shares the same underlying data
-     * but only exposes a slice of it.
+     * but only exposes a slice of it. Slices of up to kInlineCapacity
+     * bytes are copied inline instead, which is cheaper than sharing.
      * 
      * @param offset Offset from the start of the buffer
      * @param length Length of the slice
@@ -145,39 +200,39 @@ public:
     std::string ToString() const;
 
     /**
-     * @brief Compares two buffers for equality
-     * 
-     * @param other Buffer to compare with
-     * @return true if buffers have identical content
-     */
-    bool operator==(const ByteBuffer& other) const;
-
-    /**
-     * @brief Compares two buffers for inequality
-     * 
-     * @param other Buffer to compare with
-     * @return true if buffers have different content
+     * @brief Three-way lexicographic comparison of raw byte ranges
+     *
+     * @return Negative, zero or positive like memcmp
      */
-    bool operator!=(const ByteBuffer& other) const;
+    static int Compare(const char* a, size_t a_size, const char* b, size_t b_size) noexcept {
+        size_t common = a_size < b_size ? a_size : b_size;
+        int cmp = common ? std::memcmp(a, b, common) : 0;
+        if (cmp != 0) {
+            return cmp;
+        }
+        return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+    }
 
-    /**
-     * @brief Lexicographically compares this buffer with another
-     * 
-     * @param other Buffer to compare with
-     * @return true if this buffer is less than the other
-     */
-    bool operator<(const ByteBuffer& other) const;
+    int Compare(const ByteBuffer& other) const noexcept {
+        return Compare(Data(), Size(), other.Data(), other.Size());
+    }
 
     /**
-     * @brief Lexicographically compares this buffer with another
+     * @brief Compares two buffers for equality
      * 
      * @param other Buffer to compare with
-     * @return true if this buffer is greater than the other
+     * @return true if buffers have identical content
      */
-    bool operator>(const ByteBuffer& other) const;
+    bool operator==(const ByteBuffer& other) const noexcept {
+        size_t size = Size();
+        return size == other.Size() && (size == 0 || std::memcmp(Data(), other.Data(), size) == 0);
+    }
 
-    bool operator<=(const ByteBuffer& other) const { return !(*this > other); }
-    bool operator>=(const ByteBuffer& other) const { return !(*this < other); }
+    bool operator!=(const ByteBuffer& other) const noexcept { return !(*this == other); }
+    bool operator<(const ByteBuffer& other) const noexcept { return Compare(other) < 0; }
+    bool operator>(const ByteBuffer& other) const noexcept { return Compare(other) > 0; }
+    bool operator<=(const ByteBuffer& other) const noexcept { return Compare(other) <= 0; }
+    bool operator>=(const ByteBuffer& other) const noexcept { return Compare(other) >= 0; }
 
     // -------- Added utility helpers --------
     /**
@@ -196,8 +251,7 @@ public:
      *        After calling this, Empty() == true.
      */
     void Clear() noexcept {
-        data_.reset();
-        offset_ = 0;
+        Release();
         size_ = 0;
     }
 
@@ -210,15 +264,44 @@ public:
         return std::vector<uint8_t>(ptr, ptr + Size());
     }
 
+    /// Buffers up to this size keep their bytes inline, without a heap allocation
+    static constexpr size_t kInlineCapacity = sizeof(std::shared_ptr<const char>) + sizeof(size_t);
+
 private:
+    // Set in size_ when the bytes live in shared storage
+    static constexpr size_t kSharedFlag = ~(~size_t(0) >> 1);
+
+    struct Shared {
+        // Points at the first byte of the storage, which may be heap, arena
+        // or mapped memory
+        std::shared_ptr<const char> data;
+        size_t offset;
+    };
+
     // Private constructor for creating slices
-    ByteBuffer(std::shared_ptr<const std::vector<char>> data, size_t offset, size_t size);
+    ByteBuffer(std::shared_ptr<const char> data, size_t offset, size_t size);
+
+    // Copies `size` bytes into one allocation holding the reference count too
+    static std::shared_ptr<const char> CopyToHeap(const char* data, size_t size);
+
+    // Copies `size` bytes inline, or to the heap if they do not fit
+    void Assign(const char* data, size_t size);
+    void AssignShared(std::shared_ptr<const char> data, size_t offset, size_t size) noexcept;
+    void CopyFrom(const ByteBuffer& other) noexcept;
+    void MoveFrom(ByteBuffer& other) noexcept;
+    // Drops shared storage, if any; size_ is left for the caller to reset
+    void Release() noexcept {
+        if (size_ & kSharedFlag) {
+            shared_.~Shared();
+        }
+    }
 
-    // Shared data storage with reference counting
-    std::shared_ptr<const std::vector<char>> data_;
-    
-    // Offset and size for slicing
-    size_t offset_;
+    union {
+        Shared shared_;
+        char inline_[kInlineCapacity];
+    };
+
+    // Size in bytes, with kSharedFlag
     size_t size_;
 };
 
@@ -233,12 +316,8 @@ namespace std {
  */
 template <>
 struct hash<SAK::ByteBuffer> {
-    size_t operator()(const SAK::ByteBuffer& buf) const {
-        // Hash the raw data directly
-        const char* data = buf.Data();
-        size_t size = buf.Size();
-        std::hash<std::string> hasher;
-        return hasher(std::string(data, size));
+    size_t operator()(const SAK::ByteBuffer& buf) const noexcept {
+        return static_cast<size_t>(SAK::hash::Hash64(buf.Data(), buf.Size()));
     }
 };
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SAK {
+
+/**
+ * @brief Little-endian fixed-width and varint encoding for on-disk formats
+ *
+ * Shared by the write-ahead log and the SST format so both agree on byte
+ * order. The Get functions do no bounds checking beyond what their
+ * signatures state; callers validate sizes first.
+ */
+namespace coding {
+
+inline void PutFixed32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+inline void PutFixed64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+inline uint32_t GetFixed32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+inline uint64_t GetFixed64(const uint8_t* p) {
+    return uint64_t(GetFixed32(p)) | uint64_t(GetFixed32(p + 4)) << 32;
+}
+
+inline void PutVarint32(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Decode a varint from [p, limit)
+ *
+ * @return Pointer past the varint, or nullptr if it is truncated or too long
+ */
+inline const uint8_t* GetVarint32(const uint8_t* p, const uint8_t* limit, uint32_t& value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift <= 28 && p < limit; shift += 7) {
+        uint32_t byte = *p++;
+        result |= (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = result;
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace coding
+
+} // namespace SAK
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "block_cache.hpp"
+#include "options.hpp"
+#include "sstable.hpp"
+#include "thread_pool.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Settings of Simple Leveled compaction, taken from Options
+ */
+class CompactionOptions {
+public:
+    // Compact level i into i + 1 once level i + 1 is smaller than this
+    // percentage of level i
+    size_t size_ratio_percent{50};
+
+    // Compact L0 into L1 once L0 holds this many tables
+    size_t level0_file_num_compaction_trigger{4};
+
+    // Levels below L0; the last one is the bottom level
+    size_t max_levels{7};
+
+    // Output tables are cut at about this size, between keys, and built
+    // with these block and filter settings
+    size_t target_sst_size{2 * 1024 * 1024};
+    size_t block_size{4096};
+    size_t bloom_bits_per_key{10};
+
+    // Output bytes per second across compactions, 0 for no limit
+    uint64_t rate_limit_bytes_per_sec{0};
+
+    CompactionOptions() = default;
+    explicit CompactionOptions(const Options& options);
+};
+
+/**
+ * @brief The tables of an LSM tree by level
+ *
+ * levels[0] is L0, newest table first, whose tables may overlap; each
+ * deeper level is one sorted run of non-overlapping tables in key order.
+ * There are max_levels + 1 entries.
+ */
+struct LevelState {
+    std::vector<std::vector<std::shared_ptr<SsTable>>> levels;
+
+    /// Total file bytes of level `level`
+    uint64_t LevelSize(size_t level) const;
+};
+
+/**
+ * @brief Merge the tables of `upper_level` into `lower_level`
+ */
+struct CompactionTask {
+    size_t upper_level = 0;
+    std::vector<std::shared_ptr<SsTable>> upper;
+    size_t lower_level = 0;
+    std::vector<std::shared_ptr<SsTable>> lower;
+    // Output goes to the bottom level, where tombstones can be dropped
+    bool bottom_level = false;
+};
+
+/**
+ * @brief Picks Simple Leveled compaction tasks from level sizes
+ *
+ * L0 is compacted into L1 once it has level0_file_num_compaction_trigger
+ * tables. Otherwise the shallowest level i whose lower neighbour holds less
+ * than size_ratio_percent of its bytes is compacted into i + 1, whole.
+ */
+class SimpleLeveledController {
+public:
+    explicit SimpleLeveledController(const CompactionOptions& options);
+
+    std::optional<CompactionTask> Pick(const LevelState& state) const;
+
+    /**
+     * @brief Install the output of a finished `task`
+     *
+     * Removes the task's inputs, keeping L0 tables added since it was
+     * picked, and makes `outputs` the lower level.
+     */
+    static void Apply(LevelState& state, const CompactionTask& task, std::vector<std::shared_ptr<SsTable>> outputs);
+
+private:
+    CompactionOptions options_;
+};
+
+/**
+ * @brief K-way merge of SST iterators in KeyTs order
+ *
+ * Keeps the current entry of every table in a binary min-heap. Tables are
+ * given newest first; if two hold the same (key, ts), the newer table's
+ * entry comes first and the other is still visited.
+ */
+class MergeIterator {
+public:
+    explicit MergeIterator(const std::vector<std::shared_ptr<SsTable>>& tables);
+
+    bool Valid() const noexcept { return !heap_.empty(); }
+    /// Some table stopped at a damaged block
+    bool Corrupted() const noexcept { return corrupted_; }
+    void Next();
+
+    ByteBuffer Key() const { return Top().Key(); }
+    uint64_t Timestamp() const noexcept { return Top().Timestamp(); }
+    ByteBuffer Value() const { return Top().Value(); }
+
+private:
+    const SsTableIterator& Top() const noexcept { return iterators_[heap_.front()]; }
+    // Whether the entry of iterator `a` sorts after that of `b`
+    bool After(size_t a, size_t b) const;
+
+    std::vector<SsTableIterator> iterators_;
+    std::vector<size_t> heap_;  // Indices into iterators_
+    bool corrupted_ = false;
+};
+
+/**
+ * @brief Token bucket pacing background writes
+ *
+ * Request() blocks until `bytes` fit the configured rate; bursts up to one
+ * second's worth pass without waiting. Thread safe.
+ */
+class RateLimiter {
+public:
+    /// 0 disables limiting
+    explicit RateLimiter(uint64_t bytes_per_sec);
+
+    void Request(size_t bytes);
+    uint64_t BytesPerSecond() const noexcept { return bytes_per_sec_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const uint64_t bytes_per_sec_;
+    std::mutex mutex_;
+    double available_;
+    Clock::time_point last_;
+};
+
+/**
+ * @brief Runs Simple Leveled compaction in the background
+ *
+ * Owns the LevelState. Flushed tables enter through AddL0(); whenever the
+ * controller finds a task, one compaction at a time is posted to the pool
+ * at TaskPriority::low. It merges the inputs and writes tables of about
+ * target_sst_size through the rate limiter.
+ *
+ * Versions newer than the watermark, the oldest timestamp an active reader
+ * may use, are all kept. Of the versions at or below it only the newest
+ * survives, since no reader can see the rest; in the bottom level a
+ * surviving tombstone is dropped as well.
+ */
+class CompactionScheduler {
+public:
+    struct Hooks {
+        // Id and path for a new output table; required
+        std::function<std::pair<size_t, std::string>()> new_table;
+        // Oldest active read timestamp; unset means no readers, kMaxTimestamp
+        std::function<uint64_t()> watermark;
+        // Called with each table that left the tree, e.g. to delete its file
+        std::function<void(const std::shared_ptr<SsTable>&)> obsolete;
+    };
+
+    CompactionScheduler(const CompactionOptions& options, thread::ThreadPool& pool, Hooks hooks,
+                        std::shared_ptr<BlockCache> cache = nullptr);
+    /// Waits for a running compaction; no new ones start
+    ~CompactionScheduler();
+
+    CompactionScheduler(const CompactionScheduler&) = delete;
+    CompactionScheduler& operator=(const CompactionScheduler&) = delete;
+
+    /// Adds a table as the newest in L0 and schedules compaction if due
+    void AddL0(std::shared_ptr<SsTable> table);
+
+    LevelState Levels() const;
+
+    /// Blocks until no compaction is running or due
+    void WaitIdle();
+
+    size_t CompactionsRun() const noexcept { return compactions_.load(std::memory_order_relaxed); }
+    uint64_t BytesWritten() const noexcept { return bytes_written_.load(std::memory_order_relaxed); }
+    /// A compaction failed to read its inputs or write its output; none run after it
+    bool BackgroundError() const noexcept { return error_.load(std::memory_order_acquire); }
+
+private:
+    // Caller holds mutex_
+    void MaybeScheduleLocked();
+    void Run(const CompactionTask& task);
+    // Merges the task's inputs; false on a read or write error
+    bool Compact(const CompactionTask& task, std::vector<std::shared_ptr<SsTable>>& outputs);
+
+    const CompactionOptions options_;
+    const SimpleLeveledController controller_;
+    thread::ThreadPool& pool_;
+    const Hooks hooks_;
+    const std::shared_ptr<BlockCache> cache_;
+    RateLimiter limiter_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+    LevelState state_;
+    bool running_ = false;
+    bool stopping_ = false;
+
+    std::atomic<size_t> compactions_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<bool> error_{false};
+};
+
+} // namespace SAK
@@ -0,0 +1,246 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine) || __cplusplus < 202002L
+#error "coroutine.hpp requires C++20 coroutines; build with the 'coroutines' option"
+#endif
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace SAK {
+namespace coro {
+
+template<class T>
+class task;
+
+namespace detail {
+
+// Hands control back to the coroutine awaiting the finished task
+struct final_awaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template<class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        auto continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct promise_base {
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+};
+
+template<class T>
+struct promise : promise_base {
+    task<T> get_return_object() noexcept;
+
+    template<class V>
+    void return_value(V&& v) { value.emplace(std::forward<V>(v)); }
+
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template<>
+struct promise<void> : promise_base {
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief A lazily started coroutine producing a T
+ *
+ * The body runs when the task is first awaited, on the awaiting thread;
+ * awaiting ThreadPool::schedule(), Timer::sleep_for(),
+ * CApplication::resumeOnMain() or IPCImplement::receive() inside it moves
+ * the rest of the body to the thread those resume on. When the body
+ * finishes, the awaiting coroutine is resumed directly (symmetric
+ * transfer), so long chains do not grow the stack. Exceptions propagate
+ * to the awaiter.
+ */
+template<class T = void>
+class task {
+public:
+    using promise_type = detail::promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+    explicit task(handle_type handle) noexcept : handle_(handle) {}
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() { reset(); }
+
+    bool valid() const noexcept { return static_cast<bool>(handle_); }
+
+    struct awaiter {
+        handle_type handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        T await_resume() { return handle.promise().take(); }
+    };
+
+    awaiter operator co_await() const& noexcept { return awaiter{handle_}; }
+
+private:
+    void reset() noexcept {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    handle_type handle_;
+};
+
+namespace detail {
+
+template<class T>
+task<T> promise<T>::get_return_object() noexcept {
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+inline task<void> promise<void>::get_return_object() noexcept {
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+// Self-destroying coroutine used by sync_wait() and spawn()
+struct detached {
+    struct promise_type {
+        detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct sync_wait_state {
+    void complete() {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        condition.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return done; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::exception_ptr error;
+};
+
+template<class T>
+detached sync_wait_driver(task<T>& work, sync_wait_state& state, std::optional<T>& value) {
+    try {
+        value.emplace(co_await work);
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    state.complete();
+}
+
+inline detached sync_wait_driver(task<void>& work, sync_wait_state& state) {
+    try {
+        co_await work;
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    state.complete();
+}
+
+inline detached spawn_driver(task<void> work) {
+    try {
+        co_await work;
+    } catch (...) {
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Run `work` to completion and return its result
+ *
+ * Blocks the calling thread until the task finishes, wherever it resumes.
+ * Do not call it from a thread the task needs to make progress, such as
+ * the only ThreadPool worker or the CApplication main thread.
+ */
+template<class T>
+T sync_wait(task<T> work) {
+    detail::sync_wait_state state;
+    if constexpr (std::is_void<T>::value) {
+        detail::sync_wait_driver(work, state);
+        state.wait();
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    } else {
+        std::optional<T> value;
+        detail::sync_wait_driver(work, state, value);
+        state.wait();
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+        return std::move(*value);
+    }
+}
+
+/**
+ * @brief Start `work` without waiting for it
+ *
+ * The coroutine frame frees itself when the task finishes. Exceptions
+ * escaping the task are discarded.
+ */
+inline void spawn(task<void> work) {
+    detail::spawn_driver(std::move(work));
+}
+
+} // namespace coro
+} // namespace SAK
@@ -3,29 +3,31 @@
 #include <cstdint>
 #include <cstddef>  // For size_t
 #include <array>
+#include <mutex>
 #include <vector>
 
 namespace SAK {
 
 /**
  * @brief Implementation of CRC32C (Castagnoli polynomial 0x1EDC6F41)
- * 
- * This is a software-based implementation of the CRC32C checksum algorithm,
- * which uses the Castagnoli polynomial for better error detection than the
- * standard CRC32 algorithm.
+ *
+ * The checksum is computed with the SSE4.2 `crc32` instruction on x86 or the
+ * ARMv8 CRC extension on AArch64 when the CPU supports it, and falls back to a
+ * slice-by-4 table implementation otherwise. The implementation is selected
+ * once, the first time the tables are initialized.
  */
 class Crc32c {
 public:
     /**
-     * @brief Initialize the CRC32C lookup tables
-     * 
-     * Must be called before using any other methods.
+     * @brief Initialize the CRC32C lookup tables and select the implementation
+     *
+     * Called implicitly by Compute/Extend; safe to call from multiple threads.
      */
     static void Initialize();
 
     /**
      * @brief Calculate CRC32C checksum for a byte array
-     * 
+     *
      * @param data Pointer to the data
      * @param length Length of the data in bytes
      * @return uint32_t CRC32C checksum
@@ -34,24 +36,77 @@ public:
 
     /**
      * @brief Calculate CRC32C checksum for a vector of bytes
-     * 
+     *
      * @param data Vector containing the data
      * @return uint32_t CRC32C checksum
      */
     static uint32_t Compute(const std::vector<uint8_t>& data);
 
+    /**
+     * @brief Extend a previously computed checksum with more data
+     *
+     * `Extend(Compute(a, n), b, m)` equals the checksum of `a` followed by `b`,
+     * so scattered buffers can be checksummed without concatenating them.
+     * `Extend(0, data, length)` is the same as `Compute(data, length)`.
+     *
+     * @param crc Checksum of the preceding data (0 for none)
+     * @param data Pointer to the data
+     * @param length Length of the data in bytes
+     * @return uint32_t CRC32C checksum of the combined data
+     */
+    static uint32_t Extend(uint32_t crc, const void* data, size_t length);
+
+    /**
+     * @brief Checksum of two buffers back to back, from their checksums
+     *
+     * `Combine(Compute(a, n), Compute(b, m), m)` equals the checksum of `a`
+     * followed by `b`, so pieces checksummed in parallel can be joined
+     * without touching the data again. Costs O(log m) table-free steps.
+     *
+     * @param crc1 Checksum of the first buffer
+     * @param crc2 Checksum of the second buffer
+     * @param length2 Length of the second buffer in bytes
+     */
+    static uint32_t Combine(uint32_t crc1, uint32_t crc2, uint64_t length2);
+
+    /**
+     * @brief Whether a hardware CRC32C instruction is in use
+     */
+    static bool IsHardwareAccelerated();
+
 private:
+    using ExtendFunc = uint32_t (*)(uint32_t crc, const uint8_t* data, size_t length);
+
+    static void InitializeOnce();
+    static uint32_t ExtendSoftware(uint32_t crc, const uint8_t* data, size_t length);
+#if defined(__x86_64__) || defined(_M_X64)
+    static uint32_t ExtendSse42(uint32_t crc, const uint8_t* data, size_t length);
+#elif defined(__aarch64__)
+    static uint32_t ExtendArmv8(uint32_t crc, const uint8_t* data, size_t length);
+#endif
+    // Advances a raw CRC register state past `kLongBlock`/`kShortBlock` zero bytes
+    static uint32_t ShiftLong(uint32_t crc);
+    static uint32_t ShiftShort(uint32_t crc);
+
     // CRC32C polynomial in reversed bit order
     static constexpr uint32_t kPolynomial = 0x82F63B78;
-    
+
+    // Per-lane block sizes for the 3-way interleaved hardware path
+    static constexpr size_t kLongBlock = 8192;
+    static constexpr size_t kShortBlock = 256;
+
     // Lookup tables for CRC32C calculation
     static std::array<uint32_t, 256> table0_;
     static std::array<uint32_t, 256> table1_;
     static std::array<uint32_t, 256> table2_;
     static std::array<uint32_t, 256> table3_;
-    
-    // Flag to check if tables are initialized
-    static bool initialized_;
+
+    // Tables combining the independent lanes of the interleaved path
+    static std::array<std::array<uint32_t, 256>, 4> long_shift_;
+    static std::array<std::array<uint32_t, 256>, 4> short_shift_;
+
+    static ExtendFunc extend_;
+    static std::once_flag init_flag_;
 };
 
 } // namespace SAK
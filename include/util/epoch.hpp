@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "_config.hpp"
+
+namespace SAK {
+
+class epoch_domain;
+
+/**
+ * @brief Keeps the current thread inside an epoch_domain critical section
+ *
+ * While a guard is alive, nothing retired to the domain after the guard
+ * was taken is freed, so pointers loaded from shared state stay valid.
+ * Guards may nest, and may be moved to other threads; a thread's nested
+ * guards join the slot it already holds rather than taking more.
+ */
+class epoch_guard {
+public:
+    epoch_guard() noexcept : domain_(nullptr), slot_(0) {}
+    epoch_guard(epoch_guard&& other) noexcept : domain_(other.domain_), slot_(other.slot_) {
+        other.domain_ = nullptr;
+    }
+    epoch_guard& operator=(epoch_guard&& other) noexcept;
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+    ~epoch_guard() { release(); }
+
+    void release() noexcept;
+
+private:
+    friend class epoch_domain;
+    epoch_guard(epoch_domain* domain, std::size_t slot) noexcept : domain_(domain), slot_(slot) {}
+
+    epoch_domain* domain_;
+    std::size_t slot_;
+};
+
+/**
+ * @brief Epoch-based reclamation for read-mostly lock-free structures
+ *
+ * Readers pin() the domain around their accesses; writers unlink an
+ * object, then retire() it. A retired object is freed once the global
+ * epoch has moved two steps past the one it was retired in, which can
+ * only happen after every reader that might still see it has unpinned.
+ *
+ * pin() claims one of SLOTS reader slots with a single CAS, starting from
+ * a per-thread home slot, so uncontended readers never share a cache line
+ * and never allocate. A thread that is already pinned joins its own slot
+ * instead by bumping the slot's holder count, so SLOTS bounds the number
+ * of pinned threads, not of live guards. Reclamation runs from retire()
+ * every COLLECT_INTERVAL retirements and from collect().
+ *
+ * The slots take SLOTS * max_nfs_size bytes (16 KiB) per domain.
+ */
+class epoch_domain {
+public:
+    static constexpr std::size_t SLOTS = 128;
+    static constexpr std::size_t COLLECT_INTERVAL = 64;
+
+    epoch_domain() = default;
+    // Frees everything still retired; no reader may be pinned
+    ~epoch_domain();
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    epoch_guard pin() noexcept;
+
+    /// Frees `object` with `deleter` once no pinned reader can reach it
+    void retire(void* object, void (*deleter)(void*));
+
+    /// retire() for objects whose deleter needs its owner, e.g. an allocator
+    void retire(void* object, void (*deleter)(void* object, void* context), void* context);
+
+    template<typename T>
+    void retire(T* object) {
+        retire(const_cast<void*>(static_cast<const void*>(object)),
+               [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /// Advances the epoch if possible and frees what has become safe
+    void collect();
+
+    /**
+     * @brief Waits out every reader pinned before the call, then frees
+     *        everything retired before it
+     *
+     * The calling thread must not be pinned to this domain.
+     */
+    void synchronize();
+
+    /**
+     * @brief Frees everything retired without waiting for readers
+     *
+     * For owners that know no reader can reach those objects any more,
+     * e.g. a container cleared under exclusive access.
+     */
+    void purge();
+
+    /// Objects retired but not freed yet
+    std::size_t pending() const;
+
+private:
+    friend class epoch_guard;
+
+    static constexpr uint64_t IDLE = ~uint64_t(0);
+
+    struct alignas(max_nfs_size) Slot {
+        std::atomic<uint64_t> epoch{IDLE};
+        // Guards sharing the pin; the slot goes idle with the last one
+        std::atomic<uint32_t> holders{0};
+        // Identity of the thread that claimed the pin
+        std::atomic<const void*> owner{nullptr};
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        void (*context_deleter)(void*, void*);
+        void* context;
+        uint64_t epoch;
+
+        void free() const {
+            if (context_deleter) {
+                context_deleter(object, context);
+            } else {
+                deleter(object);
+            }
+        }
+    };
+
+    void push_retired(const Retired& retired);
+
+    bool try_advance(uint64_t current);
+    void free_retired(uint64_t current);
+
+    alignas(max_nfs_size) std::atomic<uint64_t> epoch_{0};
+    Slot slots_[SLOTS];
+    mutable std::mutex retired_mutex_;
+    std::vector<Retired> retired_;
+    std::size_t since_collect_ = 0;
+};
+
+} // namespace SAK
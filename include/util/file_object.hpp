@@ -1,17 +1,35 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "byte_buffer.hpp"
+
 namespace SAK {
 
+namespace thread {
+class ThreadPool;
+}
+
+/**
+ * @brief Expected access pattern, passed on to madvise / posix_fadvise
+ */
+enum class AccessHint {
+    Normal,
+    Sequential,  // Read ahead aggressively, drop pages behind
+    Random,      // No read-ahead, e.g. SST point lookups
+    WillNeed,    // Start reading the range in now
+};
+
 /**
  * @brief Simple RAII wrapper over a POSIX file used by SsTable.
  *
- * It supports random read (`Read`), size query (`Size`) and two factory helpers
- * `Create` (create-and-write) and `Open` (read-only).
+ * It supports random read (`Read`, `ReadInto`), a zero-copy memory-mapped
+ * view (`Map`), size query (`Size`) and two factory helpers `Create`
+ * (create-and-write) and `Open` (read-only).
  */
 class FileObject {
 public:
@@ -42,6 +60,35 @@ public:
      */
     std::vector<uint8_t> Read(uint64_t offset, uint64_t len) const;
 
+    /**
+     * @brief Read `len` bytes starting from `offset` into the caller's buffer.
+     *
+     * Unlike `Read` nothing is allocated, so a buffer can be reused across reads.
+     *
+     * @return false if fewer than `len` bytes could be read
+     */
+    bool ReadInto(uint64_t offset, uint8_t* dst, size_t len) const;
+
+    /**
+     * @brief A read-only view of the whole file, backed by mmap (MapViewOfFile
+     *        on Windows).
+     *
+     * The file is mapped once, on the first call, and shared by every view;
+     * views and their slices keep the mapping alive after the FileObject is
+     * gone. `hint` is applied to the whole mapping on each call. The file must
+     * not be truncated while mapped.
+     *
+     * @return An empty buffer for an empty or invalid file, or if mapping fails
+     */
+    ByteBuffer Map(AccessHint hint = AccessHint::Normal) const;
+
+    /**
+     * @brief Advise the OS how `[offset, offset + len)` will be read; `len` 0
+     *        means to the end of the file. Applies to the mapping once `Map`
+     *        has been called, else to the page cache. Best effort.
+     */
+    void Advise(AccessHint hint, uint64_t offset = 0, uint64_t len = 0) const;
+
     /**
      * @brief Total file size in bytes.
      */
@@ -52,6 +99,14 @@ public:
      */
     bool Valid() const noexcept;
 
+#ifndef _WIN32
+    /**
+     * @brief The POSIX descriptor, or -1; for submitting asynchronous reads,
+     *        e.g. to EventDispatcherUring::read(), instead of calling `Read`.
+     */
+    int Fd() const noexcept;
+#endif
+
 private:
     explicit FileObject(std::shared_ptr<struct FileObjectImpl> impl) noexcept : impl_(std::move(impl)) {}
 
@@ -59,4 +114,100 @@ private:
     std::shared_ptr<struct FileObjectImpl> impl_;
 };
 
+/**
+ * @brief Tuning of a FileWriter
+ */
+struct FileWriterOptions {
+    // Bytes per write and per checksum, rounded up to a multiple of 4096
+    size_t block_size = 1 << 20;
+    // Blocks being filled or written at once, at least 2; Append() waits
+    // for one to come back when all are in flight
+    size_t buffers = 2;
+    // Bypass the page cache (O_DIRECT) where the filesystem allows it,
+    // else fall back to buffered writes
+    bool direct_io = true;
+    // Reserve disk space this far ahead of the write position (Linux
+    // fallocate); 0 disables
+    uint64_t preallocate = 64ull << 20;
+    // Writes and checksums full blocks, in parallel with each other and
+    // with Append(); null does both on the appending thread. Append() must
+    // not be called from this pool's workers, which it may wait for.
+    thread::ThreadPool* pool = nullptr;
+    // fdatasync before Finish() returns
+    bool sync = false;
+};
+
+/**
+ * @brief Writes a new file from appended chunks
+ *
+ * The streaming counterpart of `FileObject::Create`: data is gathered
+ * into aligned blocks and each full block is written at its offset while
+ * the next one fills, so peak memory is `buffers * block_size` whatever
+ * the file size. Every block is checksummed (Crc32c) alongside its write.
+ * The writer is used from one thread at a time.
+ *
+ * On the first failed write Append() and Finish() start returning false
+ * and an invalid FileObject; a writer destroyed without Finish() waits
+ * for its writes and leaves the file as far as written.
+ */
+class FileWriter {
+public:
+    /**
+     * @brief Create (or truncate) the file at `path`
+     */
+    explicit FileWriter(const std::string& path, const FileWriterOptions& options = FileWriterOptions());
+    ~FileWriter();
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+    FileWriter(FileWriter&& other) noexcept;
+    FileWriter& operator=(FileWriter&& other) noexcept;
+
+    /**
+     * @brief Append `len` bytes; copies them, so `data` can be reused at once
+     *
+     * @return false if the writer failed or is finished
+     */
+    bool Append(const void* data, size_t len);
+    bool Append(const std::vector<uint8_t>& data) { return Append(data.data(), data.size()); }
+
+    /**
+     * @brief Write what is buffered, trim the file to the appended size and
+     *        reopen it read-only
+     *
+     * @return An invalid FileObject if any write failed
+     */
+    FileObject Finish();
+
+    /**
+     * @brief Whether the file is open and no write has failed.
+     */
+    bool Valid() const noexcept;
+
+    /**
+     * @brief Bytes appended so far.
+     */
+    uint64_t Size() const noexcept;
+
+    /**
+     * @brief Whether writes bypass the page cache.
+     */
+    bool DirectIo() const noexcept;
+
+    /**
+     * @brief Crc32c of each block of `block_size` bytes (the last may be
+     *        shorter), in file order; complete after Finish().
+     */
+    std::vector<uint32_t> BlockChecksums() const;
+
+    /**
+     * @brief Crc32c of the whole file, combined from the block checksums;
+     *        valid after Finish().
+     */
+    uint32_t Checksum() const noexcept;
+
+private:
+    std::unique_ptr<struct FileWriterImpl> impl_;
+};
+
 }  // namespace SAK
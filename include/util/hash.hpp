@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "coding.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Fast non-cryptographic 64-bit hashing
+ *
+ * A port of wyhash (final version 4, public domain). Bytes are read as
+ * little-endian, so results are the same on every platform and may be
+ * stored, e.g. in SST Bloom filters. Nothing is allocated.
+ */
+namespace hash {
+
+namespace detail {
+
+constexpr uint64_t kSecret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+                                 0x4d5a2da51de1aa47ull};
+
+// 128-bit product of a and b, low half in a and high half in b
+inline void Mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b) noexcept {
+    Mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t Read3(const uint8_t* p, size_t k) noexcept {
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace detail
+
+inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0) noexcept {
+    using namespace detail;
+    using coding::GetFixed32;
+    using coding::GetFixed64;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+    uint64_t a;
+    uint64_t b;
+    if (size <= 16) {
+        if (size >= 4) {
+            size_t step = (size >> 3) << 2;
+            a = (uint64_t(GetFixed32(p)) << 32) | GetFixed32(p + step);
+            b = (uint64_t(GetFixed32(p + size - 4)) << 32) | GetFixed32(p + size - 4 - step);
+        } else if (size > 0) {
+            a = Read3(p, size);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = size;
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = Mix(GetFixed64(p) ^ kSecret[1], GetFixed64(p + 8) ^ seed);
+                see1 = Mix(GetFixed64(p + 16) ^ kSecret[2], GetFixed64(p + 24) ^ see1);
+                see2 = Mix(GetFixed64(p + 32) ^ kSecret[3], GetFixed64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = Mix(GetFixed64(p) ^ kSecret[1], GetFixed64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = GetFixed64(p + i - 16);
+        b = GetFixed64(p + i - 8);
+    }
+    a ^= kSecret[1];
+    b ^= seed;
+    Mum(a, b);
+    return Mix(a ^ kSecret[0] ^ size, b ^ kSecret[1]);
+}
+
+} // namespace hash
+
+} // namespace SAK
@@ -96,6 +96,24 @@ public:
         ++my_size;
     }
 
+    void PushBack(T& val) {
+        node(val).next = &my_head;
+        node(val).prev = my_head.prev;
+        my_head.prev->next = &node(val);
+        my_head.prev = &node(val);
+        ++my_size;
+    }
+
+    T& Front() { return item(my_head.next); }
+    T& Back() { return item(my_head.prev); }
+
+    // Forgets every element without touching them
+    void Clear() {
+        my_head.prev = &my_head;
+        my_head.next = &my_head;
+        my_size = 0;
+    }
+
     void Remove(T& val) {
         node(val).prev->next = node(val).next;
         node(val).next->prev = node(val).prev;
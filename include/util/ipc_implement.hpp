@@ -7,6 +7,12 @@
 #include <queue>
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <chrono>
+#include <vector>
+#include <string_view>
 #include "ipc_shared_memory.hpp"
 
 namespace SAK {
@@ -44,6 +50,57 @@ public:
      * @param is_server True if server, false if client
      */
     void setIsServer(bool is_server);
+
+    /**
+     * @brief Choose how the shared memory channel is synchronised
+     * @param transport Must match the other side; takes effect on start()
+     */
+    void setTransport(IPCTransport transport);
+
+    /**
+     * @brief Set ring size, channel count, huge pages and transport at once
+     * @param options Must match the other side; takes effect on start()
+     *
+     * Messages are sent on channel 0 and received from every channel.
+     */
+    void setSharedMemoryOptions(const IPCSharedMemoryOptions& options);
+
+    /**
+     * @brief Run without sender and receiver threads
+     * @param event_driven Takes effect on start()
+     *
+     * Messages arrive through notificationFd(), which the owning event loop
+     * watches, e.g. with
+     * `dispatcher->registerSocketNotifier(new SocketNotifier{fd, SocketNotifierType::Read, receiver})`,
+     * calling processEvents() when the receiver gets Event::Type::SocketAct.
+     * sendMessage() writes straight into shared memory; messages that find
+     * it full wait in the send queue until the other side frees room, which
+     * also wakes the descriptor. POSIX only.
+     */
+    void setEventDriven(bool event_driven);
+
+    /**
+     * @brief Receive messages through `handler` instead of the queues
+     *
+     * The view is only valid during the call; with the ring transport in
+     * event-driven mode it points into shared memory. Called on the
+     * receiver thread, or from processEvents() when event-driven.
+     */
+    void setMessageHandler(std::function<void(std::string_view)> handler);
+
+    /**
+     * @brief Descriptor that turns readable when processEvents() has work;
+     *        -1 unless started event-driven
+     */
+    int notificationFd() const;
+
+    /**
+     * @brief Deliver the messages that arrived and flush queued sends
+     *
+     * For event-driven mode; call it on the loop thread when
+     * notificationFd() is readable.
+     */
+    void processEvents();
     
     /**
      * @brief Start the IPC communication
@@ -61,6 +118,34 @@ public:
      * @return True if message was queued successfully, false otherwise
      */
     bool sendMessage(const std::string& message);
+
+    /**
+     * @brief Send several messages as MSG_BATCH packets, one checksum and
+     *        ring write per packet instead of per message
+     * @return True if the batch was queued or written
+     *
+     * The receiver unpacks a batch in one pass; messages keep their order.
+     * Batches larger than half a ring are split.
+     */
+    bool sendBatch(const std::vector<std::string>& messages);
+
+    /**
+     * @brief Coalesce sendMessage() calls into batches
+     * @param max_delay  How long the first message of a batch may wait
+     * @param max_bytes  Framed size that sends a batch at once; 0 turns
+     *                   coalescing off
+     *
+     * The sender thread sends a batch when it reaches `max_bytes` or is
+     * `max_delay` old. Event-driven instances have no thread to watch the
+     * delay: batches then go out when full, from processEvents() once due,
+     * or on flush().
+     */
+    void setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes);
+
+    /**
+     * @brief Send the messages being coalesced now
+     */
+    void flush();
     
     /**
      * @brief Receive a message from the IPC channel (non-blocking)
@@ -69,6 +154,37 @@ public:
      */
     bool receiveMessage(std::string& message);
     
+    /**
+     * @brief Awaitable result of receive()
+     *
+     * Yields the next message, or std::nullopt once the channel is stopped.
+     */
+    struct ReceiveAwaiter {
+        IPCImplement* ipc;
+        std::optional<std::string> message;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<class Handle>
+        bool await_suspend(Handle handle) {
+            return ipc->suspendReceive(&message, [handle]() mutable { handle.resume(); });
+        }
+
+        std::optional<std::string> await_resume() { return std::move(message); }
+    };
+
+    /**
+     * @brief Wait for the next message without blocking a thread
+     *
+     * `co_await ipc.receive()` completes immediately when a message is
+     * already queued. Otherwise the coroutine is suspended and resumed on
+     * the receiver thread when one arrives, or by stop(). Waiting
+     * coroutines are served before the queue used by receiveMessage().
+     */
+    ReceiveAwaiter receive() {
+        return ReceiveAwaiter{this, std::nullopt};
+    }
+    
     /**
      * @brief Receive a raw packet from the IPC channel (for backward compatibility)
      * @param packet Pointer to store the received packet
@@ -83,6 +199,36 @@ public:
     bool isRunning() const;
 
 private:
+    struct ReceiveWaiter {
+        std::optional<std::string>* slot;
+        std::function<void()> resume;
+    };
+
+    /**
+     * @brief Fill `slot` now or park a waiter for the next message
+     * @return True if the caller must suspend until `resume` is invoked
+     */
+    bool suspendReceive(std::optional<std::string>* slot, std::function<void()> resume);
+
+    struct PendingSend {
+        MessageType type = MessageType::MSG_REQUEST;
+        std::string payload;
+        // Start of the "ipc.send_ns" latency
+        std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+    };
+
+    // Hands one message to a suspended receive(), the handler or the queue
+    void deliverMessage(std::string_view message);
+    // Unpacks MSG_BATCH payloads under a single lock
+    void deliverPayload(MessageType type, std::string_view payload);
+
+    // Call with send_mutex_ held
+    bool enqueueSend(PendingSend send);
+    void takeCoalesced();
+    // With send_mutex_ held, or from the sender thread
+    bool writeMessage(const PendingSend& send);
+    void flushSendQueue();
+
     /**
      * @brief Thread function for sending messages
      */
@@ -96,6 +242,10 @@ private:
 private:
     std::string ipc_name_;
     bool is_server_;
+    IPCSharedMemoryOptions shm_options_;
+    bool event_driven_ = false;
+    int notify_fd_ = -1;
+    std::function<void(std::string_view)> message_handler_;
     std::atomic<bool> running_;
     std::unique_ptr<IPCSharedMemory> shared_memory_;
     
@@ -103,13 +253,18 @@ private:
     std::thread sender_thread_;
     std::mutex send_mutex_;
     std::condition_variable send_cv_;
-    std::queue<std::string> send_queue_;
+    std::queue<PendingSend> send_queue_;
+    std::chrono::microseconds coalesce_delay_{0};
+    size_t coalesce_bytes_ = 0;
+    std::string coalesce_buffer_;
+    std::chrono::steady_clock::time_point coalesce_deadline_;
 
     // Receiver thread and queue
     std::thread receiver_thread_;
     std::mutex receive_mutex_;
     std::condition_variable receive_cv_;
     std::queue<std::string> receive_queue_;
+    std::deque<ReceiveWaiter> receive_waiters_;
 };
 
 } // namespace ipc
@@ -6,6 +6,9 @@
 #include <chrono>
 #include <memory>
 #include "logger.hpp"
+#include "crc32c.hpp"
+#include "arena.hpp"
+#include "memory_pool_v2.hpp"
 
 // Platform-specific includes
 #ifdef _WIN32
@@ -26,23 +29,46 @@ enum class MessageType : uint8_t {
     MSG_RESPONSE = 0x02,
     MSG_HEARTBEAT = 0x03,
     MSG_ERROR = 0x04,
-    // 0x05-0xFF reserved for future use
+    // Several messages, each framed as a uint32_t length and its bytes
+    MSG_BATCH = 0x05,
+    // 0x06-0xFF reserved for future use
 };
 
+// Payloads up to this size are stored inside the IPCPacket
+constexpr uint32_t IPC_INLINE_PAYLOAD = 64;
+
+// The writer did not checksum the packet; its checksum field is zero
+constexpr uint16_t PACKET_FLAG_UNCHECKED = 0x0001;
+
 // Packet header structure
 #pragma pack(push, 1)
 struct PacketHeader {
     uint32_t magic_id;     // Magic identifier "UTIL"
     uint8_t version;       // Protocol version
     uint8_t msg_type;      // Message type
-    uint16_t reserved;     // Reserved for future use
+    uint16_t flags;        // PACKET_FLAG_* bits, otherwise zero
     uint32_t payload_len;  // Length of the payload data
     uint32_t seq_num;      // Sequence number
     uint64_t timestamp;    // Timestamp in milliseconds
 };
 #pragma pack(pop)
 
-// Complete packet structure
+/**
+ * @brief One message with its header, as written to and read from the rings
+ *
+ * Payloads of up to IPC_INLINE_PAYLOAD bytes are stored inside the packet;
+ * larger ones come from MemoryPoolV2, whose per-thread caches recycle the
+ * buffers of packets built and dropped at a steady rate, or from an arena.
+ * Moving a packet never copies a pooled or arena payload.
+ *
+ * The CRC32C is computed only by Serialize() and checked only by
+ * IsValid(), so packets moved between queues don't pay for it. A writer
+ * that trusts its peer, e.g. the other end of a same-host shared memory
+ * segment, can serialize without it: the packet is then flagged with
+ * PACKET_FLAG_UNCHECKED. Whether that is acceptable is the reader's call:
+ * IsValid() rejects such a packet, IsValid(false) checks any packet's
+ * structure alone.
+ */
 class IPCPacket {
 public:
     // Default constructor for creating an empty packet
@@ -50,18 +76,10 @@ public:
         : header_{}
         , payload_(nullptr)
         , checksum_(0)
-        , total_size_(sizeof(PacketHeader) + sizeof(uint32_t))
+        , total_size_(0)
+        , arena_(nullptr)
     {
-        header_.magic_id = IPC_PACKET_MAGIC;
-        header_.version = 1;
-        header_.msg_type = static_cast<uint8_t>(MessageType::MSG_REQUEST);
-        header_.reserved = 0;
-        header_.payload_len = 0;
-        header_.seq_num = 0;
-        header_.timestamp = GetCurrentTimestampMs();
-        
-        // Calculate checksum
-        CalculateChecksum();
+        Build(MessageType::MSG_REQUEST, 0, nullptr, 0);
     }
 
     // Constructor for creating a new packet
@@ -69,150 +87,122 @@ public:
         : header_{}
         , payload_(nullptr)
         , checksum_(0)
-        , total_size_(sizeof(PacketHeader) + payload_len + sizeof(uint32_t))
+        , total_size_(0)
+        , arena_(nullptr)
     {
-        header_.magic_id = IPC_PACKET_MAGIC;
-        header_.version = 1;
-        header_.msg_type = static_cast<uint8_t>(type);
-        header_.reserved = 0;
-        header_.payload_len = payload_len;
-        header_.seq_num = seq_num;
-        header_.timestamp = GetCurrentTimestampMs();
-
-        if (payload_len > 0 && payload != nullptr) {
-            payload_ = new(std::nothrow) uint8_t[payload_len];
-            if (payload_) {
-                std::memcpy(payload_, payload, payload_len);
-            } else {
-                header_.payload_len = 0;
-                total_size_ = sizeof(PacketHeader) + sizeof(uint32_t);
-            }
-        }
+        Build(type, seq_num, payload, payload_len);
+    }
 
-        // Calculate checksum
-        CalculateChecksum();
+    // Constructor for creating a new packet whose payload copy lives in `arena`.
+    // The packet must not be used after the arena is reset.
+    IPCPacket(Arena& arena, MessageType type, uint32_t seq_num, const void* payload = nullptr, uint32_t payload_len = 0)
+        : header_{}
+        , payload_(nullptr)
+        , checksum_(0)
+        , total_size_(0)
+        , arena_(&arena)
+    {
+        Build(type, seq_num, payload, payload_len);
     }
 
     // Constructor for parsing received data
     IPCPacket(const void* data, uint32_t data_size)
-        : payload_(nullptr)
+        : header_{}
+        , payload_(nullptr)
         , checksum_(0)
         , total_size_(0)
+        , arena_(nullptr)
     {
-        if (!data || data_size < sizeof(PacketHeader) + sizeof(uint32_t)) {
-            return; // Invalid data or not enough data for a valid packet
-        }
-
-        // Copy header
-        std::memcpy(&header_, data, sizeof(PacketHeader));
-
-        // Validate magic ID and size
-        if (header_.magic_id != IPC_PACKET_MAGIC || header_.payload_len > data_size - sizeof(PacketHeader) - sizeof(uint32_t)) {
-            header_.magic_id = 0; // Mark as invalid
-            return;
-        }
-
-        // Calculate total size
-        total_size_ = sizeof(PacketHeader) + header_.payload_len + sizeof(uint32_t);
-
-        // Copy payload if present
-        if (header_.payload_len > 0) {
-            payload_ = new(std::nothrow) uint8_t[header_.payload_len];
-            if (payload_) {
-                std::memcpy(payload_, static_cast<const uint8_t*>(data) + sizeof(PacketHeader), header_.payload_len);
-            } else {
-                header_.magic_id = 0; // Mark as invalid
-                header_.payload_len = 0;
-                total_size_ = 0;
-                return;
-            }
-        }
+        Parse(data, data_size);
+    }
 
-        // Copy checksum
-        std::memcpy(&checksum_, static_cast<const uint8_t*>(data) + sizeof(PacketHeader) + header_.payload_len, sizeof(uint32_t));
+    // Constructor for parsing received data into an arena-backed payload
+    IPCPacket(Arena& arena, const void* data, uint32_t data_size)
+        : header_{}
+        , payload_(nullptr)
+        , checksum_(0)
+        , total_size_(0)
+        , arena_(&arena)
+    {
+        Parse(data, data_size);
     }
     
-    // Copy constructor
+    // Copy constructor; the copy never lives in an arena
     IPCPacket(const IPCPacket& other)
-        : header_(other.header_)
+        : header_{}
         , payload_(nullptr)
-        , checksum_(other.checksum_)
-        , total_size_(other.total_size_)
+        , checksum_(0)
+        , total_size_(0)
+        , arena_(nullptr)
     {
-        if (other.payload_ && other.header_.payload_len > 0) {
-            payload_ = new uint8_t[other.header_.payload_len];
-            std::memcpy(payload_, other.payload_, other.header_.payload_len);
-        }
+        CopyFrom(other);
     }
     
     // Assignment operator
     IPCPacket& operator=(const IPCPacket& other) {
         if (this != &other) {
-            delete[] payload_;
-            payload_ = nullptr;
-            
-            header_ = other.header_;
-            checksum_ = other.checksum_;
-            total_size_ = other.total_size_;
-            
-            if (other.payload_ && other.header_.payload_len > 0) {
-                payload_ = new uint8_t[other.header_.payload_len];
-                std::memcpy(payload_, other.payload_, other.header_.payload_len);
-            }
+            ReleasePayload();
+            arena_ = nullptr;
+            CopyFrom(other);
         }
         return *this;
     }
     
     // Move constructor
     IPCPacket(IPCPacket&& other) noexcept
-        : header_(other.header_)
-        , payload_(other.payload_)
-        , checksum_(other.checksum_)
-        , total_size_(other.total_size_)
+        : header_{}
+        , payload_(nullptr)
+        , checksum_(0)
+        , total_size_(0)
+        , arena_(nullptr)
     {
-        other.payload_ = nullptr;
-        other.total_size_ = 0;
-        other.header_.payload_len = 0;
+        MoveFrom(other);
     }
     
     // Move assignment operator
     IPCPacket& operator=(IPCPacket&& other) noexcept {
         if (this != &other) {
-            delete[] payload_;
-            
-            header_ = other.header_;
-            payload_ = other.payload_;
-            checksum_ = other.checksum_;
-            total_size_ = other.total_size_;
-            
-            other.payload_ = nullptr;
-            other.total_size_ = 0;
-            other.header_.payload_len = 0;
+            ReleasePayload();
+            MoveFrom(other);
         }
         return *this;
     }
 
     // Destructor
     ~IPCPacket() {
-        delete[] payload_;
+        ReleasePayload();
     }
 
-    // Serialize packet to buffer
-    bool Serialize(void* buffer, uint32_t buffer_size) const {
+    /**
+     * @brief Serialize packet to buffer
+     * @param checksum False to flag the packet PACKET_FLAG_UNCHECKED and
+     *                 skip the CRC, for a reader that trusts this writer
+     */
+    bool Serialize(void* buffer, uint32_t buffer_size, bool checksum = true) const {
         if (buffer_size < total_size_) {
             return false; // Buffer too small
         }
 
-        // Copy header
-        std::memcpy(buffer, &header_, sizeof(PacketHeader));
+        PacketHeader header = header_;
+        if (checksum) {
+            header.flags &= static_cast<uint16_t>(~PACKET_FLAG_UNCHECKED);
+        } else {
+            header.flags |= PACKET_FLAG_UNCHECKED;
+        }
+        uint8_t* out = static_cast<uint8_t*>(buffer);
+        std::memcpy(out, &header, sizeof(PacketHeader));
 
         // Copy payload if present
         if (header_.payload_len > 0 && payload_ != nullptr) {
-            std::memcpy(static_cast<uint8_t*>(buffer) + sizeof(PacketHeader), payload_, header_.payload_len);
+            std::memcpy(out + sizeof(PacketHeader), payload_, header_.payload_len);
         }
 
-        // Copy checksum
-        std::memcpy(static_cast<uint8_t*>(buffer) + sizeof(PacketHeader) + header_.payload_len, &checksum_, sizeof(uint32_t));
+        // A parsed packet already carries the checksum of what it holds
+        uint32_t crc = 0;
+        if (checksum) {
+            crc = checksum_known_ && !IsUnchecked() ? checksum_ : ComputeChecksum(header);
+        }
+        std::memcpy(out + sizeof(PacketHeader) + header_.payload_len, &crc, sizeof(uint32_t));
 
         return true;
     }
@@ -233,14 +223,20 @@ public:
     const PacketHeader& GetHeader() const { return header_; }
     const uint8_t* GetPayload() const { return payload_; }
     uint32_t GetPayloadLength() const { return header_.payload_len; }
-    uint32_t GetChecksum() const { return checksum_; }
+    // The received checksum of a parsed packet, else the one Serialize() writes
+    uint32_t GetChecksum() const { return checksum_known_ ? checksum_ : ComputeChecksum(header_); }
     uint32_t GetTotalSize() const { return total_size_; }
     MessageType GetMessageType() const { return static_cast<MessageType>(header_.msg_type); }
     uint32_t GetSequenceNumber() const { return header_.seq_num; }
     uint64_t GetTimestamp() const { return header_.timestamp; }
+    bool IsArenaBacked() const { return arena_ != nullptr; }
+    bool IsInline() const { return payload_ != nullptr && payload_ == inline_; }
+    // True if the writer left the checksum out
+    bool IsUnchecked() const { return (header_.flags & PACKET_FLAG_UNCHECKED) != 0; }
 
-    // Validate the packet's checksum and structure
-    bool IsValid() const {
+    // Validate the packet's structure and, if `checksum`, its CRC; a packet
+    // without one only passes when the checksum is not required
+    bool IsValid(bool checksum = true) const {
         if (header_.magic_id != IPC_PACKET_MAGIC || total_size_ == 0) {
             SAK::log::Logger::instance().log(SAK::log::Level::LOG_DEBUG, __FILE__, __FUNCTION__, __LINE__, "Invalid magic ID %u or total size %u", header_.magic_id, total_size_);
             return false;
@@ -249,42 +245,142 @@ public:
             SAK::log::Logger::instance().log(SAK::log::Level::LOG_ERROR, __FILE__, __FUNCTION__, __LINE__, "Invalid payload");
             return false;
         }
-        uint32_t calculated_checksum = CalculateChecksumInternal();
+        if (!checksum || !checksum_known_) {
+            // Trusted by the reader, or built here and not yet serialized
+            return true;
+        }
+        if (IsUnchecked()) {
+            LOG_ERROR("Packet carries no checksum");
+            return false;
+        }
+        uint32_t calculated_checksum = ComputeChecksum(header_);
         LOG_DEBUG("Calculated checksum: %u, stored checksum: %u", calculated_checksum, checksum_);
         return calculated_checksum == checksum_;
     }
 
 private:
-    // Calculate CRC32 checksum
-    void CalculateChecksum() {
-        checksum_ = CalculateChecksumInternal();
+    void Build(MessageType type, uint32_t seq_num, const void* payload, uint32_t payload_len) {
+        header_.magic_id = IPC_PACKET_MAGIC;
+        header_.version = 1;
+        header_.msg_type = static_cast<uint8_t>(type);
+        header_.flags = 0;
+        header_.payload_len = 0;
+        header_.seq_num = seq_num;
+        header_.timestamp = GetCurrentTimestampMs();
+        total_size_ = sizeof(PacketHeader) + sizeof(uint32_t);
+        checksum_known_ = false;
+
+        if (payload_len > 0 && payload != nullptr) {
+            payload_ = AllocatePayload(payload_len);
+            if (payload_) {
+                std::memcpy(payload_, payload, payload_len);
+                header_.payload_len = payload_len;
+                total_size_ += payload_len;
+            }
+        }
     }
 
-    uint32_t CalculateChecksumInternal() const {
-        // Simple CRC32 implementation
-        // In a real implementation, you would use a standard CRC32 algorithm
-        uint32_t crc = 0xFFFFFFFF;
-        
-        // Include header in checksum
-        const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header_);
-        for (size_t i = 0; i < sizeof(PacketHeader); ++i) {
-            crc ^= header_bytes[i];
-            for (int j = 0; j < 8; ++j) {
-                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    void Parse(const void* data, uint32_t data_size) {
+        if (!data || data_size < sizeof(PacketHeader) + sizeof(uint32_t)) {
+            return; // Invalid data or not enough data for a valid packet
+        }
+
+        // Copy header
+        std::memcpy(&header_, data, sizeof(PacketHeader));
+
+        // Validate magic ID and size
+        if (header_.magic_id != IPC_PACKET_MAGIC || header_.payload_len > data_size - sizeof(PacketHeader) - sizeof(uint32_t)) {
+            header_.magic_id = 0; // Mark as invalid
+            header_.payload_len = 0;
+            return;
+        }
+
+        // Calculate total size
+        total_size_ = sizeof(PacketHeader) + header_.payload_len + sizeof(uint32_t);
+
+        // Copy payload if present
+        if (header_.payload_len > 0) {
+            payload_ = AllocatePayload(header_.payload_len);
+            if (payload_) {
+                std::memcpy(payload_, static_cast<const uint8_t*>(data) + sizeof(PacketHeader), header_.payload_len);
+            } else {
+                header_.magic_id = 0; // Mark as invalid
+                header_.payload_len = 0;
+                total_size_ = 0;
+                return;
             }
         }
-        
-        // Include payload in checksum if present
-        if (header_.payload_len > 0 && payload_ != nullptr) {
-            for (uint32_t i = 0; i < header_.payload_len; ++i) {
-                crc ^= payload_[i];
-                for (int j = 0; j < 8; ++j) {
-                    crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-                }
+
+        // Kept for IsValid(), which does the verification
+        std::memcpy(&checksum_, static_cast<const uint8_t*>(data) + sizeof(PacketHeader) + header_.payload_len, sizeof(uint32_t));
+        checksum_known_ = true;
+    }
+
+    // With the payload released
+    void CopyFrom(const IPCPacket& other) {
+        header_ = other.header_;
+        header_.payload_len = 0;
+        payload_ = nullptr;
+        checksum_ = other.checksum_;
+        checksum_known_ = other.checksum_known_;
+        total_size_ = other.total_size_;
+
+        if (other.payload_ && other.header_.payload_len > 0) {
+            payload_ = AllocatePayload(other.header_.payload_len);
+            if (!payload_) {
+                header_.magic_id = 0; // Mark as invalid
+                total_size_ = 0;
+                return;
             }
+            std::memcpy(payload_, other.payload_, other.header_.payload_len);
+            header_.payload_len = other.header_.payload_len;
         }
-        
-        return ~crc;
+    }
+
+    // With the payload released; leaves `other` empty
+    void MoveFrom(IPCPacket& other) noexcept {
+        header_ = other.header_;
+        checksum_ = other.checksum_;
+        checksum_known_ = other.checksum_known_;
+        total_size_ = other.total_size_;
+        arena_ = other.arena_;
+        if (other.IsInline()) {
+            std::memcpy(inline_, other.inline_, other.header_.payload_len);
+            payload_ = inline_;
+        } else {
+            payload_ = other.payload_;
+        }
+
+        other.payload_ = nullptr;
+        other.total_size_ = 0;
+        other.header_.payload_len = 0;
+    }
+
+    uint8_t* AllocatePayload(uint32_t len) {
+        if (arena_) {
+            return static_cast<uint8_t*>(arena_->Allocate(len, 1));
+        }
+        if (len <= IPC_INLINE_PAYLOAD) {
+            return inline_;
+        }
+        return static_cast<uint8_t*>(MemoryPoolV2::GetInstance().Allocate(len));
+    }
+
+    // Arena payloads are reclaimed by Arena::Reset()
+    void ReleasePayload() {
+        if (payload_ && !arena_ && !IsInline()) {
+            MemoryPoolV2::GetInstance().Deallocate(payload_, header_.payload_len);
+        }
+        payload_ = nullptr;
+    }
+
+    // CRC32C of `header` followed by the payload
+    uint32_t ComputeChecksum(const PacketHeader& header) const {
+        uint32_t crc = Crc32c::Compute(&header, sizeof(PacketHeader));
+        if (header_.payload_len > 0 && payload_ != nullptr) {
+            crc = Crc32c::Extend(crc, payload_, header_.payload_len);
+        }
+        return crc;
     }
 
     // Get current timestamp in milliseconds
@@ -295,9 +391,12 @@ private:
     }
 
     PacketHeader header_;
-    uint8_t* payload_;
-    uint32_t checksum_;
+    uint8_t* payload_;       // inline_, a MemoryPoolV2 block or arena memory
+    uint32_t checksum_;      // As received; meaningful if checksum_known_
+    bool checksum_known_ = false;
     uint32_t total_size_;
+    Arena* arena_;           // Owner of payload_ when not null
+    alignas(8) uint8_t inline_[IPC_INLINE_PAYLOAD];
 };
 
 } // namespace ipc
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 #include "logger.hpp"
 #include "ipc_packet.hpp"
 
@@ -24,9 +25,29 @@ namespace SAK {
 namespace ipc {
 
 // Shared memory constants
-constexpr size_t SHM_BUFFER_SIZE = 1024 * 1024; // 1MB buffer size
+constexpr size_t SHM_BUFFER_SIZE = 1024 * 1024; // Default ring size per direction (1MB)
+constexpr size_t SHM_MIN_RING_SIZE = 4096;
+constexpr size_t SHM_MAX_RING_SIZE = size_t(1) << 30;
+constexpr uint32_t SHM_MAX_CHANNELS = 64;
+constexpr size_t SHM_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
 constexpr int SHM_PERMISSIONS = 0666;           // Read/write permissions
 constexpr int SEM_PERMISSIONS = 0666;           // Semaphore permissions
+constexpr size_t SHM_CACHE_LINE = 64;
+
+/**
+ * @brief How the two sides of a channel coordinate access to the buffers
+ *
+ * Both sides must use the same transport; the server records its choice
+ * in the header and a client with a different one fails to initialise.
+ */
+enum class IPCTransport : uint32_t {
+    // System V semaphores around every read and write
+    semaphore = 1,
+    // Each direction is a lock-free single-producer/single-consumer ring;
+    // a reader that runs dry parks on a futex and the writer only makes
+    // the wake-up syscall when it sees the reader parked
+    spsc_ring = 2
+};
 
 // Semaphore indices
 enum SEM_INDEX {
@@ -37,46 +58,203 @@ enum SEM_INDEX {
     SEM_COUNT = 4          // Total number of semaphores
 };
 
-// Shared memory buffer structure
+/**
+ * @brief Shape of a shared memory segment; both sides must agree on it
+ */
+struct IPCSharedMemoryOptions {
+    IPCTransport transport = IPCTransport::semaphore;
+    // Bytes per direction and channel; a power of two between
+    // SHM_MIN_RING_SIZE and SHM_MAX_RING_SIZE
+    size_t ring_size = SHM_BUFFER_SIZE;
+    // Independent ring pairs, each with its own producer per side, so
+    // several sending threads don't contend; more than one needs spsc_ring
+    uint32_t channels = 1;
+    // Back the segment with huge pages (SHM_HUGETLB), falling back to
+    // normal pages when none are available; ignored on Windows
+    bool huge_pages = false;
+    // Checksum every packet this side writes, and require and verify the
+    // checksum of every packet it reads, rejecting PACKET_FLAG_UNCHECKED
+    // ones. Turning it off trusts the peer and the memory between them,
+    // which can hold on one host: written packets are flagged unchecked and
+    // read ones are taken without a CRC. Both sides must turn it off for
+    // unchecked packets to get through
+    bool checksums = true;
+};
+
+// Shared memory layout: one SharedMemorySegmentHeader, then per channel a
+// SharedMemoryHeader followed by the server_to_client and client_to_server
+// rings of ring_size bytes each
 #pragma pack(push, 1)
+struct SharedMemorySegmentHeader {
+    std::atomic<uint32_t> transport;         // IPCTransport chosen by the server
+    uint32_t ring_size;
+    uint32_t channel_count;
+    // Ring transport: number of that side's readers sleeping on its doorbell,
+    // which writers ring when they see one
+    std::atomic<uint32_t> server_readers_parked;
+    std::atomic<uint32_t> client_readers_parked;
+    std::atomic<uint32_t> server_doorbell;
+    std::atomic<uint32_t> client_doorbell;
+    // Notifier (see IPCSharedMemory::OpenNotifier): that side wants a wake-up
+    // on its descriptor for new data, or for room freed in the rings it writes
+    std::atomic<uint32_t> server_notify_armed;
+    std::atomic<uint32_t> client_notify_armed;
+    std::atomic<uint32_t> server_space_armed;
+    std::atomic<uint32_t> client_space_armed;
+    char pad[SHM_CACHE_LINE - 11 * sizeof(uint32_t)];
+};
+
+// Each position sits on its own cache line so the producer and the
+// consumer of a direction don't invalidate each other's line
 struct SharedMemoryHeader {
     std::atomic<uint32_t> server_write_pos;  // Position where server writes
+    char pad0[SHM_CACHE_LINE - sizeof(uint32_t)];
     std::atomic<uint32_t> server_read_pos;   // Position where server reads
+    char pad1[SHM_CACHE_LINE - sizeof(uint32_t)];
     std::atomic<uint32_t> client_write_pos;  // Position where client writes
+    char pad2[SHM_CACHE_LINE - sizeof(uint32_t)];
     std::atomic<uint32_t> client_read_pos;   // Position where client reads
+    char pad3[SHM_CACHE_LINE - sizeof(uint32_t)];
 
     // Note: For cross-process atomic operations, always use std::memory_order_seq_cst
     // to ensure proper synchronization between processes on all architectures
 };
 
-struct SharedMemoryBuffer {
-    SharedMemoryHeader header;
-    char server_to_client[SHM_BUFFER_SIZE];  // Buffer for server-to-client communication
-    char client_to_server[SHM_BUFFER_SIZE];  // Buffer for client-to-server communication
-};
 #pragma pack(pop)
 
 // Forward declaration
 class IPCPacket;
 
+// A packet read in place from the shared memory ring; see PeekRead()
+struct PacketView {
+    const PacketHeader* header;
+    const uint8_t* payload;
+    uint32_t payload_len;
+};
+
 class IPCSharedMemory {
 public:
-    IPCSharedMemory(const std::string& ipc_name, bool is_server);
+    IPCSharedMemory(const std::string& ipc_name, bool is_server,
+                    IPCTransport transport = IPCTransport::semaphore);
+    IPCSharedMemory(const std::string& ipc_name, bool is_server, const IPCSharedMemoryOptions& options);
     ~IPCSharedMemory();
 
     bool Init();
     bool Uninit();
 
-    // Writer methods
-    bool WritePacket(const IPCPacket& packet);
+    // Writer methods; each channel takes one writing thread per side
+    bool WritePacket(const IPCPacket& packet, uint32_t channel = 0);
     
-    // Reader methods
-    bool ReadPacket(IPCPacket *packet);
+    // Reader methods; each channel takes one reading thread per side
+    bool ReadPacket(IPCPacket *packet, uint32_t channel = 0);
+
+    /**
+     * @brief Block until the other side may have written, or `timeout_ms`
+     * @return True if data is waiting to be read on any channel
+     *
+     * With the ring transport the reader parks on a futex (a short sleep
+     * where futexes are unavailable); with semaphores it sleeps briefly.
+     */
+    bool WaitForData(uint32_t timeout_ms);
+
+    // Wakes a thread of this side blocked in WaitForData(), e.g. to stop it
+    void WakeReader();
+
+    /**
+     * @brief A descriptor for an event loop that turns readable when the
+     *        other side writes, while armed with ArmNotifier()
+     * @return The descriptor, or -1 where unsupported (Windows)
+     *
+     * The other side pays one datagram send for the first packet after each
+     * ArmNotifier(), nothing for the following ones; it finds this side's
+     * AF_UNIX socket through the segment's key.
+     */
+    int OpenNotifier();
+    void CloseNotifier();
+
+    /**
+     * @brief Drain the notifier and arm it for the next packet
+     * @return True if data is already waiting, i.e. keep reading
+     */
+    bool ArmNotifier();
+
+    // Also notify once the other side frees room in the rings this side writes
+    void WatchForSpace();
+
+    /**
+     * @brief Zero-copy send: reserve room for a `payload_len` byte payload
+     *        directly inside the ring (ring transport only)
+     * @return Where to write the payload, or nullptr if the ring is full
+     *
+     * Nothing is visible to the reader until CommitWrite(); CancelWrite()
+     * drops the reservation. Only one reservation can be open at a time and
+     * WritePacket() fails while it is.
+     */
+    uint8_t* ReserveWrite(uint32_t payload_len, uint32_t channel = 0);
+
+    // Publishes the reserved packet; `payload_len` may be less than reserved
+    bool CommitWrite(MessageType type, uint32_t seq_num, uint32_t payload_len, uint32_t channel = 0);
+    void CancelWrite(uint32_t channel = 0);
+
+    /**
+     * @brief Zero-copy receive: view the next valid packet where it lies in
+     *        the ring (ring transport only)
+     *
+     * The view stays valid, and its space stays taken, until ReleaseRead().
+     * Packets failing validation are skipped.
+     */
+    bool PeekRead(PacketView* view, uint32_t channel = 0);
+    void ReleaseRead(uint32_t channel = 0);
     
     // Common methods
     bool IsInitialized() const { return initialized_; }
+    IPCTransport GetTransport() const { return options_.transport; }
+    const IPCSharedMemoryOptions& GetOptions() const { return options_; }
+    uint32_t GetChannelCount() const { return options_.channels; }
+    // True when this side created the segment on huge pages
+    bool UsesHugePages() const { return huge_pages_; }
 
 private:
+    // One direction of a channel as seen from this side
+    struct Direction {
+        char* buffer;
+        std::atomic<uint32_t>* write_pos;
+        std::atomic<uint32_t>* read_pos;
+        std::atomic<uint32_t>* readers_parked;  // Of the reading side
+        std::atomic<uint32_t>* doorbell;        // Of the reading side
+        std::atomic<uint32_t>* notify_armed;    // Of the reading side
+        std::atomic<uint32_t>* space_armed;     // Of the writing side
+    };
+    Direction Outgoing(uint32_t channel) const;
+    Direction Incoming(uint32_t channel) const;
+    SharedMemorySegmentHeader* Segment() const {
+        return reinterpret_cast<SharedMemorySegmentHeader*>(shm_base_);
+    }
+    SharedMemoryHeader* Channel(uint32_t channel) const;
+    size_t SegmentSize() const;
+    bool ValidateOptions() const;
+    bool HasData(uint32_t channel) const;
+    bool HasAnyData() const;
+
+    // Notifier plumbing; `armed` is the flag the other side set
+    void NotifyPeerIf(std::atomic<uint32_t>* armed);
+    void SignalSpace(const Direction& in);
+
+    // Per-channel state of the zero-copy calls
+    struct ChannelState {
+        uint32_t reserved_head = 0;
+        uint32_t reserved_size = 0;            // Open reservation when != 0
+        uint32_t peeked_size = 0;              // Held peek when != 0
+    };
+
+    // Ring transport: positions count bytes and wrap at 2^32
+    char* ReserveRecord(uint32_t channel, uint32_t packet_size);
+    void PublishRecord(uint32_t channel, uint32_t packet_size);
+    const char* PeekRecord(uint32_t channel, uint32_t* packet_size);
+    void ConsumeRecord(uint32_t channel);
+    bool WriteRing(const IPCPacket& packet, uint32_t channel);
+    bool ReadRing(IPCPacket* packet, uint32_t channel);
+
     // Generate a unique key for shared memory and semaphores
     int GenerateKey(const std::string& name, bool is_sem);
     
@@ -95,6 +273,8 @@ private:
 private:
     std::string ipc_name_;
     bool is_server_;
+    IPCSharedMemoryOptions options_;
+    uint32_t ring_mask_;
     
     // Keys for POSIX IPC
     int shm_key_;
@@ -109,10 +289,16 @@ private:
     int sem_id_;
 #endif
     
-    SharedMemoryBuffer* shm_buffer_;
+    char* shm_base_;
+    bool huge_pages_ = false;
+
+    // Our notifier socket, and an unbound one to reach the other side's
+    int notify_fd_ = -1;
+    int peer_notify_fd_ = -1;
     
     // State
     bool initialized_ = false;
+    std::vector<ChannelState> channel_state_;
 };
 
 } // namespace ipc
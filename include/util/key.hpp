@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "byte_buffer.hpp"
@@ -49,7 +50,11 @@ public:
      * @return size_t Key length
      */
     size_t Size() const {
-        return AsRef().size();
+        if constexpr (std::is_same_v<T, ByteBuffer>) {
+            return data_.Size();
+        } else {
+            return data_.size();
+        }
     }
 
     /**
@@ -59,7 +64,7 @@ public:
      * @return false if not empty
      */
     bool Empty() const {
-        return AsRef().empty();
+        return Size() == 0;
     }
 
     /**
@@ -109,7 +114,7 @@ public:
      * @return false if not equal
      */
     bool operator==(const Key& other) const {
-        return AsRef() == other.AsRef();
+        return Compare(other) == 0;
     }
 
     /**
@@ -131,7 +136,7 @@ public:
      * @return false otherwise
      */
     bool operator<(const Key& other) const {
-        return AsRef() < other.AsRef();
+        return Compare(other) < 0;
     }
 
     /**
@@ -142,7 +147,7 @@ public:
      * @return false otherwise
      */
     bool operator>(const Key& other) const {
-        return AsRef() > other.AsRef();
+        return Compare(other) > 0;
     }
 
     /**
@@ -153,7 +158,7 @@ public:
      * @return false otherwise
      */
     bool operator<=(const Key& other) const {
-        return AsRef() <= other.AsRef();
+        return Compare(other) <= 0;
     }
 
     /**
@@ -164,10 +169,23 @@ public:
      * @return false otherwise
      */
     bool operator>=(const Key& other) const {
-        return AsRef() >= other.AsRef();
+        return Compare(other) >= 0;
     }
 
 private:
+    // Compares the raw bytes; no ByteBuffer is built per comparison
+    int Compare(const Key& other) const noexcept {
+        return ByteBuffer::Compare(Bytes(), Size(), other.Bytes(), other.Size());
+    }
+
+    const char* Bytes() const noexcept {
+        if constexpr (std::is_same_v<T, ByteBuffer>) {
+            return data_.Data();
+        } else {
+            return reinterpret_cast<const char*>(data_.data());
+        }
+    }
+
     T data_;
 };
 
@@ -64,9 +64,9 @@ public:
      * version first (highest timestamp) that is at or below our read timestamp.
      */
     bool operator<(const KeyTs& other) const noexcept {
-        // Primary order: user key (ascending)
-        if (key_ < other.key_) return true;
-        if (other.key_ < key_) return false;
+        // Primary order: user key (ascending), in a single comparison
+        int cmp = key_.Compare(other.key_);
+        if (cmp != 0) return cmp < 0;
         
         // Secondary order: timestamp (descending - newer first)
         return ts_ > other.ts_;
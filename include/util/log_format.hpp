@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace SAK {
+namespace log {
+namespace detail {
+
+// Binary capture of printf-style arguments for deferred log formatting.
+//
+// Fixed-size arguments (arithmetic values, enums, pointers) are stored
+// first, back to back, followed by the C strings with their terminators.
+// The decoder is instantiated for the same argument types, so it knows the
+// layout without any tags in the payload. Strings are cut short when the
+// payload runs out; fixed-size arguments always fit (checked at compile
+// time).
+
+template<typename T>
+struct is_log_string
+    : std::integral_constant<bool, std::is_same<T, const char*>::value || std::is_same<T, char*>::value> {};
+
+// The type an argument bound to `const T&` is captured as; char arrays
+// become `const char*`
+template<typename T>
+using log_arg_t = std::decay_t<const T>;
+
+template<typename T, typename = void>
+struct log_arg_storage {
+    static_assert(!std::is_same<T, std::string>::value,
+                  "deferred logging copies C strings only; pass .c_str()");
+    static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value,
+                  "deferred logging supports arithmetic, enum, pointer and C string arguments");
+    using type = std::conditional_t<std::is_pointer<T>::value, const void*, T>;
+};
+
+template<typename T>
+struct log_arg_storage<T, std::enable_if_t<std::is_enum<T>::value>> {
+    using type = std::underlying_type_t<T>;
+};
+
+template<typename T>
+constexpr std::size_t log_fixed_size() {
+    return is_log_string<T>::value ? 0 : sizeof(typename log_arg_storage<T>::type);
+}
+
+template<typename... Args>
+constexpr std::size_t log_fixed_total() {
+    std::size_t total = 0;
+    ((total += log_fixed_size<Args>()), ...);
+    return total;
+}
+
+class arg_writer {
+public:
+    arg_writer(char* buffer, std::size_t capacity, std::size_t fixed_total)
+        : fixed_(buffer), strings_(buffer + fixed_total), end_(buffer + capacity) {}
+
+    template<typename T>
+    void write(const T& value) {
+        if constexpr (is_log_string<T>::value) {
+            const char* text = value ? value : "(null)";
+            std::size_t room = static_cast<std::size_t>(end_ - strings_);
+            if (room == 0) return;
+            std::size_t length = std::strlen(text);
+            if (length > room - 1) length = room - 1;
+            std::memcpy(strings_, text, length);
+            strings_[length] = '\0';
+            strings_ += length + 1;
+        } else {
+            using stored = typename log_arg_storage<T>::type;
+            stored raw = (stored)(value);
+            std::memcpy(fixed_, &raw, sizeof(raw));
+            fixed_ += sizeof(raw);
+        }
+    }
+
+    char* end() const { return strings_; }
+
+private:
+    char* fixed_;
+    char* strings_;
+    char* end_;
+};
+
+class arg_reader {
+public:
+    arg_reader(const char* payload, std::size_t length, std::size_t fixed_total)
+        : fixed_(payload), strings_(payload + fixed_total), end_(payload + length) {}
+
+    template<typename T>
+    auto read() {
+        if constexpr (is_log_string<T>::value) {
+            // A string the writer had no room for reads as empty
+            if (strings_ >= end_) return static_cast<const char*>("");
+            const char* text = strings_;
+            strings_ += std::strlen(text) + 1;
+            return text;
+        } else {
+            typename log_arg_storage<T>::type value;
+            std::memcpy(&value, fixed_, sizeof(value));
+            fixed_ += sizeof(value);
+            return value;
+        }
+    }
+
+private:
+    const char* fixed_;
+    const char* strings_;
+    const char* end_;
+};
+
+/// Encodes `args` into `buffer`; returns the number of bytes used
+template<typename... Args>
+std::size_t encode_log_args(char* buffer, std::size_t capacity, const Args&... args) {
+    constexpr std::size_t fixed_total = log_fixed_total<Args...>();
+    static_assert(fixed_total <= 192, "too many fixed-size arguments for one deferred log record");
+    arg_writer writer(buffer, capacity, fixed_total);
+    (writer.write(args), ...);
+    return static_cast<std::size_t>(writer.end() - buffer);
+}
+
+template<typename Tuple, std::size_t... I>
+int format_decoded(char* out, std::size_t capacity, const char* fmt, const Tuple& values,
+                   std::index_sequence<I...>) {
+    return std::snprintf(out, capacity, fmt, std::get<I>(values)...);
+}
+
+/**
+ * @brief Formats a payload written by encode_log_args<Args...>() with `fmt`
+ * @return Length of the text in `out`, which is always NUL-terminated
+ */
+template<typename... Args>
+std::size_t format_log_args(const char* fmt, const char* payload, std::size_t length,
+                            char* out, std::size_t capacity) {
+    if (capacity == 0) return 0;
+    int written;
+    if constexpr (sizeof...(Args) == 0) {
+        (void)payload;
+        (void)length;
+        // Nothing to substitute; only "%%" needs translating
+        std::size_t n = 0;
+        for (const char* p = fmt; *p && n + 1 < capacity; ++p) {
+            if (p[0] == '%' && p[1] == '%') ++p;
+            out[n++] = *p;
+        }
+        out[n] = '\0';
+        written = static_cast<int>(n);
+    } else {
+        arg_reader reader(payload, length, log_fixed_total<Args...>());
+        // Braced initialisation reads the arguments left to right
+        std::tuple<decltype(reader.template read<Args>())...> values{reader.template read<Args>()...};
+        written = format_decoded(out, capacity, fmt, values, std::index_sequence_for<Args...>{});
+    }
+    if (written < 0) return 0;
+    return static_cast<std::size_t>(written) < capacity ? static_cast<std::size_t>(written) : capacity - 1;
+}
+
+// Never called; lets the compiler check deferred format strings like printf's
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void check_log_format(const char*, ...) {}
+
+} // namespace detail
+} // namespace log
+} // namespace SAK
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <process.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace SAK {
+namespace log {
+
+struct FileSinkConfig {
+    std::filesystem::path dir;
+    size_t max_file_size = 10 * 1024 * 1024;
+    size_t max_files = 0;                        // Files kept by this sink, 0: unlimited
+    std::chrono::seconds rotate_interval{0};     // 0: rotate by size only
+    std::chrono::milliseconds sync_interval{0};  // fdatasync cadence, 0: never
+};
+
+/**
+ * @brief Append-only log file writer with size and time based rotation
+ *
+ * Writes go straight to an O_APPEND descriptor, several buffers at a time
+ * with writev, and the byte count is tracked in memory instead of asking
+ * the file system after every line. The file that rotation switches to is
+ * opened in advance, so rotating is a descriptor swap; the following file
+ * is prepared right after, on the same (logging) thread. Not thread-safe.
+ */
+class FileSink {
+public:
+    FileSink() = default;
+    ~FileSink() { close(); }
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    /// Closes any open file and starts a new one in `config.dir`
+    bool open(const FileSinkConfig& config) {
+        close();
+        config_ = config;
+        if (!prepare_next()) return false;
+        return rotate();
+    }
+
+    void close() {
+        if (fd_ >= 0) {
+            if (config_.sync_interval.count() > 0) sync_file(fd_);
+            close_file(fd_);
+            fd_ = -1;
+        }
+        if (next_fd_ >= 0) {
+            close_file(next_fd_);
+            next_fd_ = -1;
+            // Never written to; don't leave an empty file behind
+            std::error_code ec;
+            std::filesystem::remove(next_path_, ec);
+        }
+        files_.clear();
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+    const std::filesystem::path& path() const { return path_; }
+    uint64_t rotations() const { return rotations_; }
+
+    /// Writes `size` bytes; a file that fills up is ended at a line break
+    void write(const char* data, size_t size) {
+        while (fd_ >= 0 && size > 0) {
+            size_t take = size;
+            size_t room = remaining();
+            if (size > room) {
+                const char* from = data + (room ? room - 1 : 0);
+                const void* newline = std::memchr(from, '\n', static_cast<size_t>(data + size - from));
+                if (newline) take = static_cast<size_t>(static_cast<const char*>(newline) - data) + 1;
+            }
+            write_range(data, take);
+            data += take;
+            size -= take;
+            after_write();
+        }
+    }
+
+    /// Writes `count` entries in order with as few system calls as possible;
+    /// rotation happens between entries
+    void write(const std::string* entries, size_t count) {
+        size_t i = 0;
+        while (fd_ >= 0 && i < count) {
+#ifdef _WIN32
+            write_range(entries[i].data(), entries[i].size());
+            ++i;
+#else
+            struct iovec iov[MAX_IOV];
+            int n = 0;
+            size_t pending = 0;
+            size_t room = remaining();
+            for (; i < count && n < MAX_IOV && (n == 0 || pending < room); ++i) {
+                if (entries[i].empty()) continue;
+                iov[n].iov_base = const_cast<char*>(entries[i].data());
+                iov[n].iov_len = entries[i].size();
+                pending += entries[i].size();
+                ++n;
+            }
+            if (n) writev_all(iov, n);
+#endif
+            after_write();
+        }
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int MAX_IOV = 64;
+
+    size_t remaining() const {
+        return config_.max_file_size > written_ ? config_.max_file_size - written_ : 0;
+    }
+
+    void write_range(const char* data, size_t size) {
+#ifdef _WIN32
+        write_all(data, size);
+#else
+        struct iovec one{const_cast<char*>(data), size};
+        writev_all(&one, 1);
+#endif
+    }
+
+#ifdef _WIN32
+    void write_all(const char* data, size_t size) {
+        while (size > 0) {
+            int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+            int n = _write(fd_, data, static_cast<unsigned>(chunk));
+            if (n <= 0) return;
+            data += n;
+            size -= static_cast<size_t>(n);
+            written_ += static_cast<size_t>(n);
+        }
+    }
+#else
+    // Retries short writes; other errors drop the rest like the stream did
+    void writev_all(struct iovec* iov, int count) {
+        while (count > 0) {
+            ssize_t n = ::writev(fd_, iov, count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            written_ += static_cast<size_t>(n);
+            size_t left = static_cast<size_t>(n);
+            while (count > 0 && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+    }
+#endif
+
+    void after_write() {
+        bool timed = config_.rotate_interval.count() > 0 || config_.sync_interval.count() > 0;
+        clock::time_point now = timed ? clock::now() : clock::time_point();
+        if (config_.sync_interval.count() > 0 && now - last_sync_ >= config_.sync_interval) {
+            sync_file(fd_);
+            last_sync_ = now;
+        }
+        bool full = written_ >= config_.max_file_size;
+        bool expired = config_.rotate_interval.count() > 0 && now >= rotate_at_;
+        if (full || expired) {
+            rotate();
+        }
+    }
+
+    // Switches to the pre-opened file, then opens the one after it
+    bool rotate() {
+        if (next_fd_ < 0 && !prepare_next()) return false;
+        if (fd_ >= 0) {
+            if (config_.sync_interval.count() > 0) sync_file(fd_);
+            close_file(fd_);
+            ++rotations_;
+        }
+        fd_ = next_fd_;
+        path_ = next_path_;
+        next_fd_ = -1;
+        written_ = 0;
+        last_sync_ = rotate_at_ = clock::now();
+        rotate_at_ += config_.rotate_interval;
+
+        files_.push_back(path_);
+        while (config_.max_files > 0 && files_.size() > config_.max_files) {
+            std::error_code ec;
+            std::filesystem::remove(files_.front(), ec);
+            files_.pop_front();
+        }
+        prepare_next();
+        return true;
+    }
+
+    bool prepare_next() {
+        next_path_ = make_path();
+#ifdef _WIN32
+        next_fd_ = _open(next_path_.string().c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY,
+                         _S_IREAD | _S_IWRITE);
+#else
+        next_fd_ = ::open(next_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+        return next_fd_ >= 0;
+    }
+
+    // log_<pid>_<time>_<sequence>.log; the sequence keeps files opened
+    // within the same second apart
+    std::filesystem::path make_path() {
+        auto time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+#ifdef _WIN32
+        auto pid = _getpid();
+#else
+        auto pid = getpid();
+#endif
+        std::string name = "log_" + std::to_string(pid) + "_" + std::to_string(time_t) + "_" +
+                           std::to_string(sequence_++) + ".log";
+        return config_.dir / name;
+    }
+
+    static void sync_file(int fd) {
+#if defined(_WIN32)
+        _commit(fd);
+#elif defined(__APPLE__)
+        ::fsync(fd);
+#else
+        ::fdatasync(fd);
+#endif
+    }
+
+    static void close_file(int fd) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    FileSinkConfig config_;
+    int fd_ = -1;
+    int next_fd_ = -1;
+    std::filesystem::path path_;
+    std::filesystem::path next_path_;
+    size_t written_ = 0;
+    uint64_t rotations_ = 0;
+    uint64_t sequence_ = 0;
+    clock::time_point rotate_at_;
+    clock::time_point last_sync_;
+    std::deque<std::filesystem::path> files_;
+};
+
+} // namespace log
+} // namespace SAK
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <iostream>
@@ -15,6 +18,11 @@
 #include <cstdio>
 #include <ctime>
 #include <sstream>
+#include <iterator>
+#include "log_format.hpp"
+#include "log_sink.hpp"
+#include "metrics.hpp"
+#include "ring_queue.hpp"
 // Platform-specific includes
 #ifdef _WIN32
 #include <windows.h>
@@ -45,9 +53,49 @@ struct LogConfig {
     bool use_stdout = false;
     Level min_level = Level::LOG_DEBUG;
     size_t max_file_size = 10 * 1024 * 1024;  // 10MB
-    size_t max_files = 5;
+    size_t max_files = 5;                     // Oldest files of this process are deleted, 0: keep all
+    size_t rotate_interval_s = 0;             // Also start a new file this often, 0: by size only
+    size_t sync_interval_ms = 0;              // fdatasync cadence after writes, 0: never
     bool async_mode = true;
     size_t flush_interval_ms = 1000;
+    // Async mode only: producers write fixed-size records into per-thread
+    // lock-free rings instead of the shared queue (see Logger::log)
+    bool thread_buffers = false;
+    size_t thread_buffer_records = 4096;
+    overflow_policy buffer_overflow = overflow_policy::block;  // block or drop
+};
+
+// Messages longer than this are truncated
+constexpr size_t LOG_PAYLOAD_SIZE = 256;
+
+// Static description of one deferred logging statement; the
+// LOG_DEFERRED_* macros give each call site its own instance, so records
+// refer to it instead of carrying the format string
+struct LogSite {
+    Level level;
+    const char* file;
+    const char* func;
+    int line;
+    const char* fmt;
+};
+
+// Turns a deferred record's payload back into text; writes at most
+// `capacity` bytes including the terminator and returns the text length
+using LogDecoder = size_t (*)(const char* fmt, const char* payload, size_t length,
+                              char* out, size_t capacity);
+
+// One log line as captured by the producer; formatting happens on the
+// logging thread
+struct LogRecord {
+    int64_t ticks;         // system_clock nanoseconds since the epoch
+    const char* file;      // Must outlive the record, e.g. __FILE__
+    const char* func;
+    const char* fmt;       // Deferred records only
+    LogDecoder decode;     // nullptr when payload already holds the text
+    int32_t line;
+    Level level;
+    uint16_t length;
+    char payload[LOG_PAYLOAD_SIZE];
 };
 
 class Logger {
@@ -58,29 +106,42 @@ public:
     }
 
     void configure(const LogConfig& config) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        bool was_async = config_.async_mode;
-        config_ = config;
-        init();
-        // Manage async thread based on mode transition
-        if (was_async && !config_.async_mode) {
-            // Stop async thread if switching to sync mode
-            if (async_thread_.joinable()) {
-                stop_async_thread();
-            }
-        } else if (!was_async && config_.async_mode) {
-            // Start async thread if switching to async mode
-            if (!async_thread_.joinable()) {
-                start_async_thread();
-            }
+        // The logging thread takes mutex_ to write, so stop it before
+        // locking; it drains what was queued under the old configuration
+        stop_async_thread();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = config;
+            init();
+        }
+        if (config_.async_mode) {
+            start_async_thread();
         }
     }
 
+    /**
+     * @brief Format and emit one log line
+     *
+     * With LogConfig::thread_buffers in async mode, the caller only runs
+     * vsnprintf into a fixed-size record on its own stack and copies it
+     * into a ring owned by the calling thread: no lock, no allocation and
+     * no clock formatting. The logging thread merges the rings in
+     * timestamp order, formats the lines with a per-second cached time
+     * prefix and writes each batch with a single write and flush.
+     */
     void log(Level level, const char* file, const char* func, int line, const char* fmt, ...) {
         if (level < config_.min_level) return;
         if (!init_success_) return;
 
-        char buffer[256];
+        if (buffers_active_.load(std::memory_order_acquire)) {
+            va_list args;
+            va_start(args, fmt);
+            bool buffered = log_to_thread_buffer(level, file, func, line, fmt, args);
+            va_end(args);
+            if (buffered) return;
+        }
+
+        char buffer[LOG_PAYLOAD_SIZE];
         va_list args;
         va_start(args, fmt);
         vsnprintf(buffer, sizeof(buffer), fmt, args);
@@ -95,12 +156,77 @@ public:
         }
     }
 
+    /**
+     * @brief Emit one log line whose arguments are formatted later
+     *
+     * The arguments are copied in binary form (C strings by content) and
+     * turned into text by the logging thread when thread buffers are
+     * active, so the caller skips printf entirely. In the other modes they
+     * are formatted immediately, with the same output. Use the
+     * LOG_DEFERRED_* macros rather than calling this directly.
+     */
+    template<typename... Args>
+    void log_deferred(const LogSite& site, const Args&... args) {
+        if (site.level < config_.min_level) return;
+        if (!init_success_) return;
+
+        if (buffers_active_.load(std::memory_order_acquire)) {
+            int64_t ticks = now_ticks();
+            bool buffered = push_to_thread_buffer([&](LogRecord& record) {
+                fill_header(record, ticks, site.level, site.file, site.func, site.line);
+                record.fmt = site.fmt;
+                record.decode = &detail::format_log_args<detail::log_arg_t<Args>...>;
+                record.length = static_cast<uint16_t>(
+                    detail::encode_log_args<detail::log_arg_t<Args>...>(record.payload, sizeof(record.payload), args...));
+            });
+            if (buffered) return;
+        }
+
+        char payload[LOG_PAYLOAD_SIZE];
+        char buffer[LOG_PAYLOAD_SIZE];
+        payload[0] = '\0';
+        size_t length = detail::encode_log_args<detail::log_arg_t<Args>...>(payload, sizeof(payload), args...);
+        detail::format_log_args<detail::log_arg_t<Args>...>(site.fmt, payload, length, buffer, sizeof(buffer));
+
+        auto log_entry = format_log(site.level, site.file, site.func, site.line, buffer);
+
+        if (config_.async_mode) {
+            enqueue_log(log_entry);
+        } else {
+            write_log(log_entry);
+        }
+    }
+
+    /**
+     * @brief Block until every line logged before the call has been written
+     *
+     * A no-op in sync mode, where log() writes before returning.
+     */
+    void flush() {
+        if (!async_thread_.joinable()) return;
+        std::unique_lock<std::mutex> lock(flush_mutex_);
+        uint64_t target = ++flush_requested_;
+        lock.unlock();
+        queue_cv_.notify_one();
+        buffer_signal_.notify_one();
+        lock.lock();
+        flush_cv_.wait(lock, [&] { return flush_done_ >= target; });
+    }
+
+    /// Records discarded because a thread buffer was full under overflow_policy::drop
+    uint64_t dropped_count() {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        uint64_t dropped = 0;
+        for (const auto& buffer : buffers_) {
+            dropped += buffer->ring.dropped();
+        }
+        return dropped + retired_dropped_;
+    }
+
     ~Logger() noexcept {
         try {
             // Always stop/join async thread if running to avoid hangs
-            if (async_thread_.joinable()) {
-                stop_async_thread();
-            }
+            stop_async_thread();
         } catch (...) {
             // Destructors must not throw - this is critical for program stability
             // Silently handle any exceptions during shutdown
@@ -108,6 +234,16 @@ public:
     }
 
 private:
+    // A thread's ring; it outlives the thread until drained
+    struct ThreadBuffer {
+        ThreadBuffer(size_t records, overflow_policy policy) : ring(records, policy) {}
+
+        spsc_ring<LogRecord> ring;
+        std::atomic<bool> retired{false};
+        // Set by the owner thread around a push; stop_async_thread() waits it out
+        std::atomic<bool> writing{false};
+    };
+
     Logger() : config_(), stop_flag_(false) {
         init();
         if (config_.async_mode) {
@@ -117,8 +253,8 @@ private:
 
     void init() {
         log_dir_ = fs::path(config_.log_dir);
-        max_file_size_ = config_.max_file_size;
-        
+        sink_.close();
+
         if (config_.use_stdout) {
             init_success_ = true;
             return;
@@ -128,63 +264,44 @@ private:
             fs::create_directories(log_dir_);
         }
 
-        open_new_log_file();
-        init_success_ = file_stream_ && file_stream_->is_open();
+        FileSinkConfig sink_config;
+        sink_config.dir = log_dir_;
+        sink_config.max_file_size = config_.max_file_size;
+        sink_config.max_files = config_.max_files;
+        sink_config.rotate_interval = std::chrono::seconds(config_.rotate_interval_s);
+        sink_config.sync_interval = std::chrono::milliseconds(config_.sync_interval_ms);
+        init_success_ = sink_.open(sink_config);
     }
 
-    void rotate_log_files() {
-        if (file_stream_) {
-            file_stream_->close();
-        }
-        
-        // Simple rotation - create new file with timestamp
-        open_new_log_file();
-    }
-
-    fs::path get_log_path() {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
+    // Writes "YYYYmmddHHMMSS" plus a terminator into `out`
+    static void format_time(std::time_t t, char (&out)[20]) {
+        struct tm tm_info;
 #ifdef _WIN32
-        auto pid = _getpid();
+        localtime_s(&tm_info, &t);
 #else
-        auto pid = getpid();
+        localtime_r(&t, &tm_info);
 #endif
-        
-        std::ostringstream filename;
-        filename << "log_" << pid << "_" << time_t << ".log";
-        return log_dir_ / filename.str();
+        std::strftime(out, sizeof(out), "%Y%m%d%H%M%S", &tm_info);
     }
 
-    void open_new_log_file() {
-        current_log_path_ = get_log_path();
-        file_stream_ = std::make_unique<std::ofstream>(
-            current_log_path_, std::ios::out | std::ios::app);
+    static const char* level_name(Level level) {
+        switch(level) {
+            case Level::LOG_DEBUG: return "DEBUG";
+            case Level::LOG_INFO: return "INFO";
+            case Level::LOG_WARNING: return "WARNING";
+            case Level::LOG_ERROR: return "ERROR";
+        }
+        return "";
     }
 
     std::string format_log(Level level, const char* file, const char* func, int line, const std::string& message) {
         auto now = std::chrono::system_clock::now();
-        std::time_t t = std::chrono::system_clock::to_time_t(now);
         char time_str[20];
-#ifdef _WIN32
-        struct tm tm_info;
-        localtime_s(&tm_info, &t);
-        std::strftime(time_str, sizeof(time_str), "%Y%m%d%H%M%S", &tm_info);
-#else
-        std::strftime(time_str, sizeof(time_str), "%Y%m%d%H%M%S", std::localtime(&t));
-#endif
-
-        std::string level_str;
-        switch(level) {
-            case Level::LOG_DEBUG: level_str = "DEBUG"; break;
-            case Level::LOG_INFO: level_str = "INFO"; break;
-            case Level::LOG_WARNING: level_str = "WARNING"; break;
-            case Level::LOG_ERROR: level_str = "ERROR"; break;
-        }
+        format_time(std::chrono::system_clock::to_time_t(now), time_str);
 
         std::ostringstream oss;
         oss << "[" << time_str << "] "
-            << "[" << level_str << "] "
+            << "[" << level_name(level) << "] "
 #ifdef _WIN32
             << "[" << _getpid() << "] "
 #else
@@ -196,21 +313,263 @@ private:
     }
 
     void write_log(const std::string& log_entry) {
+        lines_metric_.Add();
         std::lock_guard<std::mutex> lock(mutex_);
         
         if (config_.use_stdout) {
             std::cout << log_entry;
             return;
         }
+        sink_.write(log_entry.data(), log_entry.size());
+    }
+
+    // Writes queued entries with one vectored write where possible
+    void write_logs(const std::vector<std::string>& entries) {
+        if (entries.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (config_.use_stdout) {
+            for (const auto& entry : entries) {
+                std::cout << entry;
+            }
+            return;
+        }
+        sink_.write(entries.data(), entries.size());
+    }
+
+    // Writes an already formatted batch with one write
+    void write_batch(const std::string& batch) {
+        if (batch.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (config_.use_stdout) {
+            std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            std::cout.flush();
+            return;
+        }
+        sink_.write(batch.data(), batch.size());
+    }
+
+    ThreadBuffer* thread_buffer() {
+        // Marks the ring retired on thread exit; the logging thread frees it
+        // once it has been drained
+        struct Holder {
+            std::shared_ptr<ThreadBuffer> buffer;
+            ~Holder() {
+                if (buffer) buffer->retired.store(true, std::memory_order_release);
+            }
+        };
+        static thread_local Holder holder;
+
+        if (!holder.buffer) {
+            overflow_policy policy = config_.buffer_overflow == overflow_policy::drop
+                ? overflow_policy::drop : overflow_policy::block;
+            holder.buffer = std::make_shared<ThreadBuffer>(config_.thread_buffer_records, policy);
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            buffers_.push_back(holder.buffer);
+            buffers_version_.fetch_add(1, std::memory_order_release);
+        }
+        return holder.buffer.get();
+    }
+
+    static int64_t now_ticks() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static void fill_header(LogRecord& record, int64_t ticks, Level level, const char* file,
+                            const char* func, int line) {
+        record.ticks = ticks;
+        record.file = file;
+        record.func = func;
+        record.line = line;
+        record.level = level;
+    }
+
+    bool log_to_thread_buffer(Level level, const char* file, const char* func, int line,
+                              const char* fmt, va_list args) {
+        int64_t ticks = now_ticks();
+        // Formats straight into the ring slot
+        return push_to_thread_buffer([&](LogRecord& record) {
+            fill_header(record, ticks, level, file, func, line);
+            record.fmt = nullptr;
+            record.decode = nullptr;
+            int written = vsnprintf(record.payload, sizeof(record.payload), fmt, args);
+            record.length = static_cast<uint16_t>(
+                written < 0 ? 0 : std::min<size_t>(written, sizeof(record.payload) - 1));
+        });
+    }
+
+    // Pushes into the calling thread's ring; false, without touching it, if
+    // the buffers were deactivated meanwhile. The writing flag and
+    // buffers_active_ pair up so that stop_async_thread() either sees this
+    // push in progress or this call sees the buffers stopped.
+    template<typename Fill>
+    bool push_to_thread_buffer(Fill&& fill) {
+        ThreadBuffer* buffer = thread_buffer();
+        buffer->writing.store(true, std::memory_order_seq_cst);
+        if (!buffers_active_.load(std::memory_order_seq_cst)) {
+            buffer->writing.store(false, std::memory_order_release);
+            return false;
+        }
+        if (buffer->ring.push_with(fill)) {
+            buffer_signal_.notify_one();
+        } else {
+            dropped_metric_.Add();
+        }
+        buffer->writing.store(false, std::memory_order_release);
+        return true;
+    }
+
+    // Stopping thread only: drains until no producer is inside a push, so
+    // one blocked on a full ring under overflow_policy::block gets its room
+    void wait_for_buffer_writers() {
+        for (;;) {
+            drain_thread_buffers();
+            bool writing;
+            {
+                std::lock_guard<std::mutex> lock(buffers_mutex_);
+                writing = std::any_of(buffers_.begin(), buffers_.end(), [](const auto& buffer) {
+                    return buffer->writing.load(std::memory_order_acquire);
+                });
+            }
+            if (!writing) return;
+            std::this_thread::yield();
+        }
+    }
+
+    bool thread_buffers_pending() {
+        for (const auto& buffer : buffer_snapshot_) {
+            if (!buffer->ring.empty()) return true;
+        }
+        return false;
+    }
+
+    // Logging thread only: picks up rings registered since the last round
+    // and frees the drained rings of exited threads
+    void refresh_buffer_snapshot() {
+        uint64_t version = buffers_version_.load(std::memory_order_acquire);
+        bool reap = std::any_of(buffer_snapshot_.begin(), buffer_snapshot_.end(), [](const auto& buffer) {
+            return buffer->retired.load(std::memory_order_acquire) && buffer->ring.empty();
+        });
+        if (version == snapshot_version_ && !reap) return;
+
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        auto retired = std::remove_if(buffers_.begin(), buffers_.end(), [this](const auto& buffer) {
+            if (!buffer->retired.load(std::memory_order_acquire) || !buffer->ring.empty()) return false;
+            retired_dropped_ += buffer->ring.dropped();
+            return true;
+        });
+        buffers_.erase(retired, buffers_.end());
+        buffer_snapshot_ = buffers_;
+        snapshot_version_ = buffers_version_.load(std::memory_order_relaxed);
+    }
+
+    // Moves every queued record out of the rings, formats them in
+    // timestamp order and writes them; returns the number of records
+    size_t drain_thread_buffers() {
+        refresh_buffer_snapshot();
+        batch_records_.clear();
+        for (const auto& buffer : buffer_snapshot_) {
+            buffer->ring.try_pop_bulk(std::back_inserter(batch_records_), buffer->ring.capacity());
+        }
+        if (batch_records_.empty()) return 0;
+        queue_depth_metric_.Set(static_cast<int64_t>(batch_records_.size()));
+        lines_metric_.Add(batch_records_.size());
+
+        // Each ring is already ordered; the sort interleaves the threads
+        batch_order_.clear();
+        for (const auto& record : batch_records_) {
+            batch_order_.push_back(&record);
+        }
+        std::stable_sort(batch_order_.begin(), batch_order_.end(),
+                         [](const LogRecord* a, const LogRecord* b) { return a->ticks < b->ticks; });
+
+        batch_text_.clear();
+        for (const LogRecord* record : batch_order_) {
+            append_record(batch_text_, *record);
+        }
+        write_batch(batch_text_);
+        return batch_records_.size();
+    }
+
+    void append_record(std::string& out, const LogRecord& record) {
+        int64_t second = record.ticks / 1000000000;
+        if (second != cached_second_) {
+            char time_str[20];
+            format_time(static_cast<std::time_t>(second), time_str);
+            cached_prefix_.assign("[").append(time_str).append("] ");
+            cached_second_ = second;
+        }
+        if (pid_prefix_.empty()) {
+#ifdef _WIN32
+            pid_prefix_ = "[" + std::to_string(_getpid()) + "] ";
+#else
+            pid_prefix_ = "[" + std::to_string(getpid()) + "] ";
+#endif
+        }
 
-        if (file_stream_ && file_stream_->is_open()) {
-            *file_stream_ << log_entry;
-            file_stream_->flush();
-            
-            if (fs::exists(current_log_path_) && fs::file_size(current_log_path_) >= max_file_size_) {
-                rotate_log_files();
+        char line_str[16];
+        auto line_end = std::to_chars(line_str, line_str + sizeof(line_str), record.line).ptr;
+
+        out += cached_prefix_;
+        out += '[';
+        out += level_name(record.level);
+        out += "] ";
+        out += pid_prefix_;
+        out += '[';
+        out += record.file;
+        out += ':';
+        out += record.func;
+        out += ':';
+        out.append(line_str, line_end);
+        out += "] ";
+        if (record.decode) {
+            char text[LOG_PAYLOAD_SIZE];
+            size_t length = record.decode(record.fmt, record.payload, record.length, text, sizeof(text));
+            out.append(text, length);
+        } else {
+            out.append(record.payload, record.length);
+        }
+        out += '\n';
+    }
+
+    // Lines that took the shared-queue path while the mode was switching
+    void drain_shared_queue() {
+        std::vector<std::string> stray;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            for (; !log_queue_.empty(); log_queue_.pop()) {
+                stray.push_back(std::move(log_queue_.front()));
+            }
+        }
+        write_logs(stray);
+    }
+
+    void buffered_logging_thread() {
+        for (;;) {
+            uint64_t flush_target = flush_requested_.load(std::memory_order_acquire);
+            drain_shared_queue();
+            while (drain_thread_buffers() != 0) {
             }
+            complete_flush(flush_target);
+
+            if (stop_flag_.load(std::memory_order_acquire)) break;
+            buffer_signal_.wait_until([this] {
+                refresh_buffer_snapshot();
+                return stop_flag_.load(std::memory_order_acquire) || thread_buffers_pending() ||
+                       flush_requested_.load(std::memory_order_acquire) != flush_done_seen_;
+            });
+        }
+    }
+
+    void complete_flush(uint64_t target) {
+        flush_done_seen_ = target;
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        if (target > flush_done_) {
+            flush_done_ = target;
         }
+        flush_cv_.notify_all();
     }
 
     void enqueue_log(const std::string& log_entry) {
@@ -224,13 +583,21 @@ private:
     void start_async_thread() {
         if (!async_thread_.joinable()) {
             stop_flag_ = false;  // Reset stop flag for new thread
-            async_thread_ = std::thread([this] { async_logging_thread(); });
+            if (config_.thread_buffers) {
+                async_thread_ = std::thread([this] { buffered_logging_thread(); });
+                buffers_active_.store(true, std::memory_order_release);
+            } else {
+                async_thread_ = std::thread([this] { async_logging_thread(); });
+            }
         }
     }
 
     void stop_async_thread() {
+        if (!async_thread_.joinable()) return;
+        buffers_active_.store(false, std::memory_order_seq_cst);
         if (!stop_flag_.exchange(true)) {  // Only proceed if not already stopped
             queue_cv_.notify_one();
+            buffer_signal_.notify_all();
             if (async_thread_.joinable()) {
                 try {
                     async_thread_.join();
@@ -245,38 +612,49 @@ private:
                     // Ignore unknown exceptions during thread join
                 }
             }
+            // Lines pushed while the thread was exiting, including those of
+            // producers that saw the buffers active just before the store
+            wait_for_buffer_writers();
+            drain_thread_buffers();
+            complete_flush(flush_requested_.load(std::memory_order_acquire));
         }
     }
 
     void async_logging_thread() {
         while (!stop_flag_) {
             std::vector<std::string> batch;
+            uint64_t flush_target;
             {
                 std::unique_lock<std::mutex> lock(queue_mutex_);
                 if (log_queue_.empty()) {
                     queue_cv_.wait_for(lock, 
                         std::chrono::milliseconds(config_.flush_interval_ms),
-                        [this] { return !log_queue_.empty() || stop_flag_; });
+                        [this] {
+                            return !log_queue_.empty() || stop_flag_ ||
+                                   flush_requested_.load(std::memory_order_acquire) != flush_done_seen_;
+                        });
                 }
                 
+                flush_target = flush_requested_.load(std::memory_order_acquire);
                 while (!log_queue_.empty()) {
                     batch.push_back(std::move(log_queue_.front()));
                     log_queue_.pop();
                 }
             }
 
-            for (const auto& entry : batch) {
-                write_log(entry);
+            if (!batch.empty()) {
+                queue_depth_metric_.Set(static_cast<int64_t>(batch.size()));
+                lines_metric_.Add(batch.size());
             }
+            write_logs(batch);
+            complete_flush(flush_target);
         }
     }
 
     LogConfig config_;
-    std::unique_ptr<std::ofstream> file_stream_;
+    FileSink sink_;                      // Guarded by mutex_
     bool init_success_ = false;
     fs::path log_dir_;
-    fs::path current_log_path_;
-    size_t max_file_size_ = 10 * 1024 * 1024;  // 10MB
 
     // Async logging members
     std::queue<std::string> log_queue_;
@@ -284,6 +662,36 @@ private:
     std::condition_variable queue_cv_;
     std::thread async_thread_;
     std::atomic<bool> stop_flag_;
+
+    // Flush handshake with the logging thread
+    std::atomic<uint64_t> flush_requested_{0};
+    uint64_t flush_done_ = 0;            // Guarded by flush_mutex_
+    uint64_t flush_done_seen_ = 0;       // Logging thread only
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+
+    // Per-thread buffer mode
+    std::atomic<bool> buffers_active_{false};
+    SAK::detail::queue_signal buffer_signal_;
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;  // Guarded by buffers_mutex_
+    std::atomic<uint64_t> buffers_version_{0};
+    uint64_t retired_dropped_ = 0;                         // Guarded by buffers_mutex_
+    // Owned by the logging thread (or the thread stopping it)
+    std::vector<std::shared_ptr<ThreadBuffer>> buffer_snapshot_;
+    uint64_t snapshot_version_ = 0;
+    std::vector<LogRecord> batch_records_;
+    std::vector<const LogRecord*> batch_order_;
+    std::string batch_text_;
+    std::string cached_prefix_;
+    int64_t cached_second_ = -1;
+    std::string pid_prefix_;
+
+    // "log.queue_depth" is the size of the last non-empty batch the logging
+    // thread took; idle rounds leave it alone
+    metrics::Counter& lines_metric_ = metrics::Registry::Instance().GetCounter("log.lines");
+    metrics::Counter& dropped_metric_ = metrics::Registry::Instance().GetCounter("log.dropped");
+    metrics::Gauge& queue_depth_metric_ = metrics::Registry::Instance().GetGauge("log.queue_depth");
     
     std::mutex mutex_;
 };
@@ -302,3 +710,19 @@ private:
 
 #define LOG_ERROR(fmt, ...) \
     SAK::log::Logger::instance().log(SAK::log::Level::LOG_ERROR, __FILE__, __FUNCTION__, __LINE__, fmt, ## __VA_ARGS__)
+
+// Deferred variants of the macros above: only C strings, arithmetic, enum
+// and pointer arguments are accepted, and formatting moves to the logging
+// thread when LogConfig::thread_buffers is on. The format string must be a
+// literal; it is checked like printf's but never evaluated here.
+#define SAK_LOG_DEFERRED(lvl, fmt, ...) \
+    do { \
+        static constexpr SAK::log::LogSite sak_log_site{lvl, __FILE__, __FUNCTION__, __LINE__, fmt}; \
+        if (false) SAK::log::detail::check_log_format(fmt, ## __VA_ARGS__); \
+        SAK::log::Logger::instance().log_deferred(sak_log_site, ## __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEFERRED_DEBUG(fmt, ...) SAK_LOG_DEFERRED(SAK::log::Level::LOG_DEBUG, fmt, ## __VA_ARGS__)
+#define LOG_DEFERRED_INFO(fmt, ...) SAK_LOG_DEFERRED(SAK::log::Level::LOG_INFO, fmt, ## __VA_ARGS__)
+#define LOG_DEFERRED_WARNING(fmt, ...) SAK_LOG_DEFERRED(SAK::log::Level::LOG_WARNING, fmt, ## __VA_ARGS__)
+#define LOG_DEFERRED_ERROR(fmt, ...) SAK_LOG_DEFERRED(SAK::log::Level::LOG_ERROR, fmt, ## __VA_ARGS__)
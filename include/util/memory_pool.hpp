@@ -5,18 +5,21 @@
 #include <unordered_map>
 #include <memory>
 #include <cassert>
+#include <atomic>
 #include <iostream>
 
 // Configuration options
 // Define this macro to zero out memory blocks on allocation
 // #define MEMORY_POOL_ZERO_ON_ALLOCATE
-// Define this macro to validate pointers on deallocation
+// Define this macro to validate pointers on deallocation (also bypasses the thread caches)
 // #define MEMORY_POOL_VALIDATE_POINTERS
 
 namespace SAK {
 namespace memory {
 
-// Memory pool for fixed-size memory blocks
+// Memory pool for fixed-size memory blocks.
+// Blocks are carved out of large aligned chunks and free blocks are chained
+// through their first word, so block_size must be at least sizeof(void*).
 class FixedSizeMemoryPool {
 public:
     explicit FixedSizeMemoryPool(size_t block_size, size_t initial_blocks = 8);
@@ -25,22 +28,33 @@ public:
     void* allocate();
     void deallocate(void* ptr);
 
+    // Take up to `max_blocks` blocks under a single lock; they are returned
+    // chained through their first word and the count is stored in `count`
+    void* allocate_batch(size_t max_blocks, size_t& count);
+    // Return a chain of `count` blocks linked through their first word
+    void deallocate_batch(void* head, void* tail, size_t count);
+
     size_t block_size() const { return block_size_; }
-    size_t num_blocks() const { return blocks_.size(); }
-    size_t num_free_blocks() const { return free_blocks_.size(); }
-    
+    size_t num_blocks() const;
+    size_t num_free_blocks() const;
+
     // Add memory usage statistics
-    double usage_ratio() const { 
-        return blocks_.empty() ? 0.0 : 
-            static_cast<double>(blocks_.size() - free_blocks_.size()) / blocks_.size(); 
-    }
+    double usage_ratio() const;
 
 private:
     void expand(size_t num_blocks);
+    void grow_if_empty();
 
     const size_t block_size_;
-    std::vector<char*> blocks_;        // All allocated memory blocks
-    std::vector<char*> free_blocks_;   // Available memory blocks
+    size_t alignment_;                 // Block alignment (and chunk alignment)
+    size_t stride_;                    // Distance between consecutive blocks
+    std::vector<char*> chunks_;        // One allocation per expand()
+#ifdef MEMORY_POOL_VALIDATE_POINTERS
+    std::vector<std::pair<char*, size_t>> chunk_ranges_;  // Chunk start and block count
+#endif
+    size_t num_blocks_ = 0;
+    void* free_list_ = nullptr;        // Available memory blocks
+    size_t num_free_ = 0;
     mutable std::mutex mutex_;
 };
 
@@ -53,13 +67,13 @@ public:
     void Deallocate(void* ptr, size_t size);
     
     // Add statistics and debugging features
-    size_t GetTotalAllocations() const { return total_allocations_; }
-    size_t GetCurrentAllocations() const { return current_allocations_; }
+    size_t GetTotalAllocations() const { return total_allocations_.load(std::memory_order_relaxed); }
+    size_t GetCurrentAllocations() const { return current_allocations_.load(std::memory_order_relaxed); }
     size_t GetLargeAllocations() const;
     double GetMemoryUsage() const;
     void PrintStats() const;
     
-    // Add memory pool cleanup method
+    // Add memory pool cleanup method; also returns the calling thread's cached blocks
     void Trim();
 
     // Disable copy and assignment
@@ -70,20 +84,28 @@ private:
     MemoryPool();
     ~MemoryPool();
 
+    // Per-thread block cache in front of the fixed-size pools
+    struct ThreadCache;
+    static ThreadCache* LocalCache();
+    void FlushCache(ThreadCache& cache);
+
     // Common memory block sizes
     static constexpr size_t kSmallBlockSizes[] = {
         8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096
     };
     static constexpr size_t kNumPools = sizeof(kSmallBlockSizes) / sizeof(kSmallBlockSizes[0]);
+    static constexpr size_t kMaxSmallSize = kSmallBlockSizes[kNumPools - 1];
+
+    // Pool index for a size in [1, kMaxSmallSize], found in constant time
+    static size_t PoolIndex(size_t size);
 
     std::unique_ptr<FixedSizeMemoryPool> pools_[kNumPools];
     mutable std::mutex large_alloc_mutex_;
     std::unordered_map<void*, size_t> large_allocations_;
 
     // Statistics
-    mutable std::mutex stats_mutex_;
-    size_t total_allocations_ = 0;
-    size_t current_allocations_ = 0;
+    std::atomic<size_t> total_allocations_{0};
+    std::atomic<size_t> current_allocations_{0};
 };
 
 // Custom deleter for smart pointers
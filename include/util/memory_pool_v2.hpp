@@ -17,13 +17,21 @@ constexpr size_t SLAB_SIZE = 32768;
 constexpr uint16_t MEDIUM_OBJECT = 0xFFFE;
 constexpr uint16_t LARGE_OBJECT = 0xFFFF;
 constexpr uint16_t LARGE_DIRECT = 0x0001;
+constexpr uint16_t MEDIUM_MAPPED = 0x0002;  // Medium block backed by its own node-bound mapping
+constexpr size_t MAX_NUMA_NODES = 8;
 constexpr size_t MEDIUM_CACHE_SIZE = 8;
+// Central transfer cache defaults, in bytes per size class
+constexpr size_t TRANSFER_HIGH_WATERMARK = 2 * SLAB_SIZE;
+constexpr size_t TRANSFER_BATCH_SIZE = SLAB_SIZE / 4;
+constexpr size_t TRANSFER_MAX_BATCHES = 64;
 
 namespace SAK {
 
 struct ThreadCache;
 
-struct BlockHeader {
+// Header of medium and large blocks; small blocks are located through their slab.
+// Aligned so that the user pointer keeps malloc's fundamental alignment.
+struct alignas(16) BlockHeader {
     uint16_t size_class;
     uint16_t flags;
     ThreadCache* owner;
@@ -40,20 +48,73 @@ struct alignas(64) SizeClassBin {
     void* private_list;
     std::atomic<void*> mailbox;
     size_t block_size;
-    char padding[64 - sizeof(void*) - sizeof(std::atomic<void*>) - sizeof(size_t)];
-    SizeClassBin(): private_list(nullptr), mailbox(nullptr), block_size(0) {
+    // Lower bound on the private list length (mailbox drains are not counted)
+    size_t free_blocks;
+    char padding[64 - sizeof(void*) - sizeof(std::atomic<void*>) - 2 * sizeof(size_t)];
+    SizeClassBin(): private_list(nullptr), mailbox(nullptr), block_size(0), free_blocks(0) {
     }
 };
 
 static_assert(sizeof(SizeClassBin) == 64, "SizeClassBin must be exactly 64 bytes");
 
+/**
+ * @brief Header stored at the start of every SLAB_SIZE-aligned slab
+ *
+ * Small blocks carry no per-block header: the slab holding a block, and with
+ * it the owning ThreadCache and size class, is found by masking the block
+ * address with SlabOf(). Free blocks link through their first word.
+ */
 struct Slab {
-    void* memory;
+    ThreadCache* owner;
     size_t block_size;
     size_t num_blocks;
     std::atomic<size_t> free_count;
     Slab* next;
-    Slab(): memory(nullptr), block_size(0), num_blocks(0), free_count(0), next(nullptr) {
+    uint16_t size_class;
+
+#ifdef MEMORY_POOL_V2_DEBUG
+    uint32_t magic;
+    static constexpr uint32_t MAGIC_VALUE = 0x51AB51AB;
+#endif
+
+    Slab(ThreadCache* tc, size_t class_idx);
+};
+
+constexpr size_t SLAB_HEADER_SIZE = 64;
+static_assert(sizeof(Slab) <= SLAB_HEADER_SIZE, "Slab header must fit before the first block");
+static_assert((SLAB_SIZE & (SLAB_SIZE - 1)) == 0, "SLAB_SIZE must be a power of two");
+
+inline Slab* SlabOf(const void* block) {
+    return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(SLAB_SIZE - 1));
+}
+
+constexpr size_t BlocksPerSlab(size_t class_idx) {
+    return (SLAB_SIZE - SLAB_HEADER_SIZE) / SIZE_CLASSES[class_idx];
+}
+
+/**
+ * @brief Per-thread statistics counters
+ *
+ * Only the owning thread writes these, so updates are plain relaxed
+ * load/store pairs; readers aggregate them in MemoryPoolV2::GetStats().
+ * Kept on its own cache line so that readers do not disturb the bins.
+ */
+struct alignas(64) ThreadStats {
+    std::atomic<size_t> total_allocated;
+    std::atomic<size_t> total_deallocated;
+    std::atomic<size_t> cross_thread_frees;
+    std::atomic<size_t> slab_refills;
+    std::atomic<size_t> mailbox_drains;
+    std::atomic<size_t> slabs_released;
+    std::atomic<size_t> bytes_released;
+    std::atomic<size_t> transfers_out;
+    std::atomic<size_t> transfers_in;
+    std::atomic<size_t> numa_mapped_bytes;
+    std::atomic<size_t> numa_bind_failures;
+
+    ThreadStats(): total_allocated(0), total_deallocated(0), cross_thread_frees(0), slab_refills(0),
+                   mailbox_drains(0), slabs_released(0), bytes_released(0), transfers_out(0), transfers_in(0),
+                   numa_mapped_bytes(0), numa_bind_failures(0) {
     }
 };
 
@@ -73,10 +134,18 @@ struct ThreadCache {
     std::atomic<size_t> ref_count;
 
     std::atomic<bool> dead;
+    // Set by MemoryPoolV2::RequestTrim(); honoured by the owner thread on its next free
+    std::atomic<bool> trim_requested;
     size_t alloc_count;
     size_t free_count;
+    // NUMA node the owner thread ran on when it registered
+    uint32_t numa_node;
+#ifndef MEMORY_POOL_V2_NO_STATS
+    ThreadStats stats;
+#endif
 
-    ThreadCache(): medium_count(0), ref_count(1), dead(false), alloc_count(0), free_count(0) {
+    ThreadCache(): medium_count(0), ref_count(1), dead(false), trim_requested(false), alloc_count(0), free_count(0),
+                   numa_node(0) {
         for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
             bins[i].block_size = SIZE_CLASSES[i];
             slabs[i] = nullptr;
@@ -90,26 +159,115 @@ public:
     void* Allocate(size_t size);
     void Deallocate(void* ptr, size_t size);
 
+    /**
+     * @brief Release a block without knowing its requested size
+     *
+     * The block kind is recovered from the slab map, so this serves unsized
+     * operator delete. Statistics record the usable size of the block.
+     */
+    void Deallocate(void* ptr);
+
+    /**
+     * @brief Bytes usable in a block returned by Allocate (at least the requested size)
+     */
+    size_t UsableSize(const void* ptr) const;
+
     void RegisterThread(ThreadCache* tc);
     void UnregisterThread(ThreadCache* tc);
-    void UnregisterThreadOnly(ThreadCache* tc);
     void RemoveFromDeadCaches(ThreadCache* tc);
 
+    /**
+     * @brief Caches of exited threads still kept alive by outstanding blocks
+     *
+     * Blocks that are allocated, parked in the transfer cache or adopted by
+     * another thread each hold their owner's cache; the last one to return
+     * frees it together with its slabs.
+     */
+    size_t DeadCacheCount() const;
+
+    /**
+     * @brief Return fully free slabs of the calling thread's cache to the OS
+     *
+     * Cross-thread frees waiting in the mailboxes are drained first so that
+     * slabs whose blocks were released by other threads are detected too.
+     *
+     * @return Number of bytes released
+     */
+    size_t Trim();
+
+    /**
+     * @brief Ask every registered thread to trim its own cache
+     *
+     * Thread caches are only touched by their owner, so each thread performs
+     * the trim the next time it frees a small block.
+     */
+    void RequestTrim();
+
+    /**
+     * @brief Configure the central transfer cache
+     *
+     * When a thread's private list for a size class holds more than
+     * `high_watermark` bytes of free blocks, a batch of `batch_size` bytes is
+     * handed to the shared per-class transfer cache, from which other threads
+     * refill before carving a new slab. A zero high watermark disables transfers.
+     */
+    void SetTransferWatermarks(size_t high_watermark, size_t batch_size);
+    size_t GetTransferHighWatermark() const;
+    size_t GetTransferBatchSize() const;
+
+    /**
+     * @brief Bind new slabs and medium blocks to the owning thread's NUMA node
+     *
+     * Each thread cache records its node when it registers. In NUMA-aware mode
+     * slab memory is bound to that node with mbind(MPOL_PREFERRED) before it is
+     * first touched, and medium blocks get their own bound mapping instead of
+     * coming from malloc. On platforms without mbind the memory is simply left
+     * unbound. Disabled by default.
+     */
+    void SetNumaAware(bool enabled);
+    bool IsNumaAware() const;
+
     struct PoolStat {
         size_t total_allocated;
         size_t total_deallocated;
         size_t cross_thread_frees;
         size_t slab_refills;
         size_t mailbox_drains;
+        size_t slabs_released;
+        size_t bytes_released;
+        size_t transfers_out;   // Batches handed to the transfer cache
+        size_t transfers_in;    // Batches taken from the transfer cache
+        size_t numa_bind_failures;
+        // Per-node figures; nodes past MAX_NUMA_NODES are folded into the last entry
+        size_t node_mapped_bytes[MAX_NUMA_NODES];  // Bytes mapped in NUMA-aware mode
+        size_t node_threads[MAX_NUMA_NODES];       // Live thread caches
     };
 
+    // Define MEMORY_POOL_V2_NO_STATS to compile the counters out entirely;
+    // GetStats() then reports zeros.
     PoolStat GetStats() const;
     void PrintStats() const;
+#ifdef MEMORY_POOL_V2_NO_STATS
+    void RecordAlloc(size_t) {}
+    void RecordDealloc(size_t) {}
+    void RecordCrossThreadFree() {}
+    void RecordSlabRefill() {}
+    void RecordMailboxDrain() {}
+    void RecordSlabRelease(size_t) {}
+    void RecordTransferOut() {}
+    void RecordTransferIn() {}
+    void RecordNumaMapping(size_t, bool) {}
+#else
     void RecordAlloc(size_t bytes);
     void RecordDealloc(size_t bytes);
     void RecordCrossThreadFree();
     void RecordSlabRefill();
     void RecordMailboxDrain();
+    void RecordSlabRelease(size_t bytes);
+    void RecordTransferOut();
+    void RecordTransferIn();
+    void RecordNumaMapping(size_t bytes, bool bound);
+#endif
 
     MemoryPoolV2(const MemoryPoolV2&) = delete;
     MemoryPoolV2& operator=(const MemoryPoolV2&) = delete;
@@ -121,16 +279,28 @@ private:
     mutable std::mutex registry_mutex_;
     std::unordered_map<std::thread::id, ThreadCache*> thread_caches_;
     std::vector<ThreadCache*> dead_caches_;
-    mutable std::mutex stats_mutex_;
-    PoolStat stats_;
+#ifndef MEMORY_POOL_V2_NO_STATS
+    void RetireStats(ThreadCache* tc);
+
+    // Counters of unregistered threads and of calls made without a thread cache
+    ThreadStats retired_stats_;
+    std::atomic<size_t> retired_node_bytes_[MAX_NUMA_NODES] = {};
+#endif
 };
 
+// Returns nullptr once the calling thread's cache has been torn down at exit
 ThreadCache* GetOrCreateThreadCache();
+
+// Whether `ptr` lies in a live small-object slab
+bool IsSmallBlock(const void* ptr);
  
 size_t FindSizeClass(size_t size);
 
 // Internal helper functions
 void RefillFromSlab(ThreadCache* tc, size_t class_idx);
+size_t TrimThreadCache(ThreadCache* tc);
+bool RefillFromTransferCache(ThreadCache* tc, size_t class_idx);
+void ReleaseToTransferCache(ThreadCache* tc, size_t class_idx);
 
 void* AllocateSmall(size_t size);
 void DeallocateSmall(void* ptr);
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+#include "byte_buffer.hpp"
+#include "key_ts.hpp"
+#include "options.hpp"
+#include "skiplist.hpp"
+#include "spin_mutex.hpp"
+
+namespace SAK {
+
+/// Read timestamp that sees every version
+constexpr uint64_t kMaxTimestamp = std::numeric_limits<uint64_t>::max();
+
+/**
+ * @brief Multi-versioned in-memory write buffer of the LSM engine
+ *
+ * Every version of a key is its own entry in a ConcurrentSkipList ordered
+ * by KeyTs (key ascending, timestamp descending), so Put() is a lock-free
+ * insert and Get() finds the version visible at a read timestamp with a
+ * single seek. Skip list nodes come from an arena owned by the table and
+ * are released with it; keys and values stay reference counted, so what
+ * Get() and the iterators return outlives the table.
+ *
+ * An empty value is a tombstone. Get() and Scan() report it, so readers
+ * stop before reaching older tables.
+ */
+class MemTable {
+public:
+    using Map = ConcurrentSkipList<KeyTs, ByteBuffer, std::less<KeyTs>,
+                                   ArenaAllocator<std::pair<KeyTs, ByteBuffer>, ConcurrentArena>>;
+
+    /**
+     * @brief Visits, in key order, the version of each key visible at a
+     *        read timestamp
+     *
+     * Tombstones are visited too, with an empty Value(). The iterator must
+     * not outlive its MemTable; entries put while it runs may or may not
+     * be seen.
+     */
+    class Iterator {
+    public:
+        bool Valid() const { return it_ != end_; }
+        const ByteBuffer& Key() const { return it_->first.Key(); }
+        uint64_t Timestamp() const { return it_->first.Timestamp(); }
+        const ByteBuffer& Value() const { return it_->second; }
+        void Next();
+
+    private:
+        friend class MemTable;
+
+        Iterator(Map::const_iterator it, Map::const_iterator end, ByteBuffer upper, uint64_t read_ts);
+        // Moves to the first version at or before read_ts_, stopping at upper_
+        void Settle();
+
+        Map::const_iterator it_;
+        Map::const_iterator end_;
+        ByteBuffer upper_;  // Exclusive; empty for no bound
+        uint64_t read_ts_;
+    };
+
+    explicit MemTable(size_t id, size_t arena_block_size = Arena::kDefaultBlockSize);
+
+    MemTable(const MemTable&) = delete;
+    MemTable& operator=(const MemTable&) = delete;
+
+    size_t Id() const noexcept { return id_; }
+
+    /**
+     * @brief Add the version of `key` at `ts`
+     *
+     * @return false if `key` already has a version at `ts`, which is kept,
+     *         or if the table is frozen
+     */
+    bool Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value);
+
+    /**
+     * @brief The newest version of `key` at or before `read_ts`
+     *
+     * @return nullopt if there is none; an empty buffer for a tombstone
+     */
+    std::optional<ByteBuffer> Get(const ByteBuffer& key, uint64_t read_ts = kMaxTimestamp) const;
+
+    /**
+     * @brief Iterate keys in [lower, upper) as seen at `read_ts`
+     *
+     * An empty `upper` leaves the range open-ended.
+     */
+    Iterator Scan(const ByteBuffer& lower, const ByteBuffer& upper, uint64_t read_ts = kMaxTimestamp) const;
+
+    /// Every version in KeyTs order, e.g. for flushing to an SST
+    Map::const_iterator begin() const { return map_.begin(); }
+    Map::const_iterator end() const { return map_.end(); }
+
+    /// Key, timestamp and value bytes put so far; what a flushed SST would hold
+    size_t ApproximateSize() const noexcept { return approximate_size_.load(std::memory_order_relaxed); }
+    /// Bytes the arena holds for skip list nodes
+    size_t ArenaMemoryUsage() const noexcept { return arena_.BytesReserved(); }
+    size_t NumEntries() const { return map_.size(); }
+    bool Empty() const { return map_.empty(); }
+
+    /// Makes Put() fail from now on; done by MemTableList before replacing it
+    void Freeze() noexcept { frozen_.store(true, std::memory_order_release); }
+    bool Frozen() const noexcept { return frozen_.load(std::memory_order_acquire); }
+
+private:
+    const size_t id_;
+    // Declared before map_ so it outlives the nodes
+    ConcurrentArena arena_;
+    Map map_;
+    std::atomic<size_t> approximate_size_{0};
+    std::atomic<bool> frozen_{false};
+};
+
+/**
+ * @brief The active MemTable and the frozen ones waiting to be flushed
+ *
+ * Writes go to the active table. Once it reaches Options::target_sst_size
+ * it is frozen and a fresh table takes its place; frozen tables stay
+ * readable until PopOldest() hands them to the flush. Writers share a
+ * read lock on the set of tables, so they insert concurrently and only a
+ * freeze waits for them.
+ */
+class MemTableList {
+public:
+    explicit MemTableList(const Options& options);
+
+    /// See MemTable::Put(); may freeze the active table afterwards
+    bool Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value);
+    /// Puts a tombstone
+    bool Delete(const ByteBuffer& key, uint64_t ts) { return Put(key, ts, ByteBuffer()); }
+
+    /// Looks in the active table, then the frozen ones from newest to oldest
+    std::optional<ByteBuffer> Get(const ByteBuffer& key, uint64_t read_ts = kMaxTimestamp) const;
+
+    std::shared_ptr<MemTable> Active() const;
+    /// Frozen tables, newest first
+    std::vector<std::shared_ptr<MemTable>> Immutables() const;
+
+    /// Freezes the active table unless it is empty
+    void Freeze();
+    /// More tables in memory than Options::num_memtable_limit allows
+    bool NeedsFlush() const;
+    /// Removes and returns the oldest frozen table, or nullptr
+    std::shared_ptr<MemTable> PopOldest();
+
+private:
+    // Caller holds mutex_ for writing
+    void FreezeLocked();
+
+    const size_t target_size_;
+    const size_t memtable_limit_;
+    mutable spin_rw_mutex mutex_;
+    std::shared_ptr<MemTable> active_;
+    // Oldest first
+    std::vector<std::shared_ptr<MemTable>> immutables_;
+    size_t next_id_ = 0;
+};
+
+} // namespace SAK
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "_config.hpp"
+
+namespace SAK {
+
+/**
+ * @brief Process-wide counters, gauges, latency histograms and trace spans
+ *
+ * Subsystems look their metrics up by name once, keep the reference, and
+ * update it on the hot path: a counter increment is one relaxed add on the
+ * calling thread's shard, a histogram sample a few more. Building with
+ * CODEKNIFE_NO_METRICS defined (`xmake f --metrics=n`) turns every update
+ * and span into nothing; lookups and exports still work and report zeros.
+ */
+namespace metrics {
+
+#if defined(CODEKNIFE_NO_METRICS)
+constexpr bool kEnabled = false;
+#else
+constexpr bool kEnabled = true;
+#endif
+
+// Shards of a Counter; threads are spread over them round robin
+constexpr size_t kCounterShards = 16;
+// Shards of a Histogram, which are far larger
+constexpr size_t kHistogramShards = 4;
+
+namespace detail {
+
+// Round-robin shard number of the calling thread
+inline size_t ThreadSlot() noexcept {
+    static std::atomic<size_t> next{0};
+    thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+} // namespace detail
+
+// Steady clock in nanoseconds, the time base of histograms and spans
+inline uint64_t NowNanos() noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+inline uint64_t ToNanos(std::chrono::steady_clock::time_point time) noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+/**
+ * @brief Monotonic count, sharded so concurrent writers rarely share a line
+ */
+class Counter {
+public:
+    void Add(uint64_t n = 1) noexcept {
+        if constexpr (kEnabled) {
+            shards_[detail::ThreadSlot() % kCounterShards].value.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t Value() const noexcept;
+    void Reset() noexcept;
+
+private:
+    struct alignas(max_nfs_size) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, kCounterShards> shards_;
+};
+
+/**
+ * @brief Last value of a level, e.g. a queue depth
+ */
+class Gauge {
+public:
+    void Set(int64_t value) noexcept {
+        if constexpr (kEnabled) {
+            value_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void Add(int64_t delta) noexcept {
+        if constexpr (kEnabled) {
+            value_.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+    int64_t Value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Log-linear histogram of non-negative values, HDR style
+ *
+ * Values below 2^kSubBucketBits get a bucket each; above that, every power
+ * of two is split into 2^kSubBucketBits equal buckets, so a reported
+ * percentile is within 1/16 (6.25%) of the true value over the whole
+ * 64-bit range. Recording touches one shard: a bucket, the count, the sum
+ * and, for a new maximum, the max.
+ */
+class Histogram {
+public:
+    static constexpr size_t kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets;
+
+        double Mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0; }
+        // Upper bound of the bucket holding the p-th percentile, capped at max
+        uint64_t Percentile(double p) const;
+    };
+
+    Histogram();
+
+    void Record(uint64_t value) noexcept {
+        if constexpr (kEnabled) {
+            Shard& shard = shards_[detail::ThreadSlot() % kHistogramShards];
+            shard.buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.count.fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+            uint64_t seen = shard.max.load(std::memory_order_relaxed);
+            while (value > seen && !shard.max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    // Records the time since `start_ns`, a NowNanos() reading
+    void RecordSince(uint64_t start_ns) noexcept {
+        if constexpr (kEnabled) {
+            uint64_t now = NowNanos();
+            Record(now > start_ns ? now - start_ns : 0);
+        }
+    }
+
+    Snapshot Take() const;
+    void Reset() noexcept;
+
+    static size_t BucketOf(uint64_t value) noexcept {
+        if (value < 2 * kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        size_t exponent = 63 - static_cast<size_t>(CountLeadingZeros(value));
+        size_t shift = exponent - kSubBucketBits;
+        return (exponent - kSubBucketBits + 1) * kSubBuckets + static_cast<size_t>((value >> shift) - kSubBuckets);
+    }
+
+    // Largest value that falls into bucket `index`
+    static uint64_t BucketUpperBound(size_t index) noexcept;
+
+private:
+    static int CountLeadingZeros(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(value & bit); bit >>= 1) {
+            ++zeros;
+        }
+        return zeros;
+#endif
+    }
+
+    struct alignas(max_nfs_size) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+    };
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * @brief Named metrics of the process
+ *
+ * Get*() creates a metric on first use and always returns the same object
+ * for a name, so callers look it up once and keep the reference. Callback
+ * gauges are read at export time, e.g. to report the queue length of every
+ * live pool; callbacks registered under the same name are summed.
+ */
+class Registry {
+public:
+    // Never destroyed, so metrics stay valid in static destructors
+    static Registry& Instance();
+
+    Counter& GetCounter(const std::string& name);
+    Gauge& GetGauge(const std::string& name);
+    Histogram& GetHistogram(const std::string& name);
+
+    // Returns an id for RemoveCallbackGauge(); `read` may run on any thread
+    uint64_t AddCallbackGauge(const std::string& name, std::function<int64_t()> read);
+    void RemoveCallbackGauge(uint64_t id);
+
+    /**
+     * @brief Every metric as one JSON object
+     *
+     * Counters and gauges map to numbers; histograms to an object with
+     * count, sum, mean, max, p50, p90, p99 and p999.
+     */
+    std::string ToJson() const;
+
+    // Zeroes counters and histograms; gauges keep their level
+    void Reset();
+
+private:
+    Registry() = default;
+
+    struct CallbackGauge {
+        std::string name;
+        std::function<int64_t()> read;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+    std::map<uint64_t, CallbackGauge> callbacks_;
+    uint64_t next_callback_ = 1;
+};
+
+/**
+ * @brief A finished span as recorded by a thread
+ *
+ * Category and name point to string literals.
+ */
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t thread;  // Small sequential id of the recording thread
+};
+
+/**
+ * @brief Collects spans into per-thread rings, exported as Chrome trace JSON
+ *
+ * Disabled by default; while disabled a span costs one relaxed load. When
+ * enabled, each thread writes its spans into its own ring of
+ * buffer_events() slots without locking, overwriting the oldest, so
+ * tracing can stay on in production and the last moments are dumped on
+ * demand. The rings of exited threads are kept until Clear().
+ */
+class Tracer {
+public:
+    static Tracer& Instance();
+
+    void SetEnabled(bool enabled) noexcept { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool Enabled() const noexcept { return kEnabled && enabled_.load(std::memory_order_relaxed); }
+
+    // Ring size of threads that record their first span from now on
+    void SetBufferEvents(size_t events);
+    size_t BufferEvents() const;
+
+    // `category` and `name` must outlive the tracer, e.g. string literals
+    void Record(const char* category, const char* name, uint64_t start_ns, uint64_t end_ns) noexcept;
+
+    // What the rings hold now, ordered by start time
+    std::vector<TraceEvent> Collect() const;
+
+    /**
+     * @brief Collect() in the Chrome trace event format
+     *
+     * Complete ("X") events with microsecond timestamps, loadable in
+     * chrome://tracing and Perfetto.
+     */
+    std::string ChromeTraceJson() const;
+    bool WriteChromeTrace(const std::string& path) const;
+
+    // Empties the rings and forgets those of exited threads
+    void Clear();
+
+private:
+    struct Ring;
+
+    Tracer() = default;
+    Ring* ThisThreadRing();
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    size_t buffer_events_ = 4096;
+    uint32_t next_thread_ = 1;
+};
+
+/**
+ * @brief Records the lifetime of the scope as a span, if tracing is enabled
+ */
+class ScopedSpan {
+public:
+    ScopedSpan(const char* category, const char* name) noexcept
+        : category_(category),
+          name_(name),
+          start_(Tracer::Instance().Enabled() ? NowNanos() : 0) {}
+
+    ~ScopedSpan() {
+        if (start_) {
+            Tracer::Instance().Record(category_, name_, start_, NowNanos());
+        }
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    uint64_t start_;
+};
+
+} // namespace metrics
+} // namespace SAK
+
+#define SAK_METRICS_CONCAT_(a, b) a##b
+#define SAK_METRICS_CONCAT(a, b) SAK_METRICS_CONCAT_(a, b)
+
+#if defined(CODEKNIFE_NO_METRICS)
+#define SAK_TRACE_SPAN(category, name) ((void)0)
+#else
+// Traces the rest of the enclosing scope; both arguments are string literals
+#define SAK_TRACE_SPAN(category, name) \
+    ::SAK::metrics::ScopedSpan SAK_METRICS_CONCAT(sak_trace_span_, __LINE__)(category, name)
+#endif
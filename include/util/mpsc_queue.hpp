@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace SAK {
+
+/// Embed (or derive from) this in elements of an mpsc_queue
+struct mpsc_node {
+    std::atomic<mpsc_node*> next{nullptr};
+};
+
+/**
+ * @brief Unbounded intrusive multi-producer single-consumer queue
+ *
+ * Vyukov's design: push() is one atomic exchange and never fails or
+ * allocates; pop() is wait-free for the consumer but may return nullptr
+ * while a producer is between its exchange and its link, in which case
+ * the element shows up on a later pop(). Only one thread may pop at a
+ * time. The queue never owns its elements.
+ */
+template<typename T>
+class mpsc_queue {
+public:
+    mpsc_queue() : head_(&stub_), tail_(&stub_) {}
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    void push(T* item) noexcept {
+        link(static_cast<mpsc_node*>(item));
+    }
+
+    T* pop() noexcept {
+        mpsc_node* tail = tail_;
+        mpsc_node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // A producer has swapped the head but not linked it yet
+            return nullptr;
+        }
+        // `tail` is the last element: put the stub behind it so it can go
+        link(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+    /// Consumer side; a concurrent push may not be visible yet
+    bool empty() const noexcept {
+        return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    void link(mpsc_node* node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        mpsc_node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::atomic<mpsc_node*> head_;
+    mpsc_node* tail_;
+    mpsc_node stub_;
+};
+
+} // namespace SAK
@@ -9,6 +9,11 @@
 #include <cassert>
 #include <atomic>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#ifdef DEBUG
+#include <unordered_set>
+#endif
 
 namespace SAK {
 namespace pool {
@@ -34,8 +39,10 @@ enum class GrowthPolicy {
  * 
  * @tparam T The type of objects to pool
  * @tparam ResetFunction Type of function used to reset objects (defaults to no-op)
+ * @tparam Mutex Lock guarding the free list; short critical sections make
+ *         SAK::spin_mutex a good fit when std::mutex syscalls show up
  */
-template <typename T, typename ResetFunction = std::function<void(T&)>>
+template <typename T, typename ResetFunction = std::function<void(T&)>, typename Mutex = std::mutex>
 class ObjectPool {
 public:
     /**
@@ -98,7 +105,7 @@ public:
      * @return T* Pointer to the object (nullptr if allocation failed)
      */
     T* acquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
 
         if (objects_.empty()) {
             if (!grow()) {
@@ -143,13 +150,13 @@ public:
             // Delete it instead to prevent corruption
             delete obj;
             {
-                std::lock_guard<std::mutex> lock(mutex_);
+                std::lock_guard<Mutex> lock(mutex_);
                 --active_count_;
             }
             return;
         }
 
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
 
         // Basic double-free protection: check if object is already in pool
         // This is O(n) but helps catch usage errors in debug scenarios
@@ -184,7 +191,7 @@ public:
      * @return size_t Number of available objects
      */
     size_t available_count() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         return objects_.size();
     }
 
@@ -194,7 +201,7 @@ public:
      * @return size_t Total number of objects
      */
     size_t total_count() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         // Calculate total within single critical section to avoid race condition
         return active_count_.load() + objects_.size();
     }
@@ -206,7 +213,7 @@ public:
      * @param size New growth size parameter
      */
     void set_growth_policy(GrowthPolicy policy, size_t size) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         growth_policy_ = policy;
         growth_size_ = size;
     }
@@ -217,7 +224,7 @@ public:
      * @param reset_func New reset function
      */
     void set_reset_function(ResetFunction reset_func) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         reset_func_ = reset_func;
     }
 
@@ -227,7 +234,7 @@ public:
      * @param capacity Desired capacity
      */
     void reserve(size_t capacity) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         
         size_t current_total = objects_.size() + active_count_.load();
         if (capacity > current_total) {
@@ -247,7 +254,7 @@ public:
      * @return size_t Number of objects removed
      */
     size_t trim(size_t target_size = 0) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<Mutex> lock(mutex_);
         
         if (objects_.size() <= target_size) {
             return 0;
@@ -313,7 +320,7 @@ private:
     std::vector<std::unique_ptr<T>> objects_;
     
     // Synchronization
-    mutable std::mutex mutex_;
+    mutable Mutex mutex_;
     
     // Configuration
     GrowthPolicy growth_policy_;
@@ -324,6 +331,535 @@ private:
     std::atomic<size_t> active_count_;
 };
 
+/**
+ * @brief Object pool with per-thread magazines and a lock-free depot.
+ *
+ * Each thread keeps two magazines of up to `MagazineSize` objects per pool
+ * (a loaded one and a previous one) and serves acquire/release from them
+ * without synchronization. When both are exhausted or both are full, a
+ * whole magazine is exchanged with a shared depot: two lock-free stacks of
+ * full and empty magazines. The mutex is only taken to grow the pool,
+ * register a thread, or reconfigure the pool.
+ *
+ * Growth follows the same GrowthPolicy rules as ObjectPool. Objects parked
+ * in another thread's magazines are not visible to the caller, so a Fixed
+ * pool can report exhaustion while other threads hold spare objects. A
+ * thread's magazines return to the depot when the thread exits.
+ *
+ * With DEBUG defined, releasing an object that is already in the pool throws
+ * std::runtime_error; the check is O(1) but serializes acquire/release.
+ *
+ * @tparam T The type of objects to pool
+ * @tparam ResetFunction Type of function used to reset objects (defaults to no-op)
+ * @tparam MagazineSize Objects per magazine
+ */
+template <typename T, typename ResetFunction = std::function<void(T&)>, size_t MagazineSize = 32>
+class ShardedObjectPool {
+    static_assert(MagazineSize > 0, "MagazineSize must be positive");
+
+    struct Magazine {
+        T* items[MagazineSize];
+        size_t count = 0;
+        // Depot link: index + 1 of the next magazine, 0 for none
+        std::atomic<uint32_t> next{0};
+        uint32_t index = 0;
+    };
+
+    // Per-thread state; owned by the core so that counters survive thread exit
+    struct ThreadState {
+        Magazine* loaded = nullptr;
+        Magazine* previous = nullptr;
+        // Written by the owner thread only
+        std::atomic<size_t> acquired{0};
+        std::atomic<size_t> released{0};
+    };
+
+    // Shared with thread-local entries so that exiting threads can tell
+    // whether the pool is still alive
+    struct Core {
+        static constexpr size_t kChunkMagazines = 64;
+        static constexpr size_t kMaxChunks = 1024;
+
+        // Heads pack an ABA tag (high 32 bits) with index + 1 (low 32 bits)
+        std::atomic<uint64_t> full_head{0};
+        std::atomic<uint64_t> empty_head{0};
+        std::atomic<Magazine*> chunks[kMaxChunks] = {};
+        size_t chunk_count = 0;          // Guarded by mutex
+        std::atomic<size_t> total{0};    // Objects owned by the pool
+        std::atomic<size_t> deleted{0};  // Released objects deleted instead of pooled
+
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadState>> threads;  // Guarded by mutex
+        GrowthPolicy growth_policy;
+        size_t growth_size;
+        ResetFunction reset_func;
+
+#ifdef DEBUG
+        std::mutex debug_mutex;
+        std::unordered_set<T*> pooled;
+#endif
+
+        Core(GrowthPolicy policy, size_t size, ResetFunction reset)
+            : growth_policy(policy), growth_size(size), reset_func(std::move(reset)) {}
+
+        ~Core() {
+            for (size_t c = 0; c < chunk_count; ++c) {
+                Magazine* chunk = chunks[c].load(std::memory_order_relaxed);
+                for (size_t i = 0; i < kChunkMagazines; ++i) {
+                    for (size_t j = 0; j < chunk[i].count; ++j) {
+                        delete chunk[i].items[j];
+                    }
+                }
+                delete[] chunk;
+            }
+        }
+
+        Magazine* At(uint32_t index) const {
+            return &chunks[index / kChunkMagazines].load(std::memory_order_acquire)[index % kChunkMagazines];
+        }
+
+        void Push(std::atomic<uint64_t>& head, Magazine* mag) {
+            uint64_t old_head = head.load(std::memory_order_relaxed);
+            uint64_t new_head;
+            do {
+                mag->next.store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+                new_head = ((old_head >> 32) + 1) << 32 | (mag->index + 1);
+            } while (!head.compare_exchange_weak(old_head, new_head, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        }
+
+        Magazine* Pop(std::atomic<uint64_t>& head) {
+            uint64_t old_head = head.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(old_head) != 0) {
+                Magazine* mag = At(static_cast<uint32_t>(old_head) - 1);
+                uint64_t new_head = ((old_head >> 32) + 1) << 32 | mag->next.load(std::memory_order_relaxed);
+                if (head.compare_exchange_weak(old_head, new_head, std::memory_order_acquire,
+                                               std::memory_order_acquire)) {
+                    return mag;
+                }
+            }
+            return nullptr;
+        }
+
+        // Must be called with mutex held
+        bool AddChunk() {
+            if (chunk_count == kMaxChunks) return false;
+            Magazine* chunk = new (std::nothrow) Magazine[kChunkMagazines];
+            if (!chunk) return false;
+            for (size_t i = 0; i < kChunkMagazines; ++i) {
+                chunk[i].index = static_cast<uint32_t>(chunk_count * kChunkMagazines + i);
+            }
+            chunks[chunk_count].store(chunk, std::memory_order_release);
+            ++chunk_count;
+            for (size_t i = 0; i < kChunkMagazines; ++i) {
+                Push(empty_head, &chunk[i]);
+            }
+            return true;
+        }
+
+        Magazine* PopEmpty() {
+            Magazine* mag = Pop(empty_head);
+            while (!mag) {
+                std::lock_guard<std::mutex> lock(mutex);
+                mag = Pop(empty_head);
+                if (!mag && !AddChunk()) return nullptr;
+            }
+            return mag;
+        }
+
+        // Creates `count` objects into full magazines; the first one is
+        // returned to the caller instead of going to the depot.
+        // Must be called with mutex held.
+        template <typename... Args>
+        bool Populate(size_t count, Magazine** first, Args&&... args) {
+            std::vector<T*> created;
+            try {
+                created.reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    created.push_back(new T(args...));
+                }
+            } catch (...) {
+                for (T* obj : created) delete obj;
+                return false;
+            }
+
+            size_t pos = 0;
+            while (pos < created.size()) {
+                Magazine* mag = Pop(empty_head);
+                if (!mag && AddChunk()) mag = Pop(empty_head);
+                if (!mag) {
+                    for (; pos < created.size(); ++pos) delete created[pos];
+                    break;
+                }
+                size_t n = std::min(MagazineSize, created.size() - pos);
+                std::copy(created.begin() + pos, created.begin() + pos + n, mag->items);
+                mag->count = n;
+                pos += n;
+#ifdef DEBUG
+                {
+                    std::lock_guard<std::mutex> debug_lock(debug_mutex);
+                    pooled.insert(mag->items, mag->items + n);
+                }
+#endif
+                total.fetch_add(n, std::memory_order_relaxed);
+                if (first && !*first) {
+                    *first = mag;
+                } else {
+                    Push(full_head, mag);
+                }
+            }
+            return !first || *first;
+        }
+
+        size_t ActiveCount() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t acquired = 0;
+            size_t released = 0;
+            for (const auto& state : threads) {
+                acquired += state->acquired.load(std::memory_order_relaxed);
+                released += state->released.load(std::memory_order_relaxed);
+            }
+            // Counters are read without a snapshot, so clamp transient skew
+            released += deleted.load(std::memory_order_relaxed);
+            return acquired > released ? acquired - released : 0;
+        }
+    };
+
+    struct LocalEntry {
+        uint64_t pool_id;
+        std::weak_ptr<Core> core;
+        ThreadState* state;
+    };
+
+    // Thread-local registry of the pools this thread has touched
+    struct LocalRegistry {
+        std::vector<LocalEntry> entries;
+
+        ~LocalRegistry() {
+            for (auto& entry : entries) {
+                if (std::shared_ptr<Core> core = entry.core.lock()) {
+                    Flush(*core, entry.state->loaded);
+                    Flush(*core, entry.state->previous);
+                    entry.state->loaded = nullptr;
+                    entry.state->previous = nullptr;
+                }
+            }
+        }
+
+        static void Flush(Core& core, Magazine* mag) {
+            if (!mag) return;
+            core.Push(mag->count ? core.full_head : core.empty_head, mag);
+        }
+    };
+
+public:
+    /**
+     * @brief Construct a new Sharded Object Pool
+     *
+     * @param initial_size Initial number of objects in the pool
+     * @param growth_policy How the pool should grow when empty
+     * @param growth_size Size parameter for growth (amount to add or multiply by)
+     * @param reset_func Function to reset objects when returned to the pool
+     */
+    explicit ShardedObjectPool(
+        size_t initial_size = 32,
+        GrowthPolicy growth_policy = GrowthPolicy::Multiplicative,
+        size_t growth_size = 2,
+        ResetFunction reset_func = [](T&) {}
+    ) : id_(next_id_.fetch_add(1, std::memory_order_relaxed)),
+        core_(std::make_shared<Core>(growth_policy, growth_size, std::move(reset_func)))
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        if (!core_->Populate(initial_size, nullptr)) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Construct a new Sharded Object Pool with in-place construction
+     *
+     * Only the initial objects receive `args`; growth default-constructs, as
+     * in ObjectPool.
+     */
+    template <typename... Args>
+    explicit ShardedObjectPool(
+        size_t initial_size,
+        GrowthPolicy growth_policy,
+        size_t growth_size,
+        ResetFunction reset_func,
+        Args&&... args
+    ) : id_(next_id_.fetch_add(1, std::memory_order_relaxed)),
+        core_(std::make_shared<Core>(growth_policy, growth_size, std::move(reset_func)))
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        if (!core_->Populate(initial_size, nullptr, std::forward<Args>(args)...)) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ShardedObjectPool(const ShardedObjectPool&) = delete;
+    ShardedObjectPool& operator=(const ShardedObjectPool&) = delete;
+
+    /**
+     * @brief Get an object from the pool
+     *
+     * @return T* Pointer to the object (nullptr if the pool is exhausted)
+     */
+    T* acquire() {
+        ThreadState* state = local_state();
+        if (!state) return nullptr;
+
+        if (state->loaded->count == 0) {
+            if (state->previous->count > 0) {
+                std::swap(state->loaded, state->previous);
+            } else if (Magazine* full = core_->Pop(core_->full_head)) {
+                core_->Push(core_->empty_head, state->previous);
+                state->previous = state->loaded;
+                state->loaded = full;
+            } else if (Magazine* grown = grow()) {
+                core_->Push(core_->empty_head, state->previous);
+                state->previous = state->loaded;
+                state->loaded = grown;
+            } else {
+                return nullptr;
+            }
+        }
+
+        T* obj = state->loaded->items[--state->loaded->count];
+#ifdef DEBUG
+        {
+            std::lock_guard<std::mutex> debug_lock(core_->debug_mutex);
+            core_->pooled.erase(obj);
+        }
+#endif
+        bump(state->acquired);
+        return obj;
+    }
+
+    /**
+     * @brief Return an object to the pool
+     *
+     * @param obj Pointer to the object to return
+     */
+    void release(T* obj) {
+        if (!obj) return;
+        ThreadState* state = local_state();
+
+#ifdef DEBUG
+        {
+            std::lock_guard<std::mutex> debug_lock(core_->debug_mutex);
+            if (core_->pooled.count(obj)) {
+                throw std::runtime_error("Attempted to release object that is already in pool");
+            }
+        }
+#endif
+
+        try {
+            core_->reset_func(*obj);
+        } catch (...) {
+            // A half-reset object cannot be reused safely
+            drop(obj);
+            return;
+        }
+
+        if (!state) {
+            drop(obj);
+            return;
+        }
+
+        if (state->loaded->count == MagazineSize) {
+            if (state->previous->count == 0) {
+                std::swap(state->loaded, state->previous);
+            } else if (Magazine* empty = core_->PopEmpty()) {
+                core_->Push(core_->full_head, state->previous);
+                state->previous = state->loaded;
+                state->loaded = empty;
+            } else {
+                drop(obj);
+                return;
+            }
+        }
+
+        state->loaded->items[state->loaded->count++] = obj;
+#ifdef DEBUG
+        {
+            std::lock_guard<std::mutex> debug_lock(core_->debug_mutex);
+            core_->pooled.insert(obj);
+        }
+#endif
+        bump(state->released);
+    }
+
+    /**
+     * @brief Get the number of objects currently in use
+     */
+    size_t active_count() const {
+        return core_->ActiveCount();
+    }
+
+    /**
+     * @brief Get the number of objects available, including other threads' magazines
+     */
+    size_t available_count() const {
+        return total_count() - active_count();
+    }
+
+    /**
+     * @brief Get the total number of objects managed by the pool
+     */
+    size_t total_count() const {
+        return core_->total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the growth policy
+     */
+    void set_growth_policy(GrowthPolicy policy, size_t size) {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        core_->growth_policy = policy;
+        core_->growth_size = size;
+    }
+
+    /**
+     * @brief Set the reset function
+     *
+     * Not synchronized with concurrent release(), as in ObjectPool.
+     */
+    void set_reset_function(ResetFunction reset_func) {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        core_->reset_func = reset_func;
+    }
+
+    /**
+     * @brief Reserve capacity for a specific number of objects
+     */
+    void reserve(size_t capacity) {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        size_t current_total = core_->total.load(std::memory_order_relaxed);
+        if (capacity > current_total) {
+            core_->Populate(capacity - current_total, nullptr);
+        }
+    }
+
+    /**
+     * @brief Trim the pool towards a specific number of available objects
+     *
+     * Only objects in the depot are freed; magazines held by threads are untouched.
+     *
+     * @return size_t Number of objects removed
+     */
+    size_t trim(size_t target_size = 0) {
+        size_t removed = 0;
+        size_t available = available_count();
+        while (available > target_size) {
+            Magazine* mag = core_->Pop(core_->full_head);
+            if (!mag) break;
+            while (mag->count > 0 && available > target_size) {
+                T* obj = mag->items[--mag->count];
+#ifdef DEBUG
+                {
+                    std::lock_guard<std::mutex> debug_lock(core_->debug_mutex);
+                    core_->pooled.erase(obj);
+                }
+#endif
+                delete obj;
+                --available;
+                ++removed;
+            }
+            core_->Push(mag->count ? core_->full_head : core_->empty_head, mag);
+        }
+        core_->total.fetch_sub(removed, std::memory_order_relaxed);
+        return removed;
+    }
+
+private:
+    static void bump(std::atomic<size_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Deletes an object that cannot go back to the pool
+    void drop(T* obj) {
+        delete obj;
+        core_->total.fetch_sub(1, std::memory_order_relaxed);
+        core_->deleted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ThreadState* local_state() {
+        thread_local LocalRegistry registry;
+        thread_local uint64_t cached_id = 0;
+        thread_local ThreadState* cached_state = nullptr;
+        if (cached_id == id_) return cached_state;
+
+        for (const auto& entry : registry.entries) {
+            if (entry.pool_id == id_) {
+                cached_id = id_;
+                cached_state = entry.state;
+                return cached_state;
+            }
+        }
+
+        Magazine* loaded = core_->PopEmpty();
+        Magazine* previous = loaded ? core_->PopEmpty() : nullptr;
+        if (!previous) {
+            if (loaded) core_->Push(core_->empty_head, loaded);
+            return nullptr;
+        }
+
+        ThreadState* state;
+        {
+            std::lock_guard<std::mutex> lock(core_->mutex);
+            core_->threads.push_back(std::make_unique<ThreadState>());
+            state = core_->threads.back().get();
+        }
+        state->loaded = loaded;
+        state->previous = previous;
+
+        // Forget pools that have since been destroyed
+        registry.entries.erase(std::remove_if(registry.entries.begin(), registry.entries.end(),
+                                              [](const LocalEntry& entry) { return entry.core.expired(); }),
+                               registry.entries.end());
+        registry.entries.push_back(LocalEntry{id_, core_, state});
+        cached_id = id_;
+        cached_state = state;
+        return state;
+    }
+
+    // Returns a full magazine of new objects, or nullptr if the pool may not grow
+    Magazine* grow() {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+
+        // Another thread may have grown the pool while we waited
+        if (Magazine* full = core_->Pop(core_->full_head)) {
+            return full;
+        }
+
+        size_t current_size = core_->total.load(std::memory_order_relaxed);
+        size_t new_objects = 0;
+        switch (core_->growth_policy) {
+            case GrowthPolicy::Multiplicative:
+                new_objects = current_size * (core_->growth_size - 1);
+                break;
+            case GrowthPolicy::Additive:
+                new_objects = core_->growth_size;
+                break;
+            case GrowthPolicy::Fixed:
+                return nullptr;
+        }
+
+        Magazine* first = nullptr;
+        if (new_objects == 0 || !core_->Populate(new_objects, &first)) {
+            return nullptr;
+        }
+        return first;
+    }
+
+    // Pool identities are never reused, so stale thread-local entries cannot match
+    static inline std::atomic<uint64_t> next_id_{1};
+
+    const uint64_t id_;
+    std::shared_ptr<Core> core_;
+};
+
 /**
  * @brief RAII wrapper for ObjectPool
  * 
@@ -331,8 +867,10 @@ private:
  * 
  * @tparam T The type of object
  * @tparam ResetFunction Type of function used to reset objects
+ * @tparam Pool Pool type the object came from
  */
-template <typename T, typename ResetFunction = std::function<void(T&)>>
+template <typename T, typename ResetFunction = std::function<void(T&)>,
+          typename Pool = ObjectPool<T, ResetFunction>>
 class PooledObject {
 public:
     /**
@@ -341,7 +879,7 @@ public:
      * @param pool Reference to the object pool
      * @param obj Pointer to the object
      */
-    PooledObject(ObjectPool<T, ResetFunction>& pool, T* obj)
+    PooledObject(Pool& pool, T* obj)
         : pool_(pool), obj_(obj) {}
     
     /**
@@ -418,7 +956,7 @@ public:
     explicit operator bool() const { return obj_ != nullptr; }
 
 private:
-    ObjectPool<T, ResetFunction>& pool_;
+    Pool& pool_;
     T* obj_;
 };
 
@@ -430,9 +968,18 @@ private:
  * @param pool Object pool
  * @return PooledObject<T, ResetFunction> RAII wrapper for the object
  */
-template <typename T, typename ResetFunction>
-PooledObject<T, ResetFunction> make_pooled(ObjectPool<T, ResetFunction>& pool) {
-    return PooledObject<T, ResetFunction>(pool, pool.acquire());
+template <typename T, typename ResetFunction, typename Mutex>
+PooledObject<T, ResetFunction, ObjectPool<T, ResetFunction, Mutex>> make_pooled(ObjectPool<T, ResetFunction, Mutex>& pool) {
+    return PooledObject<T, ResetFunction, ObjectPool<T, ResetFunction, Mutex>>(pool, pool.acquire());
+}
+
+/**
+ * @brief Create a pooled object from a sharded pool
+ */
+template <typename T, typename ResetFunction, size_t MagazineSize>
+PooledObject<T, ResetFunction, ShardedObjectPool<T, ResetFunction, MagazineSize>>
+make_pooled(ShardedObjectPool<T, ResetFunction, MagazineSize>& pool) {
+    return PooledObject<T, ResetFunction, ShardedObjectPool<T, ResetFunction, MagazineSize>>(pool, pool.acquire());
 }
 
 } // namespace pool
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace SAK {
@@ -8,6 +9,15 @@ namespace SAK {
 // Forward declarations
 class CompactionOptions;
 
+/**
+ * @brief When the write-ahead log makes group commits durable
+ */
+enum class WalSyncPolicy {
+    None,      // Leave flushing to the OS; a crash may lose recent writes
+    Always,    // fdatasync each group commit before acknowledging it
+    Periodic,  // fdatasync once wal_sync_bytes have been written
+};
+
 /**
  * @brief Options for configuring the LSM storage engine
  */
@@ -15,6 +25,14 @@ class Options {
 public:
     // Block size in bytes
     std::size_t block_size{4096};
+
+    // Bytes of decoded SST blocks cached across all tables, 0 to disable,
+    // split over 2^block_cache_shard_bits independently locked shards
+    std::size_t block_cache_size{64 * 1024 * 1024};
+    std::size_t block_cache_shard_bits{4};
+
+    // Bloom filter bits per key in each SST, 0 for none; 10 gives ~1% false positives
+    std::size_t bloom_bits_per_key{10};
     
     // SST size in bytes, also the approximate memtable capacity limit
     std::size_t target_sst_size{2 * 1024 * 1024}; // 2MB default
@@ -24,6 +42,10 @@ public:
     
     // Whether to enable write-ahead logging
     bool enable_wal{true};
+
+    // How the write-ahead log syncs, and how often under WalSyncPolicy::Periodic
+    WalSyncPolicy wal_sync_policy{WalSyncPolicy::Always};
+    std::size_t wal_sync_bytes{1024 * 1024};
     
     // Whether to enable serializable isolation level for MVCC
     bool serializable{false};
@@ -38,6 +60,9 @@ public:
     size_t simple_leveled_size_ratio_percent{50};
     size_t simple_leveled_level0_file_num_compaction_trigger{4};
     size_t simple_leveled_max_levels{7};
+
+    // Compaction output bytes per second, 0 for no limit
+    uint64_t compaction_rate_limit_bytes_per_sec{64 * 1024 * 1024};
     
     // Default constructor
     Options() = default;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "memory_pool_v2.hpp"
+
+namespace SAK {
+
+/**
+ * @brief STL allocator drawing from MemoryPoolV2
+ *
+ * Stateless: every instance shares the process-wide pool, so containers can
+ * be moved and swapped freely. Types over-aligned beyond max_align_t fall
+ * back to the aligned global operator new.
+ *
+ * @code
+ * std::vector<int, SAK::PoolAllocator<int>> values;
+ * @endcode
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = PoolAllocator<U>;
+    };
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if (kOverAligned) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        void* ptr = MemoryPoolV2::GetInstance().Allocate(n * sizeof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_type n) noexcept {
+        if (kOverAligned) {
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+            return;
+        }
+        MemoryPoolV2::GetInstance().Deallocate(ptr, n * sizeof(T));
+    }
+
+private:
+    static constexpr bool kOverAligned = alignof(T) > alignof(std::max_align_t);
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return false;
+}
+
+} // namespace SAK
@@ -0,0 +1,528 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "_config.hpp"
+#include "_utils.hpp"
+#include "waitable_atomic.hpp"
+
+namespace SAK {
+
+/**
+ * @brief What a bounded queue does with push() when it is full
+ */
+enum class overflow_policy : uint8_t {
+    block,      ///< Wait for space (or until the queue is closed)
+    drop,       ///< Discard the new element and count it in dropped()
+    overwrite,  ///< Discard the oldest element and count it in overwritten()
+};
+
+namespace detail {
+
+inline std::size_t ring_capacity(std::size_t requested) {
+    std::size_t capacity = 2;
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Lets threads sleep until a queue becomes non-empty or non-full. Notifiers
+// only touch the futex when someone is waiting, so the uncontended push and
+// pop paths stay free of syscalls.
+class queue_signal {
+public:
+    template<typename Ready>
+    void wait_until(Ready ready) {
+        atomic_backoff backoff;
+        do {
+            if (ready()) return;
+        } while (backoff.BoundedPause());
+
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+#if !defined(__SANITIZE_THREAD__)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+        for (;;) {
+            uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            if (ready()) break;
+            epoch_.wait(epoch, std::memory_order_acquire);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Call after publishing the state change that makes waiters ready
+    void notify_one() {
+        if (has_waiters()) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_one();
+        }
+    }
+
+    void notify_all() {
+        if (has_waiters()) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_all();
+        }
+    }
+
+private:
+    // Orders the caller's earlier publishing store before the read of waiters_
+    bool has_waiters() {
+#if defined(__SANITIZE_THREAD__)
+        // TSAN does not model standalone fences; an RMW gives the same ordering
+        return waiters_.fetch_add(0, std::memory_order_seq_cst) != 0;
+#else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return waiters_.load(std::memory_order_relaxed) != 0;
+#endif
+    }
+
+    waitable_atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+template<typename T>
+struct ring_slot {
+    T* get() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+
+    alignas(T) unsigned char storage[sizeof(T)];
+};
+
+} // namespace detail
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue
+ *
+ * Dmitry Vyukov's array queue: every cell carries a sequence number that
+ * tells producers and consumers whether it is free or filled for their lap,
+ * so each operation is a single CAS on the enqueue or dequeue index plus
+ * one release store on the cell. The two indices sit on their own cache
+ * lines so producers and consumers do not false-share.
+ *
+ * The capacity is rounded up to a power of two. try_push()/try_pop() never
+ * wait; push() applies the queue's overflow_policy and pop() waits for an
+ * element. close() wakes all waiters; afterwards pushes fail and pops drain
+ * what is left.
+ */
+template<typename T>
+class mpmc_queue {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "mpmc_queue elements must be nothrow move constructible");
+
+public:
+    explicit mpmc_queue(std::size_t capacity, overflow_policy policy = overflow_policy::block)
+        : mask_(detail::ring_capacity(capacity) - 1),
+          cells_(new cell[mask_ + 1]),
+          policy_(policy) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~mpmc_queue() {
+        while (try_pop_with([](T&&) {})) {
+        }
+        delete[] cells_;
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    /// Adds `value` unless the queue is full or closed
+    bool try_push(T value) { return try_push_from(value); }
+
+    /**
+     * @brief Adds `value`, resolving a full queue with the overflow policy
+     * @return False if the queue is closed, or if the element was dropped
+     */
+    bool push(T value) {
+        if (try_push_from(value)) return true;
+        if (closed()) return false;
+
+        switch (policy_) {
+            case overflow_policy::drop:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case overflow_policy::overwrite:
+                for (;;) {
+                    if (try_pop_with([](T&&) {})) {
+                        overwritten_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (try_push_from(value)) return true;
+                    if (closed()) return false;
+                }
+            case overflow_policy::block:
+                break;
+        }
+
+        bool pushed = false;
+        space_.wait_until([&] { return (pushed = try_push_from(value)) || closed(); });
+        return pushed;
+    }
+
+    /// Takes the oldest element into `out`; false if the queue is empty
+    bool try_pop(T& out) {
+        return try_pop_with([&out](T&& item) { out = std::move(item); });
+    }
+
+    std::optional<T> try_pop() {
+        std::optional<T> out;
+        try_pop_with([&out](T&& item) { out.emplace(std::move(item)); });
+        return out;
+    }
+
+    /// Waits for an element; false once the queue is closed and drained
+    bool pop(T& out) {
+        bool popped = false;
+        items_.wait_until([&] { return (popped = try_pop(out)) || closed(); });
+        // An element pushed just before close() is still handed out
+        return popped || try_pop(out);
+    }
+
+    /// Makes further pushes fail and wakes every waiting thread
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        items_.notify_all();
+        space_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    /// Element count; only a hint while other threads are pushing or popping
+    std::size_t size_approx() const {
+        std::size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+        std::size_t dequeued = dequeue_pos_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const { return size_approx() == 0; }
+    std::size_t capacity() const { return mask_ + 1; }
+    overflow_policy policy() const { return policy_; }
+
+    /// Elements rejected by push() under overflow_policy::drop
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Elements discarded by push() under overflow_policy::overwrite
+    uint64_t overwritten() const { return overwritten_.load(std::memory_order_relaxed); }
+
+private:
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        detail::ring_slot<T> slot;
+    };
+
+    // Hands the oldest element to sink(T&&) and destroys it
+    template<typename Sink>
+    bool try_pop_with(Sink&& sink) {
+        cell* c;
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t sequence = c->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* item = c->slot.get();
+        sink(std::move(*item));
+        item->~T();
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        space_.notify_one();
+        return true;
+    }
+
+    // Moves from `value` only when a cell was claimed
+    bool try_push_from(T& value) {
+        if (closed()) return false;
+
+        cell* c;
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t sequence = c->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (c->slot.storage) T(std::move(value));
+        c->sequence.store(pos + 1, std::memory_order_release);
+        items_.notify_one();
+        return true;
+    }
+
+    const std::size_t mask_;
+    cell* const cells_;
+    const overflow_policy policy_;
+
+    alignas(max_nfs_size) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(max_nfs_size) std::atomic<std::size_t> dequeue_pos_{0};
+    alignas(max_nfs_size) detail::queue_signal items_;
+    detail::queue_signal space_;
+    std::atomic<bool> closed_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> overwritten_{0};
+};
+
+/**
+ * @brief Bounded wait-free single-producer single-consumer ring
+ *
+ * Exactly one thread may push and one thread may pop. Each side keeps a
+ * private copy of the other side's index and only re-reads the shared one
+ * when the copy says the ring is full (or empty), so a steady stream costs
+ * one release store per operation or per batch. The bulk operations move
+ * a run of elements with a single index update.
+ *
+ * overflow_policy::overwrite is not supported: discarding the oldest
+ * element would make the producer a second consumer. The constructor
+ * throws std::invalid_argument for it; use mpmc_queue instead.
+ */
+template<typename T>
+class spsc_ring {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "spsc_ring elements must be nothrow move constructible");
+
+public:
+    explicit spsc_ring(std::size_t capacity, overflow_policy policy = overflow_policy::block)
+        : mask_(detail::ring_capacity(capacity) - 1),
+          slots_(new detail::ring_slot<T>[mask_ + 1]),
+          policy_(policy) {
+        if (policy == overflow_policy::overwrite) {
+            delete[] slots_;
+            throw std::invalid_argument("spsc_ring does not support overflow_policy::overwrite");
+        }
+    }
+
+    ~spsc_ring() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            slots_[head & mask_].get()->~T();
+        }
+        delete[] slots_;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // ---- Producer side ----
+
+    bool try_push(T value) { return try_push_from(value); }
+
+    /**
+     * @brief Adds `value`, resolving a full ring with the overflow policy
+     * @return False if the ring is closed, or if the element was dropped
+     */
+    bool push(T value) {
+        return push_with_policy([&] { return try_push_from(value); });
+    }
+
+    /**
+     * @brief Default-constructs an element in the next slot and lets
+     *        `fill(T&)` write it there, avoiding a copy of large elements
+     *
+     * `fill` runs at most once, only after a slot has been claimed, and
+     * must not throw.
+     */
+    template<typename Fill>
+    bool try_push_with(Fill&& fill) {
+        static_assert(std::is_default_constructible<T>::value, "try_push_with needs a default constructible T");
+        if (closed()) return false;
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (free_slots(tail, 1) == 0) return false;
+        fill(*new (slots_[tail & mask_].storage) T);
+        publish_tail(tail + 1);
+        return true;
+    }
+
+    /// try_push_with() that resolves a full ring with the overflow policy
+    template<typename Fill>
+    bool push_with(Fill&& fill) {
+        return push_with_policy([&] { return try_push_with(fill); });
+    }
+
+    /**
+     * @brief Moves up to `count` elements from `first` into the ring
+     * @return Number of elements moved; the rest are left untouched
+     */
+    template<typename InputIt>
+    std::size_t try_push_bulk(InputIt first, std::size_t count) {
+        if (closed()) return 0;
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t room = free_slots(tail, count);
+        std::size_t n = count < room ? count : room;
+        for (std::size_t i = 0; i < n; ++i, ++first) {
+            new (slots_[(tail + i) & mask_].storage) T(std::move(*first));
+        }
+        if (n) publish_tail(tail + n);
+        return n;
+    }
+
+    // ---- Consumer side ----
+
+    bool try_pop(T& out) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (available(head, 1) == 0) return false;
+
+        T* item = slots_[head & mask_].get();
+        out = std::move(*item);
+        item->~T();
+        publish_head(head + 1);
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (available(head, 1) == 0) return std::nullopt;
+
+        T* item = slots_[head & mask_].get();
+        std::optional<T> out(std::move(*item));
+        item->~T();
+        publish_head(head + 1);
+        return out;
+    }
+
+    /// Waits for an element; false once the ring is closed and drained
+    bool pop(T& out) {
+        bool popped = false;
+        items_.wait_until([&] { return (popped = try_pop(out)) || closed(); });
+        return popped || try_pop(out);
+    }
+
+    /**
+     * @brief Moves up to `max` elements into `out` without waiting
+     * @return Number of elements moved
+     */
+    template<typename OutputIt>
+    std::size_t try_pop_bulk(OutputIt out, std::size_t max) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t ready = available(head, max);
+        std::size_t n = max < ready ? max : ready;
+        for (std::size_t i = 0; i < n; ++i, ++out) {
+            T* item = slots_[(head + i) & mask_].get();
+            *out = std::move(*item);
+            item->~T();
+        }
+        if (n) publish_head(head + n);
+        return n;
+    }
+
+    /// Waits for at least one element, then takes up to `max` of them
+    template<typename OutputIt>
+    std::size_t pop_bulk(OutputIt out, std::size_t max) {
+        if (max == 0) return 0;
+        items_.wait_until([&] { return available(head_.load(std::memory_order_relaxed), 1) != 0 || closed(); });
+        return try_pop_bulk(out, max);
+    }
+
+    // ---- Either side ----
+
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        items_.notify_all();
+        space_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    std::size_t size_approx() const {
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const { return size_approx() == 0; }
+    std::size_t capacity() const { return mask_ + 1; }
+    overflow_policy policy() const { return policy_; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    template<typename TryPush>
+    bool push_with_policy(TryPush try_push) {
+        if (try_push()) return true;
+        if (closed()) return false;
+        if (policy_ == overflow_policy::drop) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool pushed = false;
+        space_.wait_until([&] { return (pushed = try_push()) || closed(); });
+        return pushed;
+    }
+
+    bool try_push_from(T& value) {
+        if (closed()) return false;
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (free_slots(tail, 1) == 0) return false;
+        new (slots_[tail & mask_].storage) T(std::move(value));
+        publish_tail(tail + 1);
+        return true;
+    }
+
+    // Producer only: free slots, refreshing the cached head if fewer than wanted
+    std::size_t free_slots(std::size_t tail, std::size_t wanted) {
+        std::size_t room = mask_ + 1 - (tail - head_cache_);
+        if (room < wanted) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            room = mask_ + 1 - (tail - head_cache_);
+        }
+        return room;
+    }
+
+    // Consumer only: filled slots, refreshing the cached tail if fewer than wanted
+    std::size_t available(std::size_t head, std::size_t wanted) {
+        std::size_t ready = tail_cache_ - head;
+        if (ready < wanted) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            ready = tail_cache_ - head;
+        }
+        return ready;
+    }
+
+    void publish_tail(std::size_t tail) {
+        tail_.store(tail, std::memory_order_release);
+        items_.notify_one();
+    }
+
+    void publish_head(std::size_t head) {
+        head_.store(head, std::memory_order_release);
+        space_.notify_one();
+    }
+
+    const std::size_t mask_;
+    detail::ring_slot<T>* const slots_;
+    const overflow_policy policy_;
+
+    // Producer's line
+    alignas(max_nfs_size) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;
+    // Consumer's line
+    alignas(max_nfs_size) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_ = 0;
+
+    alignas(max_nfs_size) detail::queue_signal items_;
+    detail::queue_signal space_;
+    std::atomic<bool> closed_{false};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace SAK
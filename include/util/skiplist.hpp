@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstddef>
@@ -7,23 +8,58 @@
 #include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <new>
 #include <random>
 #include <type_traits>
 #include <utility>
+#include "epoch.hpp"
 
 namespace SAK {
 
-/// ConcurrentSkipList: Lock-free concurrent skip list with unsafe modification operations.
+/// Allocators declaring `using releases_in_bulk = std::true_type`, such as
+/// ArenaAllocator, get their memory back all at once rather than through
+/// deallocate().
+template <typename Allocator, typename = void>
+struct allocator_releases_in_bulk : std::false_type {};
+
+template <typename Allocator>
+struct allocator_releases_in_bulk<Allocator, std::void_t<typename Allocator::releases_in_bulk>>
+    : Allocator::releases_in_bulk {};
+
+/// ConcurrentSkipList: Lock-free concurrent skip list.
 ///
 /// Concurrency Contract:
-/// - insert/emplace/find/contains/lower_bound/upper_bound: Safe for concurrent access
+/// - insert/emplace/erase/find/contains/lower_bound/upper_bound and iteration:
+///   Safe for concurrent access
 /// - unsafe_erase/unsafe_clear/unsafe_swap: NOT safe with concurrent readers/writers
 ///   Caller must ensure exclusive access (no concurrent insert/find/iterate) when calling
 ///   these operations to avoid use-after-free and data races.
 /// - Destructor calls unsafe_clear() and assumes no concurrent access during destruction
-template <typename Key, typename Value, typename Compare = std::less<Key>>
+///
+/// erase() marks the node's links, the level 0 one last, which removes the
+/// key; searches that modify the list unlink marked nodes as they pass
+/// them, read-only ones step over them. Unlinked nodes are retired to the
+/// list's epoch_domain and freed once no reader can reach them. Every
+/// operation pins the domain while it walks the list, and every iterator
+/// other than end() holds a pin, so the element it refers to stays valid
+/// even if it is erased; a live iterator therefore also holds back the
+/// freeing of nodes erased meanwhile. Iteration is weakly consistent: it
+/// skips erased elements and sees some, but not necessarily all, of the
+/// concurrent inserts. The iterators and operations of one thread share
+/// its pin, so a thread may hold any number of iterators; pinning only
+/// waits while more than epoch_domain::SLOTS threads are pinned to the list.
+/// The domain's slots add 16 KiB to every list.
+///
+/// Node storage (node plus its tower of next pointers) is obtained from
+/// `Allocator` rebound to an alignment-sized unit type. With an allocator
+/// that releases in bulk, e.g. ArenaAllocator over a ConcurrentArena, nodes
+/// are bump-allocated and never handed back one by one: unsafe_clear() only
+/// runs destructors, and skips even the walk when the elements are
+/// trivially destructible.
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<std::pair<Key, Value>>>
 class ConcurrentSkipList {
 public:
     using key_type = Key;
@@ -32,6 +68,7 @@ public:
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
     using key_compare = Compare;
+    using allocator_type = Allocator;
 
 private:
     static constexpr size_type MAX_LEVEL = 16;
@@ -41,15 +78,31 @@ private:
 
         template <typename... Args>
         explicit Node(size_type height, Args&&... args)
-            : value(std::forward<Args>(args)...), height_(height) {}
+            : value(std::forward<Args>(args)...), height_(static_cast<uint32_t>(height)) {}
 
         value_type value;
-        size_type height_;
+        uint32_t height_;
+        // Held by the inserter until the tower is linked and by the list
+        // until erase(); whoever lets go last retires the node
+        std::atomic<uint32_t> references_{2};
 
         size_type height() const {
             return height_;
         }
 
+        // Links carry a mark in their low bit once erase() has claimed them
+        static bool is_marked(const Node* link) {
+            return (reinterpret_cast<std::uintptr_t>(link) & 1) != 0;
+        }
+
+        static Node* marked(Node* link) {
+            return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(link) | 1);
+        }
+
+        static Node* unmarked(Node* link) {
+            return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(link) & ~std::uintptr_t(1));
+        }
+
         atomic_node_ptr& atomic_next(size_type level) {
             return reinterpret_cast<atomic_node_ptr*>(this + 1)[level];
         }
@@ -58,10 +111,20 @@ private:
             return reinterpret_cast<const atomic_node_ptr*>(this + 1)[level];
         }
 
-        Node* next(size_type level) const {
+        // The successor on `level`, with its mark
+        Node* marked_next(size_type level) const {
             return atomic_next(level).load(std::memory_order_acquire);
         }
 
+        Node* next(size_type level) const {
+            return unmarked(marked_next(level));
+        }
+
+        // Erased: the level 0 link is marked
+        bool deleted() const {
+            return is_marked(marked_next(0));
+        }
+
         void set_next(size_type level, Node* node) {
             atomic_next(level).store(node, std::memory_order_relaxed);
         }
@@ -106,12 +169,38 @@ private:
         using reference = ValueRef;
         using pointer = std::add_pointer_t<std::remove_reference_t<ValueRef>>;
 
-        BasicIterator() : node_(nullptr) {}
-        explicit BasicIterator(NodeType* node) : node_(node) {}
+        BasicIterator() : node_(nullptr), domain_(nullptr) {}
+
+        // `guard`, a pin of `domain`, keeps `node` alive
+        BasicIterator(NodeType* node, epoch_domain* domain, epoch_guard guard)
+            : node_(node), domain_(node ? domain : nullptr) {
+            if (node_) {
+                guard_ = std::move(guard);
+            }
+        }
+
+        // Copies pin the domain again
+        BasicIterator(const BasicIterator& other)
+            : node_(other.node_), domain_(other.domain_), guard_(pin(other.domain_)) {}
+
+        BasicIterator(BasicIterator&&) noexcept = default;
 
         template <typename OtherNodeType, typename OtherValueRef,
                   typename = std::enable_if_t<std::is_convertible<OtherNodeType*, NodeType*>::value>>
-        BasicIterator(const BasicIterator<OtherNodeType, OtherValueRef>& other) : node_(other.node()) {}
+        BasicIterator(const BasicIterator<OtherNodeType, OtherValueRef>& other)
+            : node_(other.node()), domain_(other.domain()), guard_(pin(other.domain())) {}
+
+        BasicIterator& operator=(const BasicIterator& other) {
+            if (this != &other) {
+                // Pinned before the old guard goes, so node_ never dangles
+                guard_ = pin(other.domain_);
+                node_ = other.node_;
+                domain_ = other.domain_;
+            }
+            return *this;
+        }
+
+        BasicIterator& operator=(BasicIterator&&) noexcept = default;
 
         reference operator*() const {
             return node_->value;
@@ -122,7 +211,11 @@ private:
         }
 
         BasicIterator& operator++() {
-            node_ = node_ ? node_->next(0) : nullptr;
+            node_ = node_ ? first_live(node_->next(0)) : nullptr;
+            if (!node_) {
+                guard_.release();
+                domain_ = nullptr;
+            }
             return *this;
         }
 
@@ -144,21 +237,44 @@ private:
             return node_;
         }
 
+        epoch_domain* domain() const {
+            return domain_;
+        }
+
     private:
+        static epoch_guard pin(epoch_domain* domain) {
+            return domain ? domain->pin() : epoch_guard();
+        }
+
         NodeType* node_;
+        epoch_domain* domain_;  // Null at the end
+        epoch_guard guard_;
     };
 
+    // `node`, or the first element after it that is not erased
+    template <typename NodeType>
+    static NodeType* first_live(NodeType* node) {
+        while (node && node->deleted()) {
+            node = node->next(0);
+        }
+        return node;
+    }
+
 public:
     using iterator = BasicIterator<Node, value_type&>;
     using const_iterator = BasicIterator<const Node, const value_type&>;
 
-    explicit ConcurrentSkipList(const Compare& compare = Compare())
-        : compare_(compare), size_(0), max_height_(1) {}
+    explicit ConcurrentSkipList(const Compare& compare = Compare(), const Allocator& allocator = Allocator())
+        : compare_(compare), node_allocator_(allocator), size_(0), max_height_(1) {}
+
+    allocator_type get_allocator() const {
+        return allocator_type(node_allocator_);
+    }
 
     ConcurrentSkipList(const ConcurrentSkipList&) = delete;
     ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
 
-    ConcurrentSkipList(ConcurrentSkipList&& other) noexcept {
+    ConcurrentSkipList(ConcurrentSkipList&& other) noexcept : node_allocator_(other.node_allocator_) {
         move_from(std::move(other));
     }
 
@@ -187,56 +303,70 @@ public:
         Node* new_node = create_node(random_level(), std::forward<Args>(args)...);
         std::array<Node*, MAX_LEVEL> prev_nodes{};
         std::array<Node*, MAX_LEVEL> next_nodes{};
-
-        for (;;) {
-            bool found_existing = find_path(new_node->value.first, prev_nodes, next_nodes);
-            if (found_existing) {
-                Node* existing = next_nodes[0];
-                destroy_node(new_node);
-                return { iterator(existing), false };
-            }
-
-            for (size_type level = 0; level < new_node->height(); ++level) {
-                new_node->set_next(level, next_nodes[level]);
+        epoch_guard guard = domain_.pin();
+        Node* linked = link_node(new_node, prev_nodes, next_nodes, false);
+        if (linked != new_node) {
+            destroy_node(new_node);
+            return { iterator(linked, &domain_, std::move(guard)), false };
+        }
+        return { iterator(new_node, &domain_, std::move(guard)), true };
+    }
+
+    /// Insert the elements of [first, last), ideally sorted by key.
+    ///
+    /// Each search starts from the path of the previous insert (a finger)
+    /// rather than from the head, so a sorted batch costs little more than
+    /// walking to the neighbouring nodes. Keys already present are skipped
+    /// before a node is made for them. Unsorted input is accepted and falls
+    /// back to full searches. Safe to run concurrently with other inserts.
+    ///
+    /// @return Number of elements inserted
+    template <typename InputIt>
+    size_type insert_batch(InputIt first, InputIt last) {
+        std::array<Node*, MAX_LEVEL> prev_nodes{};
+        std::array<Node*, MAX_LEVEL> next_nodes{};
+        size_type inserted = 0;
+        // Also keeps the finger's nodes alive
+        epoch_guard guard = domain_.pin();
+        for (; first != last; ++first) {
+            size_type height = random_level();
+            if (find_path_from(first->first, height, prev_nodes, next_nodes)) {
+                continue;
             }
-
-            Node* expected = next_nodes[0];
-            if (!link_after(prev_nodes[0], 0, expected, new_node)) {
+            Node* new_node = create_node(height, first->first, first->second);
+            if (link_node(new_node, prev_nodes, next_nodes, true) != new_node) {
+                destroy_node(new_node);
                 continue;
             }
-
-            publish_max_height(new_node->height());
-
-            for (size_type level = 1; level < new_node->height(); ++level) {
-                for (;;) {
-                    expected = next_nodes[level];
-                    if (link_after(prev_nodes[level], level, expected, new_node)) {
-                        break;
-                    }
-                    find_path(new_node->value.first, prev_nodes, next_nodes);
-                    new_node->set_next(level, next_nodes[level]);
-                }
+            // The next key in order is searched for from just past this one
+            for (size_type level = 0; level < height; ++level) {
+                prev_nodes[level] = new_node;
             }
-
-            size_.fetch_add(1, std::memory_order_release);
-            return { iterator(new_node), true };
+            ++inserted;
         }
+        return inserted;
     }
 
-    iterator find(const key_type& key) {
-        return iterator(find_node(key));
+    template <typename Range>
+    size_type insert_batch(const Range& sorted_range) {
+        using std::begin;
+        using std::end;
+        return insert_batch(begin(sorted_range), end(sorted_range));
     }
 
-    const_iterator find(const key_type& key) const {
-        return const_iterator(find_node(key));
+    iterator find(const key_type& key) {
+        epoch_guard guard = domain_.pin();
+        return iterator(find_node(key), &domain_, std::move(guard));
     }
 
-    bool contains(const key_type& key) {
-        return find(key) != end();
+    const_iterator find(const key_type& key) const {
+        epoch_guard guard = domain_.pin();
+        return const_iterator(find_node(key), &domain_, std::move(guard));
     }
 
     bool contains(const key_type& key) const {
-        return find(key) != end();
+        epoch_guard guard = domain_.pin();
+        return find_node(key) != nullptr;
     }
 
     size_type count(const key_type& key) {
@@ -248,19 +378,36 @@ public:
     }
 
     iterator lower_bound(const key_type& key) {
-        return iterator(lower_bound_node(key));
+        epoch_guard guard = domain_.pin();
+        return iterator(lower_bound_node(key), &domain_, std::move(guard));
     }
 
     const_iterator lower_bound(const key_type& key) const {
-        return const_iterator(lower_bound_node(key));
+        epoch_guard guard = domain_.pin();
+        return const_iterator(lower_bound_node(key), &domain_, std::move(guard));
+    }
+
+    /// lower_bound() searching forward from `hint`, which should be at or
+    /// before the result; cheap when the key is not far past the hint, as
+    /// when scanning with increasing keys. An unusable hint is ignored.
+    iterator lower_bound(const key_type& key, const const_iterator& hint) {
+        epoch_guard guard = domain_.pin();
+        return iterator(const_cast<Node*>(lower_bound_node(key, hint.node())), &domain_, std::move(guard));
+    }
+
+    const_iterator lower_bound(const key_type& key, const const_iterator& hint) const {
+        epoch_guard guard = domain_.pin();
+        return const_iterator(lower_bound_node(key, hint.node()), &domain_, std::move(guard));
     }
 
     iterator upper_bound(const key_type& key) {
-        return iterator(upper_bound_node(key));
+        epoch_guard guard = domain_.pin();
+        return iterator(upper_bound_node(key), &domain_, std::move(guard));
     }
 
     const_iterator upper_bound(const key_type& key) const {
-        return const_iterator(upper_bound_node(key));
+        epoch_guard guard = domain_.pin();
+        return const_iterator(upper_bound_node(key), &domain_, std::move(guard));
     }
 
     std::pair<iterator, iterator> equal_range(const key_type& key) {
@@ -272,27 +419,74 @@ public:
     }
 
     iterator begin() {
-        return iterator(head_.next_at(0));
+        epoch_guard guard = domain_.pin();
+        return iterator(first_live(head_.next_at(0)), &domain_, std::move(guard));
     }
 
     const_iterator begin() const {
-        return const_iterator(head_.next_at(0));
+        epoch_guard guard = domain_.pin();
+        return const_iterator(first_live(head_.next_at(0)), &domain_, std::move(guard));
     }
 
     const_iterator cbegin() const {
-        return const_iterator(head_.next_at(0));
+        return begin();
     }
 
     iterator end() {
-        return iterator(nullptr);
+        return iterator();
     }
 
     const_iterator end() const {
-        return const_iterator(nullptr);
+        return const_iterator();
     }
 
     const_iterator cend() const {
-        return const_iterator(nullptr);
+        return const_iterator();
+    }
+
+    /// Remove the element with `key`, if any. Safe to run concurrently with
+    /// every other operation but the unsafe_ ones; iterators to the element
+    /// stay valid, and the node is freed once none is left.
+    ///
+    /// @return Number of elements removed
+    size_type erase(const key_type& key) {
+        std::array<Node*, MAX_LEVEL> prev_nodes{};
+        std::array<Node*, MAX_LEVEL> next_nodes{};
+        epoch_guard guard = domain_.pin();
+        if (!find_path(key, prev_nodes, next_nodes)) {
+            return 0;
+        }
+
+        // Top down, so searches stop descending through the node first
+        Node* node = next_nodes[0];
+        for (size_type level = node->height(); level-- > 1;) {
+            Node* next = node->marked_next(level);
+            while (!Node::is_marked(next) &&
+                   !node->atomic_next(level).compare_exchange_weak(next, Node::marked(next), std::memory_order_acq_rel,
+                                                                   std::memory_order_acquire)) {
+            }
+        }
+        Node* next = node->marked_next(0);
+        do {
+            if (Node::is_marked(next)) {
+                // Another erase() removed it first
+                return 0;
+            }
+        } while (!node->atomic_next(0).compare_exchange_weak(next, Node::marked(next), std::memory_order_acq_rel,
+                                                            std::memory_order_acquire));
+        size_.fetch_sub(1, std::memory_order_release);
+
+        // Ordered against an inserter still linking the tower; see build_tower()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        find_path(key, prev_nodes, next_nodes);
+        release_node(node);
+        return 1;
+    }
+
+    /// A pin of the domain that reclaims erased nodes. Pointers and
+    /// references into elements stay valid while it is held.
+    epoch_guard pin() const {
+        return domain_.pin();
     }
 
     size_type unsafe_erase(const key_type& key) {
@@ -320,7 +514,7 @@ public:
         }
         Node* next = pos.node()->next(0);
         unsafe_erase(pos->first);
-        return iterator(next);
+        return iterator(next, &domain_, domain_.pin());
     }
 
     iterator unsafe_erase(const_iterator pos) {
@@ -329,7 +523,7 @@ public:
         }
         Node* next = pos.node()->next(0);
         unsafe_erase(pos->first);
-        return iterator(next);
+        return iterator(next, &domain_, domain_.pin());
     }
 
     iterator unsafe_erase(const_iterator first, const_iterator last) {
@@ -337,16 +531,21 @@ public:
         while (current != last) {
             current = unsafe_erase(current);
         }
-        return iterator(const_cast<Node*>(current.node()));
+        return iterator(const_cast<Node*>(current.node()), &domain_, domain_.pin());
     }
 
     void unsafe_clear() noexcept {
         std::lock_guard<std::mutex> lock(erase_mutex_);
-        Node* current = head_.next_at(0);
-        while (current) {
-            Node* next = current->next(0);
-            destroy_node(current);
-            current = next;
+        // Nodes erase() retired; no reader can reach them any more
+        domain_.purge();
+        // The allocator's owner reclaims bulk-released nodes; nothing to run for them
+        if (!releases_in_bulk || !std::is_trivially_destructible<value_type>::value) {
+            Node* current = head_.next_at(0);
+            while (current) {
+                Node* next = current->next(0);
+                destroy_node(current);
+                current = next;
+            }
         }
 
         for (size_type level = 0; level < MAX_LEVEL; ++level) {
@@ -365,6 +564,11 @@ public:
         return size() == 0;
     }
 
+    /// Bytes of node storage obtained from the allocator and not given back
+    size_type memory_usage() const {
+        return memory_usage_.load(std::memory_order_relaxed);
+    }
+
     size_type max_size() const {
         return std::numeric_limits<size_type>::max() / sizeof(Node);
     }
@@ -377,6 +581,9 @@ public:
         std::lock(erase_mutex_, other.erase_mutex_);
         std::lock_guard<std::mutex> left_lock(erase_mutex_, std::adopt_lock);
         std::lock_guard<std::mutex> right_lock(other.erase_mutex_, std::adopt_lock);
+        // Retired nodes go back to the allocator that made them
+        domain_.purge();
+        other.domain_.purge();
 
         for (size_type level = 0; level < MAX_LEVEL; ++level) {
             Node* this_next = head_.next[level].load(std::memory_order_relaxed);
@@ -385,8 +592,10 @@ public:
             other.head_.next[level].store(this_next, std::memory_order_relaxed);
         }
         std::swap(compare_, other.compare_);
+        std::swap(node_allocator_, other.node_allocator_);
         swap_atomic(size_, other.size_);
         swap_atomic(max_height_, other.max_height_);
+        swap_atomic(memory_usage_, other.memory_usage_);
     }
 
 private:
@@ -398,29 +607,141 @@ private:
         rhs.store(lhs_value, std::memory_order_relaxed);
     }
 
+    struct alignas(Node) NodeUnit {
+        unsigned char bytes[alignof(Node)];
+    };
+    using node_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<NodeUnit>;
+    using node_allocator_traits = std::allocator_traits<node_allocator_type>;
+    static constexpr bool releases_in_bulk = allocator_releases_in_bulk<node_allocator_type>::value;
+
     static size_type node_allocation_size(size_type height) {
         return sizeof(Node) + sizeof(typename Node::atomic_node_ptr) * height;
     }
 
+    static size_type node_allocation_units(size_type height) {
+        return (node_allocation_size(height) + sizeof(NodeUnit) - 1) / sizeof(NodeUnit);
+    }
+
     template <typename... Args>
-    static Node* create_node(size_type height, Args&&... args) {
-        void* storage = ::operator new(node_allocation_size(height));
-        Node* node = new (storage) Node(height, std::forward<Args>(args)...);
+    Node* create_node(size_type height, Args&&... args) {
+        size_type units = node_allocation_units(height);
+        NodeUnit* storage = node_allocator_traits::allocate(node_allocator_, units);
+        Node* node;
+        try {
+            node = new (storage) Node(height, std::forward<Args>(args)...);
+        } catch (...) {
+            node_allocator_traits::deallocate(node_allocator_, storage, units);
+            throw;
+        }
         for (size_type level = 0; level < height; ++level) {
             new (&node->atomic_next(level)) typename Node::atomic_node_ptr(nullptr);
         }
+        memory_usage_.fetch_add(units * sizeof(NodeUnit), std::memory_order_relaxed);
         return node;
     }
 
-    static void destroy_node(Node* node) noexcept {
+    // Drops one of the node's two references; see Node::references_
+    void release_node(Node* node) {
+        if (node->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            domain_.retire(node, &destroy_retired, this);
+        }
+    }
+
+    static void destroy_retired(void* node, void* list) {
+        static_cast<ConcurrentSkipList*>(list)->destroy_node(static_cast<Node*>(node));
+    }
+
+    void destroy_node(Node* node) noexcept {
         if (!node) {
             return;
         }
+        size_type units = node_allocation_units(node->height());
         for (size_type level = 0; level < node->height(); ++level) {
             node->atomic_next(level).~atomic<Node*>();
         }
         node->~Node();
-        ::operator delete(node);
+        if (!releases_in_bulk) {
+            node_allocator_traits::deallocate(node_allocator_, reinterpret_cast<NodeUnit*>(node), units);
+            memory_usage_.fetch_sub(units * sizeof(NodeUnit), std::memory_order_relaxed);
+        }
+    }
+
+    // Starts loading what a search looks at on reaching `node` at `level`:
+    // its key and its link, which sit on different lines for larger values
+    static void prefetch(const Node* node, size_type level) {
+#if defined(__GNUC__) || defined(__clang__)
+        if (node) {
+            __builtin_prefetch(node);
+            __builtin_prefetch(&node->atomic_next(level));
+        }
+#else
+        (void)node;
+        (void)level;
+#endif
+    }
+
+    // Links new_node between the nodes in prev_nodes and next_nodes, which
+    // bracket its key when path_ready is set and are searched for otherwise.
+    // Returns the node already holding the key, or new_node once linked.
+    Node* link_node(Node* new_node, std::array<Node*, MAX_LEVEL>& prev_nodes,
+                    std::array<Node*, MAX_LEVEL>& next_nodes, bool path_ready) {
+        for (;; path_ready = false) {
+            if (!path_ready && find_path(new_node->value.first, prev_nodes, next_nodes)) {
+                return next_nodes[0];
+            }
+
+            for (size_type level = 0; level < new_node->height(); ++level) {
+                new_node->set_next(level, next_nodes[level]);
+            }
+
+            Node* expected = next_nodes[0];
+            if (!link_after(prev_nodes[0], 0, expected, new_node)) {
+                continue;
+            }
+
+            // The key is in from here on
+            size_.fetch_add(1, std::memory_order_release);
+            publish_max_height(new_node->height());
+            link_tower(new_node, prev_nodes, next_nodes);
+            return new_node;
+        }
+    }
+
+    // Links the upper levels of a node linked on level 0, then drops the
+    // inserter's reference. An erase() may mark the node meanwhile: the
+    // tower stops growing then, and whichever of the two runs its search
+    // last unlinks every level that made it in.
+    void link_tower(Node* node, std::array<Node*, MAX_LEVEL>& prev_nodes, std::array<Node*, MAX_LEVEL>& next_nodes) {
+        for (size_type level = 1; level < node->height() && link_level(node, level, prev_nodes, next_nodes); ++level) {
+        }
+
+        // Pairs with the fence in erase(): either it sees the last link or we see its mark
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (node->deleted()) {
+            find_path(node->value.first, prev_nodes, next_nodes);
+        }
+        release_node(node);
+    }
+
+    // False once the node is marked on `level`
+    bool link_level(Node* node, size_type level, std::array<Node*, MAX_LEVEL>& prev_nodes,
+                    std::array<Node*, MAX_LEVEL>& next_nodes) {
+        for (;;) {
+            Node* own = node->marked_next(level);
+            if (Node::is_marked(own)) {
+                return false;
+            }
+            if (own != next_nodes[level] &&
+                !node->atomic_next(level).compare_exchange_strong(own, next_nodes[level], std::memory_order_acq_rel,
+                                                                  std::memory_order_acquire)) {
+                return false;
+            }
+            Node* expected = next_nodes[level];
+            if (link_after(prev_nodes[level], level, expected, node)) {
+                return true;
+            }
+            find_path(node->value.first, prev_nodes, next_nodes);
+        }
     }
 
     bool link_after(Node* prev, size_type level, Node*& expected, Node* desired) {
@@ -430,6 +751,10 @@ private:
         return prev->atomic_next(level).compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
     }
 
+    Node* next_after(const Node* prev, size_type level) const {
+        return prev ? prev->next(level) : head_.next_at(level);
+    }
+
     void set_next_after(Node* prev, size_type level, Node* next) {
         if (prev == nullptr) {
             head_.set_next(level, next);
@@ -468,80 +793,155 @@ private:
         max_height_.store(current, std::memory_order_relaxed);
     }
 
-    bool find_path(const key_type& key, std::array<Node*, MAX_LEVEL>& prev_nodes, std::array<Node*, MAX_LEVEL>& next_nodes) const {
-        Node* prev = nullptr;
+    // Searches for the path to key, unlinking erased nodes on the way
+    bool find_path(const key_type& key, std::array<Node*, MAX_LEVEL>& prev_nodes, std::array<Node*, MAX_LEVEL>& next_nodes) {
         size_type current_height = max_height_.load(std::memory_order_acquire);
+        while (!descend(key, nullptr, current_height, prev_nodes, next_nodes)) {
+        }
 
-        for (size_type level = current_height; level > 0; --level) {
-            Node* current = prev ? prev->next(level - 1) : head_.next_at(level - 1);
-            while (current && compare_(current->value.first, key)) {
+        for (size_type level = current_height; level < MAX_LEVEL; ++level) {
+            prev_nodes[level] = nullptr;
+            next_nodes[level] = nullptr;
+        }
+
+        return next_nodes[0] && keys_equal(compare_, next_nodes[0]->value.first, key);
+    }
+
+    // Fills levels [0, top) of the path to key, starting at `prev` on the top
+    // one, and unlinks the erased nodes it passes. False when a predecessor
+    // was erased too, so the path has to be searched for again from the head.
+    bool descend(const key_type& key, Node* prev, size_type top, std::array<Node*, MAX_LEVEL>& prev_nodes,
+                 std::array<Node*, MAX_LEVEL>& next_nodes) {
+        for (size_type level = top; level > 0; --level) {
+            Node* current = next_after(prev, level - 1);
+            while (current) {
+                Node* next = current->marked_next(level - 1);
+                if (Node::is_marked(next)) {
+                    Node* expected = current;
+                    if (!link_after(prev, level - 1, expected, Node::unmarked(next))) {
+                        return false;
+                    }
+                    current = Node::unmarked(next);
+                    continue;
+                }
+                // Overlap the miss on the following node with this comparison
+                prefetch(next, level - 1);
+                if (!compare_(current->value.first, key)) {
+                    break;
+                }
                 prev = current;
-                current = current->next(level - 1);
+                current = next;
             }
             prev_nodes[level - 1] = prev;
             next_nodes[level - 1] = current;
         }
-
-        for (size_type level = current_height; level < MAX_LEVEL; ++level) {
-            prev_nodes[level] = nullptr;
-            next_nodes[level] = nullptr;
+        return true;
+    }
+
+    // find_path() reusing prev_nodes, the path to a smaller key, as a finger:
+    // climbs only until the finger brackets key on every level a node of
+    // `height` links into, then descends from there. Levels above keep the
+    // finger, which still precedes key.
+    bool find_path_from(const key_type& key, size_type height, std::array<Node*, MAX_LEVEL>& prev_nodes,
+                        std::array<Node*, MAX_LEVEL>& next_nodes) {
+        size_type top = std::max(max_height_.load(std::memory_order_acquire), height);
+        size_type level = 0;
+        while (level + 1 < top) {
+            if (level + 1 >= height) {
+                Node* next = next_after(prev_nodes[level], level);
+                if (!next || !compare_(next->value.first, key)) {
+                    break;
+                }
+            }
+            ++level;
         }
 
+        Node* start = prev_nodes[level];
+        if (start && (start->deleted() || !compare_(start->value.first, key))) {
+            // Erased, or not sorted after the previous key
+            return find_path(key, prev_nodes, next_nodes);
+        }
+        if (!descend(key, start, level + 1, prev_nodes, next_nodes)) {
+            return find_path(key, prev_nodes, next_nodes);
+        }
         return next_nodes[0] && keys_equal(compare_, next_nodes[0]->value.first, key);
     }
 
     Node* find_node(const key_type& key) const {
-        std::array<Node*, MAX_LEVEL> prev_nodes{};
-        std::array<Node*, MAX_LEVEL> next_nodes{};
-        return find_path(key, prev_nodes, next_nodes) ? next_nodes[0] : nullptr;
+        Node* node = lower_bound_node(key);
+        return node && keys_equal(compare_, node->value.first, key) ? node : nullptr;
     }
 
     Node* lower_bound_node(const key_type& key) const {
-        Node* prev = nullptr;
-        size_type current_height = max_height_.load(std::memory_order_acquire);
-        for (size_type level = current_height; level > 0; --level) {
-            Node* current = prev ? prev->next(level - 1) : head_.next_at(level - 1);
-            while (current && compare_(current->value.first, key)) {
-                prev = current;
-                current = current->next(level - 1);
-            }
+        return seek(key, nullptr, max_height_.load(std::memory_order_acquire), false);
+    }
+
+    const Node* lower_bound_node(const key_type& key, const Node* hint) const {
+        if (!hint || hint->deleted() || !compare_(hint->value.first, key)) {
+            return lower_bound_node(key);
         }
-        return prev ? prev->next(0) : head_.next_at(0);
+        return seek(key, const_cast<Node*>(hint), hint->height(), false);
     }
 
     Node* upper_bound_node(const key_type& key) const {
-        Node* prev = nullptr;
-        size_type current_height = max_height_.load(std::memory_order_acquire);
-        for (size_type level = current_height; level > 0; --level) {
-            Node* current = prev ? prev->next(level - 1) : head_.next_at(level - 1);
-            while (current && !compare_(key, current->value.first)) {
+        return seek(key, nullptr, max_height_.load(std::memory_order_acquire), true);
+    }
+
+    // The first live node not before key, or after key when `after` is set,
+    // starting at `prev` (before it) on level top - 1. Steps over erased
+    // nodes without unlinking them, so readers never write to the list.
+    Node* seek(const key_type& key, Node* prev, size_type top, bool after) const {
+        Node* current = nullptr;
+        for (size_type level = top; level > 0; --level) {
+            current = next_after(prev, level - 1);
+            while (current) {
+                Node* next = current->marked_next(level - 1);
+                if (Node::is_marked(next)) {
+                    current = Node::unmarked(next);
+                    continue;
+                }
+                // Overlap the miss on the following node with this comparison
+                prefetch(next, level - 1);
+                if (after ? compare_(key, current->value.first) : !compare_(current->value.first, key)) {
+                    break;
+                }
                 prev = current;
-                current = current->next(level - 1);
+                current = next;
             }
         }
-        return prev ? prev->next(0) : head_.next_at(0);
+        return current;
     }
 
     void move_from(ConcurrentSkipList&& other) {
+        // The nodes stay with the allocator that made them
+        other.domain_.purge();
         compare_ = std::move(other.compare_);
+        node_allocator_ = other.node_allocator_;
         for (size_type level = 0; level < MAX_LEVEL; ++level) {
             head_.set_next(level, other.head_.next[level].load(std::memory_order_relaxed));
             other.head_.set_next(level, nullptr);
         }
         size_.store(other.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
         max_height_.store(other.max_height_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        memory_usage_.store(other.memory_usage_.load(std::memory_order_relaxed), std::memory_order_relaxed);
         other.size_.store(0, std::memory_order_relaxed);
         other.max_height_.store(1, std::memory_order_relaxed);
+        other.memory_usage_.store(0, std::memory_order_relaxed);
     }
 
     HeadNode head_;
     Compare compare_{};
+    node_allocator_type node_allocator_;
     std::atomic<size_type> size_;
     std::atomic<size_type> max_height_;
+    std::atomic<size_type> memory_usage_{0};
     mutable std::mutex erase_mutex_;
+    // Last, so it frees what is still retired while the allocator exists
+    mutable epoch_domain domain_;
 };
 
-template <typename Key, typename Value, typename Compare = std::less<Key>>
-using SkipList = ConcurrentSkipList<Key, Value, Compare>;
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<std::pair<Key, Value>>>
+using SkipList = ConcurrentSkipList<Key, Value, Compare, Allocator>;
 
 } // namespace SAK
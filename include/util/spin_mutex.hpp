@@ -3,6 +3,7 @@
 #include "_utils.hpp"
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 
 namespace SAK {
 
@@ -124,36 +125,318 @@ private:
     bool is_writer_{};
 };
 
-class spin_mutex {
+/**
+ * @brief Snapshot of the contention counters of a lock
+ */
+struct lock_counters {
+    uint64_t acquisitions = 0;  ///< Successful lock()/lock_shared() calls
+    uint64_t contended = 0;     ///< Acquisitions that had to wait
+    uint64_t spins = 0;         ///< Backoff rounds spent waiting in total
+};
+
+/// Stats policy that records nothing; the default for every lock type
+struct no_lock_stats {
+    void record(uint64_t) noexcept {}
+    lock_counters counters() const noexcept { return {}; }
+    void reset() noexcept {}
+};
+
+/// Stats policy that counts acquisitions, contended acquisitions and spins
+class lock_stats {
+public:
+    void record(uint64_t spins) noexcept {
+        acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        if (spins) {
+            contended_.fetch_add(1, std::memory_order_relaxed);
+            spins_.fetch_add(spins, std::memory_order_relaxed);
+        }
+    }
+
+    lock_counters counters() const noexcept {
+        lock_counters c;
+        c.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+        c.contended = contended_.load(std::memory_order_relaxed);
+        c.spins = spins_.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    void reset() noexcept {
+        acquisitions_.store(0, std::memory_order_relaxed);
+        contended_.store(0, std::memory_order_relaxed);
+        spins_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> acquisitions_{0};
+    std::atomic<uint64_t> contended_{0};
+    std::atomic<uint64_t> spins_{0};
+};
+
+/**
+ * @brief Test-and-test-and-set spin lock with exponential backoff
+ *
+ * Waiters spin on a plain load, so the cache line stays shared until the
+ * lock is released, and back off with machine_pause() in doubling rounds
+ * before falling back to yielding. Not fair: under heavy contention use
+ * ticket_mutex.
+ *
+ * @tparam Stats no_lock_stats, or lock_stats to collect contention counters
+ */
+template<typename Stats = no_lock_stats>
+class basic_spin_mutex {
 public:
     static constexpr bool is_fair_mutex = false;
     static constexpr bool is_recursive_mutex = false;
     static constexpr bool is_rw_mutex = false;
 
-    spin_mutex() noexcept : flag_(false) {}
-    ~spin_mutex() = default;
+    basic_spin_mutex() noexcept = default;
+    ~basic_spin_mutex() = default;
 
-    spin_mutex(const spin_mutex&) = delete;
-    spin_mutex& operator=(const spin_mutex&) = delete;
+    basic_spin_mutex(const basic_spin_mutex&) = delete;
+    basic_spin_mutex& operator=(const basic_spin_mutex&) = delete;
+
+    using scoped_lock = unique_scoped_lock<basic_spin_mutex>;
 
-    using scoped_lock = unique_scoped_lock<spin_mutex>;
     void lock() {
+        uint64_t spins = 0;
         atomic_backoff backoff;
-        while (flag_.load(std::memory_order_relaxed) || flag_.exchange(true)) {
+        while (flag_.load(std::memory_order_relaxed) || flag_.exchange(true, std::memory_order_acquire)) {
             backoff.Pause();
+            ++spins;
         }
+        stats_.record(spins);
     }
 
     bool try_lock() {
-        return !flag_.load(std::memory_order_relaxed) && !flag_.exchange(true);
+        if (flag_.load(std::memory_order_relaxed) || flag_.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+        stats_.record(0);
+        return true;
     }
 
     void unlock() {
         flag_.store(false, std::memory_order_release);
     }
 
+    lock_counters counters() const noexcept { return stats_.counters(); }
+    void reset_counters() noexcept { stats_.reset(); }
+
 private:
     std::atomic<bool> flag_{false};
+    Stats stats_;
 };
 
-}
\ No newline at end of file
+using spin_mutex = basic_spin_mutex<>;
+
+/**
+ * @brief FIFO ticket lock for highly contended critical sections
+ *
+ * Each locker takes a ticket and waits until it is served, so the lock is
+ * granted in arrival order and no thread starves. Waiters back off in
+ * proportion to their distance from the head of the queue. The two
+ * counters live on separate cache lines so taking a ticket does not
+ * disturb the waiters polling the served counter.
+ */
+template<typename Stats = no_lock_stats>
+class basic_ticket_mutex {
+public:
+    static constexpr bool is_fair_mutex = true;
+    static constexpr bool is_recursive_mutex = false;
+    static constexpr bool is_rw_mutex = false;
+
+    basic_ticket_mutex() noexcept = default;
+    ~basic_ticket_mutex() = default;
+
+    basic_ticket_mutex(const basic_ticket_mutex&) = delete;
+    basic_ticket_mutex& operator=(const basic_ticket_mutex&) = delete;
+
+    using scoped_lock = unique_scoped_lock<basic_ticket_mutex>;
+
+    void lock() {
+        const uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t spins = 0;
+        for (;;) {
+            const uint32_t serving = serving_.load(std::memory_order_acquire);
+            if (serving == ticket) {
+                break;
+            }
+            // Yield when far back in the queue, or when the thread being
+            // served is likely descheduled; spinning would only delay it
+            const uint32_t ahead = ticket - serving;
+            if (ahead > PAUSES_BEFORE_YIELD / PAUSES_PER_WAITER || spins >= SPINS_BEFORE_YIELD) {
+                yield();
+            } else {
+                machine_pause(static_cast<int32_t>(ahead * PAUSES_PER_WAITER));
+            }
+            ++spins;
+        }
+        stats_.record(spins);
+    }
+
+    bool try_lock() {
+        uint32_t ticket = serving_.load(std::memory_order_relaxed);
+        if (!next_.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            return false;
+        }
+        stats_.record(0);
+        return true;
+    }
+
+    void unlock() {
+        // Only the holder writes serving_
+        serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    lock_counters counters() const noexcept { return stats_.counters(); }
+    void reset_counters() noexcept { stats_.reset(); }
+
+private:
+    static constexpr uint32_t PAUSES_PER_WAITER = 8;
+    static constexpr uint32_t PAUSES_BEFORE_YIELD = 256;
+    static constexpr uint64_t SPINS_BEFORE_YIELD = 16;
+
+    alignas(max_nfs_size) std::atomic<uint32_t> next_{0};
+    alignas(max_nfs_size) std::atomic<uint32_t> serving_{0};
+    Stats stats_;
+};
+
+using ticket_mutex = basic_ticket_mutex<>;
+
+/**
+ * @brief Reader-writer spin lock with writer preference
+ *
+ * The state word holds a writer bit, a writer-pending bit and the reader
+ * count. A waiting writer sets the pending bit, which stops new readers
+ * from entering, so a stream of readers cannot starve writers. Works with
+ * rw_scoped_lock, including UpgradeToWriter() and DowngradeToReader().
+ */
+template<typename Stats = no_lock_stats>
+class basic_spin_rw_mutex {
+public:
+    static constexpr bool is_fair_mutex = false;
+    static constexpr bool is_recursive_mutex = false;
+    static constexpr bool is_rw_mutex = true;
+
+    basic_spin_rw_mutex() noexcept = default;
+    ~basic_spin_rw_mutex() = default;
+
+    basic_spin_rw_mutex(const basic_spin_rw_mutex&) = delete;
+    basic_spin_rw_mutex& operator=(const basic_spin_rw_mutex&) = delete;
+
+    using scoped_lock = rw_scoped_lock<basic_spin_rw_mutex>;
+
+    void lock() {
+        uint64_t spins = 0;
+        atomic_backoff backoff;
+        for (;;) {
+            state_type s = state_.load(std::memory_order_relaxed);
+            if (!(s & BUSY)) {
+                if (state_.compare_exchange_strong(s, WRITER, std::memory_order_acquire)) {
+                    break;
+                }
+                backoff.Reset();
+            } else if (!(s & WRITER_PENDING)) {
+                state_.fetch_or(WRITER_PENDING, std::memory_order_relaxed);
+            }
+            backoff.Pause();
+            ++spins;
+        }
+        stats_.record(spins);
+    }
+
+    bool try_lock() {
+        state_type s = state_.load(std::memory_order_relaxed);
+        if (!(s & BUSY) && state_.compare_exchange_strong(s, WRITER, std::memory_order_acquire)) {
+            stats_.record(0);
+            return true;
+        }
+        return false;
+    }
+
+    void unlock() {
+        // Clears the writer bit and any pending bit; still-waiting writers set it again
+        state_.fetch_and(READERS, std::memory_order_release);
+    }
+
+    void lock_shared() {
+        uint64_t spins = 0;
+        atomic_backoff backoff;
+        for (;;) {
+            if (!(state_.load(std::memory_order_relaxed) & (WRITER | WRITER_PENDING))) {
+                if (!(state_.fetch_add(ONE_READER, std::memory_order_acquire) & WRITER)) {
+                    break;
+                }
+                // A writer got in first
+                state_.fetch_sub(ONE_READER, std::memory_order_relaxed);
+            }
+            backoff.Pause();
+            ++spins;
+        }
+        stats_.record(spins);
+    }
+
+    bool try_lock_shared() {
+        if (state_.load(std::memory_order_relaxed) & (WRITER | WRITER_PENDING)) {
+            return false;
+        }
+        if (state_.fetch_add(ONE_READER, std::memory_order_acquire) & WRITER) {
+            state_.fetch_sub(ONE_READER, std::memory_order_relaxed);
+            return false;
+        }
+        stats_.record(0);
+        return true;
+    }
+
+    void unlock_shared() {
+        state_.fetch_sub(ONE_READER, std::memory_order_release);
+    }
+
+    /**
+     * @brief Turn a read lock into the write lock
+     * @return True if the lock was upgraded without being released; false
+     *         if it had to be released first, so state read under the
+     *         read lock must be re-validated
+     */
+    bool upgrade() {
+        state_type s = state_.load(std::memory_order_relaxed);
+        // Only succeeds in place if we are the sole reader or no other writer is waiting
+        while ((s & READERS) == ONE_READER || !(s & WRITER_PENDING)) {
+            if (state_.compare_exchange_strong(s, s | WRITER | WRITER_PENDING, std::memory_order_acquire)) {
+                atomic_backoff backoff;
+                while ((state_.load(std::memory_order_acquire) & READERS) != ONE_READER) {
+                    backoff.Pause();
+                }
+                state_.fetch_sub(ONE_READER + WRITER_PENDING, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        unlock_shared();
+        lock();
+        return false;
+    }
+
+    /// Turn the write lock into a read lock without letting a writer in between
+    void downgrade() {
+        state_.fetch_add(ONE_READER - WRITER, std::memory_order_release);
+    }
+
+    lock_counters counters() const noexcept { return stats_.counters(); }
+    void reset_counters() noexcept { stats_.reset(); }
+
+private:
+    using state_type = uintptr_t;
+    static constexpr state_type WRITER = 1;
+    static constexpr state_type WRITER_PENDING = 2;
+    static constexpr state_type READERS = ~(WRITER | WRITER_PENDING);
+    static constexpr state_type ONE_READER = 4;
+    static constexpr state_type BUSY = WRITER | READERS;
+
+    std::atomic<state_type> state_{0};
+    Stats stats_;
+};
+
+using spin_rw_mutex = basic_spin_rw_mutex<>;
+
+}
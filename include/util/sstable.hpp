@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "block.hpp"
+#include "block_cache.hpp"
+#include "bloom.hpp"
+#include "byte_buffer.hpp"
+#include "file_object.hpp"
+#include "options.hpp"
+
+namespace SAK {
+
+class SsTable;
+
+/**
+ * @brief Location and key range of one data block
+ */
+struct BlockMeta {
+    uint64_t offset;
+    uint32_t size;  // Without the trailing checksum
+    ByteBuffer first_key;
+    uint64_t first_ts;
+    ByteBuffer last_key;
+    uint64_t last_ts;
+};
+
+/**
+ * @brief Writes a sorted table from entries in KeyTs order
+ *
+ * The file is a run of data blocks of about Options::block_size, each
+ * followed by its Crc32c, then a Bloom filter over the distinct keys at
+ * Options::bloom_bits_per_key, unless that is 0, then an index block
+ * holding every block's offset, size and first and last (key, ts) and the
+ * filter's location, each with its own Crc32c, and a fixed footer locating
+ * the index.
+ */
+class SsTableBuilder {
+public:
+    explicit SsTableBuilder(const Options& options);
+
+    /// Entries must arrive in KeyTs order, each (key, ts) once
+    void Add(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value);
+
+    /// Bytes of the file so far; compare against Options::target_sst_size
+    size_t EstimatedSize() const noexcept;
+    bool Empty() const noexcept { return meta_.empty() && block_.Empty(); }
+
+    /**
+     * @brief Write the table to `path` and open it
+     *
+     * @return nullptr if nothing was added or the file could not be written
+     */
+    std::shared_ptr<SsTable> Build(size_t id, const std::string& path,
+                                   std::shared_ptr<BlockCache> cache = nullptr);
+
+private:
+    void FinishBlock();
+
+    const size_t block_size_;
+    const size_t filter_bits_per_key_;
+    BlockBuilder block_;
+    BloomFilterBuilder filter_;
+    std::vector<uint8_t> data_;
+    std::vector<BlockMeta> meta_;
+    ByteBuffer first_key_;
+    uint64_t first_ts_ = 0;
+    ByteBuffer last_key_;
+    uint64_t last_ts_ = 0;
+};
+
+/**
+ * @brief An immutable sorted table on disk
+ *
+ * Open() reads and verifies the footer and index only; data blocks are
+ * read, checksummed and decoded on demand. The file is memory-mapped when
+ * possible, so a block is a slice of the mapping and a point lookup copies
+ * no bytes; otherwise blocks are read with FileObject::Read. Decoded blocks
+ * go through the BlockCache, if given, under (Id(), block offset), so ids
+ * must be unique among the tables sharing a cache. Values, and keys stored
+ * whole, come back as slices of the block rather than copies.
+ */
+class SsTable {
+public:
+    static constexpr uint64_t kMagic = 0x53414b5353544231ull;  // "SAKSSTB1"
+    static constexpr size_t kFooterSize = 8 + 4 + 8;
+
+    /// nullptr if `file` does not hold a well-formed, non-empty table
+    static std::shared_ptr<SsTable> Open(size_t id, FileObject file, std::shared_ptr<BlockCache> cache = nullptr);
+
+    size_t Id() const noexcept { return id_; }
+    uint64_t FileSize() const noexcept { return file_.Size(); }
+    size_t NumBlocks() const noexcept { return meta_.size(); }
+    const BlockMeta& Meta(size_t index) const { return meta_[index]; }
+    const ByteBuffer& FirstKey() const { return meta_.front().first_key; }
+    const ByteBuffer& LastKey() const { return meta_.back().last_key; }
+
+    /**
+     * @brief Block `index`, from the cache or else read and cached at `priority`
+     *
+     * @return nullptr if the block cannot be read or fails its checksum
+     */
+    std::shared_ptr<const Block> ReadBlock(size_t index, CachePriority priority = CachePriority::High) const;
+
+    /// False only if the filter rules `key` out; true when there is no filter
+    bool MayContain(const ByteBuffer& key) const noexcept { return filter_.MayContain(key); }
+    bool HasFilter() const noexcept { return filter_.Valid(); }
+
+    /// First block that may hold (key, ts) or later entries; NumBlocks() if none
+    size_t FindBlock(const ByteBuffer& key, uint64_t ts) const;
+
+    /**
+     * @brief The newest version of `key` at or before `read_ts`
+     *
+     * Consults the Bloom filter first, so most absent keys read no blocks.
+     *
+     * @return nullopt if there is none; an empty buffer for a tombstone
+     */
+    std::optional<ByteBuffer> Get(const ByteBuffer& key, uint64_t read_ts) const;
+
+private:
+    SsTable(size_t id, FileObject file, std::vector<BlockMeta> meta, std::shared_ptr<BlockCache> cache);
+
+    std::shared_ptr<const Block> DecodeBlock(const BlockMeta& meta) const;
+    // Verifies and keeps the filter; a damaged one is left out
+    void LoadFilter(uint64_t offset, uint32_t size);
+
+    const size_t id_;
+    FileObject file_;
+    ByteBuffer mapped_;  // Whole file, or empty if it could not be mapped
+    std::vector<BlockMeta> meta_;
+    std::shared_ptr<BlockCache> cache_;
+    BloomFilter filter_;
+};
+
+/**
+ * @brief Walks every entry of an SsTable in KeyTs order, block by block
+ *
+ * Blocks it reads enter the cache at CachePriority::Low, so a scan does not
+ * displace blocks hot for point lookups. Stops, with Corrupted() set, at a
+ * block that fails to read or verify.
+ */
+class SsTableIterator {
+public:
+    explicit SsTableIterator(std::shared_ptr<const SsTable> table);
+
+    bool Valid() const noexcept { return block_it_ && block_it_->Valid(); }
+    bool Corrupted() const noexcept { return corrupted_; }
+
+    void SeekToFirst();
+    /// To the first entry at or after (key, ts) in KeyTs order
+    void Seek(const ByteBuffer& key, uint64_t ts);
+    void Next();
+
+    ByteBuffer Key() const { return block_it_->Key(); }
+    /// The current key without building a buffer; valid until the iterator moves
+    const char* KeyData() const noexcept { return block_it_->KeyData(); }
+    size_t KeySize() const noexcept { return block_it_->KeySize(); }
+    uint64_t Timestamp() const noexcept { return block_it_->Timestamp(); }
+    ByteBuffer Value() const { return block_it_->Value(); }
+
+private:
+    // Opens block `index` positioned at its first entry; skips empty blocks
+    void LoadBlock(size_t index);
+
+    std::shared_ptr<const SsTable> table_;
+    size_t block_index_ = 0;
+    std::optional<BlockIterator> block_it_;
+    bool corrupted_ = false;
+};
+
+} // namespace SAK
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "thread_pool.hpp"
+#include "unique_task.hpp"
+
+namespace SAK {
+
+template<class T>
+class Task;
+
+namespace detail {
+
+// Shared between a Task, its producer and its continuations
+template<class T>
+class task_state {
+public:
+    using value_type = std::conditional_t<std::is_void<T>::value, char, T>;
+
+    explicit task_state(thread::ThreadPool* owner) : pool(owner) {}
+
+    template<class... V>
+    void set_value(V&&... v) {
+        std::vector<thread::unique_task> ready_callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            value.emplace(std::forward<V>(v)...);
+            publish(ready_callbacks);
+        }
+        run(ready_callbacks);
+    }
+
+    void set_exception(std::exception_ptr exception) {
+        std::vector<thread::unique_task> ready_callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::move(exception);
+            publish(ready_callbacks);
+        }
+        run(ready_callbacks);
+    }
+
+    // Stores fn()'s result, or the exception it throws
+    template<class F>
+    void fulfil(F&& fn) {
+        try {
+            if constexpr (std::is_void<T>::value) {
+                std::forward<F>(fn)();
+                set_value();
+            } else {
+                set_value(std::forward<F>(fn)());
+            }
+        } catch (...) {
+            set_exception(std::current_exception());
+        }
+    }
+
+    // Runs `callback` on the completing thread, or right away if the state
+    // is already complete
+    void on_ready(thread::unique_task callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ready.load(std::memory_order_relaxed)) {
+                callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    void wait() {
+        if (ready.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return ready.load(std::memory_order_relaxed); });
+    }
+
+    thread::ThreadPool* pool;
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    std::atomic<bool> ready{false};
+
+private:
+    void publish(std::vector<thread::unique_task>& ready_callbacks) {
+        ready.store(true, std::memory_order_release);
+        ready_callbacks.swap(callbacks);
+        condition.notify_all();
+    }
+
+    static void run(std::vector<thread::unique_task>& ready_callbacks) {
+        for (auto& callback : ready_callbacks) {
+            callback();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<thread::unique_task> callbacks;
+};
+
+template<class T, class F>
+struct continuation_result {
+    using type = std::invoke_result_t<F&, const T&>;
+};
+
+template<class F>
+struct continuation_result<void, F> {
+    using type = std::invoke_result_t<F&>;
+};
+
+// Lets the free functions below build and inspect Tasks
+struct task_access {
+    template<class T>
+    static Task<T> make(std::shared_ptr<task_state<T>> state) { return Task<T>(std::move(state)); }
+
+    template<class T>
+    static const std::shared_ptr<task_state<T>>& state(const Task<T>& task) { return task.state_; }
+};
+
+} // namespace detail
+
+/**
+ * @brief Result of asynchronous work on a ThreadPool that can be chained
+ *
+ * A Task is a shared handle like std::shared_future: copies refer to the
+ * same result. Instead of blocking in get() to start dependent work, attach
+ * it with then(); the continuation is queued on the deque of the worker
+ * that completed this task (see ThreadPool::post_local), so it usually runs
+ * next on the same core. If this task failed, continuations are skipped and
+ * the exception propagates down the chain.
+ */
+template<class T>
+class Task {
+public:
+    using value_type = T;
+
+    Task() = default;
+
+    bool valid() const { return state_ != nullptr; }
+    bool is_ready() const { return state_ && state_->ready.load(std::memory_order_acquire); }
+
+    // Blocks until the task has completed; avoid calling it on a pool worker
+    void wait() const { state_->wait(); }
+
+    // Waits, then returns the value or rethrows the task's exception
+    decltype(auto) get() const {
+        state_->wait();
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+        if constexpr (!std::is_void<T>::value) {
+            return static_cast<const T&>(*state_->value);
+        }
+    }
+
+    /**
+     * @brief Run fn with this task's value once it is available
+     *
+     * fn takes `const T&` (nothing for Task<void>) and its result becomes
+     * the value of the returned Task.
+     */
+    template<class F>
+    auto then(F&& fn) const -> Task<typename detail::continuation_result<T, std::decay_t<F>>::type> {
+        using result_type = typename detail::continuation_result<T, std::decay_t<F>>::type;
+        auto next = std::make_shared<detail::task_state<result_type>>(state_->pool);
+
+        state_->on_ready(thread::unique_task(
+            [prev = state_, next, fn = std::forward<F>(fn)]() mutable {
+                if (prev->error) {
+                    next->set_exception(prev->error);
+                    return;
+                }
+                auto run = [prev, next, fn = std::move(fn)]() mutable {
+                    next->fulfil([&]() -> result_type {
+                        if constexpr (std::is_void<T>::value) {
+                            return fn();
+                        } else {
+                            return fn(static_cast<const T&>(*prev->value));
+                        }
+                    });
+                };
+                if (!prev->pool) {
+                    run();
+                    return;
+                }
+                try {
+                    prev->pool->post_local(std::move(run));
+                } catch (...) {
+                    // The pool is shutting down
+                    next->set_exception(std::current_exception());
+                }
+            }));
+        return detail::task_access::make(std::move(next));
+    }
+
+private:
+    friend struct detail::task_access;
+
+    explicit Task(std::shared_ptr<detail::task_state<T>> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<detail::task_state<T>> state_;
+};
+
+/**
+ * @brief Run f(args...) on `pool` and return a Task for its result
+ *
+ * The arguments are decay-copied like std::thread does.
+ */
+template<class F, class... Args>
+auto spawn_task(thread::ThreadPool& pool, F&& f, Args&&... args)
+    -> Task<std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>&...>> {
+    using result_type = std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>&...>;
+    auto state = std::make_shared<detail::task_state<result_type>>(&pool);
+
+    pool.post([state, fn = std::forward<F>(f), bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        state->fulfil([&]() -> result_type { return std::apply(fn, bound); });
+    });
+    return detail::task_access::make(std::move(state));
+}
+
+/**
+ * @brief A Task that completes once every task in `tasks` has
+ *
+ * Its value holds the input values in input order (nothing for void). If
+ * any input fails, it fails with the exception of the first failed input
+ * in that order. An empty input yields an already completed Task whose
+ * continuations run inline on the thread that attaches them.
+ */
+template<class T>
+Task<std::conditional_t<std::is_void<T>::value, void, std::vector<T>>> when_all(const std::vector<Task<T>>& tasks) {
+    using result_type = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+    auto result = std::make_shared<detail::task_state<result_type>>(
+        tasks.empty() ? nullptr : detail::task_access::state(tasks.front())->pool);
+    if (tasks.empty()) {
+        result->fulfil([]() -> result_type { return result_type(); });
+        return detail::task_access::make(std::move(result));
+    }
+
+    struct join_state {
+        explicit join_state(const std::vector<Task<T>>& inputs) : tasks(inputs), remaining(inputs.size()) {}
+        std::vector<Task<T>> tasks;
+        std::atomic<size_t> remaining;
+    };
+    auto join = std::make_shared<join_state>(tasks);
+
+    for (const auto& task : tasks) {
+        detail::task_access::state(task)->on_ready(thread::unique_task([join, result]() {
+            if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            for (const auto& input : join->tasks) {
+                if (detail::task_access::state(input)->error) {
+                    result->set_exception(detail::task_access::state(input)->error);
+                    return;
+                }
+            }
+            result->fulfil([&]() -> result_type {
+                if constexpr (!std::is_void<T>::value) {
+                    std::vector<T> values;
+                    values.reserve(join->tasks.size());
+                    for (const auto& input : join->tasks) {
+                        values.push_back(*detail::task_access::state(input)->value);
+                    }
+                    return values;
+                }
+            });
+        }));
+    }
+    return detail::task_access::make(std::move(result));
+}
+
+/**
+ * @brief A Task holding the index of the first task in `tasks` to complete
+ *
+ * A failed input counts as completed; inspect tasks[index] for its result.
+ * Throws std::invalid_argument for an empty input.
+ */
+template<class T>
+Task<size_t> when_any(const std::vector<Task<T>>& tasks) {
+    if (tasks.empty()) {
+        throw std::invalid_argument("when_any needs at least one task");
+    }
+
+    auto result = std::make_shared<detail::task_state<size_t>>(detail::task_access::state(tasks.front())->pool);
+    auto claimed = std::make_shared<std::atomic<bool>>(false);
+    for (size_t index = 0; index < tasks.size(); ++index) {
+        detail::task_access::state(tasks[index])->on_ready(thread::unique_task([result, claimed, index]() {
+            if (!claimed->exchange(true, std::memory_order_acq_rel)) {
+                result->set_value(index);
+            }
+        }));
+    }
+    return detail::task_access::make(std::move(result));
+}
+
+/**
+ * @brief A reusable DAG of void jobs for fan-out/fan-in pipelines
+ *
+ * Nodes are added with add() and ordered with precede(). run() starts the
+ * nodes without predecessors; whenever a node finishes, successors whose
+ * predecessors are all done are queued on the finishing worker's deque.
+ * If a node throws, nodes that have not started yet are skipped and the
+ * Task returned by run() fails with the first exception.
+ */
+class TaskGraph {
+public:
+    using node_id = size_t;
+
+    // Adds a job; the returned id is used with precede()
+    node_id add(std::function<void()> fn);
+
+    // `before` must finish before `after` starts
+    void precede(node_id before, node_id after);
+
+    size_t size() const { return nodes_.size(); }
+
+    /**
+     * @brief Schedule one execution of the graph on `pool`
+     *
+     * The jobs are copied, so the graph may be modified or destroyed while
+     * the run is in progress. Throws std::invalid_argument if the graph
+     * contains a cycle.
+     */
+    Task<void> run(thread::ThreadPool& pool) const;
+
+private:
+    struct node {
+        std::function<void()> fn;
+        std::vector<node_id> successors;
+        size_t predecessors = 0;
+    };
+
+    std::vector<node> nodes_;
+};
+
+} // namespace SAK
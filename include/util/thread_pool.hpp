@@ -8,61 +8,439 @@
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <string>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include "unique_task.hpp"
+#include "waitable_atomic.hpp"
 #include "work_stealing_deque.hpp"
 
 namespace SAK {
 namespace thread {
 
+/**
+ * @brief Scheduling class of a ThreadPool task
+ *
+ * Workers always take queued high priority work before normal, and normal
+ * before low. There is no aging, so a steady stream of higher priority
+ * tasks can starve the lower levels.
+ */
+enum class TaskPriority : uint8_t {
+    high = 0,
+    normal = 1,
+    low = 2,
+};
+
+constexpr size_t kTaskPriorityLevels = 3;
+
+/**
+ * @brief Options for configuring worker placement in a ThreadPool
+ *
+ * Pinning, naming and NUMA discovery are applied on Linux and ignored on
+ * other platforms.
+ */
+class ThreadPoolOptions {
+public:
+    // Number of worker threads; 0 is treated as 1
+    size_t threads{std::thread::hardware_concurrency()};
+
+    // Worker i is pinned to cpus[i % cpus.size()]; empty leaves placement to the OS
+    std::vector<int> cpus;
+
+    // Workers are named "<name_prefix>-<index>" (truncated to 15 characters
+    // on Linux) so they can be told apart in top and perf; empty keeps the
+    // inherited name
+    std::string name_prefix;
+
+    // Partition workers into one group per NUMA node. Stealing tries workers
+    // of the same node before crossing sockets. Without explicit cpus the
+    // workers are spread round-robin over the nodes and bound to each
+    // node's cpus.
+    bool numa_groups{false};
+
+    // Number of workers (the highest indices) that only ever run
+    // TaskPriority::high tasks, as a latency lane that background floods
+    // cannot occupy. Clamped so at least one worker runs everything.
+    size_t high_priority_workers{0};
+
+    ThreadPoolOptions() = default;
+    explicit ThreadPoolOptions(size_t thread_count) : threads(thread_count) {}
+};
+
 class ThreadPool {
 public:
     explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    explicit ThreadPool(const ThreadPoolOptions& options);
     
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args) 
+        -> std::future<decltype(std::declval<F>()(std::declval<Args>()...))> {
+        return enqueue(TaskPriority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template<class F, class... Args>
+    auto enqueue(TaskPriority priority, F&& f, Args&&... args)
         -> std::future<decltype(std::declval<F>()(std::declval<Args>()...))> {
         using return_type = decltype(std::declval<F>()(std::declval<Args>()...));
 
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+        // The packaged_task is moved into the task's inline storage; only its
+        // shared state (needed by the future) is heap allocated
+        std::packaged_task<return_type()> task(
+            bind_call(std::forward<F>(f), std::forward<Args>(args)...)
         );
         
-        std::future<return_type> res = task->get_future();
-        submit_task([task](){ (*task)(); });
+        std::future<return_type> res = task.get_future();
+        submit_task(unique_task(std::move(task)), priority);
         return res;
     }
+
+    /**
+     * @brief Submit a fire-and-forget task
+     *
+     * No future or shared state is created, so a small callable is queued
+     * without any heap allocation. Exceptions thrown by the task are
+     * swallowed; use enqueue() to observe them.
+     */
+    template<class F, class... Args,
+             class = std::enable_if_t<!std::is_same<std::decay_t<F>, TaskPriority>::value>>
+    void post(F&& f, Args&&... args) {
+        post(TaskPriority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template<class F, class... Args>
+    void post(TaskPriority priority, F&& f, Args&&... args) {
+        submit_task(unique_task(bind_call(std::forward<F>(f), std::forward<Args>(args)...)), priority);
+    }
+
+    /**
+     * @brief Awaitable that moves the awaiting coroutine onto a worker
+     *
+     * `co_await pool.schedule()` suspends the coroutine and resumes it from
+     * a worker of this pool. Usable from C++20 code; the awaiter itself
+     * does not depend on <coroutine>, so this header stays C++17.
+     */
+    struct schedule_awaiter {
+        ThreadPool* pool;
+        TaskPriority priority;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<class Handle>
+        void await_suspend(Handle handle) {
+            pool->post(priority, [handle]() mutable { handle.resume(); });
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    schedule_awaiter schedule(TaskPriority priority = TaskPriority::normal) {
+        return schedule_awaiter{this, priority};
+    }
+
+    /**
+     * @brief Queue a task on the calling worker's own deque
+     *
+     * From one of this pool's workers the task is pushed onto that worker's
+     * local deque, where it is popped next (LIFO) while the data the worker
+     * just touched is still in cache; idle workers may still steal it. It
+     * inherits the priority of the running task. From any other thread this
+     * behaves like post() at normal priority.
+     */
+    template<class F>
+    void post_local(F&& f) {
+        spawn(unique_task(std::forward<F>(f)));
+    }
     
+    /**
+     * @brief Submit every callable in a range at once
+     *
+     * The tasks are split into contiguous chunks, one per worker inbox, so
+     * each inbox lock is taken once. At most one parked worker is woken per
+     * inbox that received tasks; other workers reach them by stealing.
+     * Elements are moved out of an rvalue range and copied otherwise.
+     *
+     * @return One future per task, in range order
+     */
+    template<class Range>
+    auto enqueue_bulk(Range&& tasks, TaskPriority priority = TaskPriority::normal)
+        -> std::vector<std::future<std::invoke_result_t<std::decay_t<decltype(*std::begin(tasks))>&>>> {
+        using task_type = std::decay_t<decltype(*std::begin(tasks))>;
+        using return_type = std::invoke_result_t<task_type&>;
+
+        std::vector<unique_task> batch;
+        std::vector<std::future<return_type>> futures;
+        for (auto&& fn : tasks) {
+            std::packaged_task<return_type()> task(
+                [f = forward_element<Range>(fn)]() mutable -> return_type { return f(); });
+            futures.push_back(task.get_future());
+            batch.emplace_back(std::move(task));
+        }
+
+        submit_bulk(batch, priority);
+        return futures;
+    }
+
+    /**
+     * @brief Submit fire-and-forget tasks at once
+     *
+     * Like enqueue_bulk() without futures: the tasks are moved out and
+     * `tasks` is left empty. Throws, leaving `tasks` untouched, if the pool
+     * has been stopped.
+     */
+    void post_bulk(std::vector<unique_task>& tasks, TaskPriority priority = TaskPriority::normal) {
+        submit_bulk(tasks, priority);
+    }
+
+    /**
+     * @brief Call fn(i) for every i in [begin, end) and wait for completion
+     *
+     * The range is cut into chunks of at most `grain` indices. The chunk
+     * range is halved recursively and the upper halves are pushed onto the
+     * current worker's deque, where idle workers steal them. The calling
+     * thread runs chunks too; when it is a worker of this pool it keeps
+     * executing queued tasks while it waits, so nested calls cannot
+     * deadlock. The first exception thrown by fn is rethrown here.
+     *
+     * Chunks inherit the priority of the task that calls parallel_for, or
+     * TaskPriority::normal when called from outside the pool.
+     */
+    template<class Index, class F>
+    void parallel_for(Index begin, Index end, Index grain, F&& fn) {
+        static_assert(std::is_integral<Index>::value, "parallel_for requires an integral index");
+        if (end <= begin) {
+            return;
+        }
+        const std::size_t step = grain > 0 ? static_cast<std::size_t>(grain) : 1;
+        const std::size_t count = static_cast<std::size_t>(end - begin);
+
+        auto leaf = [&](std::size_t chunk) {
+            const std::size_t first = chunk * step;
+            const std::size_t last = first + step < count ? first + step : count;
+            for (std::size_t i = first; i < last; ++i) {
+                fn(static_cast<Index>(begin + static_cast<Index>(i)));
+            }
+        };
+        run_chunked((count + step - 1) / step, leaf);
+    }
+
+    /**
+     * @brief Fold map(i) over [begin, end) with reduce, in parallel
+     *
+     * Each chunk of at most `grain` indices is folded left to right starting
+     * from `identity`, and the chunk results are then folded in index order,
+     * so reduce only needs to be associative.
+     */
+    template<class Index, class T, class Map, class Reduce>
+    T parallel_reduce(Index begin, Index end, Index grain, T identity, Map&& map, Reduce&& reduce) {
+        static_assert(std::is_integral<Index>::value, "parallel_reduce requires an integral index");
+        if (end <= begin) {
+            return identity;
+        }
+        const std::size_t step = grain > 0 ? static_cast<std::size_t>(grain) : 1;
+        const std::size_t count = static_cast<std::size_t>(end - begin);
+        std::vector<T> partials((count + step - 1) / step, identity);
+
+        auto leaf = [&](std::size_t chunk) {
+            const std::size_t first = chunk * step;
+            const std::size_t last = first + step < count ? first + step : count;
+            T acc = identity;
+            for (std::size_t i = first; i < last; ++i) {
+                acc = reduce(std::move(acc), map(static_cast<Index>(begin + static_cast<Index>(i))));
+            }
+            partials[chunk] = std::move(acc);
+        };
+        run_chunked(partials.size(), leaf);
+
+        T result = std::move(identity);
+        for (auto& partial : partials) {
+            result = reduce(std::move(result), std::move(partial));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Queueing counters of one priority level
+     */
+    struct PriorityStats {
+        size_t queued;          // Accepted but not yet picked up by a worker
+        size_t started;         // Picked up by a worker so far
+        uint64_t total_wait_ns; // Sum of submit-to-start delays
+        uint64_t max_wait_ns;   // Largest submit-to-start delay
+
+        uint64_t average_wait_ns() const { return started ? total_wait_ns / started : 0; }
+    };
+
     // Get the current number of tasks in the queue
     size_t get_task_count() const;
+
+    // Get the current number of tasks of one priority in the queue
+    size_t get_task_count(TaskPriority priority) const;
+
+    // Get queue depth and wait-time counters of one priority
+    PriorityStats get_priority_stats(TaskPriority priority) const;
     
     // Get the number of threads in the pool
     size_t get_thread_count() const;
+
+    // Get the number of workers currently parked waiting for work
+    size_t get_parked_count() const;
+
+    // Get the NUMA node a worker was assigned to (0 without numa_groups)
+    uint32_t get_worker_node(size_t worker_index) const;
+
+    // Get the number of distinct NUMA groups the workers are spread over
+    size_t get_group_count() const;
         
     ~ThreadPool();
 
 private:
+    enum park_state : uint32_t {
+        worker_running = 0,
+        worker_parked = 1,
+        worker_notified = 2,
+    };
+
+    // A task together with what the scheduler needs to account for it
+    struct queued_task {
+        unique_task task;
+        std::chrono::steady_clock::time_point enqueued;
+        TaskPriority priority = TaskPriority::normal;
+    };
+
     struct WorkerState {
         WorkerState() = default;
 
-        work_stealing_deque<std::function<void()>> local_tasks;
-        std::deque<std::function<void()>> inbox;
+        // One deque and one inbox per priority level, sharing the inbox lock
+        work_stealing_deque<queued_task> local_tasks[kTaskPriorityLevels];
+        std::deque<queued_task> inbox[kTaskPriorityLevels];
         std::mutex inbox_mutex;
+        // Each worker sleeps on its own word, so a wake-up targets one thread
+        waitable_atomic<uint32_t> park{worker_running};
+
+        // Placement, fixed before the worker starts
+        std::vector<int> affinity;
+        uint32_t numa_node = 0;
+        // Victims in steal order: same-node workers first
+        std::vector<size_t> steal_order;
+        bool high_priority_only = false;
     };
 
-    void submit_task(std::function<void()> task);
-    bool try_acquire_task(size_t worker_index, std::function<void()>& task);
-    bool try_drain_inbox_to_local(size_t worker_index);
-    bool try_steal_task(size_t worker_index, std::function<void()>& task);
+    struct alignas(64) priority_counters {
+        std::atomic<size_t> pending{0};
+        std::atomic<size_t> started{0};
+        std::atomic<uint64_t> total_wait_ns{0};
+        std::atomic<uint64_t> max_wait_ns{0};
+    };
+
+    // Completion tracking for one parallel_for/parallel_reduce call
+    struct fork_join_state {
+        explicit fork_join_state(std::size_t chunks) : remaining(chunks) {}
+
+        void fail(std::exception_ptr error);
+        void complete_chunk();
+        void wait_done();
+
+        std::atomic<std::size_t> remaining;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done_condition;
+        bool done = false;
+    };
+
+    template<class Range, class T>
+    static decltype(auto) forward_element(T& element) {
+        if constexpr (std::is_lvalue_reference<Range>::value) {
+            return static_cast<const T&>(element);
+        } else {
+            return std::move(element);
+        }
+    }
+
+    template<class Leaf>
+    void run_chunked(std::size_t chunks, Leaf& leaf) {
+        fork_join_state state(chunks);
+        split_chunks(state, leaf, 0, chunks);
+        wait_for(state);
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    }
+
+    // Runs chunk `lo` after handing [mid, hi) halves to other workers
+    template<class Leaf>
+    void split_chunks(fork_join_state& state, Leaf& leaf, std::size_t lo, std::size_t hi) {
+        while (hi - lo > 1) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            spawn(unique_task([this, &state, &leaf, mid, hi] { split_chunks(state, leaf, mid, hi); }));
+            hi = mid;
+        }
+        if (!state.failed.load(std::memory_order_relaxed)) {
+            try {
+                leaf(lo);
+            } catch (...) {
+                state.fail(std::current_exception());
+            }
+        }
+        state.complete_chunk();
+    }
+
+    // Decay-copies the arguments like std::bind, without its type erasure
+    template<class F, class... Args>
+    static auto bind_call(F&& f, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            return std::forward<F>(f);
+        } else {
+            return [fn = std::forward<F>(f), bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(fn, bound);
+            };
+        }
+    }
+
+    void submit_task(unique_task task, TaskPriority priority);
+    void submit_bulk(std::vector<unique_task>& tasks, TaskPriority priority);
+    void account_submitted(TaskPriority priority, size_t count);
+    void account_started(const queued_task& task);
+    void wake_for(TaskPriority priority, size_t preferred_index);
+    bool has_runnable_work(size_t worker_index) const;
+    static void run_task(queued_task& task);
+    void spawn(unique_task task);
+    void wait_for(fork_join_state& state);
+    void assign_placement(const ThreadPoolOptions& options);
+    void setup_worker_thread(size_t worker_index);
+    void worker_loop(size_t worker_index);
+    bool search_for_task(size_t worker_index, queued_task& task);
+    void park_worker(size_t worker_index);
+    bool unpark_worker(size_t worker_index);
+    void wake_worker(size_t preferred_index, bool general_only);
+    void wake_workers(size_t count, bool general_only);
+    bool current_worker(size_t& worker_index) const;
+    bool try_acquire_task(size_t worker_index, queued_task& task);
+    bool try_acquire_level(size_t worker_index, size_t level, queued_task& task);
+    bool try_drain_inbox_to_local(size_t worker_index, size_t level);
+    bool try_steal_task(size_t worker_index, size_t level, queued_task& task);
 
     std::vector<std::thread> workers;
     std::vector<std::unique_ptr<WorkerState>> worker_states;
+    std::string name_prefix;
+    size_t group_count = 1;
+    // Workers [0, general_workers) run every priority, the rest only high
+    size_t general_workers = 1;
+    // The "thread_pool.pending" callback gauge of this pool
+    uint64_t metrics_gauge_id = 0;
     
     mutable std::mutex control_mutex;
-    mutable std::mutex wait_mutex;
-    std::condition_variable condition;
     std::atomic<bool> stop;
     std::atomic<size_t> pending_tasks{0};
     std::atomic<size_t> submission_index{0};
+    std::atomic<size_t> searching_workers{0};
+    std::atomic<size_t> parked_workers{0};
+    priority_counters priority_stats[kTaskPriorityLevels];
 };
 
 } // namespace thread
@@ -14,12 +14,87 @@
 #include <cstdint>
 #include <cstdio>
 #include <exception>
+#include <stdexcept>
+#include <vector>
+#include "thread_pool.hpp"
+#include "timing_wheel.hpp"
+#include "unique_task.hpp"
 
 namespace SAK {
 namespace timer {
 
+/// Queue structure behind a Timer
+enum class TimerBackend {
+    heap,   // Binary heap ordered by deadline; exact deadlines, O(log n) schedule
+    wheel   // Hierarchical timing wheel; O(1) schedule and cancel at tick resolution
+};
+
+/**
+ * @brief Runs the callbacks that expired in one pass of the timer thread
+ *
+ * Called on the timer thread with the callbacks in deadline order; it must
+ * move out the tasks it accepts. Tasks it leaves in the vector, or all of
+ * them if it throws, run on the timer thread.
+ */
+using TimerExecutor = std::function<void(std::vector<thread::unique_task>&)>;
+
+struct TimerOptions {
+    TimerBackend backend = TimerBackend::heap;
+    // Wheel only: deadlines are rounded up to a multiple of this
+    std::chrono::microseconds tick = std::chrono::milliseconds(1);
+    // Empty: callbacks run on the timer thread, one after another. With an
+    // executor a periodic callback may overlap with its own next run.
+    TimerExecutor executor;
+};
+
+/// An executor that posts each batch of expired callbacks to `pool` at once
+inline TimerExecutor pool_executor(thread::ThreadPool& pool,
+                                   thread::TaskPriority priority = thread::TaskPriority::normal) {
+    return [&pool, priority](std::vector<thread::unique_task>& batch) { pool.post_bulk(batch, priority); };
+}
+
+/**
+ * @brief How late timer callbacks started relative to their deadlines
+ *
+ * Bucket 0 counts callbacks that started less than 1us late; bucket i
+ * counts those between 2^(i-1) and 2^i microseconds late, and the last
+ * bucket everything later. Wheel deadlines are the requested times, so
+ * tick rounding shows up here.
+ */
+struct TimerLateness {
+    static constexpr size_t BUCKETS = 32;
+
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+
+    uint64_t average_us() const { return count ? total_us / count : 0; }
+
+    /// Upper bound of the bucket holding the p-th quantile (0 < p <= 1)
+    uint64_t percentile_us(double p) const {
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count) + 0.5);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= rank && seen > 0) {
+                uint64_t bound = i == 0 ? 0 : (uint64_t(1) << i) - 1;
+                return bound < max_us ? bound : max_us;
+            }
+        }
+        return max_us;
+    }
+};
+
 /**
  * @brief Timer class, supports one-time and periodic timers
+ *
+ * The default heap backend keeps the earliest deadline on top and marks
+ * cancelled timers for lazy removal. The wheel backend suits large numbers
+ * of short-lived timeouts that are mostly cancelled before they fire:
+ * timers are intrusive nodes recycled through a free list, so scheduling
+ * and cancelling neither allocate nor search, and the callback is moved
+ * in once instead of being copied on every fire.
  */
 class Timer {
 public:
@@ -38,6 +113,41 @@ public:
         return instance;
     }
 
+    /**
+     * @brief Create a timer with its own thread
+     * @param options Backend and, for the wheel, its tick length
+     */
+    explicit Timer(const TimerOptions& options)
+        : running_(true), next_timer_id_(1), options_(options), epoch_(Clock::now()),
+          tick_(std::chrono::duration_cast<Duration>(options.tick)) {
+        if (tick_.count() <= 0) {
+            throw std::invalid_argument("Timer tick must be positive");
+        }
+        start_timer_thread();
+    }
+
+    TimerBackend backend() const { return options_.backend; }
+
+    /// Lateness of the callbacks started since construction or the last reset
+    TimerLateness lateness() const {
+        TimerLateness result;
+        for (size_t i = 0; i < TimerLateness::BUCKETS; ++i) {
+            result.buckets[i] = lateness_->buckets[i].load(std::memory_order_relaxed);
+            result.count += result.buckets[i];
+        }
+        result.total_us = lateness_->total_us.load(std::memory_order_relaxed);
+        result.max_us = lateness_->max_us.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset_lateness() {
+        for (auto& bucket : lateness_->buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        lateness_->total_us.store(0, std::memory_order_relaxed);
+        lateness_->max_us.store(0, std::memory_order_relaxed);
+    }
+
     /**
      * @brief Create a one-time timer
      * @param delay Delay time (milliseconds)
@@ -61,6 +171,31 @@ public:
                           std::move(callback), interval_ms);
     }
 
+    /**
+     * @brief Awaitable that resumes the awaiting coroutine after a delay
+     *
+     * `co_await timer.sleep_for(ms)` resumes on the timer thread, so long
+     * work after it should hop to a ThreadPool with `co_await pool.schedule()`.
+     * A timer stopped before the delay expires never resumes the coroutine.
+     */
+    struct sleep_awaiter {
+        Timer* timer;
+        uint64_t delay_ms;
+
+        bool await_ready() const noexcept { return delay_ms == 0; }
+
+        template<class Handle>
+        void await_suspend(Handle handle) {
+            timer->schedule_once(delay_ms, [handle]() mutable { handle.resume(); });
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    sleep_awaiter sleep_for(uint64_t delay_ms) {
+        return sleep_awaiter{this, delay_ms};
+    }
+
     /**
      * @brief Cancel a timer
      * @param timer_id Timer ID
@@ -68,6 +203,9 @@ public:
      */
     bool cancel(TimerId timer_id) {
         std::lock_guard<std::mutex> lock(mutex_);
+        if (options_.backend == TimerBackend::wheel) {
+            return cancel_wheel_timer(timer_id);
+        }
         auto it = timers_.find(timer_id);
         if (it != timers_.end()) {
             // Mark as cancelled
@@ -92,6 +230,7 @@ public:
             while (!timer_queue_.empty()) {
                 timer_queue_.pop();
             }
+            clear_wheel_timers();
         }
         // Notify and wait for thread to complete
         cond_.notify_all();
@@ -139,11 +278,42 @@ private:
         }
     };
 
-    // Private constructor to ensure singleton pattern
-    Timer() : running_(true), next_timer_id_(1) {
-        // Start timer thread in a safer way
-        start_timer_thread();
-    }
+    // A timer on the wheel backend; its slot in wheel_nodes_ is reused
+    struct WheelTimer : TimingWheel::Node {
+        Callback callback;
+        uint64_t interval_ms = 0;
+        TimePoint deadline;
+        uint32_t index = 0;
+        uint32_t generation = 1;   // Part of the TimerId; bumped on release
+        bool active = false;       // Scheduled, due or firing
+        bool due = false;          // Waiting on due_
+        bool firing = false;
+        bool cancelled = false;
+    };
+
+    // Shared with dispatched tasks, which may outlive the Timer
+    struct LatenessRecorder {
+        std::atomic<uint64_t> buckets[TimerLateness::BUCKETS] = {};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> max_us{0};
+
+        void record(Duration late) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(late).count();
+            uint64_t value = us > 0 ? static_cast<uint64_t>(us) : 0;
+            size_t bucket = 0;
+            while (bucket + 1 < TimerLateness::BUCKETS && (value >> bucket) != 0) {
+                ++bucket;
+            }
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            total_us.fetch_add(value, std::memory_order_relaxed);
+            uint64_t seen = max_us.load(std::memory_order_relaxed);
+            while (value > seen && !max_us.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+            }
+        }
+    };
+
+    // Private constructor for the singleton, which uses the heap backend
+    Timer() : Timer(TimerOptions()) {}
 
     void start_timer_thread() {
         if (!timer_thread_.joinable()) {
@@ -158,6 +328,9 @@ private:
     // Schedule a task at a specific time point
     TimerId schedule_at(TimePoint time, Callback callback, uint64_t interval_ms) {
         std::lock_guard<std::mutex> lock(mutex_);
+        if (options_.backend == TimerBackend::wheel) {
+            return schedule_wheel_timer(time, std::move(callback), interval_ms);
+        }
         TimerId id = next_timer_id_++;
         
         TimerItem item{id, time, std::move(callback), interval_ms, false};
@@ -172,12 +345,218 @@ private:
         return id;
     }
 
+    // Wheel ticks are counted from epoch_
+    uint64_t tick_floor(TimePoint time) const {
+        return time <= epoch_ ? 0 : static_cast<uint64_t>((time - epoch_).count() / tick_.count());
+    }
+
+    uint64_t tick_ceil(TimePoint time) const {
+        return time <= epoch_ ? 0 : static_cast<uint64_t>(((time - epoch_).count() + tick_.count() - 1) / tick_.count());
+    }
+
+    // The wheel helpers below expect mutex_ to be held
+    TimerId schedule_wheel_timer(TimePoint time, Callback callback, uint64_t interval_ms) {
+        if (free_wheel_nodes_.empty()) {
+            free_wheel_nodes_.push_back(static_cast<uint32_t>(wheel_nodes_.size()));
+            wheel_nodes_.push_back(std::make_unique<WheelTimer>());
+            wheel_nodes_.back()->index = free_wheel_nodes_.back();
+        }
+        WheelTimer& node = *wheel_nodes_[free_wheel_nodes_.back()];
+        free_wheel_nodes_.pop_back();
+        node.callback = std::move(callback);
+        node.interval_ms = interval_ms;
+        node.deadline = time;
+        node.active = true;
+
+        if (wheel_.empty()) {
+            // Catch an idle wheel up so the new deadline lands in a low level
+            wheel_.advance(tick_floor(Clock::now()), [](TimingWheel::Node&) {});
+        }
+        wheel_.insert(node, tick_ceil(time));
+        if (node.expires < wake_tick_) {
+            cond_.notify_one();
+        }
+        return (static_cast<TimerId>(node.generation) << 32) | node.index;
+    }
+
+    bool cancel_wheel_timer(TimerId timer_id) {
+        uint32_t index = static_cast<uint32_t>(timer_id);
+        if (index >= wheel_nodes_.size()) {
+            return false;
+        }
+        WheelTimer& node = *wheel_nodes_[index];
+        if (!node.active || node.cancelled || node.generation != static_cast<uint32_t>(timer_id >> 32)) {
+            return false;
+        }
+        if (node.firing) {
+            // A one-shot timer is done once it fires; a periodic one is
+            // released by the timer thread when the callback returns
+            if (node.interval_ms == 0) {
+                return false;
+            }
+            node.cancelled = true;
+            return true;
+        }
+        if (node.due) {
+            due_.Remove(node);
+        } else {
+            wheel_.remove(node);
+        }
+        release_wheel_timer(node);
+        return true;
+    }
+
+    void release_wheel_timer(WheelTimer& node) {
+        node.callback = nullptr;
+        node.active = node.due = node.cancelled = false;
+        if (++node.generation == 0) {
+            node.generation = 1;
+        }
+        free_wheel_nodes_.push_back(node.index);
+    }
+
+    void clear_wheel_timers() {
+        wheel_.clear();
+        due_.Clear();
+        for (auto& node : wheel_nodes_) {
+            if (node->firing) {
+                node->cancelled = true;
+            } else if (node->active) {
+                release_wheel_timer(*node);
+            }
+        }
+    }
+
+    void wheel_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            wheel_.advance(tick_floor(Clock::now()), [this](TimingWheel::Node& expired) {
+                static_cast<WheelTimer&>(expired).due = true;
+                due_.PushBack(expired);
+            });
+
+            while (!due_.Empty() && running_) {
+                WheelTimer& node = static_cast<WheelTimer&>(due_.Front());
+                due_.Remove(node);
+                node.due = false;
+                TimePoint deadline = node.deadline;
+                TimePoint next_time = Clock::now() + std::chrono::milliseconds(node.interval_ms);
+
+                if (options_.executor) {
+                    // The task gets its own copy of a periodic callback
+                    if (node.interval_ms == 0) {
+                        batch_.push_back(dispatched(std::move(node.callback), deadline));
+                        release_wheel_timer(node);
+                    } else {
+                        batch_.push_back(dispatched(node.callback, deadline));
+                        node.deadline = next_time;
+                        wheel_.insert(node, tick_ceil(next_time));
+                    }
+                    continue;
+                }
+
+                node.firing = true;
+                lock.unlock();
+                lateness_->record(Clock::now() - deadline);
+                run_callback(node.callback);
+                lock.lock();
+
+                node.firing = false;
+                if (node.cancelled || node.interval_ms == 0 || !running_) {
+                    release_wheel_timer(node);
+                } else {
+                    node.deadline = next_time;
+                    wheel_.insert(node, tick_ceil(next_time));
+                }
+            }
+            if (!batch_.empty()) {
+                dispatch_batch(lock);
+                continue;
+            }
+            if (!running_) break;
+            if (!due_.Empty()) continue;
+
+            uint64_t next = wheel_.next_tick();
+            if (next <= tick_floor(Clock::now())) continue;
+            wake_tick_ = next;
+            if (next == TimingWheel::NO_TICK) {
+                cond_.wait(lock);
+            } else {
+                cond_.wait_until(lock, epoch_ + tick_ * next);
+            }
+            wake_tick_ = 0;
+        }
+    }
+
+    // Wraps an expired callback for the executor
+    thread::unique_task dispatched(Callback callback, TimePoint deadline) {
+        return thread::unique_task(
+            [callback = std::move(callback), deadline, lateness = lateness_]() mutable {
+                lateness->record(Clock::now() - deadline);
+                run_callback(callback);
+            });
+    }
+
+    // Hands batch_ to the executor with mutex_ released
+    void dispatch_batch(std::unique_lock<std::mutex>& lock) {
+        std::vector<thread::unique_task> batch;
+        batch.swap(batch_);
+        lock.unlock();
+        try {
+            options_.executor(batch);
+        } catch (...) {
+            // E.g. a stopped ThreadPool; fall back to this thread
+        }
+        for (auto& task : batch) {
+            if (task) {
+                task();
+            }
+        }
+        batch.clear();
+        lock.lock();
+        if (batch_.empty()) {
+            // Keep the capacity for the next pass
+            batch_.swap(batch);
+        }
+    }
+
+    // Runs a callback without letting its exceptions end the timer thread
+    static void run_callback(Callback& callback) {
+        try {
+            callback();
+        } catch (const std::exception& e) {
+            // Log callback exceptions but continue running
+            try {
+                printf("Timer callback exception: %s\n", e.what());
+                fflush(stdout);
+            } catch (...) {
+                // Ignore even logging failures
+            }
+        } catch (...) {
+            // Ignore unknown callback exceptions to prevent thread termination
+            try {
+                printf("Timer callback unknown exception\n");
+                fflush(stdout);
+            } catch (...) {
+                // Ignore even logging failures
+            }
+        }
+    }
+
     // Timer thread main loop
     void timer_loop() {
+        if (options_.backend == TimerBackend::wheel) {
+            wheel_loop();
+            return;
+        }
         std::unique_lock<std::mutex> lock(mutex_);
 
         while (running_) {
             if (timer_queue_.empty()) {
+                if (!batch_.empty()) {
+                    dispatch_batch(lock);
+                    continue;
+                }
                 // No timers, wait for condition variable notification
                 cond_.wait(lock, [this]() { return !running_ || !timer_queue_.empty(); });
                 if (!running_) break;  // Early exit if stopped
@@ -201,47 +580,44 @@ private:
             if (item.next_time > now) {
                 // Not yet time, put it back in the queue and wait
                 timer_queue_.push(item);
+                if (!batch_.empty()) {
+                    // Everything due in this pass has been collected
+                    dispatch_batch(lock);
+                    continue;
+                }
                 cond_.wait_until(lock, item.next_time, [this]() { return !running_; });
                 if (!running_) break;  // Early exit if stopped
                 continue;
             }
 
             // Save the callback function to be called after unlocking
-            auto callback = item.callback;
+            TimePoint deadline = item.next_time;
+            Callback callback;
 
             // If it's a periodic timer, reschedule
             if (item.interval_ms > 0) {
+                callback = item.callback;
                 item.next_time = now + std::chrono::milliseconds(item.interval_ms);
                 timer_queue_.push(item);
                 timers_[item.id] = item;
             } else {
                 // One-time timer, remove from the map
+                callback = std::move(item.callback);
                 timers_.erase(item.id);
             }
 
+            if (options_.executor) {
+                // Collect everything that is due, then dispatch it together
+                batch_.push_back(dispatched(std::move(callback), deadline));
+                continue;
+            }
+
             // Temporarily unlock to execute the callback, avoiding long-term lock holding
             lock.unlock();
-            try {
-                // Check if still running before executing callback
-                if (running_.load()) {
-                    callback();
-                }
-            } catch (const std::exception& e) {
-                // Log callback exceptions but continue running
-                try {
-                    printf("Timer callback exception: %s\n", e.what());
-                    fflush(stdout);
-                } catch (...) {
-                    // Ignore even logging failures
-                }
-            } catch (...) {
-                // Ignore unknown callback exceptions to prevent thread termination
-                try {
-                    printf("Timer callback unknown exception\n");
-                    fflush(stdout);
-                } catch (...) {
-                    // Ignore even logging failures
-                }
+            // Check if still running before executing callback
+            if (running_.load()) {
+                lateness_->record(Clock::now() - deadline);
+                run_callback(callback);
             }
             lock.lock();
         }
@@ -258,6 +634,21 @@ private:
     
     // Timer priority queue, sorted by trigger time
     std::priority_queue<TimerItem, std::vector<TimerItem>, std::greater<TimerItem>> timer_queue_;
+
+    TimerOptions options_;
+    TimePoint epoch_;
+    Duration tick_;
+
+    // Wheel backend state
+    TimingWheel wheel_;
+    std::vector<std::unique_ptr<WheelTimer>> wheel_nodes_;
+    std::vector<uint32_t> free_wheel_nodes_;
+    InstrusiveList<TimingWheel::Node> due_;
+    uint64_t wake_tick_ = 0;   // Tick the timer thread sleeps until, 0 while it runs
+
+    // Executor mode: callbacks collected in the current pass
+    std::vector<thread::unique_task> batch_;
+    std::shared_ptr<LatenessRecorder> lateness_ = std::make_shared<LatenessRecorder>();
 };
 
 /**
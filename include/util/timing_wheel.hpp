@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "instrusive_list.hpp"
+
+namespace SAK {
+namespace timer {
+
+/**
+ * @brief Hierarchical timing wheel over intrusive nodes
+ *
+ * Four levels of 256 slots cover 2^32 ticks ahead of the current tick;
+ * later deadlines park in the top level and are re-examined when it turns.
+ * insert() and remove() are O(1) and allocation-free, advance() costs one
+ * step per tick plus a cascade every 256 ticks, and stretches without
+ * level-0 work are skipped. Time is measured in ticks only; mapping them
+ * to a clock is up to the owner. Not thread-safe.
+ */
+class TimingWheel {
+public:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t NO_TICK = ~uint64_t(0);
+
+    // Embed (or derive from) this in the timer object
+    struct Node : InstrusiveListNode {
+        uint64_t expires = 0;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool linked = false;
+    };
+
+    explicit TimingWheel(uint64_t start_tick = 0) : current_(start_tick) {}
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    uint64_t current_tick() const { return current_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /// Queue `node` to expire at `tick`; past ticks expire on the next advance
+    void insert(Node& node, uint64_t tick) {
+        node.expires = tick > current_ ? tick : current_ + 1;
+        place(node);
+        ++size_;
+    }
+
+    void remove(Node& node) {
+        unlink(node);
+        --size_;
+    }
+
+    /**
+     * @brief Move time forward to `tick`, handing every expired node to
+     *        `on_expired(Node&)` after unlinking it
+     *
+     * Nodes expire in tick order. `on_expired` must not touch the wheel.
+     */
+    template<typename F>
+    void advance(uint64_t tick, F&& on_expired) {
+        while (current_ < tick) {
+            if (size_ == 0) {
+                current_ = tick;
+                return;
+            }
+            if (level_empty(0)) {
+                // Nothing due before level 0 wraps; jump to just before it
+                uint64_t last = current_ | (SLOTS - 1);
+                if (last >= tick) {
+                    current_ = tick;
+                    return;
+                }
+                current_ = last;
+            }
+            ++current_;
+            int index = static_cast<int>(current_ & (SLOTS - 1));
+            if (index == 0) {
+                cascade();
+            }
+            List& due = slots_[0][index];
+            while (!due.Empty()) {
+                Node& node = due.Front();
+                remove(node);
+                on_expired(node);
+            }
+        }
+    }
+
+    /**
+     * @brief The earliest tick at which advance() may have work: a level-0
+     *        expiry or the next cascade; NO_TICK when empty
+     */
+    uint64_t next_tick() const;
+
+    /// Drops every node without touching it; the caller owns their storage
+    void clear();
+
+private:
+    using List = InstrusiveList<Node>;
+
+    void place(Node& node);
+    void unlink(Node& node);
+    void cascade();
+    bool level_empty(int level) const {
+        const uint64_t* bits = occupied_[level];
+        return (bits[0] | bits[1] | bits[2] | bits[3]) == 0;
+    }
+
+    uint64_t current_;
+    size_t size_ = 0;
+    List slots_[LEVELS][SLOTS];
+    uint64_t occupied_[LEVELS][SLOTS / 64] = {};
+};
+
+} // namespace timer
+} // namespace SAK
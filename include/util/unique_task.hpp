@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SAK {
+namespace thread {
+
+/**
+ * @brief Move-only `void()` callable with inline storage
+ *
+ * Callables up to `inline_size` bytes that are nothrow move constructible
+ * are stored in place, so wrapping a small lambda allocates nothing. Larger
+ * callables fall back to a single heap allocation. Unlike std::function the
+ * callable does not need to be copyable, so it can own a packaged_task or a
+ * unique_ptr.
+ */
+class unique_task {
+public:
+    static constexpr std::size_t inline_size = 64;
+
+    unique_task() noexcept : ops_(nullptr) {}
+    unique_task(std::nullptr_t) noexcept : ops_(nullptr) {}
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same<Fn, unique_task>::value &&
+                                          std::is_invocable<Fn&>::value>>
+    unique_task(F&& f) : ops_(nullptr) {
+        if constexpr (stored_inline<Fn>()) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &inline_ops<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &heap_ops<Fn>;
+        }
+    }
+
+    unique_task(unique_task&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->relocate(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    unique_task& operator=(unique_task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->relocate(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    unique_task& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    unique_task(const unique_task&) = delete;
+    unique_task& operator=(const unique_task&) = delete;
+
+    ~unique_task() {
+        reset();
+    }
+
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    /// Whether the callable lives in the inline buffer (no heap allocation)
+    bool is_inline() const noexcept {
+        return ops_ && ops_->is_inline;
+    }
+
+private:
+    struct ops {
+        void (*invoke)(void* storage);
+        // Move-construct into `dst` and destroy the source
+        void (*relocate)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+        bool is_inline;
+    };
+
+    template <typename Fn>
+    static constexpr bool stored_inline() {
+        return sizeof(Fn) <= inline_size &&
+               alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Fn>::value;
+    }
+
+    template <typename Fn>
+    static constexpr ops inline_ops = {
+        [](void* storage) { (*std::launder(static_cast<Fn*>(storage)))(); },
+        [](void* dst, void* src) noexcept {
+            Fn* source = std::launder(static_cast<Fn*>(src));
+            ::new (dst) Fn(std::move(*source));
+            source->~Fn();
+        },
+        [](void* storage) noexcept { std::launder(static_cast<Fn*>(storage))->~Fn(); },
+        true
+    };
+
+    template <typename Fn>
+    static constexpr ops heap_ops = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) noexcept { ::new (dst) Fn*(*static_cast<Fn**>(src)); },
+        [](void* storage) noexcept { delete *static_cast<Fn**>(storage); },
+        false
+    };
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[inline_size];
+    const ops* ops_;
+};
+
+} // namespace thread
+} // namespace SAK
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace SAK {
+
+/**
+ * @brief A 32-bit atomic that threads can block on until its value changes
+ *
+ * A C++17 stand-in for std::atomic<T>::wait/notify. On Linux wait() and
+ * notify_*() are private futex calls on the value itself. Other platforms
+ * fall back to a mutex and condition variable owned by the object.
+ *
+ * wait() may return spuriously, so callers re-check their condition.
+ */
+template<typename T>
+class waitable_atomic {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "waitable_atomic requires an integral or enum type");
+    static_assert(sizeof(T) == sizeof(uint32_t), "waitable_atomic requires a 32-bit type");
+
+public:
+    constexpr waitable_atomic(T value = T()) noexcept : value_(value) {}
+
+    waitable_atomic(const waitable_atomic&) = delete;
+    waitable_atomic& operator=(const waitable_atomic&) = delete;
+
+    T load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        return value_.load(order);
+    }
+
+    void store(T value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        value_.store(value, order);
+    }
+
+    T exchange(T value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return value_.exchange(value, order);
+    }
+
+    T fetch_add(T delta, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return value_.fetch_add(delta, order);
+    }
+
+    bool compare_exchange_strong(T& expected, T desired,
+                                 std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return value_.compare_exchange_strong(expected, desired, order);
+    }
+
+    /// Blocks while the value equals `old`
+    void wait(T old, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+#if defined(__linux__)
+        while (value_.load(order) == old) {
+            syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, as_word(old), nullptr, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (value_.load(order) == old) {
+            condition_.wait(lock);
+        }
+#endif
+    }
+
+    void notify_one() noexcept {
+#if defined(__linux__)
+        syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_one();
+#endif
+    }
+
+    void notify_all() noexcept {
+#if defined(__linux__)
+        syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<T>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+
+    uint32_t* futex_word() const noexcept {
+        return reinterpret_cast<uint32_t*>(const_cast<std::atomic<T>*>(&value_));
+    }
+
+    static uint32_t as_word(T value) noexcept {
+        return static_cast<uint32_t>(value);
+    }
+#endif
+
+    std::atomic<T> value_;
+#if !defined(__linux__)
+    mutable std::mutex mutex_;
+    mutable std::condition_variable condition_;
+#endif
+};
+
+} // namespace SAK
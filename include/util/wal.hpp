@@ -0,0 +1,196 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "byte_buffer.hpp"
+#include "file_object.hpp"
+#include "options.hpp"
+
+namespace SAK {
+
+class MemTable;
+
+/**
+ * @brief One versioned write as logged; an empty value is a tombstone
+ */
+struct WalEntry {
+    ByteBuffer key;
+    uint64_t ts;
+    ByteBuffer value;
+};
+
+/**
+ * @brief On-disk framing shared by WalWriter and WalReader
+ *
+ * The log is a sequence of `block_size` blocks. A record is split into
+ * fragments that never straddle a block; each fragment carries a header of
+ * Crc32c (4 bytes, over type and data), data length (2) and type (1). Block
+ * tails too short for a header are zero-filled. A reader can therefore
+ * resynchronise at the next block after a damaged one, and a torn write at
+ * the end of the log only loses the record it belonged to.
+ */
+struct WalFormat {
+    enum Type : uint8_t {
+        kZero = 0,  // Padding
+        kFull = 1,
+        kFirst = 2,
+        kMiddle = 3,
+        kLast = 4,
+    };
+
+    static constexpr size_t kHeaderSize = 4 + 2 + 1;
+    static constexpr size_t kMaxBlockSize = kHeaderSize + 0xFFFF;
+
+    /// Options::block_size limited to what the 2-byte length can frame
+    static size_t BlockSize(const Options& options);
+
+    /// Payload of a batch: count, then key, timestamp and value of each entry
+    static void EncodeBatch(const WalEntry* entries, size_t count, std::vector<uint8_t>& out);
+    /// Replaces `out` with the entries of a batch; false if `data` is malformed
+    static bool DecodeBatch(const uint8_t* data, size_t size, std::vector<WalEntry>& out);
+};
+
+/**
+ * @brief Appends batches to a write-ahead log with group commit
+ *
+ * Any number of threads may call Write() at once. The first queued writer
+ * becomes the leader: it frames every batch queued behind it (up to
+ * kMaxGroupBytes) into one buffer, issues a single write and, depending on
+ * Options::wal_sync_policy, a single fdatasync, then wakes the writers it
+ * committed for. Batches are encoded by their own threads before queueing,
+ * so only framing and I/O are serialised.
+ *
+ * A failed write or sync leaves the writer broken: every later call
+ * returns false.
+ */
+class WalWriter {
+public:
+    /// Bytes of queued batches a leader takes into one group at most
+    static constexpr size_t kMaxGroupBytes = 1 << 20;
+
+    /**
+     * @brief Open `path` for appending, creating it if missing
+     *
+     * Appending to an existing log continues its last block, as the reader
+     * expects; check Valid() afterwards.
+     */
+    WalWriter(const std::string& path, const Options& options);
+    /// Syncs what was written unless the policy is WalSyncPolicy::None
+    ~WalWriter();
+
+    WalWriter(const WalWriter&) = delete;
+    WalWriter& operator=(const WalWriter&) = delete;
+
+    bool Valid() const noexcept;
+
+    /**
+     * @brief Log the entries as one atomically replayed record
+     *
+     * Returns once the record is written and, under WalSyncPolicy::Always,
+     * durable; false if the log is broken.
+     */
+    bool Write(const std::vector<WalEntry>& entries);
+    bool Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value);
+    bool Delete(const ByteBuffer& key, uint64_t ts) { return Put(key, ts, ByteBuffer()); }
+
+    /// Make everything written so far durable, whatever the policy
+    bool Sync();
+
+    /// Bytes in the file, framing and padding included
+    uint64_t FileSize() const;
+    /// Group commits performed, each one write (and at most one sync)
+    uint64_t GroupCount() const;
+    uint64_t SyncCount() const;
+
+private:
+    struct Waiter {
+        explicit Waiter(const std::vector<uint8_t>* payload) : payload(payload) {}
+
+        const std::vector<uint8_t>* payload;  // nullptr for a Sync() request
+        bool done = false;
+        bool ok = false;
+        std::condition_variable cv;
+    };
+
+    bool Commit(Waiter& waiter);
+    // Appends the fragments of one record to group_buffer_
+    void Frame(const uint8_t* data, size_t size);
+    bool WriteAll(const uint8_t* data, size_t size);
+    bool SyncFile();
+
+    const size_t block_size_;
+    const WalSyncPolicy sync_policy_;
+    const size_t sync_bytes_;
+    int fd_ = -1;
+    void* handle_ = nullptr;  // Windows HANDLE
+
+    mutable std::mutex mutex_;
+    std::deque<Waiter*> queue_;
+    bool broken_ = false;
+    uint64_t file_size_ = 0;
+    uint64_t groups_ = 0;
+    uint64_t syncs_ = 0;
+
+    // Touched only by the current leader
+    std::vector<uint8_t> group_buffer_;
+    size_t block_offset_ = 0;
+    uint64_t unsynced_bytes_ = 0;
+};
+
+/**
+ * @brief Reads the records of a write-ahead log in order
+ *
+ * The file is read through FileObject in runs of blocks, so replaying a
+ * log costs one read per run rather than one per record. Damaged
+ * fragments are skipped and counted; a record cut short at the end of the
+ * log, as a crash during a write leaves it, ends the log quietly.
+ */
+class WalReader {
+public:
+    /// Blocks fetched per FileObject::Read
+    static constexpr size_t kBlocksPerRead = 64;
+
+    WalReader(const std::string& path, const Options& options);
+
+    bool Valid() const noexcept { return file_.Valid(); }
+
+    /**
+     * @brief Next complete record
+     *
+     * @return false at the end of the log
+     */
+    bool ReadRecord(std::vector<uint8_t>& record);
+
+    /// Bytes skipped because of checksum or framing errors
+    uint64_t CorruptedBytes() const noexcept { return corrupted_bytes_; }
+
+    /**
+     * @brief Put every logged entry into `table`
+     *
+     * @param max_ts If set, raised to the largest timestamp replayed, to
+     *        resume the clock from
+     * @return Number of entries replayed
+     */
+    static size_t Replay(const std::string& path, const Options& options, MemTable& table,
+                         uint64_t* max_ts = nullptr);
+
+private:
+    // Next fragment, with its type; false at the end of the file
+    bool ReadFragment(uint8_t& type, const uint8_t*& data, size_t& size);
+    bool FillBuffer();
+
+    FileObject file_;
+    const size_t block_size_;
+    uint64_t file_offset_ = 0;   // Of the end of buffer_
+    std::vector<uint8_t> buffer_;
+    size_t buffer_pos_ = 0;
+    uint64_t corrupted_bytes_ = 0;
+};
+
+} // namespace SAK
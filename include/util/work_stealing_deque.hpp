@@ -3,32 +3,83 @@
 #include <atomic>
 #include <cstddef>
 #include <memory>
+#include <new>
 #include <optional>
+#include <type_traits>
 #include <utility>
-#include <vector>
+#include "memory_pool_v2.hpp"
 
 namespace SAK {
 namespace thread {
 
+namespace detail {
+
+// Only types std::atomic can hold without a lock are stored in the slots
+// themselves; std::atomic<U> must not be named for anything else
+template <typename U, bool = std::is_trivially_copyable<U>::value>
+struct stores_inline : std::false_type {};
+
+template <typename U>
+struct stores_inline<U, true>
+    : std::integral_constant<bool, std::atomic<U>::is_always_lock_free &&
+                                   std::is_default_constructible<U>::value> {};
+
+} // namespace detail
+
+/// Chase-Lev work-stealing deque. The owner thread pushes and pops at the
+/// bottom, any thread may steal from the top.
+///
+/// Small trivially copyable elements are stored directly in atomic slots.
+/// Other elements live in nodes allocated from MemoryPoolV2's thread caches
+/// and the slots hold plain atomic pointers to them. The ring buffer is
+/// reached through a raw atomic pointer; buffers replaced by grow() are
+/// retired and freed by the owner once no steal is in flight, so no
+/// operation touches a shared_ptr or takes a lock.
 template <typename T>
 class work_stealing_deque {
 public:
+    /// True when elements are held in the ring buffer without a node
+    static constexpr bool inline_slots = detail::stores_inline<T>::value;
+
     explicit work_stealing_deque(std::size_t initial_capacity = 32)
         : top_(0),
           bottom_(0),
-          buffer_(std::make_shared<buffer>(normalize_capacity(initial_capacity))) {}
+          buffer_(new buffer(normalize_capacity(initial_capacity))),
+          stealers_(0),
+          retired_(nullptr) {}
+
+    ~work_stealing_deque() {
+        buffer* current = buffer_.load(std::memory_order_relaxed);
+        if constexpr (!inline_slots) {
+            std::size_t top = top_.load(std::memory_order_relaxed);
+            std::size_t bottom = bottom_.load(std::memory_order_relaxed);
+            for (std::size_t index = top; index < bottom; ++index) {
+                T* item = current->slots[index & current->mask].load(std::memory_order_relaxed);
+                if (item) {
+                    destroy_node(item);
+                }
+            }
+        }
+        delete current;
+        free_retired();
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
 
     void push_bottom(T value) {
         std::size_t bottom = bottom_.load(std::memory_order_relaxed);
         std::size_t top = top_.load(std::memory_order_acquire);
-        std::shared_ptr<buffer> current = std::atomic_load_explicit(&buffer_, std::memory_order_acquire);
+        buffer* current = buffer_.load(std::memory_order_relaxed);
 
         if (bottom - top >= current->capacity - 1) {
             current = grow(current, top, bottom);
+        } else if (retired_) {
+            reclaim_retired();
         }
 
         const std::size_t index = bottom & current->mask;
-        std::atomic_store_explicit(&current->slots[index], std::make_shared<T>(std::move(value)), std::memory_order_relaxed);
+        current->slots[index].store(make_slot(std::move(value)), std::memory_order_relaxed);
         bottom_.store(bottom + 1, std::memory_order_release);
     }
 
@@ -47,9 +98,9 @@ public:
             return std::nullopt;
         }
 
-        std::shared_ptr<buffer> current = std::atomic_load_explicit(&buffer_, std::memory_order_acquire);
-        const std::size_t index = bottom & current->mask;
-        std::shared_ptr<T> item = std::atomic_load_explicit(&current->slots[index], std::memory_order_acquire);
+        // Only the owner replaces the buffer, so a relaxed load is current
+        buffer* current = buffer_.load(std::memory_order_relaxed);
+        slot_type item = current->slots[bottom & current->mask].load(std::memory_order_relaxed);
 
         if (top == bottom) {
             if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
@@ -59,11 +110,7 @@ public:
             bottom_.store(bottom + 1, std::memory_order_relaxed);
         }
 
-        std::atomic_store_explicit(&current->slots[index], std::shared_ptr<T>{}, std::memory_order_release);
-        if (!item) {
-            return std::nullopt;
-        }
-        return std::move(*item);
+        return take_slot(item);
     }
 
     std::optional<T> steal_top() {
@@ -74,39 +121,107 @@ public:
             return std::nullopt;
         }
 
-        std::shared_ptr<buffer> current = std::atomic_load_explicit(&buffer_, std::memory_order_acquire);
-        const std::size_t index = top & current->mask;
-        std::shared_ptr<T> item = std::atomic_load_explicit(&current->slots[index], std::memory_order_acquire);
+        // Announce the steal before reading buffer_ so the owner cannot free
+        // the buffer between that load and the slot read
+        stealers_.fetch_add(1, std::memory_order_seq_cst);
+        buffer* current = buffer_.load(std::memory_order_seq_cst);
+        slot_type item = current->slots[top & current->mask].load(std::memory_order_relaxed);
+        stealers_.fetch_sub(1, std::memory_order_release);
 
         if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
             return std::nullopt;
         }
 
-        std::atomic_store_explicit(&current->slots[index], std::shared_ptr<T>{}, std::memory_order_release);
-        if (!item) {
-            return std::nullopt;
-        }
-        return std::move(*item);
+        // A claimed slot is never rewritten before the owner grows past it
+        return take_slot(item);
     }
 
     bool empty() const {
         return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
     }
 
+    /// Owner thread only; the buffer may be replaced concurrently otherwise
     std::size_t capacity() const {
-        return std::atomic_load_explicit(&buffer_, std::memory_order_acquire)->capacity;
+        return buffer_.load(std::memory_order_relaxed)->capacity;
     }
 
 private:
+    using slot_type = std::conditional_t<inline_slots, T, T*>;
+
     struct buffer {
         explicit buffer(std::size_t size)
-            : capacity(size), mask(size - 1), slots(size) {}
+            : capacity(size), mask(size - 1), slots(new std::atomic<slot_type>[size]), next_retired(nullptr) {
+            if constexpr (!inline_slots) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    slots[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        }
 
         std::size_t capacity;
         std::size_t mask;
-        std::vector<std::shared_ptr<T>> slots;
+        std::unique_ptr<std::atomic<slot_type>[]> slots;
+        buffer* next_retired;
     };
 
+    static constexpr bool pool_aligned = alignof(T) <= alignof(std::max_align_t);
+
+    static slot_type make_slot(T&& value) {
+        if constexpr (inline_slots) {
+            return value;
+        } else {
+            return create_node(std::move(value));
+        }
+    }
+
+    static std::optional<T> take_slot(slot_type item) {
+        if constexpr (inline_slots) {
+            return item;
+        } else {
+            return take_node(item);
+        }
+    }
+
+    static T* create_node(T&& value) {
+        void* mem;
+        if constexpr (pool_aligned) {
+            mem = MemoryPoolV2::GetInstance().Allocate(sizeof(T));
+            if (!mem) {
+                throw std::bad_alloc();
+            }
+        } else {
+            mem = ::operator new(sizeof(T), std::align_val_t(alignof(T)));
+        }
+        try {
+            return ::new (mem) T(std::move(value));
+        } catch (...) {
+            release_memory(mem);
+            throw;
+        }
+    }
+
+    static void release_memory(void* mem) {
+        if constexpr (pool_aligned) {
+            MemoryPoolV2::GetInstance().Deallocate(mem, sizeof(T));
+        } else {
+            ::operator delete(mem, std::align_val_t(alignof(T)));
+        }
+    }
+
+    static void destroy_node(T* item) {
+        item->~T();
+        release_memory(item);
+    }
+
+    static std::optional<T> take_node(T* item) {
+        if (!item) {
+            return std::nullopt;
+        }
+        std::optional<T> result(std::move(*item));
+        destroy_node(item);
+        return result;
+    }
+
     static std::size_t normalize_capacity(std::size_t requested) {
         std::size_t capacity = requested < 2 ? 2 : requested;
         std::size_t normalized = 1;
@@ -116,27 +231,47 @@ private:
         return normalized;
     }
 
-    std::shared_ptr<buffer> grow(const std::shared_ptr<buffer>& current, std::size_t top, std::size_t bottom) {
+    buffer* grow(buffer* current, std::size_t top, std::size_t bottom) {
         std::size_t new_capacity = current->capacity * 2;
         while (bottom - top >= new_capacity - 1) {
             new_capacity *= 2;
         }
 
-        std::shared_ptr<buffer> expanded = std::make_shared<buffer>(new_capacity);
+        buffer* expanded = new buffer(new_capacity);
         for (std::size_t index = top; index < bottom; ++index) {
-            const std::size_t old_slot = index & current->mask;
-            const std::size_t new_slot = index & expanded->mask;
-            std::shared_ptr<T> item = std::atomic_load_explicit(&current->slots[old_slot], std::memory_order_acquire);
-            std::atomic_store_explicit(&expanded->slots[new_slot], item, std::memory_order_relaxed);
+            expanded->slots[index & expanded->mask].store(
+                current->slots[index & current->mask].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
         }
 
-        std::atomic_store_explicit(&buffer_, expanded, std::memory_order_release);
+        buffer_.store(expanded, std::memory_order_seq_cst);
+        current->next_retired = retired_;
+        retired_ = current;
+        reclaim_retired();
         return expanded;
     }
 
+    // A thief that registers after this check loads buffer_ after the
+    // seq_cst store in grow() and so can only see the current buffer
+    void reclaim_retired() {
+        if (stealers_.load(std::memory_order_seq_cst) == 0) {
+            free_retired();
+        }
+    }
+
+    void free_retired() {
+        while (retired_) {
+            buffer* next = retired_->next_retired;
+            delete retired_;
+            retired_ = next;
+        }
+    }
+
     std::atomic<std::size_t> top_;
     std::atomic<std::size_t> bottom_;
-    std::shared_ptr<buffer> buffer_;
+    std::atomic<buffer*> buffer_;
+    std::atomic<std::size_t> stealers_;
+    buffer* retired_;  // owner-only list of buffers replaced by grow()
 };
 
 } // namespace thread
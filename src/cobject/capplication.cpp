@@ -2,8 +2,13 @@
 #include "capplication.hpp"
 
 #include "event_dispatcher.hpp"
+#include "event_loop.hpp"
 #if defined(__linux__)
+#include "event_dispatcher_epoll.hpp"
+#include "event_dispatcher_uring.hpp"
+#if !defined(CODEKNIFE_NO_GLIB)
 #include "event_dispatcher_linux.hpp"
+#endif
 #elif defined(_WIN32)
 #include "event_dispatcher_win.hpp"
 #endif
@@ -22,24 +27,37 @@ const MetaObject CApplication::staticMetaObject = {
     {}
 };
 
-CApplication::CApplication(CObject* parent) 
+CApplication::CApplication(CObject* parent, EventDispatcherBackend backend)
     : CObject(parent),
       dispatcher_(nullptr),
-      quitFlag_(false),
-      returnCode_(0) {
+      loop_(nullptr) {
     if (instance_) {
         // Warning: multiple CApplication instances
     }
     instance_ = this;
     
 #if defined(__linux__)
-    dispatcher_ = new EventDispatcherLinux(this);
+    if (backend == EventDispatcherBackend::IoUring) {
+        dispatcher_ = new EventDispatcherUring(this);
+    } else if (backend == EventDispatcherBackend::Epoll) {
+        dispatcher_ = new EventDispatcherEpoll(this);
+    } else {
+#if defined(CODEKNIFE_NO_GLIB)
+        dispatcher_ = new EventDispatcherEpoll(this);
+#else
+        dispatcher_ = new EventDispatcherLinux(this);
+#endif
+    }
 #elif defined(_WIN32)
+    (void)backend;
     dispatcher_ = new EventDispatcherWin(this);
 #endif
+    loop_ = new EventLoop(dispatcher_);
 }
 
 CApplication::~CApplication() {
+    delete loop_;
+    loop_ = nullptr;
     if (dispatcher_) {
         delete dispatcher_;
         dispatcher_ = nullptr;
@@ -54,27 +72,16 @@ CApplication* CApplication::instance() {
 }
 
 int CApplication::exec() {
-    if (!dispatcher_) {
-        return -1;
-    }
-    quitFlag_ = false;
-    returnCode_ = 0;
-    
-    while(!quitFlag_) {
-        dispatcher_->processEvents();
-        processPostedEvents();
-    }
-    
-    return returnCode_;
+    // Runs the posted events of the calling thread
+    return loop_->exec();
 }
 
 void CApplication::quit() {
-    quitFlag_ = true;
+    loop_->quit();
 }
 
 void CApplication::exit(int returnCode) {
-    quitFlag_ = true;
-    returnCode_ = returnCode;
+    loop_->exit(returnCode);
 }
 
 void CApplication::setEventDispatcher(EventDispatcher* dispatcher) {
@@ -82,6 +89,7 @@ void CApplication::setEventDispatcher(EventDispatcher* dispatcher) {
         delete dispatcher_;
     }
     dispatcher_ = dispatcher;
+    loop_->setDispatcher(dispatcher);
 }
 
 bool CApplication::sendEvent(CObject* receiver, Event *event) {
@@ -89,60 +97,43 @@ bool CApplication::sendEvent(CObject* receiver, Event *event) {
 }
 
 void CApplication::postEvent(CObject* receiver, Event* event) {
-    if (!instance_ || !receiver || !event) {
-        delete event;
-        return;
-    }
-    
-    std::lock_guard<std::mutex> lock(instance_->eventQueueMutex_);
-    instance_->eventQueue_.push_back({receiver, event, 0});
-    
-    if (instance_->dispatcher_) {
-        instance_->dispatcher_->wakeUp();
-    }
+    ThreadData::postEvent(receiver, event);
 }
 
 void CApplication::removePostedEvents(CObject* receiver, Event::Type eventType) {
-    if (!instance_) {
-        return;
-    }
-    
-    std::lock_guard<std::mutex> lock(instance_->eventQueueMutex_);
-    auto& queue = instance_->eventQueue_;
-    
-    queue.erase(
-        std::remove_if(queue.begin(), queue.end(),
-            [receiver, eventType](const PostedEvent& pe) {
-                bool match = (receiver == nullptr || pe.receiver == receiver) &&
-                             (eventType == Event::Type::None || pe.event->type() == eventType);
-                if (match) {
-                    delete pe.event;
-                }
-                return match;
-            }),
-        queue.end()
-    );
+    ThreadData::removePostedEvents(receiver, eventType);
 }
 
-void CApplication::processPostedEvents() {
-    if (!instance_) {
+void CApplication::postCallback(std::function<void()> callback) {
+    if (!instance_ || !callback) {
         return;
     }
-    
-    std::vector<PostedEvent> events;
-    {
-        std::lock_guard<std::mutex> lock(instance_->eventQueueMutex_);
-        events.swap(instance_->eventQueue_);
+
+    auto* call = new MetaCallEvent(std::move(callback));
+    epoch_guard guard = ThreadData::pin();
+    if (ThreadData* running = instance_->loop_->threadData()) {
+        running->postCall(call);
+    } else {
+        // CObject::event() runs it once the application's thread gets to it
+        ThreadData::postEvent(instance_, call);
     }
-    
-    for (auto& pe : events) {
-        if (pe.receiver) {
-            CObject::sendEvent(pe.receiver, pe.event);
+}
+
+std::function<void(std::vector<thread::unique_task>&)> CApplication::timerExecutor() {
+    return [](std::vector<thread::unique_task>& batch) {
+        if (!instance_) {
+            // Leave the batch to the timer thread
+            return;
         }
-        // Always delete the event after processing
-        // Note: For DeferredDelete events, the receiver deletes itself but the event still needs cleanup
-        delete pe.event;
-    }
+        // std::function needs a copyable callable
+        auto tasks = std::make_shared<std::vector<thread::unique_task>>(std::move(batch));
+        batch.clear();
+        postCallback([tasks]() {
+            for (auto& task : *tasks) {
+                task();
+            }
+        });
+    };
 }
 
 } // namespace SAK
@@ -4,10 +4,14 @@
 #include "event.hpp"
 #include "capplication.hpp"
 #include "event_dispatcher.hpp"
+#include "event_loop.hpp"
+#include "memory_pool_v2.hpp"
+#include "pool_allocator.hpp"
 #include <algorithm>
 #include <iostream>
 #include <future>
 #include <atomic>
+#include <new>
 
 namespace SAK {
 
@@ -20,13 +24,15 @@ const MetaObject CObject::staticMetaObject(
     {}
 );
 
-CObject::CObject(CObject* parent) : parent_(nullptr) {
+CObject::CObject(CObject* parent) : parent_(nullptr), thread_data_(ThreadData::current()) {
+    thread_data_.load(std::memory_order_relaxed)->ref();
     setParent(parent);
 }
 
 CObject::~CObject() {
     // Disconnect all signal-slot connections involving this object
     ConnectionManager::instance().disconnectAll(this);
+    ThreadData::removePostedEvents(this);
     
     // Remove from parent
     setParent(nullptr);
@@ -37,6 +43,22 @@ CObject::~CObject() {
         children_.pop_back(); // Remove from list first
         delete child; // Then delete - child's destructor will call setParent(nullptr)
     }
+    thread_data_.load(std::memory_order_relaxed)->deref();
+}
+
+void* CObject::allocatePooled(std::size_t size) {
+    void* object = MemoryPoolV2::GetInstance().Allocate(size);
+    if (!object) {
+        throw std::bad_alloc();
+    }
+    return object;
+}
+
+void CObject::freePooled(void* object, std::size_t size) noexcept {
+    if (object) {
+        // Saves the unsized overload its extra usable-size lookup
+        MemoryPoolV2::GetInstance().Deallocate(object, size);
+    }
 }
 
 void CObject::setParent(CObject* parent) {
@@ -58,6 +80,31 @@ void CObject::removeChild(CObject* child) {
     }
 }
 
+bool CObject::moveToThread(std::thread::id thread) {
+    if (parent_) {
+        std::cerr << "CObject::moveToThread: Cannot move objects with a parent" << std::endl;
+        return false;
+    }
+    if (this->thread() != std::this_thread::get_id()) {
+        std::cerr << "CObject::moveToThread: Only the object's own thread can move it" << std::endl;
+        return false;
+    }
+    if (thread == this->thread()) {
+        return true;
+    }
+    ThreadData* target = ThreadData::get(thread);
+    setThreadData(target);
+    target->deref();
+    return true;
+}
+
+void CObject::setThreadData(ThreadData* data) {
+    ThreadData::moveObject(this, data);
+    for (CObject* child : children_) {
+        child->setThreadData(data);
+    }
+}
+
 bool CObject::setProperty(const std::string& name, const std::any& value) {
     const MetaProperty* prop = metaObject()->findProperty(name);
     if (prop) {
@@ -105,63 +152,74 @@ bool CObject::disconnect(const CObject* sender, const char* signal, const CObjec
     return ConnectionManager::instance().disconnect(sender, signal, receiver, slot);
 }
 
+bool CObject::connectThunk(const CObject* sender, int signal, const CObject* receiver,
+                           std::shared_ptr<const SlotThunk> thunk, ConnectionType type) {
+    return ConnectionManager::instance().connect(sender, signal, receiver, std::move(thunk), type);
+}
+
+bool CObject::disconnectThunk(const CObject* sender, int signal, const CObject* receiver,
+                              const SlotThunk& thunk) {
+    return ConnectionManager::instance().disconnect(sender, signal, receiver, thunk);
+}
+
 void CObject::emitSignal(const char* signal, const std::vector<std::any>& args) {
     ConnectionManager::instance().emitSignal(this, signal, args);
 }
 
+CObject::CallMode CObject::callMode(ConnectionType type) const {
+    // Direct only when the emission runs in the receiver's thread, whatever
+    // thread the sender lives in
+    bool sameThread = (std::this_thread::get_id() == thread());
+    
+    switch (type) {
+    case ConnectionType::kAutoConnection:
+        // AutoConnection: choose based on thread affinity
+        return sameThread ? CallMode::Direct : CallMode::Queued;
+    case ConnectionType::kQueuedConnection:
+        return CallMode::Queued;
+    case ConnectionType::kBlockingConnection:
+        // Blocking in same thread would cause deadlock - use direct call
+        return sameThread ? CallMode::Direct : CallMode::Blocking;
+    default:
+        return CallMode::Direct;
+    }
+}
+
+void CObject::postCall(MetaCallEvent* event, CallMode mode) {
+    if (mode != CallMode::Blocking) {
+        // Async call via the queue of the receiver's thread
+        ThreadData::postEvent(this, event);
+        return;
+    }
+    
+    // Blocking call: post event and wait for completion
+    auto promise = std::allocate_shared<std::promise<void>>(PoolAllocator<std::promise<void>>());
+    auto future = promise->get_future();
+    event->setPromise(promise);
+    ThreadData::postEvent(this, event);
+    
+    // Wait for slot to complete
+    future.wait();
+}
+
 void CObject::metacall(const char* slot, const std::vector<std::any>& args, 
                        ConnectionType type, const CObject* sender) {
     if (!slot || !sender) return;
-    
-    // Check if sender and receiver are in the same thread
-    bool sameThread = (sender->thread() == this->thread_id_);
-    ConnectionType effectiveType = type;
-    
-    // AutoConnection: choose based on thread affinity
-    if (effectiveType == ConnectionType::kAutoConnection) {
-        effectiveType = sameThread ? ConnectionType::kDirectConnection : ConnectionType::kQueuedConnection;
-    }
+    metacall(metaObject()->findMethod(slot), args, type, sender);
+}
+
+void CObject::metacall(const MetaMethod* method, const std::vector<std::any>& args,
+                       ConnectionType type, const CObject* sender) {
+    if (!method || !sender) return;
+    const char* slot = method->name();
     
     try {
-        const MetaMethod* method = metaObject()->findMethod(slot);
-        if (!method) {
-            return;
-        }
-        
-        switch (effectiveType) {
-        case ConnectionType::kDirectConnection:
+        CallMode mode = callMode(type);
+        if (mode == CallMode::Direct) {
             // Direct call in sender's thread
             method->invoke(this, args);
-            break;
-            
-        case ConnectionType::kQueuedConnection: {
-            // Async call via event queue
-            auto* event = new MetaCallEvent(slot, args);
-            CApplication::postEvent(this, event);
-            break;
-        }
-        
-        case ConnectionType::kBlockingConnection: {
-            if (sameThread) {
-                // Blocking in same thread would cause deadlock - use direct call
-                method->invoke(this, args);
-            } else {
-                // Blocking call: post event and wait for completion
-                auto promise = std::make_shared<std::promise<void>>();
-                auto future = promise->get_future();
-                
-                auto* event = new MetaCallEvent(slot, args);
-                event->setPromise(promise);
-                CApplication::postEvent(this, event);
-                
-                // Wait for slot to complete
-                future.wait();
-            }
-            break;
-        }
-        
-        default:
-            break;
+        } else {
+            postCall(new MetaCallEvent(slot, args), mode);
         }
     } catch (const std::exception& e) {
         std::cerr << "Error invoking slot " << slot << ": " << e.what() << std::endl;
@@ -170,6 +228,41 @@ void CObject::metacall(const char* slot, const std::vector<std::any>& args,
     }
 }
 
+void CObject::metacall(const SlotThunk& thunk, const void* args,
+                       ConnectionType type, const CObject* sender) {
+    if (!sender) return;
+    try {
+        CallMode mode = callMode(type);
+        if (mode == CallMode::Direct) {
+            thunk.invoke(this, args);
+        } else {
+            postCall(new MetaCallEvent(thunk.bind(this, args)), mode);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error invoking typed slot: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown error invoking typed slot" << std::endl;
+    }
+}
+
+void CObject::metacall(const std::shared_ptr<const SlotThunk>& thunk, const std::vector<std::any>& args,
+                       ConnectionType type, const CObject* sender) {
+    if (!sender) return;
+    try {
+        CallMode mode = callMode(type);
+        if (mode == CallMode::Direct) {
+            thunk->invokeAny(this, args);
+        } else {
+            // The connection may be gone by the time the event runs
+            postCall(new MetaCallEvent([thunk, receiver = this, args]() { thunk->invokeAny(receiver, args); }), mode);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error invoking typed slot: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown error invoking typed slot" << std::endl;
+    }
+}
+
 void CObject::deleteLater() {
     auto* event = new Event(Event::Type::DeferredDelete);
     CApplication::postEvent(this, event);
@@ -181,14 +274,7 @@ int CObject::startTimer(int64_t interval) {
         return 0;
     }
     
-    // Get the event dispatcher from the application
-    CApplication* app = CApplication::instance();
-    if (!app) {
-        std::cerr << "CObject::startTimer: No application instance" << std::endl;
-        return 0;
-    }
-    
-    EventDispatcher* dispatcher = app->eventDispatcher();
+    EventDispatcher* dispatcher = eventDispatcher();
     if (!dispatcher) {
         std::cerr << "CObject::startTimer: No event dispatcher" << std::endl;
         return 0;
@@ -209,13 +295,7 @@ void CObject::killTimer(int timerId) {
         return;
     }
     
-    // Get the event dispatcher from the application
-    CApplication* app = CApplication::instance();
-    if (!app) {
-        return;
-    }
-    
-    EventDispatcher* dispatcher = app->eventDispatcher();
+    EventDispatcher* dispatcher = eventDispatcher();
     if (!dispatcher) {
         return;
     }
@@ -225,13 +305,7 @@ void CObject::killTimer(int timerId) {
 }
 
 bool CObject::unregisterTimers() {
-    // Get the event dispatcher from the application
-    CApplication* app = CApplication::instance();
-    if (!app) {
-        return false;
-    }
-    
-    EventDispatcher* dispatcher = app->eventDispatcher();
+    EventDispatcher* dispatcher = eventDispatcher();
     if (!dispatcher) {
         return false;
     }
@@ -240,6 +314,16 @@ bool CObject::unregisterTimers() {
     return dispatcher->unregisterTimers(this);
 }
 
+EventDispatcher* CObject::eventDispatcher() const {
+    // Timers go to the loop running in the object's thread, if any
+    EventDispatcher* dispatcher = thread_data_.load(std::memory_order_acquire)->dispatcher();
+    if (dispatcher) {
+        return dispatcher;
+    }
+    CApplication* app = CApplication::instance();
+    return app ? app->eventDispatcher() : nullptr;
+}
+
 bool CObject::event(Event* event) {
     if (!event) return false;
     
@@ -247,10 +331,14 @@ bool CObject::event(Event* event) {
     case Event::Type::MetaCall: {
         // Handle cross-thread slot invocation
         MetaCallEvent* mce = static_cast<MetaCallEvent*>(event);
-        const MetaMethod* method = metaObject()->findMethod(mce->slot());
-        if (method) {
+        const MetaMethod* method = mce->call() ? nullptr : metaObject()->findMethod(mce->slot());
+        if (mce->call() || method) {
             try {
-                method->invoke(this, mce->args());
+                if (mce->call()) {
+                    mce->call()();
+                } else {
+                    method->invoke(this, mce->args());
+                }
                 
                 // If this is a blocking call, notify the sender thread
                 if (mce->promise()) {
@@ -4,9 +4,20 @@
 #include "meta_object.hpp"
 #include <algorithm>
 #include <iostream>
+#include <optional>
 
 namespace SAK {
 
+namespace {
+
+// Heterogeneous comparator for searching a ConnectionList by signal id
+struct BySignal {
+    bool operator()(const Connection& conn, int signal) const { return conn.signal < signal; }
+    bool operator()(int signal, const Connection& conn) const { return signal < conn.signal; }
+};
+
+} // namespace
+
 ConnectionManager& ConnectionManager::instance() {
     static ConnectionManager instance;
     return instance;
@@ -32,24 +43,39 @@ bool ConnectionManager::connect(const CObject* sender, const char* signal,
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
+    return addConnection({sender, metaSignal->id(), receiver, metaSlot, type, true, nullptr});
+}
+
+bool ConnectionManager::connect(const CObject* sender, int signal, const CObject* receiver,
+                                std::shared_ptr<const SlotThunk> thunk, ConnectionType type) {
+    if (!sender || !receiver || !thunk) {
+        return false;
+    }
     
-    Connection conn = {sender, signal, receiver, slot, type, true};
+    // Typed and by-name emission share the signal's registration
+    if (!sender->metaObject()->findSignal(signal)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    return addConnection({sender, signal, receiver, nullptr, type, true, std::move(thunk)});
+}
+
+bool ConnectionManager::addConnection(Connection conn) {
+    const CObject* sender = conn.sender;
+    const CObject* receiver = conn.receiver;
+    
+    // Keep the list sorted by signal id, in connection order within a signal
+    std::vector<Connection> connections = connectionsOf(sender);
+    auto range = std::equal_range(connections.begin(), connections.end(), conn.signal, BySignal());
     
     // Check if connection already exists
-    auto it = connections_.find(sender);
-    if (it != connections_.end()) {
-        auto& connList = it->second;
-        auto existingConn = std::find_if(connList.begin(), connList.end(),
-            [&conn](const Connection& existing) {
-                return existing == conn;
-            });
-        if (existingConn != connList.end()) {
-            return false; // Connection already exists
-        }
-        connList.push_back(conn);
-    } else {
-        connections_[sender] = {conn};
+    if (std::find(range.first, range.second, conn) != range.second) {
+        return false; // Connection already exists
     }
+    connections.insert(range.second, std::move(conn));
+    publish(sender, std::move(connections));
+    ++senders_[receiver][sender];
     
     return true;
 }
@@ -58,35 +84,59 @@ bool ConnectionManager::disconnect(const CObject* sender, const char* signal,
                                   const CObject* receiver, const char* slot) {
     if (!sender) return false;
     
+    // A name that was never interned cannot be connected
+    int signalId = signal ? MetaNames::find(signal) : MetaNames::kInvalid;
+    int slotId = slot ? MetaNames::find(slot) : MetaNames::kInvalid;
+    if ((signal && signalId == MetaNames::kInvalid) || (slot && slotId == MetaNames::kInvalid)) {
+        return false;
+    }
+    
     std::lock_guard<std::mutex> lock(mutex_);
     
-    auto it = connections_.find(sender);
-    if (it == connections_.end()) {
+    std::vector<Connection> connections = connectionsOf(sender);
+    
+    // Remove all matching connections (not just the first one)
+    auto kept = std::stable_partition(connections.begin(), connections.end(),
+        [signal, signalId, receiver, slot, slotId](const Connection& conn) {
+            bool signalMatch = !signal || conn.signal == signalId;
+            bool receiverMatch = !receiver || conn.receiver == receiver;
+            bool slotMatch = !slot || (conn.slot && conn.slot->id() == slotId);
+            return !(signalMatch && receiverMatch && slotMatch);
+        });
+    if (kept == connections.end()) {
         return false;
     }
     
-    auto& connList = it->second;
+    for (auto it = kept; it != connections.end(); ++it) {
+        forgetReceiver(sender, it->receiver);
+    }
+    connections.erase(kept, connections.end());
+    publish(sender, std::move(connections));
     
-    // Remove all matching connections (not just the first one)
-    auto originalSize = connList.size();
-    connList.erase(
-        std::remove_if(connList.begin(), connList.end(),
-            [signal, receiver, slot](const Connection& conn) {
-                bool signalMatch = !signal || conn.signal == signal;
-                bool receiverMatch = !receiver || conn.receiver == receiver;
-                bool slotMatch = !slot || conn.slot == slot;
-                return signalMatch && receiverMatch && slotMatch;
-            }),
-        connList.end()
-    );
+    return true;
+}
+
+bool ConnectionManager::disconnect(const CObject* sender, int signal, const CObject* receiver,
+                                   const SlotThunk& thunk) {
+    if (!sender) return false;
     
-    bool removed = (connList.size() < originalSize);
+    std::lock_guard<std::mutex> lock(mutex_);
     
-    if (connList.empty()) {
-        connections_.erase(it);
+    std::vector<Connection> connections = connectionsOf(sender);
+    auto match = std::find_if(connections.begin(), connections.end(),
+        [signal, receiver, &thunk](const Connection& conn) {
+            return conn.signal == signal && conn.receiver == receiver &&
+                   conn.thunk && conn.thunk->equals(thunk);
+        });
+    if (match == connections.end()) {
+        return false;
     }
     
-    return removed;
+    forgetReceiver(sender, receiver);
+    connections.erase(match);
+    publish(sender, std::move(connections));
+    
+    return true;
 }
 
 void ConnectionManager::disconnectAll(const CObject* obj) {
@@ -95,26 +145,27 @@ void ConnectionManager::disconnectAll(const CObject* obj) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // Remove all connections where obj is sender
-    connections_.erase(obj);
+    for (const Connection& conn : connectionsOf(obj)) {
+        forgetReceiver(obj, conn.receiver);
+    }
+    publish(obj, {});
     
     // Remove all connections where obj is receiver
-    for (auto& [sender, connList] : connections_) {
-        connList.erase(
-            std::remove_if(connList.begin(), connList.end(),
+    auto it = senders_.find(obj);
+    if (it == senders_.end()) {
+        return;
+    }
+    auto senders = std::move(it->second);
+    senders_.erase(it);
+    for (const auto& [sender, count] : senders) {
+        std::vector<Connection> connections = connectionsOf(sender);
+        connections.erase(
+            std::remove_if(connections.begin(), connections.end(),
                 [obj](const Connection& conn) {
                     return conn.receiver == obj;
                 }),
-            connList.end());
-    }
-    
-    // Remove empty connection lists
-    auto it = connections_.begin();
-    while (it != connections_.end()) {
-        if (it->second.empty()) {
-            it = connections_.erase(it);
-        } else {
-            ++it;
-        }
+            connections.end());
+        publish(sender, std::move(connections));
     }
 }
 
@@ -122,45 +173,105 @@ void ConnectionManager::emitSignal(const CObject* sender, const char* signal,
                                   const std::vector<std::any>& args) {
     if (!sender || !signal) return;
     
-    std::vector<Connection> activeConnections;
+    const MetaSignal* metaSignal = sender->metaObject()->findSignal(signal);
+    if (!metaSignal) {
+        return;
+    }
     
-    // Find all active connections for this signal
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        activeConnections = findConnections(sender, signal);
+    // The list read here stays alive until the guard is released, even if
+    // a slot disconnects or destroys the sender
+    epoch_guard guard = epoch_.pin();
+    const ConnectionList* list = sender->connections_.load(std::memory_order_acquire);
+    if (!list) {
+        return;
     }
     
     // Invoke slots for each connection
-    for (const auto& conn : activeConnections) {
-        if (conn.enabled) {
-            invokeSlot(conn, args);
+    auto range = std::equal_range(list->connections.begin(), list->connections.end(),
+                                  metaSignal->id(), BySignal());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->enabled) {
+            invokeSlot(*it, args);
         }
     }
 }
 
-std::vector<Connection> ConnectionManager::findConnections(const CObject* sender, 
-                                                          const char* signal) const {
-    std::vector<Connection> result;
+void ConnectionManager::emitSignal(const CObject* sender, int signal, const void* args,
+                                   const std::type_info& signature, detail::BoxArgs box) {
+    if (!sender) return;
     
-    auto it = connections_.find(sender);
-    if (it == connections_.end()) {
-        return result;
+    epoch_guard guard = epoch_.pin();
+    const ConnectionList* list = sender->connections_.load(std::memory_order_acquire);
+    if (!list) {
+        return;
     }
     
-    const auto& connList = it->second;
-    std::copy_if(connList.begin(), connList.end(), std::back_inserter(result),
-        [signal](const Connection& conn) {
-            return conn.signal == signal && conn.enabled;
-        });
-    
-    return result;
+    // Boxed at most once, and only for slots connected by name
+    std::optional<std::vector<std::any>> boxed;
+    auto range = std::equal_range(list->connections.begin(), list->connections.end(), signal, BySignal());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (!it->enabled) {
+            continue;
+        }
+        CObject* receiver = const_cast<CObject*>(it->receiver);
+        if (it->thunk && it->thunk->signature() == signature) {
+            receiver->metacall(*it->thunk, args, it->type, sender);
+            continue;
+        }
+        if (!boxed) {
+            boxed = box(args);
+        }
+        invokeSlot(*it, *boxed);
+    }
+}
+
+std::vector<Connection> ConnectionManager::connectionsOf(const CObject* sender) const {
+    // Writers hold mutex_, so the list cannot be retired under us
+    const ConnectionList* list = sender->connections_.load(std::memory_order_acquire);
+    return list ? list->connections : std::vector<Connection>();
+}
+
+void ConnectionManager::publish(const CObject* sender, std::vector<Connection> connections) {
+    const ConnectionList* next = connections.empty() ? nullptr : new ConnectionList{std::move(connections)};
+    const ConnectionList* old = sender->connections_.exchange(next, std::memory_order_acq_rel);
+    if (old) {
+        epoch_.retire(old);
+    }
+}
+
+void ConnectionManager::forgetReceiver(const CObject* sender, const CObject* receiver) {
+    auto it = senders_.find(receiver);
+    if (it == senders_.end()) {
+        return;
+    }
+    auto entry = it->second.find(sender);
+    if (entry != it->second.end() && --entry->second == 0) {
+        it->second.erase(entry);
+        if (it->second.empty()) {
+            senders_.erase(it);
+        }
+    }
 }
 
 void ConnectionManager::invokeSlot(const Connection& conn, const std::vector<std::any>& args) {
     // Delegate to CObject::metacall() - following Qt's design pattern
     // where QMetaObject::activate() handles the actual slot invocation logic
-    const_cast<CObject*>(conn.receiver)->metacall(conn.slot.c_str(), args, conn.type, conn.sender);
+    CObject* receiver = const_cast<CObject*>(conn.receiver);
+    if (conn.thunk) {
+        receiver->metacall(conn.thunk, args, conn.type, conn.sender);
+    } else {
+        receiver->metacall(conn.slot, args, conn.type, conn.sender);
+    }
 }
 
+namespace detail {
+
+void activate(const CObject* sender, int signal, const void* args,
+              const std::type_info& signature, BoxArgs box) {
+    ConnectionManager::instance().emitSignal(sender, signal, args, signature, box);
+}
+
+} // namespace detail
+
 } // namespace SAK
 
@@ -0,0 +1,332 @@
+#include "event_dispatcher_epoll.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include "event.hpp"
+#include "cobject.hpp"
+
+namespace SAK {
+
+AUTO_REGISTER_META_OBJECT(EventDispatcherEpoll, EventDispatcher)
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+
+// CLOCK_MONOTONIC, which the timerfd runs on, in milliseconds
+int64_t currentTime() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void drain(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == sizeof(value)) {
+    }
+}
+
+} // namespace
+
+EventDispatcherEpoll::EventDispatcherEpoll(CObject* parent)
+    : EventDispatcherEpoll(Trigger::Level, parent)
+{
+}
+
+EventDispatcherEpoll::EventDispatcherEpoll(Trigger trigger, CObject* parent)
+    : EventDispatcher(parent)
+    , trigger_(trigger)
+{
+    startingUp();
+}
+
+EventDispatcherEpoll::~EventDispatcherEpoll()
+{
+    shuttingDown();
+}
+
+void EventDispatcherEpoll::startingUp()
+{
+    if (epollFd_ >= 0) return;
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0 || timerFd_ < 0) {
+        std::cerr << "EventDispatcherEpoll: " << std::strerror(errno) << std::endl;
+        shuttingDown();
+        return;
+    }
+    // Both are drained on every wake-up, so level-triggered always
+    for (int fd : {wakeFd_, timerFd_}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+    // Start woken, as EventDispatcherLinux does: events posted before the
+    // first processEvents() must not wait for another wake-up
+    wakeUp();
+}
+
+void EventDispatcherEpoll::shuttingDown()
+{
+    for (int* fd : {&timerFd_, &wakeFd_, &epollFd_}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    armedDeadline_ = -1;
+    internalFds_.clear();
+    timers_.clear();
+    deadlines_.clear();
+    sockets_.clear();
+}
+
+bool EventDispatcherEpoll::processEvents()
+{
+    if (epollFd_ < 0) return false;
+    aboutToWait();
+    epoll_event events[kMaxEvents];
+    int n = epoll_wait(epollFd_, events, kMaxEvents, -1);
+    if (n < 0) {
+        if (errno != EINTR) {
+            std::cerr << "EventDispatcherEpoll::processEvents: " << std::strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    bool timersDue = false;
+    for (int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == wakeFd_) {
+            drain(wakeFd_);
+        } else if (fd == timerFd_) {
+            drain(timerFd_);
+            timersDue = true;
+        } else if (std::find(internalFds_.begin(), internalFds_.end(), fd) != internalFds_.end()) {
+            internalEvent(fd);
+        } else {
+            dispatchSocket(fd, events[i].events);
+        }
+    }
+    if (timersDue) {
+        activateTimers();
+    }
+    return n > 0;
+}
+
+bool EventDispatcherEpoll::watchInternal(int fd)
+{
+    if (epollFd_ < 0) return false;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::cerr << "EventDispatcherEpoll::watchInternal: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    internalFds_.push_back(fd);
+    return true;
+}
+
+void EventDispatcherEpoll::unwatchInternal(int fd)
+{
+    auto it = std::find(internalFds_.begin(), internalFds_.end(), fd);
+    if (it == internalFds_.end()) return;
+    internalFds_.erase(it);
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void EventDispatcherEpoll::wakeUp()
+{
+    if (wakeFd_ < 0) return;
+    uint64_t one = 1;
+    // Fails only when the counter is saturated, which wakes the loop anyway
+    ssize_t written = write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void EventDispatcherEpoll::interrupt()
+{
+    wakeUp();
+}
+
+void EventDispatcherEpoll::registerTimer(int timerId, int64_t interval, CObject* receiver)
+{
+    if (timerFd_ < 0) return;
+    auto it = timers_.find(timerId);
+    if (it != timers_.end()) {
+        deadlines_.erase({it->second.deadline, timerId});
+    }
+    int64_t deadline = currentTime() + interval;
+    timers_[timerId] = Timer{interval, deadline, receiver};
+    deadlines_.emplace(deadline, timerId);
+    armTimer();
+}
+
+bool EventDispatcherEpoll::unregisterTimer(int timerId)
+{
+    auto it = timers_.find(timerId);
+    if (it == timers_.end()) return false;
+    deadlines_.erase({it->second.deadline, timerId});
+    timers_.erase(it);
+    armTimer();
+    return true;
+}
+
+bool EventDispatcherEpoll::unregisterTimers(CObject* object)
+{
+    bool removed = false;
+    for (auto it = timers_.begin(); it != timers_.end();) {
+        if (it->second.receiver == object) {
+            deadlines_.erase({it->second.deadline, it->first});
+            it = timers_.erase(it);
+            removed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (removed) {
+        armTimer();
+    }
+    return removed;
+}
+
+int EventDispatcherEpoll::remainingTime(int timerId)
+{
+    auto it = timers_.find(timerId);
+    if (it == timers_.end()) return -1;
+    int64_t remaining = it->second.deadline - currentTime();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+void EventDispatcherEpoll::activateTimers()
+{
+    // The timerfd has expired; whatever it is armed for next is set below
+    armedDeadline_ = -1;
+    int64_t now = currentTime();
+    std::vector<int> due;
+    while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+        due.push_back(deadlines_.begin()->second);
+        deadlines_.erase(deadlines_.begin());
+    }
+    // Rescheduled before any handler runs, so zero-interval timers fire
+    // once per iteration rather than in a loop
+    for (int id : due) {
+        Timer& t = timers_[id];
+        t.deadline = now + t.interval;
+        deadlines_.emplace(t.deadline, id);
+    }
+    armTimer();
+    for (int id : due) {
+        // An earlier handler may have killed it
+        auto it = timers_.find(id);
+        if (it == timers_.end()) continue;
+        TimerEvent ev(id);
+        CObject::sendEvent(it->second.receiver, &ev);
+    }
+}
+
+void EventDispatcherEpoll::armTimer()
+{
+    int64_t deadline = deadlines_.empty() ? -1 : deadlines_.begin()->first;
+    if (deadline == armedDeadline_ || timerFd_ < 0) return;
+    itimerspec spec{};
+    if (deadline >= 0) {
+        spec.it_value.tv_sec = deadline / 1000;
+        spec.it_value.tv_nsec = (deadline % 1000) * 1000000;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+            // A zero value would disarm it
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+    armedDeadline_ = deadline;
+}
+
+uint32_t EventDispatcherEpoll::interestFor(const Socket& socket) const
+{
+    uint32_t events = 0;
+    if (socket.notifiers[static_cast<int>(SocketNotifierType::Read)]) events |= EPOLLIN;
+    if (socket.notifiers[static_cast<int>(SocketNotifierType::Write)]) events |= EPOLLOUT;
+    if (socket.notifiers[static_cast<int>(SocketNotifierType::Exception)]) events |= EPOLLPRI;
+    if (trigger_ == Trigger::Edge) events |= EPOLLET;
+    return events;
+}
+
+void EventDispatcherEpoll::registerSocketNotifier(SocketNotifier* notifier)
+{
+    if (!notifier || notifier->socket < 0 || epollFd_ < 0) return;
+    auto [it, inserted] = sockets_.try_emplace(notifier->socket);
+    SocketNotifier*& slot = it->second.notifiers[static_cast<int>(notifier->type)];
+    if (slot && slot != notifier) {
+        std::cerr << "EventDispatcherEpoll::registerSocketNotifier: Replacing the notifier of socket "
+                  << notifier->socket << std::endl;
+    }
+    SocketNotifier* previous = slot;
+    slot = notifier;
+
+    epoll_event ev{};
+    ev.events = interestFor(it->second);
+    ev.data.fd = notifier->socket;
+    if (epoll_ctl(epollFd_, inserted ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, notifier->socket, &ev) < 0) {
+        std::cerr << "EventDispatcherEpoll::registerSocketNotifier: " << std::strerror(errno) << std::endl;
+        slot = previous;
+        if (inserted) {
+            sockets_.erase(it);
+        }
+    }
+}
+
+void EventDispatcherEpoll::unregisterSocketNotifier(SocketNotifier* notifier)
+{
+    if (!notifier) return;
+    auto it = sockets_.find(notifier->socket);
+    if (it == sockets_.end()) return;
+    SocketNotifier*& slot = it->second.notifiers[static_cast<int>(notifier->type)];
+    if (slot != notifier) return;
+    slot = nullptr;
+
+    uint32_t events = interestFor(it->second) & ~static_cast<uint32_t>(EPOLLET);
+    if (!events) {
+        // Fails harmlessly if the socket was closed first
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, notifier->socket, nullptr);
+        sockets_.erase(it);
+        return;
+    }
+    epoll_event ev{};
+    ev.events = interestFor(it->second);
+    ev.data.fd = notifier->socket;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, notifier->socket, &ev);
+}
+
+void EventDispatcherEpoll::dispatchSocket(int fd, uint32_t events)
+{
+    // Errors and hang-ups wake readers and writers, which see them on
+    // their next call, as with poll()
+    static const uint32_t masks[3] = {
+        EPOLLIN | EPOLLERR | EPOLLHUP,
+        EPOLLOUT | EPOLLERR | EPOLLHUP,
+        EPOLLPRI,
+    };
+    for (int type = 0; type < 3; ++type) {
+        // Looked up each time: a receiver may unregister any notifier
+        auto it = sockets_.find(fd);
+        if (it == sockets_.end()) return;
+        SocketNotifier* notifier = it->second.notifiers[type];
+        if (notifier && notifier->enable && (events & masks[type])) {
+            Event event(Event::Type::SocketAct);
+            CObject::sendEvent(notifier->receiver, &event);
+        }
+    }
+}
+
+}
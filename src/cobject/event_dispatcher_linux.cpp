@@ -3,6 +3,7 @@
 #include <vector>
 #include <chrono>
 #include <algorithm>
+#include <unordered_map>
 
 #include "event_dispatcher_linux.hpp"
 #include "event.hpp"
@@ -31,9 +32,163 @@ struct TimerInfo {
     bool activated = false;
 };
 
+// Min-heap of timers by nextTimeout, indexed by id and by receiver, so
+// registering, killing and finding the next timeout never scan all timers
+class TimerHeap {
+public:
+    bool empty() const { return heap_.empty(); }
+    const TimerInfo& top() const { return heap_.front(); }
+
+    TimerInfo* find(int id) {
+        auto it = slots_.find(id);
+        return it == slots_.end() ? nullptr : &heap_[it->second];
+    }
+
+    void insert(const TimerInfo& timer) {
+        heap_.push_back(timer);
+        slots_[timer.id] = heap_.size() - 1;
+        byReceiver_.emplace(timer.receiver, timer.id);
+        siftUp(heap_.size() - 1);
+    }
+
+    // Moves a registered timer to a new deadline
+    void reschedule(int id, int64_t nextTimeout) {
+        size_t slot = slots_.at(id);
+        heap_[slot].nextTimeout = nextTimeout;
+        restore(slot);
+    }
+
+    bool erase(int id) {
+        auto it = slots_.find(id);
+        if (it == slots_.end()) return false;
+        size_t slot = it->second;
+        forgetReceiver(heap_[slot].receiver, id);
+        slots_.erase(it);
+        size_t last = heap_.size() - 1;
+        if (slot != last) {
+            heap_[slot] = heap_[last];
+            slots_[heap_[slot].id] = slot;
+        }
+        heap_.pop_back();
+        if (slot < heap_.size()) {
+            restore(slot);
+        }
+        return true;
+    }
+
+    bool eraseReceiver(CObject* receiver) {
+        auto range = byReceiver_.equal_range(receiver);
+        if (range.first == range.second) return false;
+        std::vector<int> ids;
+        for (auto it = range.first; it != range.second; ++it) {
+            ids.push_back(it->second);
+        }
+        for (int id : ids) {
+            erase(id);
+        }
+        return true;
+    }
+
+    void setReceiver(int id, CObject* receiver) {
+        TimerInfo* timer = find(id);
+        if (timer->receiver == receiver) return;
+        forgetReceiver(timer->receiver, id);
+        timer->receiver = receiver;
+        byReceiver_.emplace(receiver, id);
+    }
+
+    /**
+     * Marks every timer due at `now` activated and reschedules it at
+     * `now + interval`. All due timers are taken off first, so a
+     * zero-interval timer fires once per pass.
+     */
+    void activateDue(int64_t now) {
+        due_.clear();
+        while (!heap_.empty() && heap_.front().nextTimeout <= now) {
+            due_.push_back(heap_.front().id);
+            TimerInfo& timer = heap_.front();
+            if (!timer.activated) {
+                timer.activated = true;
+                activated_.push_back(timer.id);
+            }
+            // Parked past every deadline until the pass is done
+            timer.nextTimeout = INT64_MAX;
+            siftDown(0);
+        }
+        for (int id : due_) {
+            reschedule(id, now + find(id)->interval);
+        }
+    }
+
+    // Ids activated since the last call, in activation order
+    void takeActivated(std::vector<int>& out) {
+        out.swap(activated_);
+        activated_.clear();
+    }
+
+private:
+    void forgetReceiver(CObject* receiver, int id) {
+        auto range = byReceiver_.equal_range(receiver);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == id) {
+                byReceiver_.erase(it);
+                return;
+            }
+        }
+    }
+
+    void place(size_t slot, const TimerInfo& timer) {
+        heap_[slot] = timer;
+        slots_[timer.id] = slot;
+    }
+
+    void restore(size_t slot) {
+        if (slot > 0 && heap_[slot].nextTimeout < heap_[(slot - 1) / 2].nextTimeout) {
+            siftUp(slot);
+        } else {
+            siftDown(slot);
+        }
+    }
+
+    void siftUp(size_t slot) {
+        TimerInfo timer = heap_[slot];
+        while (slot > 0) {
+            size_t parent = (slot - 1) / 2;
+            if (heap_[parent].nextTimeout <= timer.nextTimeout) break;
+            place(slot, heap_[parent]);
+            slot = parent;
+        }
+        place(slot, timer);
+    }
+
+    void siftDown(size_t slot) {
+        TimerInfo timer = heap_[slot];
+        size_t size = heap_.size();
+        while (true) {
+            size_t child = 2 * slot + 1;
+            if (child >= size) break;
+            if (child + 1 < size && heap_[child + 1].nextTimeout < heap_[child].nextTimeout) {
+                ++child;
+            }
+            if (timer.nextTimeout <= heap_[child].nextTimeout) break;
+            place(slot, heap_[child]);
+            slot = child;
+        }
+        place(slot, timer);
+    }
+
+    std::vector<TimerInfo> heap_;
+    std::unordered_map<int, size_t> slots_;
+    std::unordered_multimap<CObject*, int> byReceiver_;
+    std::vector<int> activated_;
+    std::vector<int> due_;
+};
+
 struct GTimerSource {
     GSource source;
-    std::vector<TimerInfo> timerList;
+    // Owned; g_source_new() only zeroes the struct, so C++ members live
+    // behind a pointer
+    TimerHeap* timers;
     bool runWithIdlePriority;
 };
 
@@ -62,7 +217,7 @@ static gboolean socketNotifierSourceCheck(GSource* source)
     bool pending = false;
     for (size_t i = 0; i < s->pollfds.size(); ++i) {
         auto* pfd = s->pollfds[i];
-        if (pfd->pollfd.revents & G_IO_INVAL) {
+        if (pfd->pollfd.revents & G_IO_NVAL) {
             pfd->socketNotifier->enable = false;
         } else if (pfd->socketNotifier->enable) {
             pending = pending || ((pfd->pollfd.revents & pfd->pollfd.events) != 0);
@@ -98,16 +253,9 @@ static GSourceFuncs socketNotifierSourceFuncs = {
 
 static int64_t getNextTimerTimeout(GTimerSource* s)
 {
-    if (s->timerList.empty())
+    if (s->timers->empty())
         return -1;
-    int64_t now = getCurrentTime();
-    int64_t minTimeout = INT64_MAX;
-    for (auto& timer : s->timerList) {
-        int64_t timeout = timer.nextTimeout - now;
-        if (timeout < minTimeout)
-            minTimeout = timeout;
-    }
-    return minTimeout;
+    return s->timers->top().nextTimeout - getCurrentTime();
 }
 
 static gint saturateCast(int64_t value)
@@ -137,25 +285,13 @@ static gboolean timerSourceCheck(GSource* source)
 {
     auto* s = reinterpret_cast<GTimerSource*>(source);
     if (s->runWithIdlePriority) return false;
-    if (s->timerList.empty()) return false;
-    int64_t now = getCurrentTime();
-    for (const auto& timer : s->timerList) {
-        if (timer.nextTimeout <= now)
-            return true;
-    }
-    return false;
+    return !s->timers->empty() && s->timers->top().nextTimeout <= getCurrentTime();
 }
 
 static gboolean timerSourceDispatch(GSource* source, GSourceFunc, gpointer)
 {
     auto* s = reinterpret_cast<GTimerSource*>(source);
-    int64_t now = getCurrentTime();
-    for (auto& timer : s->timerList) {
-        if (timer.nextTimeout <= now) {
-            timer.activated = true;
-            timer.nextTimeout = now + timer.interval;
-        }
-    }
+    s->timers->activateDue(getCurrentTime());
     return true;
 }
 
@@ -187,13 +323,7 @@ static gboolean idleTimerSourceDispatch(GSource* source, GSourceFunc, gpointer)
     if (!s->timerSource) return true;
     auto* time_source = s->timerSource;
     time_source->runWithIdlePriority = true;
-    int64_t now = getCurrentTime();
-    for (auto& timer : time_source->timerList) {
-        if (timer.nextTimeout <= now) {
-            timer.activated = true;
-            timer.nextTimeout = now + timer.interval;
-        }
-    }
+    time_source->timers->activateDue(getCurrentTime());
     return true;
 }
 
@@ -237,6 +367,16 @@ EventDispatcherLinux::EventDispatcherLinux(GMainContext* context, CObject* paren
 EventDispatcherLinux::~EventDispatcherLinux()
 {
     shuttingDown();
+    if (ownsContext_) {
+        g_main_context_unref(mainContext_);
+    }
+}
+
+EventDispatcherLinux* EventDispatcherLinux::createForThread(CObject* parent)
+{
+    auto* dispatcher = new EventDispatcherLinux(g_main_context_new(), parent);
+    dispatcher->ownsContext_ = true;
+    return dispatcher;
 }
 
 bool EventDispatcherLinux::processEvents()
@@ -244,11 +384,15 @@ bool EventDispatcherLinux::processEvents()
     g_main_context_iteration(mainContext_, true);
     if (timerSource_) {
         auto* s = timerSource_;
-        for (auto& t : s->timerList) {
-            if (t.activated) {
-                t.activated = false;
-                TimerEvent ev(t.id);
-                CObject::sendEvent(t.receiver, &ev);
+        // Handlers may start and kill timers, so look each one up again
+        std::vector<int> activated;
+        s->timers->takeActivated(activated);
+        for (int id : activated) {
+            TimerInfo* t = s->timers->find(id);
+            if (t && t->activated) {
+                t->activated = false;
+                TimerEvent ev(id);
+                CObject::sendEvent(t->receiver, &ev);
             }
         }
         s->runWithIdlePriority = false;
@@ -270,13 +414,12 @@ void EventDispatcherLinux::registerTimer(int timerId, int64_t interval, CObject*
 {
     if (!timerSource_) return;
     int64_t now = getCurrentTime();
-    auto& list = timerSource_->timerList;
-    auto it = std::find_if(list.begin(), list.end(), [timerId](const TimerInfo& t) { return t.id == timerId; });
-    if (it != list.end()) {
-        it->interval = interval;
-        it->receiver = receiver;
-        it->nextTimeout = now + interval;
-        it->activated = false;
+    TimerHeap& timers = *timerSource_->timers;
+    if (TimerInfo* existing = timers.find(timerId)) {
+        existing->interval = interval;
+        existing->activated = false;
+        timers.setReceiver(timerId, receiver);
+        timers.reschedule(timerId, now + interval);
         return;
     }
     TimerInfo timer;
@@ -285,41 +428,28 @@ void EventDispatcherLinux::registerTimer(int timerId, int64_t interval, CObject*
     timer.receiver = receiver;
     timer.nextTimeout = now + interval;
     timer.activated = false;
-    list.push_back(timer);
+    timers.insert(timer);
 }
 
 bool EventDispatcherLinux::unregisterTimer(int timerId)
 {
     if (!timerSource_) return false;
-    auto& list = timerSource_->timerList;
-    auto it = std::find_if(list.begin(), list.end(), [timerId](const TimerInfo& t) { return t.id == timerId; });
-    if (it != list.end()) {
-        list.erase(it);
-        return true;
-    }
-    return false;
+    return timerSource_->timers->erase(timerId);
 }
 
 bool EventDispatcherLinux::unregisterTimers(CObject* object)
 {
     if (!timerSource_ || !object) return false;
-    auto& list = timerSource_->timerList;
-    auto oldSize = list.size();
-    list.erase(std::remove_if(list.begin(), list.end(), [object](const TimerInfo& t) { return t.receiver == object; }), list.end());
-    return list.size() != oldSize;
+    return timerSource_->timers->eraseReceiver(object);
 }
 
 int EventDispatcherLinux::remainingTime(int timerId)
 {
     if (!timerSource_) return -1;
-    int64_t now = getCurrentTime();
-    for (const auto& t : timerSource_->timerList) {
-        if (t.id == timerId) {
-            int64_t remain = t.nextTimeout - now;
-            return remain < 0 ? 0 : static_cast<int>(std::min<int64_t>(remain, INT_MAX));
-        }
-    }
-    return -1;
+    const TimerInfo* t = timerSource_->timers->find(timerId);
+    if (!t) return -1;
+    int64_t remain = t->nextTimeout - getCurrentTime();
+    return remain < 0 ? 0 : static_cast<int>(std::min<int64_t>(remain, INT_MAX));
 }
 
 void EventDispatcherLinux::registerSocketNotifier(SocketNotifier* notifier)
@@ -368,7 +498,7 @@ void EventDispatcherLinux::startingUp()
     {
         GSource* source = g_source_new(&timerSourceFuncs, sizeof(GTimerSource));
         timerSource_ = reinterpret_cast<GTimerSource*>(source);
-        timerSource_->timerList.clear();
+        timerSource_->timers = new TimerHeap();
         timerSource_->runWithIdlePriority = false;
         g_source_set_can_recurse(reinterpret_cast<GSource*>(timerSource_), true);
         g_source_attach(reinterpret_cast<GSource*>(timerSource_), mainContext_);
@@ -397,6 +527,8 @@ void EventDispatcherLinux::shuttingDown()
         socketNotifierSource_ = nullptr;
     }
     if (timerSource_) {
+        delete timerSource_->timers;
+        timerSource_->timers = nullptr;
         g_source_destroy(reinterpret_cast<GSource*>(timerSource_));
         g_source_unref(reinterpret_cast<GSource*>(timerSource_));
         timerSource_ = nullptr;
@@ -0,0 +1,420 @@
+#include "event_dispatcher_uring.hpp"
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "event.hpp"
+#include "cobject.hpp"
+#include "memory_pool_v2.hpp"
+
+namespace SAK {
+
+AUTO_REGISTER_META_OBJECT(EventDispatcherUring, EventDispatcherEpoll)
+
+namespace {
+
+constexpr unsigned kDefaultEntries = 256;
+constexpr std::size_t kDefaultBufferSize = 16 * 1024;
+constexpr unsigned kDefaultBufferCount = 16;
+constexpr unsigned kReapBatch = 64;
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+} // namespace
+
+// The rings shared with the kernel, mapped from the io_uring fd. Entries
+// are published to the kernel only by flush().
+struct EventDispatcherUring::Ring {
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    std::size_t sqRingSize = 0;
+    void* cqRing = MAP_FAILED;
+    std::size_t cqRingSize = 0;
+    void* sqeMap = MAP_FAILED;
+    std::size_t sqeMapSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned localTail = 0;
+    // Requests submitted whose completion has not been reaped
+    std::size_t inflight = 0;
+
+    static Ring* create(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = uringSetup(entries, &params);
+        if (fd < 0) {
+            return nullptr;
+        }
+        Ring* ring = new Ring;
+        ring->fd = fd;
+        ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            ring->sqRingSize = ring->cqRingSize = std::max(ring->sqRingSize, ring->cqRingSize);
+        }
+        ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ring->sqRing == MAP_FAILED) {
+            delete ring;
+            return nullptr;
+        }
+        ring->cqRing = single ? ring->sqRing
+                              : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        ring->sqeMapSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqeMap = mmap(nullptr, ring->sqeMapSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (ring->cqRing == MAP_FAILED || ring->sqeMap == MAP_FAILED) {
+            delete ring;
+            return nullptr;
+        }
+
+        auto* sq = static_cast<char*>(ring->sqRing);
+        auto* cq = static_cast<char*>(ring->cqRing);
+        ring->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+        ring->sqes = static_cast<io_uring_sqe*>(ring->sqeMap);
+        ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        ring->localTail = *ring->sqTail;
+        return ring;
+    }
+
+    ~Ring() {
+        if (sqeMap != MAP_FAILED) munmap(sqeMap, sqeMapSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (fd >= 0) close(fd);
+    }
+
+    unsigned unsubmitted() const {
+        return localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    }
+
+    // A zeroed entry, or nullptr while the queue is full
+    io_uring_sqe* next() {
+        if (unsubmitted() >= sqEntries) {
+            return nullptr;
+        }
+        unsigned index = localTail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        ++localTail;
+        return sqe;
+    }
+
+    // Submits what next() handed out, optionally waiting for completions
+    int flush(unsigned minComplete = 0) {
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        return uringEnter(fd, unsubmitted(), minComplete, minComplete ? IORING_ENTER_GETEVENTS : 0);
+    }
+
+    // Copies out up to `max` completions
+    unsigned reap(io_uring_cqe* out, unsigned max) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        unsigned n = 0;
+        while (head != tail && n < max) {
+            out[n++] = cqes[head & cqMask];
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        return n;
+    }
+};
+
+EventDispatcherUring::EventDispatcherUring(CObject* parent)
+    : EventDispatcherUring(kDefaultEntries, kDefaultBufferSize, kDefaultBufferCount, parent)
+{
+}
+
+EventDispatcherUring::EventDispatcherUring(unsigned entries, std::size_t bufferSize, unsigned bufferCount,
+                                           CObject* parent)
+    : EventDispatcherEpoll(parent)
+    , entries_(entries)
+    , bufferSize_(bufferSize)
+    , bufferCount_(bufferSize ? bufferCount : 0)
+{
+    startingUp();
+}
+
+EventDispatcherUring::~EventDispatcherUring()
+{
+    shuttingDown();
+}
+
+void EventDispatcherUring::startingUp()
+{
+    EventDispatcherEpoll::startingUp();
+    if (completionFd_ >= 0) return;
+    completionFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (completionFd_ < 0 || !watchInternal(completionFd_)) {
+        std::cerr << "EventDispatcherUring: No completion eventfd" << std::endl;
+        if (completionFd_ >= 0) {
+            close(completionFd_);
+            completionFd_ = -1;
+        }
+        return;
+    }
+
+    if (bufferCount_) {
+        buffers_ = static_cast<uint8_t*>(MemoryPoolV2::GetInstance().Allocate(bufferSize_ * bufferCount_));
+        for (unsigned i = bufferCount_; buffers_ && i > 0; --i) {
+            freeBuffers_.push_back(static_cast<int>(i - 1));
+        }
+    }
+
+    ring_ = Ring::create(entries_);
+    if (!ring_) {
+        std::cerr << "EventDispatcherUring: io_uring unavailable (" << std::strerror(errno)
+                  << "), running requests synchronously" << std::endl;
+        return;
+    }
+    if (uringRegister(ring_->fd, IORING_REGISTER_EVENTFD, &completionFd_, 1) < 0) {
+        std::cerr << "EventDispatcherUring: Cannot register the eventfd: " << std::strerror(errno) << std::endl;
+        delete ring_;
+        ring_ = nullptr;
+        return;
+    }
+    if (buffers_) {
+        std::vector<iovec> iovecs(bufferCount_);
+        for (unsigned i = 0; i < bufferCount_; ++i) {
+            iovecs[i].iov_base = buffers_ + i * bufferSize_;
+            iovecs[i].iov_len = bufferSize_;
+        }
+        // Fails under a low RLIMIT_MEMLOCK; the buffers then serve plain requests
+        buffersRegistered_ = uringRegister(ring_->fd, IORING_REGISTER_BUFFERS, iovecs.data(), bufferCount_) == 0;
+    }
+}
+
+void EventDispatcherUring::shuttingDown()
+{
+    if (ring_) {
+        // The kernel may still write into the buffers until each request
+        // has completed or been cancelled
+        for (const auto& entry : requests_) {
+            io_uring_sqe* sqe = ring_->next();
+            if (!sqe) {
+                ring_->flush();
+                sqe = ring_->next();
+            }
+            if (sqe) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = -1;
+                sqe->addr = entry.first;
+                sqe->user_data = 0;
+            }
+        }
+        io_uring_cqe batch[kReapBatch];
+        while (ring_->inflight > 0) {
+            if (ring_->flush(1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                break;
+            }
+            unsigned n;
+            while ((n = ring_->reap(batch, kReapBatch)) > 0) {
+                for (unsigned i = 0; i < n; ++i) {
+                    if (batch[i].user_data) {
+                        --ring_->inflight;
+                    }
+                }
+            }
+        }
+        delete ring_;
+        ring_ = nullptr;
+    }
+    for (const auto& entry : requests_) {
+        releaseBuffer(entry.second);
+    }
+    requests_.clear();
+    finished_.clear();
+    if (completionFd_ >= 0) {
+        unwatchInternal(completionFd_);
+        close(completionFd_);
+        completionFd_ = -1;
+    }
+    if (buffers_) {
+        MemoryPoolV2::GetInstance().Deallocate(buffers_, bufferSize_ * bufferCount_);
+        buffers_ = nullptr;
+    }
+    buffersRegistered_ = false;
+    freeBuffers_.clear();
+    EventDispatcherEpoll::shuttingDown();
+}
+
+uint64_t EventDispatcherUring::read(int fd, uint64_t offset, std::size_t len, CObject* receiver)
+{
+    return submit(fd, offset, len, nullptr, receiver, true);
+}
+
+uint64_t EventDispatcherUring::write(int fd, uint64_t offset, const void* data, std::size_t len, CObject* receiver)
+{
+    return submit(fd, offset, len, data, receiver, false);
+}
+
+void EventDispatcherUring::cancelRequests(CObject* receiver)
+{
+    for (auto& entry : requests_) {
+        if (entry.second.receiver == receiver) {
+            entry.second.receiver = nullptr;
+        }
+    }
+}
+
+uint64_t EventDispatcherUring::submit(int fd, uint64_t offset, std::size_t len, const void* data,
+                                      CObject* receiver, bool isRead)
+{
+    if (!receiver || completionFd_ < 0 || len > UINT32_MAX) return 0;
+
+    Request request{receiver, nullptr, len, -1, isRead};
+    if (len <= bufferSize_ && !freeBuffers_.empty()) {
+        request.bufferIndex = freeBuffers_.back();
+        freeBuffers_.pop_back();
+        request.buffer = buffers_ + static_cast<std::size_t>(request.bufferIndex) * bufferSize_;
+    } else {
+        request.buffer = static_cast<uint8_t*>(MemoryPoolV2::GetInstance().Allocate(len ? len : 1));
+        if (!request.buffer) return 0;
+    }
+    if (!isRead && len) {
+        std::memcpy(request.buffer, data, len);
+    }
+
+    uint64_t id = nextId_++;
+    requests_.emplace(id, request);
+
+    io_uring_sqe* sqe = ring_ ? ring_->next() : nullptr;
+    if (ring_ && !sqe) {
+        ring_->flush();
+        sqe = ring_->next();
+    }
+    if (!sqe) {
+        runSynchronously(id, fd, offset, request);
+        return id;
+    }
+    bool fixed = buffersRegistered_ && request.bufferIndex >= 0;
+    if (isRead) {
+        sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    } else {
+        sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    }
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(request.buffer);
+    sqe->len = static_cast<uint32_t>(len);
+    if (fixed) {
+        sqe->buf_index = static_cast<uint16_t>(request.bufferIndex);
+    }
+    sqe->user_data = id;
+    ++ring_->inflight;
+    return id;
+}
+
+void EventDispatcherUring::runSynchronously(uint64_t id, int fd, uint64_t offset, const Request& request)
+{
+    ssize_t n;
+    if (request.isRead) {
+        n = offset == kCurrentPosition ? ::read(fd, request.buffer, request.size)
+                                       : ::pread(fd, request.buffer, request.size, static_cast<off_t>(offset));
+    } else {
+        n = offset == kCurrentPosition ? ::write(fd, request.buffer, request.size)
+                                       : ::pwrite(fd, request.buffer, request.size, static_cast<off_t>(offset));
+    }
+    finished_.emplace_back(id, n < 0 ? -errno : n);
+    uint64_t one = 1;
+    ssize_t written = ::write(completionFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void EventDispatcherUring::aboutToWait()
+{
+    // Everything queued since the last wait goes in one system call
+    if (ring_ && ring_->unsubmitted() > 0) {
+        ring_->flush();
+    }
+}
+
+void EventDispatcherUring::internalEvent(int fd)
+{
+    if (fd != completionFd_) return;
+    uint64_t count;
+    while (::read(completionFd_, &count, sizeof(count)) == sizeof(count)) {
+    }
+    if (ring_) {
+        io_uring_cqe batch[kReapBatch];
+        unsigned n;
+        while ((n = ring_->reap(batch, kReapBatch)) > 0) {
+            for (unsigned i = 0; i < n; ++i) {
+                if (batch[i].user_data) {
+                    --ring_->inflight;
+                    complete(batch[i].user_data, batch[i].res);
+                }
+            }
+        }
+    }
+    if (!finished_.empty()) {
+        // Handlers may queue more; those signal the eventfd again
+        std::vector<std::pair<uint64_t, int64_t>> finished;
+        finished.swap(finished_);
+        for (const auto& result : finished) {
+            complete(result.first, result.second);
+        }
+    }
+}
+
+void EventDispatcherUring::complete(uint64_t id, int64_t result)
+{
+    auto it = requests_.find(id);
+    if (it == requests_.end()) return;
+    Request request = it->second;
+    requests_.erase(it);
+    if (request.receiver) {
+        IoCompletionEvent event(id, result, request.isRead && result > 0 ? request.buffer : nullptr);
+        CObject::sendEvent(request.receiver, &event);
+    }
+    releaseBuffer(request);
+}
+
+void EventDispatcherUring::releaseBuffer(const Request& request)
+{
+    if (request.bufferIndex >= 0) {
+        freeBuffers_.push_back(request.bufferIndex);
+    } else if (request.buffer) {
+        MemoryPoolV2::GetInstance().Deallocate(request.buffer, request.size ? request.size : 1);
+    }
+}
+
+}
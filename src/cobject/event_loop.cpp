@@ -0,0 +1,494 @@
+#include "event_loop.hpp"
+
+#include "cobject.hpp"
+#include "event_dispatcher.hpp"
+#include "metrics.hpp"
+#if defined(__linux__)
+#include "event_dispatcher_epoll.hpp"
+#if !defined(CODEKNIFE_NO_GLIB)
+#include "event_dispatcher_linux.hpp"
+#endif
+#elif defined(_WIN32)
+#include "event_dispatcher_win.hpp"
+#endif
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace SAK {
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    // Holds one reference to each entry
+    std::unordered_map<std::thread::id, ThreadData*> threads;
+    epoch_domain epoch;
+};
+
+// Never destroyed: objects with static storage may outlive it
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+} // namespace
+
+ThreadData* ThreadData::current() {
+    struct Holder {
+        ThreadData* data = ThreadData::get(std::this_thread::get_id());
+
+        ~Holder() {
+            Registry& reg = registry();
+            bool registered = false;
+            {
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                auto it = reg.threads.find(data->id());
+                if (it != reg.threads.end() && it->second == data) {
+                    reg.threads.erase(it);
+                    registered = true;
+                }
+            }
+            if (registered) {
+                data->deref();
+            }
+            data->deref();
+        }
+    };
+    thread_local Holder holder;
+    return holder.data;
+}
+
+ThreadData* ThreadData::get(std::thread::id thread) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    ThreadData*& data = reg.threads[thread];
+    if (!data) {
+        data = new ThreadData(thread);
+    }
+    data->ref();
+    return data;
+}
+
+epoch_guard ThreadData::pin() {
+    return registry().epoch.pin();
+}
+
+ThreadData::~ThreadData() {
+    // No object references this thread any more, so no receiver is
+    // touched: whatever is left was posted to objects that died or moved
+    while (PostedEvent* pe = incoming_.pop()) {
+        delete pe->event;
+        delete pe;
+    }
+    while (!pending_.Empty()) {
+        PostedEvent* pe = &pending_.Front();
+        pending_.Remove(*pe);
+        delete pe->event;
+        delete pe;
+    }
+}
+
+void ThreadData::ref() noexcept {
+    refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadData::deref() noexcept {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Posters may still hold this pointer under pin()
+        registry().epoch.retire(this, [](void* data) { delete static_cast<ThreadData*>(data); });
+    }
+}
+
+void ThreadData::postEvent(CObject* receiver, Event* event) {
+    if (!receiver || !event) {
+        delete event;
+        return;
+    }
+    epoch_guard guard = pin();
+    receiver->thread_data_.load(std::memory_order_acquire)->enqueue(receiver, event);
+}
+
+void ThreadData::postCall(Event* event) {
+    if (event) {
+        enqueue(nullptr, event);
+    }
+}
+
+void ThreadData::enqueue(CObject* receiver, Event* event) {
+    if (receiver) {
+        receiver->posted_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    incoming_.push(new PostedEvent(receiver, event));
+    wakeUp();
+}
+
+void ThreadData::drainIncoming() {
+    while (PostedEvent* pe = incoming_.pop()) {
+        if (CObject* receiver = pe->receiver) {
+            ThreadData* owner = receiver->thread_data_.load(std::memory_order_acquire);
+            if (owner != this) {
+                // Posted while the receiver was moving to another thread
+                owner->queued_.fetch_add(1, std::memory_order_release);
+                queued_.fetch_sub(1, std::memory_order_release);
+                owner->incoming_.push(pe);
+                owner->wakeUp();
+                continue;
+            }
+            if (coalesceInto(receiver, pe)) {
+                continue;
+            }
+            receiver->posted_events_.PushBack(*pe);
+        }
+        pending_.PushBack(*pe);
+    }
+}
+
+bool ThreadData::coalesceInto(CObject* receiver, PostedEvent* pe) {
+    if (!coalesce_.load(std::memory_order_relaxed) || receiver->posted_events_.Empty()) {
+        return false;
+    }
+    PostedEvent& last = receiver->posted_events_.Back();
+    if (last.event->type() != pe->event->type() || !last.event->merge(*pe->event)) {
+        return false;
+    }
+    receiver->posted_count_.fetch_sub(1, std::memory_order_relaxed);
+    queued_.fetch_sub(1, std::memory_order_release);
+    coalesced_.fetch_add(1, std::memory_order_relaxed);
+    delete pe->event;
+    delete pe;
+    return true;
+}
+
+void ThreadData::unlink(PostedEvent* pe) {
+    pending_.Remove(*pe);
+    queued_.fetch_sub(1, std::memory_order_release);
+    if (CObject* receiver = pe->receiver) {
+        receiver->posted_events_.Remove(*pe);
+        receiver->posted_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+ThreadData* ThreadData::lockOwner(const CObject* object, std::unique_lock<std::mutex>& lock) {
+    for (;;) {
+        ThreadData* owner = object->thread_data_.load(std::memory_order_acquire);
+        lock = std::unique_lock<std::mutex>(owner->pending_mutex_);
+        // Checked under the lock: moving the object needs it too
+        if (object->thread_data_.load(std::memory_order_acquire) == owner) {
+            return owner;
+        }
+        lock.unlock();
+    }
+}
+
+void ThreadData::removePostedEvents(CObject* receiver, Event::Type type) {
+    if (receiver) {
+        if (receiver->posted_count_.load(std::memory_order_acquire) == 0) {
+            // The common case when objects are torn down
+            return;
+        }
+        PostedEventQueue removed;
+        {
+            epoch_guard guard = pin();
+            std::unique_lock<std::mutex> lock;
+            ThreadData* owner = lockOwner(receiver, lock);
+            owner->drainIncoming();
+            PostedEventList& events = receiver->posted_events_;
+            for (auto it = events.Begin(); it != events.End();) {
+                PostedEvent& pe = *it++;
+                if (type == Event::Type::None || pe.event->type() == type) {
+                    owner->unlink(&pe);
+                    removed.PushBack(pe);
+                }
+            }
+        }
+        // Outside the lock: destroying an event may post another one
+        while (!removed.Empty()) {
+            PostedEvent* pe = &removed.Front();
+            removed.Remove(*pe);
+            delete pe->event;
+            delete pe;
+        }
+        return;
+    }
+
+    std::vector<ThreadData*> threads;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& [id, data] : reg.threads) {
+            data->ref();
+            threads.push_back(data);
+        }
+    }
+    for (ThreadData* data : threads) {
+        data->removeAll(type);
+        data->deref();
+    }
+}
+
+void ThreadData::removeAll(Event::Type type) {
+    PostedEventQueue removed;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        drainIncoming();
+        for (auto it = pending_.Begin(); it != pending_.End();) {
+            PostedEvent& pe = *it++;
+            // Calls posted with postCall() have no receiver and stay
+            if (pe.receiver && (type == Event::Type::None || pe.event->type() == type)) {
+                unlink(&pe);
+                removed.PushBack(pe);
+            }
+        }
+    }
+    while (!removed.Empty()) {
+        PostedEvent* pe = &removed.Front();
+        removed.Remove(*pe);
+        delete pe->event;
+        delete pe;
+    }
+}
+
+void ThreadData::moveObject(CObject* object, ThreadData* target) {
+    // Only the object's own thread moves it, so this cannot change under us
+    ThreadData* old = object->thread_data_.load(std::memory_order_acquire);
+    if (old == target) {
+        return;
+    }
+    target->ref();
+    bool moved;
+    {
+        std::scoped_lock lock(old->pending_mutex_, target->pending_mutex_);
+        // Links whatever is still in flight for the object while it is ours
+        old->drainIncoming();
+        object->thread_data_.store(target, std::memory_order_release);
+        object->thread_id_.store(target->id(), std::memory_order_release);
+        PostedEventList& events = object->posted_events_;
+        moved = !events.Empty();
+        for (auto it = events.Begin(); it != events.End(); ++it) {
+            old->pending_.Remove(*it);
+            target->pending_.PushBack(*it);
+        }
+        target->queued_.fetch_add(events.Size(), std::memory_order_release);
+        old->queued_.fetch_sub(events.Size(), std::memory_order_release);
+    }
+    if (moved) {
+        target->wakeUp();
+    }
+    old->deref();
+}
+
+std::size_t ThreadData::processPostedEvents(std::size_t maxEvents) {
+    std::size_t budget;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        drainIncoming();
+        budget = pending_.Size();
+    }
+    if (maxEvents != 0 && maxEvents < budget) {
+        budget = maxEvents;
+    }
+
+    std::size_t delivered = 0;
+    for (; budget > 0; --budget) {
+        std::unique_ptr<PostedEvent> pe;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            if (pending_.Empty()) {
+                // Removed meanwhile
+                break;
+            }
+            pe.reset(&pending_.Front());
+            unlink(pe.get());
+        }
+        std::unique_ptr<Event> event(pe->event);
+
+        if (!pe->receiver) {
+            static_cast<MetaCallEvent*>(event.get())->call()();
+        } else if (pe->receiver->thread_data_.load(std::memory_order_acquire) != this) {
+            // The receiver moved after the event was popped
+            postEvent(pe->receiver, event.release());
+            continue;
+        } else {
+            // For DeferredDelete the receiver deletes itself; the event is
+            // still ours to free
+            CObject::sendEvent(pe->receiver, event.get());
+        }
+        ++delivered;
+    }
+    return delivered;
+}
+
+EventDispatcher* ThreadData::dispatcher() const {
+    spin_rw_mutex::scoped_lock lock(dispatcher_mutex_, false);
+    return dispatcher_;
+}
+
+EventDispatcher* ThreadData::setDispatcher(EventDispatcher* dispatcher) {
+    spin_rw_mutex::scoped_lock lock(dispatcher_mutex_);
+    EventDispatcher* previous = dispatcher_;
+    dispatcher_ = dispatcher;
+    return previous;
+}
+
+void ThreadData::wakeUp() const {
+    // Shared: the loop cannot drop its dispatcher while it is being woken
+    spin_rw_mutex::scoped_lock lock(dispatcher_mutex_, false);
+    if (dispatcher_) {
+        dispatcher_->wakeUp();
+    }
+}
+
+EventLoop::EventLoop(EventDispatcher* dispatcher)
+    : dispatcher_(dispatcher ? dispatcher : createPlatformDispatcher()),
+      ownsDispatcher_(dispatcher == nullptr) {}
+
+EventLoop::~EventLoop() {
+    if (ownsDispatcher_) {
+        delete dispatcher_;
+    }
+}
+
+EventDispatcher* EventLoop::createPlatformDispatcher(CObject* parent) {
+#if defined(__linux__) && !defined(CODEKNIFE_NO_GLIB)
+    return EventDispatcherLinux::createForThread(parent);
+#elif defined(__linux__)
+    return new EventDispatcherEpoll(parent);
+#elif defined(_WIN32)
+    return new EventDispatcherWin(parent);
+#else
+    (void)parent;
+    return nullptr;
+#endif
+}
+
+void EventLoop::setDispatcher(EventDispatcher* dispatcher) {
+    if (ownsDispatcher_ && dispatcher_ != dispatcher) {
+        delete dispatcher_;
+    }
+    dispatcher_ = dispatcher;
+    ownsDispatcher_ = false;
+}
+
+int EventLoop::exec() {
+    if (!dispatcher_) {
+        return -1;
+    }
+    ThreadData* data = ThreadData::current();
+
+    // Undone on the way out, including by an exception from a handler
+    struct Running {
+        EventLoop* loop;
+        ThreadData* data;
+        EventDispatcher* previous;
+
+        bool coalesced;
+
+        Running(EventLoop* l, ThreadData* d)
+            : loop(l), data(d), previous(d->setDispatcher(l->dispatcher_)), coalesced(d->coalescing()) {
+            data->setCoalescing(loop->coalescing());
+            loop->thread_.store(data, std::memory_order_release);
+            // Posts made before this dispatcher was installed woke nobody
+            if (data->hasPendingEvents()) {
+                loop->dispatcher_->wakeUp();
+            }
+        }
+        ~Running() {
+            loop->thread_.store(nullptr, std::memory_order_release);
+            data->setCoalescing(coalesced);
+            data->setDispatcher(previous);
+        }
+    } running(this, data);
+
+    quit_.store(false, std::memory_order_relaxed);
+    returnCode_.store(0, std::memory_order_relaxed);
+    using Clock = std::chrono::steady_clock;
+    static metrics::Histogram& pollNanos = metrics::Registry::Instance().GetHistogram("event_loop.poll_ns");
+    static metrics::Histogram& dispatchNanos = metrics::Registry::Instance().GetHistogram("event_loop.dispatch_ns");
+    static metrics::Counter& eventsMetric = metrics::Registry::Instance().GetCounter("event_loop.events");
+    metrics::Tracer& tracer = metrics::Tracer::Instance();
+    while (!quit_.load(std::memory_order_acquire)) {
+        Clock::time_point start = Clock::now();
+        dispatcher_->processEvents();
+        Clock::time_point polled = Clock::now();
+
+        std::size_t delivered = 0;
+        if (data->hasPendingEvents()) {
+            delivered = data->processPostedEvents(budget_.load(std::memory_order_relaxed));
+        }
+        if (data->hasPendingEvents()) {
+            // Left over or posted meanwhile: the next poll must not block
+            dispatcher_->wakeUp();
+            counters_.budgetExhausted.fetch_add(1, std::memory_order_relaxed);
+        }
+        Clock::time_point done = Clock::now();
+
+        counters_.iterations.fetch_add(1, std::memory_order_relaxed);
+        counters_.events.fetch_add(delivered, std::memory_order_relaxed);
+        counters_.coalesced.fetch_add(data->takeCoalesced(), std::memory_order_relaxed);
+        if (delivered > counters_.maxEventsPerIteration.load(std::memory_order_relaxed)) {
+            counters_.maxEventsPerIteration.store(delivered, std::memory_order_relaxed);
+        }
+        counters_.ioNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(polled - start).count(),
+                                    std::memory_order_relaxed);
+        counters_.eventNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(done - polled).count(),
+                                       std::memory_order_relaxed);
+
+        // The same clock readings feed the process-wide metrics and spans
+        pollNanos.Record(metrics::ToNanos(polled) - metrics::ToNanos(start));
+        dispatchNanos.Record(metrics::ToNanos(done) - metrics::ToNanos(polled));
+        eventsMetric.Add(delivered);
+        if (tracer.Enabled()) {
+            tracer.Record("event_loop", "poll", metrics::ToNanos(start), metrics::ToNanos(polled));
+            tracer.Record("event_loop", "dispatch", metrics::ToNanos(polled), metrics::ToNanos(done));
+        }
+    }
+    return returnCode_.load(std::memory_order_relaxed);
+}
+
+void EventLoop::exit(int returnCode) {
+    // The loop may return and be destroyed as soon as quit_ is set, so
+    // wake it through its thread, which cannot drop the dispatcher while
+    // wakeUp() runs
+    epoch_guard guard = ThreadData::pin();
+    ThreadData* running = thread_.load(std::memory_order_acquire);
+    returnCode_.store(returnCode, std::memory_order_relaxed);
+    quit_.store(true, std::memory_order_release);
+    if (running) {
+        running->wakeUp();
+    }
+}
+
+void EventLoop::setCoalescing(bool enabled) {
+    coalesce_.store(enabled, std::memory_order_relaxed);
+    epoch_guard guard = ThreadData::pin();
+    if (ThreadData* running = thread_.load(std::memory_order_acquire)) {
+        running->setCoalescing(enabled);
+    }
+}
+
+EventLoop::Stats EventLoop::stats() const {
+    Stats stats;
+    stats.iterations = counters_.iterations.load(std::memory_order_relaxed);
+    stats.events = counters_.events.load(std::memory_order_relaxed);
+    stats.coalesced = counters_.coalesced.load(std::memory_order_relaxed);
+    stats.maxEventsPerIteration = counters_.maxEventsPerIteration.load(std::memory_order_relaxed);
+    stats.budgetExhausted = counters_.budgetExhausted.load(std::memory_order_relaxed);
+    stats.ioTime = std::chrono::nanoseconds(counters_.ioNanos.load(std::memory_order_relaxed));
+    stats.eventTime = std::chrono::nanoseconds(counters_.eventNanos.load(std::memory_order_relaxed));
+    return stats;
+}
+
+void EventLoop::resetStats() {
+    counters_.iterations.store(0, std::memory_order_relaxed);
+    counters_.events.store(0, std::memory_order_relaxed);
+    counters_.coalesced.store(0, std::memory_order_relaxed);
+    counters_.maxEventsPerIteration.store(0, std::memory_order_relaxed);
+    counters_.budgetExhausted.store(0, std::memory_order_relaxed);
+    counters_.ioNanos.store(0, std::memory_order_relaxed);
+    counters_.eventNanos.store(0, std::memory_order_relaxed);
+}
+
+} // namespace SAK
@@ -1,11 +1,66 @@
 
 #include "meta_object.hpp"
 #include "cobject.hpp"
+#include "spin_mutex.hpp"
 #include <algorithm>
+#include <deque>
 #include <string>
 
 namespace SAK {
 
+namespace {
+
+struct NameTable {
+    spin_rw_mutex mutex;
+    std::unordered_map<std::string_view, int> ids;
+    // Owns the text; a deque never moves its elements
+    std::deque<std::string> names;
+};
+
+// Function-local so registration from static initializers is safe
+NameTable& nameTable() {
+    static NameTable table;
+    return table;
+}
+
+} // namespace
+
+int MetaNames::intern(std::string_view name) {
+    NameTable& table = nameTable();
+    {
+        spin_rw_mutex::scoped_lock lock(table.mutex, false);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) {
+            return it->second;
+        }
+    }
+    spin_rw_mutex::scoped_lock lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+    int id = static_cast<int>(table.names.size());
+    const std::string& stored = table.names.emplace_back(name);
+    table.ids.emplace(stored, id);
+    return id;
+}
+
+int MetaNames::find(std::string_view name) {
+    NameTable& table = nameTable();
+    spin_rw_mutex::scoped_lock lock(table.mutex, false);
+    auto it = table.ids.find(name);
+    return it != table.ids.end() ? it->second : kInvalid;
+}
+
+const char* MetaNames::name(int id) {
+    NameTable& table = nameTable();
+    spin_rw_mutex::scoped_lock lock(table.mutex, false);
+    if (id < 0 || id >= static_cast<int>(table.names.size())) {
+        return nullptr;
+    }
+    return table.names[id].c_str();
+}
+
 MetaObject::MetaObject(const char* className, const MetaObject* parent, FactoryFunc factory, 
                       const std::vector<MetaProperty>& properties, 
                       const std::vector<MetaMethod>& methods, 
@@ -20,49 +75,72 @@ CObject* MetaObject::createInstance() const {
     return nullptr;
 }
 
-const MetaProperty* MetaObject::findProperty(const std::string& name) const {
-    auto it = std::find_if(properties_.begin(), properties_.end(),
-        [&name](const MetaProperty& prop) { return name == prop.name(); });
-
-    if (it != properties_.end()) {
-        return &(*it);
-    }
-
-    if (parent_) {
-        return parent_->findProperty(name);
-    }
+const MetaObject::Index& MetaObject::index() const {
+    std::call_once(index_once_, [this]() {
+        auto index = std::make_unique<Index>();
+        // emplace() keeps the first entry, so the nearest class wins
+        for (const MetaObject* meta = this; meta; meta = meta->parent_) {
+            for (const auto& prop : meta->properties_) {
+                index->ids.emplace(prop.name(), prop.id());
+                index->properties.emplace(prop.id(), &prop);
+            }
+            for (const auto& method : meta->methods_) {
+                index->ids.emplace(method.name(), method.id());
+                index->methods.emplace(method.id(), &method);
+            }
+            for (const auto& signal : meta->signals_) {
+                index->ids.emplace(signal.name(), signal.id());
+                index->signals.emplace(signal.id(), &signal);
+            }
+        }
+        index_ = std::move(index);
+    });
+    return *index_;
+}
 
-    return nullptr;
+int MetaObject::memberId(std::string_view name) const {
+    const auto& ids = index().ids;
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : MetaNames::kInvalid;
 }
 
-const MetaMethod* MetaObject::findMethod(const std::string& name) const {
-    auto it = std::find_if(methods_.begin(), methods_.end(),
-        [&name](const MetaMethod& method) { return name == method.name(); });
-    
-    if (it != methods_.end()) {
-        return &(*it);
-    }
+const MetaProperty* MetaObject::findProperty(std::string_view name) const {
+    return findProperty(memberId(name));
+}
 
-    if (parent_) {
-        return parent_->findMethod(name);
+const MetaProperty* MetaObject::findProperty(int id) const {
+    if (id == MetaNames::kInvalid) {
+        return nullptr;
     }
+    const auto& properties = index().properties;
+    auto it = properties.find(id);
+    return it != properties.end() ? it->second : nullptr;
+}
 
-    return nullptr;
+const MetaMethod* MetaObject::findMethod(std::string_view name) const {
+    return findMethod(memberId(name));
 }
 
-const MetaSignal* MetaObject::findSignal(const std::string& name) const {
-    auto it = std::find_if(signals_.begin(), signals_.end(),
-        [&name](const MetaSignal& signal) { return name == signal.name(); });
-    
-    if (it != signals_.end()) {
-        return &(*it);
+const MetaMethod* MetaObject::findMethod(int id) const {
+    if (id == MetaNames::kInvalid) {
+        return nullptr;
     }
+    const auto& methods = index().methods;
+    auto it = methods.find(id);
+    return it != methods.end() ? it->second : nullptr;
+}
 
-    if (parent_) {
-        return parent_->findSignal(name);
-    }
+const MetaSignal* MetaObject::findSignal(std::string_view name) const {
+    return findSignal(memberId(name));
+}
 
-    return nullptr;
+const MetaSignal* MetaObject::findSignal(int id) const {
+    if (id == MetaNames::kInvalid) {
+        return nullptr;
+    }
+    const auto& signals = index().signals;
+    auto it = signals.find(id);
+    return it != signals.end() ? it->second : nullptr;
 }
 
 bool MetaObject::inherits(const MetaObject* metaObject) const {
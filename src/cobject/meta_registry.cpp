@@ -1,45 +1,124 @@
-
 #include "meta_registry.hpp"
 #include "meta_object.hpp"
+#include "hash.hpp"
 
 namespace SAK {
 
+MetaFactory::MetaFactory(const MetaObject* metaObject) : meta_object_(metaObject) {
+    if (!metaObject || !metaObject->factory()) {
+        return;
+    }
+    const RawFactory* raw = metaObject->factory().target<RawFactory>();
+    if (raw && *raw) {
+        raw_ = *raw;
+    } else {
+        factory_ = &metaObject->factory();
+    }
+}
+
 MetaRegistry& MetaRegistry::instance() {
     static MetaRegistry instance;
     return instance;
 }
 
+MetaRegistry::MetaRegistry() {
+    tables_.push_back(std::make_unique<Table>(kInitialCapacity));
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+uint64_t MetaRegistry::hashOf(std::string_view className) {
+    return hash::Hash64(className.data(), className.size());
+}
+
+MetaRegistry::Slot& MetaRegistry::probe(Table& table, std::string_view className, uint64_t hash) {
+    for (size_t i = hash & table.mask;; i = (i + 1) & table.mask) {
+        Slot& slot = table.slots[i];
+        const MetaObject* meta = slot.meta.load(std::memory_order_relaxed);
+        if (!meta || (slot.hash.load(std::memory_order_relaxed) == hash && className == meta->className())) {
+            return slot;
+        }
+    }
+}
+
+void MetaRegistry::fill(Table& table, Slot& slot, const MetaObject* metaObject, uint64_t hash) {
+    if (!slot.meta.load(std::memory_order_relaxed)) {
+        slot.hash.store(hash, std::memory_order_relaxed);
+        ++table.used;
+    }
+    // Release: readers that see the class see its hash
+    slot.meta.store(metaObject, std::memory_order_release);
+}
+
 void MetaRegistry::registerMeta(const MetaObject* metaObject) {
     if (!metaObject) return;
+    std::string_view className = metaObject->className();
+    uint64_t hash = hashOf(className);
     std::lock_guard<std::mutex> lock(mutex_);
-    metaMap_[metaObject->className()] = metaObject;
+    Table* table = table_.load(std::memory_order_relaxed);
+    Slot* slot = &probe(*table, className, hash);
+    if (!slot->meta.load(std::memory_order_relaxed) && (table->used + 1) * 2 > table->mask + 1) {
+        // Readers keep probing the old table until the bigger one is out
+        auto grown = std::make_unique<Table>((table->mask + 1) * 2);
+        for (size_t i = 0; i <= table->mask; ++i) {
+            const MetaObject* meta = table->slots[i].meta.load(std::memory_order_relaxed);
+            if (meta) {
+                uint64_t h = table->slots[i].hash.load(std::memory_order_relaxed);
+                Slot& moved = probe(*grown, meta->className(), h);
+                moved.hash.store(h, std::memory_order_relaxed);
+                moved.meta.store(meta, std::memory_order_relaxed);
+            }
+        }
+        grown->used = table->used;
+        table = grown.get();
+        tables_.push_back(std::move(grown));
+        slot = &probe(*table, className, hash);
+        fill(*table, *slot, metaObject, hash);
+        table_.store(table, std::memory_order_release);
+        return;
+    }
+    fill(*table, *slot, metaObject, hash);
 }
 
-const MetaObject* MetaRegistry::findMeta(const std::string& className) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = metaMap_.find(className);
-    return it != metaMap_.end() ? it->second : nullptr;
+const MetaObject* MetaRegistry::findMeta(std::string_view className) const {
+    uint64_t hash = hashOf(className);
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        const Slot& slot = table->slots[i];
+        const MetaObject* meta = slot.meta.load(std::memory_order_acquire);
+        if (!meta) {
+            return nullptr;
+        }
+        if (slot.hash.load(std::memory_order_relaxed) == hash && className == meta->className()) {
+            return meta;
+        }
+    }
 }
 
-CObject* MetaRegistry::createInstance(const std::string& className) const {
+CObject* MetaRegistry::createInstance(std::string_view className) const {
     const MetaObject* metaObject = findMeta(className);
     if (!metaObject) return nullptr;
     return metaObject->createInstance();
 }
 
+MetaFactory MetaRegistry::factory(std::string_view className) const {
+    return MetaFactory(findMeta(className));
+}
+
 std::vector<std::string> MetaRegistry::registeredClasses() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    const Table* table = table_.load(std::memory_order_relaxed);
     std::vector<std::string> classes;
-    for (const auto& it : metaMap_) {
-        classes.push_back(it.first);
+    for (size_t i = 0; i <= table->mask; ++i) {
+        const MetaObject* meta = table->slots[i].meta.load(std::memory_order_relaxed);
+        if (meta) {
+            classes.push_back(meta->className());
+        }
     }
     return classes;
 }
 
-bool MetaRegistry::isClassRegistered(const std::string& className) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return metaMap_.find(className) != metaMap_.end();
+bool MetaRegistry::isClassRegistered(std::string_view className) const {
+    return findMeta(className) != nullptr;
 }
 
 } // namespace SAK
-
@@ -0,0 +1,167 @@
+#include "arena.hpp"
+#include "memory_pool_v2.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SAK {
+
+Arena::Arena(size_t block_size)
+    : block_size_(std::max(block_size, kHeaderSize + alignof(std::max_align_t))) {
+}
+
+Arena::~Arena() {
+    FreeBlocks(head_);
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : block_size_(other.block_size_),
+      head_(other.head_),
+      ptr_(other.ptr_),
+      end_(other.end_),
+      bytes_used_(other.bytes_used_),
+      bytes_reserved_(other.bytes_reserved_),
+      block_count_(other.block_count_) {
+    other.head_ = nullptr;
+    other.ptr_ = nullptr;
+    other.end_ = nullptr;
+    other.bytes_used_ = 0;
+    other.bytes_reserved_ = 0;
+    other.block_count_ = 0;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        FreeBlocks(head_);
+        block_size_ = other.block_size_;
+        head_ = other.head_;
+        ptr_ = other.ptr_;
+        end_ = other.end_;
+        bytes_used_ = other.bytes_used_;
+        bytes_reserved_ = other.bytes_reserved_;
+        block_count_ = other.block_count_;
+        other.head_ = nullptr;
+        other.ptr_ = nullptr;
+        other.end_ = nullptr;
+        other.bytes_used_ = 0;
+        other.bytes_reserved_ = 0;
+        other.block_count_ = 0;
+    }
+    return *this;
+}
+
+Arena::Block* Arena::NewBlock(size_t size) {
+    void* mem = MemoryPoolV2::GetInstance().Allocate(size);
+    if (!mem) return nullptr;
+    Block* block = static_cast<Block*>(mem);
+    block->size = size;
+    bytes_reserved_ += size;
+    ++block_count_;
+    return block;
+}
+
+void Arena::FreeBlocks(Block* block) {
+    MemoryPoolV2& pool = MemoryPoolV2::GetInstance();
+    while (block) {
+        Block* next = block->next;
+        bytes_reserved_ -= block->size;
+        --block_count_;
+        pool.Deallocate(block, block->size);
+        block = next;
+    }
+}
+
+void* Arena::AllocateSlow(size_t bytes, size_t alignment) {
+    // Worst-case padding needed to align the first byte after the header
+    size_t padding = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+    size_t needed = kHeaderSize + padding + bytes;
+
+    // Requests that would waste most of a standard block get their own block,
+    // linked behind the current one so bump allocation can continue
+    if (needed > block_size_ / 4 && head_) {
+        Block* block = NewBlock(needed);
+        if (!block) return nullptr;
+        block->next = head_->next;
+        head_->next = block;
+        uintptr_t start = reinterpret_cast<uintptr_t>(block) + kHeaderSize;
+        uintptr_t aligned = (start + alignment - 1) & ~(alignment - 1);
+        bytes_used_ += bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    Block* block = NewBlock(std::max(block_size_, needed));
+    if (!block) return nullptr;
+    block->next = head_;
+    head_ = block;
+    ptr_ = reinterpret_cast<char*>(block) + kHeaderSize;
+    end_ = reinterpret_cast<char*>(block) + block->size;
+    return Allocate(bytes, alignment);
+}
+
+void* Arena::Copy(const void* data, size_t size, size_t alignment) {
+    void* mem = Allocate(size, alignment);
+    if (mem && size) {
+        std::memcpy(mem, data, size);
+    }
+    return mem;
+}
+
+void Arena::Reset() {
+    bytes_used_ = 0;
+
+    // Keep one standard-sized block; oversized ones are always released
+    Block* keep = nullptr;
+    Block** link = &head_;
+    while (*link) {
+        if ((*link)->size == block_size_) {
+            keep = *link;
+            *link = keep->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    FreeBlocks(head_);
+
+    head_ = keep;
+    if (keep) {
+        keep->next = nullptr;
+        ptr_ = reinterpret_cast<char*>(keep) + kHeaderSize;
+        end_ = reinterpret_cast<char*>(keep) + keep->size;
+    } else {
+        ptr_ = nullptr;
+        end_ = nullptr;
+    }
+}
+
+ConcurrentArena::ConcurrentArena(size_t block_size) : arena_(block_size) {
+    // A chunk fills a standard block, header included
+    size_t overhead = Arena::kHeaderSize + sizeof(Chunk);
+    chunk_size_ = arena_.BlockSize() > overhead ? arena_.BlockSize() - overhead : 0;
+}
+
+void* ConcurrentArena::AllocateSlow(size_t bytes, size_t alignment) {
+    spin_mutex::scoped_lock lock(mutex_);
+    void* ptr;
+    if (bytes + alignment - 1 > chunk_size_ / 4) {
+        // Would waste most of a chunk; the arena gives it a block of its own
+        ptr = arena_.Allocate(bytes, alignment);
+    } else if (!(ptr = TryBump(chunk_.load(std::memory_order_relaxed), bytes, alignment))) {
+        // Nobody installed a fresh chunk while we waited for the lock
+        void* mem = arena_.Allocate(sizeof(Chunk) + chunk_size_, alignof(Chunk));
+        if (!mem) {
+            return nullptr;
+        }
+        Chunk* chunk = new (mem) Chunk;
+        chunk->offset.store(0, std::memory_order_relaxed);
+        chunk->size = chunk_size_;
+        ptr = TryBump(chunk, bytes, alignment);
+        chunk_.store(chunk, std::memory_order_release);
+    }
+    if (ptr) {
+        bytes_used_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    bytes_reserved_.store(arena_.BytesReserved(), std::memory_order_relaxed);
+    return ptr;
+}
+
+} // namespace SAK
@@ -0,0 +1,193 @@
+#include "block.hpp"
+#include "coding.hpp"
+
+#include <algorithm>
+
+namespace SAK {
+
+int CompareKeyTs(const char* a, size_t a_size, uint64_t a_ts, const char* b, size_t b_size, uint64_t b_ts) {
+    int cmp = ByteBuffer::Compare(a, a_size, b, b_size);
+    if (cmp != 0) {
+        return cmp;
+    }
+    if (a_ts != b_ts) {
+        return a_ts > b_ts ? -1 : 1;
+    }
+    return 0;
+}
+
+BlockBuilder::BlockBuilder(size_t restart_interval)
+    : restart_interval_(std::max<size_t>(restart_interval, 1)) {
+    restarts_.push_back(0);
+}
+
+void BlockBuilder::Add(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value) {
+    size_t shared = 0;
+    if (counter_ < restart_interval_) {
+        size_t limit = std::min(last_key_.size(), key.Size());
+        while (shared < limit && last_key_[shared] == key.Data()[shared]) {
+            ++shared;
+        }
+    } else {
+        restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+        counter_ = 0;
+    }
+    size_t unshared = key.Size() - shared;
+
+    coding::PutVarint32(buffer_, static_cast<uint32_t>(shared));
+    coding::PutVarint32(buffer_, static_cast<uint32_t>(unshared));
+    coding::PutVarint32(buffer_, static_cast<uint32_t>(value.Size()));
+    buffer_.insert(buffer_.end(), key.Data() + shared, key.Data() + key.Size());
+    coding::PutFixed64(buffer_, ts);
+    buffer_.insert(buffer_.end(), value.Data(), value.Data() + value.Size());
+
+    last_key_.assign(key.Data(), key.Size());
+    ++counter_;
+    ++entries_;
+}
+
+size_t BlockBuilder::EstimatedSize() const noexcept {
+    return buffer_.size() + (finished_ ? 0 : (restarts_.size() + 1) * sizeof(uint32_t));
+}
+
+const std::vector<uint8_t>& BlockBuilder::Finish() {
+    if (!finished_) {
+        for (uint32_t restart : restarts_) {
+            coding::PutFixed32(buffer_, restart);
+        }
+        coding::PutFixed32(buffer_, static_cast<uint32_t>(restarts_.size()));
+        finished_ = true;
+    }
+    return buffer_;
+}
+
+void BlockBuilder::Reset() {
+    buffer_.clear();
+    restarts_.assign(1, 0);
+    last_key_.clear();
+    counter_ = 0;
+    entries_ = 0;
+    finished_ = false;
+}
+
+Block::Block(ByteBuffer data, size_t restarts_offset, uint32_t num_restarts)
+    : data_(std::move(data)),
+      restarts_offset_(restarts_offset),
+      num_restarts_(num_restarts) {
+}
+
+std::shared_ptr<const Block> Block::Decode(ByteBuffer contents) {
+    size_t size = contents.Size();
+    if (size < sizeof(uint32_t)) {
+        return nullptr;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(contents.Data());
+    uint32_t num_restarts = coding::GetFixed32(bytes + size - sizeof(uint32_t));
+    if (num_restarts == 0 || num_restarts > (size - sizeof(uint32_t)) / sizeof(uint32_t)) {
+        return nullptr;
+    }
+    size_t restarts_offset = size - (size_t(num_restarts) + 1) * sizeof(uint32_t);
+    for (uint32_t i = 0; i < num_restarts; ++i) {
+        if (coding::GetFixed32(bytes + restarts_offset + i * sizeof(uint32_t)) > restarts_offset) {
+            return nullptr;
+        }
+    }
+    return std::shared_ptr<const Block>(new Block(std::move(contents), restarts_offset, num_restarts));
+}
+
+uint32_t Block::RestartOffset(uint32_t index) const noexcept {
+    return coding::GetFixed32(Bytes() + restarts_offset_ + index * sizeof(uint32_t));
+}
+
+BlockIterator::BlockIterator(std::shared_ptr<const Block> block) : block_(std::move(block)) {
+    SeekToFirst();
+}
+
+void BlockIterator::SeekToRestart(uint32_t index) {
+    key_.clear();
+    corrupted_ = false;
+    next_offset_ = block_->RestartOffset(index);
+}
+
+void BlockIterator::SeekToFirst() {
+    SeekToRestart(0);
+    valid_ = ParseNext();
+}
+
+void BlockIterator::Next() {
+    valid_ = ParseNext();
+}
+
+void BlockIterator::Seek(const ByteBuffer& key, uint64_t ts) {
+    const uint8_t* bytes = block_->Bytes();
+    const uint8_t* limit = bytes + block_->restarts_offset_;
+
+    // Last restart point whose key is before (key, ts); restart keys are whole
+    uint32_t left = 0;
+    uint32_t right = block_->num_restarts_ - 1;
+    while (left < right) {
+        uint32_t mid = left + (right - left + 1) / 2;
+        const uint8_t* p = bytes + block_->RestartOffset(mid);
+        uint32_t shared;
+        uint32_t unshared;
+        uint32_t value_size;
+        if (!(p = coding::GetVarint32(p, limit, shared)) || !(p = coding::GetVarint32(p, limit, unshared)) ||
+            !(p = coding::GetVarint32(p, limit, value_size)) || shared != 0 ||
+            static_cast<size_t>(limit - p) < size_t(unshared) + sizeof(uint64_t)) {
+            valid_ = false;
+            corrupted_ = true;
+            return;
+        }
+        uint64_t restart_ts = coding::GetFixed64(p + unshared);
+        if (CompareKeyTs(reinterpret_cast<const char*>(p), unshared, restart_ts, key.Data(), key.Size(), ts) < 0) {
+            left = mid;
+        } else {
+            right = mid - 1;
+        }
+    }
+
+    SeekToRestart(left);
+    while ((valid_ = ParseNext())) {
+        if (CompareKeyTs(key_.data(), key_.size(), ts_, key.Data(), key.Size(), ts) >= 0) {
+            return;
+        }
+    }
+}
+
+bool BlockIterator::ParseNext() {
+    const uint8_t* bytes = block_->Bytes();
+    const uint8_t* limit = bytes + block_->restarts_offset_;
+    const uint8_t* p = bytes + next_offset_;
+    if (p >= limit) {
+        return false;
+    }
+    uint32_t shared;
+    uint32_t unshared;
+    uint32_t value_size;
+    if (!(p = coding::GetVarint32(p, limit, shared)) || !(p = coding::GetVarint32(p, limit, unshared)) ||
+        !(p = coding::GetVarint32(p, limit, value_size)) || shared > key_.size() ||
+        static_cast<size_t>(limit - p) < size_t(unshared) + sizeof(uint64_t) + value_size) {
+        corrupted_ = true;
+        return false;
+    }
+    key_.resize(shared);
+    key_.append(reinterpret_cast<const char*>(p), unshared);
+    key_whole_ = shared == 0;
+    key_offset_ = static_cast<size_t>(p - bytes);
+    p += unshared;
+    ts_ = coding::GetFixed64(p);
+    p += sizeof(uint64_t);
+    value_offset_ = static_cast<size_t>(p - bytes);
+    value_size_ = value_size;
+    next_offset_ = value_offset_ + value_size;
+    return true;
+}
+
+ByteBuffer BlockIterator::Key() const {
+    if (key_whole_) {
+        return block_->data_.Slice(key_offset_, key_.size());
+    }
+    return ByteBuffer(key_.data(), key_.size());
+}
+
+} // namespace SAK
@@ -0,0 +1,190 @@
+#include "block_cache.hpp"
+
+#include <algorithm>
+
+namespace SAK {
+
+size_t BlockCache::KeyHash::operator()(const Key& key) const noexcept {
+    // splitmix64 finalizer; offsets of one file differ little, so mix them well
+    uint64_t h = key.file_id * 0x9e3779b97f4a7c15ull ^ key.offset;
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return static_cast<size_t>(h);
+}
+
+BlockCache::BlockCache(size_t capacity, size_t shard_bits)
+    : capacity_(capacity),
+      shard_bits_(std::min<size_t>(shard_bits, 16)),
+      shard_capacity_(capacity >> shard_bits_),
+      protected_capacity_(shard_capacity_ / 5 * 4),
+      shards_(new Shard[size_t(1) << shard_bits_]) {
+}
+
+BlockCache::~BlockCache() = default;
+
+std::shared_ptr<BlockCache> BlockCache::Create(const Options& options) {
+    if (options.block_cache_size == 0) {
+        return nullptr;
+    }
+    return std::make_shared<BlockCache>(options.block_cache_size, options.block_cache_shard_bits);
+}
+
+BlockCache::Shard& BlockCache::ShardFor(const Key& key) noexcept {
+    // Top bits pick the shard; the map buckets use the low bits
+    size_t h = KeyHash()(key);
+    return shards_[shard_bits_ ? h >> (sizeof(size_t) * 8 - shard_bits_) : 0];
+}
+
+std::shared_ptr<const Block> BlockCache::Lookup(uint64_t file_id, uint64_t offset) {
+    Key key{file_id, offset};
+    Shard& shard = ShardFor(key);
+    spin_mutex::scoped_lock lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    Promote(shard, it->second);
+    return it->second.block;
+}
+
+void BlockCache::Insert(uint64_t file_id, uint64_t offset, std::shared_ptr<const Block> block,
+                        CachePriority priority) {
+    if (!block) {
+        return;
+    }
+    size_t charge = block->Size() + kEntryOverhead;
+    Key key{file_id, offset};
+    Shard& shard = ShardFor(key);
+    spin_mutex::scoped_lock lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) {
+        Remove(shard, it);
+    }
+    if (charge > shard_capacity_) {
+        Publish(shard);
+        return;
+    }
+
+    Entry& entry = shard.map[key];
+    entry.key = key;
+    entry.block = std::move(block);
+    entry.charge = charge;
+    if (priority == CachePriority::High) {
+        shard.probation.PushFront(entry);
+    } else {
+        shard.probation.PushBack(entry);
+    }
+    shard.usage += charge;
+    EvictToCapacity(shard);
+    Publish(shard);
+}
+
+void BlockCache::Erase(uint64_t file_id, uint64_t offset) {
+    Key key{file_id, offset};
+    Shard& shard = ShardFor(key);
+    spin_mutex::scoped_lock lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) {
+        Remove(shard, it);
+        Publish(shard);
+    }
+}
+
+void BlockCache::EraseFile(uint64_t file_id) {
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        Shard& shard = shards_[i];
+        spin_mutex::scoped_lock lock(shard.mutex);
+        for (auto it = shard.map.begin(); it != shard.map.end();) {
+            auto next = std::next(it);
+            if (it->first.file_id == file_id) {
+                Remove(shard, it);
+            }
+            it = next;
+        }
+        Publish(shard);
+    }
+}
+
+void BlockCache::Unlink(Shard& shard, Entry& entry) noexcept {
+    if (entry.is_protected) {
+        shard.protected_.Remove(entry);
+        shard.protected_usage -= entry.charge;
+    } else {
+        shard.probation.Remove(entry);
+    }
+}
+
+void BlockCache::Remove(Shard& shard, Map::iterator it) noexcept {
+    Unlink(shard, it->second);
+    shard.usage -= it->second.charge;
+    shard.map.erase(it);
+}
+
+void BlockCache::Promote(Shard& shard, Entry& entry) noexcept {
+    Unlink(shard, entry);
+    entry.is_protected = true;
+    shard.protected_.PushFront(entry);
+    shard.protected_usage += entry.charge;
+    // Demote the coldest protected blocks to probation, where they get another chance
+    while (shard.protected_usage > protected_capacity_ && shard.protected_.Size() > 1) {
+        Entry& coldest = shard.protected_.Back();
+        shard.protected_.Remove(coldest);
+        shard.protected_usage -= coldest.charge;
+        coldest.is_protected = false;
+        shard.probation.PushFront(coldest);
+    }
+}
+
+void BlockCache::EvictToCapacity(Shard& shard) noexcept {
+    while (shard.usage > shard_capacity_) {
+        List& victims = shard.probation.Empty() ? shard.protected_ : shard.probation;
+        Entry& victim = victims.Back();
+        Unlink(shard, victim);
+        shard.usage -= victim.charge;
+        shard.map.erase(victim.key);
+    }
+}
+
+void BlockCache::Publish(Shard& shard) noexcept {
+    shard.published_usage.store(shard.usage, std::memory_order_relaxed);
+    shard.count.store(shard.map.size(), std::memory_order_relaxed);
+}
+
+size_t BlockCache::Usage() const noexcept {
+    size_t usage = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        usage += shards_[i].published_usage.load(std::memory_order_relaxed);
+    }
+    return usage;
+}
+
+size_t BlockCache::Count() const noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        count += shards_[i].count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+uint64_t BlockCache::Hits() const noexcept {
+    uint64_t hits = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        hits += shards_[i].hits.load(std::memory_order_relaxed);
+    }
+    return hits;
+}
+
+uint64_t BlockCache::Misses() const noexcept {
+    uint64_t misses = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        misses += shards_[i].misses.load(std::memory_order_relaxed);
+    }
+    return misses;
+}
+
+} // namespace SAK
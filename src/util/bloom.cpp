@@ -0,0 +1,94 @@
+#include "bloom.hpp"
+#include "coding.hpp"
+#include "hash.hpp"
+
+#include <cstring>
+
+namespace SAK {
+
+namespace {
+
+constexpr size_t kWords = BloomFilter::kBlockBytes / sizeof(uint32_t);
+
+// Odd multipliers, one per word of a block
+constexpr uint32_t kSalt[kWords] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// The block for `hash`, by a multiply-shift range reduction of its high half
+inline size_t BlockIndex(uint64_t hash, size_t num_blocks) noexcept {
+    return static_cast<size_t>(((hash >> 32) * num_blocks) >> 32);
+}
+
+// One bit per word from the low half of the hash
+inline void BlockMask(uint64_t hash, uint32_t (&mask)[kWords]) noexcept {
+    uint32_t key = static_cast<uint32_t>(hash);
+    for (size_t i = 0; i < kWords; ++i) {
+        mask[i] = uint32_t(1) << ((key * kSalt[i]) >> 27);
+    }
+}
+
+} // namespace
+
+uint64_t BloomFilter::Hash(const char* data, size_t size) noexcept {
+    return hash::Hash64(data, size);
+}
+
+BloomFilterBuilder::BloomFilterBuilder(size_t bits_per_key) : bits_per_key_(bits_per_key ? bits_per_key : 1) {
+}
+
+void BloomFilterBuilder::AddKey(const char* data, size_t size) {
+    uint64_t hash = BloomFilter::Hash(data, size);
+    if (hashes_.empty() || hashes_.back() != hash) {
+        hashes_.push_back(hash);
+    }
+}
+
+std::vector<uint8_t> BloomFilterBuilder::Finish() {
+    if (hashes_.empty()) {
+        return {};
+    }
+    size_t bits = hashes_.size() * bits_per_key_;
+    size_t num_blocks = (bits + BloomFilter::kBlockBytes * 8 - 1) / (BloomFilter::kBlockBytes * 8);
+    std::vector<uint32_t> words(num_blocks * kWords, 0);
+    for (uint64_t hash : hashes_) {
+        uint32_t mask[kWords];
+        BlockMask(hash, mask);
+        uint32_t* block = words.data() + BlockIndex(hash, num_blocks) * kWords;
+        for (size_t i = 0; i < kWords; ++i) {
+            block[i] |= mask[i];
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(num_blocks * BloomFilter::kBlockBytes + 1);
+    for (uint32_t word : words) {
+        coding::PutFixed32(out, word);
+    }
+    out.push_back(BloomFilter::kFormat);
+    Reset();
+    return out;
+}
+
+BloomFilter::BloomFilter(ByteBuffer contents) : contents_(std::move(contents)) {
+    size_t size = contents_.Size();
+    if (size > 1 && (size - 1) % kBlockBytes == 0 && static_cast<uint8_t>(contents_.Data()[size - 1]) == kFormat) {
+        num_blocks_ = (size - 1) / kBlockBytes;
+    }
+}
+
+bool BloomFilter::MayContainHash(uint64_t hash) const noexcept {
+    if (num_blocks_ == 0) {
+        return true;
+    }
+    uint32_t mask[kWords];
+    BlockMask(hash, mask);
+    const uint8_t* block =
+        reinterpret_cast<const uint8_t*>(contents_.Data()) + BlockIndex(hash, num_blocks_) * kBlockBytes;
+    uint32_t missing = 0;
+    for (size_t i = 0; i < kWords; ++i) {
+        missing |= mask[i] & ~coding::GetFixed32(block + i * sizeof(uint32_t));
+    }
+    return missing == 0;
+}
+
+} // namespace SAK
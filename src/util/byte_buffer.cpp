@@ -1,14 +1,65 @@
 #include "byte_buffer.hpp"
+#include "arena.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <new>
 #include <utility>
 
 namespace SAK {
 
+namespace {
+
+/**
+ * Hands std::allocate_shared one allocation with `extra` bytes after its
+ * control block, and reports where they start, so the buffer bytes and
+ * the reference count share a single allocation.
+ */
+template <typename T>
+struct TrailingBytesAllocator {
+    using value_type = T;
+
+    TrailingBytesAllocator(size_t extra_bytes, char** trailing_bytes) noexcept
+        : extra(extra_bytes),
+          trailing(trailing_bytes) {
+    }
+
+    template <typename U>
+    TrailingBytesAllocator(const TrailingBytesAllocator<U>& other) noexcept
+        : extra(other.extra),
+          trailing(other.trailing) {
+    }
+
+    T* allocate(size_t n) {
+        size_t head = n * sizeof(T);
+        char* p = static_cast<char*>(::operator new(head + extra));
+        *trailing = p + head;
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const TrailingBytesAllocator<U>& other) const noexcept {
+        return extra == other.extra;
+    }
+
+    template <typename U>
+    bool operator!=(const TrailingBytesAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+    size_t extra;
+    // Only written by the single allocate() call
+    char** trailing;
+};
+
+} // namespace
+
 ByteBuffer::ByteBuffer()
-    : data_(std::make_shared<std::vector<char>>()),
-      offset_(0),
-      size_(0) {
+    : size_(0) {
 }
 
 ByteBuffer::ByteBuffer(const char* cstr)
@@ -16,165 +67,160 @@ ByteBuffer::ByteBuffer(const char* cstr)
 }
 
 ByteBuffer::ByteBuffer(const char* data, size_t size)
-    : data_(std::make_shared<std::vector<char>>(data, data + size)),
-      offset_(0),
-      size_(size) {
+    : size_(0) {
+    Assign(data, size);
 }
 
 ByteBuffer::ByteBuffer(const uint8_t* data, size_t size)
-    : data_(std::make_shared<std::vector<char>>(reinterpret_cast<const char*>(data),
-                                             reinterpret_cast<const char*>(data + size))),
-      offset_(0),
-      size_(size) {
+    : ByteBuffer(reinterpret_cast<const char*>(data), size) {
 }
 
 ByteBuffer::ByteBuffer(const std::string& str)
-    : data_(std::make_shared<std::vector<char>>(str.begin(), str.end())),
-      offset_(0),
-      size_(str.size()) {
+    : ByteBuffer(str.data(), str.size()) {
 }
 
 // Note: Removed string_view constructor to avoid C++20 compatibility issues
 
 ByteBuffer::ByteBuffer(const std::vector<uint8_t>& vec)
-    : data_(std::make_shared<std::vector<char>>(
-          reinterpret_cast<const char*>(vec.data()),
-          reinterpret_cast<const char*>(vec.data() + vec.size()))),
-      offset_(0),
-      size_(vec.size()) {
+    : ByteBuffer(reinterpret_cast<const char*>(vec.data()), vec.size()) {
+}
+
+ByteBuffer::ByteBuffer(std::vector<uint8_t>&& vec)
+    : size_(0) {
+    if (vec.size() <= kInlineCapacity) {
+        Assign(reinterpret_cast<const char*>(vec.data()), vec.size());
+        vec.clear();
+        return;
+    }
+    size_t size = vec.size();
+    auto storage = std::make_shared<std::vector<uint8_t>>(std::move(vec));
+    const char* bytes = reinterpret_cast<const char*>(storage->data());
+    AssignShared(std::shared_ptr<const char>(std::move(storage), bytes), 0, size);
+}
+
+ByteBuffer::ByteBuffer(std::shared_ptr<const char> data, size_t size)
+    : size_(0) {
+    if (!data) return;
+    if (size <= kInlineCapacity) {
+        Assign(data.get(), size);
+    } else {
+        AssignShared(std::move(data), 0, size);
+    }
+}
+
+ByteBuffer::ByteBuffer(Arena& arena, const char* data, size_t size)
+    : size_(0) {
+    if (size == 0) return;
+    const char* bytes = static_cast<const char*>(arena.Copy(data, size));
+    if (!bytes) throw std::bad_alloc();
+    // The control block is placed in the arena too; nothing is freed on release.
+    // Kept shared even when small, as the caller asked for arena storage
+    AssignShared(std::shared_ptr<const char>(bytes, [](const char*) {}, ArenaAllocator<char>(arena)), 0, size);
+}
+
+std::shared_ptr<const char> ByteBuffer::CopyToHeap(const char* data, size_t size) {
+    char* bytes = nullptr;
+    std::shared_ptr<char> owner = std::allocate_shared<char>(TrailingBytesAllocator<char>(size, &bytes));
+    std::memcpy(bytes, data, size);
+    return std::shared_ptr<const char>(std::move(owner), bytes);
+}
+
+void ByteBuffer::Assign(const char* data, size_t size) {
+    if (size <= kInlineCapacity) {
+        if (size) std::memcpy(inline_, data, size);
+        size_ = size;
+    } else {
+        AssignShared(CopyToHeap(data, size), 0, size);
+    }
+}
+
+void ByteBuffer::AssignShared(std::shared_ptr<const char> data, size_t offset, size_t size) noexcept {
+    new (&shared_) Shared{std::move(data), offset};
+    size_ = size | kSharedFlag;
 }
 
-ByteBuffer::ByteBuffer(const ByteBuffer& other)
-    : data_(other.data_),
-      offset_(other.offset_),
-      size_(other.size_) {
+void ByteBuffer::CopyFrom(const ByteBuffer& other) noexcept {
+    if (other.size_ & kSharedFlag) {
+        new (&shared_) Shared(other.shared_);
+    } else {
+        std::memcpy(inline_, other.inline_, kInlineCapacity);
+    }
+    size_ = other.size_;
 }
 
-ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
-    : data_(std::move(other.data_)),
-      offset_(other.offset_),
-      size_(other.size_) {
-    other.offset_ = 0;
+void ByteBuffer::MoveFrom(ByteBuffer& other) noexcept {
+    if (other.size_ & kSharedFlag) {
+        new (&shared_) Shared(std::move(other.shared_));
+        other.shared_.~Shared();
+    } else {
+        std::memcpy(inline_, other.inline_, kInlineCapacity);
+    }
+    size_ = other.size_;
     other.size_ = 0;
 }
 
+ByteBuffer::ByteBuffer(const ByteBuffer& other) {
+    CopyFrom(other);
+}
+
+ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept {
+    MoveFrom(other);
+}
+
 ByteBuffer& ByteBuffer::operator=(const ByteBuffer& other) {
     if (this != &other) {
-        data_ = other.data_;
-        offset_ = other.offset_;
-        size_ = other.size_;
+        Release();
+        CopyFrom(other);
     }
     return *this;
 }
 
 ByteBuffer& ByteBuffer::operator=(ByteBuffer&& other) noexcept {
     if (this != &other) {
-        data_ = std::move(other.data_);
-        offset_ = other.offset_;
-        size_ = other.size_;
-        
-        other.offset_ = 0;
-        other.size_ = 0;
+        Release();
+        MoveFrom(other);
     }
     return *this;
 }
 
-ByteBuffer::~ByteBuffer() = default;
-
-const char* ByteBuffer::Data() const {
-    if (!data_ || data_->empty()) {
-        return nullptr;
-    }
-    return data_->data() + offset_;
-}
-
-size_t ByteBuffer::Size() const {
-    return size_;
+ByteBuffer::~ByteBuffer() {
+    Release();
 }
 
 ByteBuffer ByteBuffer::Slice(size_t offset, size_t length) const {
-    if (offset >= size_) {
+    size_t size = Size();
+    if (offset >= size) {
         // Return empty buffer if offset is out of range
         return ByteBuffer();
     }
-    
+
     // Adjust length if it would exceed the buffer's bounds
-    length = std::min(length, size_ - offset);
-    
+    length = std::min(length, size - offset);
+
+    if (length <= kInlineCapacity) {
+        return ByteBuffer(Data() + offset, length);
+    }
     // Create a new buffer that shares the same underlying data
-    return ByteBuffer(data_, offset_ + offset, length);
+    return ByteBuffer(shared_.data, shared_.offset + offset, length);
 }
 
 ByteBuffer ByteBuffer::Clone() const {
     // Create a deep copy of the buffer
-    if (size_ == 0) {
-        return ByteBuffer();
-    }
-    
-    return ByteBuffer(Data(), size_);
+    return ByteBuffer(Data(), Size());
 }
 
 std::string ByteBuffer::ToString() const {
-    if (size_ == 0) {
+    size_t size = Size();
+    if (size == 0) {
         return std::string();
     }
-    
-    return std::string(Data(), size_);
-}
-
-bool ByteBuffer::operator==(const ByteBuffer& other) const {
-    if (size_ != other.size_) {
-        return false;
-    }
-    
-    if (size_ == 0) {
-        return true;
-    }
-    
-    return std::memcmp(Data(), other.Data(), size_) == 0;
-}
-
-bool ByteBuffer::operator!=(const ByteBuffer& other) const {
-    return !(*this == other);
-}
 
-bool ByteBuffer::operator<(const ByteBuffer& other) const {
-    const size_t min_size = std::min(size_, other.size_);
-    
-    if (min_size == 0) {
-        return size_ < other.size_;
-    }
-    
-    int cmp = std::memcmp(Data(), other.Data(), min_size);
-    
-    if (cmp != 0) {
-        return cmp < 0;
-    }
-    
-    return size_ < other.size_;
+    return std::string(Data(), size);
 }
 
-bool ByteBuffer::operator>(const ByteBuffer& other) const {
-    const size_t min_size = std::min(size_, other.size_);
-    
-    if (min_size == 0) {
-        return size_ > other.size_;
-    }
-    
-    int cmp = std::memcmp(Data(), other.Data(), min_size);
-    
-    if (cmp != 0) {
-        return cmp > 0;
-    }
-    
-    return size_ > other.size_;
-}
-
-ByteBuffer::ByteBuffer(std::shared_ptr<const std::vector<char>> data, size_t offset, size_t size)
-    : data_(std::move(data)),
-      offset_(offset),
-      size_(size) {
+ByteBuffer::ByteBuffer(std::shared_ptr<const char> data, size_t offset, size_t size)
+    : size_(0) {
+    AssignShared(std::move(data), offset, size);
 }
 
 } // namespace SAK
-
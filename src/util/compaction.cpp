@@ -0,0 +1,288 @@
+#include "compaction.hpp"
+#include "memtable.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace SAK {
+
+CompactionOptions::CompactionOptions(const Options& options)
+    : size_ratio_percent(options.simple_leveled_size_ratio_percent),
+      level0_file_num_compaction_trigger(options.simple_leveled_level0_file_num_compaction_trigger),
+      max_levels(options.simple_leveled_max_levels),
+      target_sst_size(options.target_sst_size),
+      block_size(options.block_size),
+      bloom_bits_per_key(options.bloom_bits_per_key),
+      rate_limit_bytes_per_sec(options.compaction_rate_limit_bytes_per_sec) {
+}
+
+uint64_t LevelState::LevelSize(size_t level) const {
+    uint64_t size = 0;
+    if (level < levels.size()) {
+        for (const auto& table : levels[level]) {
+            size += table->FileSize();
+        }
+    }
+    return size;
+}
+
+SimpleLeveledController::SimpleLeveledController(const CompactionOptions& options) : options_(options) {
+    options_.max_levels = std::max<size_t>(options_.max_levels, 1);
+}
+
+std::optional<CompactionTask> SimpleLeveledController::Pick(const LevelState& state) const {
+    if (state.levels.size() <= options_.max_levels) {
+        return std::nullopt;
+    }
+    auto task_for = [&](size_t upper) {
+        CompactionTask task;
+        task.upper_level = upper;
+        task.upper = state.levels[upper];
+        task.lower_level = upper + 1;
+        task.lower = state.levels[upper + 1];
+        task.bottom_level = upper + 1 == options_.max_levels;
+        return task;
+    };
+
+    if (!state.levels[0].empty() && state.levels[0].size() >= options_.level0_file_num_compaction_trigger) {
+        return task_for(0);
+    }
+    for (size_t level = 1; level < options_.max_levels; ++level) {
+        uint64_t upper = state.LevelSize(level);
+        if (upper == 0) {
+            continue;
+        }
+        uint64_t lower = state.LevelSize(level + 1);
+        if (lower * 100 < upper * options_.size_ratio_percent) {
+            return task_for(level);
+        }
+    }
+    return std::nullopt;
+}
+
+void SimpleLeveledController::Apply(LevelState& state, const CompactionTask& task,
+                                    std::vector<std::shared_ptr<SsTable>> outputs) {
+    auto& upper = state.levels[task.upper_level];
+    upper.erase(std::remove_if(upper.begin(), upper.end(),
+                               [&](const std::shared_ptr<SsTable>& table) {
+                                   return std::find(task.upper.begin(), task.upper.end(), table) != task.upper.end();
+                               }),
+                upper.end());
+    state.levels[task.lower_level] = std::move(outputs);
+}
+
+MergeIterator::MergeIterator(const std::vector<std::shared_ptr<SsTable>>& tables) {
+    iterators_.reserve(tables.size());
+    for (const auto& table : tables) {
+        iterators_.emplace_back(table);
+        if (iterators_.back().Valid()) {
+            heap_.push_back(iterators_.size() - 1);
+        } else {
+            corrupted_ = corrupted_ || iterators_.back().Corrupted();
+        }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return After(a, b); });
+}
+
+bool MergeIterator::After(size_t a, size_t b) const {
+    const SsTableIterator& x = iterators_[a];
+    const SsTableIterator& y = iterators_[b];
+    int cmp = CompareKeyTs(x.KeyData(), x.KeySize(), x.Timestamp(), y.KeyData(), y.KeySize(), y.Timestamp());
+    return cmp != 0 ? cmp > 0 : a > b;
+}
+
+void MergeIterator::Next() {
+    auto after = [this](size_t a, size_t b) { return After(a, b); };
+    std::pop_heap(heap_.begin(), heap_.end(), after);
+    SsTableIterator& it = iterators_[heap_.back()];
+    it.Next();
+    if (it.Valid()) {
+        std::push_heap(heap_.begin(), heap_.end(), after);
+    } else {
+        corrupted_ = corrupted_ || it.Corrupted();
+        heap_.pop_back();
+    }
+}
+
+RateLimiter::RateLimiter(uint64_t bytes_per_sec)
+    : bytes_per_sec_(bytes_per_sec),
+      available_(static_cast<double>(bytes_per_sec)),
+      last_(Clock::now()) {
+}
+
+void RateLimiter::Request(size_t bytes) {
+    if (bytes_per_sec_ == 0) {
+        return;
+    }
+    double rate = static_cast<double>(bytes_per_sec_);
+    std::chrono::duration<double> wait{0};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+        available_ = std::min(available_ + elapsed * rate, rate);
+        available_ -= static_cast<double>(bytes);
+        if (available_ < 0) {
+            wait = std::chrono::duration<double>(-available_ / rate);
+        }
+    }
+    if (wait.count() > 0) {
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+CompactionScheduler::CompactionScheduler(const CompactionOptions& options, thread::ThreadPool& pool, Hooks hooks,
+                                         std::shared_ptr<BlockCache> cache)
+    : options_(options),
+      controller_(options),
+      pool_(pool),
+      hooks_(std::move(hooks)),
+      cache_(std::move(cache)),
+      limiter_(options.rate_limit_bytes_per_sec) {
+    state_.levels.resize(std::max<size_t>(options.max_levels, 1) + 1);
+}
+
+CompactionScheduler::~CompactionScheduler() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    idle_.wait(lock, [this] { return !running_; });
+}
+
+void CompactionScheduler::AddL0(std::shared_ptr<SsTable> table) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.levels[0].insert(state_.levels[0].begin(), std::move(table));
+    MaybeScheduleLocked();
+}
+
+LevelState CompactionScheduler::Levels() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+void CompactionScheduler::WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return !running_; });
+}
+
+void CompactionScheduler::MaybeScheduleLocked() {
+    if (running_ || stopping_ || error_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::optional<CompactionTask> task = controller_.Pick(state_);
+    if (!task) {
+        return;
+    }
+    running_ = true;
+    pool_.post(thread::TaskPriority::low, [this, task = std::move(*task)] { Run(task); });
+}
+
+void CompactionScheduler::Run(const CompactionTask& task) {
+    std::vector<std::shared_ptr<SsTable>> outputs;
+    bool ok = Compact(task, outputs);
+    std::vector<std::shared_ptr<SsTable>> obsolete;
+    if (ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SimpleLeveledController::Apply(state_, task, outputs);
+        obsolete = task.upper;
+        obsolete.insert(obsolete.end(), task.lower.begin(), task.lower.end());
+        compactions_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        obsolete = std::move(outputs);
+        error_.store(true, std::memory_order_release);
+    }
+
+    // Still marked running, so WaitIdle() returns only once the files are gone
+    for (const auto& table : obsolete) {
+        if (cache_) {
+            cache_->EraseFile(table->Id());
+        }
+        if (hooks_.obsolete) {
+            hooks_.obsolete(table);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+    MaybeScheduleLocked();
+    idle_.notify_all();
+}
+
+bool CompactionScheduler::Compact(const CompactionTask& task, std::vector<std::shared_ptr<SsTable>>& outputs) {
+    // Charge the limiter in chunks rather than per entry
+    constexpr size_t kChargeBytes = 64 * 1024;
+
+    const uint64_t watermark = hooks_.watermark ? hooks_.watermark() : kMaxTimestamp;
+    Options table_options;
+    table_options.block_size = options_.block_size;
+    table_options.bloom_bits_per_key = options_.bloom_bits_per_key;
+
+    std::vector<std::shared_ptr<SsTable>> inputs = task.upper;
+    inputs.insert(inputs.end(), task.lower.begin(), task.lower.end());
+    MergeIterator it(inputs);
+
+    std::optional<SsTableBuilder> builder;
+    auto finish_table = [&] {
+        std::pair<size_t, std::string> target = hooks_.new_table();
+        std::shared_ptr<SsTable> table = builder->Build(target.first, target.second, cache_);
+        builder.reset();
+        if (!table) {
+            return false;
+        }
+        outputs.push_back(std::move(table));
+        return true;
+    };
+
+    std::string current_key;
+    bool have_key = false;
+    uint64_t last_ts = 0;
+    bool kept_visible = false;  // The newest version at or below the watermark was seen
+    size_t pending = 0;
+    for (; it.Valid(); it.Next()) {
+        ByteBuffer key = it.Key();
+        uint64_t ts = it.Timestamp();
+        bool new_key = !have_key || key.Size() != current_key.size() ||
+                       std::memcmp(key.Data(), current_key.data(), key.Size()) != 0;
+        if (new_key) {
+            // Versions of one key stay in one table
+            if (builder && builder->EstimatedSize() >= options_.target_sst_size && !finish_table()) {
+                return false;
+            }
+            current_key.assign(key.Data(), key.Size());
+            have_key = true;
+            kept_visible = false;
+        } else if (ts == last_ts) {
+            continue;  // Same version in an older table
+        }
+        last_ts = ts;
+
+        ByteBuffer value = it.Value();
+        bool keep = true;
+        if (ts <= watermark) {
+            keep = !kept_visible && !(task.bottom_level && value.Empty());
+            kept_visible = true;
+        }
+        if (!keep) {
+            continue;
+        }
+        if (!builder) {
+            builder.emplace(table_options);
+        }
+        builder->Add(key, ts, value);
+        pending += key.Size() + value.Size() + sizeof(uint64_t);
+        if (pending >= kChargeBytes) {
+            limiter_.Request(pending);
+            bytes_written_.fetch_add(pending, std::memory_order_relaxed);
+            pending = 0;
+        }
+    }
+    if (it.Corrupted()) {
+        return false;
+    }
+    limiter_.Request(pending);
+    bytes_written_.fetch_add(pending, std::memory_order_relaxed);
+    return !builder || finish_table();
+}
+
+} // namespace SAK
@@ -2,9 +2,34 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <array>
+#include <mutex>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SAK_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(__aarch64__) && defined(__clang__)
+#define SAK_CRC32C_TARGET __attribute__((target("crc")))
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define SAK_CRC32C_TARGET __attribute__((target("+crc")))
+#else
+#define SAK_CRC32C_TARGET
+#endif
+
 namespace SAK {
 
 // Static variable initialization
@@ -12,51 +37,111 @@ std::array<uint32_t, 256> Crc32c::table0_ = {};
 std::array<uint32_t, 256> Crc32c::table1_ = {};
 std::array<uint32_t, 256> Crc32c::table2_ = {};
 std::array<uint32_t, 256> Crc32c::table3_ = {};
-bool Crc32c::initialized_ = false;
+std::array<std::array<uint32_t, 256>, 4> Crc32c::long_shift_ = {};
+std::array<std::array<uint32_t, 256>, 4> Crc32c::short_shift_ = {};
+Crc32c::ExtendFunc Crc32c::extend_ = nullptr;
+std::once_flag Crc32c::init_flag_;
 
-void Crc32c::Initialize() {
-    if (initialized_) {
-        return;
+namespace {
+
+inline uint64_t LoadU64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+bool CpuHasCrc32c() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("sse4.2");
+#elif defined(_M_X64) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#elif defined(__aarch64__) && defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(__aarch64__) && defined(__APPLE__)
+    return true;  // Every Apple arm64 core implements the CRC extension
+#else
+    return false;
+#endif
+}
+
+// Expands the action of a linear CRC operator on the 32 basis vectors into
+// four byte-indexed tables so it can be applied with four lookups.
+void BuildShiftTables(const uint32_t (&basis)[32], std::array<std::array<uint32_t, 256>, 4>& tables) {
+    for (uint32_t k = 0; k < 4; ++k) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t value = 0;
+            for (uint32_t bit = 0; bit < 8; ++bit) {
+                if (b & (1u << bit)) {
+                    value ^= basis[k * 8 + bit];
+                }
+            }
+            tables[k][b] = value;
+        }
     }
-    
-    // Generate CRC32C lookup tables
+}
+
+} // namespace
+
+void Crc32c::Initialize() {
+    std::call_once(init_flag_, &Crc32c::InitializeOnce);
+}
+
+void Crc32c::InitializeOnce() {
+    // Generate CRC32C lookup tables; tableN_ advances a byte through N extra zero bytes
     for (uint32_t i = 0; i < 256; i++) {
         uint32_t crc = i;
         for (uint32_t j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+            crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
         }
         table0_[i] = crc;
     }
-    
+
     for (uint32_t i = 0; i < 256; i++) {
-        uint32_t crc = table0_[i];
-        for (uint32_t j = 0; j < 3; j++) {
-            crc = table0_[crc & 0xff] ^ (crc >> 8);
-        }
-        table1_[i] = crc;
-        
-        crc = table0_[i];
-        for (uint32_t j = 0; j < 2; j++) {
-            crc = table0_[crc & 0xff] ^ (crc >> 8);
-        }
-        table2_[i] = crc;
-        
-        crc = table0_[i];
-        crc = table0_[crc & 0xff] ^ (crc >> 8);
-        table3_[i] = crc;
+        table1_[i] = (table0_[i] >> 8) ^ table0_[table0_[i] & 0xff];
+        table2_[i] = (table1_[i] >> 8) ^ table0_[table1_[i] & 0xff];
+        table3_[i] = (table2_[i] >> 8) ^ table0_[table2_[i] & 0xff];
     }
-    
-    initialized_ = true;
-}
 
-uint32_t Crc32c::Compute(const void* data, size_t length) {
-    if (!initialized_) {
-        Initialize();
+    // Shifting a register past N zero bytes is linear, so it is fully described
+    // by its effect on each single-bit register value.
+    uint32_t long_basis[32];
+    uint32_t short_basis[32];
+    std::vector<uint8_t> zeros(kLongBlock, 0);
+    for (uint32_t bit = 0; bit < 32; ++bit) {
+        long_basis[bit] = ExtendSoftware(1u << bit, zeros.data(), kLongBlock);
+        short_basis[bit] = ExtendSoftware(1u << bit, zeros.data(), kShortBlock);
+    }
+    BuildShiftTables(long_basis, long_shift_);
+    BuildShiftTables(short_basis, short_shift_);
+
+    extend_ = &Crc32c::ExtendSoftware;
+    if (CpuHasCrc32c()) {
+#if defined(__x86_64__) || defined(_M_X64)
+        extend_ = &Crc32c::ExtendSse42;
+#elif defined(__aarch64__)
+        extend_ = &Crc32c::ExtendArmv8;
+#endif
     }
-    
-    const uint8_t* ptr = static_cast<const uint8_t*>(data);
-    uint32_t crc = ~0U;
-    
+}
+
+uint32_t Crc32c::ShiftLong(uint32_t crc) {
+    return long_shift_[0][crc & 0xff] ^
+           long_shift_[1][(crc >> 8) & 0xff] ^
+           long_shift_[2][(crc >> 16) & 0xff] ^
+           long_shift_[3][crc >> 24];
+}
+
+uint32_t Crc32c::ShiftShort(uint32_t crc) {
+    return short_shift_[0][crc & 0xff] ^
+           short_shift_[1][(crc >> 8) & 0xff] ^
+           short_shift_[2][(crc >> 16) & 0xff] ^
+           short_shift_[3][crc >> 24];
+}
+
+// Operates on the raw register value (no pre/post inversion).
+uint32_t Crc32c::ExtendSoftware(uint32_t crc, const uint8_t* ptr, size_t length) {
     // Process data in blocks of 4 bytes using the lookup tables
     while (length >= 4) {
         crc ^= ptr[0] | (static_cast<uint32_t>(ptr[1]) << 8) |
@@ -68,18 +153,180 @@ uint32_t Crc32c::Compute(const void* data, size_t length) {
         ptr += 4;
         length -= 4;
     }
-    
+
     // Process remaining bytes
     while (length-- > 0) {
         crc = table0_[(crc ^ *ptr++) & 0xff] ^ (crc >> 8);
     }
-    
-    return ~crc;  // Final inversion
+
+    return crc;
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+// Three independent crc32q streams hide the instruction's 3-cycle latency; the
+// lane results are merged with the precomputed shift tables.
+SAK_CRC32C_TARGET
+uint32_t Crc32c::ExtendSse42(uint32_t crc, const uint8_t* ptr, size_t length) {
+    uint64_t l = crc;
+
+    while (length > 0 && (reinterpret_cast<uintptr_t>(ptr) & 7) != 0) {
+        l = _mm_crc32_u8(static_cast<uint32_t>(l), *ptr++);
+        --length;
+    }
+
+    while (length >= 3 * kLongBlock) {
+        uint64_t l1 = 0;
+        uint64_t l2 = 0;
+        for (size_t i = 0; i < kLongBlock; i += 8) {
+            l = _mm_crc32_u64(l, LoadU64(ptr + i));
+            l1 = _mm_crc32_u64(l1, LoadU64(ptr + kLongBlock + i));
+            l2 = _mm_crc32_u64(l2, LoadU64(ptr + 2 * kLongBlock + i));
+        }
+        l = ShiftLong(ShiftLong(static_cast<uint32_t>(l)) ^ static_cast<uint32_t>(l1)) ^ static_cast<uint32_t>(l2);
+        ptr += 3 * kLongBlock;
+        length -= 3 * kLongBlock;
+    }
+
+    while (length >= 3 * kShortBlock) {
+        uint64_t l1 = 0;
+        uint64_t l2 = 0;
+        for (size_t i = 0; i < kShortBlock; i += 8) {
+            l = _mm_crc32_u64(l, LoadU64(ptr + i));
+            l1 = _mm_crc32_u64(l1, LoadU64(ptr + kShortBlock + i));
+            l2 = _mm_crc32_u64(l2, LoadU64(ptr + 2 * kShortBlock + i));
+        }
+        l = ShiftShort(ShiftShort(static_cast<uint32_t>(l)) ^ static_cast<uint32_t>(l1)) ^ static_cast<uint32_t>(l2);
+        ptr += 3 * kShortBlock;
+        length -= 3 * kShortBlock;
+    }
+
+    while (length >= 8) {
+        l = _mm_crc32_u64(l, LoadU64(ptr));
+        ptr += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        l = _mm_crc32_u8(static_cast<uint32_t>(l), *ptr++);
+        --length;
+    }
+
+    return static_cast<uint32_t>(l);
+}
+
+#elif defined(__aarch64__)
+
+SAK_CRC32C_TARGET
+uint32_t Crc32c::ExtendArmv8(uint32_t crc, const uint8_t* ptr, size_t length) {
+    while (length > 0 && (reinterpret_cast<uintptr_t>(ptr) & 7) != 0) {
+        crc = __crc32cb(crc, *ptr++);
+        --length;
+    }
+
+    while (length >= 3 * kLongBlock) {
+        uint32_t crc1 = 0;
+        uint32_t crc2 = 0;
+        for (size_t i = 0; i < kLongBlock; i += 8) {
+            crc = __crc32cd(crc, LoadU64(ptr + i));
+            crc1 = __crc32cd(crc1, LoadU64(ptr + kLongBlock + i));
+            crc2 = __crc32cd(crc2, LoadU64(ptr + 2 * kLongBlock + i));
+        }
+        crc = ShiftLong(ShiftLong(crc) ^ crc1) ^ crc2;
+        ptr += 3 * kLongBlock;
+        length -= 3 * kLongBlock;
+    }
+
+    while (length >= 8) {
+        crc = __crc32cd(crc, LoadU64(ptr));
+        ptr += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = __crc32cb(crc, *ptr++);
+        --length;
+    }
+
+    return crc;
+}
+
+#endif
+
+uint32_t Crc32c::Extend(uint32_t crc, const void* data, size_t length) {
+    Initialize();
+    return ~extend_(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+uint32_t Crc32c::Compute(const void* data, size_t length) {
+    return Extend(0, data, length);
 }
 
 uint32_t Crc32c::Compute(const std::vector<uint8_t>& data) {
     return Compute(data.data(), data.size());
 }
 
-}  // namespace SAK
+namespace {
 
+// Product of a 32x32 GF(2) matrix, one column per word, and a vector
+uint32_t Gf2Times(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (; vector; vector >>= 1, ++matrix) {
+        if (vector & 1) {
+            sum ^= *matrix;
+        }
+    }
+    return sum;
+}
+
+void Gf2Square(uint32_t* square, const uint32_t* matrix) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = Gf2Times(matrix, matrix[n]);
+    }
+}
+
+}  // namespace
+
+uint32_t Crc32c::Combine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+    if (length2 == 0) {
+        return crc1;
+    }
+
+    // Operator appending one zero bit to the register, then squared up to
+    // one zero byte; the loop then applies 2^k bytes for each bit of length2
+    uint32_t even[32];
+    uint32_t odd[32];
+    odd[0] = kPolynomial;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = uint32_t(1) << (n - 1);
+    }
+    Gf2Square(even, odd);
+    Gf2Square(odd, even);
+
+    for (;;) {
+        Gf2Square(even, odd);
+        if (length2 & 1) {
+            crc1 = Gf2Times(even, crc1);
+        }
+        length2 >>= 1;
+        if (length2 == 0) {
+            break;
+        }
+        Gf2Square(odd, even);
+        if (length2 & 1) {
+            crc1 = Gf2Times(odd, crc1);
+        }
+        length2 >>= 1;
+        if (length2 == 0) {
+            break;
+        }
+    }
+    return crc1 ^ crc2;
+}
+
+bool Crc32c::IsHardwareAccelerated() {
+    Initialize();
+    return extend_ != &Crc32c::ExtendSoftware;
+}
+
+}  // namespace SAK
@@ -0,0 +1,161 @@
+#include "epoch.hpp"
+#include "_machine.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace SAK {
+
+epoch_guard& epoch_guard::operator=(epoch_guard&& other) noexcept {
+    if (this != &other) {
+        release();
+        domain_ = other.domain_;
+        slot_ = other.slot_;
+        other.domain_ = nullptr;
+    }
+    return *this;
+}
+
+void epoch_guard::release() noexcept {
+    if (domain_) {
+        epoch_domain::Slot& slot = domain_->slots_[slot_];
+        if (slot.holders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Release: the reads made under the guards happen before a free
+            slot.epoch.store(epoch_domain::IDLE, std::memory_order_release);
+        }
+        domain_ = nullptr;
+    }
+}
+
+epoch_domain::~epoch_domain() {
+    for (const Retired& retired : retired_) {
+        retired.free();
+    }
+}
+
+epoch_guard epoch_domain::pin() noexcept {
+    static std::atomic<std::size_t> next_home{0};
+    thread_local std::size_t home = next_home.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+    thread_local const char self = 0;
+
+    std::size_t index = home;
+    for (std::size_t probes = 1;; ++probes) {
+        Slot& slot = slots_[index];
+        // Join this thread's pin while it has holders. Should the slot have
+        // changed hands meanwhile, joining is still safe: any held slot keeps
+        // the epoch from moving past the one it published.
+        if (slot.owner.load(std::memory_order_relaxed) == &self) {
+            uint32_t holders = slot.holders.load(std::memory_order_relaxed);
+            while (holders != 0) {
+                if (slot.holders.compare_exchange_weak(holders, holders + 1, std::memory_order_seq_cst)) {
+                    return epoch_guard(this, index);
+                }
+            }
+        }
+        uint64_t idle = IDLE;
+        // A stale epoch is harmless: it only holds reclamation back longer
+        uint64_t current = epoch_.load(std::memory_order_seq_cst);
+        if (slot.epoch.compare_exchange_strong(idle, current, std::memory_order_seq_cst)) {
+            slot.owner.store(&self, std::memory_order_relaxed);
+            slot.holders.store(1, std::memory_order_release);
+            return epoch_guard(this, index);
+        }
+        index = (index + 1) % SLOTS;
+        if (probes % SLOTS == 0) {
+            // More pinned threads than slots: wait for one to leave
+            machine_pause(16);
+        }
+    }
+}
+
+void epoch_domain::retire(void* object, void (*deleter)(void*)) {
+    push_retired({object, deleter, nullptr, nullptr, 0});
+}
+
+void epoch_domain::retire(void* object, void (*deleter)(void*, void*), void* context) {
+    push_retired({object, nullptr, deleter, context, 0});
+}
+
+void epoch_domain::push_retired(const Retired& retired) {
+    bool due;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back(retired);
+        // Read after the caller unlinked the object
+        retired_.back().epoch = epoch_.load(std::memory_order_seq_cst);
+        due = ++since_collect_ >= COLLECT_INTERVAL;
+        if (due) {
+            since_collect_ = 0;
+        }
+    }
+    if (due) {
+        collect();
+    }
+}
+
+void epoch_domain::collect() {
+    uint64_t current = epoch_.load(std::memory_order_seq_cst);
+    if (try_advance(current)) {
+        ++current;
+    }
+    free_retired(current);
+}
+
+void epoch_domain::synchronize() {
+    // Two advances past the current epoch outlast every reader pinned now
+    uint64_t target = epoch_.load(std::memory_order_seq_cst) + 2;
+    for (;;) {
+        uint64_t current = epoch_.load(std::memory_order_seq_cst);
+        if (current >= target || (try_advance(current) && current + 1 >= target)) {
+            break;
+        }
+        if (epoch_.load(std::memory_order_seq_cst) == current) {
+            // A reader is still inside an older epoch
+            std::this_thread::yield();
+        }
+    }
+    free_retired(epoch_.load(std::memory_order_seq_cst));
+}
+
+void epoch_domain::purge() {
+    std::vector<Retired> all;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        all.swap(retired_);
+        since_collect_ = 0;
+    }
+    for (const Retired& retired : all) {
+        retired.free();
+    }
+}
+
+std::size_t epoch_domain::pending() const {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+}
+
+bool epoch_domain::try_advance(uint64_t current) {
+    for (const Slot& slot : slots_) {
+        uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+        if (epoch != IDLE && epoch != current) {
+            return false;
+        }
+    }
+    return epoch_.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+}
+
+void epoch_domain::free_retired(uint64_t current) {
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        auto safe = std::partition(retired_.begin(), retired_.end(),
+            [current](const Retired& retired) { return retired.epoch + 2 > current; });
+        ready.assign(safe, retired_.end());
+        retired_.erase(safe, retired_.end());
+    }
+    // Outside the lock: a deleter may retire further objects
+    for (const Retired& retired : ready) {
+        retired.free();
+    }
+}
+
+} // namespace SAK
@@ -1,15 +1,27 @@
 #include "file_object.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <string>
 #include <vector>
 
+#include "crc32c.hpp"
+#include "thread_pool.hpp"
+
 #ifdef _WIN32
 #include <windows.h>
 #include <io.h>
 #else
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -72,6 +84,84 @@ inline uint64_t FileSize(FileHandleType handle) {
     return static_cast<uint64_t>(size.QuadPart);
 }
 
+inline std::shared_ptr<const char> MapFile(FileHandleType handle, uint64_t size) {
+    if (!handle || size == 0 || size > std::numeric_limits<SIZE_T>::max()) {
+        return nullptr;
+    }
+    HANDLE mapping = ::CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping object alive
+    ::CloseHandle(mapping);
+    if (!view) {
+        return nullptr;
+    }
+    return std::shared_ptr<const char>(static_cast<const char*>(view),
+                                       [](const char* p) { ::UnmapViewOfFile(p); });
+}
+
+// Direct I/O is not supported here; `direct` is cleared
+inline FileHandleType OpenForWrite(const std::string& path, bool& direct) {
+    direct = false;
+    HANDLE hFile = ::CreateFileA(
+        path.c_str(),
+        GENERIC_WRITE,
+        0,
+        nullptr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    return (hFile == INVALID_HANDLE_VALUE) ? nullptr : hFile;
+}
+
+inline FileHandleType NoFile() {
+    return nullptr;
+}
+
+inline bool IsOpen(FileHandleType handle) {
+    return handle != nullptr;
+}
+
+inline void CloseFile(FileHandleType handle) {
+    ::CloseHandle(handle);
+}
+
+inline bool WriteAt(FileHandleType handle, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(len, size_t(1) << 30));
+        DWORD written = 0;
+        if (!::WriteFile(handle, data, chunk, &written, &overlapped) || written == 0) {
+            return false;
+        }
+        data += written;
+        len -= written;
+        offset += written;
+    }
+    return true;
+}
+
+inline bool DisableDirect(FileHandleType) {
+    return false;
+}
+
+inline void Reserve(FileHandleType, uint64_t, uint64_t) {}
+
+inline bool TruncateTo(FileHandleType handle, uint64_t size) {
+    LARGE_INTEGER liSize;
+    liSize.QuadPart = static_cast<LONGLONG>(size);
+    return ::SetFilePointerEx(handle, liSize, nullptr, FILE_BEGIN) && ::SetEndOfFile(handle);
+}
+
+inline bool SyncData(FileHandleType handle) {
+    return ::FlushFileBuffers(handle) != 0;
+}
+
 #else
 using FileHandleType = int;
 
@@ -103,7 +193,126 @@ inline uint64_t FileSize(FileHandleType fd) {
     }
     return static_cast<uint64_t>(st.st_size);
 }
+
+inline std::shared_ptr<const char> MapFile(FileHandleType fd, uint64_t size) {
+    if (fd < 0 || size == 0 || size > std::numeric_limits<size_t>::max()) {
+        return nullptr;
+    }
+    size_t len = static_cast<size_t>(size);
+    void* addr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::shared_ptr<const char>(static_cast<const char*>(addr),
+                                       [len](const char* p) { ::munmap(const_cast<char*>(p), len); });
+}
+
+// Falls back to buffered writes, clearing `direct`, where O_DIRECT is refused
+inline FileHandleType OpenForWrite(const std::string& path, bool& direct) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            return fd;
+        }
+    }
 #endif
+    direct = false;
+    int fd = ::open(path.c_str(), flags, 0644);
+    return (fd < 0) ? -1 : fd;
+}
+
+inline FileHandleType NoFile() {
+    return -1;
+}
+
+inline bool IsOpen(FileHandleType fd) {
+    return fd >= 0;
+}
+
+inline void CloseFile(FileHandleType fd) {
+    ::close(fd);
+}
+
+// Leaves errno set on failure
+inline bool WriteAt(FileHandleType fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Some filesystems accept O_DIRECT at open and refuse the writes
+inline bool DisableDirect(FileHandleType fd) {
+#ifdef O_DIRECT
+    int flags = ::fcntl(fd, F_GETFL);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0;
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+// Best effort: keeps the file contiguous and fails early when the disk is full
+inline void Reserve(FileHandleType fd, uint64_t offset, uint64_t len) {
+#if defined(__linux__)
+    ::fallocate(fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(len));
+#else
+    (void)fd;
+    (void)offset;
+    (void)len;
+#endif
+}
+
+inline bool TruncateTo(FileHandleType fd, uint64_t size) {
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+inline bool SyncData(FileHandleType fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+inline int ToMadvise(AccessHint hint) {
+    switch (hint) {
+    case AccessHint::Sequential: return MADV_SEQUENTIAL;
+    case AccessHint::Random: return MADV_RANDOM;
+    case AccessHint::WillNeed: return MADV_WILLNEED;
+    default: return MADV_NORMAL;
+    }
+}
+
+#ifndef __APPLE__
+inline int ToFadvise(AccessHint hint) {
+    switch (hint) {
+    case AccessHint::Sequential: return POSIX_FADV_SEQUENTIAL;
+    case AccessHint::Random: return POSIX_FADV_RANDOM;
+    case AccessHint::WillNeed: return POSIX_FADV_WILLNEED;
+    default: return POSIX_FADV_NORMAL;
+    }
+}
+#endif
+#endif
+
+// Offsets and lengths of direct writes are multiples of this
+constexpr size_t kWriteAlignment = 4096;
+
+inline size_t AlignUp(size_t value) {
+    return (value + kWriteAlignment - 1) / kWriteAlignment * kWriteAlignment;
+}
 }  // namespace
 
 class FileHandle {
@@ -176,6 +385,10 @@ private:
 struct FileObjectImpl {
     FileHandle handle;
     uint64_t size;
+
+    // Whole-file mapping, created by the first Map()
+    std::mutex map_mutex;
+    std::shared_ptr<const char> mapping;
     
     FileObjectImpl(FileHandle h, uint64_t s) : handle(std::move(h)), size(s) {}
 };
@@ -198,42 +411,348 @@ FileObject FileObject::Open(const std::string& path) {
 }
 
 std::vector<uint8_t> FileObject::Read(uint64_t offset, uint64_t len) const {
+    std::vector<uint8_t> buf(len);
+    if (!ReadInto(offset, buf.data(), buf.size())) {
+        return {};  // Return empty vector on read failure
+    }
+    return buf;
+}
+
+bool FileObject::ReadInto(uint64_t offset, uint8_t* dst, size_t len) const {
     if (!Valid()) {
-        return {};  // Return empty vector for invalid file
+        return false;
     }
-    
-    std::vector<uint8_t> buf(len);
-    
+
 #ifdef _WIN32
     HANDLE hFile = impl_->handle.Handle();
     if (hFile == nullptr || hFile == INVALID_HANDLE_VALUE) {
-        return {};
+        return false;
     }
     
     LARGE_INTEGER liOffset;
     liOffset.QuadPart = static_cast<LONGLONG>(offset);
     
     if (!::SetFilePointerEx(hFile, liOffset, nullptr, FILE_BEGIN)) {
-        return {};
+        return false;
     }
     
     DWORD bytesRead = 0;
-    if (!::ReadFile(hFile, buf.data(), static_cast<DWORD>(len), &bytesRead, nullptr) || 
+    if (!::ReadFile(hFile, dst, static_cast<DWORD>(len), &bytesRead, nullptr) || 
         bytesRead != len) {
-        return {};
+        return false;
     }
 #else
-    ssize_t n = ::pread(impl_->handle.Fd(), buf.data(), len, static_cast<off_t>(offset));
-    if (n < 0 || static_cast<uint64_t>(n) != len) {
-        return {};  // Return empty vector on read failure
+    while (len > 0) {
+        ssize_t n = ::pread(impl_->handle.Fd(), dst, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;  // Error, or end of file before `len` bytes
+        }
+        dst += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
     }
 #endif
-    
-    return buf;
+
+    return true;
+}
+
+ByteBuffer FileObject::Map(AccessHint hint) const {
+    if (!Valid()) {
+        return ByteBuffer();
+    }
+    std::shared_ptr<const char> mapping;
+    {
+        std::lock_guard<std::mutex> lock(impl_->map_mutex);
+        if (!impl_->mapping) {
+#ifdef _WIN32
+            impl_->mapping = MapFile(impl_->handle.Handle(), impl_->size);
+#else
+            impl_->mapping = MapFile(impl_->handle.Fd(), impl_->size);
+#endif
+        }
+        mapping = impl_->mapping;
+    }
+    if (!mapping) {
+        return ByteBuffer();
+    }
+    if (hint != AccessHint::Normal) {
+        Advise(hint);
+    }
+    return ByteBuffer(std::move(mapping), static_cast<size_t>(impl_->size));
+}
+
+void FileObject::Advise(AccessHint hint, uint64_t offset, uint64_t len) const {
+    if (!Valid() || offset >= impl_->size) {
+        return;
+    }
+    if (len == 0 || len > impl_->size - offset) {
+        len = impl_->size - offset;
+    }
+#ifdef _WIN32
+    // No equivalent of madvise for plain handles; the hints only help
+    (void)hint;
+#else
+    std::shared_ptr<const char> mapping;
+    {
+        std::lock_guard<std::mutex> lock(impl_->map_mutex);
+        mapping = impl_->mapping;
+    }
+    if (mapping) {
+        // madvise wants a page-aligned start
+        static const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        uint64_t start = offset - offset % page;
+        ::madvise(const_cast<char*>(mapping.get()) + start, static_cast<size_t>(offset + len - start),
+                  ToMadvise(hint));
+        return;
+    }
+#ifndef __APPLE__
+    ::posix_fadvise(impl_->handle.Fd(), static_cast<off_t>(offset), static_cast<off_t>(len), ToFadvise(hint));
+#endif
+#endif
+}
+
+struct FileWriterImpl {
+    struct Block {
+        uint8_t* data = nullptr;
+        size_t used = 0;
+        size_t index = 0;
+        uint32_t crc = 0;
+        // Tasks still reading the block: its write and its checksum
+        int pending = 0;
+    };
+
+    FileWriterImpl(const std::string& p, const FileWriterOptions& o) : path(p), options(o) {
+        options.block_size = AlignUp(std::max<size_t>(options.block_size, 1));
+        options.buffers = std::max<size_t>(options.buffers, 2);
+        bool use_direct = options.direct_io;
+        handle = OpenForWrite(path, use_direct);
+        direct.store(use_direct, std::memory_order_relaxed);
+    }
+
+    ~FileWriterImpl() {
+        if (current) {
+            Return(current);
+            current = nullptr;
+        }
+        WaitIdle();
+        if (IsOpen(handle)) {
+            CloseFile(handle);
+        }
+        for (const auto& block : blocks) {
+            ::operator delete(block->data, std::align_val_t(kWriteAlignment));
+        }
+    }
+
+    // A free block, allocating up to options.buffers; waits for one otherwise
+    Block* Acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (free_blocks.empty() && blocks.size() < options.buffers) {
+            auto block = std::make_unique<Block>();
+            block->data = static_cast<uint8_t*>(::operator new(options.block_size, std::align_val_t(kWriteAlignment)));
+            blocks.push_back(std::move(block));
+            return blocks.back().get();
+        }
+        returned.wait(lock, [this] { return !free_blocks.empty(); });
+        Block* block = free_blocks.back();
+        free_blocks.pop_back();
+        return block;
+    }
+
+    void Return(Block* block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        block->used = 0;
+        free_blocks.push_back(block);
+        returned.notify_all();
+    }
+
+    // Starts writing and checksumming a filled block
+    void Dispatch(Block* block) {
+        block->index = next_index++;
+        uint64_t offset = static_cast<uint64_t>(block->index) * options.block_size;
+        uint64_t end = offset + options.block_size;
+        if (options.preallocate && end > reserved) {
+            Reserve(handle, reserved, end + options.preallocate - reserved);
+            reserved = end + options.preallocate;
+        }
+        if (direct.load(std::memory_order_relaxed) && block->used < options.block_size) {
+            // The short last block is written padded, then trimmed by Finish()
+            std::memset(block->data + block->used, 0, AlignUp(block->used) - block->used);
+        }
+
+        block->pending = 2;
+        auto write = [this, block, offset] { Done(block, WriteBlock(*block, offset)); };
+        auto checksum = [this, block] {
+            block->crc = Crc32c::Compute(block->data, block->used);
+            Done(block, true);
+        };
+        if (!options.pool) {
+            write();
+            checksum();
+            return;
+        }
+        Post(write);
+        Post(checksum);
+    }
+
+    template <typename Task>
+    void Post(Task& task) {
+        try {
+            options.pool->post(task);
+        } catch (...) {
+            // A stopped pool takes no tasks
+            task();
+        }
+    }
+
+    bool WriteBlock(const Block& block, uint64_t offset) {
+        bool padded = direct.load(std::memory_order_relaxed);
+        if (WriteAt(handle, block.data, padded ? AlignUp(block.used) : block.used, offset)) {
+            return true;
+        }
+        if (padded && errno == EINVAL && DisableDirect(handle)) {
+            direct.store(false, std::memory_order_relaxed);
+            return WriteAt(handle, block.data, block.used, offset);
+        }
+        return false;
+    }
+
+    void Done(Block* block, bool ok) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ok) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+        if (--block->pending == 0) {
+            if (checksums.size() <= block->index) {
+                checksums.resize(block->index + 1);
+            }
+            checksums[block->index] = block->crc;
+            block->used = 0;
+            free_blocks.push_back(block);
+            returned.notify_all();
+        }
+    }
+
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        returned.wait(lock, [this] { return free_blocks.size() == blocks.size(); });
+    }
+
+    std::string path;
+    FileWriterOptions options;
+    FileHandleType handle;
+    std::atomic<bool> direct{false};
+    std::atomic<bool> failed{false};
+    bool finished = false;
+
+    std::mutex mutex;
+    std::condition_variable returned;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::vector<Block*> free_blocks;
+    std::vector<uint32_t> checksums;
+
+    // Owned by the appending thread
+    Block* current = nullptr;
+    uint64_t size = 0;
+    uint64_t reserved = 0;
+    size_t next_index = 0;
+    uint32_t checksum = 0;
+};
+
+FileWriter::FileWriter(const std::string& path, const FileWriterOptions& options)
+    : impl_(std::make_unique<FileWriterImpl>(path, options)) {}
+
+FileWriter::~FileWriter() = default;
+FileWriter::FileWriter(FileWriter&& other) noexcept = default;
+FileWriter& FileWriter::operator=(FileWriter&& other) noexcept = default;
+
+bool FileWriter::Append(const void* data, size_t len) {
+    if (!Valid() || impl_->finished) {
+        return false;
+    }
+    FileWriterImpl& writer = *impl_;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        if (!writer.current) {
+            writer.current = writer.Acquire();
+        }
+        FileWriterImpl::Block* block = writer.current;
+        size_t n = std::min(len, writer.options.block_size - block->used);
+        std::memcpy(block->data + block->used, bytes, n);
+        block->used += n;
+        writer.size += n;
+        bytes += n;
+        len -= n;
+        if (block->used == writer.options.block_size) {
+            writer.current = nullptr;
+            writer.Dispatch(block);
+        }
+    }
+    return !writer.failed.load(std::memory_order_relaxed);
+}
+
+FileObject FileWriter::Finish() {
+    if (!Valid() || impl_->finished) {
+        return FileObject();
+    }
+    FileWriterImpl& writer = *impl_;
+    if (writer.current) {
+        FileWriterImpl::Block* block = writer.current;
+        writer.current = nullptr;
+        if (block->used) {
+            writer.Dispatch(block);
+        } else {
+            writer.Return(block);
+        }
+    }
+    writer.WaitIdle();
+    writer.finished = true;
+
+    // Drops the padding and whatever was reserved past the end
+    bool ok = !writer.failed.load(std::memory_order_relaxed) && TruncateTo(writer.handle, writer.size);
+    if (ok && writer.options.sync) {
+        ok = SyncData(writer.handle);
+    }
+    CloseFile(writer.handle);
+    writer.handle = NoFile();
+    if (!ok) {
+        writer.failed.store(true, std::memory_order_relaxed);
+        return FileObject();
+    }
+
+    uint32_t crc = 0;
+    for (size_t i = 0; i < writer.checksums.size(); ++i) {
+        uint64_t length = i + 1 < writer.checksums.size() ? writer.options.block_size
+                                                          : writer.size - i * writer.options.block_size;
+        crc = Crc32c::Combine(crc, writer.checksums[i], length);
+    }
+    writer.checksum = crc;
+    return FileObject::Open(writer.path);
+}
+
+bool FileWriter::Valid() const noexcept {
+    return impl_ && (IsOpen(impl_->handle) || impl_->finished) && !impl_->failed.load(std::memory_order_relaxed);
+}
+
+uint64_t FileWriter::Size() const noexcept { return impl_ ? impl_->size : 0; }
+bool FileWriter::DirectIo() const noexcept { return impl_ && impl_->direct.load(std::memory_order_relaxed); }
+uint32_t FileWriter::Checksum() const noexcept { return impl_ ? impl_->checksum : 0; }
+
+std::vector<uint32_t> FileWriter::BlockChecksums() const {
+    if (!impl_) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->checksums;
 }
 
 bool FileObject::Valid() const noexcept { return impl_ != nullptr; }
 uint64_t FileObject::Size() const noexcept { return Valid() ? impl_->size : 0; }
+#ifndef _WIN32
+int FileObject::Fd() const noexcept { return Valid() ? impl_->handle.Fd() : -1; }
+#endif
 
 } // namespace SAK
 
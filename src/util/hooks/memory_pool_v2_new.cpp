@@ -0,0 +1,73 @@
+/**
+ * Replaces the global operator new/delete with MemoryPoolV2.
+ *
+ * Not part of the default build: enable the `pool_operator_new` option
+ * (`xmake f --pool_operator_new=y`) to link it into codeknife. Over-aligned
+ * (std::align_val_t) forms keep the default implementation.
+ */
+#include "memory_pool_v2.hpp"
+
+#include <new>
+
+namespace {
+
+void* PoolNew(std::size_t size) {
+    if (size == 0) size = 1;
+    for (;;) {
+        void* ptr = SAK::MemoryPoolV2::GetInstance().Allocate(size);
+        if (ptr) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* PoolNewNothrow(std::size_t size) noexcept {
+    try {
+        return PoolNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return PoolNew(size);
+}
+
+void* operator new[](std::size_t size) {
+    return PoolNew(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return PoolNewNothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return PoolNewNothrow(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr, size == 0 ? 1 : size);
+}
+
+void operator delete[](void* ptr, std::size_t size) noexcept {
+    SAK::MemoryPoolV2::GetInstance().Deallocate(ptr, size == 0 ? 1 : size);
+}
@@ -1,16 +1,36 @@
 #include "ipc_implement.hpp"
 #include "ipc_packet.hpp"
 #include "logger.hpp"
+#include "metrics.hpp"
 #include <thread>
 #include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <string>
+#include <algorithm>
+#include <cstring>
 
 namespace SAK {
 namespace ipc {
 
+namespace {
+
+constexpr size_t MAX_SEND_QUEUE = 1000;
+
+metrics::Counter& sendDrops() {
+    static metrics::Counter& drops = metrics::Registry::Instance().GetCounter("ipc.send_drops");
+    return drops;
+}
+
+void appendFrame(std::string& batch, std::string_view message) {
+    uint32_t length = static_cast<uint32_t>(message.size());
+    batch.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    batch.append(message.data(), message.size());
+}
+
+} // namespace
+
 IPCImplement::IPCImplement(const std::string& ipc_name, bool is_server)
     : ipc_name_(ipc_name), is_server_(is_server), running_(false), shared_memory_(nullptr) {}
 
@@ -34,6 +54,52 @@ void IPCImplement::setIsServer(bool is_server) {
     is_server_ = is_server;
 }
 
+void IPCImplement::setTransport(IPCTransport transport) {
+    if (running_) {
+        LOG_ERROR("Cannot set transport while running");
+        return;
+    }
+    shm_options_.transport = transport;
+}
+
+void IPCImplement::setSharedMemoryOptions(const IPCSharedMemoryOptions& options) {
+    if (running_) {
+        LOG_ERROR("Cannot set shared memory options while running");
+        return;
+    }
+    shm_options_ = options;
+}
+
+void IPCImplement::setEventDriven(bool event_driven) {
+    if (running_) {
+        LOG_ERROR("Cannot change event-driven mode while running");
+        return;
+    }
+    event_driven_ = event_driven;
+}
+
+void IPCImplement::setMessageHandler(std::function<void(std::string_view)> handler) {
+    if (running_) {
+        LOG_ERROR("Cannot set message handler while running");
+        return;
+    }
+    message_handler_ = std::move(handler);
+}
+
+int IPCImplement::notificationFd() const {
+    return notify_fd_;
+}
+
+void IPCImplement::setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    coalesce_delay_ = max_delay;
+    // A batch must fit in one ring write
+    coalesce_bytes_ = std::min(max_bytes, shm_options_.ring_size / 2);
+    if (coalesce_bytes_ == 0 && !coalesce_buffer_.empty()) {
+        takeCoalesced();
+    }
+}
+
 void IPCImplement::start() {
     if (ipc_name_.empty()) {
         LOG_ERROR("IPC name not set");
@@ -46,13 +112,25 @@ void IPCImplement::start() {
     }
 
     // Create shared memory
-    shared_memory_ = std::make_unique<IPCSharedMemory>(ipc_name_, is_server_);
+    shared_memory_ = std::make_unique<IPCSharedMemory>(ipc_name_, is_server_, shm_options_);
     if (!shared_memory_->Init()) {
         LOG_ERROR("Failed to initialize shared memory");
         shared_memory_.reset();
         return;
     }
 
+    if (event_driven_) {
+        notify_fd_ = shared_memory_->OpenNotifier();
+        if (notify_fd_ < 0) {
+            LOG_ERROR("Failed to open IPC notifier");
+            shared_memory_.reset();
+            return;
+        }
+        running_ = true;
+        LOG_INFO("IPC started event-driven (name=%s, is_server=%d, fd=%d)", ipc_name_.c_str(), is_server_, notify_fd_);
+        return;
+    }
+
     // Set running flag before starting threads
     running_ = true;
 
@@ -76,11 +154,17 @@ void IPCImplement::stop() {
         send_cv_.notify_all();
     }
 
-    // Wake up receiver thread if it's waiting
+    // Wake up receiver thread if it's waiting, and take the suspended
+    // receive() waiters; they are resumed empty once the threads are gone
+    std::deque<ReceiveWaiter> waiters;
     {
         std::lock_guard<std::mutex> lock(receive_mutex_);
+        waiters.swap(receive_waiters_);
         receive_cv_.notify_all();
     }
+    if (shared_memory_) {
+        shared_memory_->WakeReader();
+    }
 
     // Join threads with timeout handling to prevent infinite hang
     if (sender_thread_.joinable()) {
@@ -106,7 +190,12 @@ void IPCImplement::stop() {
         }
     }
 
-    // Clean up shared memory
+    for (auto& waiter : waiters) {
+        waiter.resume();
+    }
+
+    // Clean up shared memory; the notifier closes with it
+    notify_fd_ = -1;
     if (shared_memory_) {
         try {
             shared_memory_->Uninit();
@@ -139,25 +228,289 @@ bool IPCImplement::receiveMessage(std::string& message) {
     return true;
 }
 
+bool IPCImplement::suspendReceive(std::optional<std::string>* slot, std::function<void()> resume) {
+    std::lock_guard<std::mutex> lock(receive_mutex_);
+    if (!receive_queue_.empty()) {
+        *slot = std::move(receive_queue_.front());
+        receive_queue_.pop();
+        return false;
+    }
+    if (!running_) {
+        return false;
+    }
+
+    receive_waiters_.push_back({slot, std::move(resume)});
+    return true;
+}
+
 bool IPCImplement::sendMessage(const std::string& message) {
     if (!running_) {
         LOG_ERROR("IPC not running");
         return false;
     }
 
-    // Add message to send queue
-    {
-        std::lock_guard<std::mutex> lock(send_mutex_);
-        send_queue_.push(message);
+    std::unique_lock<std::mutex> lock(send_mutex_);
+    if (coalesce_bytes_ > 0) {
+        bool first = coalesce_buffer_.empty();
+        if (first) {
+            coalesce_deadline_ = std::chrono::steady_clock::now() + coalesce_delay_;
+        }
+        appendFrame(coalesce_buffer_, message);
+        if (coalesce_buffer_.size() >= coalesce_bytes_) {
+            takeCoalesced();
+        } else if (first && !event_driven_) {
+            // The sender thread now waits for the deadline
+            lock.unlock();
+            send_cv_.notify_one();
+        }
+        return true;
     }
 
-    // Notify sender thread
-    send_cv_.notify_one();
-
+    MessageType type = is_server_ ? MessageType::MSG_RESPONSE : MessageType::MSG_REQUEST;
+    if (!enqueueSend({type, message})) {
+        return false;
+    }
     LOG_DEBUG("Queued message for sending: %s", message.c_str());
     return true;
 }
 
+bool IPCImplement::sendBatch(const std::vector<std::string>& messages) {
+    if (!running_) {
+        LOG_ERROR("IPC not running");
+        return false;
+    }
+
+    size_t limit = shm_options_.ring_size / 2;
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    // Whatever is being coalesced was sent first
+    takeCoalesced();
+    std::string batch;
+    for (const std::string& message : messages) {
+        if (!batch.empty() && batch.size() + sizeof(uint32_t) + message.size() > limit) {
+            if (!enqueueSend({MessageType::MSG_BATCH, std::move(batch)})) {
+                return false;
+            }
+            batch.clear();
+        }
+        appendFrame(batch, message);
+    }
+    if (!batch.empty()) {
+        return enqueueSend({MessageType::MSG_BATCH, std::move(batch)});
+    }
+    return true;
+}
+
+void IPCImplement::flush() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    takeCoalesced();
+}
+
+void IPCImplement::takeCoalesced() {
+    if (coalesce_buffer_.empty()) {
+        return;
+    }
+    std::string batch;
+    batch.swap(coalesce_buffer_);
+    // Reserve what the next batch will need
+    coalesce_buffer_.reserve(batch.capacity());
+    enqueueSend({MessageType::MSG_BATCH, std::move(batch)});
+}
+
+bool IPCImplement::enqueueSend(PendingSend send) {
+    if (event_driven_) {
+        // Keep order: only bypass the queue when it is empty
+        if (send_queue_.empty() && writeMessage(send)) {
+            return true;
+        }
+        if (send_queue_.size() >= MAX_SEND_QUEUE) {
+            LOG_WARNING("Sending queue is full, discarding %u bytes", static_cast<uint32_t>(send.payload.size()));
+            sendDrops().Add();
+            return false;
+        }
+        send_queue_.push(std::move(send));
+        // Ask for a wake-up when the reader frees room, then retry in case
+        // it already did
+        shared_memory_->WatchForSpace();
+        flushSendQueue();
+        return true;
+    }
+
+    // Add message to send queue and notify sender thread
+    send_queue_.push(std::move(send));
+    send_cv_.notify_one();
+    return true;
+}
+
+bool IPCImplement::writeMessage(const PendingSend& send) {
+    static metrics::Histogram& send_ns = metrics::Registry::Instance().GetHistogram("ipc.send_ns");
+    static metrics::Counter& packets_sent = metrics::Registry::Instance().GetCounter("ipc.packets_sent");
+    static metrics::Counter& bytes_sent = metrics::Registry::Instance().GetCounter("ipc.bytes_sent");
+
+    const std::string& payload = send.payload;
+    bool written;
+    if (shared_memory_->GetTransport() == IPCTransport::spsc_ring) {
+        uint8_t* dest = shared_memory_->ReserveWrite(static_cast<uint32_t>(payload.size()));
+        if (!dest) {
+            return false;
+        }
+        std::memcpy(dest, payload.data(), payload.size());
+        written = shared_memory_->CommitWrite(send.type, 0, static_cast<uint32_t>(payload.size()));
+    } else {
+        IPCPacket packet(send.type, 0, payload.data(), static_cast<uint32_t>(payload.size()));
+        written = shared_memory_->WritePacket(packet);
+    }
+    if (written) {
+        // Queued to written, including any time spent waiting for ring space
+        send_ns.RecordSince(metrics::ToNanos(send.queued));
+        packets_sent.Add();
+        bytes_sent.Add(payload.size());
+    }
+    return written;
+}
+
+void IPCImplement::flushSendQueue() {
+    while (!send_queue_.empty() && writeMessage(send_queue_.front())) {
+        send_queue_.pop();
+    }
+}
+
+void IPCImplement::deliverMessage(std::string_view message) {
+    LOG_DEBUG("Received message: %.*s", static_cast<int>(message.size()), message.data());
+    if (message_handler_) {
+        message_handler_(message);
+        return;
+    }
+
+    // Hand the message to a suspended receive() if there is one, otherwise
+    // add it to the receive queue
+    std::function<void()> resume;
+    {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        if (!receive_waiters_.empty()) {
+            ReceiveWaiter waiter = std::move(receive_waiters_.front());
+            receive_waiters_.pop_front();
+            *waiter.slot = std::string(message);
+            resume = std::move(waiter.resume);
+        } else {
+            receive_queue_.push(std::string(message));
+        }
+    }
+
+    if (resume) {
+        resume();
+    } else {
+        // Notify any waiting threads
+        receive_cv_.notify_one();
+    }
+}
+
+void IPCImplement::deliverPayload(MessageType type, std::string_view payload) {
+    static metrics::Histogram& receive_ns = metrics::Registry::Instance().GetHistogram("ipc.receive_ns");
+    static metrics::Counter& packets_received = metrics::Registry::Instance().GetCounter("ipc.packets_received");
+
+    SAK_TRACE_SPAN("ipc", "deliver");
+    packets_received.Add();
+    // Handing the packet to handlers, waiters or the queue, recorded on return
+    struct DeliveryTimer {
+        metrics::Histogram& histogram;
+        uint64_t start = metrics::kEnabled ? metrics::NowNanos() : 0;
+        ~DeliveryTimer() { histogram.RecordSince(start); }
+    } timer{receive_ns};
+
+    if (type != MessageType::MSG_BATCH) {
+        if (!payload.empty()) {
+            deliverMessage(payload);
+        }
+        return;
+    }
+
+    std::vector<std::function<void()>> resumes;
+    bool queued = false;
+    {
+        std::unique_lock<std::mutex> lock(receive_mutex_, std::defer_lock);
+        if (!message_handler_) {
+            lock.lock();
+        }
+        size_t offset = 0;
+        while (offset < payload.size()) {
+            uint32_t length;
+            if (payload.size() - offset < sizeof(length)) {
+                LOG_ERROR("Truncated batch frame at offset %u", static_cast<uint32_t>(offset));
+                break;
+            }
+            std::memcpy(&length, payload.data() + offset, sizeof(length));
+            offset += sizeof(length);
+            if (length > payload.size() - offset) {
+                LOG_ERROR("Batch frame of %u bytes overruns the packet", length);
+                break;
+            }
+            std::string_view message = payload.substr(offset, length);
+            offset += length;
+
+            if (message_handler_) {
+                message_handler_(message);
+            } else if (!receive_waiters_.empty()) {
+                ReceiveWaiter waiter = std::move(receive_waiters_.front());
+                receive_waiters_.pop_front();
+                *waiter.slot = std::string(message);
+                resumes.push_back(std::move(waiter.resume));
+            } else {
+                receive_queue_.push(std::string(message));
+                queued = true;
+            }
+        }
+    }
+
+    for (auto& resume : resumes) {
+        resume();
+    }
+    if (queued) {
+        receive_cv_.notify_all();
+    }
+}
+
+void IPCImplement::processEvents() {
+    if (!running_.load() || !event_driven_ || !shared_memory_) {
+        return;
+    }
+
+    bool ring = shared_memory_->GetTransport() == IPCTransport::spsc_ring;
+    uint32_t channels = shared_memory_->GetChannelCount();
+    bool more = true;
+    while (more && running_.load()) {
+        for (uint32_t channel = 0; channel < channels; ++channel) {
+            if (ring) {
+                // Delivered straight from shared memory
+                PacketView view;
+                while (shared_memory_->PeekRead(&view, channel)) {
+                    deliverPayload(static_cast<MessageType>(view.header->msg_type),
+                                   std::string_view(reinterpret_cast<const char*>(view.payload), view.payload_len));
+                    shared_memory_->ReleaseRead(channel);
+                }
+            } else {
+                IPCPacket packet;
+                while (shared_memory_->ReadPacket(&packet, channel)) {
+                    deliverPayload(packet.GetMessageType(),
+                                   std::string_view(reinterpret_cast<const char*>(packet.GetPayload()),
+                                                    packet.GetPayloadLength()));
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (!coalesce_buffer_.empty() && std::chrono::steady_clock::now() >= coalesce_deadline_) {
+            takeCoalesced();
+        }
+        flushSendQueue();
+        // Re-arm, then look again for what raced with arming
+        more = shared_memory_->ArmNotifier();
+        if (!send_queue_.empty()) {
+            shared_memory_->WatchForSpace();
+            flushSendQueue();
+        }
+    }
+}
+
 bool IPCImplement::ReceiveMsg(IPCPacket* packet) {
     if (packet == nullptr) {
         LOG_ERROR("Packet is null");
@@ -191,25 +544,34 @@ void IPCImplement::senderThreadFunc() {
     const int base_retry_delay_ms = 10;
 
     while (running_.load()) {
-        std::string message;
+        PendingSend send;
         bool has_message = false;
 
         // Wait for a message in the queue or until stopped
         {
             std::unique_lock<std::mutex> lock(send_mutex_);
 
-            // Wait for a message or stop signal with timeout
-            send_cv_.wait_for(lock, std::chrono::milliseconds(50),
-                [this]() { return !send_queue_.empty() || !running_.load(); });
+            auto ready = [this]() { return !send_queue_.empty() || !running_.load(); };
+            if (coalesce_buffer_.empty()) {
+                // Wait for a message or stop signal with timeout
+                send_cv_.wait_for(lock, std::chrono::milliseconds(50), ready);
+            } else {
+                // A coalesced batch is due at its deadline
+                send_cv_.wait_until(lock, coalesce_deadline_, ready);
+            }
 
             // Double-check running state after waking up
             if (!running_.load()) {
                 break;
             }
 
+            if (!coalesce_buffer_.empty() && std::chrono::steady_clock::now() >= coalesce_deadline_) {
+                takeCoalesced();
+            }
+
             // Get message from queue if not empty
             if (!send_queue_.empty()) {
-                message = std::move(send_queue_.front());
+                send = std::move(send_queue_.front());
                 send_queue_.pop();
                 has_message = true;
             }
@@ -217,14 +579,6 @@ void IPCImplement::senderThreadFunc() {
 
         // Send message if we got one
         if (has_message && shared_memory_ && running_.load()) {
-            // Create packet with message as payload
-            IPCPacket packet(
-                is_server_ ? MessageType::MSG_RESPONSE : MessageType::MSG_REQUEST,
-                0, // sequence number
-                message.data(),
-                message.size()
-            );
-
             // Try to write packet to shared memory with retries
             bool write_success = false;
             for (int retry = 0; retry < max_retries && !write_success && running_.load(); retry++) {
@@ -234,24 +588,27 @@ void IPCImplement::senderThreadFunc() {
                     std::this_thread::sleep_for(std::chrono::milliseconds(base_retry_delay_ms * (1 << retry)));
                 }
 
-                write_success = shared_memory_->WritePacket(packet);
+                write_success = writeMessage(send);
             }
 
             if (!write_success) {
-                LOG_ERROR("Failed to write packet to shared memory after retries: %s", message.c_str());
+                LOG_ERROR("Failed to write packet to shared memory after retries: %u bytes",
+                          static_cast<uint32_t>(send.payload.size()));
 
                 // Put the message back in the queue to try again later, but only if still running
                 if (running_.load()) {
                     std::lock_guard<std::mutex> lock(send_mutex_);
                     // Avoid infinite growth of the queue, discard messages if too large
-                    if (send_queue_.size() < 1000) {
-                        send_queue_.push(std::move(message));
+                    if (send_queue_.size() < MAX_SEND_QUEUE) {
+                        send_queue_.push(std::move(send));
                     } else {
-                        LOG_WARNING("Sending queue is full, discarding message: %s", message.c_str());
+                        LOG_WARNING("Sending queue is full, discarding %u bytes",
+                                    static_cast<uint32_t>(send.payload.size()));
+                        sendDrops().Add();
                     }
                 }
             } else {
-                LOG_DEBUG("Sent message: %s", message.c_str());
+                LOG_DEBUG("Sent %u bytes", static_cast<uint32_t>(send.payload.size()));
             }
         }
     }
@@ -273,15 +630,18 @@ void IPCImplement::receiverThreadFunc() {
 
         // Try to read multiple packets from shared memory
         if (shared_memory_ && running_.load()) {
-            // Read up to max_batch_size packets in a single loop
-            for (size_t i = 0; i < max_batch_size && running_.load(); ++i) {
-                IPCPacket packet;
-                if (shared_memory_->ReadPacket(&packet)) {
-                    packet_buffer.push_back(std::move(packet));
-                    received_any = true;
-                } else {
-                    // No more packets available
-                    break;
+            // Read up to max_batch_size packets per channel in a single loop
+            uint32_t channels = shared_memory_->GetChannelCount();
+            for (uint32_t channel = 0; channel < channels; ++channel) {
+                for (size_t i = 0; i < max_batch_size && running_.load(); ++i) {
+                    IPCPacket packet;
+                    if (shared_memory_->ReadPacket(&packet, channel)) {
+                        packet_buffer.push_back(std::move(packet));
+                        received_any = true;
+                    } else {
+                        // No more packets available
+                        break;
+                    }
                 }
             }
 
@@ -293,19 +653,9 @@ void IPCImplement::receiverThreadFunc() {
 
                 // Extract message from packet payload
                 if (packet.GetPayloadLength() > 0 && packet.GetPayload() != nullptr) {
-                    std::string message(reinterpret_cast<const char*>(packet.GetPayload()),
-                                        packet.GetPayloadLength());
-
-                    // Add message to receive queue
-                    {
-                        std::lock_guard<std::mutex> lock(receive_mutex_);
-                        receive_queue_.push(message);
-                    }
-
-                    // Notify any waiting threads
-                    receive_cv_.notify_one();
-
-                    LOG_DEBUG("Queued received message: %s", message.c_str());
+                    deliverPayload(packet.GetMessageType(),
+                                   std::string_view(reinterpret_cast<const char*>(packet.GetPayload()),
+                                                    packet.GetPayloadLength()));
                 }
 
                 // Also call the legacy handler for backward compatibility
@@ -313,12 +663,10 @@ void IPCImplement::receiverThreadFunc() {
             }
         }
 
-        // Sleep briefly to reduce CPU usage, with regular checks of running state
-        if (!received_any) {
-            // Use shorter sleep intervals with running state checks
-            for (int i = 0; i < 10 && running_.load(); ++i) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            }
+        // Block until the writer publishes more, bounded so the running
+        // state is still checked regularly
+        if (!received_any && shared_memory_ && running_.load()) {
+            shared_memory_->WaitForData(50);
         }
     }
 
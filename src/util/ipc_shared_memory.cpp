@@ -1,6 +1,9 @@
 #include "ipc_shared_memory.hpp"
 #include "ipc_packet.hpp"
+#include "crc32c.hpp"
+#include <chrono>
 #include <errno.h>
+#include <cstddef>
 #include <cstring>
 #include <thread>
 #include <vector>
@@ -14,14 +17,91 @@
 #include <sys/shm.h>
 #include <sys/sem.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
 #endif
 
 namespace SAK {
 namespace ipc {
 
-IPCSharedMemory::IPCSharedMemory(const std::string& ipc_name, bool is_server)
-    : ipc_name_(ipc_name), is_server_(is_server), shm_key_(0), sem_key_(0),
-      shm_buffer_(nullptr), initialized_(false) {
+namespace {
+
+// Ring transport records: an 8-byte header, then the serialized packet,
+// padded so every record starts 8-byte aligned. A record never wraps; the
+// space left at the end of the buffer is filled with a padding record.
+struct RingRecord {
+    uint32_t length;    // Packet bytes, or RING_PADDING
+    uint32_t reserved;
+};
+
+constexpr uint32_t RING_PADDING = 0xFFFFFFFFu;
+constexpr uint32_t RING_ALIGN = 8;
+
+#ifndef _WIN32
+// Where a side's notifier socket lives: the abstract namespace on Linux, a
+// socket file under /tmp elsewhere
+socklen_t NotifierAddress(int shm_key, bool server, struct sockaddr_un* address) {
+    std::memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    std::string name = "sak_ipc_" + std::to_string(shm_key) + (server ? "_server" : "_client");
+#ifdef __linux__
+    std::memcpy(address->sun_path + 1, name.data(), name.size());
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + name.size());
+#else
+    name = "/tmp/" + name + ".sock";
+    std::memcpy(address->sun_path, name.data(), name.size());
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + name.size() + 1);
+#endif
+}
+
+int OpenDatagramSocket() {
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    return fd;
+}
+#endif
+
+static_assert(sizeof(SharedMemorySegmentHeader) == SHM_CACHE_LINE, "segment header is one cache line");
+static_assert(sizeof(SharedMemoryHeader) % SHM_CACHE_LINE == 0, "rings must start cache-line aligned");
+static_assert(sizeof(RingRecord) == RING_ALIGN, "ring record header must keep records aligned");
+
+uint32_t RingRecordSize(uint32_t packet_size) {
+    return (static_cast<uint32_t>(sizeof(RingRecord)) + packet_size + RING_ALIGN - 1) & ~(RING_ALIGN - 1);
+}
+
+#ifdef __linux__
+// Shared (not FUTEX_PRIVATE) so waiters and wakers may live in different processes
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t timeout_ms) {
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#endif
+
+} // namespace
+
+IPCSharedMemory::IPCSharedMemory(const std::string& ipc_name, bool is_server, IPCTransport transport)
+    : IPCSharedMemory(ipc_name, is_server, IPCSharedMemoryOptions{transport}) {}
+
+IPCSharedMemory::IPCSharedMemory(const std::string& ipc_name, bool is_server, const IPCSharedMemoryOptions& options)
+    : ipc_name_(ipc_name), is_server_(is_server), options_(options),
+      ring_mask_(static_cast<uint32_t>(options.ring_size - 1)), shm_key_(0), sem_key_(0),
+      shm_base_(nullptr), initialized_(false) {
 #ifdef _WIN32
     shm_handle_ = nullptr;
     for (int i = 0; i < SEM_COUNT; i++) {
@@ -42,6 +122,9 @@ bool IPCSharedMemory::Init() {
         LOG_ERROR("IPC name is empty");
         return false;
     }
+    if (!ValidateOptions()) {
+        return false;
+    }
 
     // Generate keys for shared memory and semaphores
     shm_key_ = GenerateKey(ipc_name_, false);
@@ -58,8 +141,8 @@ bool IPCSharedMemory::Init() {
         return false;
     }
 
-    // Create semaphores
-    if (!CreateSemaphore()) {
+    // Create semaphores; the ring transport synchronises through the header alone
+    if (options_.transport == IPCTransport::semaphore && !CreateSemaphore()) {
         LOG_ERROR("Failed to create semaphores");
         DestroySharedMemory();
         return false;
@@ -70,31 +153,63 @@ bool IPCSharedMemory::Init() {
     // For client, we need to ensure we can read the header values
     if (is_server_) {
         // Initialize header as server with explicit memory ordering for cross-process safety
-        shm_buffer_->header.server_write_pos.store(0, std::memory_order_seq_cst);
-        shm_buffer_->header.server_read_pos.store(0, std::memory_order_seq_cst);
-        shm_buffer_->header.client_write_pos.store(0, std::memory_order_seq_cst);
-        shm_buffer_->header.client_read_pos.store(0, std::memory_order_seq_cst);
-        
-        // Clear buffers for safety
-        std::memset(shm_buffer_->server_to_client, 0, SHM_BUFFER_SIZE);
-        std::memset(shm_buffer_->client_to_server, 0, SHM_BUFFER_SIZE);
+        SharedMemorySegmentHeader* segment = Segment();
+        segment->ring_size = static_cast<uint32_t>(options_.ring_size);
+        segment->channel_count = options_.channels;
+        segment->server_readers_parked.store(0, std::memory_order_seq_cst);
+        segment->client_readers_parked.store(0, std::memory_order_seq_cst);
+        segment->server_doorbell.store(0, std::memory_order_seq_cst);
+        segment->client_doorbell.store(0, std::memory_order_seq_cst);
+        segment->server_notify_armed.store(0, std::memory_order_seq_cst);
+        segment->client_notify_armed.store(0, std::memory_order_seq_cst);
+        segment->server_space_armed.store(0, std::memory_order_seq_cst);
+        segment->client_space_armed.store(0, std::memory_order_seq_cst);
+        for (uint32_t channel = 0; channel < options_.channels; ++channel) {
+            SharedMemoryHeader* header = Channel(channel);
+            header->server_write_pos.store(0, std::memory_order_seq_cst);
+            header->server_read_pos.store(0, std::memory_order_seq_cst);
+            header->client_write_pos.store(0, std::memory_order_seq_cst);
+            header->client_read_pos.store(0, std::memory_order_seq_cst);
+        }
+        segment->transport.store(static_cast<uint32_t>(options_.transport), std::memory_order_seq_cst);
         
-        LOG_DEBUG("Server initialized shared memory with all positions set to 0");
+        LOG_DEBUG("Server initialized shared memory with all positions set to 0 (%u channels of %zu bytes)",
+                  options_.channels, options_.ring_size);
     } else {
         // Client should wait briefly to ensure server has initialized the header
         // Give the server time to initialize if it hasn't already
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
         // Verify header values are initialized using safe cross-process atomic access
-        uint32_t server_write = shm_buffer_->header.server_write_pos.load(std::memory_order_seq_cst);
-        uint32_t server_read = shm_buffer_->header.server_read_pos.load(std::memory_order_seq_cst);
-        uint32_t client_write = shm_buffer_->header.client_write_pos.load(std::memory_order_seq_cst);
-        uint32_t client_read = shm_buffer_->header.client_read_pos.load(std::memory_order_seq_cst);
+        SharedMemoryHeader* header = Channel(0);
+        uint32_t server_write = header->server_write_pos.load(std::memory_order_seq_cst);
+        uint32_t server_read = header->server_read_pos.load(std::memory_order_seq_cst);
+        uint32_t client_write = header->client_write_pos.load(std::memory_order_seq_cst);
+        uint32_t client_read = header->client_read_pos.load(std::memory_order_seq_cst);
         
         LOG_DEBUG("Client verified header initialization: server_write=%u, server_read=%u, client_write=%u, client_read=%u",
                  server_write, server_read, client_write, client_read);
+
+        SharedMemorySegmentHeader* segment = Segment();
+        uint32_t server_transport = segment->transport.load(std::memory_order_seq_cst);
+        if (server_transport != static_cast<uint32_t>(options_.transport)) {
+            LOG_ERROR("Transport mismatch: server uses %u, client asked for %u",
+                      server_transport, static_cast<uint32_t>(options_.transport));
+            Uninit();
+            return false;
+        }
+        if (segment->ring_size != options_.ring_size || segment->channel_count != options_.channels) {
+            LOG_ERROR("Layout mismatch: server has %u channels of %u bytes, client asked for %u of %zu",
+                      segment->channel_count, segment->ring_size, options_.channels, options_.ring_size);
+            Uninit();
+            return false;
+        }
     }
 
+    channel_state_.assign(options_.channels, ChannelState());
+#ifndef _WIN32
+    peer_notify_fd_ = OpenDatagramSocket();
+#endif
     initialized_ = true;
     LOG_DEBUG("Shared memory initialized successfully (is_server=%d)", is_server_);
     return true;
@@ -103,19 +218,27 @@ bool IPCSharedMemory::Init() {
 bool IPCSharedMemory::Uninit() {
     bool result = true;
 
-    if (shm_buffer_) {
+    CloseNotifier();
+#ifndef _WIN32
+    if (peer_notify_fd_ >= 0) {
+        close(peer_notify_fd_);
+        peer_notify_fd_ = -1;
+    }
+#endif
+
+    if (shm_base_) {
 #ifdef _WIN32
-        if (!UnmapViewOfFile(shm_buffer_)) {
+        if (!UnmapViewOfFile(shm_base_)) {
             LOG_ERROR("Failed to unmap shared memory: %lu", GetLastError());
             result = false;
         }
 #else
-        if (shmdt(shm_buffer_) == -1) {
+        if (shmdt(shm_base_) == -1) {
             LOG_ERROR("Failed to detach shared memory: %s", strerror(errno));
             result = false;
         }
 #endif
-        shm_buffer_ = nullptr;
+        shm_base_ = nullptr;
     }
 
     // Only destroy resources if we're the server
@@ -134,37 +257,35 @@ bool IPCSharedMemory::Uninit() {
     return result;
 }
 
-bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
-    if (!initialized_ || !shm_buffer_) {
+bool IPCSharedMemory::WritePacket(const IPCPacket& packet, uint32_t channel) {
+    if (!initialized_ || !shm_base_) {
         LOG_ERROR("Shared memory not initialized");
         return false;
     }
+    if (channel >= options_.channels) {
+        LOG_ERROR("Invalid channel %u", channel);
+        return false;
+    }
     
+    if (options_.transport == IPCTransport::spsc_ring) {
+        return WriteRing(packet, channel);
+    }
+
     LOG_DEBUG("WritePacket: is_server=%d, packet_size=%u", is_server_, packet.GetTotalSize());
     
-    // Determine which buffer and positions to use based on server/client role
-    char* buffer = nullptr;
-    
     // For server: write to server_to_client buffer, read from client_to_server buffer
     // For client: write to client_to_server buffer, read from server_to_client buffer
-    
-    // Write position is our own write position
-    std::atomic<uint32_t>& write_pos = is_server_ ? 
-        shm_buffer_->header.server_write_pos : 
-        shm_buffer_->header.client_write_pos;
-    
-    // Read position is the other side's read position
-    std::atomic<uint32_t>& read_pos = is_server_ ? 
-        shm_buffer_->header.client_read_pos : 
-        shm_buffer_->header.server_read_pos;
+    // Write position is our own, read position the other side's
+    Direction out = Outgoing(0);
+    std::atomic<uint32_t>& write_pos = *out.write_pos;
+    std::atomic<uint32_t>& read_pos = *out.read_pos;
     
     // Semaphores for synchronization
     int write_sem = is_server_ ? SEM_SERVER_WRITE : SEM_CLIENT_WRITE;
     int read_sem = is_server_ ? SEM_CLIENT_READ : SEM_SERVER_READ;
     
-    // Select the appropriate buffer for writing
-    // Server writes to server_to_client, client writes to client_to_server
-    buffer = is_server_ ? shm_buffer_->server_to_client : shm_buffer_->client_to_server;
+    char* buffer = out.buffer;
+    const uint32_t ring_size = static_cast<uint32_t>(options_.ring_size);
     
     LOG_DEBUG("WritePacket: Role=%s, Using buffer=%s, write_pos=%u, read_pos=%u, write_sem=%d, read_sem=%d",
              is_server_ ? "SERVER" : "CLIENT",
@@ -175,8 +296,8 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
     uint32_t packet_size = packet.GetTotalSize();
     
     // Check if packet fits in buffer
-    if (packet_size > SHM_BUFFER_SIZE) {
-        LOG_ERROR("Packet size %u exceeds buffer size %u", packet_size, SHM_BUFFER_SIZE);
+    if (packet_size > ring_size) {
+        LOG_ERROR("Packet size %u exceeds buffer size %u", packet_size, ring_size);
         return false;
     }
     
@@ -203,7 +324,7 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
         // Write position is after or equal to read position
         // Available space wraps around: from write_pos to end, plus from start to read_pos
         // Need to keep at least 1 byte gap to distinguish full from empty
-        available_space = SHM_BUFFER_SIZE - current_write_pos + current_read_pos - 1;
+        available_space = ring_size - current_write_pos + current_read_pos - 1;
     } else {
         // Write position is before read position
         // Available space = read position - write position - 1 (keep one byte gap)
@@ -221,17 +342,17 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
     
     // Serialize packet to buffer
     // Check if we need to handle wrap-around case
-    if (current_write_pos + packet_size > SHM_BUFFER_SIZE) {
+    if (current_write_pos + packet_size > ring_size) {
         LOG_DEBUG("WritePacket: Handling wrap-around case for serialization");
         
         // Calculate how much data fits before the end of the buffer
-        uint32_t first_chunk_size = SHM_BUFFER_SIZE - current_write_pos;
+        uint32_t first_chunk_size = ring_size - current_write_pos;
         
         // Create a temporary buffer to hold the serialized packet
         std::vector<uint8_t> temp_buffer(packet_size);
         
         // Serialize to temporary buffer
-        if (!packet.Serialize(temp_buffer.data(), packet_size)) {
+        if (!packet.Serialize(temp_buffer.data(), packet_size, options_.checksums)) {
             LOG_ERROR("Failed to serialize packet to temporary buffer");
             SemaphoreSignal(write_sem);
             return false;
@@ -247,7 +368,7 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
                  first_chunk_size, packet_size - first_chunk_size);
     } else {
         // Normal case - no wrap-around
-        if (!packet.Serialize(buffer + current_write_pos, SHM_BUFFER_SIZE - current_write_pos)) {
+        if (!packet.Serialize(buffer + current_write_pos, ring_size - current_write_pos, options_.checksums)) {
             LOG_ERROR("Failed to serialize packet");
             SemaphoreSignal(write_sem);
             return false;
@@ -257,11 +378,12 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
     }
     
     // Update write position
-    uint32_t new_write_pos = (current_write_pos + packet_size) % SHM_BUFFER_SIZE;
-    write_pos.store(new_write_pos, std::memory_order_release);
+    uint32_t new_write_pos = (current_write_pos + packet_size) % ring_size;
+    write_pos.store(new_write_pos, std::memory_order_seq_cst);
     
     // Signal read semaphore to indicate data is available for the other side
     SemaphoreSignal(read_sem);
+    NotifyPeerIf(out.notify_armed);
 
     // Release write semaphore
     SemaphoreSignal(write_sem);
@@ -270,37 +392,35 @@ bool IPCSharedMemory::WritePacket(const IPCPacket& packet) {
     return true;
 }
 
-bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
-    if (!initialized_ || !shm_buffer_ || !packet) {
+bool IPCSharedMemory::ReadPacket(IPCPacket* packet, uint32_t channel) {
+    if (!initialized_ || !shm_base_ || !packet) {
         LOG_ERROR("Shared memory not initialized or packet is null");
         return false;
     }
+    if (channel >= options_.channels) {
+        LOG_ERROR("Invalid channel %u", channel);
+        return false;
+    }
     
+    if (options_.transport == IPCTransport::spsc_ring) {
+        return ReadRing(packet, channel);
+    }
+
     LOG_DEBUG("ReadPacket: is_server=%d", is_server_);
     
-    // Determine which buffer and positions to use based on server/client role
-    char* buffer = nullptr;
-    
     // For server: read from client_to_server buffer, write to server_to_client buffer
     // For client: read from server_to_client buffer, write to client_to_server buffer
-    
-    // Write position is the other side's write position
-    std::atomic<uint32_t>& write_pos = is_server_ ? 
-        shm_buffer_->header.client_write_pos : 
-        shm_buffer_->header.server_write_pos;
-    
-    // Read position is our own read position
-    std::atomic<uint32_t>& read_pos = is_server_ ? 
-        shm_buffer_->header.server_read_pos : 
-        shm_buffer_->header.client_read_pos;
+    // Write position is the other side's, read position our own
+    Direction in = Incoming(0);
+    std::atomic<uint32_t>& write_pos = *in.write_pos;
+    std::atomic<uint32_t>& read_pos = *in.read_pos;
     
     // Semaphores for synchronization
     int write_sem = is_server_ ? SEM_CLIENT_WRITE : SEM_SERVER_WRITE;
     int read_sem = is_server_ ? SEM_SERVER_READ : SEM_CLIENT_READ;
     
-    // Select the appropriate buffer for reading
-    // Server reads from client_to_server, client reads from server_to_client
-    buffer = is_server_ ? shm_buffer_->client_to_server : shm_buffer_->server_to_client;
+    char* buffer = in.buffer;
+    const uint32_t ring_size = static_cast<uint32_t>(options_.ring_size);
     
     LOG_DEBUG("ReadPacket: Role=%s, Using buffer=%s, write_pos=%u, read_pos=%u, write_sem=%d, read_sem=%d",
              is_server_ ? "SERVER" : "CLIENT",
@@ -319,7 +439,7 @@ bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
         available_data = current_write_pos - current_read_pos;
     } else {
         // Write position is before read position (wrap-around case)
-        available_data = SHM_BUFFER_SIZE - current_read_pos + current_write_pos;
+        available_data = ring_size - current_read_pos + current_write_pos;
     }
     
     LOG_DEBUG("ReadPacket: Available data: %u bytes", available_data);
@@ -352,12 +472,12 @@ bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
     SAK::ipc::PacketHeader header;
     
     // Check if header crosses buffer boundary
-    if (current_read_pos + sizeof(header) > SHM_BUFFER_SIZE) {
+    if (current_read_pos + sizeof(header) > ring_size) {
         // Header is split across buffer boundary
         LOG_DEBUG("ReadPacket: Header crosses buffer boundary");
         
         // Calculate how much of the header is at the end of the buffer
-        uint32_t first_chunk_size = SHM_BUFFER_SIZE - current_read_pos;
+        uint32_t first_chunk_size = ring_size - current_read_pos;
         
         // Create a temporary buffer to hold the header
         uint8_t temp_header[sizeof(PacketHeader)];
@@ -387,14 +507,14 @@ bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
     // Calculate packet total size, including header, payload, and checksum
     uint32_t packet_size = sizeof(PacketHeader) + header.payload_len + sizeof(uint32_t);
     
-    if (packet_size > SHM_BUFFER_SIZE) {
-        LOG_ERROR("Packet size %u exceeds buffer size %u", packet_size, SHM_BUFFER_SIZE);
+    if (packet_size > ring_size) {
+        LOG_ERROR("Packet size %u exceeds buffer size %u", packet_size, ring_size);
         SemaphoreSignal(read_sem);
         return false;
     }
     
     // Check if packet crosses buffer boundary
-    if (current_read_pos + packet_size > SHM_BUFFER_SIZE) {
+    if (current_read_pos + packet_size > ring_size) {
         // Packet is split across buffer boundary
         LOG_DEBUG("ReadPacket: Packet crosses buffer boundary");
         
@@ -402,7 +522,7 @@ bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
         std::vector<uint8_t> temp_buffer(packet_size);
         
         // Calculate sizes of the two chunks
-        uint32_t first_chunk_size = SHM_BUFFER_SIZE - current_read_pos;
+        uint32_t first_chunk_size = ring_size - current_read_pos;
         uint32_t second_chunk_size = packet_size - first_chunk_size;
         
         // Copy first chunk from end of buffer
@@ -423,23 +543,469 @@ bool IPCSharedMemory::ReadPacket(IPCPacket* packet) {
     }
     
     // Validate packet
-    if (!packet->IsValid()) {
+    if (!packet->IsValid(options_.checksums)) {
         LOG_ERROR("Invalid packet read from shared memory");
         SemaphoreSignal(read_sem);
         return false;
     }
     
     // Update read position
-    uint32_t new_read_pos = (current_read_pos + packet_size) % SHM_BUFFER_SIZE;
-    read_pos.store(new_read_pos, std::memory_order_release);
+    uint32_t new_read_pos = (current_read_pos + packet_size) % ring_size;
+    read_pos.store(new_read_pos, std::memory_order_seq_cst);
     
     // Signal write semaphore to indicate buffer space is available to the other side
     SemaphoreSignal(write_sem);
+    SignalSpace(in);
 
     LOG_DEBUG("ReadPacket: Successfully read packet, signaled write_sem=%d", write_sem);
     return true;
 }
 
+bool IPCSharedMemory::ValidateOptions() const {
+    size_t ring_size = options_.ring_size;
+    if (ring_size < SHM_MIN_RING_SIZE || ring_size > SHM_MAX_RING_SIZE || (ring_size & (ring_size - 1)) != 0) {
+        LOG_ERROR("Ring size %zu must be a power of two in [%zu, %zu]", ring_size, SHM_MIN_RING_SIZE, SHM_MAX_RING_SIZE);
+        return false;
+    }
+    if (options_.channels == 0 || options_.channels > SHM_MAX_CHANNELS) {
+        LOG_ERROR("Channel count %u must be in [1, %u]", options_.channels, SHM_MAX_CHANNELS);
+        return false;
+    }
+    if (options_.channels > 1 && options_.transport != IPCTransport::spsc_ring) {
+        LOG_ERROR("Multiple channels need the spsc_ring transport");
+        return false;
+    }
+    return true;
+}
+
+size_t IPCSharedMemory::SegmentSize() const {
+    size_t size = sizeof(SharedMemorySegmentHeader) +
+                  options_.channels * (sizeof(SharedMemoryHeader) + 2 * options_.ring_size);
+    if (options_.huge_pages) {
+        size = (size + SHM_HUGE_PAGE_SIZE - 1) & ~(SHM_HUGE_PAGE_SIZE - 1);
+    }
+    return size;
+}
+
+SharedMemoryHeader* IPCSharedMemory::Channel(uint32_t channel) const {
+    size_t stride = sizeof(SharedMemoryHeader) + 2 * options_.ring_size;
+    return reinterpret_cast<SharedMemoryHeader*>(shm_base_ + sizeof(SharedMemorySegmentHeader) + channel * stride);
+}
+
+IPCSharedMemory::Direction IPCSharedMemory::Outgoing(uint32_t channel) const {
+    SharedMemorySegmentHeader* segment = Segment();
+    SharedMemoryHeader* header = Channel(channel);
+    char* server_to_client = reinterpret_cast<char*>(header + 1);
+    char* client_to_server = server_to_client + options_.ring_size;
+    if (is_server_) {
+        return {server_to_client, &header->server_write_pos, &header->client_read_pos,
+                &segment->client_readers_parked, &segment->client_doorbell,
+                &segment->client_notify_armed, &segment->server_space_armed};
+    }
+    return {client_to_server, &header->client_write_pos, &header->server_read_pos,
+            &segment->server_readers_parked, &segment->server_doorbell,
+            &segment->server_notify_armed, &segment->client_space_armed};
+}
+
+IPCSharedMemory::Direction IPCSharedMemory::Incoming(uint32_t channel) const {
+    SharedMemorySegmentHeader* segment = Segment();
+    SharedMemoryHeader* header = Channel(channel);
+    char* server_to_client = reinterpret_cast<char*>(header + 1);
+    char* client_to_server = server_to_client + options_.ring_size;
+    if (is_server_) {
+        return {client_to_server, &header->client_write_pos, &header->server_read_pos,
+                &segment->server_readers_parked, &segment->server_doorbell,
+                &segment->server_notify_armed, &segment->client_space_armed};
+    }
+    return {server_to_client, &header->server_write_pos, &header->client_read_pos,
+            &segment->client_readers_parked, &segment->client_doorbell,
+            &segment->client_notify_armed, &segment->server_space_armed};
+}
+
+char* IPCSharedMemory::ReserveRecord(uint32_t channel, uint32_t packet_size) {
+    ChannelState& state = channel_state_[channel];
+    if (state.reserved_size != 0) {
+        LOG_ERROR("A write reservation is already open on channel %u", channel);
+        return nullptr;
+    }
+    Direction out = Outgoing(channel);
+    const uint32_t ring_size = static_cast<uint32_t>(options_.ring_size);
+    uint32_t record_size = RingRecordSize(packet_size);
+    if (packet_size > ring_size || record_size > ring_size) {
+        LOG_ERROR("Packet size %u exceeds buffer size %u", packet_size, ring_size);
+        return nullptr;
+    }
+
+    // Only this thread moves the write position; the reader only moves its own
+    uint32_t head = out.write_pos->load(std::memory_order_relaxed);
+    uint32_t tail = out.read_pos->load(std::memory_order_acquire);
+    uint32_t offset = head & ring_mask_;
+    uint32_t to_end = ring_size - offset;
+    uint32_t needed = record_size > to_end ? to_end + record_size : record_size;
+    if (ring_size - (head - tail) < needed) {
+        LOG_DEBUG("ReserveRecord: ring full, used=%u, needed=%u", head - tail, needed);
+        return nullptr;
+    }
+
+    if (record_size > to_end) {
+        // Unpublished until the record after it is committed
+        RingRecord padding{RING_PADDING, 0};
+        std::memcpy(out.buffer + offset, &padding, sizeof(padding));
+        head += to_end;
+        offset = 0;
+    }
+    state.reserved_head = head;
+    state.reserved_size = packet_size;
+    return out.buffer + offset + sizeof(RingRecord);
+}
+
+void IPCSharedMemory::PublishRecord(uint32_t channel, uint32_t packet_size) {
+    ChannelState& state = channel_state_[channel];
+    Direction out = Outgoing(channel);
+    RingRecord record{packet_size, 0};
+    std::memcpy(out.buffer + (state.reserved_head & ring_mask_), &record, sizeof(record));
+    state.reserved_size = 0;
+
+    // Sequentially consistent, like the parking in WaitForData(): either the
+    // reader sees the new position before sleeping or we see it parked
+    out.write_pos->store(state.reserved_head + RingRecordSize(packet_size), std::memory_order_seq_cst);
+    if (out.readers_parked->load(std::memory_order_seq_cst) != 0) {
+        out.doorbell->fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+        FutexWakeAll(out.doorbell);
+#endif
+    }
+    NotifyPeerIf(out.notify_armed);
+}
+
+const char* IPCSharedMemory::PeekRecord(uint32_t channel, uint32_t* packet_size) {
+    Direction in = Incoming(channel);
+    const uint32_t ring_size = static_cast<uint32_t>(options_.ring_size);
+    uint32_t tail = in.read_pos->load(std::memory_order_relaxed);
+    uint32_t head = in.write_pos->load(std::memory_order_acquire);
+
+    while (head != tail) {
+        uint32_t offset = tail & ring_mask_;
+        RingRecord record;
+        std::memcpy(&record, in.buffer + offset, sizeof(record));
+        if (record.length == RING_PADDING) {
+            tail += ring_size - offset;
+            in.read_pos->store(tail, std::memory_order_release);
+            continue;
+        }
+
+        uint32_t record_size = RingRecordSize(record.length);
+        if (record.length > ring_size || record_size > head - tail) {
+            // Can't find the next record boundary; drop what was published
+            LOG_ERROR("Corrupt ring record (length=%u), discarding %u bytes", record.length, head - tail);
+            in.read_pos->store(head, std::memory_order_seq_cst);
+            SignalSpace(in);
+            return nullptr;
+        }
+        channel_state_[channel].peeked_size = record_size;
+        *packet_size = record.length;
+        return in.buffer + offset + sizeof(RingRecord);
+    }
+    return nullptr;
+}
+
+void IPCSharedMemory::ConsumeRecord(uint32_t channel) {
+    ChannelState& state = channel_state_[channel];
+    Direction in = Incoming(channel);
+    uint32_t tail = in.read_pos->load(std::memory_order_relaxed);
+    // Hands the space back to the writer; sequentially consistent against
+    // the writer arming WatchForSpace() after finding the ring full
+    in.read_pos->store(tail + state.peeked_size, std::memory_order_seq_cst);
+    state.peeked_size = 0;
+    SignalSpace(in);
+}
+
+bool IPCSharedMemory::WriteRing(const IPCPacket& packet, uint32_t channel) {
+    uint32_t packet_size = packet.GetTotalSize();
+    char* dest = ReserveRecord(channel, packet_size);
+    if (!dest) {
+        return false;
+    }
+    // Serialize straight into the ring, then publish the record
+    if (!packet.Serialize(dest, packet_size, options_.checksums)) {
+        LOG_ERROR("Failed to serialize packet");
+        channel_state_[channel].reserved_size = 0;
+        return false;
+    }
+    PublishRecord(channel, packet_size);
+    return true;
+}
+
+bool IPCSharedMemory::ReadRing(IPCPacket* packet, uint32_t channel) {
+    if (channel_state_[channel].peeked_size != 0) {
+        LOG_ERROR("ReadPacket called while a PeekRead view is held");
+        return false;
+    }
+    uint32_t packet_size = 0;
+    const char* data = PeekRecord(channel, &packet_size);
+    if (!data) {
+        return false;
+    }
+    *packet = IPCPacket(data, packet_size);
+    // The packet owns a copy now
+    ConsumeRecord(channel);
+    if (!packet->IsValid(options_.checksums)) {
+        LOG_ERROR("Invalid packet read from shared memory");
+        return false;
+    }
+    return true;
+}
+
+uint8_t* IPCSharedMemory::ReserveWrite(uint32_t payload_len, uint32_t channel) {
+    if (!initialized_ || !shm_base_ || options_.transport != IPCTransport::spsc_ring ||
+        channel >= options_.channels) {
+        LOG_ERROR("ReserveWrite needs an initialized ring transport and a valid channel");
+        return nullptr;
+    }
+    if (payload_len > options_.ring_size) {
+        LOG_ERROR("Payload size %u exceeds buffer size %zu", payload_len, options_.ring_size);
+        return nullptr;
+    }
+    char* packet = ReserveRecord(channel, sizeof(PacketHeader) + payload_len + sizeof(uint32_t));
+    return packet ? reinterpret_cast<uint8_t*>(packet + sizeof(PacketHeader)) : nullptr;
+}
+
+bool IPCSharedMemory::CommitWrite(MessageType type, uint32_t seq_num, uint32_t payload_len, uint32_t channel) {
+    if (channel >= channel_state_.size() || channel_state_[channel].reserved_size == 0) {
+        LOG_ERROR("CommitWrite without ReserveWrite");
+        return false;
+    }
+    ChannelState& state = channel_state_[channel];
+    uint32_t reserved_payload = state.reserved_size - sizeof(PacketHeader) - sizeof(uint32_t);
+    if (payload_len > reserved_payload) {
+        LOG_ERROR("CommitWrite of %u bytes exceeds the %u reserved", payload_len, reserved_payload);
+        return false;
+    }
+
+    // Same wire format and checksum as IPCPacket::Serialize()
+    PacketHeader header{};
+    header.magic_id = IPC_PACKET_MAGIC;
+    header.version = 1;
+    header.msg_type = static_cast<uint8_t>(type);
+    header.flags = options_.checksums ? 0 : PACKET_FLAG_UNCHECKED;
+    header.payload_len = payload_len;
+    header.seq_num = seq_num;
+    header.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    char* packet = Outgoing(channel).buffer + (state.reserved_head & ring_mask_) + sizeof(RingRecord);
+    uint32_t checksum = 0;
+    if (options_.checksums) {
+        checksum = Crc32c::Extend(Crc32c::Compute(&header, sizeof(header)), packet + sizeof(PacketHeader), payload_len);
+    }
+    std::memcpy(packet, &header, sizeof(header));
+    std::memcpy(packet + sizeof(PacketHeader) + payload_len, &checksum, sizeof(checksum));
+    PublishRecord(channel, sizeof(PacketHeader) + payload_len + sizeof(uint32_t));
+    return true;
+}
+
+void IPCSharedMemory::CancelWrite(uint32_t channel) {
+    if (channel < channel_state_.size()) {
+        channel_state_[channel].reserved_size = 0;
+    }
+}
+
+bool IPCSharedMemory::PeekRead(PacketView* view, uint32_t channel) {
+    if (!initialized_ || !shm_base_ || !view || options_.transport != IPCTransport::spsc_ring ||
+        channel >= options_.channels) {
+        LOG_ERROR("PeekRead needs an initialized ring transport and a valid channel");
+        return false;
+    }
+    if (channel_state_[channel].peeked_size != 0) {
+        LOG_ERROR("PeekRead called before ReleaseRead");
+        return false;
+    }
+
+    uint32_t packet_size = 0;
+    const char* data;
+    while ((data = PeekRecord(channel, &packet_size)) != nullptr) {
+        const PacketHeader* header = reinterpret_cast<const PacketHeader*>(data);
+        uint32_t payload_len = header->payload_len;
+        if (header->magic_id == IPC_PACKET_MAGIC &&
+            packet_size == sizeof(PacketHeader) + payload_len + sizeof(uint32_t)) {
+            const uint8_t* payload = reinterpret_cast<const uint8_t*>(data + sizeof(PacketHeader));
+            uint32_t checksum;
+            std::memcpy(&checksum, payload + payload_len, sizeof(checksum));
+            // This side's setting decides, whatever the writer chose
+            if (!options_.checksums ||
+                (!(header->flags & PACKET_FLAG_UNCHECKED) &&
+                 Crc32c::Extend(Crc32c::Compute(header, sizeof(PacketHeader)), payload, payload_len) == checksum)) {
+                view->header = header;
+                view->payload = payload;
+                view->payload_len = payload_len;
+                return true;
+            }
+        }
+        LOG_ERROR("Invalid packet in shared memory, skipping %u bytes", packet_size);
+        ConsumeRecord(channel);
+    }
+    return false;
+}
+
+void IPCSharedMemory::ReleaseRead(uint32_t channel) {
+    if (channel < channel_state_.size() && channel_state_[channel].peeked_size != 0) {
+        ConsumeRecord(channel);
+    }
+}
+
+bool IPCSharedMemory::HasData(uint32_t channel) const {
+    Direction in = Incoming(channel);
+    return in.write_pos->load(std::memory_order_seq_cst) != in.read_pos->load(std::memory_order_relaxed);
+}
+
+bool IPCSharedMemory::HasAnyData() const {
+    for (uint32_t channel = 0; channel < options_.channels; ++channel) {
+        if (HasData(channel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IPCSharedMemory::WaitForData(uint32_t timeout_ms) {
+    if (!initialized_ || !shm_base_) {
+        return false;
+    }
+    auto has_data = [this]() { return HasAnyData(); };
+    if (has_data()) {
+        return true;
+    }
+
+#ifdef __linux__
+    if (options_.transport == IPCTransport::spsc_ring) {
+        // One doorbell per side covers every channel; writers only ring it
+        // while a reader is counted as parked
+        Direction in = Incoming(0);
+        in.readers_parked->fetch_add(1, std::memory_order_seq_cst);
+        uint32_t bell = in.doorbell->load(std::memory_order_seq_cst);
+        if (!has_data()) {
+            FutexWait(in.doorbell, bell, timeout_ms);
+        }
+        in.readers_parked->fetch_sub(1, std::memory_order_seq_cst);
+        return has_data();
+    }
+#endif
+
+    // Semaphore transport (or no futex): poll in short naps
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!has_data() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return has_data();
+}
+
+void IPCSharedMemory::WakeReader() {
+#ifdef __linux__
+    if (initialized_ && shm_base_ && options_.transport == IPCTransport::spsc_ring) {
+        Direction in = Incoming(0);
+        in.doorbell->fetch_add(1, std::memory_order_seq_cst);
+        FutexWakeAll(in.doorbell);
+    }
+#endif
+}
+
+int IPCSharedMemory::OpenNotifier() {
+    if (!initialized_) {
+        LOG_ERROR("Shared memory not initialized");
+        return -1;
+    }
+#ifdef _WIN32
+    LOG_ERROR("IPC notifier descriptors are not supported on Windows");
+    return -1;
+#else
+    if (notify_fd_ >= 0) {
+        return notify_fd_;
+    }
+    struct sockaddr_un address;
+    socklen_t length = NotifierAddress(shm_key_, is_server_, &address);
+    int fd = OpenDatagramSocket();
+    if (fd < 0) {
+        LOG_ERROR("Failed to create notifier socket: %s", strerror(errno));
+        return -1;
+    }
+#ifndef __linux__
+    unlink(address.sun_path);
+#endif
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), length) == -1) {
+        LOG_ERROR("Failed to bind notifier socket: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    notify_fd_ = fd;
+    ArmNotifier();
+    return notify_fd_;
+#endif
+}
+
+void IPCSharedMemory::CloseNotifier() {
+#ifndef _WIN32
+    if (notify_fd_ < 0) {
+        return;
+    }
+    if (shm_base_) {
+        Incoming(0).notify_armed->store(0, std::memory_order_seq_cst);
+        Outgoing(0).space_armed->store(0, std::memory_order_seq_cst);
+    }
+    close(notify_fd_);
+    notify_fd_ = -1;
+#ifndef __linux__
+    struct sockaddr_un address;
+    NotifierAddress(shm_key_, is_server_, &address);
+    unlink(address.sun_path);
+#endif
+#endif
+}
+
+bool IPCSharedMemory::ArmNotifier() {
+    if (!initialized_ || !shm_base_) {
+        return false;
+    }
+#ifndef _WIN32
+    if (notify_fd_ >= 0) {
+        char drain[64];
+        while (recv(notify_fd_, drain, sizeof(drain), MSG_DONTWAIT) > 0) {
+        }
+    }
+#endif
+    // Stays armed across packets until a writer takes it; the re-check below
+    // catches a packet published before the writer could see the flag
+    Incoming(0).notify_armed->store(1, std::memory_order_seq_cst);
+    return HasAnyData();
+}
+
+void IPCSharedMemory::WatchForSpace() {
+    if (initialized_ && shm_base_) {
+        Outgoing(0).space_armed->store(1, std::memory_order_seq_cst);
+    }
+}
+
+void IPCSharedMemory::NotifyPeerIf(std::atomic<uint32_t>* armed) {
+    // Cheap load first so the common, unarmed case stays a read
+    if (armed->load(std::memory_order_seq_cst) == 0 || armed->exchange(0, std::memory_order_seq_cst) == 0) {
+        return;
+    }
+#ifndef _WIN32
+    if (peer_notify_fd_ < 0) {
+        return;
+    }
+    struct sockaddr_un address;
+    socklen_t length = NotifierAddress(shm_key_, !is_server_, &address);
+    char byte = 1;
+    // A full socket means a wake-up is already pending; a missing one means
+    // nobody listens any more
+    sendto(peer_notify_fd_, &byte, 1, MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&address), length);
+#endif
+}
+
+void IPCSharedMemory::SignalSpace(const Direction& in) {
+    NotifyPeerIf(in.space_armed);
+}
+
 int IPCSharedMemory::GenerateKey(const std::string& name, bool is_sem) {
     // Generate a unique key based on the IPC name and type
     // Use a hash of the name instead of ftok since ftok requires an existing file
@@ -462,6 +1028,9 @@ int IPCSharedMemory::GenerateKey(const std::string& name, bool is_sem) {
 }
 
 bool IPCSharedMemory::CreateSharedMemory() {
+    size_t segment_size = SegmentSize();
+    huge_pages_ = false;
+
     // Try to get existing shared memory
 #ifdef _WIN32
     // Windows uses named shared memory
@@ -475,19 +1044,33 @@ bool IPCSharedMemory::CreateSharedMemory() {
             return false;
         }
         // Create new shared memory mapping if not found
+        // Large pages need SeLockMemoryPrivilege; Windows always uses normal pages here
         shm_handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
-                                         0, (DWORD)sizeof(SharedMemoryBuffer), shm_name.c_str());
+                                         (DWORD)((uint64_t)segment_size >> 32), (DWORD)segment_size,
+                                         shm_name.c_str());
         if (shm_handle_ == nullptr) {
             LOG_ERROR("Failed to create shared memory: %lu", GetLastError());
             return false;
         }
     }
 #else
-    shm_id_ = shmget(shm_key_, sizeof(SharedMemoryBuffer), 0);
+    shm_id_ = shmget(shm_key_, segment_size, 0);
     
     if (shm_id_ == -1) {
         // Create new shared memory if it doesn't exist
-        shm_id_ = shmget(shm_key_, sizeof(SharedMemoryBuffer), IPC_CREAT | SHM_PERMISSIONS);
+#ifdef SHM_HUGETLB
+        if (options_.huge_pages) {
+            shm_id_ = shmget(shm_key_, segment_size, IPC_CREAT | SHM_HUGETLB | SHM_PERMISSIONS);
+            if (shm_id_ == -1) {
+                LOG_WARNING("No huge pages for shared memory (%s), using normal pages", strerror(errno));
+            } else {
+                huge_pages_ = true;
+            }
+        }
+#endif
+        if (shm_id_ == -1) {
+            shm_id_ = shmget(shm_key_, segment_size, IPC_CREAT | SHM_PERMISSIONS);
+        }
         
         if (shm_id_ == -1) {
             LOG_ERROR("Failed to create shared memory: %s", strerror(errno));
@@ -502,18 +1085,18 @@ bool IPCSharedMemory::CreateSharedMemory() {
     
     // Attach to shared memory
 #ifdef _WIN32
-    shm_buffer_ = (SharedMemoryBuffer*)MapViewOfFile(shm_handle_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedMemoryBuffer));
-    if (shm_buffer_ == nullptr) {
+    shm_base_ = (char*)MapViewOfFile(shm_handle_, FILE_MAP_ALL_ACCESS, 0, 0, segment_size);
+    if (shm_base_ == nullptr) {
         LOG_ERROR("Failed to map shared memory: %lu", GetLastError());
         return false;
     }
 #else
-    shm_buffer_ = (SharedMemoryBuffer*)shmat(shm_id_, nullptr, 0);
+    shm_base_ = (char*)shmat(shm_id_, nullptr, 0);
 #endif
 
-    if (shm_buffer_ == (void*)-1) {
+    if (shm_base_ == (void*)-1) {
         LOG_ERROR("Failed to attach to shared memory: %s", strerror(errno));
-        shm_buffer_ = nullptr;
+        shm_base_ = nullptr;
         return false;
     }
 
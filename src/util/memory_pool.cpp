@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <cstdint>
 #include <iostream>
+#include <new>
 
 #ifdef _WIN32
 #include <intrin.h>
@@ -12,123 +14,213 @@
 namespace SAK {
 namespace memory {
 
+namespace {
+
+inline void*& NextBlock(void* block) {
+    return *static_cast<void**>(block);
+}
+
+char* AllocateChunk(size_t alignment, size_t bytes) {
+#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
+    // Use posix_memalign on supported platforms
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0) {
+        return nullptr;
+    }
+    return static_cast<char*>(p);
+#else
+    return static_cast<char*>(::operator new(bytes, std::align_val_t(alignment), std::nothrow));
+#endif
+}
+
+void FreeChunk(char* chunk, size_t alignment) {
+#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
+    // Use free for posix_memalign allocated memory
+    (void)alignment;
+    std::free(chunk);
+#else
+    ::operator delete(chunk, std::align_val_t(alignment));
+#endif
+}
+
+// Blocks each thread may hold per size class before returning half of them
+constexpr size_t kThreadCacheLimit = 64;
+constexpr size_t kThreadCacheBatch = kThreadCacheLimit / 2;
+
+} // namespace
+
 // FixedSizeMemoryPool implementation
 FixedSizeMemoryPool::FixedSizeMemoryPool(size_t block_size, size_t initial_blocks)
     : block_size_(block_size) {
+    assert(block_size_ >= sizeof(void*));
+
+    // Align to at least 64 bytes (cache line size), or a multiple of block_size
+    size_t alignment = std::max(static_cast<size_t>(64), block_size_);
+
+    // Ensure alignment is a power of 2
+    if (alignment & (alignment - 1)) {
+#ifdef _WIN32
+        // Windows doesn't have __builtin_clzl, use _BitScanReverse
+        unsigned long index = 0;
+        _BitScanReverse(&index, static_cast<unsigned long>(alignment));
+        alignment = static_cast<size_t>(1) << (static_cast<size_t>(index) + 1);
+#else
+        alignment = static_cast<size_t>(1) << (sizeof(size_t) * 8 - __builtin_clzl(alignment));
+#endif
+    }
+    alignment_ = alignment;
+
+    // Ensure block_size is a multiple of alignment
+    stride_ = ((block_size_ + alignment_ - 1) / alignment_) * alignment_;
+
     expand(initial_blocks);
 }
 
 FixedSizeMemoryPool::~FixedSizeMemoryPool() {
-    for (auto block : blocks_) {
-#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
-        // Use free for posix_memalign allocated memory
-        std::free(block);
-#else
-        // Use operator delete for operator new allocated memory
-        ::operator delete(block);
-#endif
+    for (auto chunk : chunks_) {
+        FreeChunk(chunk, alignment_);
     }
 }
 
 void FixedSizeMemoryPool::expand(size_t num_blocks) {
-    size_t old_size = blocks_.size();
-    blocks_.resize(old_size + num_blocks);
-    free_blocks_.reserve(free_blocks_.size() + num_blocks);
-    
-    for (size_t i = 0; i < num_blocks; ++i) {
-        // Use aligned_alloc to ensure memory alignment for improved access efficiency
-        // Align to at least 64 bytes (cache line size), or a multiple of block_size
-        size_t alignment = std::max(static_cast<size_t>(64), block_size_);
-        
-        // Ensure alignment is a power of 2
-        if (alignment & (alignment - 1)) {
-#ifdef _WIN32
-            // Windows doesn't have __builtin_clzl, use _BitScanReverse
-            unsigned long index = 0;
-            _BitScanReverse(&index, static_cast<unsigned long>(alignment));
-            alignment = static_cast<size_t>(1) << (static_cast<size_t>(index) + 1);
-#else
-            alignment = 1 << (sizeof(size_t) * 8 - __builtin_clzl(alignment));
-#endif
-        }
-        
-        // Ensure block_size is a multiple of alignment
-        size_t aligned_size = ((block_size_ + alignment - 1) / alignment) * alignment;
-        
-#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
-        // Use posix_memalign on supported platforms
-        void* p = nullptr;
-        if (posix_memalign(&p, alignment, aligned_size) != 0) {
-            // Failed to allocate, skip this block
-            continue;
-        }
-        blocks_[old_size + i] = static_cast<char*>(p);
-#else
-        // Fall back to standard allocation
-        blocks_[old_size + i] = static_cast<char*>(::operator new(aligned_size));
+    // Must be called with mutex already locked
+    if (num_blocks == 0) return;
+
+    // One allocation per expansion; every block keeps the per-block alignment
+    char* chunk = AllocateChunk(alignment_, stride_ * num_blocks);
+    if (!chunk) {
+        return;
+    }
+    chunks_.push_back(chunk);
+#ifdef MEMORY_POOL_VALIDATE_POINTERS
+    chunk_ranges_.emplace_back(chunk, num_blocks);
 #endif
-        
-        free_blocks_.push_back(blocks_[old_size + i]);
+
+    // Chain the new blocks in address order in front of the free list
+    for (size_t i = num_blocks; i-- > 0;) {
+        char* block = chunk + i * stride_;
+        NextBlock(block) = free_list_;
+        free_list_ = block;
     }
+    num_blocks_ += num_blocks;
+    num_free_ += num_blocks;
+}
+
+void FixedSizeMemoryPool::grow_if_empty() {
+    // Must be called with mutex already locked
+    if (free_list_) return;
+
+    // Expand the memory pool when there are no free blocks
+    // Use exponential growth strategy, limiting maximum growth
+    size_t new_blocks = std::min(num_blocks_, static_cast<size_t>(1024));
+    new_blocks = std::max(new_blocks, static_cast<size_t>(8));
+    expand(new_blocks);
 }
 
 void* FixedSizeMemoryPool::allocate() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (free_blocks_.empty()) {
-        // Expand the memory pool when there are no free blocks
-        // Use exponential growth strategy, limiting maximum growth
-        size_t current_size = blocks_.size();
-        size_t new_blocks = std::min(current_size, static_cast<size_t>(1024));
-        new_blocks = std::max(new_blocks, static_cast<size_t>(8));
-        expand(new_blocks);
+
+    grow_if_empty();
+    if (!free_list_) {
+        return nullptr;
     }
-    
+
     // Use LIFO strategy to improve cache locality
-    void* block = free_blocks_.back();
-    free_blocks_.pop_back();
-    
+    void* block = free_list_;
+    free_list_ = NextBlock(block);
+    --num_free_;
+
     // Clear memory block to avoid using uninitialized memory
     // Note: This may need to be disabled in performance-sensitive scenarios
 #ifdef MEMORY_POOL_ZERO_ON_ALLOCATE
     std::memset(block, 0, block_size_);
 #endif
-    
+
     return block;
 }
 
+void* FixedSizeMemoryPool::allocate_batch(size_t max_blocks, size_t& count) {
+    count = 0;
+    if (max_blocks == 0) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    grow_if_empty();
+    void* head = free_list_;
+    void* tail = nullptr;
+    while (free_list_ && count < max_blocks) {
+        tail = free_list_;
+        free_list_ = NextBlock(tail);
+        ++count;
+    }
+    if (tail) {
+        NextBlock(tail) = nullptr;
+    }
+    num_free_ -= count;
+    return count ? head : nullptr;
+}
+
 void FixedSizeMemoryPool::deallocate(void* ptr) {
     if (!ptr) return;
-    
+
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     // Validate that the pointer belongs to this memory pool
     // This is an O(n) operation and may impact performance in DEBUG mode
 #ifdef MEMORY_POOL_VALIDATE_POINTERS
     bool valid_ptr = false;
-    for (auto block : blocks_) {
-        if (ptr == block) {
+    char* p = static_cast<char*>(ptr);
+    for (const auto& range : chunk_ranges_) {
+        if (p >= range.first && p < range.first + range.second * stride_ &&
+            static_cast<size_t>(p - range.first) % stride_ == 0) {
             valid_ptr = true;
             break;
         }
     }
-    
+
     if (!valid_ptr) {
         std::cerr << "Warning: Attempted to deallocate pointer not from this pool" << std::endl;
         return;
     }
-    
+
     // Check for double free
-    for (auto free_block : free_blocks_) {
+    for (void* free_block = free_list_; free_block; free_block = NextBlock(free_block)) {
         if (ptr == free_block) {
             std::cerr << "Warning: Attempted to deallocate already freed pointer" << std::endl;
             return;
         }
     }
 #endif
-    
+
     // Add the pointer to the free list
-    free_blocks_.push_back(static_cast<char*>(ptr));
+    NextBlock(ptr) = free_list_;
+    free_list_ = ptr;
+    ++num_free_;
+}
+
+void FixedSizeMemoryPool::deallocate_batch(void* head, void* tail, size_t count) {
+    if (!head) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    NextBlock(tail) = free_list_;
+    free_list_ = head;
+    num_free_ += count;
+}
+
+size_t FixedSizeMemoryPool::num_blocks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_blocks_;
+}
+
+size_t FixedSizeMemoryPool::num_free_blocks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_free_;
+}
+
+double FixedSizeMemoryPool::usage_ratio() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_blocks_ == 0 ? 0.0 :
+        static_cast<double>(num_blocks_ - num_free_) / num_blocks_;
 }
 
 // MemoryPool implementation
@@ -160,35 +252,98 @@ MemoryPool& MemoryPool::GetInstance() {
     return instance;
 }
 
+// Blocks cached by one thread, chained per size class through their first word
+struct MemoryPool::ThreadCache {
+    void* heads[kNumPools] = {};
+    size_t counts[kNumPools] = {};
+
+    ~ThreadCache();
+};
+
+namespace {
+// Set once the calling thread's cache has been flushed at thread exit
+thread_local bool g_cache_retired = false;
+} // namespace
+
+MemoryPool::ThreadCache::~ThreadCache() {
+    g_cache_retired = true;
+    MemoryPool::GetInstance().FlushCache(*this);
+}
+
+MemoryPool::ThreadCache* MemoryPool::LocalCache() {
+#ifdef MEMORY_POOL_VALIDATE_POINTERS
+    // Validation happens in FixedSizeMemoryPool::deallocate, so never cache
+    return nullptr;
+#else
+    if (g_cache_retired) return nullptr;
+    thread_local ThreadCache cache;
+    return &cache;
+#endif
+}
+
+void MemoryPool::FlushCache(ThreadCache& cache) {
+    for (size_t i = 0; i < kNumPools; ++i) {
+        void* head = cache.heads[i];
+        if (!head) continue;
+        void* tail = head;
+        while (NextBlock(tail)) {
+            tail = NextBlock(tail);
+        }
+        pools_[i]->deallocate_batch(head, tail, cache.counts[i]);
+        cache.heads[i] = nullptr;
+        cache.counts[i] = 0;
+    }
+}
+
+size_t MemoryPool::PoolIndex(size_t size) {
+    // One entry per 8-byte step; every block size is a multiple of 8
+    struct SizeTable {
+        uint8_t index[kMaxSmallSize / 8 + 1];
+
+        constexpr SizeTable() : index() {
+            size_t pool = 0;
+            for (size_t i = 0; i <= kMaxSmallSize / 8; ++i) {
+                while (kSmallBlockSizes[pool] < i * 8) {
+                    ++pool;
+                }
+                index[i] = static_cast<uint8_t>(pool);
+            }
+        }
+    };
+    static constexpr SizeTable table;
+    return table.index[(size + 7) / 8];
+}
+
 void* MemoryPool::Allocate(size_t size) {
     void* ptr = nullptr;
 
     // For small memory blocks, use fixed-size memory pools
-    if (size > 0 && size <= kSmallBlockSizes[kNumPools - 1]) {
-        // Use binary search to find the appropriate memory pool
-        // This is more efficient than linear search, especially when there are many memory pools
-        int left = 0;
-        int right = static_cast<int>(kNumPools) - 1;
-
-        while (left <= right) {
-            int mid = left + (right - left) / 2;
-
-            if (kSmallBlockSizes[mid] < size) {
-                left = mid + 1;
-            } else if (mid > 0 && kSmallBlockSizes[mid - 1] >= size) {
-                right = mid - 1;
-            } else {
-                // Found the appropriate memory pool
-                ptr = pools_[mid]->allocate();
-                if (ptr) {
-                    // Update statistics only after successful allocation
-                    std::lock_guard<std::mutex> lock(stats_mutex_);
-                    ++total_allocations_;
-                    ++current_allocations_;
-                }
-                return ptr;
+    if (size > 0 && size <= kMaxSmallSize) {
+        size_t index = PoolIndex(size);
+        ThreadCache* cache = LocalCache();
+        if (cache) {
+            // Refill the thread cache with one batch under a single pool lock
+            if (!cache->heads[index]) {
+                cache->heads[index] = pools_[index]->allocate_batch(kThreadCacheBatch, cache->counts[index]);
             }
+            ptr = cache->heads[index];
+            if (ptr) {
+                cache->heads[index] = NextBlock(ptr);
+                --cache->counts[index];
+#ifdef MEMORY_POOL_ZERO_ON_ALLOCATE
+                std::memset(ptr, 0, kSmallBlockSizes[index]);
+#endif
+            }
+        } else {
+            ptr = pools_[index]->allocate();
         }
+
+        if (ptr) {
+            // Update statistics only after successful allocation
+            total_allocations_.fetch_add(1, std::memory_order_relaxed);
+            current_allocations_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return ptr;
     }
     
     // For large memory blocks, use the global allocator
@@ -205,12 +360,9 @@ void* MemoryPool::Allocate(size_t size) {
         }
         large_allocations_[ptr] = aligned_size;
 
-        // Update statistics only after successful allocation (within same lock to prevent race)
-        {
-            std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-            ++total_allocations_;
-            ++current_allocations_;
-        }
+        // Update statistics only after successful allocation
+        total_allocations_.fetch_add(1, std::memory_order_relaxed);
+        current_allocations_.fetch_add(1, std::memory_order_relaxed);
     }
 
     return ptr;
@@ -220,18 +372,34 @@ void MemoryPool::Deallocate(void* ptr, size_t size) {
     if (!ptr) return;
 
     // For small memory blocks, return to the corresponding memory pool
-    if (size > 0) {
-        for (size_t i = 0; i < kNumPools; ++i) {
-            if (size <= kSmallBlockSizes[i]) {
-                pools_[i]->deallocate(ptr);
-                // Update statistics only after successful deallocation
-                {
-                    std::lock_guard<std::mutex> lock(stats_mutex_);
-                    --current_allocations_;
+    if (size > 0 && size <= kMaxSmallSize) {
+        size_t index = PoolIndex(size);
+        ThreadCache* cache = LocalCache();
+        if (cache) {
+            NextBlock(ptr) = cache->heads[index];
+            cache->heads[index] = ptr;
+            // Hand the oldest half back in one batch once the cache overflows
+            if (++cache->counts[index] > kThreadCacheLimit) {
+                void* keep_tail = ptr;
+                for (size_t i = 1; i < cache->counts[index] - kThreadCacheBatch; ++i) {
+                    keep_tail = NextBlock(keep_tail);
+                }
+                void* head = NextBlock(keep_tail);
+                void* tail = head;
+                while (NextBlock(tail)) {
+                    tail = NextBlock(tail);
                 }
-                return;
+                NextBlock(keep_tail) = nullptr;
+                pools_[index]->deallocate_batch(head, tail, kThreadCacheBatch);
+                cache->counts[index] -= kThreadCacheBatch;
             }
+        } else {
+            pools_[index]->deallocate(ptr);
         }
+
+        // Update statistics only after successful deallocation
+        current_allocations_.fetch_sub(1, std::memory_order_relaxed);
+        return;
     }
     
     // For large memory blocks, release directly
@@ -252,11 +420,8 @@ void MemoryPool::Deallocate(void* ptr, size_t size) {
             ::operator delete(ptr);
             large_allocations_.erase(it);
 
-            // Update statistics only after successful deallocation (within same lock to prevent race)
-            {
-                std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-                --current_allocations_;
-            }
+            // Update statistics only after successful deallocation
+            current_allocations_.fetch_sub(1, std::memory_order_relaxed);
         } else {
             // Attempt to deallocate unknown pointer
             // This may be due to the user passing an incorrect pointer
@@ -289,6 +454,11 @@ double MemoryPool::GetMemoryUsage() const {
 void MemoryPool::Trim() {
     // This method attempts to release some unused memory
     // Note: This is an expensive operation and should be called when memory pressure is high
+
+    // Blocks parked in the calling thread's cache go back to the shared pools
+    if (ThreadCache* cache = LocalCache()) {
+        FlushCache(*cache);
+    }
     
     // Currently, we do not actually release memory, as this may cause performance issues
     // In a real-world application, a more complex memory recovery strategy can be implemented
@@ -301,12 +471,10 @@ void MemoryPool::Trim() {
 }
 
 void MemoryPool::PrintStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    
     std::cout << "Memory Pool Statistics:" << std::endl;
-    std::cout << "  Total allocations: " << total_allocations_ << std::endl;
-    std::cout << "  Current allocations: " << current_allocations_ << std::endl;
-    std::cout << "  Large allocations: " << large_allocations_.size() << std::endl;
+    std::cout << "  Total allocations: " << GetTotalAllocations() << std::endl;
+    std::cout << "  Current allocations: " << GetCurrentAllocations() << std::endl;
+    std::cout << "  Large allocations: " << GetLargeAllocations() << std::endl;
     std::cout << "  Overall memory usage: " << (GetMemoryUsage() * 100.0) << "%" << std::endl;
     
     std::cout << "  Pool statistics:" << std::endl;
@@ -3,9 +3,268 @@
 #include <atomic>
 #include <mutex>
 #include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace SAK {
 
+namespace {
+
+std::atomic<bool> g_numa_aware{false};
+
+// Uses the raw syscalls so that no libnuma link dependency is needed
+uint32_t CurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+bool BindToNode(void* mem, size_t length, uint32_t node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node >= MAX_NUMA_NODES) return false;
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_mbind, mem, length, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+    (void)mem;
+    (void)length;
+    (void)node;
+    return false;
+#endif
+}
+
+void* MapMemory(size_t length) {
+#ifdef _WIN32
+    return VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* mem = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return mem == MAP_FAILED ? nullptr : mem;
+#endif
+}
+
+void UnmapMemory(void* mem, size_t length) {
+#ifdef _WIN32
+    (void)length;
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, length);
+#endif
+}
+
+void BindToOwnerNode(ThreadCache* tc, void* mem, size_t length) {
+    if (tc && g_numa_aware.load(std::memory_order_relaxed)) {
+        bool bound = BindToNode(mem, length, tc->numa_node);
+        MemoryPoolV2::GetInstance().RecordNumaMapping(length, bound);
+    }
+}
+
+// Binds a fresh mapping to the owner's node before any page is touched
+void* MapNodeMemory(ThreadCache* tc, size_t length) {
+    void* mem = MapMemory(length);
+    if (mem) BindToOwnerNode(tc, mem, length);
+    return mem;
+}
+
+bool SetSlabMapped(const void* slab, bool mapped);
+
+// Slabs are mapped directly so that Trim() can hand them back to the OS;
+// returning them to malloc would keep the pages resident in the heap. They
+// must be SLAB_SIZE-aligned for SlabOf() to work.
+void* MapSlabMemory(ThreadCache* tc) {
+#ifdef _WIN32
+    // VirtualAlloc returns allocation-granularity (64 KiB) aligned regions
+    static_assert(SLAB_SIZE <= 65536, "SLAB_SIZE exceeds the Windows allocation granularity");
+    void* mem = MapMemory(SLAB_SIZE);
+#else
+    char* raw = static_cast<char*>(MapMemory(2 * SLAB_SIZE));
+    if (!raw) return nullptr;
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + SLAB_SIZE - 1) & ~static_cast<uintptr_t>(SLAB_SIZE - 1);
+    char* mem = reinterpret_cast<char*>(aligned);
+    if (mem != raw) {
+        UnmapMemory(raw, mem - raw);
+    }
+    if (mem + SLAB_SIZE != raw + 2 * SLAB_SIZE) {
+        UnmapMemory(mem + SLAB_SIZE, raw + 2 * SLAB_SIZE - (mem + SLAB_SIZE));
+    }
+#endif
+    if (mem) BindToOwnerNode(tc, mem, SLAB_SIZE);
+    return mem;
+}
+
+void UnmapSlabMemory(Slab* slab) {
+    SetSlabMapped(slab, false);
+    UnmapMemory(slab, SLAB_SIZE);
+}
+
+void ReleaseMediumBlock(BlockHeader* header) {
+    if (header->flags & MEDIUM_MAPPED) {
+        UnmapMemory(header, header->actual_size + sizeof(BlockHeader));
+    } else {
+        free(header);
+    }
+}
+
+// Free small blocks are chained through their first word
+inline void*& NextFree(void* block) {
+    return *static_cast<void**>(block);
+}
+
+// Two-level radix map marking which SLAB_SIZE-aligned regions are live slabs,
+// so a pointer can be classified without trusting a caller-supplied size.
+// Leaves are mapped on demand and never freed.
+constexpr unsigned kSlabShift = 15;
+static_assert((size_t(1) << kSlabShift) == SLAB_SIZE, "kSlabShift must match SLAB_SIZE");
+constexpr unsigned kAddressBits = sizeof(void*) == 8 ? 48 : 32;
+constexpr unsigned kLeafBits = sizeof(void*) == 8 ? 16 : kAddressBits - kSlabShift;
+constexpr unsigned kRootBits = kAddressBits - kSlabShift - kLeafBits;
+constexpr size_t kLeafSize = size_t(1) << kLeafBits;
+
+std::atomic<std::atomic<uint8_t>*> g_slab_map[size_t(1) << kRootBits];
+
+bool SetSlabMapped(const void* slab, bool mapped) {
+    uint64_t addr = reinterpret_cast<uintptr_t>(slab);
+    if (addr >> kAddressBits) return false;
+    std::atomic<std::atomic<uint8_t>*>& root = g_slab_map[addr >> (kSlabShift + kLeafBits)];
+    std::atomic<uint8_t>* leaf = root.load(std::memory_order_acquire);
+    if (!leaf) {
+        if (!mapped) return true;
+        auto* fresh = static_cast<std::atomic<uint8_t>*>(MapMemory(kLeafSize));
+        if (!fresh) return false;
+        if (root.compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            leaf = fresh;
+        } else {
+            UnmapMemory(fresh, kLeafSize);
+        }
+    }
+    leaf[(addr >> kSlabShift) & (kLeafSize - 1)].store(mapped ? 1 : 0, std::memory_order_release);
+    return true;
+}
+
+// Per-class shared set of block batches. A batch is referenced by its first
+// block; slots are claimed and emptied with a single CAS each, so no ABA tag
+// is needed and the blocks themselves carry no extra link.
+struct alignas(64) TransferCache {
+    std::atomic<void*> slots[TRANSFER_MAX_BATCHES];
+    std::atomic<size_t> batch_count;
+};
+
+struct TransferLimits {
+    std::atomic<size_t> high_watermark;
+    std::atomic<size_t> batch_size;
+    std::atomic<size_t> high_blocks[NUM_SIZE_CLASSES];
+    std::atomic<size_t> batch_blocks[NUM_SIZE_CLASSES];
+};
+
+TransferCache g_transfer_cache[NUM_SIZE_CLASSES];
+TransferLimits g_transfer_limits;
+
+bool PushBatch(TransferCache& central, void* batch) {
+    if (central.batch_count.load(std::memory_order_relaxed) >= TRANSFER_MAX_BATCHES) return false;
+    for (auto& slot : central.slots) {
+        void* expected = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr &&
+            slot.compare_exchange_strong(expected, batch, std::memory_order_release, std::memory_order_relaxed)) {
+            central.batch_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void* PopBatch(TransferCache& central) {
+    if (central.batch_count.load(std::memory_order_relaxed) == 0) return nullptr;
+    for (auto& slot : central.slots) {
+        void* batch = slot.load(std::memory_order_relaxed);
+        if (batch && slot.compare_exchange_strong(batch, nullptr, std::memory_order_acquire, std::memory_order_relaxed)) {
+            central.batch_count.fetch_sub(1, std::memory_order_relaxed);
+            return batch;
+        }
+    }
+    return nullptr;
+}
+
+// Every block away from its owner's lists, allocated, in the transfer cache or
+// adopted by another thread, holds one reference on the owning cache
+inline void* TakeFromPrivateList(ThreadCache* tc, SizeClassBin& bin) {
+    void* block = bin.private_list;
+    bin.private_list = NextFree(block);
+    if (bin.free_blocks > 0) bin.free_blocks--;
+    tc->alloc_count++;
+    // Foreign blocks carry their reference over from the transfer or adoption
+    if (SlabOf(block)->owner == tc) {
+        tc->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return block;
+}
+
+// The last reference frees a cache whose thread has exited
+void ReleaseCacheRef(ThreadCache* tc) {
+    if (tc->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        MemoryPoolV2::GetInstance().RemoveFromDeadCaches(tc);
+        CleanupDeadCache(tc);
+    }
+}
+
+// Hands a block back through its owner's mailbox. The reference is dropped
+// only afterwards, so the owner cannot be freed under the push.
+void ReturnToOwner(void* block) {
+    Slab* slab = SlabOf(block);
+    ThreadCache* owner = slab->owner;
+    std::atomic<void*>& mailbox = owner->bins[slab->size_class].mailbox;
+    void* old_head = mailbox.load(std::memory_order_relaxed);
+    do {
+        NextFree(block) = old_head;
+    } while (!mailbox.compare_exchange_weak(old_head, block, std::memory_order_release, std::memory_order_relaxed));
+    ReleaseCacheRef(owner);
+}
+
+inline void PushToPrivateList(ThreadCache* tc, size_t class_idx, void* block) {
+    SizeClassBin& bin = tc->bins[class_idx];
+    NextFree(block) = bin.private_list;
+    bin.private_list = block;
+    tc->free_count++;
+    size_t high = g_transfer_limits.high_blocks[class_idx].load(std::memory_order_relaxed);
+    if (++bin.free_blocks > high && high != 0) {
+        ReleaseToTransferCache(tc, class_idx);
+    }
+}
+
+} // namespace
+
+Slab::Slab(ThreadCache* tc, size_t class_idx)
+    : owner(tc)
+    , block_size(SIZE_CLASSES[class_idx])
+    , num_blocks(BlocksPerSlab(class_idx))
+    , free_count(0)
+    , next(nullptr)
+    , size_class(static_cast<uint16_t>(class_idx)) {
+#ifdef MEMORY_POOL_V2_DEBUG
+    magic = MAGIC_VALUE;
+#endif
+}
+
+bool IsSmallBlock(const void* ptr) {
+    uint64_t addr = reinterpret_cast<uintptr_t>(ptr);
+    if (addr >> kAddressBits) return false;
+    std::atomic<uint8_t>* leaf = g_slab_map[addr >> (kSlabShift + kLeafBits)].load(std::memory_order_acquire);
+    return leaf && leaf[(addr >> kSlabShift) & (kLeafSize - 1)].load(std::memory_order_acquire) != 0;
+}
+
 size_t FindSizeClass(size_t size) {
     if (size == 0) size = 1;
     
@@ -19,6 +278,8 @@ size_t FindSizeClass(size_t size) {
 }
 
 thread_local ThreadCache* g_thread_cache = nullptr;
+// Set once the thread's cache is torn down; later calls run without a cache
+thread_local bool g_thread_cache_retired = false;
 
 void CleanupDeadCache(ThreadCache* tc) {
     if (!tc) return;
@@ -28,14 +289,16 @@ void CleanupDeadCache(ThreadCache* tc) {
         Slab* slab = tc->slabs[i];
         while (slab) {
             Slab* next = slab->next;
-            free(slab->memory);
-            delete slab;
+            UnmapSlabMemory(slab);
             slab = next;
         }
         tc->slabs[i] = nullptr;
     }
     
-    delete tc;
+    // Thread caches are mapped directly so that a global operator new routed to
+    // the pool never recurses into itself
+    tc->~ThreadCache();
+    UnmapMemory(tc, sizeof(ThreadCache));
 }
 
 void CleanupThreadCache() {
@@ -45,31 +308,41 @@ void CleanupThreadCache() {
     
     // Clean up medium object cache
     for (size_t i = 0; i < tc->medium_count; ++i) {
-        free(tc->medium_cache[i].ptr);
+        ReleaseMediumBlock(static_cast<BlockHeader*>(tc->medium_cache[i].ptr));
     }
     tc->medium_count = 0;
+
+    // Foreign blocks on the free lists would otherwise pin their owners forever
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+        void** link = &tc->bins[i].private_list;
+        while (void* block = *link) {
+            if (SlabOf(block)->owner != tc) {
+                *link = NextFree(block);
+                ReturnToOwner(block);
+            } else {
+                link = &NextFree(block);
+            }
+        }
+    }
     
     // Mark as dead
     tc->dead.store(true, std::memory_order_release);
     
-    // Decrement ref count (thread exit is equivalent to releasing one reference)
-    size_t old_ref = tc->ref_count.fetch_sub(1, std::memory_order_acq_rel);
-    
-    if (old_ref == 1) {
-        // Ref count dropped to 0, remove from thread_caches_ and cleanup immediately (not added to dead_caches_)
-        MemoryPoolV2::GetInstance().UnregisterThreadOnly(tc);
-        CleanupDeadCache(tc);
-    } else {
-        // Still has outstanding blocks, transfer to dead_caches_ for later cleanup
-        MemoryPoolV2::GetInstance().UnregisterThread(tc);
-    }
+    // Listed as dead before the thread's own reference goes, so whichever
+    // release turns out to be the last finds it there
+    MemoryPoolV2::GetInstance().UnregisterThread(tc);
+    ReleaseCacheRef(tc);
     
     g_thread_cache = nullptr;
+    g_thread_cache_retired = true;
 }
 
 ThreadCache* GetOrCreateThreadCache() {
     if (!g_thread_cache) {
-        g_thread_cache = new ThreadCache();
+        if (g_thread_cache_retired) return nullptr;
+        void* mem = MapMemory(sizeof(ThreadCache));
+        if (!mem) return nullptr;
+        g_thread_cache = new (mem) ThreadCache();
         MemoryPoolV2::GetInstance().RegisterThread(g_thread_cache);
 
         static thread_local struct ThreadCacheCleanup {
@@ -83,42 +356,161 @@ ThreadCache* GetOrCreateThreadCache() {
 }
 
 void RefillFromSlab(ThreadCache* tc, size_t class_idx) {
-    size_t block_size = SIZE_CLASSES[class_idx];
-    size_t total_size = block_size + sizeof(BlockHeader);
-    
-    void* slab_mem = malloc(SLAB_SIZE);
+    void* slab_mem = MapSlabMemory(tc);
     if (!slab_mem) return;  // OOM
+    if (!SetSlabMapped(slab_mem, true)) {
+        UnmapMemory(slab_mem, SLAB_SIZE);
+        return;
+    }
     
-    Slab* slab = new Slab();
-    slab->memory = slab_mem;
-    slab->block_size = block_size;
-    slab->num_blocks = SLAB_SIZE / total_size;
-    slab->free_count.store(0, std::memory_order_relaxed);
+    Slab* slab = new (slab_mem) Slab(tc, class_idx);
     slab->next = tc->slabs[class_idx];
     tc->slabs[class_idx] = slab;
     
-    char* ptr = static_cast<char*>(slab_mem);
+    SizeClassBin& bin = tc->bins[class_idx];
+    char* ptr = static_cast<char*>(slab_mem) + SLAB_HEADER_SIZE;
     for (size_t i = 0; i < slab->num_blocks; ++i) {
-        BlockHeader* header = reinterpret_cast<BlockHeader*>(ptr);
-        header->size_class = static_cast<uint16_t>(class_idx);
-        header->flags = 0;
-        header->owner = tc;
-        
-#ifdef MEMORY_POOL_V2_DEBUG
-        header->magic = BlockHeader::MAGIC_VALUE;
-#endif
-        
-        header->next = tc->bins[class_idx].private_list;
-        tc->bins[class_idx].private_list = header;
-        
-        ptr += total_size;
+        NextFree(ptr) = bin.private_list;
+        bin.private_list = ptr;
+        ptr += slab->block_size;
     }
+    bin.free_blocks += slab->num_blocks;
     
     MemoryPoolV2::GetInstance().RecordSlabRefill();
 }
 
+size_t TrimThreadCache(ThreadCache* tc) {
+    if (!tc) return 0;
+    tc->trim_requested.store(false, std::memory_order_relaxed);
+
+    size_t released = 0;
+    for (size_t class_idx = 0; class_idx < NUM_SIZE_CLASSES; ++class_idx) {
+        if (!tc->slabs[class_idx]) continue;
+        SizeClassBin& bin = tc->bins[class_idx];
+
+        // Fold cross-thread frees into the private list so they are counted
+        void* mailbox_head = bin.mailbox.exchange(nullptr, std::memory_order_acquire);
+        if (mailbox_head) {
+            MemoryPoolV2::GetInstance().RecordMailboxDrain();
+            void* tail = mailbox_head;
+            while (NextFree(tail)) {
+                tail = NextFree(tail);
+            }
+            NextFree(tail) = bin.private_list;
+            bin.private_list = mailbox_head;
+        }
+
+        for (Slab* slab = tc->slabs[class_idx]; slab; slab = slab->next) {
+            slab->free_count.store(0, std::memory_order_relaxed);
+        }
+
+        // Blocks adopted from dead caches belong to foreign slabs and are skipped
+        for (void* block = bin.private_list; block; block = NextFree(block)) {
+            Slab* slab = SlabOf(block);
+            if (slab->owner == tc) {
+                slab->free_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Drop blocks of fully free slabs from the free list, preserving order
+        void** link = &bin.private_list;
+        bin.free_blocks = 0;
+        while (*link) {
+            void* block = *link;
+            Slab* slab = SlabOf(block);
+            if (slab->owner == tc && slab->free_count.load(std::memory_order_relaxed) == slab->num_blocks) {
+                *link = NextFree(block);
+            } else {
+                link = &NextFree(block);
+                bin.free_blocks++;
+            }
+        }
+
+        Slab** slab_link = &tc->slabs[class_idx];
+        while (*slab_link) {
+            Slab* slab = *slab_link;
+            if (slab->free_count.load(std::memory_order_relaxed) == slab->num_blocks) {
+                *slab_link = slab->next;
+                UnmapSlabMemory(slab);
+                released += SLAB_SIZE;
+                MemoryPoolV2::GetInstance().RecordSlabRelease(SLAB_SIZE);
+            } else {
+                slab_link = &slab->next;
+            }
+        }
+    }
+
+    return released;
+}
+
+bool RefillFromTransferCache(ThreadCache* tc, size_t class_idx) {
+    void* batch = PopBatch(g_transfer_cache[class_idx]);
+    if (!batch) return false;
+
+    size_t count = 1;
+    void* last = batch;
+    while (NextFree(last)) {
+        last = NextFree(last);
+        count++;
+    }
+
+    // Blocks coming home drop the reference taken when they were handed off
+    size_t own = 0;
+    for (void* block = batch; block; block = NextFree(block)) {
+        own += SlabOf(block)->owner == tc;
+    }
+    if (own) {
+        tc->ref_count.fetch_sub(own, std::memory_order_relaxed);
+    }
+
+    SizeClassBin& bin = tc->bins[class_idx];
+    NextFree(last) = bin.private_list;
+    bin.private_list = batch;
+    bin.free_blocks += count;
+    MemoryPoolV2::GetInstance().RecordTransferIn();
+    return true;
+}
+
+void ReleaseToTransferCache(ThreadCache* tc, size_t class_idx) {
+    TransferCache& central = g_transfer_cache[class_idx];
+    if (central.batch_count.load(std::memory_order_relaxed) >= TRANSFER_MAX_BATCHES) return;
+
+    size_t batch_blocks = g_transfer_limits.batch_blocks[class_idx].load(std::memory_order_relaxed);
+    SizeClassBin& bin = tc->bins[class_idx];
+    void* hot = bin.private_list;
+    if (!hot || !NextFree(hot) || batch_blocks == 0) return;
+
+    // Keep the most recently freed block local and hand off the ones behind it.
+    // Own blocks pin this cache so their slab outlives the handoff; adopted
+    // ones already pin theirs.
+    void* first = NextFree(hot);
+    void* last = first;
+    size_t count = 1;
+    size_t own = SlabOf(first)->owner == tc;
+    while (count < batch_blocks && NextFree(last)) {
+        last = NextFree(last);
+        own += SlabOf(last)->owner == tc;
+        count++;
+    }
+    NextFree(hot) = NextFree(last);
+    NextFree(last) = nullptr;
+    tc->ref_count.fetch_add(own, std::memory_order_relaxed);
+
+    if (!PushBatch(central, first)) {
+        // Lost the race for the last slot; put the batch back
+        tc->ref_count.fetch_sub(own, std::memory_order_relaxed);
+        NextFree(last) = NextFree(hot);
+        NextFree(hot) = first;
+        return;
+    }
+
+    bin.free_blocks = bin.free_blocks > count ? bin.free_blocks - count : 0;
+    MemoryPoolV2::GetInstance().RecordTransferOut();
+}
+
 void* AllocateSmall(size_t size) {
     ThreadCache* tc = GetOrCreateThreadCache();
+    if (!tc) return AllocateLarge(size);  // Thread is exiting
     size_t class_idx = FindSizeClass(size);
     if (class_idx >= NUM_SIZE_CLASSES) {
         return nullptr;
@@ -126,31 +518,23 @@ void* AllocateSmall(size_t size) {
     
     SizeClassBin& bin = tc->bins[class_idx];
     if (bin.private_list) {
-        BlockHeader* header = static_cast<BlockHeader*>(bin.private_list);
-        bin.private_list = header->next;
-        tc->alloc_count++;
-        tc->ref_count.fetch_add(1, std::memory_order_relaxed);
-        return reinterpret_cast<char*>(header) + sizeof(BlockHeader);
+        return TakeFromPrivateList(tc, bin);
     }
 
     void* mailbox_head = bin.mailbox.exchange(nullptr, std::memory_order_acquire);
     if (mailbox_head != nullptr) {
         MemoryPoolV2::GetInstance().RecordMailboxDrain();
-        BlockHeader* header = static_cast<BlockHeader*>(mailbox_head);
-        bin.private_list = header->next;
-        tc->alloc_count++;
-        tc->ref_count.fetch_add(1, std::memory_order_relaxed);
-        return reinterpret_cast<char*>(header) + sizeof(BlockHeader);
+        bin.private_list = mailbox_head;
+        return TakeFromPrivateList(tc, bin);
     }
 
-    RefillFromSlab(tc, class_idx);
+    // Reuse another thread's surplus before carving a new slab
+    if (!RefillFromTransferCache(tc, class_idx)) {
+        RefillFromSlab(tc, class_idx);
+    }
     
     if (bin.private_list) {
-        BlockHeader* header = static_cast<BlockHeader*>(bin.private_list);
-        bin.private_list = header->next;
-        tc->alloc_count++;
-        tc->ref_count.fetch_add(1, std::memory_order_relaxed);
-        return reinterpret_cast<char*>(header) + sizeof(BlockHeader);
+        return TakeFromPrivateList(tc, bin);
     }
     
     return nullptr;
@@ -158,46 +542,41 @@ void* AllocateSmall(size_t size) {
 
 void DeallocateSmall(void* ptr) {
     if (!ptr) return;
-    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - sizeof(BlockHeader));
+    Slab* slab = SlabOf(ptr);
+    ThreadCache* owner = slab->owner;
     ThreadCache* tc = GetOrCreateThreadCache();
-    size_t class_idx = header->size_class;
+    size_t class_idx = slab->size_class;
 
-    if (header->owner == tc) {
-        // Return to private list
-        header->next = tc->bins[class_idx].private_list;
-        tc->bins[class_idx].private_list = header;
-        tc->free_count++;
-        
+    if (owner == tc) {
         // Decrement ref count
         tc->ref_count.fetch_sub(1, std::memory_order_relaxed);
+
+        // Return to private list
+        PushToPrivateList(tc, class_idx, ptr);
+
+        if (tc->trim_requested.load(std::memory_order_relaxed)) {
+            TrimThreadCache(tc);
+        }
     }
-    else if (header->owner->dead.load(std::memory_order_acquire)) {
-        // Owner thread is dead, decrement ref count
-        // The ThreadCache will be cleaned up in MemoryPoolV2 destructor
-        header->owner->ref_count.fetch_sub(1, std::memory_order_acq_rel);
-        
-        // Reclaim block to current thread
-        header->owner = tc;
-        header->next = tc->bins[class_idx].private_list;
-        tc->bins[class_idx].private_list = header;
-        tc->free_count++;
+    else if (owner->dead.load(std::memory_order_acquire)) {
+        // Reclaim block to current thread; it keeps the dead cache's slab
+        // alive until the block goes back to it. An exiting thread has no
+        // list to put it on, so the block is dropped.
+        if (tc) {
+            PushToPrivateList(tc, class_idx, ptr);
+        } else {
+            ReleaseCacheRef(owner);
+        }
     }
     else {
         MemoryPoolV2::GetInstance().RecordCrossThreadFree();
-        
-        // Decrement owner ref count
-        header->owner->ref_count.fetch_sub(1, std::memory_order_relaxed);
-        
-        std::atomic<void*>& mailbox = header->owner->bins[class_idx].mailbox;
-        void* old_head = mailbox.load(std::memory_order_relaxed);
-        do {
-            header->next = old_head;
-        } while (!mailbox.compare_exchange_weak(old_head, header, std::memory_order_release, std::memory_order_relaxed));
+        ReturnToOwner(ptr);
     }
 }
 
 void* AllocateMedium(size_t size) {
     ThreadCache* tc = GetOrCreateThreadCache();
+    if (!tc) return AllocateLarge(size);  // Thread is exiting
     for (size_t i = 0; i < tc->medium_count; i++) {
         if (tc->medium_cache[i].size >= size &&
             tc->medium_cache[i].size < size * 2) {
@@ -210,12 +589,13 @@ void* AllocateMedium(size_t size) {
     }
 
     size_t total_size = size + sizeof(BlockHeader);
-    void* mem = malloc(total_size);
+    bool mapped = g_numa_aware.load(std::memory_order_relaxed);
+    void* mem = mapped ? MapNodeMemory(tc, total_size) : malloc(total_size);
     if (!mem) return nullptr;
     
     BlockHeader* header = static_cast<BlockHeader*>(mem);
     header->size_class = MEDIUM_OBJECT;  // 0xFFFE
-    header->flags = 0;
+    header->flags = mapped ? MEDIUM_MAPPED : 0;
     header->owner = tc;
     header->next = nullptr;
     header->actual_size = size;
@@ -233,7 +613,7 @@ void DeallocateMedium(void* ptr) {
     BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - sizeof(BlockHeader));
     ThreadCache* tc = GetOrCreateThreadCache();
     if (header->owner != tc) {
-        free(header);
+        ReleaseMediumBlock(header);
         return;
     }
 
@@ -245,7 +625,7 @@ void DeallocateMedium(void* ptr) {
         return;
     }
     else {
-        free(header);
+        ReleaseMediumBlock(header);
         tc->free_count++;
     }
 }
@@ -261,6 +641,7 @@ void* AllocateLarge(size_t size) {
     header->flags = LARGE_DIRECT;
     header->owner = nullptr;
     header->next = nullptr;
+    header->actual_size = size;
 
 #ifdef MEMORY_POOL_V2_DEBUG
     header->magic = BlockHeader::MAGIC_VALUE;
@@ -277,11 +658,7 @@ void DeallocateLarge(void* ptr) {
 }
 
 MemoryPoolV2::MemoryPoolV2() {
-    stats_.total_allocated = 0;
-    stats_.total_deallocated = 0;
-    stats_.cross_thread_frees = 0;
-    stats_.slab_refills = 0;
-    stats_.mailbox_drains = 0;
+    SetTransferWatermarks(TRANSFER_HIGH_WATERMARK, TRANSFER_BATCH_SIZE);
 }
 
 MemoryPoolV2::~MemoryPoolV2() {
@@ -295,11 +672,15 @@ MemoryPoolV2::~MemoryPoolV2() {
 }
 
 MemoryPoolV2& MemoryPoolV2::GetInstance() {
-    static MemoryPoolV2 instance;
-    return instance;
+    // Never destroyed: blocks may still be freed from other static destructors,
+    // notably when the global operator new hook is linked in
+    alignas(MemoryPoolV2) static unsigned char storage[sizeof(MemoryPoolV2)];
+    static MemoryPoolV2* instance = new (storage) MemoryPoolV2();
+    return *instance;
 }
 
 void MemoryPoolV2::RegisterThread(ThreadCache* tc) {
+    tc->numa_node = CurrentNumaNode();
     std::lock_guard<std::mutex> lock(registry_mutex_);
     thread_caches_[std::this_thread::get_id()] = tc;
 }
@@ -307,16 +688,13 @@ void MemoryPoolV2::RegisterThread(ThreadCache* tc) {
 void MemoryPoolV2::UnregisterThread(ThreadCache* tc) {
     if (!tc) return;
     std::lock_guard<std::mutex> lock(registry_mutex_);
+#ifndef MEMORY_POOL_V2_NO_STATS
+    RetireStats(tc);
+#endif
     thread_caches_.erase(std::this_thread::get_id());
     dead_caches_.push_back(tc);
 }
 
-void MemoryPoolV2::UnregisterThreadOnly(ThreadCache* tc) {
-    if (!tc) return;
-    std::lock_guard<std::mutex> lock(registry_mutex_);
-    thread_caches_.erase(std::this_thread::get_id());
-}
-
 void MemoryPoolV2::RemoveFromDeadCaches(ThreadCache* tc) {
     if (!tc) return;
     std::lock_guard<std::mutex> lock(registry_mutex_);
@@ -326,6 +704,51 @@ void MemoryPoolV2::RemoveFromDeadCaches(ThreadCache* tc) {
     }
 }
 
+size_t MemoryPoolV2::DeadCacheCount() const {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    return dead_caches_.size();
+}
+
+size_t MemoryPoolV2::Trim() {
+    return TrimThreadCache(GetOrCreateThreadCache());
+}
+
+void MemoryPoolV2::RequestTrim() {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (auto& entry : thread_caches_) {
+        entry.second->trim_requested.store(true, std::memory_order_relaxed);
+    }
+}
+
+void MemoryPoolV2::SetTransferWatermarks(size_t high_watermark, size_t batch_size) {
+    g_transfer_limits.high_watermark.store(high_watermark, std::memory_order_relaxed);
+    g_transfer_limits.batch_size.store(batch_size, std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+        size_t total_size = SIZE_CLASSES[i];
+        size_t batch_blocks = std::max<size_t>(batch_size / total_size, 1);
+        g_transfer_limits.batch_blocks[i].store(batch_blocks, std::memory_order_relaxed);
+        // A non-zero watermark always leaves at least one batch worth in the list
+        size_t high_blocks = high_watermark ? std::max(high_watermark / total_size, batch_blocks) : 0;
+        g_transfer_limits.high_blocks[i].store(high_blocks, std::memory_order_relaxed);
+    }
+}
+
+void MemoryPoolV2::SetNumaAware(bool enabled) {
+    g_numa_aware.store(enabled, std::memory_order_relaxed);
+}
+
+bool MemoryPoolV2::IsNumaAware() const {
+    return g_numa_aware.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPoolV2::GetTransferHighWatermark() const {
+    return g_transfer_limits.high_watermark.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPoolV2::GetTransferBatchSize() const {
+    return g_transfer_limits.batch_size.load(std::memory_order_relaxed);
+}
+
 void* MemoryPoolV2::Allocate(size_t size) {
     void* ptr = nullptr;
     if (size <= MAX_SMALL_SIZE) {
@@ -343,49 +766,156 @@ void* MemoryPoolV2::Allocate(size_t size) {
 
 void MemoryPoolV2::Deallocate(void* ptr, size_t size) {
     if (!ptr) return;
-    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - sizeof(BlockHeader));
-    if (header->size_class < NUM_SIZE_CLASSES) {
+    if (IsSmallBlock(ptr)) {
         DeallocateSmall(ptr);
     }
-    else if (header->size_class == MEDIUM_OBJECT) {
-        DeallocateMedium(ptr);
-    }
     else {
-        DeallocateLarge(ptr);
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - sizeof(BlockHeader));
+        if (header->size_class == MEDIUM_OBJECT) {
+            DeallocateMedium(ptr);
+        }
+        else {
+            DeallocateLarge(ptr);
+        }
     }
     RecordDealloc(size);
 }
 
+void MemoryPoolV2::Deallocate(void* ptr) {
+    if (!ptr) return;
+    Deallocate(ptr, UsableSize(ptr));
+}
+
+size_t MemoryPoolV2::UsableSize(const void* ptr) const {
+    if (!ptr) return 0;
+    if (IsSmallBlock(ptr)) {
+        return SlabOf(ptr)->block_size;
+    }
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(static_cast<const char*>(ptr) - sizeof(BlockHeader));
+    return header->actual_size;
+}
+
+#ifndef MEMORY_POOL_V2_NO_STATS
+
+namespace {
+
+// Single-writer increment: no locked RMW needed on the owner's own counters
+inline void BumpLocal(std::atomic<size_t>& counter, size_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void AccumulateStats(MemoryPoolV2::PoolStat& out, const ThreadStats& in) {
+    out.total_allocated += in.total_allocated.load(std::memory_order_relaxed);
+    out.total_deallocated += in.total_deallocated.load(std::memory_order_relaxed);
+    out.cross_thread_frees += in.cross_thread_frees.load(std::memory_order_relaxed);
+    out.slab_refills += in.slab_refills.load(std::memory_order_relaxed);
+    out.mailbox_drains += in.mailbox_drains.load(std::memory_order_relaxed);
+    out.slabs_released += in.slabs_released.load(std::memory_order_relaxed);
+    out.bytes_released += in.bytes_released.load(std::memory_order_relaxed);
+    out.transfers_out += in.transfers_out.load(std::memory_order_relaxed);
+    out.transfers_in += in.transfers_in.load(std::memory_order_relaxed);
+    out.numa_bind_failures += in.numa_bind_failures.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Counters go to the calling thread's cache; calls made after the cache is torn
+// down (e.g. from thread-exit destructors) fall back to the shared retired set.
+#define MEMORY_POOL_V2_RECORD(field, delta)                                           \
+    do {                                                                              \
+        if (g_thread_cache) {                                                         \
+            BumpLocal(g_thread_cache->stats.field, (delta));                          \
+        } else {                                                                      \
+            retired_stats_.field.fetch_add((delta), std::memory_order_relaxed);       \
+        }                                                                             \
+    } while (0)
+
 void MemoryPoolV2::RecordAlloc(size_t bytes) {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.total_allocated += bytes;
+    MEMORY_POOL_V2_RECORD(total_allocated, bytes);
 }
 
 void MemoryPoolV2::RecordDealloc(size_t bytes) {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.total_deallocated += bytes;
+    MEMORY_POOL_V2_RECORD(total_deallocated, bytes);
 }
 
 void MemoryPoolV2::RecordCrossThreadFree() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.cross_thread_frees++;
+    MEMORY_POOL_V2_RECORD(cross_thread_frees, 1);
 }
 
 void MemoryPoolV2::RecordSlabRefill() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.slab_refills++;
+    MEMORY_POOL_V2_RECORD(slab_refills, 1);
 }
 
 void MemoryPoolV2::RecordMailboxDrain() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.mailbox_drains++;
+    MEMORY_POOL_V2_RECORD(mailbox_drains, 1);
+}
+
+void MemoryPoolV2::RecordSlabRelease(size_t bytes) {
+    MEMORY_POOL_V2_RECORD(slabs_released, 1);
+    MEMORY_POOL_V2_RECORD(bytes_released, bytes);
+}
+
+void MemoryPoolV2::RecordTransferOut() {
+    MEMORY_POOL_V2_RECORD(transfers_out, 1);
 }
 
+void MemoryPoolV2::RecordTransferIn() {
+    MEMORY_POOL_V2_RECORD(transfers_in, 1);
+}
+
+void MemoryPoolV2::RecordNumaMapping(size_t bytes, bool bound) {
+    MEMORY_POOL_V2_RECORD(numa_mapped_bytes, bytes);
+    if (!bound) {
+        MEMORY_POOL_V2_RECORD(numa_bind_failures, 1);
+    }
+}
+
+#undef MEMORY_POOL_V2_RECORD
+
+// Called with registry_mutex_ held, once the owner has stopped recording
+void MemoryPoolV2::RetireStats(ThreadCache* tc) {
+    const ThreadStats& in = tc->stats;
+    retired_stats_.total_allocated.fetch_add(in.total_allocated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.total_deallocated.fetch_add(in.total_deallocated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.cross_thread_frees.fetch_add(in.cross_thread_frees.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.slab_refills.fetch_add(in.slab_refills.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.mailbox_drains.fetch_add(in.mailbox_drains.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.slabs_released.fetch_add(in.slabs_released.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.bytes_released.fetch_add(in.bytes_released.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.transfers_out.fetch_add(in.transfers_out.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.transfers_in.fetch_add(in.transfers_in.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    retired_stats_.numa_bind_failures.fetch_add(in.numa_bind_failures.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    size_t node = tc->numa_node < MAX_NUMA_NODES ? tc->numa_node : MAX_NUMA_NODES - 1;
+    retired_node_bytes_[node].fetch_add(in.numa_mapped_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+MemoryPoolV2::PoolStat MemoryPoolV2::GetStats() const {
+    PoolStat stats = {};
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    AccumulateStats(stats, retired_stats_);
+    // Mappings recorded without a thread cache are attributed to node 0
+    stats.node_mapped_bytes[0] += retired_stats_.numa_mapped_bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < MAX_NUMA_NODES; ++i) {
+        stats.node_mapped_bytes[i] += retired_node_bytes_[i].load(std::memory_order_relaxed);
+    }
+    for (const auto& entry : thread_caches_) {
+        const ThreadCache* tc = entry.second;
+        AccumulateStats(stats, tc->stats);
+        size_t node = tc->numa_node < MAX_NUMA_NODES ? tc->numa_node : MAX_NUMA_NODES - 1;
+        stats.node_mapped_bytes[node] += tc->stats.numa_mapped_bytes.load(std::memory_order_relaxed);
+        stats.node_threads[node]++;
+    }
+    return stats;
+}
+
+#else
+
 MemoryPoolV2::PoolStat MemoryPoolV2::GetStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    return PoolStat{};
 }
 
+#endif
+
 void MemoryPoolV2::PrintStats() const {
     PoolStat stats = GetStats();
     
@@ -395,6 +925,18 @@ void MemoryPoolV2::PrintStats() const {
     std::cout << "Cross-thread Frees:  " << stats.cross_thread_frees << std::endl;
     std::cout << "Slab Refills:        " << stats.slab_refills << std::endl;
     std::cout << "Mailbox Drains:      " << stats.mailbox_drains << std::endl;
+    std::cout << "Slabs Released:      " << stats.slabs_released << std::endl;
+    std::cout << "Bytes Released:      " << stats.bytes_released << " bytes" << std::endl;
+    std::cout << "Transfers Out:       " << stats.transfers_out << std::endl;
+    std::cout << "Transfers In:        " << stats.transfers_in << std::endl;
+    if (IsNumaAware()) {
+        std::cout << "NUMA Bind Failures:  " << stats.numa_bind_failures << std::endl;
+        for (size_t i = 0; i < MAX_NUMA_NODES; ++i) {
+            if (stats.node_threads[i] == 0 && stats.node_mapped_bytes[i] == 0) continue;
+            std::cout << "Node " << i << ":              " << stats.node_threads[i] << " threads, "
+                      << stats.node_mapped_bytes[i] << " bytes mapped" << std::endl;
+        }
+    }
     std::cout << "===============================" << std::endl;
 }
 
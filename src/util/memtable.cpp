@@ -0,0 +1,135 @@
+#include "memtable.hpp"
+
+namespace SAK {
+
+MemTable::Iterator::Iterator(Map::const_iterator it, Map::const_iterator end, ByteBuffer upper, uint64_t read_ts)
+    : it_(it), end_(end), upper_(std::move(upper)), read_ts_(read_ts) {
+    Settle();
+}
+
+void MemTable::Iterator::Settle() {
+    while (it_ != end_) {
+        if (!upper_.Empty() && !(it_->first.Key() < upper_)) {
+            it_ = end_;
+            return;
+        }
+        if (it_->first.Timestamp() <= read_ts_) {
+            return;
+        }
+        ++it_;
+    }
+}
+
+void MemTable::Iterator::Next() {
+    // Older versions of the key just visited are hidden by it
+    ByteBuffer current = it_->first.Key();
+    ++it_;
+    while (it_ != end_ && it_->first.Key() == current) {
+        ++it_;
+    }
+    Settle();
+}
+
+MemTable::MemTable(size_t id, size_t arena_block_size)
+    : id_(id),
+      arena_(arena_block_size),
+      map_(std::less<KeyTs>(), Map::allocator_type(arena_)) {
+}
+
+bool MemTable::Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value) {
+    if (Frozen() || !map_.emplace(KeyTs(key, ts), value).second) {
+        return false;
+    }
+    approximate_size_.fetch_add(key.Size() + sizeof(uint64_t) + value.Size(), std::memory_order_relaxed);
+    return true;
+}
+
+std::optional<ByteBuffer> MemTable::Get(const ByteBuffer& key, uint64_t read_ts) const {
+    // Versions run newest first, so this is the newest one at or before read_ts
+    auto it = map_.lower_bound(KeyTs(key, read_ts));
+    if (it == map_.end() || it->first.Key() != key) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+MemTable::Iterator MemTable::Scan(const ByteBuffer& lower, const ByteBuffer& upper, uint64_t read_ts) const {
+    return Iterator(map_.lower_bound(KeyTs(lower, kMaxTimestamp)), map_.end(), upper, read_ts);
+}
+
+MemTableList::MemTableList(const Options& options)
+    : target_size_(options.target_sst_size),
+      memtable_limit_(options.num_memtable_limit) {
+    active_ = std::make_shared<MemTable>(next_id_++);
+}
+
+bool MemTableList::Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value) {
+    bool inserted;
+    bool full;
+    {
+        spin_rw_mutex::scoped_lock lock(mutex_, false);
+        inserted = active_->Put(key, ts, value);
+        full = active_->ApproximateSize() >= target_size_;
+    }
+    if (full) {
+        spin_rw_mutex::scoped_lock lock(mutex_, true);
+        // Another writer may have frozen it already
+        if (active_->ApproximateSize() >= target_size_) {
+            FreezeLocked();
+        }
+    }
+    return inserted;
+}
+
+std::optional<ByteBuffer> MemTableList::Get(const ByteBuffer& key, uint64_t read_ts) const {
+    spin_rw_mutex::scoped_lock lock(mutex_, false);
+    if (auto value = active_->Get(key, read_ts)) {
+        return value;
+    }
+    for (auto it = immutables_.rbegin(); it != immutables_.rend(); ++it) {
+        if (auto value = (*it)->Get(key, read_ts)) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<MemTable> MemTableList::Active() const {
+    spin_rw_mutex::scoped_lock lock(mutex_, false);
+    return active_;
+}
+
+std::vector<std::shared_ptr<MemTable>> MemTableList::Immutables() const {
+    spin_rw_mutex::scoped_lock lock(mutex_, false);
+    return std::vector<std::shared_ptr<MemTable>>(immutables_.rbegin(), immutables_.rend());
+}
+
+void MemTableList::Freeze() {
+    spin_rw_mutex::scoped_lock lock(mutex_, true);
+    if (!active_->Empty()) {
+        FreezeLocked();
+    }
+}
+
+void MemTableList::FreezeLocked() {
+    active_->Freeze();
+    immutables_.push_back(std::move(active_));
+    active_ = std::make_shared<MemTable>(next_id_++);
+}
+
+bool MemTableList::NeedsFlush() const {
+    spin_rw_mutex::scoped_lock lock(mutex_, false);
+    return immutables_.size() + 1 > memtable_limit_;
+}
+
+std::shared_ptr<MemTable> MemTableList::PopOldest() {
+    spin_rw_mutex::scoped_lock lock(mutex_, true);
+    if (immutables_.empty()) {
+        return nullptr;
+    }
+    std::shared_ptr<MemTable> oldest = std::move(immutables_.front());
+    immutables_.erase(immutables_.begin());
+    return oldest;
+}
+
+} // namespace SAK
@@ -0,0 +1,375 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace SAK {
+namespace metrics {
+
+namespace {
+
+std::string Quote(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Nanoseconds as fractional microseconds, the unit of Chrome traces
+std::string Micros(uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    return text;
+}
+
+int ProcessId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+} // namespace
+
+uint64_t Counter::Value() const noexcept {
+    uint64_t total = 0;
+    for (const Shard& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Counter::Reset() noexcept {
+    for (Shard& shard : shards_) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+Histogram::Histogram() : shards_(new Shard[kHistogramShards]()) {
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index) noexcept {
+    if (index < 2 * kSubBuckets) {
+        return index;
+    }
+    size_t shift = index / kSubBuckets - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+Histogram::Snapshot Histogram::Take() const {
+    Snapshot snapshot;
+    snapshot.buckets.assign(kBuckets, 0);
+    for (size_t s = 0; s < kHistogramShards; ++s) {
+        const Shard& shard = shards_[s];
+        snapshot.count += shard.count.load(std::memory_order_relaxed);
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < kBuckets; ++i) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+void Histogram::Reset() noexcept {
+    for (size_t s = 0; s < kHistogramShards; ++s) {
+        Shard& shard = shards_[s];
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+        shard.max.store(0, std::memory_order_relaxed);
+        for (auto& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t Histogram::Snapshot::Percentile(double p) const {
+    // Buckets are summed without a lock, so they may run a little ahead of count
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    double clamped = std::min(100.0, std::max(0.0, p));
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+Registry& Registry::Instance() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+Counter& Registry::GetCounter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Gauge& Registry::GetGauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = gauges_[name];
+    if (!slot) {
+        slot = std::make_unique<Gauge>();
+    }
+    return *slot;
+}
+
+Histogram& Registry::GetHistogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+uint64_t Registry::AddCallbackGauge(const std::string& name, std::function<int64_t()> read) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t id = next_callback_++;
+    callbacks_.emplace(id, CallbackGauge{name, std::move(read)});
+    return id;
+}
+
+void Registry::RemoveCallbackGauge(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.erase(id);
+}
+
+std::string Registry::ToJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Plain gauges and the sums of callback gauges share one namespace
+    std::map<std::string, int64_t> levels;
+    for (const auto& entry : gauges_) {
+        levels[entry.first] += entry.second->Value();
+    }
+    for (const auto& entry : callbacks_) {
+        levels[entry.second.name] += entry.second.read();
+    }
+
+    std::string out = "{\"counters\": {";
+    const char* separator = "";
+    for (const auto& entry : counters_) {
+        out += separator + Quote(entry.first) + ": " + std::to_string(entry.second->Value());
+        separator = ", ";
+    }
+    out += "}, \"gauges\": {";
+    separator = "";
+    for (const auto& entry : levels) {
+        out += separator + Quote(entry.first) + ": " + std::to_string(entry.second);
+        separator = ", ";
+    }
+    out += "}, \"histograms\": {";
+    separator = "";
+    for (const auto& entry : histograms_) {
+        Histogram::Snapshot snapshot = entry.second->Take();
+        char mean[32];
+        std::snprintf(mean, sizeof(mean), "%.1f", snapshot.Mean());
+        out += separator + Quote(entry.first) + ": {\"count\": " + std::to_string(snapshot.count) +
+               ", \"sum\": " + std::to_string(snapshot.sum) + ", \"mean\": " + mean +
+               ", \"max\": " + std::to_string(snapshot.max) +
+               ", \"p50\": " + std::to_string(snapshot.Percentile(50)) +
+               ", \"p90\": " + std::to_string(snapshot.Percentile(90)) +
+               ", \"p99\": " + std::to_string(snapshot.Percentile(99)) +
+               ", \"p999\": " + std::to_string(snapshot.Percentile(99.9)) + "}";
+        separator = ", ";
+    }
+    return out + "}}";
+}
+
+void Registry::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : counters_) {
+        entry.second->Reset();
+    }
+    for (auto& entry : histograms_) {
+        entry.second->Reset();
+    }
+}
+
+/**
+ * One thread's spans. Only the owner writes; each slot is a seqlock (odd
+ * while being written) so Collect() can read concurrently and skip a
+ * slot that is being overwritten.
+ */
+struct Tracer::Ring {
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<const char*> category{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> duration_ns{0};
+    };
+
+    Ring(size_t events, uint32_t id) : slots(new Slot[events]), capacity(events), thread(id) {}
+
+    std::unique_ptr<Slot[]> slots;
+    const size_t capacity;
+    const uint32_t thread;
+    std::atomic<uint64_t> head{0};   // Spans written so far
+    std::atomic<uint64_t> floor{0};  // Spans before this were cleared
+    std::atomic<bool> exited{false};
+};
+
+Tracer& Tracer::Instance() {
+    static Tracer* instance = new Tracer();
+    return *instance;
+}
+
+void Tracer::SetBufferEvents(size_t events) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_events_ = std::max<size_t>(events, 1);
+}
+
+size_t Tracer::BufferEvents() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_events_;
+}
+
+Tracer::Ring* Tracer::ThisThreadRing() {
+    // Marks the ring when the thread exits so Clear() can let it go
+    struct Holder {
+        std::shared_ptr<Ring> ring;
+        ~Holder() {
+            if (ring) {
+                ring->exited.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    thread_local Holder holder;
+    if (!holder.ring) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        holder.ring = std::make_shared<Ring>(buffer_events_, next_thread_++);
+        rings_.push_back(holder.ring);
+    }
+    return holder.ring.get();
+}
+
+void Tracer::Record(const char* category, const char* name, uint64_t start_ns, uint64_t end_ns) noexcept {
+    if (!Enabled()) {
+        return;
+    }
+    Ring* ring;
+    try {
+        ring = ThisThreadRing();
+    } catch (...) {
+        return;
+    }
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    Ring::Slot& slot = ring->slots[head % ring->capacity];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(end_ns > start_ns ? end_ns - start_ns : 0, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Tracer::Collect() const {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings = rings_;
+    }
+    std::vector<TraceEvent> events;
+    for (const auto& ring : rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > ring->capacity ? head - ring->capacity : 0;
+        first = std::max(first, ring->floor.load(std::memory_order_relaxed));
+        for (uint64_t i = first; i < head; ++i) {
+            const Ring::Slot& slot = ring->slots[i % ring->capacity];
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            TraceEvent event;
+            event.category = slot.category.load(std::memory_order_relaxed);
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+            event.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+            event.thread = ring->thread;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before || !event.name) {
+                continue;
+            }
+            events.push_back(event);
+        }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const TraceEvent& a, const TraceEvent& b) { return a.start_ns < b.start_ns; });
+    return events;
+}
+
+std::string Tracer::ChromeTraceJson() const {
+    std::vector<TraceEvent> events = Collect();
+    std::string pid = std::to_string(ProcessId());
+    std::string out = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        out += i ? ",\n" : "\n";
+        out += "{\"name\": " + Quote(event.name) + ", \"cat\": " + Quote(event.category ? event.category : "") +
+               ", \"ph\": \"X\", \"ts\": " + Micros(event.start_ns) + ", \"dur\": " + Micros(event.duration_ns) +
+               ", \"pid\": " + pid + ", \"tid\": " + std::to_string(event.thread) + "}";
+    }
+    return out + "\n]}\n";
+}
+
+bool Tracer::WriteChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << ChromeTraceJson();
+    return static_cast<bool>(file.flush());
+}
+
+void Tracer::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [](const std::shared_ptr<Ring>& ring) {
+                                    return ring->exited.load(std::memory_order_relaxed);
+                                }),
+                 rings_.end());
+    // Only the owner writes a ring, so a live one is emptied by hiding what it holds
+    for (const auto& ring : rings_) {
+        ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+} // namespace metrics
+} // namespace SAK
@@ -0,0 +1,296 @@
+#include "sstable.hpp"
+#include "coding.hpp"
+#include "crc32c.hpp"
+
+#include <algorithm>
+
+namespace SAK {
+
+namespace {
+
+void PutKey(std::vector<uint8_t>& out, const ByteBuffer& key, uint64_t ts) {
+    coding::PutVarint32(out, static_cast<uint32_t>(key.Size()));
+    out.insert(out.end(), key.Data(), key.Data() + key.Size());
+    coding::PutFixed64(out, ts);
+}
+
+const uint8_t* GetKey(const uint8_t* p, const uint8_t* limit, ByteBuffer& key, uint64_t& ts) {
+    uint32_t size;
+    if (!(p = coding::GetVarint32(p, limit, size)) || static_cast<size_t>(limit - p) < size_t(size) + 8) {
+        return nullptr;
+    }
+    key = size ? ByteBuffer(p, size) : ByteBuffer();
+    ts = coding::GetFixed64(p + size);
+    return p + size + 8;
+}
+
+// Appends `contents` and its checksum
+void PutChecksummed(std::vector<uint8_t>& out, const std::vector<uint8_t>& contents) {
+    out.insert(out.end(), contents.begin(), contents.end());
+    coding::PutFixed32(out, Crc32c::Compute(contents.data(), contents.size()));
+}
+
+} // namespace
+
+SsTableBuilder::SsTableBuilder(const Options& options)
+    : block_size_(options.block_size),
+      filter_bits_per_key_(options.bloom_bits_per_key),
+      filter_(options.bloom_bits_per_key) {
+}
+
+void SsTableBuilder::Add(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value) {
+    // Entry plus its worst-case varints and restart slot
+    size_t entry_size = key.Size() + value.Size() + 8 + 3 * 5 + 4;
+    if (!block_.Empty() && block_.EstimatedSize() + entry_size > block_size_) {
+        FinishBlock();
+    }
+    if (block_.Empty()) {
+        first_key_ = key;
+        first_ts_ = ts;
+    }
+    block_.Add(key, ts, value);
+    if (filter_bits_per_key_) {
+        filter_.AddKey(key);
+    }
+    last_key_ = key;
+    last_ts_ = ts;
+}
+
+void SsTableBuilder::FinishBlock() {
+    const std::vector<uint8_t>& contents = block_.Finish();
+    meta_.push_back(BlockMeta{data_.size(), static_cast<uint32_t>(contents.size()), first_key_, first_ts_,
+                              last_key_, last_ts_});
+    PutChecksummed(data_, contents);
+    block_.Reset();
+}
+
+size_t SsTableBuilder::EstimatedSize() const noexcept {
+    return data_.size() + block_.EstimatedSize();
+}
+
+std::shared_ptr<SsTable> SsTableBuilder::Build(size_t id, const std::string& path,
+                                               std::shared_ptr<BlockCache> cache) {
+    if (!block_.Empty()) {
+        FinishBlock();
+    }
+    if (meta_.empty()) {
+        return nullptr;
+    }
+
+    uint64_t filter_offset = data_.size();
+    std::vector<uint8_t> filter = filter_.Finish();
+    if (!filter.empty()) {
+        PutChecksummed(data_, filter);
+    }
+
+    std::vector<uint8_t> index;
+    coding::PutFixed32(index, static_cast<uint32_t>(meta_.size()));
+    for (const BlockMeta& meta : meta_) {
+        coding::PutFixed64(index, meta.offset);
+        coding::PutFixed32(index, meta.size);
+        PutKey(index, meta.first_key, meta.first_ts);
+        PutKey(index, meta.last_key, meta.last_ts);
+    }
+    coding::PutFixed64(index, filter_offset);
+    coding::PutFixed32(index, static_cast<uint32_t>(filter.size()));
+    uint64_t index_offset = data_.size();
+    PutChecksummed(data_, index);
+    coding::PutFixed64(data_, index_offset);
+    coding::PutFixed32(data_, static_cast<uint32_t>(index.size()));
+    coding::PutFixed64(data_, SsTable::kMagic);
+
+    FileObject file = FileObject::Create(path, data_);
+    std::vector<uint8_t>().swap(data_);
+    meta_.clear();
+    return SsTable::Open(id, std::move(file), std::move(cache));
+}
+
+SsTable::SsTable(size_t id, FileObject file, std::vector<BlockMeta> meta, std::shared_ptr<BlockCache> cache)
+    : id_(id),
+      file_(std::move(file)),
+      mapped_(file_.Map(AccessHint::Random)),
+      meta_(std::move(meta)),
+      cache_(std::move(cache)) {
+}
+
+std::shared_ptr<SsTable> SsTable::Open(size_t id, FileObject file, std::shared_ptr<BlockCache> cache) {
+    uint64_t file_size = file.Size();
+    if (file_size < kFooterSize) {
+        return nullptr;
+    }
+    std::vector<uint8_t> footer = file.Read(file_size - kFooterSize, kFooterSize);
+    if (footer.size() != kFooterSize || coding::GetFixed64(footer.data() + 12) != kMagic) {
+        return nullptr;
+    }
+    uint64_t index_offset = coding::GetFixed64(footer.data());
+    uint32_t index_size = coding::GetFixed32(footer.data() + 8);
+    if (index_offset + index_size + 4 + kFooterSize != file_size) {
+        return nullptr;
+    }
+    std::vector<uint8_t> index = file.Read(index_offset, index_size + 4);
+    if (index.size() != index_size + 4u ||
+        Crc32c::Compute(index.data(), index_size) != coding::GetFixed32(index.data() + index_size)) {
+        return nullptr;
+    }
+
+    const uint8_t* p = index.data();
+    const uint8_t* limit = p + index_size;
+    if (index_size < 4) {
+        return nullptr;
+    }
+    uint32_t count = coding::GetFixed32(p);
+    p += 4;
+    std::vector<BlockMeta> meta;
+    meta.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        BlockMeta block{};
+        if (static_cast<size_t>(limit - p) < 12) {
+            return nullptr;
+        }
+        block.offset = coding::GetFixed64(p);
+        block.size = coding::GetFixed32(p + 8);
+        p += 12;
+        if (!(p = GetKey(p, limit, block.first_key, block.first_ts)) ||
+            !(p = GetKey(p, limit, block.last_key, block.last_ts)) ||
+            block.offset + block.size + 4 > index_offset) {
+            return nullptr;
+        }
+        meta.push_back(std::move(block));
+    }
+    if (meta.empty() || static_cast<size_t>(limit - p) != 12) {
+        return nullptr;
+    }
+    uint64_t filter_offset = coding::GetFixed64(p);
+    uint32_t filter_size = coding::GetFixed32(p + 8);
+    if (filter_size && filter_offset + filter_size + 4 > index_offset) {
+        return nullptr;
+    }
+    std::shared_ptr<SsTable> table(new SsTable(id, std::move(file), std::move(meta), std::move(cache)));
+    if (filter_size) {
+        table->LoadFilter(filter_offset, filter_size);
+    }
+    return table;
+}
+
+void SsTable::LoadFilter(uint64_t offset, uint32_t size) {
+    ByteBuffer contents;
+    if (!mapped_.Empty()) {
+        contents = mapped_.Slice(offset, uint64_t(size) + 4);
+    } else {
+        contents = ByteBuffer(file_.Read(offset, uint64_t(size) + 4));
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(contents.Data());
+    // A damaged filter is dropped: lookups then read the data blocks
+    if (contents.Size() == size + 4u && Crc32c::Compute(bytes, size) == coding::GetFixed32(bytes + size)) {
+        filter_ = BloomFilter(contents.Slice(0, size));
+    }
+}
+
+std::shared_ptr<const Block> SsTable::ReadBlock(size_t index, CachePriority priority) const {
+    const BlockMeta& meta = meta_[index];
+    if (!cache_) {
+        return DecodeBlock(meta);
+    }
+    std::shared_ptr<const Block> block = cache_->Lookup(id_, meta.offset);
+    if (!block && (block = DecodeBlock(meta))) {
+        cache_->Insert(id_, meta.offset, block, priority);
+    }
+    return block;
+}
+
+std::shared_ptr<const Block> SsTable::DecodeBlock(const BlockMeta& meta) const {
+    if (!mapped_.Empty()) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(mapped_.Data()) + meta.offset;
+        if (Crc32c::Compute(bytes, meta.size) != coding::GetFixed32(bytes + meta.size)) {
+            return nullptr;
+        }
+        return Block::Decode(mapped_.Slice(meta.offset, meta.size));
+    }
+    std::vector<uint8_t> bytes = file_.Read(meta.offset, uint64_t(meta.size) + 4);
+    if (bytes.size() != meta.size + 4u ||
+        Crc32c::Compute(bytes.data(), meta.size) != coding::GetFixed32(bytes.data() + meta.size)) {
+        return nullptr;
+    }
+    bytes.resize(meta.size);
+    return Block::Decode(ByteBuffer(std::move(bytes)));
+}
+
+size_t SsTable::FindBlock(const ByteBuffer& key, uint64_t ts) const {
+    auto it = std::partition_point(meta_.begin(), meta_.end(), [&](const BlockMeta& meta) {
+        return CompareKeyTs(meta.last_key.Data(), meta.last_key.Size(), meta.last_ts, key.Data(), key.Size(), ts) < 0;
+    });
+    return static_cast<size_t>(it - meta_.begin());
+}
+
+std::optional<ByteBuffer> SsTable::Get(const ByteBuffer& key, uint64_t read_ts) const {
+    if (!MayContain(key)) {
+        return std::nullopt;
+    }
+    size_t index = FindBlock(key, read_ts);
+    if (index == meta_.size()) {
+        return std::nullopt;
+    }
+    std::shared_ptr<const Block> block = ReadBlock(index);
+    if (!block) {
+        return std::nullopt;
+    }
+    BlockIterator it(std::move(block));
+    it.Seek(key, read_ts);
+    if (!it.Valid() || it.KeySize() != key.Size() ||
+        !std::equal(key.Data(), key.Data() + key.Size(), it.KeyData())) {
+        return std::nullopt;
+    }
+    return it.Value();
+}
+
+SsTableIterator::SsTableIterator(std::shared_ptr<const SsTable> table) : table_(std::move(table)) {
+    SeekToFirst();
+}
+
+void SsTableIterator::LoadBlock(size_t index) {
+    block_it_.reset();
+    for (block_index_ = index; block_index_ < table_->NumBlocks(); ++block_index_) {
+        std::shared_ptr<const Block> block = table_->ReadBlock(block_index_, CachePriority::Low);
+        if (!block) {
+            corrupted_ = true;
+            return;
+        }
+        block_it_.emplace(std::move(block));
+        if (block_it_->Valid() || block_it_->Corrupted()) {
+            corrupted_ = block_it_->Corrupted();
+            return;
+        }
+    }
+    block_it_.reset();
+}
+
+void SsTableIterator::SeekToFirst() {
+    corrupted_ = false;
+    LoadBlock(0);
+}
+
+void SsTableIterator::Seek(const ByteBuffer& key, uint64_t ts) {
+    corrupted_ = false;
+    LoadBlock(table_->FindBlock(key, ts));
+    if (block_it_) {
+        block_it_->Seek(key, ts);
+        if (!block_it_->Valid() && !block_it_->Corrupted()) {
+            // Past the last entry of the block
+            LoadBlock(block_index_ + 1);
+        }
+        corrupted_ = corrupted_ || (block_it_ && block_it_->Corrupted());
+    }
+}
+
+void SsTableIterator::Next() {
+    block_it_->Next();
+    if (!block_it_->Valid()) {
+        if (block_it_->Corrupted()) {
+            corrupted_ = true;
+            return;
+        }
+        LoadBlock(block_index_ + 1);
+    }
+}
+
+} // namespace SAK
@@ -0,0 +1,122 @@
+#include "task.hpp"
+
+#include <deque>
+
+namespace SAK {
+
+namespace {
+
+// One execution of a TaskGraph; owns copies of the jobs
+struct graph_run : std::enable_shared_from_this<graph_run> {
+    struct node {
+        std::function<void()> fn;
+        std::vector<size_t> successors;
+        std::atomic<size_t> waiting{0};
+    };
+
+    graph_run(thread::ThreadPool& owner, size_t count, std::shared_ptr<detail::task_state<void>> state)
+        : pool(owner), nodes(count), remaining(count), done(std::move(state)) {}
+
+    void schedule(size_t index) {
+        auto self = shared_from_this();
+        pool.post_local([self, index] { self->execute(index); });
+    }
+
+    void execute(size_t index) {
+        node& current = nodes[index];
+        if (!failed.load(std::memory_order_acquire)) {
+            try {
+                current.fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_release);
+            }
+        }
+
+        for (size_t successor : current.successors) {
+            if (nodes[successor].waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(successor);
+            }
+        }
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (error) {
+                done->set_exception(error);
+            } else {
+                done->set_value();
+            }
+        }
+    }
+
+    thread::ThreadPool& pool;
+    std::vector<node> nodes;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::shared_ptr<detail::task_state<void>> done;
+};
+
+} // namespace
+
+TaskGraph::node_id TaskGraph::add(std::function<void()> fn) {
+    nodes_.push_back(node{std::move(fn), {}, 0});
+    return nodes_.size() - 1;
+}
+
+void TaskGraph::precede(node_id before, node_id after) {
+    if (before >= nodes_.size() || after >= nodes_.size()) {
+        throw std::out_of_range("TaskGraph node id out of range");
+    }
+    nodes_[before].successors.push_back(after);
+    nodes_[after].predecessors += 1;
+}
+
+Task<void> TaskGraph::run(thread::ThreadPool& pool) const {
+    auto done = std::make_shared<detail::task_state<void>>(&pool);
+    if (nodes_.empty()) {
+        done->set_value();
+        return detail::task_access::make(std::move(done));
+    }
+
+    // Kahn's algorithm up front, so a cycle is reported instead of hanging
+    std::vector<size_t> waiting(nodes_.size());
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        waiting[i] = nodes_[i].predecessors;
+        if (waiting[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    const std::vector<size_t> roots(ready.begin(), ready.end());
+    size_t visited = 0;
+    while (!ready.empty()) {
+        const size_t index = ready.front();
+        ready.pop_front();
+        ++visited;
+        for (size_t successor : nodes_[index].successors) {
+            if (--waiting[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+    if (visited != nodes_.size()) {
+        throw std::invalid_argument("TaskGraph contains a cycle");
+    }
+
+    auto execution = std::make_shared<graph_run>(pool, nodes_.size(), done);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        execution->nodes[i].fn = nodes_[i].fn;
+        execution->nodes[i].successors = nodes_[i].successors;
+        execution->nodes[i].waiting.store(nodes_[i].predecessors, std::memory_order_relaxed);
+    }
+    for (size_t root : roots) {
+        execution->schedule(root);
+    }
+    return detail::task_access::make(std::move(done));
+}
+
+} // namespace SAK
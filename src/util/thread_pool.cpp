@@ -1,113 +1,542 @@
 #include "thread_pool.hpp"
+#include "_utils.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace SAK {
 namespace thread {
 
-ThreadPool::ThreadPool(size_t threads) : stop(false) {
-    if (threads == 0) {
-        threads = 1;
+namespace {
+// The pool and worker index of the calling thread, if it is a pool worker
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_worker_index = 0;
+// Priority of the task the calling worker is running; inherited by spawn()
+thread_local TaskPriority tls_priority = TaskPriority::normal;
+
+size_t level_of(TaskPriority priority) {
+    return static_cast<size_t>(priority);
+}
+
+struct numa_node_cpus {
+    uint32_t node;
+    std::vector<int> cpus;
+};
+
+// Parses a sysfs cpu list such as "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const size_t dash = range.find('-');
+        try {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
     }
+    return cpus;
+}
+
+// Nodes with at least one cpu, read from sysfs; empty when unavailable
+std::vector<numa_node_cpus> read_numa_topology() {
+    std::vector<numa_node_cpus> nodes;
+#if defined(__linux__)
+    constexpr uint32_t kMaxNodes = 64;
+    for (uint32_t node = 0; node < kMaxNodes; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!file || !std::getline(file, list)) {
+            continue;
+        }
+        std::vector<int> cpus = parse_cpu_list(list);
+        if (!cpus.empty()) {
+            nodes.push_back({node, std::move(cpus)});
+        }
+    }
+#endif
+    return nodes;
+}
+
+uint32_t node_of_cpu(const std::vector<numa_node_cpus>& nodes, int cpu) {
+    for (const auto& node : nodes) {
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) {
+            return node.node;
+        }
+    }
+    return 0;
+}
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) : ThreadPool(ThreadPoolOptions(threads)) {
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : name_prefix(options.name_prefix), stop(false) {
+    const size_t threads = options.threads == 0 ? 1 : options.threads;
 
     worker_states.reserve(threads);
     for (size_t i = 0; i < threads; ++i) {
         worker_states.push_back(std::make_unique<WorkerState>());
     }
+    general_workers = threads - std::min(options.high_priority_workers, threads - 1);
+    for (size_t i = general_workers; i < threads; ++i) {
+        worker_states[i]->high_priority_only = true;
+    }
+    assign_placement(options);
+
+    metrics_gauge_id = metrics::Registry::Instance().AddCallbackGauge(
+        "thread_pool.pending", [this] { return static_cast<int64_t>(get_task_count()); });
 
     for(size_t i = 0; i < threads; ++i)
-        workers.emplace_back(
-            [this, i] {
-                while(true) {
-                    std::function<void()> task;
-
-                    if (this->try_acquire_task(i, task)) {
-                        task();
-                        continue;
-                    }
-
-                    std::unique_lock<std::mutex> lock(this->wait_mutex);
-                    this->condition.wait(lock, [this] {
-                        return this->stop.load(std::memory_order_acquire) ||
-                               this->pending_tasks.load(std::memory_order_acquire) > 0;
-                    });
-
-                    if (this->stop.load(std::memory_order_acquire) &&
-                        this->pending_tasks.load(std::memory_order_acquire) == 0) {
-                        return;
-                    }
+        workers.emplace_back([this, i] { worker_loop(i); });
+}
+
+void ThreadPool::assign_placement(const ThreadPoolOptions& options) {
+    const size_t worker_count = worker_states.size();
+    const std::vector<numa_node_cpus> nodes =
+        options.numa_groups ? read_numa_topology() : std::vector<numa_node_cpus>();
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        WorkerState& state = *worker_states[i];
+        if (!options.cpus.empty()) {
+            const int cpu = options.cpus[i % options.cpus.size()];
+            state.affinity.assign(1, cpu);
+            state.numa_node = node_of_cpu(nodes, cpu);
+        } else if (!nodes.empty()) {
+            const numa_node_cpus& node = nodes[i % nodes.size()];
+            state.affinity = node.cpus;
+            state.numa_node = node.node;
+        }
+    }
+
+    std::set<uint32_t> groups;
+    for (const auto& state : worker_states) {
+        groups.insert(state->numa_node);
+    }
+    group_count = groups.size();
+
+    // Same-node victims first, then the rest; each tier keeps the
+    // round-robin order starting after the thief
+    for (size_t i = 0; i < worker_count; ++i) {
+        WorkerState& state = *worker_states[i];
+        state.steal_order.clear();
+        for (int same_node = 1; same_node >= 0; --same_node) {
+            for (size_t offset = 1; offset < worker_count; ++offset) {
+                const size_t victim = (i + offset) % worker_count;
+                if ((worker_states[victim]->numa_node == state.numa_node) == (same_node == 1)) {
+                    state.steal_order.push_back(victim);
                 }
             }
-        );
+        }
+    }
+}
+
+// Runs on the worker itself before its first allocation, so MemoryPoolV2
+// registers the thread cache on the node the worker is bound to
+void ThreadPool::setup_worker_thread(size_t worker_index) {
+#if defined(__linux__)
+    const WorkerState& state = *worker_states[worker_index];
+    if (!state.affinity.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : state.affinity) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        // Best effort: an unavailable cpu leaves the worker unpinned
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    if (!name_prefix.empty()) {
+        // The kernel limit is 16 bytes including the terminator
+        std::string name = name_prefix + "-" + std::to_string(worker_index);
+        name.resize(std::min<size_t>(name.size(), 15));
+        pthread_setname_np(pthread_self(), name.c_str());
+    }
+#else
+    (void)worker_index;
+#endif
+}
+
+void ThreadPool::worker_loop(size_t worker_index) {
+    setup_worker_thread(worker_index);
+    tls_pool = this;
+    tls_worker_index = worker_index;
+    while(true) {
+        queued_task task;
+
+        if (try_acquire_task(worker_index, task) || search_for_task(worker_index, task)) {
+            run_task(task);
+            continue;
+        }
+
+        if (stop.load(std::memory_order_acquire) && !has_runnable_work(worker_index)) {
+            return;
+        }
+
+        park_worker(worker_index);
+    }
+}
+
+void ThreadPool::run_task(queued_task& task) {
+    static metrics::Counter& tasks_run = metrics::Registry::Instance().GetCounter("thread_pool.tasks");
+    static metrics::Histogram& run_ns = metrics::Registry::Instance().GetHistogram("thread_pool.run_ns");
+
+    tls_priority = task.priority;
+    const uint64_t started = metrics::kEnabled ? metrics::NowNanos() : 0;
+    {
+        SAK_TRACE_SPAN("thread_pool", "task");
+        // enqueue() routes exceptions to the future; post()ed
+        // tasks have nowhere to report them
+        try {
+            task.task();
+        } catch (...) {
+        }
+    }
+    run_ns.RecordSince(started);
+    tasks_run.Add();
+    tls_priority = TaskPriority::normal;
+}
+
+// Reserved workers ignore everything but high priority work
+bool ThreadPool::has_runnable_work(size_t worker_index) const {
+    if (worker_states[worker_index]->high_priority_only) {
+        return priority_stats[level_of(TaskPriority::high)].pending.load(std::memory_order_seq_cst) > 0;
+    }
+    return pending_tasks.load(std::memory_order_seq_cst) > 0;
+}
+
+bool ThreadPool::search_for_task(size_t worker_index, queued_task& task) {
+    // Bounded spin before parking: bursts that arrive within a few
+    // microseconds are picked up without a futex round trip
+    constexpr int kSearchRounds = 32;
+
+    // Only general workers count as searchers: a reserved worker cannot
+    // pick up the normal tasks whose wake-up a searcher suppresses
+    const bool general = !worker_states[worker_index]->high_priority_only;
+    if (general) {
+        searching_workers.fetch_add(1, std::memory_order_seq_cst);
+    }
+    atomic_backoff backoff;
+    bool found = false;
+    for (int round = 0; round < kSearchRounds; ++round) {
+        if (try_acquire_task(worker_index, task)) {
+            found = true;
+            break;
+        }
+        if (stop.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (!backoff.BoundedPause()) {
+            yield();
+        }
+    }
+    if (!general) {
+        return found;
+    }
+
+    // Submitters skip wake-ups while someone is searching, so the last
+    // searcher to find work hands the search over to a parked worker
+    const size_t searchers = searching_workers.fetch_sub(1, std::memory_order_seq_cst);
+    if (found && searchers == 1 && pending_tasks.load(std::memory_order_seq_cst) > 0) {
+        wake_worker(worker_states.size(), true);
+    }
+    return found;
+}
+
+void ThreadPool::park_worker(size_t worker_index) {
+    WorkerState& state = *worker_states[worker_index];
+    state.park.store(worker_parked, std::memory_order_seq_cst);
+    parked_workers.fetch_add(1, std::memory_order_seq_cst);
+
+    // Pairs with the submitter's pending increments followed by its
+    // parked_workers / park loads: one side always sees the other
+    if (!has_runnable_work(worker_index) && !stop.load(std::memory_order_seq_cst)) {
+        while (state.park.load(std::memory_order_acquire) == worker_parked) {
+            state.park.wait(worker_parked, std::memory_order_acquire);
+        }
+    }
+
+    state.park.store(worker_running, std::memory_order_relaxed);
+    parked_workers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool ThreadPool::unpark_worker(size_t worker_index) {
+    WorkerState& state = *worker_states[worker_index];
+    uint32_t expected = worker_parked;
+    if (!state.park.compare_exchange_strong(expected, worker_notified)) {
+        return false;
+    }
+    state.park.notify_one();
+    return true;
+}
+
+void ThreadPool::wake_worker(size_t preferred_index, bool general_only) {
+    if (parked_workers.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    const size_t candidates = general_only ? general_workers : worker_states.size();
+    if (preferred_index < candidates && unpark_worker(preferred_index)) {
+        return;
+    }
+    for (size_t i = 0; i < candidates; ++i) {
+        if (unpark_worker(i)) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::wake_workers(size_t count, bool general_only) {
+    const size_t candidates = general_only ? general_workers : worker_states.size();
+    for (size_t i = 0; i < candidates && count > 0; ++i) {
+        if (parked_workers.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+        if (unpark_worker(i)) {
+            --count;
+        }
+    }
+}
+
+void ThreadPool::wake_for(TaskPriority priority, size_t preferred_index) {
+    if (priority == TaskPriority::high) {
+        // The latency lane goes first, whether or not anyone is searching
+        for (size_t i = general_workers; i < worker_states.size(); ++i) {
+            if (unpark_worker(i)) {
+                return;
+            }
+        }
+    }
+    if (searching_workers.load(std::memory_order_seq_cst) == 0) {
+        wake_worker(preferred_index, true);
+    }
 }
 
-void ThreadPool::submit_task(std::function<void()> task) {
+void ThreadPool::account_submitted(TaskPriority priority, size_t count) {
+    // seq_cst: these increments must be ordered before the submitter's
+    // loads of searching_workers and the park words
+    priority_stats[level_of(priority)].pending.fetch_add(count, std::memory_order_seq_cst);
+    pending_tasks.fetch_add(count, std::memory_order_seq_cst);
+}
+
+void ThreadPool::account_started(const queued_task& task) {
+    static metrics::Histogram& queue_wait_ns =
+        metrics::Registry::Instance().GetHistogram("thread_pool.queue_wait_ns");
+
+    priority_counters& counters = priority_stats[level_of(task.priority)];
+    const auto waited = std::chrono::steady_clock::now() - task.enqueued;
+    const uint64_t wait_ns = static_cast<uint64_t>(
+        std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+
+    counters.pending.fetch_sub(1, std::memory_order_acq_rel);
+    pending_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    counters.started.fetch_add(1, std::memory_order_relaxed);
+    counters.total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    uint64_t seen = counters.max_wait_ns.load(std::memory_order_relaxed);
+    while (wait_ns > seen &&
+           !counters.max_wait_ns.compare_exchange_weak(seen, wait_ns, std::memory_order_relaxed)) {
+    }
+    queue_wait_ns.Record(wait_ns);
+}
+
+void ThreadPool::submit_task(unique_task task, TaskPriority priority) {
     std::lock_guard<std::mutex> lock(control_mutex);
     if (stop.load(std::memory_order_acquire)) {
         throw std::runtime_error("enqueue on stopped ThreadPool");
     }
 
-    pending_tasks.fetch_add(1, std::memory_order_release);
+    account_submitted(priority, 1);
 
-    const size_t index = submission_index.fetch_add(1, std::memory_order_relaxed) % worker_states.size();
+    // Only high priority work is routed to the reserved workers' inboxes
+    const size_t targets = priority == TaskPriority::high ? worker_states.size() : general_workers;
+    const size_t index = submission_index.fetch_add(1, std::memory_order_relaxed) % targets;
     {
         std::lock_guard<std::mutex> inbox_lock(worker_states[index]->inbox_mutex);
-        worker_states[index]->inbox.push_back(std::move(task));
+        worker_states[index]->inbox[level_of(priority)].push_back(
+            queued_task{std::move(task), std::chrono::steady_clock::now(), priority});
     }
 
-    condition.notify_one();
+    wake_for(priority, index);
 }
 
-bool ThreadPool::try_acquire_task(size_t worker_index, std::function<void()>& task) {
-    if (auto local = worker_states[worker_index]->local_tasks.pop_bottom()) {
-        task = std::move(*local);
-        pending_tasks.fetch_sub(1, std::memory_order_acq_rel);
-        return true;
+void ThreadPool::submit_bulk(std::vector<unique_task>& tasks, TaskPriority priority) {
+    if (tasks.empty()) {
+        return;
     }
 
-    if (try_drain_inbox_to_local(worker_index)) {
-        if (auto local = worker_states[worker_index]->local_tasks.pop_bottom()) {
-            task = std::move(*local);
-            pending_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    std::lock_guard<std::mutex> lock(control_mutex);
+    if (stop.load(std::memory_order_acquire)) {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    }
+
+    account_submitted(priority, tasks.size());
+
+    const auto now = std::chrono::steady_clock::now();
+    const size_t worker_count = priority == TaskPriority::high ? worker_states.size() : general_workers;
+    const size_t chunk = (tasks.size() + worker_count - 1) / worker_count;
+    const size_t first_worker = submission_index.fetch_add(1, std::memory_order_relaxed) % worker_count;
+    for (size_t start = 0, w = 0; start < tasks.size(); start += chunk, ++w) {
+        const size_t stop_at = std::min(start + chunk, tasks.size());
+        WorkerState& state = *worker_states[(first_worker + w) % worker_count];
+        std::lock_guard<std::mutex> inbox_lock(state.inbox_mutex);
+        for (size_t t = start; t < stop_at; ++t) {
+            state.inbox[level_of(priority)].push_back(queued_task{std::move(tasks[t]), now, priority});
+        }
+    }
+    const size_t filled_inboxes = (tasks.size() + chunk - 1) / chunk;
+    tasks.clear();
+
+    // One worker per filled inbox; the rest are reached by stealing
+    wake_workers(filled_inboxes, priority != TaskPriority::high);
+}
+
+bool ThreadPool::current_worker(size_t& worker_index) const {
+    if (tls_pool != this) {
+        return false;
+    }
+    worker_index = tls_worker_index;
+    return true;
+}
+
+void ThreadPool::spawn(unique_task task) {
+    size_t worker_index;
+    if (!current_worker(worker_index)) {
+        submit_task(std::move(task), TaskPriority::normal);
+        return;
+    }
+
+    // Only the owning worker pushes to its deque; idle workers steal from it
+    const TaskPriority priority = tls_priority;
+    account_submitted(priority, 1);
+    worker_states[worker_index]->local_tasks[level_of(priority)].push_bottom(
+        queued_task{std::move(task), std::chrono::steady_clock::now(), priority});
+    wake_for(priority, worker_states.size());
+}
+
+void ThreadPool::wait_for(fork_join_state& state) {
+    size_t worker_index;
+    if (current_worker(worker_index)) {
+        // Blocking a worker here could leave the remaining chunks with
+        // nobody to run them, so keep draining tasks instead
+        const TaskPriority own_priority = tls_priority;
+        while (state.remaining.load(std::memory_order_acquire) != 0) {
+            queued_task task;
+            if (try_acquire_task(worker_index, task)) {
+                run_task(task);
+                tls_priority = own_priority;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    state.wait_done();
+}
+
+void ThreadPool::fork_join_state::fail(std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+        error = std::move(exception);
+    }
+    failed.store(true, std::memory_order_relaxed);
+}
+
+void ThreadPool::fork_join_state::complete_chunk() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Notify under the lock: the waiter owns this object and destroys it
+        // as soon as it observes `done`
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        done_condition.notify_all();
+    }
+}
+
+void ThreadPool::fork_join_state::wait_done() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done_condition.wait(lock, [this] { return done; });
+}
+
+bool ThreadPool::try_acquire_task(size_t worker_index, queued_task& task) {
+    const size_t levels = worker_states[worker_index]->high_priority_only ? 1 : kTaskPriorityLevels;
+    for (size_t level = 0; level < levels; ++level) {
+        // Skips the inbox locks and victim scans of empty levels
+        if (priority_stats[level].pending.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+        if (try_acquire_level(worker_index, level, task)) {
+            account_started(task);
             return true;
         }
     }
+    return false;
+}
 
-    if (try_steal_task(worker_index, task)) {
-        pending_tasks.fetch_sub(1, std::memory_order_acq_rel);
+bool ThreadPool::try_acquire_level(size_t worker_index, size_t level, queued_task& task) {
+    auto& local_tasks = worker_states[worker_index]->local_tasks[level];
+    if (auto local = local_tasks.pop_bottom()) {
+        task = std::move(*local);
         return true;
     }
 
-    return false;
+    if (try_drain_inbox_to_local(worker_index, level)) {
+        if (auto local = local_tasks.pop_bottom()) {
+            task = std::move(*local);
+            return true;
+        }
+    }
+
+    return try_steal_task(worker_index, level, task);
 }
 
-bool ThreadPool::try_drain_inbox_to_local(size_t worker_index) {
-    std::deque<std::function<void()>> staged;
+bool ThreadPool::try_drain_inbox_to_local(size_t worker_index, size_t level) {
+    std::deque<queued_task> staged;
     {
         std::lock_guard<std::mutex> lock(worker_states[worker_index]->inbox_mutex);
-        if (worker_states[worker_index]->inbox.empty()) {
+        if (worker_states[worker_index]->inbox[level].empty()) {
             return false;
         }
-        staged.swap(worker_states[worker_index]->inbox);
+        staged.swap(worker_states[worker_index]->inbox[level]);
     }
 
-    for (auto& queued_task : staged) {
-        worker_states[worker_index]->local_tasks.push_bottom(std::move(queued_task));
+    for (auto& staged_task : staged) {
+        worker_states[worker_index]->local_tasks[level].push_bottom(std::move(staged_task));
     }
     return true;
 }
 
-bool ThreadPool::try_steal_task(size_t worker_index, std::function<void()>& task) {
-    const size_t worker_count = worker_states.size();
-    for (size_t offset = 1; offset < worker_count; ++offset) {
-        const size_t victim = (worker_index + offset) % worker_count;
-        if (auto stolen = worker_states[victim]->local_tasks.steal_top()) {
+bool ThreadPool::try_steal_task(size_t worker_index, size_t level, queued_task& task) {
+    static metrics::Counter& steals = metrics::Registry::Instance().GetCounter("thread_pool.steals");
+
+    for (size_t victim : worker_states[worker_index]->steal_order) {
+        if (auto stolen = worker_states[victim]->local_tasks[level].steal_top()) {
             task = std::move(*stolen);
+            steals.Add();
             return true;
         }
 
         std::lock_guard<std::mutex> inbox_lock(worker_states[victim]->inbox_mutex);
-        if (!worker_states[victim]->inbox.empty()) {
-            task = std::move(worker_states[victim]->inbox.front());
-            worker_states[victim]->inbox.pop_front();
+        auto& inbox = worker_states[victim]->inbox[level];
+        if (!inbox.empty()) {
+            task = std::move(inbox.front());
+            inbox.pop_front();
+            steals.Add();
             return true;
         }
     }
@@ -116,11 +545,14 @@ bool ThreadPool::try_steal_task(size_t worker_index, std::function<void()>& task
 }
 
 ThreadPool::~ThreadPool() {
+    metrics::Registry::Instance().RemoveCallbackGauge(metrics_gauge_id);
     {
         std::lock_guard<std::mutex> lock(control_mutex);
-        stop.store(true, std::memory_order_release);
+        stop.store(true, std::memory_order_seq_cst);
+    }
+    for (size_t i = 0; i < worker_states.size(); ++i) {
+        unpark_worker(i);
     }
-    condition.notify_all();
     for(std::thread &worker: workers) {
         if(worker.joinable()) {
             worker.join();
@@ -132,10 +564,36 @@ size_t ThreadPool::get_task_count() const {
     return pending_tasks.load(std::memory_order_acquire);
 }
 
+size_t ThreadPool::get_task_count(TaskPriority priority) const {
+    return priority_stats[level_of(priority)].pending.load(std::memory_order_acquire);
+}
+
+ThreadPool::PriorityStats ThreadPool::get_priority_stats(TaskPriority priority) const {
+    const priority_counters& counters = priority_stats[level_of(priority)];
+    PriorityStats stats;
+    stats.queued = counters.pending.load(std::memory_order_acquire);
+    stats.started = counters.started.load(std::memory_order_relaxed);
+    stats.total_wait_ns = counters.total_wait_ns.load(std::memory_order_relaxed);
+    stats.max_wait_ns = counters.max_wait_ns.load(std::memory_order_relaxed);
+    return stats;
+}
+
 size_t ThreadPool::get_thread_count() const {
     return workers.size();
 }
 
+size_t ThreadPool::get_parked_count() const {
+    return parked_workers.load(std::memory_order_acquire);
+}
+
+uint32_t ThreadPool::get_worker_node(size_t worker_index) const {
+    return worker_index < worker_states.size() ? worker_states[worker_index]->numa_node : 0;
+}
+
+size_t ThreadPool::get_group_count() const {
+    return group_count;
+}
+
 } // namespace thread
 } // namespace SAK
 
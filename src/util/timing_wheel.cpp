@@ -0,0 +1,112 @@
+#include "timing_wheel.hpp"
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+namespace SAK {
+namespace timer {
+
+namespace {
+
+int lowest_bit(uint64_t mask) {
+#ifdef _WIN32
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+int first_set_from(const uint64_t* bits, int start) {
+    for (int word = start / 64; word < TimingWheel::SLOTS / 64; ++word) {
+        uint64_t mask = bits[word];
+        if (word == start / 64) {
+            mask &= ~uint64_t(0) << (start % 64);
+        }
+        if (mask != 0) {
+            return word * 64 + lowest_bit(mask);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+void TimingWheel::place(Node& node) {
+    uint64_t delta = node.expires - current_;
+    uint64_t position = node.expires;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    if (delta >= (uint64_t(1) << (SLOT_BITS * LEVELS))) {
+        // Beyond the wheel; park at the far end of the top level
+        position = current_ + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    }
+    int slot = static_cast<int>((position >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.linked = true;
+    slots_[level][slot].PushBack(node);
+    occupied_[level][slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void TimingWheel::unlink(Node& node) {
+    List& list = slots_[node.level][node.slot];
+    list.Remove(node);
+    node.linked = false;
+    if (list.Empty()) {
+        occupied_[node.level][node.slot / 64] &= ~(uint64_t(1) << (node.slot % 64));
+    }
+}
+
+// Called when level 0 wraps: redistributes the next slot of each level
+// whose lower neighbour wrapped too
+void TimingWheel::cascade() {
+    for (int level = 1; level < LEVELS; ++level) {
+        int index = static_cast<int>((current_ >> (SLOT_BITS * level)) & (SLOTS - 1));
+        List& list = slots_[level][index];
+        while (!list.Empty()) {
+            Node& node = list.Front();
+            unlink(node);
+            place(node);
+        }
+        if (index != 0) {
+            break;
+        }
+    }
+}
+
+uint64_t TimingWheel::next_tick() const {
+    if (size_ == 0) {
+        return NO_TICK;
+    }
+    uint64_t next = current_ + 1;
+    int start = static_cast<int>(next & (SLOTS - 1));
+    int slot = first_set_from(occupied_[0], start);
+    if (slot >= 0) {
+        return next + static_cast<uint64_t>(slot - start);
+    }
+    // Slots before `start` belong to the next turn, which begins with a cascade
+    return (current_ | (SLOTS - 1)) + 1;
+}
+
+void TimingWheel::clear() {
+    for (auto& level : slots_) {
+        for (auto& list : level) {
+            list.Clear();
+        }
+    }
+    for (auto& bits : occupied_) {
+        for (auto& word : bits) {
+            word = 0;
+        }
+    }
+    size_ = 0;
+}
+
+} // namespace timer
+} // namespace SAK
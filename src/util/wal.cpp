@@ -0,0 +1,451 @@
+#include "wal.hpp"
+#include "coding.hpp"
+#include "crc32c.hpp"
+#include "memtable.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SAK {
+
+size_t WalFormat::BlockSize(const Options& options) {
+    return std::min(std::max(options.block_size, kHeaderSize + 1), kMaxBlockSize);
+}
+
+void WalFormat::EncodeBatch(const WalEntry* entries, size_t count, std::vector<uint8_t>& out) {
+    size_t size = 4;
+    for (size_t i = 0; i < count; ++i) {
+        size += 4 + entries[i].key.Size() + 8 + 4 + entries[i].value.Size();
+    }
+    out.clear();
+    out.reserve(size);
+    coding::PutFixed32(out, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        const WalEntry& entry = entries[i];
+        coding::PutFixed32(out, static_cast<uint32_t>(entry.key.Size()));
+        out.insert(out.end(), entry.key.Data(), entry.key.Data() + entry.key.Size());
+        coding::PutFixed64(out, entry.ts);
+        coding::PutFixed32(out, static_cast<uint32_t>(entry.value.Size()));
+        out.insert(out.end(), entry.value.Data(), entry.value.Data() + entry.value.Size());
+    }
+}
+
+bool WalFormat::DecodeBatch(const uint8_t* data, size_t size, std::vector<WalEntry>& out) {
+    out.clear();
+    const uint8_t* end = data + size;
+    if (size < 4) {
+        return false;
+    }
+    uint32_t count = coding::GetFixed32(data);
+    data += 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (static_cast<size_t>(end - data) < 4) {
+            return false;
+        }
+        uint32_t key_size = coding::GetFixed32(data);
+        data += 4;
+        if (static_cast<size_t>(end - data) < size_t(key_size) + 8 + 4) {
+            return false;
+        }
+        const uint8_t* key = data;
+        data += key_size;
+        uint64_t ts = coding::GetFixed64(data);
+        data += 8;
+        uint32_t value_size = coding::GetFixed32(data);
+        data += 4;
+        if (static_cast<size_t>(end - data) < value_size) {
+            return false;
+        }
+        out.push_back(WalEntry{ByteBuffer(key, key_size), ts,
+                               value_size ? ByteBuffer(data, value_size) : ByteBuffer()});
+        data += value_size;
+    }
+    return data == end;
+}
+
+WalWriter::WalWriter(const std::string& path, const Options& options)
+    : block_size_(WalFormat::BlockSize(options)),
+      sync_policy_(options.wal_sync_policy),
+      sync_bytes_(options.wal_sync_bytes) {
+#ifdef _WIN32
+    HANDLE handle = ::CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(handle, &size)) {
+        ::CloseHandle(handle);
+        return;
+    }
+    handle_ = handle;
+    file_size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return;
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    block_offset_ = file_size_ % block_size_;
+}
+
+WalWriter::~WalWriter() {
+    if (!Valid()) {
+        return;
+    }
+    if (sync_policy_ != WalSyncPolicy::None && unsynced_bytes_ > 0 && !broken_) {
+        SyncFile();
+    }
+#ifdef _WIN32
+    ::CloseHandle(static_cast<HANDLE>(handle_));
+#else
+    ::close(fd_);
+#endif
+}
+
+bool WalWriter::Valid() const noexcept {
+#ifdef _WIN32
+    return handle_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+bool WalWriter::Write(const std::vector<WalEntry>& entries) {
+    std::vector<uint8_t> payload;
+    WalFormat::EncodeBatch(entries.data(), entries.size(), payload);
+    Waiter waiter(&payload);
+    return Commit(waiter);
+}
+
+bool WalWriter::Put(const ByteBuffer& key, uint64_t ts, const ByteBuffer& value) {
+    WalEntry entry{key, ts, value};
+    std::vector<uint8_t> payload;
+    WalFormat::EncodeBatch(&entry, 1, payload);
+    Waiter waiter(&payload);
+    return Commit(waiter);
+}
+
+bool WalWriter::Sync() {
+    Waiter waiter(nullptr);
+    return Commit(waiter);
+}
+
+bool WalWriter::Commit(Waiter& waiter) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!Valid() || broken_) {
+        return false;
+    }
+    queue_.push_back(&waiter);
+    while (!waiter.done && queue_.front() != &waiter) {
+        waiter.cv.wait(lock);
+    }
+    if (waiter.done) {
+        return waiter.ok;
+    }
+
+    // Leader: take what is queued behind us, within kMaxGroupBytes
+    std::vector<Waiter*> group;
+    size_t group_bytes = 0;
+    for (Waiter* queued : queue_) {
+        size_t bytes = queued->payload ? queued->payload->size() : 0;
+        if (!group.empty() && group_bytes + bytes > kMaxGroupBytes) {
+            break;
+        }
+        group.push_back(queued);
+        group_bytes += bytes;
+    }
+    bool ok = !broken_;
+    lock.unlock();
+
+    bool sync = sync_policy_ == WalSyncPolicy::Always;
+    uint64_t written = 0;
+    if (ok) {
+        group_buffer_.clear();
+        for (Waiter* member : group) {
+            if (member->payload) {
+                Frame(member->payload->data(), member->payload->size());
+            } else {
+                sync = true;
+            }
+        }
+        written = group_buffer_.size();
+        ok = WriteAll(group_buffer_.data(), group_buffer_.size());
+        unsynced_bytes_ += written;
+        if (sync_policy_ == WalSyncPolicy::Periodic && unsynced_bytes_ >= sync_bytes_) {
+            sync = true;
+        }
+        sync = sync && ok && unsynced_bytes_ > 0;
+        if (sync) {
+            ok = SyncFile();
+            unsynced_bytes_ = 0;
+        }
+    }
+    // Keep the group buffer from pinning an unusually large group
+    if (group_buffer_.capacity() > 2 * kMaxGroupBytes) {
+        std::vector<uint8_t>().swap(group_buffer_);
+    }
+
+    lock.lock();
+    broken_ = broken_ || !ok;
+    file_size_ += written;
+    groups_ += written > 0 ? 1 : 0;
+    syncs_ += sync ? 1 : 0;
+    for (Waiter* member : group) {
+        queue_.pop_front();
+        member->ok = ok;
+        member->done = true;
+        if (member != &waiter) {
+            member->cv.notify_one();
+        }
+    }
+    if (!queue_.empty()) {
+        queue_.front()->cv.notify_one();
+    }
+    return ok;
+}
+
+void WalWriter::Frame(const uint8_t* data, size_t size) {
+    bool begin = true;
+    do {
+        size_t leftover = block_size_ - block_offset_;
+        if (leftover < WalFormat::kHeaderSize) {
+            group_buffer_.insert(group_buffer_.end(), leftover, 0);
+            block_offset_ = 0;
+        }
+        size_t fragment = std::min(size, block_size_ - block_offset_ - WalFormat::kHeaderSize);
+        bool end = fragment == size;
+        uint8_t type = begin && end ? WalFormat::kFull
+                       : begin      ? WalFormat::kFirst
+                       : end        ? WalFormat::kLast
+                                    : WalFormat::kMiddle;
+        uint32_t crc = Crc32c::Extend(Crc32c::Compute(&type, 1), data, fragment);
+        coding::PutFixed32(group_buffer_, crc);
+        group_buffer_.push_back(static_cast<uint8_t>(fragment));
+        group_buffer_.push_back(static_cast<uint8_t>(fragment >> 8));
+        group_buffer_.push_back(type);
+        group_buffer_.insert(group_buffer_.end(), data, data + fragment);
+        data += fragment;
+        size -= fragment;
+        block_offset_ += WalFormat::kHeaderSize + fragment;
+        begin = false;
+    } while (size > 0);
+}
+
+bool WalWriter::WriteAll(const uint8_t* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        DWORD written = 0;
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        if (!::WriteFile(static_cast<HANDLE>(handle_), data, chunk, &written, nullptr)) {
+            return false;
+        }
+#else
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+#endif
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool WalWriter::SyncFile() {
+#ifdef _WIN32
+    return ::FlushFileBuffers(static_cast<HANDLE>(handle_)) != 0;
+#elif defined(__APPLE__)
+    return ::fsync(fd_) == 0;
+#else
+    return ::fdatasync(fd_) == 0;
+#endif
+}
+
+uint64_t WalWriter::FileSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_size_;
+}
+
+uint64_t WalWriter::GroupCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return groups_;
+}
+
+uint64_t WalWriter::SyncCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return syncs_;
+}
+
+WalReader::WalReader(const std::string& path, const Options& options)
+    : file_(FileObject::Open(path)),
+      block_size_(WalFormat::BlockSize(options)) {
+}
+
+bool WalReader::FillBuffer() {
+    uint64_t size = file_.Size();
+    if (file_offset_ >= size) {
+        return false;
+    }
+    // Drop consumed blocks; buffer_ keeps starting on a block boundary
+    size_t keep_from = buffer_pos_ - buffer_pos_ % block_size_;
+    buffer_.erase(buffer_.begin(), buffer_.begin() + keep_from);
+    buffer_pos_ -= keep_from;
+
+    size_t len = static_cast<size_t>(std::min<uint64_t>(size - file_offset_, kBlocksPerRead * block_size_));
+    size_t end = buffer_.size();
+    buffer_.resize(end + len);
+    if (!file_.ReadInto(file_offset_, buffer_.data() + end, len)) {
+        buffer_.resize(end);
+        return false;
+    }
+    file_offset_ += len;
+    return true;
+}
+
+bool WalReader::ReadFragment(uint8_t& type, const uint8_t*& data, size_t& size) {
+    for (;;) {
+        size_t left_in_block = block_size_ - buffer_pos_ % block_size_;
+        size_t available = buffer_.size() - buffer_pos_;
+        if (left_in_block < WalFormat::kHeaderSize) {
+            // Zero-filled block tail
+            if (available < left_in_block && FillBuffer()) {
+                continue;
+            }
+            if (available < left_in_block) {
+                return false;
+            }
+            buffer_pos_ += left_in_block;
+            continue;
+        }
+        if (available < WalFormat::kHeaderSize) {
+            if (!FillBuffer()) {
+                return false;
+            }
+            continue;
+        }
+
+        const uint8_t* header = buffer_.data() + buffer_pos_;
+        uint32_t crc = coding::GetFixed32(header);
+        size_t length = size_t(header[4]) | size_t(header[5]) << 8;
+        uint8_t fragment_type = header[6];
+        if (fragment_type == WalFormat::kZero || WalFormat::kHeaderSize + length > left_in_block) {
+            // Not a fragment the writer could have made; resume at the next block
+            corrupted_bytes_ += std::min(left_in_block, available);
+            buffer_pos_ += std::min(left_in_block, available);
+            continue;
+        }
+        if (available < WalFormat::kHeaderSize + length) {
+            if (!FillBuffer()) {
+                // Torn write at the end of the log
+                return false;
+            }
+            continue;
+        }
+        const uint8_t* payload = header + WalFormat::kHeaderSize;
+        if (Crc32c::Extend(Crc32c::Compute(&fragment_type, 1), payload, length) != crc) {
+            // The last block is not padded, so it may end before left_in_block
+            corrupted_bytes_ += std::min(left_in_block, available);
+            buffer_pos_ += std::min(left_in_block, available);
+            continue;
+        }
+        type = fragment_type;
+        data = payload;
+        size = length;
+        buffer_pos_ += WalFormat::kHeaderSize + length;
+        return true;
+    }
+}
+
+bool WalReader::ReadRecord(std::vector<uint8_t>& record) {
+    record.clear();
+    bool in_record = false;
+    uint8_t type;
+    const uint8_t* data;
+    size_t size;
+    uint64_t corrupted = corrupted_bytes_;
+    while (ReadFragment(type, data, size)) {
+        if (corrupted_bytes_ != corrupted && in_record) {
+            // Fragments were skipped; what follows belongs to another record
+            corrupted_bytes_ += record.size();
+            record.clear();
+            in_record = false;
+        }
+        corrupted = corrupted_bytes_;
+        switch (type) {
+        case WalFormat::kFull:
+        case WalFormat::kFirst:
+            if (in_record) {
+                // The rest of the previous record was lost
+                corrupted_bytes_ += record.size();
+            }
+            record.assign(data, data + size);
+            if (type == WalFormat::kFull) {
+                return true;
+            }
+            in_record = true;
+            break;
+        case WalFormat::kMiddle:
+        case WalFormat::kLast:
+            if (!in_record) {
+                corrupted_bytes_ += size;
+                break;
+            }
+            record.insert(record.end(), data, data + size);
+            if (type == WalFormat::kLast) {
+                return true;
+            }
+            break;
+        default:
+            corrupted_bytes_ += size;
+            break;
+        }
+    }
+    return false;
+}
+
+size_t WalReader::Replay(const std::string& path, const Options& options, MemTable& table, uint64_t* max_ts) {
+    WalReader reader(path, options);
+    if (!reader.Valid()) {
+        return 0;
+    }
+    size_t replayed = 0;
+    std::vector<uint8_t> record;
+    std::vector<WalEntry> entries;
+    while (reader.ReadRecord(record)) {
+        // A batch is applied whole or not at all
+        if (!WalFormat::DecodeBatch(record.data(), record.size(), entries)) {
+            reader.corrupted_bytes_ += record.size();
+            continue;
+        }
+        for (const WalEntry& entry : entries) {
+            table.Put(entry.key, entry.ts, entry.value);
+            if (max_ts) {
+                *max_ts = std::max(*max_ts, entry.ts);
+            }
+            ++replayed;
+        }
+    }
+    return replayed;
+}
+
+} // namespace SAK
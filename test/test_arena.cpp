@@ -0,0 +1,152 @@
+#include "util/arena.hpp"
+#include "util/byte_buffer.hpp"
+#include "util/ipc_packet.hpp"
+#include "util/memory_pool_v2.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace SAK;
+
+TEST(Arena, BumpAllocatesWithAlignment) {
+    Arena arena(4096);
+    EXPECT_EQ(arena.BlockCount(), 0u);
+
+    char* a = static_cast<char*>(arena.Allocate(3, 1));
+    void* b = arena.Allocate(8, 8);
+    void* c = arena.Allocate(64, 64);
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0u);
+    EXPECT_EQ(arena.BlockCount(), 1u);
+    EXPECT_EQ(arena.BytesUsed(), 3u + 8u + 64u);
+    EXPECT_EQ(arena.BytesReserved(), 4096u);
+    EXPECT_EQ(arena.BytesWasted(), 4096u - arena.BytesUsed());
+
+    // Consecutive allocations come out of the same block
+    EXPECT_LT(static_cast<char*>(b) - a, 64);
+}
+
+TEST(Arena, ChainsBlocksAndResetKeepsOne) {
+    Arena arena(4096);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(arena.Allocate(200), nullptr);
+    }
+    EXPECT_GT(arena.BlockCount(), 1u);
+
+    // Oversized requests get a dedicated block
+    void* big = arena.Allocate(100000);
+    ASSERT_NE(big, nullptr);
+    std::memset(big, 0x5A, 100000);
+    EXPECT_GE(arena.BytesReserved(), 100000u);
+
+    arena.Reset();
+    EXPECT_EQ(arena.BlockCount(), 1u);
+    EXPECT_EQ(arena.BytesUsed(), 0u);
+    EXPECT_EQ(arena.BytesReserved(), 4096u);
+
+    // The retained block is reused from its start
+    void* first = arena.Allocate(16);
+    arena.Reset();
+    EXPECT_EQ(arena.Allocate(16), first);
+}
+
+TEST(Arena, BlocksComeFromMemoryPoolV2) {
+    auto before = MemoryPoolV2::GetInstance().GetStats();
+    {
+        Arena arena;
+        arena.Allocate(100);
+        arena.Allocate(Arena::kDefaultBlockSize * 2);
+    }
+    auto after = MemoryPoolV2::GetInstance().GetStats();
+    EXPECT_EQ(after.total_allocated - before.total_allocated,
+              after.total_deallocated - before.total_deallocated);
+    EXPECT_GE(after.total_allocated - before.total_allocated, Arena::kDefaultBlockSize * 3);
+}
+
+TEST(Arena, MoveTransfersBlocks) {
+    Arena a(4096);
+    void* p = a.Allocate(32);
+    Arena b(std::move(a));
+    EXPECT_EQ(a.BlockCount(), 0u);
+    EXPECT_EQ(b.BlockCount(), 1u);
+    EXPECT_EQ(b.BytesUsed(), 32u);
+    EXPECT_NE(p, nullptr);
+}
+
+TEST(ArenaAllocator, BacksStandardContainers) {
+    Arena arena;
+    std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[999], 999);
+
+    using Map = std::map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int>>>;
+    Map map{ArenaAllocator<std::pair<const int, int>>(arena)};
+    for (int i = 0; i < 100; ++i) {
+        map[i] = i * 2;
+    }
+    EXPECT_EQ(map.at(50), 100);
+    EXPECT_GT(arena.BytesUsed(), 1000 * sizeof(int));
+
+    Arena other;
+    EXPECT_TRUE(ArenaAllocator<int>(arena) == ArenaAllocator<char>(arena));
+    EXPECT_TRUE(ArenaAllocator<int>(arena) != ArenaAllocator<int>(other));
+}
+
+TEST(ArenaByteBuffer, SharesArenaStorage) {
+    Arena arena;
+    const char text[] = "request payload";
+    size_t used_before = arena.BytesUsed();
+    {
+        ByteBuffer buffer(arena, text, sizeof(text) - 1);
+        EXPECT_EQ(buffer.ToString(), "request payload");
+        EXPECT_GT(arena.BytesUsed(), used_before + sizeof(text) - 1);  // Control block too
+
+        ByteBuffer slice = buffer.Slice(8, 7);
+        EXPECT_EQ(slice.ToString(), "payload");
+        ByteBuffer copy = buffer;
+        EXPECT_EQ(copy, buffer);
+
+        ByteBuffer heap = buffer.Clone();
+        EXPECT_EQ(heap, buffer);
+        EXPECT_NE(heap.Data(), buffer.Data());
+    }
+
+    ByteBuffer empty(arena, nullptr, 0);
+    EXPECT_TRUE(empty.Empty());
+    EXPECT_EQ(empty.Data(), nullptr);
+}
+
+TEST(ArenaIPCPacket, PayloadLivesInArena) {
+    Arena arena;
+    const char payload[] = "hello arena";
+    ipc::IPCPacket packet(arena, ipc::MessageType::MSG_REQUEST, 7, payload, sizeof(payload));
+    EXPECT_TRUE(packet.IsArenaBacked());
+    EXPECT_TRUE(packet.IsValid());
+    EXPECT_EQ(arena.BytesUsed(), sizeof(payload));
+
+    std::string wire = packet.Serialize();
+    ipc::IPCPacket parsed(arena, wire.data(), static_cast<uint32_t>(wire.size()));
+    EXPECT_TRUE(parsed.IsValid());
+    EXPECT_EQ(parsed.GetSequenceNumber(), 7u);
+    EXPECT_EQ(std::memcmp(parsed.GetPayload(), payload, sizeof(payload)), 0);
+
+    // Copies detach from the arena
+    ipc::IPCPacket copy = parsed;
+    EXPECT_FALSE(copy.IsArenaBacked());
+    EXPECT_TRUE(copy.IsValid());
+
+    ipc::IPCPacket moved = std::move(parsed);
+    EXPECT_TRUE(moved.IsArenaBacked());
+    EXPECT_TRUE(moved.IsValid());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+#include "util/block_cache.hpp"
+#include "util/sstable.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using SAK::Block;
+using SAK::BlockBuilder;
+using SAK::BlockCache;
+using SAK::ByteBuffer;
+using SAK::CachePriority;
+
+namespace {
+
+// A block of about `bytes` bytes with a single entry
+std::shared_ptr<const Block> MakeBlock(size_t bytes, const std::string& key = "k") {
+    BlockBuilder builder;
+    builder.Add(ByteBuffer(key), 1, ByteBuffer(std::string(bytes, 'v')));
+    return Block::Decode(ByteBuffer(builder.Finish()));
+}
+
+} // namespace
+
+TEST(BlockCache, LooksUpByFileAndOffset) {
+    BlockCache cache(1 << 20, 2);
+    auto block = MakeBlock(100);
+    cache.Insert(1, 0, block);
+    cache.Insert(2, 0, MakeBlock(100));
+    EXPECT_EQ(cache.Lookup(1, 0), block);
+    EXPECT_NE(cache.Lookup(2, 0), nullptr);
+    EXPECT_EQ(cache.Lookup(1, 4096), nullptr);
+    EXPECT_EQ(cache.Hits(), 2u);
+    EXPECT_EQ(cache.Misses(), 1u);
+    EXPECT_EQ(cache.Count(), 2u);
+    EXPECT_EQ(cache.Usage(), 2 * (block->Size() + BlockCache::kEntryOverhead));
+
+    // Replacing keeps one entry per key
+    cache.Insert(1, 0, MakeBlock(200));
+    EXPECT_EQ(cache.Count(), 2u);
+    EXPECT_NE(cache.Lookup(1, 0), block);
+
+    cache.Erase(2, 0);
+    EXPECT_EQ(cache.Lookup(2, 0), nullptr);
+    cache.Insert(3, 0, MakeBlock(10));
+    cache.Insert(3, 4096, MakeBlock(10));
+    cache.EraseFile(3);
+    EXPECT_EQ(cache.Count(), 1u);
+}
+
+TEST(BlockCache, EvictsToCapacityButPinnedBlocksStayValid) {
+    BlockCache cache(16 * 1024, 0);
+    auto pinned = MakeBlock(1000, "pinned");
+    cache.Insert(1, 0, pinned);
+    for (uint64_t i = 1; i <= 100; ++i) {
+        cache.Insert(1, i * 4096, MakeBlock(1000));
+        EXPECT_LE(cache.Usage(), cache.Capacity());
+    }
+    EXPECT_EQ(cache.Lookup(1, 0), nullptr);
+    EXPECT_LT(cache.Count(), 16u);
+
+    SAK::BlockIterator it(pinned);
+    ASSERT_TRUE(it.Valid());
+    EXPECT_EQ(it.Key().ToString(), "pinned");
+    EXPECT_EQ(it.Value().Size(), 1000u);
+
+    // Too large for the shard
+    cache.Insert(2, 0, MakeBlock(20000));
+    EXPECT_EQ(cache.Lookup(2, 0), nullptr);
+}
+
+TEST(BlockCache, ScansDoNotDisplaceTheHotSet) {
+    BlockCache cache(64 * 1024, 0);
+    for (uint64_t i = 0; i < 20; ++i) {
+        cache.Insert(1, i, MakeBlock(1000));
+        ASSERT_NE(cache.Lookup(1, i), nullptr);  // Hit again: protected
+    }
+    // A long scan, both at low and at normal priority
+    for (uint64_t i = 0; i < 500; ++i) {
+        cache.Insert(2, i, MakeBlock(1000), i % 2 ? CachePriority::Low : CachePriority::High);
+    }
+    for (uint64_t i = 0; i < 20; ++i) {
+        EXPECT_NE(cache.Lookup(1, i), nullptr) << i;
+    }
+    EXPECT_LE(cache.Usage(), cache.Capacity());
+
+    // A low-priority block is the next to go
+    cache.Insert(3, 0, MakeBlock(1000));
+    cache.Insert(3, 1, MakeBlock(1000), CachePriority::Low);
+    cache.Insert(3, 2, MakeBlock(1000));
+    EXPECT_EQ(cache.Lookup(3, 1), nullptr);
+    EXPECT_NE(cache.Lookup(3, 0), nullptr);
+}
+
+TEST(BlockCache, ConcurrentLookupsAndInserts) {
+    BlockCache cache(256 * 1024, 3);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> found{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (uint64_t i = 0; i < 5000; ++i) {
+                uint64_t offset = (i * 7 + static_cast<uint64_t>(t)) % 512;
+                if (auto block = cache.Lookup(1, offset)) {
+                    SAK::BlockIterator it(block);
+                    found += it.Valid();
+                } else {
+                    cache.Insert(1, offset, MakeBlock(500));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(cache.Hits() + cache.Misses(), 4u * 5000u);
+    EXPECT_EQ(found.load(), cache.Hits());
+    EXPECT_LE(cache.Usage(), cache.Capacity());
+}
+
+TEST(BlockCache, SharedAcrossTables) {
+    SAK::Options options;
+    options.block_size = 512;
+    options.block_cache_size = 1 << 20;
+    auto cache = BlockCache::Create(options);
+    ASSERT_NE(cache, nullptr);
+
+    std::vector<std::string> paths;
+    std::vector<std::shared_ptr<SAK::SsTable>> tables;
+    for (size_t id = 0; id < 2; ++id) {
+        paths.push_back((fs::temp_directory_path() /
+                         ("sak_cache_test_" + std::to_string(getpid()) + "_" + std::to_string(id) + ".sst"))
+                            .string());
+        SAK::SsTableBuilder builder(options);
+        for (int i = 0; i < 200; ++i) {
+            builder.Add(ByteBuffer("key" + std::to_string(1000 + i)), 1, ByteBuffer(std::to_string(id)));
+        }
+        tables.push_back(builder.Build(id, paths.back(), cache));
+        ASSERT_NE(tables.back(), nullptr);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (size_t id = 0; id < 2; ++id) {
+            EXPECT_EQ(tables[id]->Get(ByteBuffer("key1100"), 1)->ToString(), std::to_string(id));
+        }
+    }
+    EXPECT_EQ(cache->Misses(), 2u);
+    EXPECT_EQ(cache->Hits(), 4u);
+
+    for (SAK::SsTableIterator it(tables[0]); it.Valid(); it.Next()) {
+    }
+    EXPECT_EQ(cache->Count(), tables[0]->NumBlocks() + 1);
+
+    SAK::Options disabled;
+    disabled.block_cache_size = 0;
+    EXPECT_EQ(BlockCache::Create(disabled), nullptr);
+    tables.clear();
+    for (const auto& path : paths) {
+        fs::remove(path);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+#include "util/byte_buffer.hpp"
+#include "util/hash.hpp"
+#include "util/key.hpp"
+#include "util/key_ts.hpp"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+using SAK::ByteBuffer;
+
+namespace {
+
+// Counts global allocations so the tests can check for their absence
+size_t g_allocations = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+TEST(ByteBuffer, ShortBuffersStayInline) {
+    const std::string key(ByteBuffer::kInlineCapacity, 'k');
+    size_t before = g_allocations;
+    ByteBuffer a(key.data(), key.size());
+    ByteBuffer b = a;
+    ByteBuffer c = std::move(b);
+    ByteBuffer d = a.Slice(3, 10);
+    EXPECT_EQ(g_allocations, before);
+    EXPECT_TRUE(a.IsInline());
+    EXPECT_TRUE(c.IsInline());
+    EXPECT_EQ(c.ToString(), key);
+    EXPECT_TRUE(b.Empty());
+    EXPECT_EQ(b.Data(), nullptr);
+    EXPECT_EQ(d.ToString(), key.substr(3, 10));
+    EXPECT_NE(a.Data(), c.Data());
+    EXPECT_EQ(sizeof(ByteBuffer), 32u);
+}
+
+TEST(ByteBuffer, LongBuffersShareOneAllocation) {
+    const std::string text(100, 'x');
+    size_t before = g_allocations;
+    ByteBuffer a(text);
+    EXPECT_EQ(g_allocations, before + 1);  // Bytes and reference count together
+    EXPECT_FALSE(a.IsInline());
+
+    ByteBuffer b = a;
+    ByteBuffer slice = a.Slice(10, 50);
+    EXPECT_EQ(g_allocations, before + 1);
+    EXPECT_EQ(b.Data(), a.Data());
+    EXPECT_EQ(slice.Data(), a.Data() + 10);
+
+    // Short slices of long buffers are copied inline and outlive it
+    ByteBuffer tail = a.Slice(90, 10);
+    EXPECT_TRUE(tail.IsInline());
+    a = ByteBuffer("short");
+    b.Clear();
+    slice = ByteBuffer();
+    EXPECT_EQ(tail.ToString(), std::string(10, 'x'));
+    EXPECT_EQ(a.ToString(), "short");
+
+    std::vector<uint8_t> bytes(1000, 7);
+    const uint8_t* storage = bytes.data();
+    ByteBuffer adopted(std::move(bytes));
+    EXPECT_EQ(reinterpret_cast<const uint8_t*>(adopted.Data()), storage);
+}
+
+TEST(ByteBuffer, ComparesAndHashesWithoutAllocating) {
+    ByteBuffer a("apple");
+    ByteBuffer b("apples");
+    ByteBuffer c(std::string(40, 'z'));
+    size_t before = g_allocations;
+    EXPECT_LT(a, b);
+    EXPECT_GT(c, b);
+    EXPECT_LE(a, a);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(ByteBuffer(), ByteBuffer(""));
+    EXPECT_LT(ByteBuffer(), a);
+    EXPECT_EQ(a.Compare(ByteBuffer("apple")), 0);
+    EXPECT_EQ(std::hash<ByteBuffer>()(a), std::hash<ByteBuffer>()(ByteBuffer("apple")));
+    EXPECT_NE(std::hash<ByteBuffer>()(a), std::hash<ByteBuffer>()(b));
+
+    SAK::KeyBuffer ka(a);
+    SAK::KeyBuffer kb(b);
+    EXPECT_TRUE(ka < kb);
+    EXPECT_FALSE(ka == kb);
+    EXPECT_TRUE(SAK::KeyTs(a, 2) < SAK::KeyTs(a, 1));
+    EXPECT_TRUE(SAK::KeyTs(a, 1) < SAK::KeyTs(b, 9));
+    EXPECT_EQ(g_allocations, before);
+
+    SAK::KeyString ks1(std::string("abc"));
+    SAK::KeyString ks2(std::string("abd"));
+    EXPECT_TRUE(ks1 < ks2);
+    EXPECT_EQ(ks1.Size(), 3u);
+}
+
+TEST(Hash, MatchesUpstreamWyhash) {
+    // The hash places keys in on-disk Bloom filters, so its values are fixed.
+    // The first vectors are upstream's own (seed = index); the rest cover the
+    // length boundaries of each code path
+    const std::pair<std::string, uint64_t> upstream[] = {
+        {"", 0x93228a4de0eec5a2ull},
+        {"a", 0xc5bac3db178713c4ull},
+        {"abc", 0xa97f2f7b1d9b3314ull},
+        {"message digest", 0x786d1f1df3801df4ull},
+        {"abcdefghijklmnopqrstuvwxyz", 0xdca5a8138ad37c87ull},
+        {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 0xb9e734f117cfaf70ull},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+         0x6cc5eab49a92d617ull},
+    };
+    for (size_t i = 0; i < sizeof(upstream) / sizeof(upstream[0]); ++i) {
+        const std::string& input = upstream[i].first;
+        EXPECT_EQ(SAK::hash::Hash64(input.data(), input.size(), i), upstream[i].second) << i;
+    }
+
+    std::string digits;
+    for (int i = 0; i < 10; ++i) {
+        digits += "1234567890";
+    }
+    struct Vector {
+        size_t size;
+        uint64_t seed;
+        uint64_t hash;
+    };
+    const Vector vectors[] = {
+        {0, 0, 0x93228a4de0eec5a2ull},   {3, 0, 0x2b6f3ea4d0ceffebull},  {16, 0, 0x01162f9042d951c0ull},
+        {17, 0, 0xfc7831f44b9e8ac9ull},  {48, 0, 0x5415d932c2a5c457ull}, {49, 0, 0x097895ffa7f342cfull},
+        {100, 0, 0x30b8eff2c1eab807ull}, {3, 1, 0xeaa315c583eaaa5cull},  {100, 1, 0x784a41922858272dull},
+    };
+    for (const Vector& v : vectors) {
+        EXPECT_EQ(SAK::hash::Hash64(digits.data(), v.size, v.seed), v.hash) << v.size << " seed " << v.seed;
+    }
+    EXPECT_EQ(SAK::hash::Hash64(nullptr, 0), 0x93228a4de0eec5a2ull);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,223 @@
+#include "util/compaction.hpp"
+#include "util/memtable.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using SAK::ByteBuffer;
+using SAK::CompactionOptions;
+using SAK::CompactionScheduler;
+using SAK::LevelState;
+using SAK::SsTable;
+using SAK::SsTableBuilder;
+
+namespace {
+
+struct Entry {
+    std::string key;
+    uint64_t ts;
+    std::string value;  // Empty for a tombstone
+};
+
+std::string KeyOf(int i) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "key%05d", i);
+    return key;
+}
+
+class CompactionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("sak_compaction_test_" + std::to_string(getpid()));
+        fs::create_directories(dir_);
+        options_.level0_file_num_compaction_trigger = 2;
+        options_.max_levels = 3;
+        options_.target_sst_size = 16 * 1024;
+        options_.block_size = 1024;
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir_);
+    }
+
+    std::pair<size_t, std::string> NewTable() {
+        size_t id = next_id_++;
+        return {id, (dir_ / (std::to_string(id) + ".sst")).string()};
+    }
+
+    // `entries` must be in KeyTs order
+    std::shared_ptr<SsTable> Build(const std::vector<Entry>& entries) {
+        SAK::Options options;
+        options.block_size = options_.block_size;
+        SsTableBuilder builder(options);
+        for (const Entry& entry : entries) {
+            builder.Add(ByteBuffer(entry.key), entry.ts, ByteBuffer(entry.value));
+        }
+        auto target = NewTable();
+        return builder.Build(target.first, target.second);
+    }
+
+    CompactionScheduler::Hooks MakeHooks() {
+        CompactionScheduler::Hooks hooks;
+        hooks.new_table = [this] { return NewTable(); };
+        hooks.watermark = [this] { return watermark_.load(); };
+        return hooks;
+    }
+
+    // Newest version at or before read_ts across the levels, like a read path would
+    static std::optional<std::string> Get(const LevelState& state, const std::string& key, uint64_t read_ts) {
+        for (const auto& level : state.levels) {
+            for (const auto& table : level) {
+                if (auto value = table->Get(ByteBuffer(key), read_ts)) {
+                    return value->Empty() ? std::nullopt : std::optional<std::string>(value->ToString());
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    fs::path dir_;
+    CompactionOptions options_;
+    std::atomic<size_t> next_id_{1};
+    std::atomic<uint64_t> watermark_{SAK::kMaxTimestamp};
+};
+
+} // namespace
+
+TEST_F(CompactionTest, ControllerPicksFromLevelSizes) {
+    SAK::SimpleLeveledController controller(options_);
+    LevelState state;
+    state.levels.resize(4);
+    EXPECT_FALSE(controller.Pick(state).has_value());
+
+    state.levels[0].push_back(Build({{"a", 1, "x"}}));
+    EXPECT_FALSE(controller.Pick(state).has_value());
+    state.levels[0].insert(state.levels[0].begin(), Build({{"b", 2, "y"}}));
+    auto task = controller.Pick(state);
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->upper_level, 0u);
+    EXPECT_EQ(task->lower_level, 1u);
+    EXPECT_EQ(task->upper.size(), 2u);
+    EXPECT_FALSE(task->bottom_level);
+
+    // L1 with an empty L2 below it is over the ratio
+    auto output = Build({{"a", 1, "x"}, {"b", 2, "y"}});
+    state.levels[0].insert(state.levels[0].begin(), Build({{"c", 3, "z"}}));
+    SAK::SimpleLeveledController::Apply(state, *task, {output});
+    ASSERT_EQ(state.levels[0].size(), 1u);  // Added after the pick
+    ASSERT_EQ(state.levels[1].size(), 1u);
+    task = controller.Pick(state);
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->upper_level, 1u);
+
+    // A large enough L2 satisfies the ratio; L2 into the bottom level is due
+    state.levels[2] = {Build({{"a", 1, "x"}})};
+    state.levels[3] = {Build({{"a", 1, "x"}})};
+    task = controller.Pick(state);
+    EXPECT_FALSE(task.has_value());
+    state.levels[3].clear();
+    task = controller.Pick(state);
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->upper_level, 2u);
+    EXPECT_TRUE(task->bottom_level);
+}
+
+TEST_F(CompactionTest, MergeIteratorOrdersAcrossTables) {
+    auto newer = Build({{"a", 5, "a5"}, {"c", 4, "c4"}, {"c", 2, "c2-new"}});
+    auto older = Build({{"a", 3, "a3"}, {"b", 1, "b1"}, {"c", 2, "c2-old"}, {"d", 1, "d1"}});
+    SAK::MergeIterator it({newer, older});
+    std::vector<std::string> seen;
+    for (; it.Valid(); it.Next()) {
+        seen.push_back(it.Key().ToString() + std::to_string(it.Timestamp()) + "=" + it.Value().ToString());
+    }
+    EXPECT_FALSE(it.Corrupted());
+    std::vector<std::string> expected = {"a5=a5", "a3=a3", "b1=b1", "c4=c4", "c2=c2-new", "c2=c2-old", "d1=d1"};
+    EXPECT_EQ(seen, expected);
+}
+
+TEST_F(CompactionTest, DropsShadowedVersionsBelowTheWatermark) {
+    SAK::thread::ThreadPool pool(2);
+    std::set<std::string> deleted;
+    std::mutex deleted_mutex;
+    auto hooks = MakeHooks();
+    hooks.obsolete = [&](const std::shared_ptr<SsTable>& table) {
+        std::lock_guard<std::mutex> lock(deleted_mutex);
+        deleted.insert(std::to_string(table->Id()));
+    };
+    watermark_ = 20;
+    {
+        CompactionScheduler scheduler(options_, pool, hooks);
+        // Round r writes every key at ts 10 * r; key 7 is deleted in round 2
+        for (uint64_t round = 1; round <= 4; ++round) {
+            std::vector<Entry> entries;
+            for (int i = 0; i < 500; ++i) {
+                std::string value = i == 7 && round == 2 ? "" : "v" + std::to_string(round) + "-" + std::to_string(i);
+                if (i == 7 && round > 2) {
+                    continue;
+                }
+                entries.push_back({KeyOf(i), round * 10, value});
+            }
+            scheduler.AddL0(Build(entries));
+        }
+        scheduler.WaitIdle();
+        EXPECT_FALSE(scheduler.BackgroundError());
+        EXPECT_GE(scheduler.CompactionsRun(), 2u);
+        EXPECT_GT(scheduler.BytesWritten(), 0u);
+
+        LevelState state = scheduler.Levels();
+        EXPECT_LT(state.levels[0].size(), options_.level0_file_num_compaction_trigger);
+        EXPECT_FALSE(state.levels[options_.max_levels].empty());
+
+        // Above the watermark every version survives
+        EXPECT_EQ(Get(state, KeyOf(3), 40), "v4-3");
+        EXPECT_EQ(Get(state, KeyOf(3), 35), "v3-3");
+        // At the watermark the visible version survives; older ones are gone
+        EXPECT_EQ(Get(state, KeyOf(3), 25), "v2-3");
+        EXPECT_EQ(Get(state, KeyOf(3), 10), std::nullopt);
+        // The tombstone at the watermark shadows round 1 and is dropped at the bottom
+        EXPECT_EQ(Get(state, KeyOf(7), 40), std::nullopt);
+        EXPECT_EQ(Get(state, KeyOf(7), 15), std::nullopt);
+
+        // Every input table left the tree and was reported
+        std::set<std::string> live;
+        for (const auto& level : state.levels) {
+            for (const auto& table : level) {
+                live.insert(std::to_string(table->Id()));
+                EXPECT_EQ(deleted.count(std::to_string(table->Id())), 0u);
+            }
+        }
+        EXPECT_EQ(deleted.size() + live.size(), next_id_ - 1);
+
+        // Bottom level tables are sorted and do not overlap
+        const auto& bottom = state.levels[options_.max_levels];
+        for (size_t i = 1; i < bottom.size(); ++i) {
+            EXPECT_LT(bottom[i - 1]->LastKey(), bottom[i]->FirstKey());
+        }
+    }
+}
+
+TEST(RateLimiter, PacesRequestsAfterTheBurst) {
+    SAK::RateLimiter unlimited(0);
+    unlimited.Request(1 << 30);
+
+    SAK::RateLimiter limiter(1024 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    limiter.Request(1024 * 1024);  // The burst
+    limiter.Request(200 * 1024);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+#include "cobject/capplication.hpp"
+#include "util/coroutine.hpp"
+#include "util/ipc_implement.hpp"
+#include "util/thread_pool.hpp"
+#include "util/timer.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+SAK::coro::task<int> add(int a, int b) {
+    co_return a + b;
+}
+
+SAK::coro::task<int> sum_chain(int depth) {
+    int total = 0;
+    for (int i = 0; i < depth; ++i) {
+        total += co_await add(i, 1);
+    }
+    co_return total;
+}
+
+SAK::coro::task<void> fail() {
+    throw std::runtime_error("coroutine failure");
+    co_return;
+}
+
+SAK::coro::task<std::thread::id> hop_to(SAK::thread::ThreadPool& pool) {
+    co_await pool.schedule();
+    co_return std::this_thread::get_id();
+}
+
+} // namespace
+
+TEST(Coroutine, TasksChainAndPropagateExceptions) {
+    EXPECT_EQ(SAK::coro::sync_wait(sum_chain(100)), 5050);
+    EXPECT_THROW(SAK::coro::sync_wait(fail()), std::runtime_error);
+}
+
+TEST(Coroutine, ScheduleResumesOnAPoolWorker) {
+    SAK::thread::ThreadPool pool(2);
+
+    std::thread::id resumed_on = SAK::coro::sync_wait(hop_to(pool));
+
+    EXPECT_NE(resumed_on, std::this_thread::get_id());
+}
+
+TEST(Coroutine, ScheduleHonoursPriority) {
+    SAK::thread::ThreadPool pool(1);
+
+    auto work = [&]() -> SAK::coro::task<int> {
+        co_await pool.schedule(SAK::thread::TaskPriority::high);
+        co_return 42;
+    };
+
+    EXPECT_EQ(SAK::coro::sync_wait(work()), 42);
+}
+
+TEST(Coroutine, SleepForResumesAfterTheDelay) {
+    auto& timer = SAK::timer::Timer::instance();
+
+    auto work = [&]() -> SAK::coro::task<std::chrono::milliseconds> {
+        auto start = std::chrono::steady_clock::now();
+        co_await timer.sleep_for(20);
+        co_return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    };
+
+    EXPECT_GE(SAK::coro::sync_wait(work()).count(), 20);
+}
+
+TEST(Coroutine, SpawnRunsDetachedTasks) {
+    SAK::thread::ThreadPool pool(2);
+    std::promise<int> done;
+
+    auto work = [&]() -> SAK::coro::task<void> {
+        co_await pool.schedule();
+        int value = co_await add(20, 22);
+        done.set_value(value);
+    };
+    SAK::coro::spawn(work());
+
+    EXPECT_EQ(done.get_future().get(), 42);
+}
+
+TEST(Coroutine, ResumeOnMainContinuesUnderExec) {
+    SAK::CApplication app;
+    SAK::thread::ThreadPool pool(1);
+    std::thread::id hopped_to;
+    std::thread::id resumed_on;
+
+    auto work = [&]() -> SAK::coro::task<void> {
+        co_await pool.schedule();
+        hopped_to = std::this_thread::get_id();
+        co_await app.resumeOnMain();
+        resumed_on = std::this_thread::get_id();
+        app.quit();
+    };
+    SAK::coro::spawn(work());
+    app.exec();
+
+    EXPECT_NE(hopped_to, std::this_thread::get_id());
+    EXPECT_EQ(resumed_on, std::this_thread::get_id());
+}
+
+TEST(Coroutine, ReceiveAwaitsTheNextMessage) {
+    std::string name = "coro_ipc_" + std::to_string(getpid());
+    SAK::ipc::IPCImplement server(name, true);
+    server.start();
+    SAK::ipc::IPCImplement client(name, false);
+    client.start();
+
+    auto work = [&]() -> SAK::coro::task<std::optional<std::string>> {
+        co_return co_await server.receive();
+    };
+
+    std::thread sender([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        client.sendMessage("hello");
+    });
+    std::optional<std::string> message = SAK::coro::sync_wait(work());
+    sender.join();
+
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(*message, "hello");
+
+    client.stop();
+    server.stop();
+}
+
+TEST(Coroutine, ReceiveYieldsNulloptWhenStopped) {
+    std::string name = "coro_ipc_stop_" + std::to_string(getpid());
+    SAK::ipc::IPCImplement server(name, true);
+    server.start();
+
+    auto work = [&]() -> SAK::coro::task<std::optional<std::string>> {
+        co_return co_await server.receive();
+    };
+
+    std::thread stopper([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        server.stop();
+    });
+    std::optional<std::string> message = SAK::coro::sync_wait(work());
+    stopper.join();
+
+    EXPECT_FALSE(message.has_value());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+#include "crc32c.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+uint32_t ReferenceCrc32c(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc >> 1) ^ (0x82F63B78 & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+std::vector<uint8_t> RandomBytes(size_t length, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(length);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(Crc32c, MatchesStandardTestVectors) {
+    const char* digits = "123456789";
+    EXPECT_EQ(SAK::Crc32c::Compute(digits, std::strlen(digits)), 0xE3069283u);
+
+    std::vector<uint8_t> zeros(32, 0x00);
+    EXPECT_EQ(SAK::Crc32c::Compute(zeros), 0x8A9136AAu);
+
+    std::vector<uint8_t> ones(32, 0xFF);
+    EXPECT_EQ(SAK::Crc32c::Compute(ones), 0x62A8AB43u);
+
+    std::vector<uint8_t> ascending(32);
+    for (size_t i = 0; i < ascending.size(); ++i) {
+        ascending[i] = static_cast<uint8_t>(i);
+    }
+    EXPECT_EQ(SAK::Crc32c::Compute(ascending), 0x46DD794Eu);
+
+    EXPECT_EQ(SAK::Crc32c::Compute(nullptr, 0), 0u);
+}
+
+TEST(Crc32c, MatchesReferenceAcrossLengthsAndAlignments) {
+    // Large enough to exercise both interleaved block sizes plus the tails
+    auto data = RandomBytes(3 * 8192 * 2 + 3 * 256 + 37, 42);
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t length : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(63), size_t(767),
+                              size_t(768), size_t(1000), size_t(3 * 8192), size_t(3 * 8192 + 3 * 256 + 5),
+                              data.size() - offset}) {
+            if (offset + length > data.size()) {
+                continue;
+            }
+            EXPECT_EQ(SAK::Crc32c::Compute(data.data() + offset, length),
+                      ReferenceCrc32c(data.data() + offset, length))
+                << "offset=" << offset << " length=" << length;
+        }
+    }
+}
+
+TEST(Crc32c, ExtendEqualsComputeOverConcatenation) {
+    auto data = RandomBytes(3 * 8192 + 1234, 7);
+    const uint32_t expected = SAK::Crc32c::Compute(data);
+
+    EXPECT_EQ(SAK::Crc32c::Extend(0, data.data(), data.size()), expected);
+
+    for (size_t split : {size_t(0), size_t(1), size_t(5), size_t(255), size_t(4096), size_t(8192 * 3),
+                         data.size()}) {
+        uint32_t crc = SAK::Crc32c::Compute(data.data(), split);
+        crc = SAK::Crc32c::Extend(crc, data.data() + split, data.size() - split);
+        EXPECT_EQ(crc, expected) << "split=" << split;
+    }
+
+    // Scatter/gather over many small pieces
+    uint32_t crc = 0;
+    size_t pos = 0;
+    for (size_t piece = 1; pos < data.size(); piece = piece * 3 % 997 + 1) {
+        size_t take = std::min(piece, data.size() - pos);
+        crc = SAK::Crc32c::Extend(crc, data.data() + pos, take);
+        pos += take;
+    }
+    EXPECT_EQ(crc, expected);
+}
+
+TEST(Crc32c, CombineJoinsIndependentChecksums) {
+    auto data = RandomBytes(5 * 4096 + 77, 11);
+    const uint32_t expected = SAK::Crc32c::Compute(data);
+
+    for (size_t split : {size_t(0), size_t(1), size_t(4096), size_t(3 * 4096 + 5), data.size() - 1, data.size()}) {
+        uint32_t first = SAK::Crc32c::Compute(data.data(), split);
+        uint32_t second = SAK::Crc32c::Compute(data.data() + split, data.size() - split);
+        EXPECT_EQ(SAK::Crc32c::Combine(first, second, data.size() - split), expected) << "split=" << split;
+    }
+
+    // Folding equal blocks left to right, as a block writer does
+    uint32_t crc = 0;
+    for (size_t pos = 0; pos < data.size(); pos += 4096) {
+        size_t take = std::min<size_t>(4096, data.size() - pos);
+        crc = SAK::Crc32c::Combine(crc, SAK::Crc32c::Compute(data.data() + pos, take), take);
+    }
+    EXPECT_EQ(crc, expected);
+}
+
+TEST(Crc32c, ConcurrentFirstUseIsConsistent) {
+    auto data = RandomBytes(4096, 99);
+    const uint32_t expected = ReferenceCrc32c(data.data(), data.size());
+
+    std::vector<std::thread> threads;
+    std::vector<uint32_t> results(8, 0);
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i]() { results[i] = SAK::Crc32c::Compute(data); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (uint32_t result : results) {
+        EXPECT_EQ(result, expected);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,208 @@
+#include "util/epoch.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using SAK::epoch_domain;
+using SAK::epoch_guard;
+
+namespace {
+
+struct Tracked {
+    explicit Tracked(std::atomic<int>* live, int value) : live(live), value(value) { ++*live; }
+    ~Tracked() {
+        value = -1;
+        --*live;
+    }
+    std::atomic<int>* live;
+    int value;
+};
+
+} // namespace
+
+TEST(EpochDomain, PinnedReaderHoldsBackReclamation) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    Tracked* object = new Tracked(&live, 7);
+    {
+        epoch_guard guard = domain.pin();
+        domain.retire(object);
+        for (int i = 0; i < 10; ++i) {
+            domain.collect();
+        }
+        // Still reachable by the pinned reader
+        EXPECT_EQ(object->value, 7);
+        EXPECT_EQ(live.load(), 1);
+        EXPECT_EQ(domain.pending(), 1u);
+    }
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(live.load(), 0);
+    EXPECT_EQ(domain.pending(), 0u);
+}
+
+TEST(EpochDomain, GuardsNestAndMove) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    epoch_guard outer = domain.pin();
+    epoch_guard moved;
+    {
+        epoch_guard inner = domain.pin();
+        moved = std::move(inner);
+    }
+    domain.retire(new Tracked(&live, 1));
+    outer.release();
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(live.load(), 1);
+    moved.release();
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(EpochDomain, ReadersNeverSeeFreedObjects) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    std::atomic<Tracked*> shared{new Tracked(&live, 0)};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> corrupt{false};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                epoch_guard guard = domain.pin();
+                Tracked* current = shared.load(std::memory_order_acquire);
+                if (current->value < 0) {
+                    corrupt = true;
+                }
+            }
+        });
+    }
+    // Retire until something gets freed under the readers' feet; on a
+    // loaded machine a preempted reader can hold the epoch back for a while
+    std::size_t retired = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (retired < 20000 || (domain.pending() == retired && std::chrono::steady_clock::now() < deadline)) {
+        Tracked* old = shared.exchange(new Tracked(&live, static_cast<int>(++retired)), std::memory_order_acq_rel);
+        domain.retire(old);
+        if (retired % 1024 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    // Reclamation kept up while readers ran
+    EXPECT_LT(domain.pending(), retired);
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_FALSE(corrupt.load());
+
+    delete shared.load();
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(EpochDomain, NestedGuardsShareTheThreadsSlot) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    std::vector<epoch_guard> guards;
+    for (size_t i = 0; i < epoch_domain::SLOTS * 4; ++i) {
+        guards.push_back(domain.pin());
+    }
+    // Slots are left for everyone else
+    std::thread other([&]() { epoch_guard guard = domain.pin(); });
+    other.join();
+
+    domain.retire(new Tracked(&live, 1));
+    guards.resize(1);
+    domain.collect();
+    domain.collect();
+    // The last guard of the shared pin still protects
+    EXPECT_EQ(live.load(), 1);
+    guards.clear();
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(live.load(), 0);
+}
+
+TEST(EpochDomain, MoreThreadsThanSlotsStillPin) {
+    epoch_domain domain;
+    std::atomic<size_t> pinned{0};
+    std::atomic<bool> leave{false};
+    std::vector<std::thread> holders;
+    for (size_t i = 0; i < epoch_domain::SLOTS; ++i) {
+        holders.emplace_back([&]() {
+            epoch_guard guard = domain.pin();
+            ++pinned;
+            while (!leave.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    while (pinned.load() < epoch_domain::SLOTS) {
+        std::this_thread::yield();
+    }
+    std::atomic<bool> late_pinned{false};
+    std::thread late([&]() {
+        // Every slot is taken now; this one waits for a release
+        epoch_guard guard = domain.pin();
+        late_pinned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(late_pinned.load());
+    leave = true;
+    late.join();
+    EXPECT_TRUE(late_pinned.load());
+    for (auto& holder : holders) {
+        holder.join();
+    }
+}
+
+TEST(EpochDomain, SynchronizeWaitsForEarlierReaders) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> done{false};
+    std::thread reader([&]() {
+        epoch_guard guard = domain.pin();
+        pinned = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        done = true;
+    });
+    while (!pinned) {
+        std::this_thread::yield();
+    }
+
+    // The context variant passes its owner along
+    domain.retire(new Tracked(&live, 1), [](void* object, void* context) {
+        ++*static_cast<int*>(context);
+        delete static_cast<Tracked*>(object);
+    }, &live);
+    domain.synchronize();
+    EXPECT_TRUE(done.load());
+    // Freed (-1) and counted by the deleter (+1)
+    EXPECT_EQ(live.load(), 1);
+    EXPECT_EQ(domain.pending(), 0u);
+    reader.join();
+}
+
+TEST(EpochDomain, PurgeIgnoresPinnedReaders) {
+    std::atomic<int> live{0};
+    epoch_domain domain;
+    epoch_guard guard = domain.pin();
+    domain.retire(new Tracked(&live, 1));
+    domain.retire(new Tracked(&live, 2));
+    domain.purge();
+    EXPECT_EQ(live.load(), 0);
+    EXPECT_EQ(domain.pending(), 0u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,592 @@
+#include "util/ipc_implement.hpp"
+#include "util/ipc_packet.hpp"
+#include "util/ipc_shared_memory.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+
+using SAK::ipc::IPCPacket;
+using SAK::ipc::IPCSharedMemory;
+using SAK::ipc::IPCTransport;
+using SAK::ipc::MessageType;
+
+namespace {
+
+std::string channel_name(const char* test) {
+    return std::string("shm_") + test + "_" + std::to_string(getpid());
+}
+
+IPCPacket make_packet(uint32_t seq, const std::string& payload) {
+    return IPCPacket(MessageType::MSG_REQUEST, seq, payload.data(), static_cast<uint32_t>(payload.size()));
+}
+
+std::string payload_of(const IPCPacket& packet) {
+    return std::string(reinterpret_cast<const char*>(packet.GetPayload()), packet.GetPayloadLength());
+}
+
+} // namespace
+
+TEST(IPCPacket, SmallPayloadsAreInlineAndMovesKeepThem) {
+    IPCPacket small = make_packet(1, std::string(SAK::ipc::IPC_INLINE_PAYLOAD, 's'));
+    EXPECT_TRUE(small.IsInline());
+    IPCPacket large = make_packet(2, std::string(SAK::ipc::IPC_INLINE_PAYLOAD + 1, 'l'));
+    EXPECT_FALSE(large.IsInline());
+
+    const uint8_t* pooled = large.GetPayload();
+    IPCPacket moved_large = std::move(large);
+    EXPECT_EQ(moved_large.GetPayload(), pooled);
+    EXPECT_EQ(large.GetPayloadLength(), 0u);
+
+    IPCPacket moved_small(std::move(small));
+    EXPECT_TRUE(moved_small.IsInline());
+    EXPECT_EQ(payload_of(moved_small), std::string(SAK::ipc::IPC_INLINE_PAYLOAD, 's'));
+
+    IPCPacket copy;
+    copy = moved_large;
+    EXPECT_NE(copy.GetPayload(), moved_large.GetPayload());
+    EXPECT_EQ(payload_of(copy), payload_of(moved_large));
+    copy = moved_small;
+    EXPECT_TRUE(copy.IsInline());
+    EXPECT_EQ(payload_of(copy), payload_of(moved_small));
+}
+
+TEST(IPCPacket, ChecksumIsVerifiedWhenParsed) {
+    for (size_t size : {16, 4096}) {
+        std::string wire = make_packet(3, std::string(size, 'c')).Serialize();
+        IPCPacket parsed(wire.data(), static_cast<uint32_t>(wire.size()));
+        EXPECT_TRUE(parsed.IsValid());
+        EXPECT_FALSE(parsed.IsUnchecked());
+        EXPECT_EQ(parsed.Serialize(), wire);
+
+        wire[sizeof(SAK::ipc::PacketHeader) + size / 2] ^= 1;
+        EXPECT_FALSE(IPCPacket(wire.data(), static_cast<uint32_t>(wire.size())).IsValid());
+    }
+
+    // Without a checksum only a reader that does not require one accepts it
+    IPCPacket packet = make_packet(4, "trusted");
+    std::string wire(packet.GetTotalSize(), '\0');
+    ASSERT_TRUE(packet.Serialize(&wire[0], static_cast<uint32_t>(wire.size()), false));
+    wire[sizeof(SAK::ipc::PacketHeader)] ^= 1;
+    IPCPacket unchecked(wire.data(), static_cast<uint32_t>(wire.size()));
+    EXPECT_TRUE(unchecked.IsUnchecked());
+    EXPECT_FALSE(unchecked.IsValid());
+    EXPECT_TRUE(unchecked.IsValid(false));
+}
+
+TEST(IPCSharedMemoryRing, ReadersDecideWhetherChecksumsAreRequired) {
+    for (IPCTransport transport : {IPCTransport::spsc_ring, IPCTransport::semaphore}) {
+        bool ring = transport == IPCTransport::spsc_ring;
+        SAK::ipc::IPCSharedMemoryOptions options;
+        options.transport = transport;
+
+        // A checking reader rejects what an unchecked writer sends
+        {
+            std::string name = channel_name(ring ? "strict_ring" : "strict_sem");
+            options.checksums = false;
+            IPCSharedMemory server(name, true, options);
+            ASSERT_TRUE(server.Init());
+            options.checksums = true;
+            IPCSharedMemory client(name, false, options);
+            ASSERT_TRUE(client.Init());
+
+            ASSERT_TRUE(server.WritePacket(make_packet(5, std::string(1000, 'u'))));
+            IPCPacket received;
+            EXPECT_FALSE(client.ReadPacket(&received));
+
+            if (ring) {
+                uint8_t* dest = server.ReserveWrite(5);
+                ASSERT_NE(dest, nullptr);
+                std::memcpy(dest, "fast!", 5);
+                ASSERT_TRUE(server.CommitWrite(MessageType::MSG_REQUEST, 6, 5));
+                SAK::ipc::PacketView view;
+                EXPECT_FALSE(client.PeekRead(&view));
+            }
+        }
+
+        // Both sides trusting each other skip the CRC
+        {
+            std::string name = channel_name(ring ? "trusted_ring" : "trusted_sem");
+            options.checksums = false;
+            IPCSharedMemory server(name, true, options);
+            ASSERT_TRUE(server.Init());
+            IPCSharedMemory client(name, false, options);
+            ASSERT_TRUE(client.Init());
+
+            ASSERT_TRUE(server.WritePacket(make_packet(5, std::string(1000, 'u'))));
+            IPCPacket received;
+            ASSERT_TRUE(client.ReadPacket(&received));
+            EXPECT_TRUE(received.IsUnchecked());
+            EXPECT_EQ(payload_of(received), std::string(1000, 'u'));
+
+            if (ring) {
+                uint8_t* dest = server.ReserveWrite(5);
+                ASSERT_NE(dest, nullptr);
+                std::memcpy(dest, "fast!", 5);
+                ASSERT_TRUE(server.CommitWrite(MessageType::MSG_REQUEST, 6, 5));
+                SAK::ipc::PacketView view;
+                ASSERT_TRUE(client.PeekRead(&view));
+                EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.payload), view.payload_len), "fast!");
+                client.ReleaseRead();
+            }
+        }
+    }
+}
+
+TEST(IPCSharedMemoryRing, PacketsSurviveManyWrapArounds) {
+    std::string name = channel_name("wrap");
+    IPCSharedMemory server(name, true, IPCTransport::spsc_ring);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, IPCTransport::spsc_ring);
+    ASSERT_TRUE(client.Init());
+
+    // Odd sizes so records land on every alignment and padding case
+    std::string chunk(12345, 'x');
+    for (uint32_t seq = 0; seq < 1000; ++seq) {
+        chunk[seq % chunk.size()] = static_cast<char>('a' + seq % 26);
+        std::string payload = chunk.substr(0, 1000 + seq * 37 % 11000);
+        ASSERT_TRUE(client.WritePacket(make_packet(seq, payload)));
+        IPCPacket received;
+        ASSERT_TRUE(server.ReadPacket(&received));
+        EXPECT_EQ(received.GetSequenceNumber(), seq);
+        EXPECT_EQ(payload_of(received), payload);
+    }
+    IPCPacket none;
+    EXPECT_FALSE(server.ReadPacket(&none));
+}
+
+TEST(IPCSharedMemoryRing, FullRingRejectsWritesUntilDrained) {
+    std::string name = channel_name("full");
+    IPCSharedMemory server(name, true, IPCTransport::spsc_ring);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, IPCTransport::spsc_ring);
+    ASSERT_TRUE(client.Init());
+
+    std::string payload(100 * 1024, 'p');
+    int written = 0;
+    while (server.WritePacket(make_packet(written, payload))) {
+        ++written;
+    }
+    EXPECT_EQ(written, static_cast<int>(SAK::ipc::SHM_BUFFER_SIZE / (payload.size() + 64)));
+
+    IPCPacket received;
+    ASSERT_TRUE(client.ReadPacket(&received));
+    EXPECT_EQ(received.GetSequenceNumber(), 0u);
+    EXPECT_TRUE(server.WritePacket(make_packet(written, payload)));
+    for (int seq = 1; seq <= written; ++seq) {
+        ASSERT_TRUE(client.ReadPacket(&received));
+        EXPECT_EQ(received.GetSequenceNumber(), static_cast<uint32_t>(seq));
+    }
+    EXPECT_FALSE(client.ReadPacket(&received));
+}
+
+TEST(IPCSharedMemoryRing, ParkedReaderWakesOnWriteAndOnRequest) {
+    std::string name = channel_name("park");
+    IPCSharedMemory server(name, true, IPCTransport::spsc_ring);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, IPCTransport::spsc_ring);
+    ASSERT_TRUE(client.Init());
+
+    std::atomic<bool> got_data{false};
+    auto start = std::chrono::steady_clock::now();
+    std::thread reader([&] { got_data = server.WaitForData(5000); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(client.WritePacket(make_packet(1, "wake up")));
+    reader.join();
+    EXPECT_TRUE(got_data.load());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    IPCPacket received;
+    ASSERT_TRUE(server.ReadPacket(&received));
+    EXPECT_EQ(payload_of(received), "wake up");
+
+    // Nothing to read: WakeReader() still releases the waiter
+    start = std::chrono::steady_clock::now();
+    std::thread idle([&] { got_data = server.WaitForData(5000); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server.WakeReader();
+    idle.join();
+    EXPECT_FALSE(got_data.load());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+}
+
+TEST(IPCSharedMemoryRing, ClientWithOtherTransportIsRejected) {
+    std::string name = channel_name("mismatch");
+    IPCSharedMemory server(name, true, IPCTransport::spsc_ring);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, IPCTransport::semaphore);
+    EXPECT_FALSE(client.Init());
+    EXPECT_FALSE(client.IsInitialized());
+}
+
+TEST(IPCSharedMemoryRing, ReservedWritesAndPeekedReadsStayInPlace) {
+    std::string name = channel_name("zerocopy");
+    IPCSharedMemory server(name, true, IPCTransport::spsc_ring);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, IPCTransport::spsc_ring);
+    ASSERT_TRUE(client.Init());
+
+    // 64KB frames, enough of them to wrap the ring several times
+    const uint32_t frame = 64 * 1024;
+    for (uint32_t seq = 0; seq < 100; ++seq) {
+        uint8_t* dest = client.ReserveWrite(frame);
+        ASSERT_NE(dest, nullptr);
+        EXPECT_EQ(client.WritePacket(make_packet(0, "blocked")), false);
+        uint32_t used = frame - seq;
+        std::memset(dest, static_cast<int>(seq), used);
+        ASSERT_TRUE(client.CommitWrite(MessageType::MSG_RESPONSE, seq, used));
+
+        SAK::ipc::PacketView view;
+        ASSERT_TRUE(server.PeekRead(&view));
+        EXPECT_EQ(view.header->seq_num, seq);
+        EXPECT_EQ(view.header->msg_type, static_cast<uint8_t>(MessageType::MSG_RESPONSE));
+        ASSERT_EQ(view.payload_len, used);
+        EXPECT_EQ(view.payload[0], static_cast<uint8_t>(seq));
+        EXPECT_EQ(view.payload[used - 1], static_cast<uint8_t>(seq));
+        // Held until released
+        IPCPacket copy;
+        EXPECT_FALSE(server.ReadPacket(&copy));
+        server.ReleaseRead();
+    }
+
+    // Both APIs share the wire format
+    uint8_t* dest = server.ReserveWrite(5);
+    ASSERT_NE(dest, nullptr);
+    std::memcpy(dest, "hello", 5);
+    ASSERT_TRUE(server.CommitWrite(MessageType::MSG_REQUEST, 7, 5));
+    IPCPacket received;
+    ASSERT_TRUE(client.ReadPacket(&received));
+    EXPECT_EQ(payload_of(received), "hello");
+    EXPECT_EQ(received.GetSequenceNumber(), 7u);
+
+    ASSERT_TRUE(server.WritePacket(make_packet(8, "world")));
+    SAK::ipc::PacketView view;
+    ASSERT_TRUE(client.PeekRead(&view));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.payload), view.payload_len), "world");
+    client.ReleaseRead();
+
+    // A cancelled reservation is never seen
+    ASSERT_NE(server.ReserveWrite(100), nullptr);
+    server.CancelWrite();
+    EXPECT_FALSE(client.PeekRead(&view));
+}
+
+TEST(IPCSharedMemoryRing, ChannelsCarryIndependentProducers) {
+    std::string name = channel_name("channels");
+    SAK::ipc::IPCSharedMemoryOptions options;
+    options.transport = IPCTransport::spsc_ring;
+    options.ring_size = 64 * 1024;
+    options.channels = 4;
+    IPCSharedMemory server(name, true, options);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, options);
+    ASSERT_TRUE(client.Init());
+    EXPECT_EQ(client.GetChannelCount(), 4u);
+
+    const uint32_t per_channel = 2000;
+    std::vector<std::thread> producers;
+    for (uint32_t channel = 0; channel < options.channels; ++channel) {
+        producers.emplace_back([&client, channel] {
+            for (uint32_t seq = 0; seq < per_channel;) {
+                std::string payload = std::to_string(channel) + ":" + std::to_string(seq);
+                if (client.WritePacket(make_packet(seq, payload), channel)) {
+                    ++seq;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Each channel preserves its own order
+    std::vector<uint32_t> next(options.channels, 0);
+    uint32_t total = 0;
+    while (total < per_channel * options.channels) {
+        bool any = false;
+        for (uint32_t channel = 0; channel < options.channels; ++channel) {
+            IPCPacket received;
+            while (server.ReadPacket(&received, channel)) {
+                any = true;
+                ASSERT_EQ(received.GetSequenceNumber(), next[channel]);
+                EXPECT_EQ(payload_of(received), std::to_string(channel) + ":" + std::to_string(next[channel]));
+                ++next[channel];
+                ++total;
+            }
+        }
+        if (!any) {
+            server.WaitForData(100);
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    IPCPacket none;
+    EXPECT_FALSE(server.WritePacket(none, 4));
+}
+
+TEST(IPCSharedMemoryRing, RingSizeIsConfigurable) {
+    std::string name = channel_name("size");
+    SAK::ipc::IPCSharedMemoryOptions options;
+    options.transport = IPCTransport::spsc_ring;
+    options.ring_size = 8 * 1024 * 1024;
+    options.huge_pages = true;  // Falls back to normal pages without hugetlbfs
+    IPCSharedMemory server(name, true, options);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false, options);
+    ASSERT_TRUE(client.Init());
+
+    std::string payload(1024 * 1024, 'b');
+    int written = 0;
+    while (server.WritePacket(make_packet(written, payload))) {
+        ++written;
+    }
+    EXPECT_EQ(written, 7);
+    IPCPacket received;
+    for (int seq = 0; seq < written; ++seq) {
+        ASSERT_TRUE(client.ReadPacket(&received));
+        EXPECT_EQ(received.GetPayloadLength(), payload.size());
+    }
+}
+
+TEST(IPCSharedMemoryRing, MismatchedOrInvalidLayoutsAreRejected) {
+    std::string name = channel_name("layout");
+    SAK::ipc::IPCSharedMemoryOptions options;
+    options.transport = IPCTransport::spsc_ring;
+    options.channels = 2;
+    IPCSharedMemory server(name, true, options);
+    ASSERT_TRUE(server.Init());
+
+    SAK::ipc::IPCSharedMemoryOptions other = options;
+    other.channels = 1;
+    IPCSharedMemory client(name, false, other);
+    EXPECT_FALSE(client.Init());
+
+    SAK::ipc::IPCSharedMemoryOptions odd_size = options;
+    odd_size.ring_size = 100000;
+    EXPECT_FALSE(IPCSharedMemory(channel_name("odd"), true, odd_size).Init());
+
+    SAK::ipc::IPCSharedMemoryOptions semaphores;
+    semaphores.channels = 2;
+    EXPECT_FALSE(IPCSharedMemory(channel_name("semchannels"), true, semaphores).Init());
+}
+
+TEST(IPCSharedMemorySemaphore, RoundTripStillWorks) {
+    std::string name = channel_name("sem");
+    IPCSharedMemory server(name, true);
+    ASSERT_TRUE(server.Init());
+    IPCSharedMemory client(name, false);
+    ASSERT_TRUE(client.Init());
+    EXPECT_EQ(client.GetTransport(), IPCTransport::semaphore);
+
+    ASSERT_TRUE(server.WritePacket(make_packet(9, "hello")));
+    EXPECT_TRUE(client.WaitForData(100));
+    IPCPacket received;
+    ASSERT_TRUE(client.ReadPacket(&received));
+    EXPECT_EQ(payload_of(received), "hello");
+
+    // Zero-copy access needs the ring layout
+    EXPECT_EQ(server.ReserveWrite(16), nullptr);
+    SAK::ipc::PacketView view;
+    EXPECT_FALSE(client.PeekRead(&view));
+}
+
+namespace {
+
+// Stand-in for the event loop: wait for either descriptor, then pump both
+void pump(SAK::ipc::IPCImplement& a, SAK::ipc::IPCImplement& b, int timeout_ms) {
+    struct pollfd fds[2] = {{a.notificationFd(), POLLIN, 0}, {b.notificationFd(), POLLIN, 0}};
+    poll(fds, 2, timeout_ms);
+    a.processEvents();
+    b.processEvents();
+}
+
+} // namespace
+
+TEST(IPCImplementEventDriven, MessagesArriveThroughTheNotifier) {
+    for (IPCTransport transport : {IPCTransport::spsc_ring, IPCTransport::semaphore}) {
+        std::string name = channel_name(transport == IPCTransport::spsc_ring ? "event_ring" : "event_sem");
+        SAK::ipc::IPCImplement server(name, true);
+        SAK::ipc::IPCImplement client(name, false);
+        std::vector<std::string> received;
+        server.setTransport(transport);
+        server.setEventDriven(true);
+        server.setMessageHandler([&](std::string_view message) { received.emplace_back(message); });
+        client.setTransport(transport);
+        client.setEventDriven(true);
+        server.start();
+        client.start();
+        ASSERT_GE(server.notificationFd(), 0);
+        ASSERT_GE(client.notificationFd(), 0);
+
+        // Nothing pending: the descriptor stays quiet
+        struct pollfd idle = {server.notificationFd(), POLLIN, 0};
+        EXPECT_EQ(poll(&idle, 1, 0), 0);
+
+        for (int i = 0; i < 50; ++i) {
+            ASSERT_TRUE(client.sendMessage("message " + std::to_string(i)));
+        }
+        for (int round = 0; round < 100 && received.size() < 50; ++round) {
+            pump(server, client, 100);
+        }
+        ASSERT_EQ(received.size(), 50u);
+        for (int i = 0; i < 50; ++i) {
+            EXPECT_EQ(received[i], "message " + std::to_string(i));
+        }
+        client.stop();
+        server.stop();
+        EXPECT_EQ(server.notificationFd(), -1);
+    }
+}
+
+TEST(IPCImplementEventDriven, SendsQueuedOnAFullRingResumeWhenTheReaderCatchesUp) {
+    std::string name = channel_name("event_full");
+    SAK::ipc::IPCSharedMemoryOptions options;
+    options.transport = IPCTransport::spsc_ring;
+    options.ring_size = SAK::ipc::SHM_MIN_RING_SIZE;
+    SAK::ipc::IPCImplement server(name, true);
+    SAK::ipc::IPCImplement client(name, false);
+    size_t received = 0;
+    bool ordered = true;
+    server.setSharedMemoryOptions(options);
+    server.setEventDriven(true);
+    server.setMessageHandler([&](std::string_view message) {
+        ordered = ordered && message == std::string(1000, static_cast<char>('a' + received % 26));
+        ++received;
+    });
+    client.setSharedMemoryOptions(options);
+    client.setEventDriven(true);
+    server.start();
+    client.start();
+
+    // Far more than the 4KB ring holds
+    for (size_t i = 0; i < 200; ++i) {
+        ASSERT_TRUE(client.sendMessage(std::string(1000, static_cast<char>('a' + i % 26))));
+    }
+    for (int round = 0; round < 2000 && received < 200; ++round) {
+        pump(server, client, 100);
+    }
+    EXPECT_EQ(received, 200u);
+    EXPECT_TRUE(ordered);
+    client.stop();
+    server.stop();
+}
+
+TEST(IPCImplementBatching, BatchesArriveWholeAndInOrder) {
+    std::string name = channel_name("batch");
+    SAK::ipc::IPCImplement server(name, true);
+    SAK::ipc::IPCImplement client(name, false);
+    server.setTransport(IPCTransport::spsc_ring);
+    client.setTransport(IPCTransport::spsc_ring);
+    server.start();
+    client.start();
+
+    std::vector<std::string> batch;
+    for (int i = 0; i < 500; ++i) {
+        batch.push_back("batched " + std::to_string(i));
+    }
+    // An empty message inside a batch is still a message
+    batch[7].clear();
+    ASSERT_TRUE(client.sendBatch(batch));
+    ASSERT_TRUE(client.sendMessage("after"));
+
+    std::vector<std::string> received;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::string message;
+    while (received.size() < batch.size() + 1 && std::chrono::steady_clock::now() < deadline) {
+        if (server.receiveMessage(message)) {
+            received.push_back(message);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ASSERT_EQ(received.size(), batch.size() + 1);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(received[i], batch[i]);
+    }
+    EXPECT_EQ(received.back(), "after");
+    client.stop();
+    server.stop();
+}
+
+TEST(IPCImplementBatching, LargeBatchesAreSplitToFitTheRing) {
+    std::string name = channel_name("batch_split");
+    SAK::ipc::IPCSharedMemoryOptions options;
+    options.transport = IPCTransport::spsc_ring;
+    options.ring_size = SAK::ipc::SHM_MIN_RING_SIZE;
+    SAK::ipc::IPCImplement server(name, true);
+    SAK::ipc::IPCImplement client(name, false);
+    std::vector<std::string> received;
+    server.setSharedMemoryOptions(options);
+    server.setEventDriven(true);
+    server.setMessageHandler([&](std::string_view message) { received.emplace_back(message); });
+    client.setSharedMemoryOptions(options);
+    client.setEventDriven(true);
+    server.start();
+    client.start();
+
+    // About 20KB through a 4KB ring
+    std::vector<std::string> batch;
+    for (int i = 0; i < 200; ++i) {
+        batch.push_back(std::string(100, static_cast<char>('a' + i % 26)));
+    }
+    ASSERT_TRUE(client.sendBatch(batch));
+    for (int round = 0; round < 2000 && received.size() < batch.size(); ++round) {
+        pump(server, client, 100);
+    }
+    EXPECT_EQ(received, batch);
+    client.stop();
+    server.stop();
+}
+
+TEST(IPCImplementBatching, CoalescedMessagesKeepTheirOrder) {
+    for (bool event_driven : {false, true}) {
+        std::string name = channel_name(event_driven ? "coalesce_event" : "coalesce_thread");
+        SAK::ipc::IPCImplement server(name, true);
+        SAK::ipc::IPCImplement client(name, false);
+        std::atomic<size_t> count{0};
+        std::vector<std::string> received;
+        server.setTransport(IPCTransport::spsc_ring);
+        server.setEventDriven(event_driven);
+        server.setMessageHandler([&](std::string_view message) {
+            received.emplace_back(message);
+            ++count;
+        });
+        client.setTransport(IPCTransport::spsc_ring);
+        client.setEventDriven(event_driven);
+        client.setCoalescing(std::chrono::milliseconds(2), 1024);
+        server.start();
+        client.start();
+
+        for (int i = 0; i < 1000; ++i) {
+            ASSERT_TRUE(client.sendMessage("small " + std::to_string(i)));
+        }
+        // The tail is shorter than max_bytes: it leaves on the delay or on flush()
+        if (event_driven) {
+            client.flush();
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (count.load() < 1000 && std::chrono::steady_clock::now() < deadline) {
+            if (event_driven) {
+                pump(server, client, 100);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        client.stop();
+        server.stop();
+        ASSERT_EQ(received.size(), 1000u);
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_EQ(received[i], "small " + std::to_string(i));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,332 @@
+#include "util/logger.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using SAK::log::Level;
+using SAK::log::LogConfig;
+using SAK::log::Logger;
+
+namespace {
+
+class LoggerBufferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("sak_logger_test_" + std::to_string(getpid()));
+        fs::remove_all(dir_);
+    }
+
+    void TearDown() override {
+        LogConfig quiet;
+        quiet.use_stdout = true;
+        quiet.async_mode = false;
+        quiet.min_level = Level::LOG_ERROR;
+        Logger::instance().configure(quiet);
+        fs::remove_all(dir_);
+    }
+
+    LogConfig buffered_config() const {
+        LogConfig config;
+        config.log_dir = dir_.string();
+        config.async_mode = true;
+        config.thread_buffers = true;
+        config.thread_buffer_records = 64;
+        return config;
+    }
+
+    std::vector<std::string> read_lines() const {
+        std::vector<std::string> lines;
+        for (const auto& entry : fs::directory_iterator(dir_)) {
+            std::ifstream in(entry.path());
+            for (std::string line; std::getline(in, line);) {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    fs::path dir_;
+};
+
+} // namespace
+
+TEST_F(LoggerBufferTest, WritesFormattedLinesFromThreadBuffers) {
+    Logger::instance().configure(buffered_config());
+
+    LOG_INFO("hello %d %s", 42, "world");
+    LOG_ERROR("second");
+    Logger::instance().flush();
+
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("[INFO] [" + std::to_string(getpid()) + "] "), std::string::npos);
+    EXPECT_NE(lines[0].find("test_logger.cpp:TestBody:"), std::string::npos);
+    EXPECT_EQ(lines[0].substr(lines[0].size() - 14), "hello 42 world");
+    EXPECT_EQ(lines[0][0], '[');
+    EXPECT_EQ(lines[0][15], ']');
+    EXPECT_NE(lines[1].find("[ERROR] "), std::string::npos);
+}
+
+TEST_F(LoggerBufferTest, ManyThreadsLoseNothingAndStayOrderedPerThread) {
+    Logger::instance().configure(buffered_config());
+
+    constexpr int kThreads = 4;
+    constexpr int kLines = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < kLines; ++i) {
+                LOG_DEBUG("thread=%d seq=%d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Logger::instance().flush();
+
+    std::map<int, int> next;
+    bool ordered = true;
+    size_t count = 0;
+    for (const std::string& line : read_lines()) {
+        auto pos = line.find("thread=");
+        if (pos == std::string::npos) continue;
+        int thread = 0;
+        int seq = 0;
+        std::sscanf(line.c_str() + pos, "thread=%d seq=%d", &thread, &seq);
+        ordered = ordered && seq == next[thread];
+        next[thread] = seq + 1;
+        ++count;
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(count, static_cast<size_t>(kThreads * kLines));
+    EXPECT_EQ(Logger::instance().dropped_count(), 0u);
+}
+
+TEST_F(LoggerBufferTest, LongMessagesAreTruncated) {
+    Logger::instance().configure(buffered_config());
+
+    std::string text(1000, 'x');
+    LOG_WARNING("%s", text.c_str());
+    Logger::instance().flush();
+
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find(std::string(SAK::log::LOG_PAYLOAD_SIZE - 1, 'x')), std::string::npos);
+    EXPECT_EQ(lines[0].find(std::string(SAK::log::LOG_PAYLOAD_SIZE, 'x')), std::string::npos);
+}
+
+TEST_F(LoggerBufferTest, FlushAlsoCoversTheSharedQueueMode) {
+    LogConfig config = buffered_config();
+    config.thread_buffers = false;
+    Logger::instance().configure(config);
+
+    LOG_INFO("queued line");
+    Logger::instance().flush();
+
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find("queued line"), std::string::npos);
+}
+
+#if !defined(CODEKNIFE_NO_METRICS)
+TEST_F(LoggerBufferTest, MetricsCountLinesDropsAndQueueDepth) {
+    auto& registry = SAK::metrics::Registry::Instance();
+    SAK::metrics::Counter& lines = registry.GetCounter("log.lines");
+    SAK::metrics::Counter& dropped = registry.GetCounter("log.dropped");
+    SAK::metrics::Gauge& depth = registry.GetGauge("log.queue_depth");
+
+    LogConfig config = buffered_config();
+    config.buffer_overflow = SAK::overflow_policy::drop;
+    Logger::instance().configure(config);
+    uint64_t lines_before = lines.Value();
+    uint64_t dropped_before = dropped.Value();
+    uint64_t dropped_count_before = Logger::instance().dropped_count();
+
+    // Faster than the logging thread keeps up with a 64-record ring
+    constexpr int kLines = 20000;
+    for (int i = 0; i < kLines; ++i) {
+        LOG_INFO("metric line %d", i);
+    }
+    Logger::instance().flush();
+
+    uint64_t written = lines.Value() - lines_before;
+    uint64_t lost = dropped.Value() - dropped_before;
+    EXPECT_EQ(written + lost, static_cast<uint64_t>(kLines));
+    EXPECT_EQ(lost, Logger::instance().dropped_count() - dropped_count_before);
+    EXPECT_EQ(read_lines().size(), written);
+    // The idle round after the last batch does not reset the depth
+    EXPECT_GT(depth.Value(), 0);
+    EXPECT_LE(depth.Value(), static_cast<int64_t>(config.thread_buffer_records));
+
+    // Nor do the shared queue's idle timeouts
+    config.thread_buffers = false;
+    config.flush_interval_ms = 5;
+    Logger::instance().configure(config);
+    LOG_INFO("queued line");
+    Logger::instance().flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(depth.Value(), 1);
+}
+#endif
+
+TEST_F(LoggerBufferTest, StoppingDoesNotStrandBlockedProducers) {
+    LogConfig config = buffered_config();
+    config.thread_buffer_records = 8;
+    Logger::instance().configure(config);
+
+    // Producers keep the tiny rings full under overflow_policy::block while
+    // the buffers are switched off underneath them
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&stop, t]() {
+            for (int i = 0; !stop.load(); ++i) {
+                LOG_INFO("producer %d line %d", t, i);
+            }
+        });
+    }
+    for (int round = 0; round < 20; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        Logger::instance().configure(config);
+    }
+    LogConfig sync = config;
+    sync.async_mode = false;
+    sync.min_level = Level::LOG_ERROR;
+    Logger::instance().configure(sync);
+    stop = true;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    // Lines queued while no logging thread ran go out here, not in a later test
+    Logger::instance().configure(config);
+    Logger::instance().flush();
+}
+
+TEST_F(LoggerBufferTest, DeferredRecordsFormatOnTheLoggingThread) {
+    Logger::instance().configure(buffered_config());
+
+    enum colour { red = 3 };
+    int value = 7;
+    char name[16] = "before";
+    LOG_DEFERRED_INFO("int=%d long=%lld dbl=%.2f enum=%d str=%s ptr=%p 100%%", -5, 123456789012LL, 2.5,
+                      red, name, static_cast<void*>(&value));
+    // The string was copied at the call, not referenced
+    std::snprintf(name, sizeof(name), "after");
+    LOG_DEFERRED_ERROR("no args 50%%");
+    Logger::instance().flush();
+
+    char expected[128];
+    std::snprintf(expected, sizeof(expected), "int=-5 long=123456789012 dbl=2.50 enum=3 str=before ptr=%p 100%%",
+                  static_cast<void*>(&value));
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("[INFO] "), std::string::npos);
+    EXPECT_NE(lines[0].find("test_logger.cpp:TestBody:"), std::string::npos);
+    EXPECT_EQ(lines[0].substr(lines[0].size() - std::strlen(expected)), expected);
+    EXPECT_EQ(lines[1].substr(lines[1].size() - 11), "no args 50%");
+}
+
+TEST_F(LoggerBufferTest, DeferredRecordsMatchInEveryMode) {
+    LogConfig sync = buffered_config();
+    sync.async_mode = false;
+    sync.thread_buffers = false;
+    LogConfig queued = buffered_config();
+    queued.thread_buffers = false;
+
+    for (const LogConfig& config : {sync, queued, buffered_config()}) {
+        Logger::instance().configure(config);
+        LOG_DEFERRED_WARNING("%s=%u", "answer", 42u);
+        LOG_DEFERRED_DEBUG("%s", std::string(1000, 'y').c_str());
+        Logger::instance().flush();
+
+        std::vector<std::string> lines = read_lines();
+        ASSERT_EQ(lines.size(), 2u);
+        EXPECT_EQ(lines[0].substr(lines[0].size() - 9), "answer=42");
+        // Strings are cut to what fits in the record
+        EXPECT_NE(lines[1].find(std::string(SAK::log::LOG_PAYLOAD_SIZE - 1, 'y')), std::string::npos);
+        EXPECT_EQ(lines[1].find(std::string(SAK::log::LOG_PAYLOAD_SIZE, 'y')), std::string::npos);
+        Logger::instance().configure(sync);
+        fs::remove_all(dir_);
+    }
+}
+
+TEST_F(LoggerBufferTest, RotatesBySizeAndKeepsMaxFiles) {
+    for (bool buffered : {false, true}) {
+        LogConfig config = buffered_config();
+        config.thread_buffers = buffered;
+        config.max_file_size = 4096;
+        config.max_files = 3;
+        config.sync_interval_ms = 1;
+        Logger::instance().configure(config);
+
+        for (int i = 0; i < 500; ++i) {
+            LOG_INFO("rotation line %04d", i);
+        }
+        Logger::instance().flush();
+
+        size_t written = 0;
+        for (const auto& entry : fs::directory_iterator(dir_)) {
+            if (fs::file_size(entry.path()) > 0) ++written;
+        }
+        // The pre-opened next file exists but is still empty
+        EXPECT_EQ(written, 3u);
+        std::vector<std::string> lines = read_lines();
+        ASSERT_FALSE(lines.empty());
+        EXPECT_LT(lines.size(), 500u);
+        for (const std::string& line : lines) {
+            EXPECT_NE(line.find("rotation line "), std::string::npos);
+        }
+        EXPECT_TRUE(std::any_of(lines.begin(), lines.end(), [](const std::string& line) {
+            return line.find("rotation line 0499") != std::string::npos;
+        }));
+
+        TearDown();
+    }
+}
+
+TEST(FileSinkTest, VectoredWritesKeepOrderAcrossIovBatches) {
+    fs::path dir = fs::temp_directory_path() / ("sak_sink_test_" + std::to_string(getpid()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        SAK::log::FileSinkConfig config;
+        config.dir = dir;
+        SAK::log::FileSink sink;
+        ASSERT_TRUE(sink.open(config));
+
+        std::vector<std::string> entries;
+        std::string expected;
+        for (int i = 0; i < 200; ++i) {
+            entries.push_back(i % 7 == 0 ? std::string() : "entry " + std::to_string(i) + "\n");
+            expected += entries.back();
+        }
+        sink.write(entries.data(), entries.size());
+        sink.write("tail\n", 5);
+        expected += "tail\n";
+
+        std::ifstream in(sink.path());
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, expected);
+        EXPECT_EQ(sink.rotations(), 0u);
+    }
+    // Closing removes the unused pre-opened file
+    EXPECT_EQ(std::distance(fs::directory_iterator(dir), fs::directory_iterator()), 1);
+    fs::remove_all(dir);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -6,13 +6,25 @@
 #include "cobject.hpp"
 #include "meta_object.hpp"
 #include "meta_registry.hpp"
+#include "memory_pool_v2.hpp"
 #include "connection_manager.hpp"
 #include "connection_types.hpp"
 #include "capplication.hpp"
+#include "event_loop.hpp"
+#include "event_dispatcher.hpp"
+#if defined(__linux__)
+#include "event_dispatcher_epoll.hpp"
+#include "event_dispatcher_uring.hpp"
+#include "file_object.hpp"
+#include <sys/socket.h>
+#endif
 #include <string>
 #include <any>
+#include <deque>
+#include <memory>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include <chrono>
 #include <thread>
 #include <atomic>
@@ -24,11 +36,20 @@
 
 // Function declarations
 void test_cobject_reflection();
+void test_meta_registry();
 void test_signal_slot_basic();
+void test_signal_slot_inherited();
+void test_signal_slot_concurrent_emit();
+void test_signal_slot_typed();
 void test_signal_slot_cross_thread();
 void test_event_loop_basic();
 void test_queued_cross_thread();
 void test_blocking_cross_thread();
+void test_thread_affinity();
+void test_posted_event_removal();
+void test_event_loop_tuning();
+void test_epoll_dispatcher();
+void test_uring_dispatcher();
 void test_cobject_timer();
 
 // Utility component tests
@@ -55,10 +76,16 @@ public:
     SIGNAL(TestObject, nameChanged, "void()")
 
     SLOT(TestObject, int, calculate, "int()")
+    SLOT(TestObject, std::string, describe, "std::string(int,int,int,int,const std::string&)",
+         int a, int b, int c, int d, const std::string& suffix)
 };
 
 int TestObject::calculate() { return value() * 2; }
 
+std::string TestObject::describe(int a, int b, int c, int d, const std::string& suffix) {
+    return std::to_string(a + b + c + d) + suffix;
+}
+
 AUTO_REGISTER_META_OBJECT(TestObject, CObject)
 
 // Sender for signal-slot tests
@@ -102,6 +129,148 @@ void Receiver::onCountChanged(int value) {
 AUTO_REGISTER_META_OBJECT(Sender, CObject)
 AUTO_REGISTER_META_OBJECT(Receiver, CObject)
 
+// Receiver subclass for inherited slot lookups
+class DerivedReceiver : public Receiver {
+    DECLARE_OBJECT(DerivedReceiver)
+public:
+    DerivedReceiver() : resets_(0) {}
+
+    SLOT(DerivedReceiver, void, onReset, "void()")
+
+    int resets() const { return resets_; }
+
+private:
+    int resets_;
+};
+
+void DerivedReceiver::onReset() { resets_++; }
+
+AUTO_REGISTER_META_OBJECT(DerivedReceiver, Receiver)
+
+// Created by name in bulk from a pool
+class PooledWidget : public CObject {
+    DECLARE_POOLED_OBJECT(PooledWidget)
+public:
+    PROPERTY(PooledWidget, int, weight)
+};
+
+class PooledGadget : public PooledWidget {
+    DECLARE_OBJECT(PooledGadget)
+public:
+    char payload[200] = {};
+};
+
+AUTO_REGISTER_META_OBJECT(PooledWidget, CObject)
+AUTO_REGISTER_META_OBJECT(PooledGadget, PooledWidget)
+
+// Emitter and counter for concurrent emission tests
+class Ticker : public CObject {
+    DECLARE_OBJECT(Ticker)
+public:
+    SIGNAL(Ticker, ticked, "void()")
+
+    void tick() { EMIT_SIGNAL(ticked); }
+};
+
+class TickCounter : public CObject {
+    DECLARE_OBJECT(TickCounter)
+public:
+    TickCounter() : ticks_(0) {}
+
+    SLOT(TickCounter, void, onTick, "void()")
+
+    int ticks() const { return ticks_.load(); }
+
+private:
+    std::atomic<int> ticks_;
+};
+
+void TickCounter::onTick() { ticks_++; }
+
+AUTO_REGISTER_META_OBJECT(Ticker, CObject)
+AUTO_REGISTER_META_OBJECT(TickCounter, CObject)
+
+// Typed signals for compile-time checked connections
+class Thermometer : public CObject {
+    DECLARE_OBJECT(Thermometer)
+public:
+    TYPED_SIGNAL(Thermometer, reading, int, const std::string&)
+    TYPED_SIGNAL(Thermometer, reset)
+
+    void emitByName(int value, const std::string& unit) { EMIT_SIGNAL(reading, value, unit); }
+};
+
+class Display : public CObject {
+    DECLARE_OBJECT(Display)
+public:
+    Display() : last_(0), shown_(0), cleared_(0), named_(0) {}
+
+    // Not registered: reachable only through typed connections
+    void show(int value, const std::string& unit) {
+        last_ = value;
+        unit_ = unit;
+        shown_++;
+    }
+    void clear() { cleared_++; }
+
+    SLOT(Display, void, onReading, "void(int,std::string)", int value, std::string unit)
+
+    int last() const { return last_; }
+    const std::string& unit() const { return unit_; }
+    int shown() const { return shown_; }
+    int cleared() const { return cleared_; }
+    int named() const { return named_; }
+
+private:
+    int last_;
+    std::string unit_;
+    int shown_;
+    int cleared_;
+    int named_;
+};
+
+void Display::onReading(int value, std::string unit) {
+    last_ = value;
+    unit_ = unit;
+    named_++;
+}
+
+AUTO_REGISTER_META_OBJECT(Thermometer, CObject)
+AUTO_REGISTER_META_OBJECT(Display, CObject)
+
+// Records where its slot and destructor ran, for thread affinity tests
+class ThreadProbe : public CObject {
+    DECLARE_OBJECT(ThreadProbe)
+public:
+    ThreadProbe(std::atomic<std::thread::id>* destroyedIn = nullptr)
+        : calls_(0), last_(0), destroyedIn_(destroyedIn) {}
+    ~ThreadProbe() {
+        if (destroyedIn_) {
+            *destroyedIn_ = std::this_thread::get_id();
+        }
+    }
+
+    SLOT(ThreadProbe, void, record, "void(int)", int value)
+
+    int calls() const { return calls_.load(); }
+    int last() const { return last_.load(); }
+    std::thread::id calledIn() const { return calledIn_.load(); }
+
+private:
+    std::atomic<int> calls_;
+    std::atomic<int> last_;
+    std::atomic<std::thread::id> calledIn_{};
+    std::atomic<std::thread::id>* destroyedIn_;
+};
+
+void ThreadProbe::record(int value) {
+    calledIn_ = std::this_thread::get_id();
+    last_ = value;
+    calls_++;
+}
+
+AUTO_REGISTER_META_OBJECT(ThreadProbe, CObject)
+
 // TimerTestObject for CObject timer tests
 class TimerTestObject : public CObject {
     DECLARE_OBJECT(TimerTestObject)
@@ -138,6 +307,53 @@ private:
 
 AUTO_REGISTER_META_OBJECT(TimerTestObject, CObject)
 
+// Counts the SocketAct events of a socket notifier
+class SocketProbe : public CObject {
+    DECLARE_OBJECT(SocketProbe)
+public:
+    bool event(Event* event) override {
+        if (event->type() == Event::Type::SocketAct) {
+            ++activations_;
+            return true;
+        }
+        return CObject::event(event);
+    }
+
+    int activations() const { return activations_; }
+
+private:
+    int activations_ = 0;
+};
+
+AUTO_REGISTER_META_OBJECT(SocketProbe, CObject)
+
+// Keeps the results of asynchronous I/O requests
+class IoProbe : public CObject {
+    DECLARE_OBJECT(IoProbe)
+public:
+    bool event(Event* event) override {
+        if (event->type() == Event::Type::IoCompletion) {
+            auto* io = static_cast<IoCompletionEvent*>(event);
+            results_[io->requestId()] = io->result();
+            if (io->data()) {
+                data_[io->requestId()].assign(reinterpret_cast<const char*>(io->data()), io->result());
+            }
+            return true;
+        }
+        return CObject::event(event);
+    }
+
+    std::size_t completed() const { return results_.size(); }
+    int64_t result(uint64_t id) const { auto it = results_.find(id); return it == results_.end() ? -1 : it->second; }
+    std::string data(uint64_t id) const { auto it = data_.find(id); return it == data_.end() ? "" : it->second; }
+
+private:
+    std::unordered_map<uint64_t, int64_t> results_;
+    std::unordered_map<uint64_t, std::string> data_;
+};
+
+AUTO_REGISTER_META_OBJECT(IoProbe, CObject)
+
 } // namespace SAK
 
 // ========== Test Functions ==========
@@ -185,6 +401,16 @@ void test_cobject_reflection() {
         }
         std::cout << "  ✓ Method reflection works" << std::endl;
         
+        // Beyond the three arguments the invokers used to be limited to
+        const SAK::MetaMethod* mDescribe = meta->findMethod("describe");
+        if (!mDescribe ||
+            std::any_cast<std::string>(mDescribe->invoke(&obj, {1, 2, 3, 4, std::string("!")})) != "10!" ||
+            mDescribe->invoke(&obj, {1, 2}).has_value()) {
+            std::cout << "FAIL: Five-argument method reflection failed" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Five-argument method reflection works" << std::endl;
+        
         std::cout << "\n✓ All CObject reflection tests PASSED!\n" << std::endl;
         
     } catch (const std::exception& e) {
@@ -192,6 +418,84 @@ void test_cobject_reflection() {
     }
 }
 
+void test_meta_registry() {
+    std::cout << "\n===== Test MetaRegistry =====\n" << std::endl;
+    SAK::MetaRegistry& registry = SAK::MetaRegistry::instance();
+    registry.registerMeta(&SAK::TestObject::staticMetaObject);
+    registry.registerMeta(&SAK::PooledWidget::staticMetaObject);
+    registry.registerMeta(&SAK::PooledGadget::staticMetaObject);
+
+    if (registry.findMeta("TestObject") != &SAK::TestObject::staticMetaObject ||
+        registry.findMeta(std::string("PooledGadget")) != &SAK::PooledGadget::staticMetaObject ||
+        registry.findMeta("NoSuchClass") || registry.factory("NoSuchClass").create()) {
+        std::cout << "FAIL: Class lookup failed" << std::endl;
+        return;
+    }
+    std::cout << "  ✓ Class lookup works" << std::endl;
+
+    // Readers look classes up while the table grows several times
+    // Registered for the rest of the process
+    static std::deque<std::string> names;
+    static std::vector<std::unique_ptr<SAK::MetaObject>> metas;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> lost{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (registry.findMeta("TestObject") != &SAK::TestObject::staticMetaObject) {
+                    lost = true;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 300; ++i) {
+        names.push_back("DynamicClass" + std::to_string(i));
+        metas.push_back(std::make_unique<SAK::MetaObject>(names.back().c_str(), &SAK::CObject::staticMetaObject,
+                                                          &SAK::TestObject::createInstance));
+        registry.registerMeta(metas.back().get());
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    bool all_found = !lost.load();
+    for (size_t i = 0; i < metas.size(); ++i) {
+        all_found = all_found && registry.findMeta(names[i]) == metas[i].get();
+    }
+    if (!all_found || registry.registeredClasses().size() < 303) {
+        std::cout << "FAIL: Lookups during registration failed" << std::endl;
+        return;
+    }
+    std::cout << "  ✓ Lookups run concurrently with registration" << std::endl;
+
+    // A resolved factory creates without looking the name up again
+    SAK::MetaFactory widgets = registry.factory("PooledWidget");
+    SAK::MetaFactory gadgets = registry.factory("PooledGadget");
+    std::vector<SAK::CObject*> created;
+    for (int i = 0; i < 1000; ++i) {
+        created.push_back(i % 2 ? gadgets.create() : widgets.create());
+    }
+    bool pooled = widgets.metaObject() == &SAK::PooledWidget::staticMetaObject;
+    for (size_t i = 0; i < created.size(); ++i) {
+        const SAK::MetaObject* expected = i % 2 ? &SAK::PooledGadget::staticMetaObject : &SAK::PooledWidget::staticMetaObject;
+        pooled = pooled && created[i] && created[i]->metaObject() == expected &&
+                 SAK::MemoryPoolV2::GetInstance().UsableSize(created[i]) >= sizeof(SAK::PooledWidget);
+    }
+    // Children go back to the pool with their parent
+    for (size_t i = 1; i < created.size(); ++i) {
+        created[i]->setParent(created[0]);
+    }
+    delete created[0];
+    if (!pooled) {
+        std::cout << "FAIL: Pooled creation through a factory failed" << std::endl;
+        return;
+    }
+    std::cout << "  ✓ Pooled creation through a factory works" << std::endl;
+
+    std::cout << "\n✓ All MetaRegistry tests PASSED!\n" << std::endl;
+}
+
 void test_signal_slot_basic() {
     std::cout << "\n===== Test Signal-Slot Basic Functionality =====\n" << std::endl;
     
@@ -248,6 +552,207 @@ void test_signal_slot_basic() {
     }
 }
 
+void test_signal_slot_inherited() {
+    std::cout << "\n===== Test Signal-Slot Inherited Members =====\n" << std::endl;
+    
+    try {
+        SAK::Sender sender;
+        SAK::DerivedReceiver receiver;
+        const SAK::MetaObject* meta = receiver.metaObject();
+        
+        std::cout << "Test 1: Flattened lookup" << std::endl;
+        const SAK::MetaMethod* inherited = meta->findMethod("onCountChanged");
+        const SAK::MetaMethod* own = meta->findMethod("onReset");
+        if (!inherited || !own || meta->findMethod(inherited->id()) != inherited ||
+            inherited != SAK::Receiver::staticMetaObject.findMethod("onCountChanged")) {
+            std::cout << "FAIL: Inherited method lookup failed" << std::endl;
+            return;
+        }
+        if (SAK::Receiver::staticMetaObject.findMethod("onReset") || meta->findMethod("noSuchSlot")) {
+            std::cout << "FAIL: Lookup found a method the class does not have" << std::endl;
+            return;
+        }
+        if (std::string(SAK::MetaNames::name(own->id())) != "onReset") {
+            std::cout << "FAIL: Interned name mismatch" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Own and inherited methods found by name and id" << std::endl;
+        
+        std::cout << "\nTest 2: Connect to inherited and own slots" << std::endl;
+        if (!SAK::CObject::connect(&sender, "countChanged", &receiver, "onCountChanged") ||
+            !SAK::CObject::connect(&sender, "countChanged", &receiver, "onReset")) {
+            std::cout << "FAIL: Connection failed" << std::endl;
+            return;
+        }
+        if (SAK::CObject::connect(&sender, "countChanged", &receiver, "onReset")) {
+            std::cout << "FAIL: Duplicate connection accepted" << std::endl;
+            return;
+        }
+        sender.increment();
+        if (receiver.callCount() != 1 || receiver.resets() != 1) {
+            std::cout << "FAIL: Signal emission failed" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Both slots called once" << std::endl;
+        
+        std::cout << "\nTest 3: Disconnect by slot for any receiver" << std::endl;
+        if (!SAK::CObject::disconnect(&sender, "countChanged", nullptr, "onReset")) {
+            std::cout << "FAIL: Disconnect failed" << std::endl;
+            return;
+        }
+        sender.increment();
+        if (receiver.callCount() != 2 || receiver.resets() != 1) {
+            std::cout << "FAIL: Wrong slots called after disconnect" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Only the remaining slot is called" << std::endl;
+        
+        std::cout << "\n✓ All inherited signal-slot tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
+void test_signal_slot_concurrent_emit() {
+    std::cout << "\n===== Test Signal-Slot Concurrent Emission =====\n" << std::endl;
+    
+    try {
+        SAK::Ticker ticker;
+        SAK::TickCounter steady;
+        const int threads = 4;
+        const int emits = 20000;
+        if (!SAK::CObject::connect(&ticker, "ticked", &steady, "onTick")) {
+            std::cout << "FAIL: Connection failed" << std::endl;
+            return;
+        }
+        
+        std::cout << "Test 1: Emit from several threads while connections change" << std::endl;
+        std::atomic<bool> done{false};
+        std::vector<std::thread> emitters;
+        for (int t = 0; t < threads; ++t) {
+            emitters.emplace_back([&ticker, emits]() {
+                for (int i = 0; i < emits; ++i) {
+                    ticker.tick();
+                }
+            });
+        }
+        // Receivers must outlive emissions already under way, so the churn
+        // reuses a fixed set and only connects and disconnects them
+        std::vector<SAK::TickCounter> transient(8);
+        std::thread churn([&ticker, &done, &transient]() {
+            for (size_t round = 0; !done.load(); ++round) {
+                SAK::TickCounter& counter = transient[round % transient.size()];
+                SAK::CObject::connect(&ticker, "ticked", &counter, "onTick");
+                std::this_thread::yield();
+                SAK::CObject::disconnect(&ticker, "ticked", &counter, "onTick");
+            }
+        });
+        for (auto& emitter : emitters) {
+            emitter.join();
+        }
+        done = true;
+        churn.join();
+        
+        if (steady.ticks() != threads * emits) {
+            std::cout << "FAIL: Expected " << threads * emits << " calls, got " << steady.ticks() << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Every emission reached the steady receiver" << std::endl;
+        
+        std::cout << "\n✓ All concurrent emission tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
+void test_signal_slot_typed() {
+    std::cout << "\n===== Test Typed Signal-Slot Connections =====\n" << std::endl;
+    
+    try {
+        SAK::Thermometer thermometer;
+        SAK::Display display;
+        
+        std::cout << "Test 1: Typed connection" << std::endl;
+        if (!SAK::CObject::connect(&thermometer, &SAK::Thermometer::reading, &display, &SAK::Display::show) ||
+            !SAK::CObject::connect(&thermometer, &SAK::Thermometer::reset, &display, &SAK::Display::clear)) {
+            std::cout << "FAIL: Typed connection failed" << std::endl;
+            return;
+        }
+        if (SAK::CObject::connect(&thermometer, &SAK::Thermometer::reading, &display, &SAK::Display::show)) {
+            std::cout << "FAIL: Duplicate typed connection accepted" << std::endl;
+            return;
+        }
+        thermometer.reading(21, "C");
+        thermometer.reset();
+        if (display.shown() != 1 || display.last() != 21 || display.unit() != "C" || display.cleared() != 1) {
+            std::cout << "FAIL: Typed emission failed" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Typed slots called with the signal's arguments" << std::endl;
+        
+        std::cout << "\nTest 2: Mixing typed and by-name connections" << std::endl;
+        if (!SAK::CObject::connect(&thermometer, "reading", &display, "onReading")) {
+            std::cout << "FAIL: By-name connection to a typed signal failed" << std::endl;
+            return;
+        }
+        thermometer.reading(22, "F");
+        if (display.shown() != 2 || display.named() != 1 || display.unit() != "F") {
+            std::cout << "FAIL: Typed emission did not reach the by-name slot" << std::endl;
+            return;
+        }
+        thermometer.emitByName(23, "K");
+        if (display.shown() != 3 || display.named() != 2 || display.last() != 23) {
+            std::cout << "FAIL: By-name emission did not reach the typed slot" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Both kinds of emission reach both kinds of slot" << std::endl;
+        
+        std::cout << "\nTest 3: Queued typed connection" << std::endl;
+        {
+            SAK::CApplication app;
+            SAK::Display queued;
+            SAK::CObject::connect(&thermometer, &SAK::Thermometer::reading, &queued, &SAK::Display::show,
+                                  SAK::ConnectionType::kQueuedConnection);
+            std::string unit = "C";
+            thermometer.reading(30, unit);
+            // The call holds its own copy of the arguments
+            unit = "changed";
+            SAK::CApplication::postCallback([&app]() { app.quit(); });
+            if (queued.shown() != 0) {
+                std::cout << "FAIL: Queued slot ran during emission" << std::endl;
+                return;
+            }
+            app.exec();
+            if (queued.shown() != 1 || queued.last() != 30 || queued.unit() != "C") {
+                std::cout << "FAIL: Queued typed slot failed" << std::endl;
+                return;
+            }
+        }
+        std::cout << "  ✓ Queued typed slot ran from the event loop" << std::endl;
+        
+        std::cout << "\nTest 4: Typed disconnect" << std::endl;
+        if (!SAK::CObject::disconnect(&thermometer, &SAK::Thermometer::reading, &display, &SAK::Display::show) ||
+            SAK::CObject::disconnect(&thermometer, &SAK::Thermometer::reading, &display, &SAK::Display::show)) {
+            std::cout << "FAIL: Typed disconnect failed" << std::endl;
+            return;
+        }
+        // Test 3's emission reached both slots here as well
+        thermometer.reading(24, "C");
+        if (display.shown() != 4 || display.named() != 4) {
+            std::cout << "FAIL: Wrong slots called after typed disconnect" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Only the by-name slot remains" << std::endl;
+        
+        std::cout << "\n✓ All typed signal-slot tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
 void test_signal_slot_cross_thread() {
     std::cout << "\n===== Test Signal-Slot Cross-Thread =====\n" << std::endl;
     std::cout << "Running event loop and cross-thread connection tests...\n" << std::endl;
@@ -255,6 +760,11 @@ void test_signal_slot_cross_thread() {
     test_event_loop_basic();
     test_queued_cross_thread();
     test_blocking_cross_thread();
+    test_thread_affinity();
+    test_posted_event_removal();
+    test_event_loop_tuning();
+    test_epoll_dispatcher();
+    test_uring_dispatcher();
 }
 
 void test_event_loop_basic() {
@@ -432,6 +942,440 @@ void test_blocking_cross_thread() {
     }
 }
 
+void test_thread_affinity() {
+    std::cout << "\n===== Test Thread Affinity =====\n";
+    
+    try {
+        std::atomic<SAK::EventLoop*> workerLoop{nullptr};
+        std::thread worker([&workerLoop]() {
+            SAK::EventLoop loop;
+            workerLoop = &loop;
+            loop.exec();
+        });
+        while (!workerLoop.load() || !workerLoop.load()->isRunning()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::thread::id workerId = worker.get_id();
+        
+        auto waitFor = [](auto done) {
+            for (int i = 0; i < 2000 && !done(); ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return done();
+        };
+        
+        std::cout << "Test 1: moveToThread" << std::endl;
+        SAK::Sender sender;
+        SAK::ThreadProbe probe;
+        auto* child = new SAK::ThreadProbe;
+        child->setParent(&probe);
+        if (child->moveToThread(workerId)) {
+            std::cout << "FAIL: A child was moved on its own" << std::endl;
+            return;
+        }
+        // Posted before the move: follows the object
+        SAK::CApplication::postEvent(&probe, new SAK::MetaCallEvent("record", {std::any(7)}));
+        if (!probe.moveToThread(workerId) || probe.thread() != workerId || child->thread() != workerId) {
+            std::cout << "FAIL: moveToThread did not move the object and its children" << std::endl;
+            return;
+        }
+        if (probe.moveToThread(std::this_thread::get_id())) {
+            std::cout << "FAIL: Object moved from a thread other than its own" << std::endl;
+            return;
+        }
+        if (!waitFor([&]() { return probe.calls() == 1; }) || probe.last() != 7 || probe.calledIn() != workerId) {
+            std::cout << "FAIL: Event posted before the move did not run in the new thread" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Object, children and pending events moved" << std::endl;
+        
+        std::cout << "\nTest 2: Auto connection to a moved receiver" << std::endl;
+        SAK::CObject::connect(&sender, "countChanged", &probe, "record", SAK::ConnectionType::kAutoConnection);
+        sender.increment();
+        if (!waitFor([&]() { return probe.calls() == 2; }) || probe.last() != 1 || probe.calledIn() != workerId) {
+            std::cout << "FAIL: Auto connection did not queue to the receiver's thread" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Slot ran on the worker's loop" << std::endl;
+        
+        std::cout << "\nTest 3: deleteLater runs in the object's thread" << std::endl;
+        std::atomic<std::thread::id> destroyedIn{};
+        auto* doomed = new SAK::ThreadProbe(&destroyedIn);
+        doomed->moveToThread(workerId);
+        doomed->deleteLater();
+        if (!waitFor([&]() { return destroyedIn.load() == workerId; })) {
+            std::cout << "FAIL: deleteLater did not run on the worker" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Deleted by the worker's loop" << std::endl;
+        
+        workerLoop.load()->quit();
+        worker.join();
+        
+        std::cout << "\n✓ All thread affinity tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
+void test_posted_event_removal() {
+    std::cout << "\n===== Test Posted Event Removal =====\n";
+    
+    try {
+        SAK::CApplication app;
+        SAK::ThreadProbe kept;
+        SAK::ThreadProbe dropped;
+        auto record = [](int value) { return new SAK::MetaCallEvent("record", {std::any(value)}); };
+        
+        std::cout << "Test 1: Removing one receiver's events" << std::endl;
+        for (int i = 1; i <= 3; ++i) {
+            SAK::CApplication::postEvent(&dropped, record(i));
+            SAK::CApplication::postEvent(&kept, record(10 + i));
+        }
+        SAK::CApplication::removePostedEvents(&dropped, SAK::Event::Type::MetaCall);
+        // Destroyed with events queued: they must go with it
+        auto* doomed = new SAK::ThreadProbe;
+        SAK::CApplication::postEvent(doomed, record(99));
+        delete doomed;
+        SAK::CApplication::postCallback([&app]() { app.quit(); });
+        app.exec();
+        if (dropped.calls() != 0 || kept.calls() != 3 || kept.last() != 13) {
+            std::cout << "FAIL: Wrong events delivered after removal" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Only the other receiver's events ran, in order" << std::endl;
+        
+        std::cout << "\nTest 2: Removing events of every receiver" << std::endl;
+        SAK::CApplication::postEvent(&kept, record(20));
+        SAK::CApplication::postEvent(&dropped, record(21));
+        SAK::CApplication::removePostedEvents(nullptr, SAK::Event::Type::MetaCall);
+        SAK::CApplication::postCallback([&app]() { app.quit(); });
+        app.exec();
+        if (kept.calls() != 3 || dropped.calls() != 0) {
+            std::cout << "FAIL: Events survived a global removal" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Callbacks kept, every event removed" << std::endl;
+        
+        std::cout << "\n✓ All posted event removal tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
+void test_event_loop_tuning() {
+    std::cout << "\n===== Test Event Loop Budget and Coalescing =====\n";
+    
+    try {
+        SAK::CApplication app;
+        SAK::EventLoop* loop = app.eventLoop();
+        SAK::ThreadProbe probe;
+        auto record = [](int value) { return new SAK::MetaCallEvent("record", {std::any(value)}); };
+        
+        std::cout << "Test 1: Identical calls coalesce" << std::endl;
+        loop->setCoalescing(true);
+        for (int i = 0; i < 3; ++i) {
+            SAK::CApplication::postEvent(&probe, record(5));
+        }
+        SAK::CApplication::postEvent(&probe, record(6));
+        SAK::CApplication::postCallback([&app]() { app.quit(); });
+        app.exec();
+        SAK::EventLoop::Stats stats = loop->stats();
+        if (probe.calls() != 2 || probe.last() != 6 || stats.coalesced != 2) {
+            std::cout << "FAIL: Expected 2 calls and 2 coalesced events, got " << probe.calls()
+                      << " and " << stats.coalesced << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Three identical calls ran once" << std::endl;
+        
+        std::cout << "\nTest 2: Per-iteration budget" << std::endl;
+        loop->setCoalescing(false);
+        loop->setEventBudget(2);
+        loop->resetStats();
+        for (int i = 0; i < 5; ++i) {
+            SAK::CApplication::postEvent(&probe, record(5));
+        }
+        SAK::CApplication::postCallback([&app]() { app.quit(); });
+        app.exec();
+        stats = loop->stats();
+        if (probe.calls() != 7 || stats.maxEventsPerIteration > 2 || stats.budgetExhausted < 2 ||
+            stats.iterations < 3 || stats.events != 6) {
+            std::cout << "FAIL: Budget not respected: " << stats.iterations << " iterations, at most "
+                      << stats.maxEventsPerIteration << " events each" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ " << stats.events << " events over " << stats.iterations << " iterations ("
+                  << stats.eventsPerIteration() << " per iteration)" << std::endl;
+        
+        std::cout << "\n✓ All event loop tuning tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+}
+
+#if defined(__linux__)
+// Posts quit() while the application is not running yet, then exec()s; a
+// watchdog quits instead if the posted callback never runs
+static bool postedQuitEndsExec(SAK::CApplication& app) {
+    // Leave the dispatcher un-woken, so only the post can wake it
+    app.eventDispatcher()->wakeUp();
+    app.eventDispatcher()->processEvents();
+    std::atomic<bool> ran{false};
+    SAK::CApplication::postCallback([&app, &ran]() {
+        ran.store(true);
+        app.quit();
+    });
+    bool stuck = false;
+    std::thread watchdog([&app, &ran, &stuck]() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!ran.load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (!ran.load()) {
+            stuck = true;
+            app.quit();
+        }
+    });
+    app.exec();
+    watchdog.join();
+    return !stuck;
+}
+#endif
+
+void test_epoll_dispatcher() {
+    std::cout << "\n===== Test Epoll Event Dispatcher =====\n";
+    
+#if defined(__linux__)
+    try {
+        std::cout << "Test 1: Timers on the timerfd" << std::endl;
+        SAK::EventDispatcherEpoll dispatcher;
+        SAK::TimerTestObject timerObj;
+        dispatcher.registerTimer(1, 10, &timerObj);
+        dispatcher.registerTimer(2, 60000, &timerObj);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (timerObj.getTimerCount() < 3 && std::chrono::steady_clock::now() < deadline) {
+            dispatcher.processEvents();
+        }
+        int remaining = dispatcher.remainingTime(2);
+        if (timerObj.getTimerCount() < 3 || remaining <= 0 || remaining > 60000 ||
+            !dispatcher.unregisterTimers(&timerObj) || dispatcher.remainingTime(1) != -1) {
+            std::cout << "FAIL: Expected the 10ms timer to fire, got " << timerObj.getTimerCount() << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Short timer fired, long one still pending" << std::endl;
+        
+        std::cout << "\nTest 2: Level- and edge-triggered notifiers" << std::endl;
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::cout << "FAIL: socketpair" << std::endl;
+            return;
+        }
+        SAK::SocketProbe levelProbe;
+        SAK::SocketNotifier levelNotifier{fds[0], SAK::SocketNotifierType::Read, &levelProbe};
+        dispatcher.registerSocketNotifier(&levelNotifier);
+        SAK::EventDispatcherEpoll edge(SAK::EventDispatcherEpoll::Trigger::Edge);
+        SAK::SocketProbe edgeProbe;
+        SAK::SocketNotifier edgeNotifier{fds[0], SAK::SocketNotifierType::Read, &edgeProbe};
+        edge.registerSocketNotifier(&edgeNotifier);
+        
+        char byte = 'x';
+        if (write(fds[1], &byte, 1) != 1) {
+            std::cout << "FAIL: write" << std::endl;
+            return;
+        }
+        for (int i = 0; i < 2; ++i) {
+            dispatcher.processEvents();
+            // Keeps processEvents() from blocking once the edge is consumed
+            edge.wakeUp();
+            edge.processEvents();
+        }
+        if (levelProbe.activations() != 2 || edgeProbe.activations() != 1) {
+            std::cout << "FAIL: Expected 2 level and 1 edge activations, got " << levelProbe.activations()
+                      << " and " << edgeProbe.activations() << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Unread data keeps firing level-triggered, once edge-triggered" << std::endl;
+        
+        dispatcher.unregisterSocketNotifier(&levelNotifier);
+        dispatcher.wakeUp();
+        dispatcher.processEvents();
+        edge.unregisterSocketNotifier(&edgeNotifier);
+        close(fds[0]);
+        close(fds[1]);
+        if (levelProbe.activations() != 2) {
+            std::cout << "FAIL: Unregistered notifier still fired" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Unregistered notifier stays quiet" << std::endl;
+        
+        std::cout << "\nTest 3: wakeUp() from another thread" << std::endl;
+        std::thread waker([&dispatcher]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            dispatcher.wakeUp();
+        });
+        dispatcher.processEvents();
+        waker.join();
+        std::cout << "  ✓ Blocked processEvents() returned" << std::endl;
+        
+        std::cout << "\nTest 4: CApplication on the epoll backend" << std::endl;
+        SAK::CApplication app(nullptr, SAK::EventDispatcherBackend::Epoll);
+        if (!dynamic_cast<SAK::EventDispatcherEpoll*>(app.eventDispatcher())) {
+            std::cout << "FAIL: CApplication did not create the epoll dispatcher" << std::endl;
+            return;
+        }
+        SAK::TimerTestObject appTimer;
+        appTimer.startTestTimer(5);
+        std::thread quitter([&app, &appTimer]() {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (appTimer.getTimerCount() < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            app.quit();
+        });
+        app.exec();
+        quitter.join();
+        appTimer.stopTestTimer();
+        if (appTimer.getTimerCount() < 2) {
+            std::cout << "FAIL: Timer did not run under exec()" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ exec() ran timers and quit from another thread" << std::endl;
+        
+        std::cout << "\nTest 5: Callback posted before exec()" << std::endl;
+        if (!postedQuitEndsExec(app)) {
+            std::cout << "FAIL: exec() blocked on a callback posted before it started" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ exec() ran the earlier post without another wake-up" << std::endl;
+        
+        std::cout << "\n✓ All epoll dispatcher tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+#else
+    std::cout << "  Skipped: epoll is Linux only" << std::endl;
+#endif
+}
+
+void test_uring_dispatcher() {
+    std::cout << "\n===== Test io_uring Event Dispatcher =====\n";
+    
+#if defined(__linux__)
+    try {
+        // 64-byte registered buffers, so larger requests take the pool path
+        SAK::EventDispatcherUring dispatcher(32, 64, 4);
+        std::cout << "  io_uring " << (dispatcher.ringAvailable() ? "available" : "unavailable, running synchronously")
+                  << std::endl;
+        SAK::IoProbe probe;
+        auto runUntil = [&dispatcher, &probe](std::size_t completions) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (probe.completed() < completions && std::chrono::steady_clock::now() < deadline) {
+                dispatcher.processEvents();
+            }
+            return probe.completed() >= completions;
+        };
+        
+        std::cout << "Test 1: File reads, batched" << std::endl;
+        std::string content(300, '\0');
+        for (std::size_t i = 0; i < content.size(); ++i) {
+            content[i] = static_cast<char>('a' + i % 26);
+        }
+        std::string path = "/tmp/codeknife_uring_test.dat";
+        SAK::FileObject file = SAK::FileObject::Create(path, std::vector<uint8_t>(content.begin(), content.end()));
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < 8; ++i) {
+            ids.push_back(dispatcher.read(file.Fd(), i * 10, 10, &probe));
+        }
+        uint64_t large = dispatcher.read(file.Fd(), 0, 200, &probe);
+        if (!runUntil(9) || dispatcher.pendingRequests() != 0) {
+            std::cout << "FAIL: Expected 9 completions, got " << probe.completed() << std::endl;
+            return;
+        }
+        for (int i = 0; i < 8; ++i) {
+            if (probe.data(ids[i]) != content.substr(i * 10, 10)) {
+                std::cout << "FAIL: Read " << i << " returned '" << probe.data(ids[i]) << "'" << std::endl;
+                return;
+            }
+        }
+        if (probe.data(large) != content.substr(0, 200)) {
+            std::cout << "FAIL: Read larger than the registered buffers returned " << probe.result(large) << std::endl;
+            return;
+        }
+        std::cout << "  ✓ 9 reads completed as events, fixed and pool buffers" << std::endl;
+        
+        std::cout << "\nTest 2: Pipe write then read" << std::endl;
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::cout << "FAIL: pipe" << std::endl;
+            return;
+        }
+        uint64_t w = dispatcher.write(fds[1], SAK::EventDispatcherUring::kCurrentPosition, "hello", 5, &probe);
+        if (!runUntil(10) || probe.result(w) != 5) {
+            std::cout << "FAIL: Write returned " << probe.result(w) << std::endl;
+            return;
+        }
+        uint64_t r = dispatcher.read(fds[0], SAK::EventDispatcherUring::kCurrentPosition, 16, &probe);
+        if (!runUntil(11) || probe.data(r) != "hello") {
+            std::cout << "FAIL: Read back '" << probe.data(r) << "'" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Written bytes read back" << std::endl;
+        
+        std::cout << "\nTest 3: Cancelled receivers get nothing" << std::endl;
+        SAK::IoProbe dropped;
+        dispatcher.read(file.Fd(), 0, 10, &dropped);
+        dispatcher.cancelRequests(&dropped);
+        uint64_t last = dispatcher.read(file.Fd(), 0, 10, &probe);
+        if (!runUntil(12) || probe.result(last) != 10 || dropped.completed() != 0) {
+            std::cout << "FAIL: Cancelled receiver still got " << dropped.completed() << " completions" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ Only the live receiver was told" << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        unlink(path.c_str());
+        
+        std::cout << "\nTest 4: Shutdown with a read that never completes" << std::endl;
+        {
+            int sv[2];
+            socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+            SAK::EventDispatcherUring pending;
+            SAK::IoProbe waiting;
+            pending.read(sv[0], 0, 16, &waiting);
+            pending.wakeUp();
+            pending.processEvents();
+            close(sv[0]);
+            close(sv[1]);
+        }
+        std::cout << "  ✓ Outstanding request cancelled on destruction" << std::endl;
+        
+        std::cout << "\nTest 5: CApplication on the io_uring backend" << std::endl;
+        SAK::CApplication app(nullptr, SAK::EventDispatcherBackend::IoUring);
+        if (!dynamic_cast<SAK::EventDispatcherUring*>(app.eventDispatcher())) {
+            std::cout << "FAIL: CApplication did not create the io_uring dispatcher" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ CApplication created the io_uring dispatcher" << std::endl;
+        if (!postedQuitEndsExec(app)) {
+            std::cout << "FAIL: exec() blocked on a callback posted before it started" << std::endl;
+            return;
+        }
+        std::cout << "  ✓ exec() ran a callback posted before it started" << std::endl;
+        
+        std::cout << "\n✓ All io_uring dispatcher tests PASSED!\n" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Exception: " << e.what() << std::endl;
+    }
+#else
+    std::cout << "  Skipped: io_uring is Linux only" << std::endl;
+#endif
+}
+
 // ========== Utility Component Tests ==========
 
 void test_logger() {
@@ -724,7 +1668,11 @@ int main() {
     try {
         // ========== Core Object System Tests ==========
         test_cobject_reflection();
+        test_meta_registry();
         test_signal_slot_basic();
+        test_signal_slot_inherited();
+        test_signal_slot_concurrent_emit();
+        test_signal_slot_typed();
         test_signal_slot_cross_thread();
         test_cobject_timer();
         
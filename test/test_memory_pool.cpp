@@ -0,0 +1,120 @@
+#include "util/memory_pool.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace SAK::memory;
+
+TEST(FixedSizeMemoryPool, CarvesAlignedBlocksFromChunks) {
+    FixedSizeMemoryPool pool(48, 16);
+    EXPECT_EQ(pool.num_blocks(), 16u);
+    EXPECT_EQ(pool.num_free_blocks(), 16u);
+
+    std::set<void*> seen;
+    std::vector<void*> blocks;
+    for (int i = 0; i < 40; ++i) {
+        void* block = pool.allocate();
+        ASSERT_NE(block, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 64, 0u);
+        EXPECT_TRUE(seen.insert(block).second);
+        blocks.push_back(block);
+    }
+    EXPECT_GE(pool.num_blocks(), 40u);
+    EXPECT_GT(pool.usage_ratio(), 0.0);
+
+    for (void* block : blocks) {
+        pool.deallocate(block);
+    }
+    EXPECT_EQ(pool.num_free_blocks(), pool.num_blocks());
+}
+
+TEST(FixedSizeMemoryPool, BatchTransfer) {
+    FixedSizeMemoryPool pool(16, 8);
+    size_t count = 0;
+    void* head = pool.allocate_batch(32, count);
+    ASSERT_NE(head, nullptr);
+    EXPECT_EQ(count, 8u);
+    EXPECT_EQ(pool.num_free_blocks(), 0u);
+
+    void* tail = head;
+    size_t walked = 1;
+    while (*static_cast<void**>(tail)) {
+        tail = *static_cast<void**>(tail);
+        ++walked;
+    }
+    EXPECT_EQ(walked, count);
+
+    pool.deallocate_batch(head, tail, count);
+    EXPECT_EQ(pool.num_free_blocks(), 8u);
+}
+
+TEST(MemoryPool, SizeClassesRoundUp) {
+    auto& pool = MemoryPool::GetInstance();
+    size_t before = pool.GetCurrentAllocations();
+
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t size : {1u, 7u, 8u, 9u, 100u, 1024u, 1025u, 4096u}) {
+        void* ptr = pool.Allocate(size);
+        ASSERT_NE(ptr, nullptr);
+        std::memset(ptr, 0xAB, size);
+        blocks.emplace_back(ptr, size);
+    }
+    EXPECT_EQ(pool.GetCurrentAllocations(), before + blocks.size());
+
+    for (auto& block : blocks) {
+        pool.Deallocate(block.first, block.second);
+    }
+    EXPECT_EQ(pool.GetCurrentAllocations(), before);
+}
+
+TEST(MemoryPool, ThreadCachesReturnBlocksOnExit) {
+    auto& pool = MemoryPool::GetInstance();
+    size_t before = pool.GetCurrentAllocations();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool]() {
+            std::vector<void*> blocks;
+            for (int i = 0; i < 500; ++i) {
+                blocks.push_back(pool.Allocate(32));
+            }
+            for (void* block : blocks) {
+                pool.Deallocate(block, 32);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(pool.GetCurrentAllocations(), before);
+}
+
+TEST(MemoryPool, CrossThreadFree) {
+    auto& pool = MemoryPool::GetInstance();
+    std::vector<void*> blocks;
+    for (int i = 0; i < 200; ++i) {
+        blocks.push_back(pool.Allocate(64));
+    }
+    std::thread([&pool, &blocks]() {
+        for (void* block : blocks) {
+            pool.Deallocate(block, 64);
+        }
+    }).join();
+
+    std::set<void*> reused;
+    for (int i = 0; i < 200; ++i) {
+        void* block = pool.Allocate(64);
+        ASSERT_NE(block, nullptr);
+        EXPECT_TRUE(reused.insert(block).second);
+    }
+    for (void* block : reused) {
+        pool.Deallocate(block, 64);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,13 @@
 #include "util/memory_pool_v2.hpp"
+#include "util/pool_allocator.hpp"
+#include "util/skiplist.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 using namespace SAK;
@@ -49,18 +56,16 @@ TEST(MemoryPoolV2, SlabRefill) {
     EXPECT_NE(tc->slabs[class_idx], nullptr);
     
     // Verify block count
-    size_t block_size = SIZE_CLASSES[class_idx];
-    size_t total_size = block_size + sizeof(BlockHeader);
-    size_t expected_blocks = SLAB_SIZE / total_size;
+    size_t expected_blocks = BlocksPerSlab(class_idx);
     
     // Count linked list length
     size_t count = 0;
     void* p = tc->bins[class_idx].private_list;
     while (p && count < expected_blocks + 10) {  // +10 to prevent infinite loop
-        BlockHeader* h = static_cast<BlockHeader*>(p);
-        EXPECT_EQ(h->size_class, class_idx);
-        EXPECT_EQ(h->owner, tc);
-        p = h->next;
+        Slab* slab = SlabOf(p);
+        EXPECT_EQ(slab->size_class, class_idx);
+        EXPECT_EQ(slab->owner, tc);
+        p = *static_cast<void**>(p);
         count++;
     }
     
@@ -71,12 +76,12 @@ TEST(MemoryPoolV2, SmallObjectAllocation) {
     void* ptr = MemoryPoolV2::GetInstance().Allocate(64);
     ASSERT_NE(ptr, nullptr);
     
-    // Verify header
-    BlockHeader* header = reinterpret_cast<BlockHeader*>(
-        static_cast<char*>(ptr) - sizeof(BlockHeader)
-    );
-    EXPECT_EQ(header->size_class, 3);  // 64-byte class
-    EXPECT_NE(header->owner, nullptr);
+    // Verify slab header found by masking
+    Slab* slab = SlabOf(ptr);
+    EXPECT_EQ(slab->size_class, 3);  // 64-byte class
+    EXPECT_EQ(slab->owner, GetOrCreateThreadCache());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(slab) % SLAB_SIZE, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
     
     // Write data to verify usability
     memset(ptr, 0xAB, 64);
@@ -84,6 +89,23 @@ TEST(MemoryPoolV2, SmallObjectAllocation) {
     MemoryPoolV2::GetInstance().Deallocate(ptr, 64);
 }
 
+TEST(MemoryPoolV2, SmallBlocksCarryNoHeader) {
+    std::thread t([]() {
+        // A fresh slab hands out tightly packed 8-byte blocks
+        void* a = MemoryPoolV2::GetInstance().Allocate(8);
+        void* b = MemoryPoolV2::GetInstance().Allocate(8);
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+        EXPECT_EQ(SlabOf(a), SlabOf(b));
+        EXPECT_EQ(static_cast<char*>(a) - static_cast<char*>(b), 8);
+        EXPECT_EQ(SlabOf(a)->num_blocks, (SLAB_SIZE - SLAB_HEADER_SIZE) / 8);
+
+        MemoryPoolV2::GetInstance().Deallocate(b, 8);
+        MemoryPoolV2::GetInstance().Deallocate(a, 8);
+    });
+    t.join();
+}
+
 TEST(MemoryPoolV2, SameThreadDeallocation) {
     void* ptr = MemoryPoolV2::GetInstance().Allocate(64);
     ASSERT_NE(ptr, nullptr);
@@ -222,6 +244,7 @@ TEST(MemoryPoolV2, CrossThreadDeallocAfterOwnerExit) {
     // Verify no crash or UAF
 }
 
+#ifndef MEMORY_POOL_V2_NO_STATS
 TEST(MemoryPoolV2, Statistics) {
     // Get initial statistics
     auto stats_before = MemoryPoolV2::GetInstance().GetStats();
@@ -247,6 +270,381 @@ TEST(MemoryPoolV2, Statistics) {
     MemoryPoolV2::GetInstance().PrintStats();
 }
 
+TEST(MemoryPoolV2, StatisticsSurviveThreadExit) {
+    auto stats_before = MemoryPoolV2::GetInstance().GetStats();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 100; ++i) {
+                void* p = MemoryPoolV2::GetInstance().Allocate(16);
+                MemoryPoolV2::GetInstance().Deallocate(p, 16);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto stats_after = MemoryPoolV2::GetInstance().GetStats();
+    EXPECT_EQ(stats_after.total_allocated - stats_before.total_allocated, 4u * 100 * 16);
+    EXPECT_EQ(stats_after.total_deallocated - stats_before.total_deallocated, 4u * 100 * 16);
+    EXPECT_GE(stats_after.slab_refills - stats_before.slab_refills, 4u);
+}
+#else
+TEST(MemoryPoolV2, StatisticsCompiledOut) {
+    void* ptr = MemoryPoolV2::GetInstance().Allocate(64);
+    MemoryPoolV2::GetInstance().Deallocate(ptr, 64);
+
+    auto stats = MemoryPoolV2::GetInstance().GetStats();
+    EXPECT_EQ(stats.total_allocated, 0u);
+    EXPECT_EQ(stats.total_deallocated, 0u);
+}
+#endif
+
+TEST(MemoryPoolV2, TrimReleasesFullyFreeSlabs) {
+    // Keep every freed block local so slab occupancy is deterministic
+    MemoryPoolV2::GetInstance().SetTransferWatermarks(0, TRANSFER_BATCH_SIZE);
+
+    std::thread t([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        size_t class_idx = 2;  // 32-byte
+        size_t blocks_per_slab = BlocksPerSlab(class_idx);
+
+        // Span three slabs, keep one block alive so its slab must survive
+        std::vector<void*> ptrs;
+        for (size_t i = 0; i < blocks_per_slab * 2 + 1; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(32));
+            ASSERT_NE(ptrs.back(), nullptr);
+        }
+        void* survivor = ptrs.front();
+        for (size_t i = 1; i < ptrs.size(); ++i) {
+            MemoryPoolV2::GetInstance().Deallocate(ptrs[i], 32);
+        }
+
+        auto stats_before = MemoryPoolV2::GetInstance().GetStats();
+        size_t released = MemoryPoolV2::GetInstance().Trim();
+        auto stats_after = MemoryPoolV2::GetInstance().GetStats();
+
+        EXPECT_EQ(released, 2 * SLAB_SIZE);
+#ifndef MEMORY_POOL_V2_NO_STATS
+        EXPECT_EQ(stats_after.slabs_released - stats_before.slabs_released, 2u);
+        EXPECT_EQ(stats_after.bytes_released - stats_before.bytes_released, 2 * SLAB_SIZE);
+#else
+        (void)stats_before;
+        (void)stats_after;
+#endif
+        ASSERT_NE(tc->slabs[class_idx], nullptr);
+        EXPECT_EQ(tc->slabs[class_idx]->next, nullptr);
+
+        // Remaining free list only references the surviving slab
+        size_t count = 0;
+        for (void* p = tc->bins[class_idx].private_list; p; p = *static_cast<void**>(p)) {
+            count++;
+        }
+        EXPECT_EQ(count, blocks_per_slab - 1);
+
+        // Pool still works after trimming
+        void* again = MemoryPoolV2::GetInstance().Allocate(32);
+        ASSERT_NE(again, nullptr);
+        memset(again, 0x5A, 32);
+        MemoryPoolV2::GetInstance().Deallocate(again, 32);
+        MemoryPoolV2::GetInstance().Deallocate(survivor, 32);
+        EXPECT_EQ(MemoryPoolV2::GetInstance().Trim(), SLAB_SIZE);
+        EXPECT_EQ(tc->slabs[class_idx], nullptr);
+        EXPECT_EQ(tc->bins[class_idx].private_list, nullptr);
+    });
+    t.join();
+
+    MemoryPoolV2::GetInstance().SetTransferWatermarks(TRANSFER_HIGH_WATERMARK, TRANSFER_BATCH_SIZE);
+}
+
+TEST(MemoryPoolV2, TrimCountsCrossThreadFrees) {
+    std::thread owner([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        size_t class_idx = 4;  // 128-byte
+        size_t blocks_per_slab = BlocksPerSlab(class_idx);
+
+        std::vector<void*> ptrs;
+        for (size_t i = 0; i < blocks_per_slab; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(128));
+        }
+
+        // Half of the blocks come back through the mailbox
+        std::thread remote([&ptrs]() {
+            for (size_t i = 0; i < ptrs.size(); i += 2) {
+                MemoryPoolV2::GetInstance().Deallocate(ptrs[i], 128);
+            }
+        });
+        remote.join();
+        for (size_t i = 1; i < ptrs.size(); i += 2) {
+            MemoryPoolV2::GetInstance().Deallocate(ptrs[i], 128);
+        }
+
+        EXPECT_EQ(MemoryPoolV2::GetInstance().Trim(), SLAB_SIZE);
+        EXPECT_EQ(tc->slabs[class_idx], nullptr);
+        EXPECT_EQ(tc->bins[class_idx].mailbox.load(), nullptr);
+        EXPECT_EQ(tc->bins[class_idx].private_list, nullptr);
+    });
+    owner.join();
+}
+
+TEST(MemoryPoolV2, RequestTrimIsHonouredOnNextFree) {
+    std::thread t([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        size_t class_idx = 5;  // 256-byte
+        size_t blocks_per_slab = BlocksPerSlab(class_idx);
+
+        std::vector<void*> ptrs;
+        for (size_t i = 0; i < blocks_per_slab; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(256));
+        }
+        for (size_t i = 1; i < ptrs.size(); ++i) {
+            MemoryPoolV2::GetInstance().Deallocate(ptrs[i], 256);
+        }
+
+        MemoryPoolV2::GetInstance().RequestTrim();
+        EXPECT_TRUE(tc->trim_requested.load());
+        EXPECT_NE(tc->slabs[class_idx], nullptr);
+
+        MemoryPoolV2::GetInstance().Deallocate(ptrs[0], 256);
+        EXPECT_FALSE(tc->trim_requested.load());
+        EXPECT_EQ(tc->slabs[class_idx], nullptr);
+    });
+    t.join();
+
+    // RequestTrim() flagged this thread's cache too; honour it now so a later
+    // free here does not release slabs that other tests still expect to reuse
+    MemoryPoolV2::GetInstance().Trim();
+}
+
+TEST(MemoryPoolV2, TransferCacheMovesSurplusBetweenThreads) {
+    const size_t class_idx = 6;  // 512-byte
+    const size_t total_size = SIZE_CLASSES[class_idx];
+    const size_t blocks_per_slab = BlocksPerSlab(class_idx);
+    EXPECT_EQ(MemoryPoolV2::GetInstance().GetTransferHighWatermark(), TRANSFER_HIGH_WATERMARK);
+    EXPECT_EQ(MemoryPoolV2::GetInstance().GetTransferBatchSize(), TRANSFER_BATCH_SIZE);
+
+    auto stats_before = MemoryPoolV2::GetInstance().GetStats();
+
+    // Producer frees well past the high watermark; the surplus goes central
+    std::vector<void*> ptrs;
+    std::thread producer([&]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        for (size_t i = 0; i < blocks_per_slab * 4; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(512));
+            ASSERT_NE(ptrs.back(), nullptr);
+        }
+        for (void* p : ptrs) {
+            MemoryPoolV2::GetInstance().Deallocate(p, 512);
+        }
+        EXPECT_LE(tc->bins[class_idx].free_blocks, TRANSFER_HIGH_WATERMARK / total_size);
+    });
+    producer.join();
+
+    // Consumer refills from the transfer cache instead of carving a slab
+    std::thread consumer([&]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        void* p = MemoryPoolV2::GetInstance().Allocate(512);
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(tc->slabs[class_idx], nullptr);
+        EXPECT_NE(SlabOf(p)->owner, tc);  // Block came from the producer's slab
+        memset(p, 0x3C, 512);
+        MemoryPoolV2::GetInstance().Deallocate(p, 512);
+    });
+    consumer.join();
+
+#ifndef MEMORY_POOL_V2_NO_STATS
+    auto stats_after = MemoryPoolV2::GetInstance().GetStats();
+    EXPECT_GT(stats_after.transfers_out, stats_before.transfers_out);
+    EXPECT_GT(stats_after.transfers_in, stats_before.transfers_in);
+#else
+    (void)stats_before;
+#endif
+}
+
+TEST(MemoryPoolV2, TransferCacheCanBeDisabled) {
+    MemoryPoolV2::GetInstance().SetTransferWatermarks(0, TRANSFER_BATCH_SIZE);
+
+    std::thread t([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        const size_t class_idx = 7;  // 1024-byte
+        const size_t blocks_per_slab = BlocksPerSlab(class_idx);
+
+        std::vector<void*> ptrs;
+        for (size_t i = 0; i < blocks_per_slab * 4; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(1024));
+        }
+        for (void* p : ptrs) {
+            MemoryPoolV2::GetInstance().Deallocate(p, 1024);
+        }
+        EXPECT_EQ(tc->bins[class_idx].free_blocks, blocks_per_slab * 4);
+    });
+    t.join();
+
+    MemoryPoolV2::GetInstance().SetTransferWatermarks(TRANSFER_HIGH_WATERMARK, TRANSFER_BATCH_SIZE);
+}
+
+TEST(MemoryPoolV2, ThreadChurnThroughTransferCacheFreesExitedCaches) {
+    const size_t dead_before = MemoryPoolV2::GetInstance().DeadCacheCount();
+
+    // Each short-lived thread takes blocks other threads handed off and hands
+    // off its own surplus in turn
+    auto churn = []() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 20000; ++i) {
+            ptrs.push_back(MemoryPoolV2::GetInstance().Allocate(64));
+        }
+        for (void* p : ptrs) {
+            MemoryPoolV2::GetInstance().Deallocate(p, 64);
+        }
+    };
+    for (int round = 0; round < 100; ++round) {
+        std::thread t(churn);
+        t.join();
+    }
+    EXPECT_LE(MemoryPoolV2::GetInstance().DeadCacheCount(), dead_before + TRANSFER_MAX_BATCHES);
+
+    // Emptying the transfer cache returns the last handed-off blocks home
+    std::thread drain([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+            while (RefillFromTransferCache(tc, i)) {
+            }
+        }
+    });
+    drain.join();
+    EXPECT_LE(MemoryPoolV2::GetInstance().DeadCacheCount(), dead_before);
+}
+
+TEST(MemoryPoolV2, NumaAwareModeMapsSlabsAndMediumBlocks) {
+    MemoryPoolV2::GetInstance().SetNumaAware(true);
+    EXPECT_TRUE(MemoryPoolV2::GetInstance().IsNumaAware());
+
+    std::thread t([]() {
+        ThreadCache* tc = GetOrCreateThreadCache();
+        EXPECT_LT(tc->numa_node, 1024u);
+        auto stats_before = MemoryPoolV2::GetInstance().GetStats();
+
+        void* small = MemoryPoolV2::GetInstance().Allocate(48);
+        ASSERT_NE(small, nullptr);
+        memset(small, 0x11, 48);
+
+        void* medium = MemoryPoolV2::GetInstance().Allocate(16 * 1024);
+        ASSERT_NE(medium, nullptr);
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(medium) - sizeof(BlockHeader));
+        EXPECT_EQ(header->size_class, MEDIUM_OBJECT);
+        EXPECT_TRUE(header->flags & MEDIUM_MAPPED);
+        memset(medium, 0x22, 16 * 1024);
+
+#ifndef MEMORY_POOL_V2_NO_STATS
+        auto stats_after = MemoryPoolV2::GetInstance().GetStats();
+        size_t node = std::min<size_t>(tc->numa_node, MAX_NUMA_NODES - 1);
+        EXPECT_GE(stats_after.node_mapped_bytes[node] - stats_before.node_mapped_bytes[node],
+                  SLAB_SIZE + 16 * 1024 + sizeof(BlockHeader));
+        EXPECT_GE(stats_after.node_threads[node], 1u);
+#else
+        (void)stats_before;
+#endif
+
+        MemoryPoolV2::GetInstance().Deallocate(small, 48);
+        MemoryPoolV2::GetInstance().Deallocate(medium, 16 * 1024);
+
+        // Cached mapped block is reused and released correctly on thread exit
+        void* again = MemoryPoolV2::GetInstance().Allocate(16 * 1024);
+        EXPECT_EQ(again, medium);
+        MemoryPoolV2::GetInstance().Deallocate(again, 16 * 1024);
+    });
+    t.join();
+
+    MemoryPoolV2::GetInstance().SetNumaAware(false);
+}
+
+TEST(MemoryPoolV2, UnsizedDeallocateUsesSlabMap) {
+    MemoryPoolV2& pool = MemoryPoolV2::GetInstance();
+
+    void* small = pool.Allocate(40);
+    void* medium = pool.Allocate(4096);
+    void* large = pool.Allocate(MAX_MEDIUM_SIZE + 1);
+    ASSERT_NE(small, nullptr);
+    ASSERT_NE(medium, nullptr);
+    ASSERT_NE(large, nullptr);
+
+    EXPECT_TRUE(IsSmallBlock(small));
+    EXPECT_FALSE(IsSmallBlock(medium));
+    EXPECT_FALSE(IsSmallBlock(large));
+    int on_stack = 0;
+    EXPECT_FALSE(IsSmallBlock(&on_stack));
+
+    EXPECT_EQ(pool.UsableSize(small), 64u);
+    EXPECT_GE(pool.UsableSize(medium), 4096u);
+    EXPECT_EQ(pool.UsableSize(large), MAX_MEDIUM_SIZE + 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(medium) % 16, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 16, 0u);
+
+    pool.Deallocate(small);
+    pool.Deallocate(medium);
+    pool.Deallocate(large);
+    pool.Deallocate(nullptr);
+
+    // A mis-sized free still lands in the right tier
+    void* block = pool.Allocate(100);
+    pool.Deallocate(block, MAX_MEDIUM_SIZE + 1);
+    EXPECT_EQ(pool.Allocate(100), block);
+    pool.Deallocate(block, 100);
+}
+
+TEST(MemoryPoolV2, PoolAllocatorWithStandardContainers) {
+    std::vector<int, PoolAllocator<int>> values;
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values.size(), 10000u);
+    EXPECT_EQ(values[9999], 9999);
+
+    using Map = std::unordered_map<int, std::string, std::hash<int>, std::equal_to<int>,
+                                   PoolAllocator<std::pair<const int, std::string>>>;
+    Map map;
+    for (int i = 0; i < 1000; ++i) {
+        map.emplace(i, std::to_string(i));
+    }
+    EXPECT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.at(512), "512");
+
+    EXPECT_TRUE(PoolAllocator<int>() == PoolAllocator<double>());
+
+    struct alignas(128) OverAligned {
+        char data[128];
+    };
+    PoolAllocator<OverAligned> aligned;
+    OverAligned* p = aligned.allocate(3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 128, 0u);
+    aligned.deallocate(p, 3);
+}
+
+TEST(MemoryPoolV2, PoolAllocatorWithSkipList) {
+    ConcurrentSkipList<int, int, std::less<int>, PoolAllocator<std::pair<int, int>>> list;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&list, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                list.emplace(t * kPerThread + i, i);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    EXPECT_EQ(list.size(), static_cast<size_t>(kThreads * kPerThread));
+    for (int k = 0; k < kThreads * kPerThread; k += 97) {
+        EXPECT_TRUE(list.contains(k));
+    }
+}
+
 TEST(MemoryPoolV2, MultiThreadStress) {
     const int num_threads = 4;
     const int iterations = 1000;
@@ -0,0 +1,171 @@
+#include "util/memtable.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SAK::ByteBuffer;
+using SAK::MemTable;
+using SAK::MemTableList;
+
+namespace {
+
+ByteBuffer B(const std::string& s) {
+    return ByteBuffer(s);
+}
+
+std::string S(const std::optional<ByteBuffer>& value) {
+    return value ? value->ToString() : "<none>";
+}
+
+} // namespace
+
+TEST(MemTable, GetReturnsNewestVersionAtReadTimestamp) {
+    MemTable table(0);
+    ASSERT_TRUE(table.Put(B("k"), 10, B("v10")));
+    ASSERT_TRUE(table.Put(B("k"), 20, B("v20")));
+    ASSERT_TRUE(table.Put(B("k"), 30, ByteBuffer()));  // tombstone
+    ASSERT_TRUE(table.Put(B("j"), 5, B("j5")));
+
+    EXPECT_EQ(S(table.Get(B("k"), 9)), "<none>");
+    EXPECT_EQ(S(table.Get(B("k"), 10)), "v10");
+    EXPECT_EQ(S(table.Get(B("k"), 25)), "v20");
+    ASSERT_TRUE(table.Get(B("k")).has_value());
+    EXPECT_TRUE(table.Get(B("k"))->Empty());
+    EXPECT_EQ(S(table.Get(B("j"))), "j5");
+    EXPECT_EQ(S(table.Get(B("l"))), "<none>");
+}
+
+TEST(MemTable, DuplicateVersionKeepsTheFirstValue) {
+    MemTable table(0);
+    ASSERT_TRUE(table.Put(B("k"), 1, B("first")));
+    EXPECT_FALSE(table.Put(B("k"), 1, B("second")));
+    EXPECT_EQ(S(table.Get(B("k"), 1)), "first");
+    EXPECT_EQ(table.NumEntries(), 1u);
+}
+
+TEST(MemTable, FrozenTableRejectsPuts) {
+    MemTable table(0);
+    ASSERT_TRUE(table.Put(B("k"), 1, B("v")));
+    table.Freeze();
+    EXPECT_FALSE(table.Put(B("j"), 2, B("w")));
+    EXPECT_EQ(S(table.Get(B("j"))), "<none>");
+    EXPECT_EQ(S(table.Get(B("k"))), "v");
+    EXPECT_EQ(table.NumEntries(), 1u);
+}
+
+TEST(MemTable, TracksApproximateSizeAndArenaUsage) {
+    MemTable table(0, 4096);
+    EXPECT_EQ(table.ApproximateSize(), 0u);
+    table.Put(B("abc"), 1, B("12345"));
+    EXPECT_EQ(table.ApproximateSize(), 3 + sizeof(uint64_t) + 5);
+    for (int i = 0; i < 1000; ++i) {
+        table.Put(B("key" + std::to_string(i)), 1, B("value"));
+    }
+    EXPECT_GE(table.ArenaMemoryUsage(), 1000u * sizeof(void*));
+}
+
+TEST(MemTable, ScanYieldsVisibleVersionPerKeyInRange) {
+    MemTable table(0);
+    table.Put(B("a"), 1, B("a1"));
+    table.Put(B("b"), 1, B("b1"));
+    table.Put(B("b"), 3, B("b3"));
+    table.Put(B("c"), 4, B("c4"));  // Not visible at ts 3
+    table.Put(B("d"), 2, ByteBuffer());
+    table.Put(B("e"), 1, B("e1"));
+
+    std::vector<std::string> seen;
+    for (auto it = table.Scan(B("b"), B("e"), 3); it.Valid(); it.Next()) {
+        seen.push_back(it.Key().ToString() + "=" + it.Value().ToString() + "@" + std::to_string(it.Timestamp()));
+    }
+    EXPECT_EQ(seen, (std::vector<std::string>{"b=b3@3", "d=@2"}));
+
+    seen.clear();
+    for (auto it = table.Scan(ByteBuffer(), ByteBuffer(), 1); it.Valid(); it.Next()) {
+        seen.push_back(it.Key().ToString());
+    }
+    EXPECT_EQ(seen, (std::vector<std::string>{"a", "b", "e"}));
+}
+
+TEST(MemTable, ConcurrentWritersAreAllVisible) {
+    MemTable table(0);
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&table, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                table.Put(B("k" + std::to_string(i)), static_cast<uint64_t>(t + 1), B(std::to_string(t)));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    EXPECT_EQ(table.NumEntries(), static_cast<size_t>(kThreads * kPerThread));
+    for (int i = 0; i < kPerThread; i += 97) {
+        EXPECT_EQ(S(table.Get(B("k" + std::to_string(i)))), std::to_string(kThreads - 1));
+    }
+}
+
+TEST(MemTableList, FreezesActiveTableAtTargetSize) {
+    SAK::Options options;
+    options.target_sst_size = 256;
+    options.num_memtable_limit = 2;
+    MemTableList tables(options);
+
+    uint64_t ts = 0;
+    while (tables.Immutables().size() < 2) {
+        std::string key = "key" + std::to_string(ts++);
+        tables.Put(B(key), ts, B(std::string(32, 'x')));
+    }
+    auto frozen = tables.Immutables();
+    EXPECT_TRUE(frozen[0]->Frozen());
+    EXPECT_GT(frozen[0]->Id(), frozen[1]->Id());
+    EXPECT_GE(frozen[1]->ApproximateSize(), options.target_sst_size);
+    EXPECT_FALSE(tables.Active()->Frozen());
+    EXPECT_TRUE(tables.NeedsFlush());
+
+    // Reads see every table, newest first
+    EXPECT_EQ(S(tables.Get(B("key0"))), std::string(32, 'x'));
+    tables.Delete(B("key0"), ++ts);
+    EXPECT_TRUE(tables.Get(B("key0"))->Empty());
+    EXPECT_FALSE(tables.Get(B("key0"), ts - 1)->Empty());
+
+    auto oldest = tables.PopOldest();
+    ASSERT_NE(oldest, nullptr);
+    EXPECT_EQ(oldest->Id(), frozen[1]->Id());
+    EXPECT_FALSE(tables.NeedsFlush());
+}
+
+TEST(MemTableList, ConcurrentWritersAcrossFreezes) {
+    SAK::Options options;
+    options.target_sst_size = 4096;
+    MemTableList tables(options);
+    std::atomic<uint64_t> ts{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&tables, &ts, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                tables.Put(B(std::to_string(t) + ":" + std::to_string(i)), ++ts, B("v"));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    size_t entries = tables.Active()->NumEntries();
+    for (const auto& table : tables.Immutables()) {
+        EXPECT_TRUE(table->Frozen());
+        entries += table->NumEntries();
+    }
+    EXPECT_EQ(entries, 4000u);
+    EXPECT_GT(tables.Immutables().size(), 1u);
+    EXPECT_EQ(S(tables.Get(B("3:999"))), "v");
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
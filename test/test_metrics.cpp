@@ -0,0 +1,214 @@
+#include "util/metrics.hpp"
+#include "util/thread_pool.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SAK::metrics;
+
+namespace {
+
+size_t CountOf(const std::vector<TraceEvent>& events, const std::string& name) {
+    size_t count = 0;
+    for (const TraceEvent& event : events) {
+        count += name == event.name;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(Metrics, CounterSumsAcrossThreads) {
+    Counter& counter = Registry::Instance().GetCounter("test.counter");
+    counter.Reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < 10000; ++i) {
+                counter.Add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.Value(), 80000u);
+    counter.Reset();
+    EXPECT_EQ(counter.Value(), 0u);
+}
+
+TEST(Metrics, GaugeKeepsLastLevel) {
+    Gauge& gauge = Registry::Instance().GetGauge("test.gauge");
+    gauge.Set(10);
+    gauge.Add(-3);
+    EXPECT_EQ(gauge.Value(), 7);
+}
+
+TEST(Metrics, SameObjectPerName) {
+    Registry& registry = Registry::Instance();
+    EXPECT_EQ(&registry.GetCounter("test.same"), &registry.GetCounter("test.same"));
+    EXPECT_NE(&registry.GetCounter("test.same"), &registry.GetCounter("test.other"));
+    EXPECT_EQ(&registry.GetHistogram("test.same"), &registry.GetHistogram("test.same"));
+}
+
+TEST(Histogram, BucketsCoverTheRangeInOrder) {
+    EXPECT_EQ(Histogram::BucketOf(0), 0u);
+    EXPECT_EQ(Histogram::BucketOf(~uint64_t(0)), Histogram::kBuckets - 1);
+    EXPECT_EQ(Histogram::BucketUpperBound(Histogram::kBuckets - 1), ~uint64_t(0));
+    for (size_t i = 1; i < Histogram::kBuckets; ++i) {
+        uint64_t lower = Histogram::BucketUpperBound(i - 1) + 1;
+        ASSERT_GT(Histogram::BucketUpperBound(i), Histogram::BucketUpperBound(i - 1));
+        ASSERT_EQ(Histogram::BucketOf(lower), i);
+        ASSERT_EQ(Histogram::BucketOf(Histogram::BucketUpperBound(i)), i);
+    }
+}
+
+TEST(Histogram, PercentilesWithinOneSixteenth) {
+    Histogram histogram;
+    for (uint64_t v = 1; v <= 100000; ++v) {
+        histogram.Record(v);
+    }
+    Histogram::Snapshot snapshot = histogram.Take();
+    EXPECT_EQ(snapshot.count, 100000u);
+    EXPECT_EQ(snapshot.max, 100000u);
+    EXPECT_DOUBLE_EQ(snapshot.Mean(), 50000.5);
+    for (double p : {50.0, 90.0, 99.0, 99.9}) {
+        double exact = p * 1000;
+        double reported = static_cast<double>(snapshot.Percentile(p));
+        EXPECT_GE(reported, exact) << p;
+        EXPECT_LE(reported, exact * 1.0625) << p;
+    }
+    EXPECT_EQ(snapshot.Percentile(100), 100000u);
+
+    histogram.Reset();
+    EXPECT_EQ(histogram.Take().count, 0u);
+    EXPECT_EQ(histogram.Take().Percentile(50), 0u);
+}
+
+TEST(Registry, CallbackGaugesAreSummedAndRemovable) {
+    Registry& registry = Registry::Instance();
+    uint64_t first = registry.AddCallbackGauge("test.callback", [] { return int64_t(5); });
+    uint64_t second = registry.AddCallbackGauge("test.callback", [] { return int64_t(7); });
+    EXPECT_NE(registry.ToJson().find("\"test.callback\": 12"), std::string::npos);
+    registry.RemoveCallbackGauge(first);
+    EXPECT_NE(registry.ToJson().find("\"test.callback\": 7"), std::string::npos);
+    registry.RemoveCallbackGauge(second);
+    EXPECT_EQ(registry.ToJson().find("\"test.callback\""), std::string::npos);
+}
+
+TEST(Registry, JsonHasEverySection) {
+    Registry& registry = Registry::Instance();
+    registry.GetCounter("test.json.counter").Add(3);
+    registry.GetHistogram("test.json.histogram").Record(42);
+    std::string json = registry.ToJson();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"counters\""), std::string::npos);
+    EXPECT_NE(json.find("\"gauges\""), std::string::npos);
+    EXPECT_NE(json.find("\"test.json.counter\": 3"), std::string::npos);
+    EXPECT_NE(json.find("\"test.json.histogram\": {\"count\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"p999\": 42"), std::string::npos);
+}
+
+TEST(Tracer, DisabledRecordsNothing) {
+    Tracer& tracer = Tracer::Instance();
+    tracer.SetEnabled(false);
+    tracer.Clear();
+    {
+        SAK_TRACE_SPAN("test", "disabled");
+    }
+    EXPECT_EQ(CountOf(tracer.Collect(), "disabled"), 0u);
+}
+
+TEST(Tracer, SpansFromEveryThreadAreExported) {
+    Tracer& tracer = Tracer::Instance();
+    tracer.Clear();
+    tracer.SetEnabled(true);
+    {
+        SAK_TRACE_SPAN("test", "outer");
+        std::thread([] { SAK_TRACE_SPAN("test", "worker"); }).join();
+    }
+    tracer.SetEnabled(false);
+
+    std::vector<TraceEvent> events = tracer.Collect();
+    ASSERT_EQ(CountOf(events, "outer"), 1u);
+    ASSERT_EQ(CountOf(events, "worker"), 1u);
+    const TraceEvent* outer = nullptr;
+    const TraceEvent* worker = nullptr;
+    for (const TraceEvent& event : events) {
+        if (std::string(event.name) == "outer") outer = &event;
+        if (std::string(event.name) == "worker") worker = &event;
+    }
+    EXPECT_NE(outer->thread, worker->thread);
+    EXPECT_LE(outer->start_ns, worker->start_ns);
+    EXPECT_GE(outer->start_ns + outer->duration_ns, worker->start_ns + worker->duration_ns);
+
+    std::string json = tracer.ChromeTraceJson();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\": \"outer\", \"cat\": \"test\", \"ph\": \"X\""), std::string::npos);
+
+    std::string path = ::testing::TempDir() + "codeknife_trace.json";
+    ASSERT_TRUE(tracer.WriteChromeTrace(path));
+    std::ifstream file(path);
+    std::stringstream written;
+    written << file.rdbuf();
+    EXPECT_EQ(written.str(), json);
+    std::remove(path.c_str());
+
+    // The exited worker's ring goes, this thread's is emptied
+    tracer.Clear();
+    EXPECT_TRUE(tracer.Collect().empty());
+}
+
+TEST(Tracer, FullRingKeepsTheNewestSpans) {
+    Tracer& tracer = Tracer::Instance();
+    tracer.Clear();
+    size_t previous = tracer.BufferEvents();
+    tracer.SetBufferEvents(8);
+    tracer.SetEnabled(true);
+    std::thread([&tracer] {
+        for (uint64_t i = 0; i < 20; ++i) {
+            tracer.Record("test", "wrapped", i * 10, i * 10 + 1);
+        }
+    }).join();
+    tracer.SetEnabled(false);
+    tracer.SetBufferEvents(previous);
+
+    std::vector<TraceEvent> events = tracer.Collect();
+    ASSERT_EQ(events.size(), 8u);
+    EXPECT_EQ(events.front().start_ns, 120u);
+    EXPECT_EQ(events.back().start_ns, 190u);
+    tracer.Clear();
+}
+
+TEST(Metrics, ThreadPoolReportsItsTasks) {
+    Registry& registry = Registry::Instance();
+    Histogram& queue_wait = registry.GetHistogram("thread_pool.queue_wait_ns");
+    Counter& tasks = registry.GetCounter("thread_pool.tasks");
+    uint64_t waited_before = queue_wait.Take().count;
+    uint64_t tasks_before = tasks.Value();
+    {
+        SAK::thread::ThreadPool pool(2);
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 100; ++i) {
+            results.push_back(pool.enqueue([i] { return i; }));
+        }
+        for (auto& result : results) {
+            result.get();
+        }
+        EXPECT_NE(registry.ToJson().find("\"thread_pool.pending\""), std::string::npos);
+    }
+    EXPECT_GE(queue_wait.Take().count, waited_before + 100);
+    EXPECT_GE(tasks.Value(), tasks_before + 100);
+    EXPECT_EQ(registry.ToJson().find("\"thread_pool.pending\""), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
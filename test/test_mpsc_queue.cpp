@@ -0,0 +1,99 @@
+#include "util/mpsc_queue.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using SAK::mpsc_node;
+using SAK::mpsc_queue;
+
+namespace {
+
+struct Item : mpsc_node {
+    Item(int producer, int value) : producer(producer), value(value) {}
+    int producer;
+    int value;
+};
+
+} // namespace
+
+TEST(MpscQueue, FifoForOneProducer) {
+    mpsc_queue<Item> queue;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.pop(), nullptr);
+
+    std::vector<std::unique_ptr<Item>> items;
+    for (int i = 0; i < 5; ++i) {
+        items.push_back(std::make_unique<Item>(0, i));
+        queue.push(items.back().get());
+    }
+    EXPECT_FALSE(queue.empty());
+    for (int i = 0; i < 5; ++i) {
+        Item* item = queue.pop();
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(item->value, i);
+    }
+    EXPECT_EQ(queue.pop(), nullptr);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, ElementsCanBeReused) {
+    mpsc_queue<Item> queue;
+    Item a(0, 1), b(0, 2);
+    for (int round = 0; round < 3; ++round) {
+        queue.push(&a);
+        queue.push(&b);
+        EXPECT_EQ(queue.pop(), &a);
+        // Pushed again while b is still queued
+        queue.push(&a);
+        EXPECT_EQ(queue.pop(), &b);
+        EXPECT_EQ(queue.pop(), &a);
+        EXPECT_EQ(queue.pop(), nullptr);
+    }
+}
+
+TEST(MpscQueue, ProducersKeepTheirOwnOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    mpsc_queue<Item> queue;
+
+    // deque: elements never move once queued
+    std::vector<std::deque<Item>> items(PRODUCERS);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        for (int i = 0; i < PER_PRODUCER; ++i) {
+            items[p].emplace_back(p, i);
+        }
+    }
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, &items, p]() {
+            for (Item& item : items[p]) {
+                queue.push(&item);
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    while (received < PRODUCERS * PER_PRODUCER) {
+        Item* item = queue.pop();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item->value, next[item->producer]);
+        ++next[item->producer];
+        ++received;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(queue.pop(), nullptr);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
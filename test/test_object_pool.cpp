@@ -0,0 +1,196 @@
+#include "util/object_pool.hpp"
+#include "util/spin_mutex.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SAK::pool;
+
+namespace {
+
+struct Item {
+    int value = 0;
+    std::string name;
+};
+
+} // namespace
+
+TEST(ShardedObjectPool, AcquireReleaseReusesObjects) {
+    ShardedObjectPool<Item> pool(8);
+    EXPECT_EQ(pool.total_count(), 8u);
+    EXPECT_EQ(pool.available_count(), 8u);
+
+    Item* a = pool.acquire();
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(pool.active_count(), 1u);
+    pool.release(a);
+    EXPECT_EQ(pool.active_count(), 0u);
+
+    // The calling thread's magazine hands the same object back
+    EXPECT_EQ(pool.acquire(), a);
+    pool.release(a);
+}
+
+TEST(ShardedObjectPool, ResetFunctionRunsOnRelease) {
+    ShardedObjectPool<Item> pool(4, GrowthPolicy::Fixed, 0, [](Item& item) {
+        item.value = 0;
+        item.name.clear();
+    });
+    Item* item = pool.acquire();
+    item->value = 42;
+    item->name = "used";
+    pool.release(item);
+
+    Item* again = pool.acquire();
+    EXPECT_EQ(again->value, 0);
+    EXPECT_TRUE(again->name.empty());
+    pool.release(again);
+}
+
+TEST(ShardedObjectPool, FailedResetDropsObject) {
+    ShardedObjectPool<Item> pool(2, GrowthPolicy::Fixed, 0, [](Item& item) {
+        if (item.value < 0) throw std::runtime_error("bad");
+    });
+    Item* item = pool.acquire();
+    item->value = -1;
+    pool.release(item);
+    EXPECT_EQ(pool.total_count(), 1u);
+    EXPECT_EQ(pool.active_count(), 0u);
+}
+
+TEST(ShardedObjectPool, GrowthPolicies) {
+    ShardedObjectPool<Item> fixed(3, GrowthPolicy::Fixed, 0);
+    std::vector<Item*> held;
+    for (int i = 0; i < 3; ++i) {
+        held.push_back(fixed.acquire());
+        ASSERT_NE(held.back(), nullptr);
+    }
+    EXPECT_EQ(fixed.acquire(), nullptr);
+    for (Item* item : held) fixed.release(item);
+    held.clear();
+
+    ShardedObjectPool<Item> additive(2, GrowthPolicy::Additive, 5);
+    for (int i = 0; i < 3; ++i) held.push_back(additive.acquire());
+    EXPECT_EQ(additive.total_count(), 7u);
+    for (Item* item : held) additive.release(item);
+    held.clear();
+
+    ShardedObjectPool<Item> multiplicative(4, GrowthPolicy::Multiplicative, 2);
+    for (int i = 0; i < 5; ++i) held.push_back(multiplicative.acquire());
+    EXPECT_EQ(multiplicative.total_count(), 8u);
+    for (Item* item : held) multiplicative.release(item);
+}
+
+TEST(ShardedObjectPool, ReserveAndTrim) {
+    ShardedObjectPool<Item, std::function<void(Item&)>, 4> pool(0, GrowthPolicy::Fixed, 0);
+    pool.reserve(40);
+    EXPECT_EQ(pool.total_count(), 40u);
+    EXPECT_EQ(pool.trim(10), 30u);
+    EXPECT_EQ(pool.total_count(), 10u);
+    EXPECT_EQ(pool.available_count(), 10u);
+}
+
+TEST(ShardedObjectPool, ConcurrentAcquireRelease) {
+    constexpr int kThreads = 8;
+    constexpr int kIterations = 20000;
+    ShardedObjectPool<Item, std::function<void(Item&)>, 8> pool(64, GrowthPolicy::Additive, 64);
+
+    std::atomic<bool> corrupted{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &corrupted, t]() {
+            std::vector<Item*> held;
+            for (int i = 0; i < kIterations; ++i) {
+                Item* item = pool.acquire();
+                if (!item) {
+                    corrupted = true;
+                    return;
+                }
+                item->value = t;
+                held.push_back(item);
+                if (held.size() == 16 || i % 3 == 0) {
+                    for (Item* h : held) {
+                        if (h->value != t) corrupted = true;
+                        pool.release(h);
+                    }
+                    held.clear();
+                }
+            }
+            for (Item* h : held) pool.release(h);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_FALSE(corrupted.load());
+    EXPECT_EQ(pool.active_count(), 0u);
+    EXPECT_EQ(pool.available_count(), pool.total_count());
+}
+
+TEST(ShardedObjectPool, ExitedThreadReturnsMagazines) {
+    ShardedObjectPool<Item, std::function<void(Item&)>, 4> pool(8, GrowthPolicy::Fixed, 0);
+    std::thread([&pool]() {
+        std::vector<Item*> held;
+        for (int i = 0; i < 8; ++i) held.push_back(pool.acquire());
+        for (Item* item : held) pool.release(item);
+    }).join();
+
+    // All eight objects must be reachable from this thread again
+    std::set<Item*> seen;
+    std::vector<Item*> held;
+    for (int i = 0; i < 8; ++i) {
+        Item* item = pool.acquire();
+        ASSERT_NE(item, nullptr);
+        seen.insert(item);
+        held.push_back(item);
+    }
+    EXPECT_EQ(seen.size(), 8u);
+    for (Item* item : held) pool.release(item);
+}
+
+TEST(ShardedObjectPool, MakePooledReleasesOnScopeExit) {
+    ShardedObjectPool<Item> pool(2);
+    {
+        auto item = make_pooled(pool);
+        ASSERT_TRUE(item);
+        item->value = 7;
+        EXPECT_EQ(pool.active_count(), 1u);
+    }
+    EXPECT_EQ(pool.active_count(), 0u);
+}
+
+#ifdef DEBUG
+TEST(ShardedObjectPool, DoubleReleaseThrows) {
+    ShardedObjectPool<Item> pool(2);
+    Item* item = pool.acquire();
+    pool.release(item);
+    EXPECT_THROW(pool.release(item), std::runtime_error);
+}
+#endif
+
+TEST(ObjectPool, SpinMutexGuardedPoolUnderContention) {
+    ObjectPool<Item, std::function<void(Item&)>, SAK::spin_mutex> pool(4, GrowthPolicy::Additive, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < 2000; ++i) {
+                auto item = make_pooled(pool);
+                ASSERT_TRUE(item);
+                item->value = i;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(pool.active_count(), 0u);
+    EXPECT_EQ(pool.available_count(), pool.total_count());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,222 @@
+#include "util/ring_queue.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SAK::mpmc_queue;
+using SAK::overflow_policy;
+using SAK::spsc_ring;
+
+TEST(MpmcQueue, FifoWithinCapacity) {
+    mpmc_queue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(8));
+    EXPECT_EQ(queue.size_approx(), 8u);
+
+    for (int i = 0; i < 8; ++i) {
+        auto value = queue.try_pop();
+        ASSERT_TRUE(value);
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_FALSE(queue.try_pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpmcQueue, MoveOnlyElementsAreDestroyedWithTheQueue) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        mpmc_queue<std::shared_ptr<int>> queue(4);
+        queue.try_push(tracker);
+        queue.try_push(tracker);
+        EXPECT_EQ(tracker.use_count(), 3);
+
+        mpmc_queue<std::unique_ptr<int>> owned(2);
+        EXPECT_TRUE(owned.try_push(std::make_unique<int>(7)));
+        std::unique_ptr<int> out;
+        EXPECT_TRUE(owned.try_pop(out));
+        EXPECT_EQ(*out, 7);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(MpmcQueue, DropAndOverwritePolicies) {
+    mpmc_queue<int> dropping(2, overflow_policy::drop);
+    EXPECT_TRUE(dropping.push(1));
+    EXPECT_TRUE(dropping.push(2));
+    EXPECT_FALSE(dropping.push(3));
+    EXPECT_EQ(dropping.dropped(), 1u);
+    EXPECT_EQ(*dropping.try_pop(), 1);
+
+    mpmc_queue<int> ring(2, overflow_policy::overwrite);
+    for (int i = 1; i <= 5; ++i) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_EQ(ring.overwritten(), 3u);
+    EXPECT_EQ(*ring.try_pop(), 4);
+    EXPECT_EQ(*ring.try_pop(), 5);
+}
+
+TEST(MpmcQueue, BlockingPushWaitsForSpace) {
+    mpmc_queue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]() {
+        EXPECT_TRUE(queue.push(3));
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(pushed.load());
+
+    EXPECT_EQ(*queue.try_pop(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    EXPECT_EQ(*queue.try_pop(), 2);
+    EXPECT_EQ(*queue.try_pop(), 3);
+}
+
+TEST(MpmcQueue, CloseWakesWaitersAndDrains) {
+    mpmc_queue<int> queue(4);
+    std::thread consumer([&]() {
+        int value = 0;
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, 1);
+        EXPECT_FALSE(queue.pop(value));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.push(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.close();
+    consumer.join();
+
+    EXPECT_FALSE(queue.push(2));
+    EXPECT_FALSE(queue.try_push(2));
+}
+
+TEST(MpmcQueue, ConcurrentProducersAndConsumersSeeEveryElementOnce) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 20000;
+    mpmc_queue<int> queue(64);
+
+    std::vector<std::atomic<int>> seen(kProducers * kPerProducer);
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&]() {
+            int value = 0;
+            while (queue.pop(value)) {
+                seen[value].fetch_add(1);
+                sum.fetch_add(value);
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ASSERT_TRUE(queue.push(p * kPerProducer + i));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.close();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long n = kProducers * kPerProducer;
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+    for (auto& count : seen) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(SpscRing, FifoAndBulkOperations) {
+    spsc_ring<std::string> ring(4);
+    EXPECT_EQ(ring.capacity(), 4u);
+
+    std::vector<std::string> input = {"a", "b", "c", "d", "e"};
+    EXPECT_EQ(ring.try_push_bulk(input.begin(), input.size()), 4u);
+    EXPECT_FALSE(ring.try_push("f"));
+    EXPECT_EQ(input[4], "e");  // Not pushed, not moved from
+
+    std::vector<std::string> out(3);
+    EXPECT_EQ(ring.try_pop_bulk(out.begin(), out.size()), 3u);
+    EXPECT_EQ(out, (std::vector<std::string>{"a", "b", "c"}));
+
+    EXPECT_TRUE(ring.try_push("e"));
+    EXPECT_EQ(*ring.try_pop(), "d");
+    std::string last;
+    EXPECT_TRUE(ring.try_pop(last));
+    EXPECT_EQ(last, "e");
+    EXPECT_FALSE(ring.try_pop());
+}
+
+TEST(SpscRing, DropPolicyAndUnsupportedOverwrite) {
+    spsc_ring<int> ring(2, overflow_policy::drop);
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push(3));
+    EXPECT_EQ(ring.dropped(), 1u);
+
+    EXPECT_THROW(spsc_ring<int>(2, overflow_policy::overwrite), std::invalid_argument);
+}
+
+TEST(SpscRing, StreamsInOrderAcrossThreads) {
+    constexpr int kCount = 200000;
+    spsc_ring<int> ring(128);
+
+    std::thread producer([&]() {
+        int batch[16];
+        int next = 0;
+        while (next < kCount) {
+            if (next % 3 == 0) {
+                ASSERT_TRUE(ring.push(next++));
+                continue;
+            }
+            int n = 0;
+            while (n < 16 && next + n < kCount) {
+                batch[n] = next + n;
+                ++n;
+            }
+            size_t pushed = ring.try_push_bulk(batch, n);
+            next += static_cast<int>(pushed);
+        }
+        ring.close();
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    std::vector<int> out(32);
+    for (;;) {
+        size_t n = ring.pop_bulk(out.begin(), out.size());
+        if (n == 0) break;
+        for (size_t i = 0; i < n; ++i) {
+            ordered = ordered && out[i] == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(expected, kCount);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
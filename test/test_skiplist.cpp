@@ -1,7 +1,16 @@
 #include "skiplist.hpp"
+#include "arena.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 TEST(ConcurrentSkipList, InsertFindAndAliasWorkForUniqueKeys) {
@@ -82,6 +91,181 @@ TEST(ConcurrentSkipList, UnsafeEraseAndSizeQueriesReflectContainerState) {
     EXPECT_EQ(list.size(), 0u);
 }
 
+TEST(ConcurrentSkipList, EraseRemovesKeysOnce) {
+    SAK::ConcurrentSkipList<int, int> list;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(list.insert({i, i * 10}).second);
+    }
+
+    EXPECT_EQ(list.erase(40), 1u);
+    EXPECT_EQ(list.erase(40), 0u);
+    EXPECT_EQ(list.erase(1000), 0u);
+    EXPECT_FALSE(list.contains(40));
+    EXPECT_EQ(list.find(40), list.end());
+    EXPECT_EQ(list.lower_bound(40)->first, 41);
+    EXPECT_EQ(list.upper_bound(39)->first, 41);
+    EXPECT_EQ(list.size(), 99u);
+
+    // The key can come back
+    EXPECT_TRUE(list.insert({40, 1}).second);
+    EXPECT_EQ(list.find(40)->second, 1);
+
+    for (int i = 0; i < 100; i += 2) {
+        EXPECT_EQ(list.erase(i), 1u);
+    }
+    int expected = 1;
+    for (const auto& entry : list) {
+        EXPECT_EQ(entry.first, expected);
+        expected += 2;
+    }
+    EXPECT_EQ(expected, 101);
+    EXPECT_EQ(list.size(), 50u);
+}
+
+TEST(ConcurrentSkipList, IteratorsKeepErasedElementsAlive) {
+    SAK::ConcurrentSkipList<int, std::string> list;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(list.insert({i, std::string(64, static_cast<char>('a' + i))}).second);
+    }
+
+    auto it = list.find(5);
+    auto copy = it;
+    EXPECT_EQ(list.erase(5), 1u);
+    EXPECT_EQ(list.erase(6), 1u);
+    EXPECT_EQ(it->second, std::string(64, 'f'));
+    // Steps over the erased successor
+    ++it;
+    EXPECT_EQ(it->first, 7);
+    EXPECT_EQ(copy->first, 5);
+}
+
+TEST(ConcurrentSkipList, OneThreadHoldsMoreIteratorsThanPinSlots) {
+    using List = SAK::ConcurrentSkipList<int, int>;
+    List list;
+    List other;
+    const int count = static_cast<int>(SAK::epoch_domain::SLOTS) + 72;
+    std::vector<List::iterator> its;
+    for (int i = 0; i < count; ++i) {
+        its.push_back(list.insert({i, i}).first);
+        its.push_back(other.insert({i, -i}).first);
+    }
+    // Operations still pin while all of those are held
+    EXPECT_EQ(list.erase(0), 1u);
+    EXPECT_EQ(list.find(count - 1)->second, count - 1);
+    std::thread reader([&]() { EXPECT_EQ(other.find(1)->second, -1); });
+    reader.join();
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(its[2 * i]->second, i);
+        EXPECT_EQ(its[2 * i + 1]->second, -i);
+    }
+}
+
+TEST(ConcurrentSkipList, ErasedNodesAreFreedOnceUnreachable) {
+    SAK::ConcurrentSkipList<int, int> list;
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(list.insert({i, i}).second);
+    }
+    std::size_t used = list.memory_usage();
+
+    {
+        auto pinned = list.begin();
+        for (int i = 0; i < 1000; i += 2) {
+            ASSERT_EQ(list.erase(i), 1u);
+        }
+        // begin() still points at key 0, so nothing may go yet
+        EXPECT_EQ(pinned->first, 0);
+        EXPECT_EQ(list.memory_usage(), used);
+    }
+
+    for (int i = 1; i < 1000; i += 2) {
+        ASSERT_EQ(list.erase(i), 1u);
+    }
+    EXPECT_TRUE(list.empty());
+    EXPECT_LT(list.memory_usage(), used / 2);
+    list.unsafe_clear();
+    EXPECT_EQ(list.memory_usage(), 0u);
+}
+
+TEST(ConcurrentSkipList, ConcurrentEraseInsertAndIteration) {
+    SAK::ConcurrentSkipList<int, int> list;
+    constexpr int kKeys = 4000;
+    // Odd keys stay put, even keys are erased and inserted over and over
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(list.insert({i, i}).second);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> erased{0};
+    std::atomic<int> inserted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&, t]() {
+            std::minstd_rand generator(t + 1);
+            for (int round = 0; round < 20000; ++round) {
+                int key = static_cast<int>(generator() % (kKeys / 2)) * 2;
+                if (round % 2 == 0) {
+                    erased.fetch_add(static_cast<int>(list.erase(key)), std::memory_order_relaxed);
+                } else if (list.insert({key, key}).second) {
+                    inserted.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                int previous = -1;
+                int odd = 0;
+                for (const auto& entry : list) {
+                    ASSERT_GT(entry.first, previous);
+                    ASSERT_EQ(entry.second, entry.first);
+                    previous = entry.first;
+                    odd += entry.first % 2;
+                }
+                ASSERT_EQ(odd, kKeys / 2);
+                ASSERT_TRUE(list.contains(kKeys - 1));
+            }
+        });
+    }
+
+    threads[0].join();
+    threads[1].join();
+    stop = true;
+    threads[2].join();
+    threads[3].join();
+
+    std::size_t counted = 0;
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        ++counted;
+    }
+    EXPECT_EQ(list.size(), static_cast<std::size_t>(kKeys - erased.load() + inserted.load()));
+    EXPECT_EQ(counted, list.size());
+}
+
+TEST(ConcurrentSkipList, RacingErasesRemoveAKeyOnce) {
+    SAK::ConcurrentSkipList<int, int> list;
+    constexpr int kKeys = 2000;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(list.insert({i, i}).second);
+    }
+
+    std::atomic<int> erased{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kKeys; ++i) {
+                erased.fetch_add(static_cast<int>(list.erase(i)), std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(erased.load(), kKeys);
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.begin(), list.end());
+}
+
 TEST(ConcurrentSkipList, ConcurrentInsertAndFindSmokeTest) {
     SAK::ConcurrentSkipList<int, int> list;
     constexpr int kThreads = 4;
@@ -115,6 +299,185 @@ TEST(ConcurrentSkipList, ConcurrentInsertAndFindSmokeTest) {
     EXPECT_TRUE(list.contains(kThreads * kItemsPerThread - 1));
 }
 
+TEST(ConcurrentSkipList, MemoryUsageFollowsNodeAllocations) {
+    SAK::ConcurrentSkipList<int, int> list;
+    EXPECT_EQ(list.memory_usage(), 0u);
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(list.insert({i, i}).second);
+    }
+    std::size_t used = list.memory_usage();
+    EXPECT_GE(used, 100 * (sizeof(std::pair<int, int>) + sizeof(void*)));
+
+    // A rejected duplicate gives its node back
+    EXPECT_FALSE(list.insert({5, 5}).second);
+    EXPECT_EQ(list.memory_usage(), used);
+
+    list.unsafe_erase(5);
+    EXPECT_LT(list.memory_usage(), used);
+    list.unsafe_clear();
+    EXPECT_EQ(list.memory_usage(), 0u);
+}
+
+TEST(ConcurrentSkipList, ArenaNodesAreReleasedWithTheArena) {
+    using Allocator = SAK::ArenaAllocator<std::pair<const int, int>, SAK::ConcurrentArena>;
+    SAK::ConcurrentArena arena(4096);
+    SAK::ConcurrentSkipList<int, int, std::less<int>, Allocator> list{std::less<int>(), Allocator(arena)};
+    constexpr int kThreads = 4;
+    constexpr int kItemsPerThread = 500;
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < kThreads; ++thread_index) {
+        threads.emplace_back([&list, thread_index]() {
+            for (int i = 0; i < kItemsPerThread; ++i) {
+                list.insert({thread_index * kItemsPerThread + i, i});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(list.size(), static_cast<std::size_t>(kThreads * kItemsPerThread));
+    int expected = 0;
+    for (const auto& entry : list) {
+        EXPECT_EQ(entry.first, expected++);
+    }
+    // Every node byte came out of the arena, which holds nothing else
+    EXPECT_GT(list.memory_usage(), 0u);
+    EXPECT_LE(list.memory_usage(), arena.BytesUsed());
+    EXPECT_GE(arena.BytesReserved(), arena.BytesUsed());
+
+    // Nodes are not handed back individually
+    std::size_t used = list.memory_usage();
+    list.unsafe_erase(0);
+    EXPECT_EQ(list.memory_usage(), used);
+    list.unsafe_clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.begin(), list.end());
+}
+
+TEST(ConcurrentSkipList, ArenaClearStillDestroysElements) {
+    using Value = std::shared_ptr<int>;
+    using Allocator = SAK::ArenaAllocator<std::pair<const int, Value>, SAK::Arena>;
+    SAK::Arena arena;
+    auto shared = std::make_shared<int>(7);
+    {
+        SAK::ConcurrentSkipList<int, Value, std::less<int>, Allocator> list{std::less<int>(), Allocator(arena)};
+        for (int i = 0; i < 10; ++i) {
+            list.insert({i, shared});
+        }
+        EXPECT_EQ(shared.use_count(), 11);
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(ConcurrentSkipList, InsertBatchHandlesSortedDuplicateAndUnsortedInput) {
+    SAK::ConcurrentSkipList<int, int> list;
+    std::vector<std::pair<int, int>> sorted;
+    for (int i = 0; i < 1000; i += 2) {
+        sorted.emplace_back(i, i * 10);
+    }
+    EXPECT_EQ(list.insert_batch(sorted), sorted.size());
+
+    // Interleaved with what is there, with repeats of new and old keys
+    std::vector<std::pair<int, int>> mixed = {{-1, 0}, {1, 0}, {1, 1}, {2, -2}, {3, 0}, {998, 0}, {999, 0}, {1500, 0}};
+    EXPECT_EQ(list.insert_batch(mixed.begin(), mixed.end()), 5u);
+    EXPECT_EQ(list.find(1)->second, 0);
+    EXPECT_EQ(list.find(2)->second, 20);
+
+    std::vector<std::pair<int, int>> unsorted = {{7, 7}, {5, 5}, {1001, 1}, {-5, 5}, {9, 9}};
+    EXPECT_EQ(list.insert_batch(unsorted), unsorted.size());
+
+    std::map<int, int> expected(sorted.begin(), sorted.end());
+    expected.insert(mixed.begin(), mixed.end());
+    expected.insert(unsorted.begin(), unsorted.end());
+    ASSERT_EQ(list.size(), expected.size());
+    EXPECT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end(),
+                           [](const auto& a, const auto& b) { return a.first == b.first && a.second == b.second; }));
+    for (const auto& entry : expected) {
+        EXPECT_EQ(list.find(entry.first)->second, entry.second);
+    }
+}
+
+TEST(ConcurrentSkipList, ConcurrentInsertBatchesInterleave) {
+    SAK::ConcurrentSkipList<int, int> list;
+    constexpr int kThreads = 4;
+    constexpr int kItemsPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < kThreads; ++thread_index) {
+        threads.emplace_back([&list, thread_index]() {
+            // Strided keys make every batch land between the others' nodes
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < kItemsPerThread; ++i) {
+                batch.emplace_back(i * kThreads + thread_index, thread_index);
+            }
+            for (std::size_t first = 0; first < batch.size(); first += 500) {
+                list.insert_batch(batch.begin() + first, batch.begin() + first + 500);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(list.size(), static_cast<std::size_t>(kThreads * kItemsPerThread));
+    int expected = 0;
+    for (const auto& entry : list) {
+        ASSERT_EQ(entry.first, expected);
+        EXPECT_EQ(entry.second, expected % kThreads);
+        ++expected;
+    }
+    for (int key = 0; key < kThreads * kItemsPerThread; key += 101) {
+        EXPECT_TRUE(list.contains(key));
+    }
+}
+
+TEST(ConcurrentSkipList, LowerBoundWithHintMatchesLowerBound) {
+    SAK::ConcurrentSkipList<int, int> list;
+    for (int i = 0; i < 2000; i += 3) {
+        list.insert({i, i});
+    }
+    auto hint = list.cbegin();
+    for (int key = -1; key < 2010; ++key) {
+        auto found = list.lower_bound(key, hint);
+        ASSERT_EQ(found, list.lower_bound(key)) << key;
+        if (found != list.end()) {
+            hint = found;
+        }
+    }
+    // Unusable hints: past the key, or end()
+    EXPECT_EQ(list.lower_bound(4, list.find(999))->first, 6);
+    EXPECT_EQ(list.lower_bound(4, list.cend())->first, 6);
+}
+
+TEST(ConcurrentSkipList, SortedBulkLoadBenchmark) {
+    constexpr int kItems = 200000;
+    std::vector<std::pair<int, int>> sorted;
+    sorted.reserve(kItems);
+    for (int i = 0; i < kItems; ++i) {
+        sorted.emplace_back(i, i);
+    }
+
+    auto time = [](auto&& load) {
+        auto start = std::chrono::steady_clock::now();
+        load();
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+    SAK::ConcurrentSkipList<int, int> one_by_one;
+    auto emplace_us = time([&]() {
+        for (const auto& entry : sorted) {
+            one_by_one.insert(entry);
+        }
+    });
+    SAK::ConcurrentSkipList<int, int> batched;
+    auto batch_us = time([&]() { batched.insert_batch(sorted); });
+
+    std::cout << "sorted load of " << kItems << " keys: insert " << emplace_us << " us, insert_batch "
+              << batch_us << " us" << std::endl;
+    EXPECT_EQ(one_by_one.size(), batched.size());
+    EXPECT_TRUE(std::equal(one_by_one.begin(), one_by_one.end(), batched.begin(), batched.end()));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
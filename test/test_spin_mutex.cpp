@@ -0,0 +1,198 @@
+#include "util/spin_mutex.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Increments a plain counter under `m` from several threads
+template<typename Mutex>
+uint64_t hammer(Mutex& m, int threads, int iterations) {
+    uint64_t counter = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                typename Mutex::scoped_lock lock(m);
+                ++counter;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return counter;
+}
+
+} // namespace
+
+TEST(SpinMutex, ProvidesMutualExclusion) {
+    SAK::spin_mutex m;
+    EXPECT_EQ(hammer(m, 4, 20000), 80000u);
+
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+    m.unlock();
+}
+
+TEST(SpinMutex, CountsContention) {
+    SAK::basic_spin_mutex<SAK::lock_stats> m;
+    EXPECT_EQ(hammer(m, 4, 5000), 20000u);
+
+    SAK::lock_counters counters = m.counters();
+    EXPECT_EQ(counters.acquisitions, 20000u);
+    EXPECT_LE(counters.contended, counters.acquisitions);
+    EXPECT_GE(counters.spins, counters.contended);
+
+    m.reset_counters();
+    EXPECT_EQ(m.counters().acquisitions, 0u);
+
+    // The default policy records nothing
+    SAK::spin_mutex plain;
+    plain.lock();
+    plain.unlock();
+    EXPECT_EQ(plain.counters().acquisitions, 0u);
+}
+
+TEST(TicketMutex, ProvidesMutualExclusion) {
+    SAK::ticket_mutex m;
+    EXPECT_EQ(hammer(m, 4, 20000), 80000u);
+    EXPECT_TRUE(SAK::ticket_mutex::is_fair_mutex);
+}
+
+TEST(TicketMutex, TryLockFailsWhileHeldOrQueued) {
+    SAK::ticket_mutex m;
+    ASSERT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&]() {
+        m.lock();
+        acquired = true;
+        m.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(acquired.load());
+
+    m.unlock();
+    waiter.join();
+    EXPECT_TRUE(acquired.load());
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(TicketMutex, GrantsTheLockInArrivalOrder) {
+    SAK::ticket_mutex m;
+    std::vector<int> order;
+    m.lock();
+
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; ++i) {
+        waiters.emplace_back([&, i]() {
+            m.lock();
+            order.push_back(i);
+            m.unlock();
+        });
+        // Let waiter i take its ticket before starting the next one
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    m.unlock();
+    for (auto& waiter : waiters) {
+        waiter.join();
+    }
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(SpinRWMutex, WritersExcludeReaders) {
+    SAK::spin_rw_mutex m;
+    EXPECT_EQ(hammer(m, 4, 10000), 40000u);
+
+    std::atomic<int> readers{0};
+    std::atomic<int> writers{0};
+    std::atomic<bool> violation{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 5000; ++i) {
+                bool write = (i + t) % 4 == 0;
+                SAK::spin_rw_mutex::scoped_lock lock(m, write);
+                if (write) {
+                    if (writers.fetch_add(1) != 0 || readers.load() != 0) {
+                        violation = true;
+                    }
+                    writers.fetch_sub(1);
+                } else {
+                    readers.fetch_add(1);
+                    if (writers.load() != 0) {
+                        violation = true;
+                    }
+                    readers.fetch_sub(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(violation.load());
+}
+
+TEST(SpinRWMutex, ReadersShareTheLock) {
+    SAK::spin_rw_mutex m;
+    ASSERT_TRUE(m.try_lock_shared());
+    EXPECT_TRUE(m.try_lock_shared());
+    EXPECT_FALSE(m.try_lock());
+    m.unlock_shared();
+    m.unlock_shared();
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock_shared());
+    m.unlock();
+}
+
+TEST(SpinRWMutex, PendingWriterBlocksNewReaders) {
+    SAK::spin_rw_mutex m;
+    m.lock_shared();
+
+    std::atomic<bool> written{false};
+    std::thread writer([&]() {
+        m.lock();
+        written = true;
+        m.unlock();
+    });
+    // Wait until the writer has announced itself
+    while (m.try_lock_shared()) {
+        m.unlock_shared();
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(written.load());
+
+    m.unlock_shared();
+    writer.join();
+    EXPECT_TRUE(written.load());
+}
+
+TEST(SpinRWMutex, UpgradeAndDowngrade) {
+    SAK::spin_rw_mutex m;
+    SAK::spin_rw_mutex::scoped_lock lock(m, false);
+    EXPECT_FALSE(lock.IsWriter());
+
+    // Sole reader: the upgrade happens in place
+    EXPECT_TRUE(lock.UpgradeToWriter());
+    EXPECT_TRUE(lock.IsWriter());
+    EXPECT_FALSE(m.try_lock_shared());
+
+    lock.DowngradeToReader();
+    EXPECT_FALSE(lock.IsWriter());
+    EXPECT_TRUE(m.try_lock_shared());
+    m.unlock_shared();
+    EXPECT_FALSE(m.try_lock());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,401 @@
+#include "util/sstable.hpp"
+#include "util/block.hpp"
+#include "util/bloom.hpp"
+#include "util/crc32c.hpp"
+#include "util/thread_pool.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using SAK::Block;
+using SAK::BlockBuilder;
+using SAK::BlockIterator;
+using SAK::ByteBuffer;
+using SAK::Options;
+using SAK::SsTable;
+using SAK::SsTableBuilder;
+using SAK::SsTableIterator;
+
+namespace {
+
+ByteBuffer B(const std::string& s) {
+    return ByteBuffer(s);
+}
+
+std::string KeyOf(int i) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "user%06d", i);
+    return key;
+}
+
+class SsTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (fs::temp_directory_path() / ("sak_sst_test_" + std::to_string(getpid()) + ".sst")).string();
+        options_.block_size = 512;
+    }
+
+    void TearDown() override {
+        fs::remove(path_);
+    }
+
+    // Keys 0, 2, 4, ... each with versions at ts 3 and 1; a tombstone at ts 2 for multiples of 10
+    std::shared_ptr<SsTable> BuildTable(int keys) {
+        SsTableBuilder builder(options_);
+        for (int i = 0; i < keys * 2; i += 2) {
+            builder.Add(B(KeyOf(i)), 3, B("v3-" + std::to_string(i)));
+            if (i % 10 == 0) {
+                builder.Add(B(KeyOf(i)), 2, ByteBuffer());
+            }
+            builder.Add(B(KeyOf(i)), 1, B("v1-" + std::to_string(i)));
+        }
+        return builder.Build(7, path_);
+    }
+
+    std::string path_;
+    Options options_;
+};
+
+} // namespace
+
+TEST(Block, PrefixCompressesAndSeeksThroughRestarts) {
+    BlockBuilder builder(4);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 50; ++i) {
+        keys.push_back(KeyOf(i * 3));
+        builder.Add(B(keys.back()), 10, B(std::to_string(i)));
+    }
+    size_t raw = 0;
+    for (const auto& key : keys) {
+        raw += key.size();
+    }
+    std::vector<uint8_t> bytes = builder.Finish();
+    // Keys share most of their bytes
+    EXPECT_LT(bytes.size(), raw + 50 * (8 + 3 + 2));
+
+    auto block = Block::Decode(ByteBuffer(bytes));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->NumRestarts(), 13u);
+
+    BlockIterator it(block);
+    for (int i = 0; i < 50; ++i, it.Next()) {
+        ASSERT_TRUE(it.Valid());
+        EXPECT_EQ(it.Key().ToString(), keys[i]);
+        EXPECT_EQ(it.Timestamp(), 10u);
+        EXPECT_EQ(it.Value().ToString(), std::to_string(i));
+    }
+    EXPECT_FALSE(it.Valid());
+    EXPECT_FALSE(it.Corrupted());
+
+    for (int probe = -1; probe < 152; ++probe) {
+        it.Seek(B(KeyOf(probe)), 10);
+        int expected = probe < 0 ? 0 : (probe + 2) / 3;
+        if (expected >= 50) {
+            EXPECT_FALSE(it.Valid()) << probe;
+        } else {
+            ASSERT_TRUE(it.Valid()) << probe;
+            EXPECT_EQ(it.Key().ToString(), keys[expected]) << probe;
+        }
+    }
+    // An older timestamp for the same key sorts after it
+    it.Seek(B(keys[5]), 9);
+    EXPECT_EQ(it.Key().ToString(), keys[6]);
+}
+
+TEST(Block, RejectsMalformedBytes) {
+    EXPECT_EQ(Block::Decode(ByteBuffer()), nullptr);
+    std::vector<uint8_t> bad = {1, 2, 3, 0xFF, 0xFF, 0, 0};
+    EXPECT_EQ(Block::Decode(ByteBuffer(bad)), nullptr);
+
+    BlockBuilder builder;
+    builder.Add(B("a"), 1, B("x"));
+    builder.Add(B("ab"), 1, B("y"));
+    std::vector<uint8_t> bytes = builder.Finish();
+    bytes[1] = 0x7F;  // Unshared length beyond the entries
+    auto block = Block::Decode(ByteBuffer(bytes));
+    ASSERT_NE(block, nullptr);
+    BlockIterator it(block);
+    EXPECT_FALSE(it.Valid());
+    EXPECT_TRUE(it.Corrupted());
+}
+
+TEST(BloomFilter, NoFalseNegativesAndFewFalsePositives) {
+    SAK::BloomFilterBuilder builder(10);
+    for (int i = 0; i < 10000; ++i) {
+        builder.AddKey(B(KeyOf(i)));
+        builder.AddKey(B(KeyOf(i)));  // Versions of one key count once
+    }
+    EXPECT_EQ(builder.NumKeys(), 10000u);
+    SAK::BloomFilter filter(ByteBuffer(builder.Finish()));
+    ASSERT_TRUE(filter.Valid());
+    EXPECT_EQ(filter.NumBlocks(), (10000u * 10 + 255) / 256);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(filter.MayContain(B(KeyOf(i)))) << i;
+    }
+    int false_positives = 0;
+    for (int i = 10000; i < 110000; ++i) {
+        false_positives += filter.MayContain(B(KeyOf(i)));
+    }
+    EXPECT_LT(false_positives, 2000);  // Under 2%
+
+    // Damaged or missing filters rule nothing out
+    EXPECT_TRUE(SAK::BloomFilter().MayContain(B("x")));
+    EXPECT_FALSE(SAK::BloomFilter(B("short")).Valid());
+    EXPECT_TRUE(builder.Finish().empty());
+
+    // Filters from before the hash changed place keys elsewhere
+    builder.AddKey(B("x"));
+    std::vector<uint8_t> old_format = builder.Finish();
+    old_format.back() = 1;
+    SAK::BloomFilter stale{ByteBuffer(old_format)};
+    EXPECT_FALSE(stale.Valid());
+    EXPECT_TRUE(stale.MayContain(B("y")));
+}
+
+TEST_F(SsTableTest, FilterSkipsBlocksForAbsentKeys) {
+    auto cache = std::make_shared<SAK::BlockCache>(1 << 20, 0);
+    SsTableBuilder builder(options_);
+    for (int i = 0; i < 2000; i += 2) {
+        builder.Add(B(KeyOf(i)), 2, B("v"));
+        builder.Add(B(KeyOf(i)), 1, B("w"));
+    }
+    auto table = builder.Build(3, path_, cache);
+    ASSERT_NE(table, nullptr);
+    ASSERT_TRUE(table->HasFilter());
+    for (int i = 0; i < 2000; i += 2) {
+        ASSERT_EQ(table->Get(B(KeyOf(i)), 1)->ToString(), "w");
+    }
+    uint64_t reads = cache->Hits() + cache->Misses();
+    for (int i = 1; i < 2000; i += 2) {
+        EXPECT_FALSE(table->Get(B(KeyOf(i)), 2).has_value());
+    }
+    EXPECT_LT(cache->Hits() + cache->Misses() - reads, 30u);
+
+    options_.bloom_bits_per_key = 0;
+    SsTableBuilder unfiltered(options_);
+    unfiltered.Add(B("a"), 1, B("b"));
+    table = unfiltered.Build(4, path_);
+    ASSERT_NE(table, nullptr);
+    EXPECT_FALSE(table->HasFilter());
+    EXPECT_EQ(table->Get(B("a"), 1)->ToString(), "b");
+}
+
+TEST_F(SsTableTest, BuildsBlocksAndIndex) {
+    auto table = BuildTable(300);
+    ASSERT_NE(table, nullptr);
+    EXPECT_EQ(table->Id(), 7u);
+    EXPECT_GT(table->NumBlocks(), 10u);
+    EXPECT_EQ(table->FileSize(), fs::file_size(path_));
+    EXPECT_EQ(table->FirstKey().ToString(), KeyOf(0));
+    EXPECT_EQ(table->LastKey().ToString(), KeyOf(598));
+    for (size_t i = 0; i < table->NumBlocks(); ++i) {
+        EXPECT_LE(table->Meta(i).size, options_.block_size);
+        ASSERT_NE(table->ReadBlock(i), nullptr);
+    }
+
+    // Reopening needs only the file
+    auto reopened = SsTable::Open(8, SAK::FileObject::Open(path_));
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_EQ(reopened->NumBlocks(), table->NumBlocks());
+}
+
+TEST_F(SsTableTest, GetHonoursReadTimestampAndTombstones) {
+    auto table = BuildTable(300);
+    ASSERT_NE(table, nullptr);
+    EXPECT_EQ(table->Get(B(KeyOf(4)), 3)->ToString(), "v3-4");
+    EXPECT_EQ(table->Get(B(KeyOf(4)), 100)->ToString(), "v3-4");
+    EXPECT_EQ(table->Get(B(KeyOf(4)), 2)->ToString(), "v1-4");
+    EXPECT_FALSE(table->Get(B(KeyOf(4)), 0).has_value());
+    EXPECT_TRUE(table->Get(B(KeyOf(20)), 2)->Empty());
+    EXPECT_EQ(table->Get(B(KeyOf(20)), 1)->ToString(), "v1-20");
+    EXPECT_FALSE(table->Get(B(KeyOf(5)), 3).has_value());
+    EXPECT_FALSE(table->Get(B(KeyOf(999)), 3).has_value());
+    EXPECT_FALSE(table->Get(B(""), 3).has_value());
+}
+
+TEST_F(SsTableTest, IteratorVisitsEveryVersionInOrder) {
+    auto table = BuildTable(300);
+    ASSERT_NE(table, nullptr);
+    SsTableIterator it(table);
+    size_t count = 0;
+    std::string previous_key;
+    uint64_t previous_ts = 0;
+    for (; it.Valid(); it.Next(), ++count) {
+        std::string key = it.Key().ToString();
+        if (key == previous_key) {
+            EXPECT_LT(it.Timestamp(), previous_ts);
+        } else {
+            EXPECT_LT(previous_key, key);
+        }
+        previous_key = key;
+        previous_ts = it.Timestamp();
+    }
+    EXPECT_FALSE(it.Corrupted());
+    EXPECT_EQ(count, 300u * 2 + 60u);
+
+    it.Seek(B(KeyOf(101)), 3);
+    ASSERT_TRUE(it.Valid());
+    EXPECT_EQ(it.Key().ToString(), KeyOf(102));
+    // Across a block boundary: the last entry of some block, then the next block
+    const auto& meta = table->Meta(3);
+    it.Seek(meta.last_key, meta.last_ts);
+    ASSERT_TRUE(it.Valid());
+    it.Next();
+    ASSERT_TRUE(it.Valid());
+    EXPECT_EQ(it.Key(), table->Meta(4).first_key);
+    it.Seek(B("zzz"), 0);
+    EXPECT_FALSE(it.Valid());
+}
+
+TEST_F(SsTableTest, ChecksumsCatchDamage) {
+    ASSERT_NE(BuildTable(300), nullptr);
+    auto table = SsTable::Open(1, SAK::FileObject::Open(path_));
+    ASSERT_NE(table, nullptr);
+    uint64_t offset = table->Meta(2).offset + 10;
+    table.reset();
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put('\x42');
+    }
+    table = SsTable::Open(1, SAK::FileObject::Open(path_));
+    ASSERT_NE(table, nullptr);
+    EXPECT_NE(table->ReadBlock(1), nullptr);
+    EXPECT_EQ(table->ReadBlock(2), nullptr);
+
+    {
+        SsTableIterator it(table);
+        while (it.Valid()) {
+            it.Next();
+        }
+        EXPECT_TRUE(it.Corrupted());
+    }
+
+    // A damaged footer or index fails Open; drop the mapping before truncating
+    table.reset();
+    fs::resize_file(path_, fs::file_size(path_) - 1);
+    EXPECT_EQ(SsTable::Open(1, SAK::FileObject::Open(path_)), nullptr);
+    SsTableBuilder empty(options_);
+    EXPECT_EQ(empty.Build(2, path_), nullptr);
+}
+
+TEST_F(SsTableTest, FileObjectMapsAndReadsIntoCallerBuffers) {
+    std::vector<uint8_t> data(3 * 4096 + 17);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    SAK::ByteBuffer view;
+    {
+        SAK::FileObject file = SAK::FileObject::Create(path_, data);
+        ASSERT_TRUE(file.Valid());
+        view = file.Map(SAK::AccessHint::Random);
+        ASSERT_EQ(view.Size(), data.size());
+        // One mapping shared by every view
+        EXPECT_EQ(file.Map(SAK::AccessHint::Sequential).Data(), view.Data());
+        file.Advise(SAK::AccessHint::WillNeed, 5000, 100);
+
+        uint8_t buf[64];
+        ASSERT_TRUE(file.ReadInto(4090, buf, sizeof(buf)));
+        EXPECT_EQ(std::memcmp(buf, data.data() + 4090, sizeof(buf)), 0);
+        EXPECT_FALSE(file.ReadInto(data.size() - 10, buf, sizeof(buf)));
+        EXPECT_TRUE(file.Read(data.size() - 10, 64).empty());
+    }
+    // The view outlives the FileObject
+    EXPECT_EQ(std::memcmp(view.Data(), data.data(), data.size()), 0);
+    EXPECT_EQ(view.Slice(12288, 17).CopyToBytes(), std::vector<uint8_t>(data.end() - 17, data.end()));
+
+    SAK::FileObject empty = SAK::FileObject::Create(path_, {});
+    EXPECT_TRUE(empty.Map().Empty());
+    EXPECT_TRUE(SAK::FileObject().Map().Empty());
+}
+
+namespace {
+
+std::vector<uint8_t> PatternBytes(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<uint8_t>(i * 131 + i / 4096);
+    }
+    return data;
+}
+
+// Appends `data` in uneven chunks, not lined up with the blocks
+void AppendInChunks(SAK::FileWriter& writer, const std::vector<uint8_t>& data) {
+    size_t pos = 0;
+    for (size_t chunk = 1; pos < data.size(); chunk = chunk * 7 % 10007 + 1) {
+        size_t take = std::min(chunk, data.size() - pos);
+        ASSERT_TRUE(writer.Append(data.data() + pos, take));
+        pos += take;
+    }
+}
+
+} // namespace
+
+TEST_F(SsTableTest, FileWriterStreamsBlocksWithChecksums) {
+    std::vector<uint8_t> data = PatternBytes(5 * 4096 + 123);
+    SAK::FileWriterOptions options;
+    options.block_size = 4096;
+    options.preallocate = 8192;
+    SAK::FileWriter writer(path_, options);
+    ASSERT_TRUE(writer.Valid());
+    AppendInChunks(writer, data);
+    EXPECT_EQ(writer.Size(), data.size());
+
+    SAK::FileObject file = writer.Finish();
+    ASSERT_TRUE(file.Valid());
+    // Neither the padded tail nor the reservation shows
+    ASSERT_EQ(file.Size(), data.size());
+    EXPECT_EQ(file.Read(0, data.size()), data);
+
+    std::vector<uint32_t> checksums = writer.BlockChecksums();
+    ASSERT_EQ(checksums.size(), 6u);
+    for (size_t i = 0; i < checksums.size(); ++i) {
+        size_t length = std::min<size_t>(4096, data.size() - i * 4096);
+        EXPECT_EQ(checksums[i], SAK::Crc32c::Compute(data.data() + i * 4096, length)) << i;
+    }
+    EXPECT_EQ(writer.Checksum(), SAK::Crc32c::Compute(data));
+    EXPECT_FALSE(writer.Append(data.data(), 1));
+    EXPECT_FALSE(writer.Finish().Valid());
+}
+
+TEST_F(SsTableTest, FileWriterOverlapsWritesOnAPool) {
+    std::vector<uint8_t> data = PatternBytes(3 * 1024 * 1024 + 4097);
+    SAK::thread::ThreadPool pool(3);
+    SAK::FileWriterOptions options;
+    options.block_size = 64 * 1024;
+    options.buffers = 3;
+    options.pool = &pool;
+    SAK::FileWriter writer(path_, options);
+    AppendInChunks(writer, data);
+    SAK::FileObject file = writer.Finish();
+    ASSERT_TRUE(file.Valid());
+    ASSERT_EQ(file.Size(), data.size());
+    EXPECT_EQ(file.Read(0, data.size()), data);
+    EXPECT_EQ(writer.BlockChecksums().size(), 49u);
+    EXPECT_EQ(writer.Checksum(), SAK::Crc32c::Compute(data));
+}
+
+TEST_F(SsTableTest, FileWriterHandlesEmptyFilesAndOpenFailures) {
+    SAK::FileWriter empty(path_);
+    SAK::FileObject file = empty.Finish();
+    ASSERT_TRUE(file.Valid());
+    EXPECT_EQ(file.Size(), 0u);
+    EXPECT_EQ(empty.Checksum(), 0u);
+
+    SAK::FileWriter missing((fs::temp_directory_path() / "sak_no_such_dir" / "file").string());
+    EXPECT_FALSE(missing.Valid());
+    EXPECT_FALSE(missing.Append("x", 1));
+    EXPECT_FALSE(missing.Finish().Valid());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
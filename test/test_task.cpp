@@ -0,0 +1,176 @@
+#include "util/task.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Task, ThenChainsResultsWithoutBlocking) {
+    SAK::thread::ThreadPool pool(4);
+
+    auto task = SAK::spawn_task(pool, [](int a, int b) { return a + b; }, 2, 3)
+                    .then([](const int& sum) { return sum * 10; })
+                    .then([](const int& value) { return std::to_string(value); });
+
+    EXPECT_EQ(task.get(), "50");
+    EXPECT_TRUE(task.is_ready());
+}
+
+TEST(Task, VoidTasksAndContinuationsAttachedAfterCompletion) {
+    SAK::thread::ThreadPool pool(2);
+    std::atomic<int> steps{0};
+
+    auto first = SAK::spawn_task(pool, [&]() { steps.fetch_add(1); });
+    first.wait();
+    // Attaching to a completed task still schedules the continuation
+    auto second = first.then([&]() {
+        steps.fetch_add(1);
+        return 7;
+    });
+
+    EXPECT_EQ(second.get(), 7);
+    EXPECT_EQ(steps.load(), 2);
+}
+
+TEST(Task, ExceptionsSkipContinuationsAndPropagate) {
+    SAK::thread::ThreadPool pool(2);
+    std::atomic<bool> continuation_ran{false};
+
+    auto failing = SAK::spawn_task(pool, []() -> int { throw std::runtime_error("boom"); })
+                       .then([&](const int& value) {
+                           continuation_ran = true;
+                           return value;
+                       });
+
+    EXPECT_THROW(failing.get(), std::runtime_error);
+    EXPECT_FALSE(continuation_ran.load());
+
+    auto throwing_continuation = SAK::spawn_task(pool, []() { return 1; })
+                                     .then([](const int&) -> int { throw std::logic_error("bad"); });
+    EXPECT_THROW(throwing_continuation.get(), std::logic_error);
+}
+
+TEST(Task, WhenAllCollectsValuesInInputOrder) {
+    SAK::thread::ThreadPool pool(4);
+    std::vector<SAK::Task<int>> tasks;
+    for (int i = 0; i < 32; ++i) {
+        tasks.push_back(SAK::spawn_task(pool, [i]() {
+            std::this_thread::sleep_for(std::chrono::microseconds((32 - i) * 20));
+            return i * i;
+        }));
+    }
+
+    auto all = SAK::when_all(tasks).then([](const std::vector<int>& values) {
+        int total = 0;
+        for (int value : values) {
+            total += value;
+        }
+        return total;
+    });
+
+    auto values = SAK::when_all(tasks).get();
+    ASSERT_EQ(values.size(), 32u);
+    for (int i = 0; i < 32; ++i) {
+        EXPECT_EQ(values[static_cast<size_t>(i)], i * i);
+    }
+    EXPECT_EQ(all.get(), 10416);
+
+    EXPECT_TRUE(SAK::when_all(std::vector<SAK::Task<int>>()).get().empty());
+}
+
+TEST(Task, WhenAllFailsWithFirstFailedInput) {
+    SAK::thread::ThreadPool pool(2);
+    std::vector<SAK::Task<void>> tasks;
+    tasks.push_back(SAK::spawn_task(pool, []() {}));
+    tasks.push_back(SAK::spawn_task(pool, []() { throw std::runtime_error("second"); }));
+    tasks.push_back(SAK::spawn_task(pool, []() {}));
+
+    EXPECT_THROW(SAK::when_all(tasks).get(), std::runtime_error);
+}
+
+TEST(Task, WhenAnyReportsTheFirstTaskToFinish) {
+    SAK::thread::ThreadPool pool(2);
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+
+    std::vector<SAK::Task<int>> tasks;
+    tasks.push_back(SAK::spawn_task(pool, [gate]() {
+        gate.wait();
+        return 1;
+    }));
+    tasks.push_back(SAK::spawn_task(pool, []() { return 2; }));
+
+    auto first = SAK::when_any(tasks);
+    EXPECT_EQ(first.get(), 1u);
+    EXPECT_EQ(tasks[first.get()].get(), 2);
+
+    release.set_value();
+    EXPECT_EQ(tasks[0].get(), 1);
+    EXPECT_THROW(SAK::when_any(std::vector<SAK::Task<int>>()), std::invalid_argument);
+}
+
+TEST(TaskGraph, RunsNodesAfterAllPredecessors) {
+    SAK::thread::ThreadPool pool(4);
+    SAK::TaskGraph graph;
+    std::mutex order_mutex;
+    std::vector<char> order;
+    auto record = [&](char tag) {
+        return [&, tag]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(tag);
+        };
+    };
+
+    // a -> {b, c} -> d
+    auto a = graph.add(record('a'));
+    auto b = graph.add(record('b'));
+    auto c = graph.add(record('c'));
+    auto d = graph.add(record('d'));
+    graph.precede(a, b);
+    graph.precede(a, c);
+    graph.precede(b, d);
+    graph.precede(c, d);
+
+    for (int run = 0; run < 20; ++run) {
+        order.clear();
+        graph.run(pool).get();
+        ASSERT_EQ(order.size(), 4u);
+        EXPECT_EQ(order.front(), 'a');
+        EXPECT_EQ(order.back(), 'd');
+    }
+    EXPECT_EQ(graph.size(), 4u);
+}
+
+TEST(TaskGraph, FailuresSkipPendingNodesAndCyclesAreRejected) {
+    SAK::thread::ThreadPool pool(2);
+    std::atomic<bool> dependent_ran{false};
+
+    SAK::TaskGraph graph;
+    auto failing = graph.add([]() { throw std::runtime_error("stage failed"); });
+    auto dependent = graph.add([&]() { dependent_ran = true; });
+    graph.precede(failing, dependent);
+
+    EXPECT_THROW(graph.run(pool).get(), std::runtime_error);
+    EXPECT_FALSE(dependent_ran.load());
+
+    SAK::TaskGraph cyclic;
+    auto x = cyclic.add([]() {});
+    auto y = cyclic.add([]() {});
+    cyclic.precede(x, y);
+    cyclic.precede(y, x);
+    EXPECT_THROW(cyclic.run(pool), std::invalid_argument);
+    EXPECT_THROW(cyclic.precede(x, 5), std::out_of_range);
+
+    // An empty graph completes immediately
+    SAK::TaskGraph empty;
+    EXPECT_NO_THROW(empty.run(pool).get());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
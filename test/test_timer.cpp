@@ -0,0 +1,286 @@
+#include "util/thread_pool.hpp"
+#include "util/timer.hpp"
+#include "util/timing_wheel.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+using SAK::timer::Timer;
+using SAK::timer::TimerBackend;
+using SAK::timer::TimerOptions;
+using SAK::timer::TimingWheel;
+
+namespace {
+
+struct TestNode : TimingWheel::Node {
+    uint64_t wanted = 0;
+    uint64_t fired_at = 0;
+    bool fired = false;
+};
+
+TimerOptions wheel_options(std::chrono::microseconds tick = std::chrono::milliseconds(1)) {
+    TimerOptions options;
+    options.backend = TimerBackend::wheel;
+    options.tick = tick;
+    return options;
+}
+
+template<typename Pred>
+bool wait_for(Pred pred, std::chrono::milliseconds limit = std::chrono::milliseconds(2000)) {
+    auto deadline = std::chrono::steady_clock::now() + limit;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(TimingWheel, ExpiresEveryNodeOnItsTickAcrossLevels) {
+    TimingWheel wheel(1000);
+    std::mt19937_64 rng(42);
+    std::vector<TestNode> nodes(2000);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        // Spread over all levels, including the top one
+        int bits = 1 + static_cast<int>(i % 28);
+        nodes[i].wanted = 1001 + rng() % (uint64_t(1) << bits);
+        wheel.insert(nodes[i], nodes[i].wanted);
+    }
+    EXPECT_EQ(wheel.size(), nodes.size());
+
+    uint64_t last = 0;
+    bool ordered = true;
+    auto on_expired = [&](TimingWheel::Node& node) {
+        auto& test = static_cast<TestNode&>(node);
+        test.fired = true;
+        test.fired_at = wheel.current_tick();
+        ordered = ordered && test.fired_at >= last;
+        last = test.fired_at;
+    };
+    // Uneven steps, each needing the jump-ahead logic at some point
+    for (uint64_t tick = 1000; !wheel.empty(); tick += 1 + tick / 3) {
+        wheel.advance(tick, on_expired);
+    }
+    EXPECT_TRUE(ordered);
+    for (const auto& node : nodes) {
+        ASSERT_TRUE(node.fired);
+        EXPECT_EQ(node.fired_at, node.wanted);
+    }
+}
+
+TEST(TimingWheel, DeadlinesBeyondTheTopLevelStillExpireOnTime) {
+    TimingWheel wheel;
+    TestNode far;
+    uint64_t wanted = (uint64_t(1) << 33) + 77;
+    wheel.insert(far, wanted);
+
+    wheel.advance(wanted - 1, [](TimingWheel::Node&) { FAIL() << "expired early"; });
+    EXPECT_EQ(wheel.size(), 1u);
+    wheel.advance(wanted, [&](TimingWheel::Node& node) {
+        EXPECT_EQ(&node, &far);
+        EXPECT_EQ(wheel.current_tick(), wanted);
+    });
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimingWheel, RemoveAndNextTick) {
+    TimingWheel wheel(10);
+    EXPECT_EQ(wheel.next_tick(), TimingWheel::NO_TICK);
+
+    TestNode soon;
+    TestNode later;
+    TestNode past;
+    wheel.insert(soon, 20);
+    wheel.insert(later, 5000);
+    EXPECT_EQ(wheel.next_tick(), 20u);
+
+    wheel.remove(soon);
+    EXPECT_FALSE(soon.linked);
+    // Only a higher level is occupied: wake up for the cascade
+    EXPECT_EQ(wheel.next_tick(), 256u);
+
+    // A tick in the past is due on the next advance
+    wheel.insert(past, 3);
+    EXPECT_EQ(wheel.next_tick(), 11u);
+
+    std::vector<TimingWheel::Node*> expired;
+    wheel.advance(11, [&](TimingWheel::Node& node) { expired.push_back(&node); });
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0], &past);
+
+    wheel.clear();
+    EXPECT_TRUE(wheel.empty());
+    wheel.advance(10000, [](TimingWheel::Node&) { FAIL() << "cleared node expired"; });
+}
+
+TEST(TimerWheel, OneShotAndPeriodicTimersFire) {
+    Timer timer(wheel_options());
+    EXPECT_EQ(timer.backend(), TimerBackend::wheel);
+
+    std::atomic<int> once{0};
+    std::atomic<int> repeated{0};
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int64_t> once_delay_ms{0};
+    timer.schedule_once(20, [&] {
+        once_delay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        ++once;
+    });
+    Timer::TimerId periodic = timer.schedule_repeated(5, 5, [&] { ++repeated; });
+
+    ASSERT_TRUE(wait_for([&] { return once.load() == 1 && repeated.load() >= 3; }));
+    EXPECT_GE(once_delay_ms.load(), 20);
+    EXPECT_TRUE(timer.cancel(periodic));
+    EXPECT_FALSE(timer.cancel(periodic));
+
+    int after_cancel = repeated.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_LE(repeated.load(), after_cancel + 1);
+    EXPECT_EQ(once.load(), 1);
+    timer.stop();
+}
+
+TEST(TimerWheel, CancelledTimersNeverFireAndIdsAreNotReused) {
+    Timer timer(wheel_options(std::chrono::microseconds(500)));
+    std::atomic<int> fired{0};
+
+    std::vector<Timer::TimerId> ids;
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 200; ++i) {
+            ids.push_back(timer.schedule_once(10 + i % 50, [&] { ++fired; }));
+        }
+        for (size_t i = ids.size() - 200; i < ids.size(); ++i) {
+            EXPECT_TRUE(timer.cancel(ids[i]));
+        }
+    }
+    // Slots are recycled, but every id handed out is distinct
+    std::vector<Timer::TimerId> sorted = ids;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+    EXPECT_FALSE(timer.cancel(ids.front()));
+
+    std::atomic<bool> marker{false};
+    timer.schedule_once(70, [&] { marker = true; });
+    ASSERT_TRUE(wait_for([&] { return marker.load(); }));
+    EXPECT_EQ(fired.load(), 0);
+    timer.stop();
+}
+
+TEST(TimerWheel, PeriodicTimerCanCancelItselfFromItsCallback) {
+    Timer timer(wheel_options());
+    std::atomic<int> runs{0};
+    std::atomic<Timer::TimerId> id{0};
+    id = timer.schedule_repeated(1, 1, [&] {
+        if (++runs == 3) {
+            EXPECT_TRUE(timer.cancel(id.load()));
+        }
+    });
+    ASSERT_TRUE(wait_for([&] { return runs.load() >= 3; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs.load(), 3);
+    timer.stop();
+}
+
+TEST(TimerWheel, StopDropsPendingTimers) {
+    std::atomic<int> fired{0};
+    {
+        Timer timer(wheel_options());
+        for (int i = 0; i < 100; ++i) {
+            timer.schedule_once(1000, [&] { ++fired; });
+        }
+        timer.stop();
+        EXPECT_FALSE(timer.cancel(1));
+    }
+    EXPECT_EQ(fired.load(), 0);
+}
+
+TEST(TimerHeap, OptionsSelectTheHeapByDefault) {
+    Timer timer{TimerOptions()};
+    EXPECT_EQ(timer.backend(), TimerBackend::heap);
+    std::atomic<bool> fired{false};
+    timer.schedule_once(1, [&] { fired = true; });
+    EXPECT_TRUE(wait_for([&] { return fired.load(); }));
+    timer.stop();
+}
+
+TEST(TimerOptions, RejectsANonPositiveTick) {
+    EXPECT_THROW(Timer(wheel_options(std::chrono::microseconds(0))), std::invalid_argument);
+}
+
+TEST(TimerExecutor, SlowCallbacksOnThePoolDoNotDelayOtherTimers) {
+    for (TimerBackend backend : {TimerBackend::heap, TimerBackend::wheel}) {
+        SAK::thread::ThreadPool pool(2);
+        TimerOptions options = wheel_options();
+        options.backend = backend;
+        options.executor = SAK::timer::pool_executor(pool);
+        Timer timer(options);
+
+        std::atomic<bool> slow_started{false};
+        std::atomic<bool> release_slow{false};
+        std::atomic<bool> fast_fired{false};
+        timer.schedule_once(1, [&] {
+            slow_started = true;
+            while (!release_slow.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        ASSERT_TRUE(wait_for([&] { return slow_started.load(); }));
+        timer.schedule_once(2, [&] { fast_fired = true; });
+        // The timer thread is free while the slow callback blocks a worker
+        EXPECT_TRUE(wait_for([&] { return fast_fired.load(); }));
+        release_slow = true;
+
+        ASSERT_TRUE(wait_for([&] { return timer.lateness().count == 2; }));
+        SAK::timer::TimerLateness lateness = timer.lateness();
+        EXPECT_EQ(lateness.count, 2u);
+        EXPECT_LE(lateness.percentile_us(0.5), lateness.max_us);
+        timer.stop();
+    }
+}
+
+TEST(TimerExecutor, TasksTheExecutorLeavesRunOnTheTimerThread) {
+    std::atomic<int> batches{0};
+    TimerOptions options = wheel_options();
+    options.executor = [&](std::vector<SAK::thread::unique_task>&) { ++batches; };
+    Timer timer(options);
+
+    std::atomic<int> fired{0};
+    Timer::TimerId periodic = timer.schedule_repeated(1, 2, [&] { ++fired; });
+    ASSERT_TRUE(wait_for([&] { return fired.load() >= 3; }));
+    timer.cancel(periodic);
+    EXPECT_GE(batches.load(), 3);
+    timer.stop();
+}
+
+TEST(TimerLateness, HistogramBucketsByPowersOfTwo) {
+    Timer timer(wheel_options());
+    std::atomic<int> fired{0};
+    for (int i = 0; i < 20; ++i) {
+        timer.schedule_once(1 + i % 3, [&] { ++fired; });
+    }
+    ASSERT_TRUE(wait_for([&] { return fired.load() == 20; }));
+
+    SAK::timer::TimerLateness lateness = timer.lateness();
+    EXPECT_EQ(lateness.count, 20u);
+    uint64_t total = 0;
+    for (uint64_t bucket : lateness.buckets) {
+        total += bucket;
+    }
+    EXPECT_EQ(total, 20u);
+    EXPECT_GE(lateness.percentile_us(1.0), lateness.percentile_us(0.5));
+    EXPECT_LE(lateness.average_us(), lateness.max_us);
+
+    timer.reset_lateness();
+    EXPECT_EQ(timer.lateness().count, 0u);
+    timer.stop();
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
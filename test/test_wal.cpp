@@ -0,0 +1,206 @@
+#include "util/wal.hpp"
+#include "util/memtable.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using SAK::ByteBuffer;
+using SAK::MemTable;
+using SAK::Options;
+using SAK::WalEntry;
+using SAK::WalReader;
+using SAK::WalSyncPolicy;
+using SAK::WalWriter;
+
+namespace {
+
+ByteBuffer B(const std::string& s) {
+    return ByteBuffer(s);
+}
+
+class WalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (fs::temp_directory_path() / ("sak_wal_test_" + std::to_string(getpid()) + ".log")).string();
+        fs::remove(path_);
+        options_.block_size = 256;
+    }
+
+    void TearDown() override {
+        fs::remove(path_);
+    }
+
+    std::vector<std::string> ReadAll(uint64_t* corrupted = nullptr) {
+        WalReader reader(path_, options_);
+        std::vector<std::string> records;
+        std::vector<uint8_t> record;
+        while (reader.ReadRecord(record)) {
+            records.emplace_back(record.begin(), record.end());
+        }
+        if (corrupted) {
+            *corrupted = reader.CorruptedBytes();
+        }
+        return records;
+    }
+
+    void FlipByte(uint64_t offset) {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char byte = 0;
+        file.get(byte);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put(static_cast<char>(byte ^ 0x5A));
+    }
+
+    std::string path_;
+    Options options_;
+};
+
+} // namespace
+
+TEST_F(WalTest, RecordsSpanBlocksAndPadShortTails) {
+    std::vector<std::string> written;
+    {
+        WalWriter writer(path_, options_);
+        ASSERT_TRUE(writer.Valid());
+        for (size_t size : {0u, 10u, 300u, 2000u, 243u, 1u}) {
+            std::string value(size, static_cast<char>('a' + written.size()));
+            ASSERT_TRUE(writer.Put(B("k" + std::to_string(written.size())), written.size() + 1, B(value)));
+            written.push_back(value);
+        }
+        EXPECT_EQ(writer.FileSize(), fs::file_size(path_));
+    }
+    EXPECT_GT(fs::file_size(path_), 2000u + 300u + 243u);
+
+    MemTable table(0);
+    uint64_t max_ts = 0;
+    EXPECT_EQ(WalReader::Replay(path_, options_, table, &max_ts), written.size());
+    EXPECT_EQ(max_ts, written.size());
+    for (size_t i = 0; i < written.size(); ++i) {
+        auto value = table.Get(B("k" + std::to_string(i)));
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(value->ToString(), written[i]);
+    }
+    EXPECT_TRUE(table.Get(B("k0"))->Empty());
+}
+
+TEST_F(WalTest, ReopenedWriterContinuesTheLastBlock) {
+    {
+        WalWriter writer(path_, options_);
+        writer.Write({WalEntry{B("a"), 1, B("1")}, WalEntry{B("b"), 2, ByteBuffer()}});
+    }
+    {
+        WalWriter writer(path_, options_);
+        writer.Put(B("c"), 3, B(std::string(600, 'c')));
+    }
+    MemTable table(0);
+    EXPECT_EQ(WalReader::Replay(path_, options_, table), 3u);
+    EXPECT_EQ(table.Get(B("a"))->ToString(), "1");
+    EXPECT_TRUE(table.Get(B("b"))->Empty());
+    EXPECT_EQ(table.Get(B("c"))->Size(), 600u);
+}
+
+TEST_F(WalTest, CorruptBlockIsSkippedAndTornTailIgnored) {
+    {
+        WalWriter writer(path_, options_);
+        for (int i = 0; i < 40; ++i) {
+            writer.Put(B("key" + std::to_string(i)), i, B(std::string(50, 'v')));
+        }
+    }
+    ASSERT_EQ(ReadAll().size(), 40u);
+
+    // Damage the second block, then cut the final record short
+    FlipByte(options_.block_size + 20);
+    fs::resize_file(path_, fs::file_size(path_) - 10);
+    uint64_t corrupted = 0;
+    auto records = ReadAll(&corrupted);
+    EXPECT_GT(corrupted, 0u);
+    EXPECT_LT(records.size(), 39u);
+    EXPECT_GT(records.size(), 30u);
+
+    // Survivors decode and replay; the damaged ones are simply missing
+    MemTable table(0);
+    EXPECT_EQ(WalReader::Replay(path_, options_, table), records.size());
+    EXPECT_TRUE(table.Get(B("key0")).has_value());
+    EXPECT_FALSE(table.Get(B("key39")).has_value());
+}
+
+TEST_F(WalTest, CorruptLastPartialBlockIsSkipped) {
+    {
+        WalWriter writer(path_, options_);
+        writer.Put(B("key"), 1, B("value"));
+    }
+    ASSERT_LT(fs::file_size(path_), options_.block_size);
+
+    // The damaged block is also the file's last, unpadded one
+    FlipByte(20);
+    uint64_t corrupted = 0;
+    EXPECT_TRUE(ReadAll(&corrupted).empty());
+    EXPECT_EQ(corrupted, fs::file_size(path_));
+}
+
+TEST_F(WalTest, ConcurrentWritersShareGroupCommits) {
+    options_.block_size = 4096;
+    options_.wal_sync_policy = WalSyncPolicy::Always;
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 200;
+    WalWriter writer(path_, options_);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&writer, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                uint64_t ts = static_cast<uint64_t>(t) * kPerThread + i + 1;
+                EXPECT_TRUE(writer.Put(B(std::to_string(t) + ":" + std::to_string(i)), ts, B("v")));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // Every acknowledged write was synced by some group
+    EXPECT_LE(writer.GroupCount(), static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(writer.SyncCount(), writer.GroupCount());
+
+    MemTable table(0);
+    uint64_t max_ts = 0;
+    EXPECT_EQ(WalReader::Replay(path_, options_, table, &max_ts), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(max_ts, static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(table.Get(B("7:199"))->ToString(), "v");
+}
+
+TEST_F(WalTest, SyncPoliciesControlFdatasync) {
+    options_.wal_sync_policy = WalSyncPolicy::None;
+    {
+        WalWriter writer(path_, options_);
+        for (int i = 0; i < 10; ++i) {
+            writer.Put(B("k"), i, B("v"));
+        }
+        EXPECT_EQ(writer.SyncCount(), 0u);
+        EXPECT_TRUE(writer.Sync());
+        EXPECT_EQ(writer.SyncCount(), 1u);
+        // Nothing new to make durable
+        EXPECT_TRUE(writer.Sync());
+        EXPECT_EQ(writer.SyncCount(), 1u);
+    }
+
+    options_.wal_sync_policy = WalSyncPolicy::Periodic;
+    options_.wal_sync_bytes = 1000;
+    WalWriter writer(path_, options_);
+    uint64_t before = writer.FileSize();
+    for (int i = 0; i < 100; ++i) {
+        writer.Put(B("key"), 100 + i, B(std::string(93, 'x')));
+    }
+    // Synced about once per 1000 bytes appended
+    double appended = static_cast<double>(writer.FileSize() - before);
+    EXPECT_NEAR(static_cast<double>(writer.SyncCount()), appended / 1000, 1.0);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
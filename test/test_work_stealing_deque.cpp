@@ -1,11 +1,25 @@
 #include "util/work_stealing_deque.hpp"
 #include "util/thread_pool.hpp"
+#include "util/waitable_atomic.hpp"
 #include <gtest/gtest.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include <chrono>
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <numeric>
 #include <optional>
+#include <stdexcept>
+#include <utility>
+#include <string>
+#include <functional>
 
 TEST(WorkStealingDeque, PushAndPopFromBottomUsesLocalLifoOrder) {
     SAK::thread::work_stealing_deque<int> deque;
@@ -91,6 +105,251 @@ TEST(WorkStealingDeque, CapacityGrowsWithoutLosingElements) {
     }
 }
 
+TEST(WorkStealingDeque, HoldsMoveOnlyValuesAndFreesLeftovers) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        SAK::thread::work_stealing_deque<std::unique_ptr<std::shared_ptr<int>>> deque(2);
+        for (int i = 0; i < 10; ++i) {
+            deque.push_bottom(std::make_unique<std::shared_ptr<int>>(tracker));
+        }
+        auto item = deque.pop_bottom();
+        ASSERT_TRUE(item.has_value());
+        EXPECT_EQ(**item, tracker);
+        EXPECT_EQ(tracker.use_count(), 11);
+    }
+    // Elements still queued when the deque is destroyed are destroyed too
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(WorkStealingDeque, StoresSmallTriviallyCopyableValuesInline) {
+    EXPECT_TRUE(SAK::thread::work_stealing_deque<int>::inline_slots);
+    EXPECT_TRUE(SAK::thread::work_stealing_deque<void*>::inline_slots);
+    EXPECT_FALSE(SAK::thread::work_stealing_deque<std::unique_ptr<int>>::inline_slots);
+    EXPECT_FALSE(SAK::thread::work_stealing_deque<SAK::thread::unique_task>::inline_slots);
+}
+
+TEST(WorkStealingDeque, ConcurrentStealsDuringGrowthClaimEachElementOnce) {
+    constexpr int kItems = 200000;
+    constexpr int kThieves = 3;
+    SAK::thread::work_stealing_deque<int> deque(2);
+    std::vector<std::atomic<int>> claimed(kItems);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < kThieves; ++t) {
+        thieves.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (auto value = deque.steal_top()) {
+                    claimed[static_cast<std::size_t>(*value)].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    // Pushes outpace pops so the buffer keeps growing under the thieves
+    for (int i = 0; i < kItems; ++i) {
+        deque.push_bottom(i);
+        if (i % 3 == 0) {
+            if (auto value = deque.pop_bottom()) {
+                claimed[static_cast<std::size_t>(*value)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    while (auto value = deque.pop_bottom()) {
+        claimed[static_cast<std::size_t>(*value)].fetch_add(1, std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_EQ(claimed[static_cast<std::size_t>(i)].load(), 1) << "item " << i;
+    }
+}
+
+namespace {
+
+// Baseline: one lock around the whole deque, which is what the former
+// atomic shared_ptr loads amounted to on libstdc++
+template <typename T>
+class locked_deque {
+public:
+    void push_bottom(T value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.push_back(std::move(value));
+    }
+
+    std::optional<T> pop_bottom() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(items_.back()));
+        items_.pop_back();
+        return value;
+    }
+
+    std::optional<T> steal_top() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(items_.front()));
+        items_.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<T> items_;
+};
+
+// Not trivially copyable, so the lock-free deque stores it behind a node
+struct boxed_int {
+    explicit boxed_int(long v = 0) : value(v) {}
+    boxed_int(boxed_int&& other) noexcept : value(other.value) {}
+    boxed_int& operator=(boxed_int&& other) noexcept {
+        value = other.value;
+        return *this;
+    }
+    long value;
+};
+
+long unbox(long v) { return v; }
+long unbox(const boxed_int& v) { return v.value; }
+
+// Owner pushes in bursts and pops half of each burst back while two
+// thieves steal; returns the elapsed time and checks nothing was lost
+template <typename Deque, typename T>
+double run_deque_benchmark(const char* name) {
+    constexpr long kItems = 400000;
+    constexpr long kBurst = 64;
+    Deque deque;
+    std::atomic<long> claimed_sum{0};
+    std::atomic<long> claimed_count{0};
+    std::atomic<bool> done{false};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 2; ++t) {
+        thieves.emplace_back([&]() {
+            long sum = 0;
+            long count = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                if (auto value = deque.steal_top()) {
+                    sum += unbox(*value);
+                    ++count;
+                }
+            }
+            while (auto value = deque.steal_top()) {
+                sum += unbox(*value);
+                ++count;
+            }
+            claimed_sum.fetch_add(sum);
+            claimed_count.fetch_add(count);
+        });
+    }
+
+    long sum = 0;
+    long count = 0;
+    for (long base = 0; base < kItems; base += kBurst) {
+        for (long i = base; i < base + kBurst; ++i) {
+            deque.push_bottom(T(i));
+        }
+        for (long i = 0; i < kBurst / 2; ++i) {
+            if (auto value = deque.pop_bottom()) {
+                sum += unbox(*value);
+                ++count;
+            }
+        }
+    }
+    done.store(true, std::memory_order_release);
+    while (auto value = deque.pop_bottom()) {
+        sum += unbox(*value);
+        ++count;
+    }
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(count + claimed_count.load(), kItems) << name;
+    EXPECT_EQ(sum + claimed_sum.load(), kItems * (kItems - 1) / 2) << name;
+    std::cout << "  " << name << ": " << elapsed << " ms, "
+              << static_cast<long>(kItems / (elapsed / 1000.0)) << " items/s" << std::endl;
+    return elapsed;
+}
+
+} // namespace
+
+TEST(WorkStealingDequeBenchmark, LockFreeVersusLocked) {
+    std::cout << "\n=== Work-stealing deque throughput ===" << std::endl;
+    run_deque_benchmark<SAK::thread::work_stealing_deque<long>, long>("lock-free, inline slots");
+    run_deque_benchmark<SAK::thread::work_stealing_deque<boxed_int>, boxed_int>("lock-free, pooled nodes");
+    run_deque_benchmark<locked_deque<long>, long>("mutex + std::deque");
+}
+
+TEST(UniqueTask, SmallCallablesAreStoredInline) {
+    int calls = 0;
+    SAK::thread::unique_task small([&calls]() { ++calls; });
+    EXPECT_TRUE(small.is_inline());
+    small();
+    EXPECT_EQ(calls, 1);
+
+    struct Big {
+        char payload[256];
+        int* calls;
+        void operator()() { ++*calls; }
+    };
+    SAK::thread::unique_task big(Big{{}, &calls});
+    EXPECT_FALSE(big.is_inline());
+    big();
+    EXPECT_EQ(calls, 2);
+
+    SAK::thread::unique_task moved(std::move(big));
+    EXPECT_FALSE(static_cast<bool>(big));
+    moved();
+    EXPECT_EQ(calls, 3);
+}
+
+TEST(UniqueTask, AcceptsMoveOnlyCallables) {
+    auto value = std::make_unique<int>(5);
+    int seen = 0;
+    SAK::thread::unique_task task([value = std::move(value), &seen]() { seen = *value; });
+    SAK::thread::unique_task other;
+    other = std::move(task);
+    other();
+    EXPECT_EQ(seen, 5);
+}
+
+TEST(ThreadPoolWorkStealing, PostRunsTasksWithoutFutures) {
+    std::atomic<int> sum{0};
+    {
+        SAK::thread::ThreadPool pool(4);
+        for (int i = 1; i <= 100; ++i) {
+            pool.post([&sum](int v) { sum.fetch_add(v, std::memory_order_relaxed); }, i);
+        }
+        // A throwing posted task must not take the worker down
+        pool.post([]() { throw std::runtime_error("ignored"); });
+        auto after = pool.enqueue([]() { return 1; });
+        EXPECT_EQ(after.get(), 1);
+    }
+    EXPECT_EQ(sum.load(), 5050);
+}
+
+TEST(ThreadPoolWorkStealing, EnqueueForwardsArgumentsAndExceptions) {
+    SAK::thread::ThreadPool pool(2);
+    auto sum = pool.enqueue([](int a, int b) { return a + b; }, 2, 3);
+    EXPECT_EQ(sum.get(), 5);
+
+    auto owned = pool.enqueue([](const std::unique_ptr<int>& p) { return *p; }, std::make_unique<int>(9));
+    EXPECT_EQ(owned.get(), 9);
+
+    auto failing = pool.enqueue([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+}
+
 TEST(ThreadPoolWorkStealing, ZeroThreadConstructionStillExecutesAcceptedTasks) {
     SAK::thread::ThreadPool pool(0);
 
@@ -230,6 +489,281 @@ TEST(ThreadPoolWorkStealing, IdleWorkerCanStealPublishedWork) {
     EXPECT_TRUE(observed_stolen_execution);
 }
 
+TEST(ThreadPoolBulk, EnqueueBulkReturnsFuturesInOrder) {
+    SAK::thread::ThreadPool pool(4);
+    std::vector<std::function<int()>> tasks;
+    for (int i = 0; i < 1000; ++i) {
+        tasks.push_back([i]() { return i * 2; });
+    }
+
+    auto futures = pool.enqueue_bulk(tasks);
+    ASSERT_EQ(futures.size(), tasks.size());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(futures[static_cast<std::size_t>(i)].get(), i * 2);
+    }
+
+    std::vector<std::function<int()>> moved;
+    moved.push_back([]() { return 7; });
+    auto moved_futures = pool.enqueue_bulk(std::move(moved));
+    ASSERT_EQ(moved_futures.size(), 1u);
+    EXPECT_EQ(moved_futures[0].get(), 7);
+}
+
+TEST(ThreadPoolBulk, ParallelForVisitsEveryIndexOnce) {
+    SAK::thread::ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(10007);
+
+    pool.parallel_for(std::size_t{0}, visits.size(), std::size_t{64}, [&](std::size_t i) {
+        visits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    for (auto& count : visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+
+    // Empty ranges and a zero grain are accepted
+    pool.parallel_for(5, 5, 0, [](int) { FAIL(); });
+    std::atomic<int> calls{0};
+    pool.parallel_for(0, 10, 0, [&](int) { calls.fetch_add(1); });
+    EXPECT_EQ(calls.load(), 10);
+}
+
+TEST(ThreadPoolBulk, NestedParallelForOnWorkersDoesNotDeadlock) {
+    SAK::thread::ThreadPool pool(2);
+    std::atomic<int> total{0};
+
+    pool.parallel_for(0, 8, 1, [&](int) {
+        pool.parallel_for(0, 100, 10, [&](int) { total.fetch_add(1, std::memory_order_relaxed); });
+    });
+
+    EXPECT_EQ(total.load(), 800);
+}
+
+TEST(ThreadPoolBulk, ParallelReduceFoldsChunksInIndexOrder) {
+    SAK::thread::ThreadPool pool(4);
+
+    const long sum = pool.parallel_reduce(0L, 100000L, 1000L, 0L,
+                                          [](long i) { return i; },
+                                          [](long a, long b) { return a + b; });
+    EXPECT_EQ(sum, 100000L * 99999L / 2);
+
+    // String concatenation is associative but not commutative
+    const std::string digits = pool.parallel_reduce(0, 10, 2, std::string(),
+                                                    [](int i) { return std::to_string(i); },
+                                                    [](std::string a, const std::string& b) { return a + b; });
+    EXPECT_EQ(digits, "0123456789");
+}
+
+TEST(ThreadPoolBulk, ParallelForRethrowsFirstException) {
+    SAK::thread::ThreadPool pool(4);
+
+    EXPECT_THROW(pool.parallel_for(0, 1000, 10, [](int i) {
+        if (i == 500) {
+            throw std::runtime_error("boom");
+        }
+    }), std::runtime_error);
+
+    // The pool stays usable afterwards
+    EXPECT_EQ(pool.enqueue([]() { return 1; }).get(), 1);
+}
+
+TEST(WaitableAtomic, WaitReturnsOnceValueChanges) {
+    SAK::waitable_atomic<uint32_t> word(0);
+    std::atomic<bool> woke{false};
+
+    std::thread waiter([&]() {
+        word.wait(0);
+        woke.store(true, std::memory_order_release);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(woke.load(std::memory_order_acquire));
+    word.store(1);
+    word.notify_one();
+    waiter.join();
+
+    EXPECT_TRUE(woke.load());
+    // A value that already differs never blocks
+    word.wait(0);
+}
+
+namespace {
+
+bool wait_until_parked(const SAK::thread::ThreadPool& pool, size_t expected) {
+    for (int i = 0; i < 1000; ++i) {
+        if (pool.get_parked_count() == expected) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(ThreadPoolParking, IdleWorkersParkAndWakeForBursts) {
+    SAK::thread::ThreadPool pool(4);
+    ASSERT_TRUE(wait_until_parked(pool, 4));
+
+    for (int burst = 0; burst < 20; ++burst) {
+        std::atomic<int> done{0};
+        for (int i = 0; i < 100; ++i) {
+            pool.post([&]() { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        auto last = pool.enqueue([]() { return true; });
+        EXPECT_TRUE(last.get());
+        while (done.load(std::memory_order_relaxed) != 100) {
+            std::this_thread::yield();
+        }
+        ASSERT_TRUE(wait_until_parked(pool, 4)) << "burst " << burst;
+    }
+}
+
+TEST(ThreadPoolParking, SingleTaskAfterIdleIsNotLost) {
+    SAK::thread::ThreadPool pool(3);
+    for (int round = 0; round < 200; ++round) {
+        if (round % 50 == 0) {
+            wait_until_parked(pool, 3);
+        }
+        auto future = pool.enqueue([round]() { return round; });
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        EXPECT_EQ(future.get(), round);
+    }
+}
+
+TEST(ThreadPoolPlacement, WorkersArePinnedAndNamed) {
+    SAK::thread::ThreadPoolOptions options(2);
+    options.cpus = {0};
+    options.name_prefix = "codeknife-worker-pool";
+    SAK::thread::ThreadPool pool(options);
+
+    EXPECT_EQ(pool.get_thread_count(), 2u);
+    EXPECT_EQ(pool.get_group_count(), 1u);
+#if defined(__linux__)
+    auto placement = pool.enqueue([]() {
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        return std::make_pair(std::string(name), sched_getcpu());
+    }).get();
+    // Truncated to the 15 characters the kernel keeps
+    EXPECT_EQ(placement.first.size(), 15u);
+    EXPECT_EQ(placement.first.rfind("codeknife-worke", 0), 0u);
+    EXPECT_EQ(placement.second, 0);
+#endif
+}
+
+TEST(ThreadPoolPlacement, NumaGroupsStillStealAcrossWorkers) {
+    SAK::thread::ThreadPoolOptions options(4);
+    options.numa_groups = true;
+    SAK::thread::ThreadPool pool(options);
+
+    EXPECT_GE(pool.get_group_count(), 1u);
+    EXPECT_LE(pool.get_group_count(), pool.get_thread_count());
+
+    std::atomic<int> total{0};
+    pool.parallel_for(0, 1000, 10, [&](int) { total.fetch_add(1, std::memory_order_relaxed); });
+    EXPECT_EQ(total.load(), 1000);
+}
+
+TEST(ThreadPoolPriority, HighPriorityTasksRunBeforeQueuedNormalOnes) {
+    SAK::thread::ThreadPool pool(1);
+    std::promise<void> release;
+    std::promise<void> started;
+    auto gate = release.get_future().share();
+    auto blocker = pool.enqueue([gate, &started]() {
+        started.set_value();
+        gate.wait();
+    });
+    started.get_future().wait();
+
+    std::mutex order_mutex;
+    std::vector<char> order;
+    auto record = [&](char tag) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(tag);
+    };
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 5; ++i) {
+        futures.push_back(pool.enqueue(SAK::thread::TaskPriority::low, [&]() { record('l'); }));
+        futures.push_back(pool.enqueue([&]() { record('n'); }));
+        futures.push_back(pool.enqueue(SAK::thread::TaskPriority::high, [&]() { record('h'); }));
+    }
+    EXPECT_EQ(pool.get_task_count(SAK::thread::TaskPriority::high), 5u);
+    EXPECT_EQ(pool.get_task_count(SAK::thread::TaskPriority::normal), 5u);
+    EXPECT_EQ(pool.get_task_count(SAK::thread::TaskPriority::low), 5u);
+
+    release.set_value();
+    blocker.get();
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    ASSERT_EQ(order.size(), 15u);
+    EXPECT_EQ(std::string(order.begin(), order.end()), "hhhhhnnnnnlllll");
+}
+
+TEST(ThreadPoolPriority, ReservedWorkersServeHighPriorityWhileGeneralWorkersAreBusy) {
+    SAK::thread::ThreadPoolOptions options(2);
+    options.high_priority_workers = 1;
+    SAK::thread::ThreadPool pool(options);
+
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    std::promise<std::thread::id> general_id;
+    auto general_future = general_id.get_future();
+    auto background = pool.enqueue([gate, &general_id]() {
+        general_id.set_value(std::this_thread::get_id());
+        gate.wait();
+    });
+    const std::thread::id general_thread = general_future.get();
+
+    // A normal task queued behind the blocked general worker must not be
+    // picked up by the reserved worker
+    std::atomic<bool> normal_ran{false};
+    auto normal = pool.enqueue([&]() { normal_ran.store(true); });
+
+    auto urgent = pool.enqueue(SAK::thread::TaskPriority::high, []() { return std::this_thread::get_id(); });
+    ASSERT_EQ(urgent.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_NE(urgent.get(), general_thread);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(normal_ran.load());
+
+    release.set_value();
+    background.get();
+    normal.get();
+    EXPECT_TRUE(normal_ran.load());
+}
+
+TEST(ThreadPoolPriority, WaitTimeCountersTrackStartedTasks) {
+    SAK::thread::ThreadPool pool(1);
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    auto blocker = pool.enqueue([gate]() { gate.wait(); });
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(pool.enqueue(SAK::thread::TaskPriority::low, []() {}));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pool.get_priority_stats(SAK::thread::TaskPriority::low).queued, 4u);
+
+    release.set_value();
+    blocker.get();
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    const auto low = pool.get_priority_stats(SAK::thread::TaskPriority::low);
+    EXPECT_EQ(low.queued, 0u);
+    EXPECT_EQ(low.started, 4u);
+    EXPECT_GE(low.max_wait_ns, 20u * 1000 * 1000);
+    EXPECT_GE(low.average_wait_ns(), 20u * 1000 * 1000);
+    EXPECT_EQ(pool.get_priority_stats(SAK::thread::TaskPriority::high).started, 0u);
+    EXPECT_EQ(pool.get_priority_stats(SAK::thread::TaskPriority::normal).started, 1u);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -13,6 +13,40 @@ end
 -- External dependencies
 -- No external dependencies required
 
+-- Build options
+option("pool_operator_new")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Route global operator new/delete through MemoryPoolV2")
+option_end()
+
+option("glib")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Use the GLib event dispatcher on Linux; without it the epoll one is the only dispatcher")
+option_end()
+
+if has_config("glib") and not is_plat("windows") then
+    add_requires("glib")
+end
+
+option("coroutines")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build the C++20 coroutine adapters and their tests")
+option_end()
+
+option("metrics")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Record metrics and trace spans; without it updates compile to nothing")
+option_end()
+
+-- Global so every translation unit sees the same metrics.hpp
+if not has_config("metrics") then
+    add_defines("CODEKNIFE_NO_METRICS")
+end
+
 -- Platform detection and flags
 if is_plat("windows") then
     -- Windows (MSVC/MinGW). Keep warnings controlled globally via set_warnings("none")
@@ -43,11 +77,22 @@ target("codeknife")
     -- Source files
     add_files("src/util/*.cpp")
     add_files("src/cobject/*.cpp")
+    if has_config("pool_operator_new") then
+        add_files("src/util/hooks/memory_pool_v2_new.cpp")
+    end
     -- Exclude non-target platform dispatcher
     if is_plat("windows") then
         remove_files("src/cobject/event_dispatcher_linux.cpp")
+        remove_files("src/cobject/event_dispatcher_epoll.cpp")
+        remove_files("src/cobject/event_dispatcher_uring.cpp")
     else
         remove_files("src/cobject/event_dispatcher_win.cpp")
+        if has_config("glib") then
+            add_packages("glib", {public = true})
+        else
+            remove_files("src/cobject/event_dispatcher_linux.cpp")
+            add_defines("CODEKNIFE_NO_GLIB", {public = true})
+        end
     end
     add_headerfiles("include/**.hpp")  -- Include all header files recursively
     add_includedirs("include", "include/cobject", "include/util", {public = true})
@@ -72,11 +117,22 @@ target("codeknife_static")
     -- Source files
     add_files("src/util/*.cpp")
     add_files("src/cobject/*.cpp")
+    if has_config("pool_operator_new") then
+        add_files("src/util/hooks/memory_pool_v2_new.cpp")
+    end
     -- Exclude non-target platform dispatcher
     if is_plat("windows") then
         del_files("src/cobject/event_dispatcher_linux.cpp")
+        del_files("src/cobject/event_dispatcher_epoll.cpp")
+        del_files("src/cobject/event_dispatcher_uring.cpp")
     else
         del_files("src/cobject/event_dispatcher_win.cpp")
+        if has_config("glib") then
+            add_packages("glib", {public = true})
+        else
+            del_files("src/cobject/event_dispatcher_linux.cpp")
+            add_defines("CODEKNIFE_NO_GLIB", {public = true})
+        end
     end
     add_headerfiles("include/**.hpp")  -- Include all header files recursively
     add_includedirs("include", "include/cobject", "include/util", {public = true})
@@ -154,3 +210,334 @@ target("test_memory_pool_v2")
         add_links("pthread", "stdc++fs")
     end
     set_rundir("$(projectdir)")
+
+-- CRC32C tests
+target("test_crc32c")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_crc32c.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- ObjectPool tests
+target("test_object_pool")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_object_pool.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Legacy MemoryPool tests
+target("test_memory_pool")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_memory_pool.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Arena tests
+target("test_arena")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_arena.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Task continuation tests
+target("test_task")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_task.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Spin lock tests
+target("test_spin_mutex")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_spin_mutex.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Bounded queue tests
+target("test_ring_queue")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_ring_queue.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+-- Logger tests
+target("test_logger")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_logger.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_timer")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_timer.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_ipc_shared_memory")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_ipc_shared_memory.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_epoch")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_epoch.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_mpsc_queue")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_mpsc_queue.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_memtable")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_memtable.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_wal")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_wal.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_sstable")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_sstable.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_block_cache")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_block_cache.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_compaction")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_compaction.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")
+
+target("test_byte_buffer")
+    set_kind("binary")
+    add_deps("codeknife_static")
+    add_files("test/test_byte_buffer.cpp")
+    add_packages("gtest")
+    add_tests("default")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread")
+    end
+    set_rundir("$(projectdir)")
+
+-- Metrics tests, which need the recording the option turns off
+if has_config("metrics") then
+    target("test_metrics")
+        set_kind("binary")
+        add_deps("codeknife_static")
+        add_files("test/test_metrics.cpp")
+        add_packages("gtest")
+        add_tests("default")
+        if is_plat("windows") then
+            add_syslinks("ws2_32")
+            add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+            add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+        else
+            add_links("pthread")
+        end
+        set_rundir("$(projectdir)")
+end
+
+-- Coroutine tests (C++20)
+if has_config("coroutines") then
+    target("test_coroutine")
+        set_kind("binary")
+        set_languages("cxx20")
+        add_deps("codeknife_static")
+        add_files("test/test_coroutine.cpp")
+        add_packages("gtest")
+        add_tests("default")
+        if is_plat("windows") then
+            add_syslinks("ws2_32")
+            add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+            add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+        else
+            add_links("pthread", "stdc++fs")
+        end
+        set_rundir("$(projectdir)")
+end
+
+-- Microbenchmarks: `xmake f -m release && xmake build bench && xmake run bench --out=bench.json`
+target("bench")
+    set_kind("binary")
+    set_default(false)
+    add_deps("codeknife_static")
+    add_files("bench/*.cpp")
+    add_includedirs("bench")
+    if is_plat("windows") then
+        add_syslinks("ws2_32")
+        add_cxxflags("-static-libgcc", "-static-libstdc++", "-static")
+        add_ldflags("-static-libgcc", "-static-libstdc++", "-static")
+    else
+        add_links("pthread", "stdc++fs")
+    end
+    set_rundir("$(projectdir)")